@@ -0,0 +1,130 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstring>
+#include <benchmark/benchmark.h>
+
+#include "benchmark-program.hpp"
+#include "benchmark-support.hpp"
+
+#include "fiber/fiber.h"
+#include "fiber/fiber_pool.h"
+#include "fiber/fiber_scheduler.h"
+
+#define FIBER_NAME "connection"
+#define FIBER_NAME_LEN (strlen(FIBER_NAME))
+
+// The benchmarks simulate the fiber lifecycle of a connection that gets accepted and closed right away, which is
+// the worst case for the accept rate as the cost of setting up the fiber is not amortized by the commands processed.
+
+void bench_fiber_pool_connection_entrypoint(void *user_data) {
+    fiber_scheduler_terminate_current_fiber();
+}
+
+static void BM_FiberPool_AcceptRate_NoPool(benchmark::State& state) {
+    fiber_scheduler_set_fiber_pool(nullptr);
+
+    for (auto _ : state) {
+        fiber_scheduler_new_fiber(
+                (char*)FIBER_NAME,
+                FIBER_NAME_LEN,
+                bench_fiber_pool_connection_entrypoint,
+                nullptr);
+    }
+
+    fiber_scheduler_free();
+}
+
+static void BM_FiberPool_AcceptRate_Pool(benchmark::State& state) {
+    fiber_pool_t *fiber_pool = fiber_pool_new(FIBER_SCHEDULER_STACK_SIZE, state.range(0));
+    fiber_pool_prewarm(fiber_pool, state.range(0));
+    fiber_scheduler_set_fiber_pool(fiber_pool);
+
+    for (auto _ : state) {
+        fiber_scheduler_new_fiber(
+                (char*)FIBER_NAME,
+                FIBER_NAME_LEN,
+                bench_fiber_pool_connection_entrypoint,
+                nullptr);
+    }
+
+    fiber_scheduler_set_fiber_pool(nullptr);
+    fiber_scheduler_free();
+    fiber_pool_free(fiber_pool);
+}
+
+static void BM_FiberPool_AcquireRelease_Concurrent(benchmark::State& state) {
+    auto fibers_count = (uint32_t)state.range(0);
+    auto fibers = (fiber_t**)malloc(sizeof(fiber_t*) * fibers_count);
+    fiber_pool_t *fiber_pool = fiber_pool_new(FIBER_SCHEDULER_STACK_SIZE, fibers_count);
+    fiber_pool_prewarm(fiber_pool, fibers_count);
+
+    // Simulate bursts of connections being accepted and then closed
+    for (auto _ : state) {
+        for(uint32_t index = 0; index < fibers_count; index++) {
+            fibers[index] = fiber_pool_acquire(
+                    fiber_pool,
+                    (char*)FIBER_NAME,
+                    FIBER_NAME_LEN,
+                    bench_fiber_pool_connection_entrypoint,
+                    nullptr);
+        }
+
+        for(uint32_t index = 0; index < fibers_count; index++) {
+            fiber_pool_release(fiber_pool, fibers[index]);
+        }
+    }
+
+    state.SetItemsProcessed((int64_t)state.iterations() * fibers_count);
+
+    fiber_pool_free(fiber_pool);
+    free(fibers);
+}
+
+static void BM_FiberPool_NewFree_Concurrent(benchmark::State& state) {
+    auto fibers_count = (uint32_t)state.range(0);
+    auto fibers = (fiber_t**)malloc(sizeof(fiber_t*) * fibers_count);
+
+    for (auto _ : state) {
+        for(uint32_t index = 0; index < fibers_count; index++) {
+            fibers[index] = fiber_new(
+                    (char*)FIBER_NAME,
+                    FIBER_NAME_LEN,
+                    FIBER_SCHEDULER_STACK_SIZE,
+                    bench_fiber_pool_connection_entrypoint,
+                    nullptr);
+        }
+
+        for(uint32_t index = 0; index < fibers_count; index++) {
+            fiber_free(fibers[index]);
+        }
+    }
+
+    state.SetItemsProcessed((int64_t)state.iterations() * fibers_count);
+
+    free(fibers);
+}
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b->UseRealTime();
+}
+
+static void BenchArgumentsConcurrent(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(4)->Range(16, 4096)->UseRealTime();
+}
+
+BENCHMARK(BM_FiberPool_AcceptRate_NoPool)
+    ->Apply(BenchArguments);
+BENCHMARK(BM_FiberPool_AcceptRate_Pool)
+    ->Arg(128)
+    ->Apply(BenchArguments);
+BENCHMARK(BM_FiberPool_NewFree_Concurrent)
+    ->Apply(BenchArgumentsConcurrent);
+BENCHMARK(BM_FiberPool_AcquireRelease_Concurrent)
+    ->Apply(BenchArgumentsConcurrent);
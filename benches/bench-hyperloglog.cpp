@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstdlib>
+#include <numa.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark-program-simple.hpp"
+
+#include "cmake_config.h"
+#include "data_structures/hyperloglog/hyperloglog.h"
+#include "data_structures/hyperloglog/hyperloglog_registers.h"
+
+// A dense HyperLogLog with random registers is merged into an array of registers, as done by PFMERGE and by PFCOUNT
+// with multiple keys for each dense HyperLogLog
+class HyperLogLogMergeDenseFixture : public benchmark::Fixture {
+private:
+    uint8_t *registers = nullptr;
+    char *buffer = nullptr;
+
+public:
+    uint8_t* GetRegisters() {
+        return this->registers;
+    }
+
+    uint8_t* GetDense() {
+        return (uint8_t*)this->buffer + HYPERLOGLOG_HEADER_LENGTH;
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        this->registers = (uint8_t*)malloc(HYPERLOGLOG_REGISTERS_COUNT);
+        this->buffer = (char*)malloc(HYPERLOGLOG_DENSE_LENGTH);
+
+        srand(42);
+        for(uint32_t index = 0; index < HYPERLOGLOG_REGISTERS_COUNT; index++) {
+            this->registers[index] = rand() % 20;
+        }
+
+        hyperloglog_serialize(this->registers, HYPERLOGLOG_ENCODING_DENSE, this->buffer);
+
+        for(uint32_t index = 0; index < HYPERLOGLOG_REGISTERS_COUNT; index++) {
+            this->registers[index] = rand() % 20;
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        free(this->registers);
+        free(this->buffer);
+    }
+};
+
+BENCHMARK_DEFINE_F(HyperLogLogMergeDenseFixture, MergeDenseLoop)(benchmark::State& state) {
+    for (auto _ : state) {
+        HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, loop)(
+                this->GetRegisters(),
+                this->GetDense(),
+                HYPERLOGLOG_REGISTERS_COUNT);
+        benchmark::ClobberMemory();
+    }
+}
+
+#if defined(__x86_64__)
+BENCHMARK_DEFINE_F(HyperLogLogMergeDenseFixture, MergeDenseAvx2)(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx2")) {
+        state.SkipWithError("AVX2 not supported");
+        return;
+    }
+
+    for (auto _ : state) {
+        HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, avx2)(
+                this->GetRegisters(),
+                this->GetDense(),
+                HYPERLOGLOG_REGISTERS_COUNT);
+        benchmark::ClobberMemory();
+    }
+}
+
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+BENCHMARK_DEFINE_F(HyperLogLogMergeDenseFixture, MergeDenseAvx512)(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw")) {
+        state.SkipWithError("AVX512BW not supported");
+        return;
+    }
+
+    for (auto _ : state) {
+        HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, avx512)(
+                this->GetRegisters(),
+                this->GetDense(),
+                HYPERLOGLOG_REGISTERS_COUNT);
+        benchmark::ClobberMemory();
+    }
+}
+#endif
+#elif defined(__aarch64__)
+BENCHMARK_DEFINE_F(HyperLogLogMergeDenseFixture, MergeDenseArmv8aNeon)(benchmark::State& state) {
+    for (auto _ : state) {
+        HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, armv8a_neon)(
+                this->GetRegisters(),
+                this->GetDense(),
+                HYPERLOGLOG_REGISTERS_COUNT);
+        benchmark::ClobberMemory();
+    }
+}
+#endif
+
+BENCHMARK_DEFINE_F(HyperLogLogMergeDenseFixture, Cardinality)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hyperloglog_cardinality(this->GetRegisters()));
+    }
+}
+
+BENCHMARK_REGISTER_F(HyperLogLogMergeDenseFixture, MergeDenseLoop);
+#if defined(__x86_64__)
+BENCHMARK_REGISTER_F(HyperLogLogMergeDenseFixture, MergeDenseAvx2);
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+BENCHMARK_REGISTER_F(HyperLogLogMergeDenseFixture, MergeDenseAvx512);
+#endif
+#elif defined(__aarch64__)
+BENCHMARK_REGISTER_F(HyperLogLogMergeDenseFixture, MergeDenseArmv8aNeon);
+#endif
+BENCHMARK_REGISTER_F(HyperLogLogMergeDenseFixture, Cardinality);
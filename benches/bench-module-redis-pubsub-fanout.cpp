@@ -0,0 +1,202 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstring>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <benchmark/benchmark.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "memory_fences.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_mailbox.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_pubsub.h"
+
+#include "benchmark-program.hpp"
+#include "benchmark-support.hpp"
+
+#define BENCH_MODULE_REDIS_PUBSUB_FANOUT_QUEUE_SIZE (4096)
+#define BENCH_MODULE_REDIS_PUBSUB_FANOUT_CHANNEL "bench-channel"
+#define BENCH_MODULE_REDIS_PUBSUB_FANOUT_PAYLOAD_LENGTH (64)
+
+// The publisher, the worker 0, fans out the messages to the receivers, the other workers, through the mailbox as
+// PUBLISH does; each receiver hosts its share of the subscribers and queues the shared message to all of them, the
+// queued messages are then dropped instead of being written out to the network.
+// The items processed are the messages queued to the subscribers.
+
+typedef struct bench_module_redis_pubsub_fanout_receiver bench_module_redis_pubsub_fanout_receiver_t;
+struct bench_module_redis_pubsub_fanout_receiver {
+    pthread_t thread;
+    worker_mailbox_t *mailbox;
+    uint32_t worker_index;
+    uint32_t workers_count;
+    uint32_t subscribers_count;
+    bool_volatile_t ready;
+    bool_volatile_t stop;
+};
+
+void *bench_module_redis_pubsub_fanout_receiver_thread_func(void *user_data) {
+    auto receiver = (bench_module_redis_pubsub_fanout_receiver_t*)user_data;
+
+    // The worker context is needed by the pubsub to know the index of the worker and to update the stats
+    auto worker_context = (worker_context_t*)xalloc_alloc_zero(sizeof(worker_context_t));
+    worker_context->worker_index = receiver->worker_index;
+    worker_context->workers_count = receiver->workers_count;
+    worker_context->mailbox = receiver->mailbox;
+    worker_context_set(worker_context);
+
+    auto network_channels = (network_channel_t*)xalloc_alloc_zero(
+            sizeof(network_channel_t) * receiver->subscribers_count);
+    auto connection_contexts = (module_redis_connection_context_t*)xalloc_alloc_zero(
+            sizeof(module_redis_connection_context_t) * receiver->subscribers_count);
+
+    for(uint32_t index = 0; index < receiver->subscribers_count; index++) {
+        connection_contexts[index].network_channel = &network_channels[index];
+        module_redis_pubsub_channel_subscribe(
+                &connection_contexts[index],
+                BENCH_MODULE_REDIS_PUBSUB_FANOUT_CHANNEL,
+                strlen(BENCH_MODULE_REDIS_PUBSUB_FANOUT_CHANNEL));
+    }
+
+    receiver->ready = true;
+    MEMORY_FENCE_STORE();
+
+    while(true) {
+        MEMORY_FENCE_LOAD();
+        bool stop = receiver->stop;
+
+        // The receiver stops only once the queues have been drained
+        if (worker_mailbox_process(receiver->mailbox, receiver->worker_index, false) == 0) {
+            if (stop) {
+                break;
+            }
+
+            continue;
+        }
+
+        for(uint32_t index = 0; index < receiver->subscribers_count; index++) {
+            module_redis_pubsub_connection_drop_pending(&connection_contexts[index]);
+        }
+    }
+
+    for(uint32_t index = 0; index < receiver->subscribers_count; index++) {
+        module_redis_pubsub_connection_cleanup(&connection_contexts[index]);
+    }
+
+    xalloc_free(connection_contexts);
+    xalloc_free(network_channels);
+
+    worker_context_set(nullptr);
+    xalloc_free(worker_context);
+
+    return nullptr;
+}
+
+static void BM_ModuleRedisPubSub_FanOut(benchmark::State& state) {
+    bool wakeup_required;
+    char payload[BENCH_MODULE_REDIS_PUBSUB_FANOUT_PAYLOAD_LENGTH] = { 0 };
+    uint32_t receivers_count = state.range(0);
+    uint32_t subscribers_count = state.range(1);
+    uint32_t workers_count = receivers_count + 1;
+
+    memset(payload, 'a', sizeof(payload));
+
+    worker_mailbox_t *mailbox = worker_mailbox_new(workers_count, BENCH_MODULE_REDIS_PUBSUB_FANOUT_QUEUE_SIZE);
+    auto receivers = (bench_module_redis_pubsub_fanout_receiver_t*)xalloc_alloc_zero(
+            sizeof(bench_module_redis_pubsub_fanout_receiver_t) * receivers_count);
+
+    for(uint32_t index = 0; index < receivers_count; index++) {
+        bench_module_redis_pubsub_fanout_receiver_t *receiver = &receivers[index];
+
+        receiver->mailbox = mailbox;
+        receiver->worker_index = index + 1;
+        receiver->workers_count = workers_count;
+        receiver->subscribers_count =
+                (subscribers_count / receivers_count) + (index < subscribers_count % receivers_count ? 1 : 0);
+        pthread_create(
+                &receiver->thread,
+                nullptr,
+                bench_module_redis_pubsub_fanout_receiver_thread_func,
+                receiver);
+    }
+
+    for(uint32_t index = 0; index < receivers_count; index++) {
+        do {
+            MEMORY_FENCE_LOAD();
+        } while(!receivers[index].ready);
+    }
+
+    for (auto _ : state) {
+        // One message per publish, shared by all the receivers
+        module_redis_pubsub_message_t *message = module_redis_pubsub_message_new(
+                BENCH_MODULE_REDIS_PUBSUB_FANOUT_CHANNEL,
+                strlen(BENCH_MODULE_REDIS_PUBSUB_FANOUT_CHANNEL),
+                payload,
+                sizeof(payload),
+                receivers_count);
+
+        for(uint32_t index = 0; index < receivers_count; index++) {
+            while(!worker_mailbox_enqueue(
+                    mailbox,
+                    0,
+                    receivers[index].worker_index,
+                    module_redis_pubsub_deliver,
+                    message,
+                    &wakeup_required)) {
+                // The queue is full, wait for the receiver
+            }
+        }
+    }
+
+    for(uint32_t index = 0; index < receivers_count; index++) {
+        receivers[index].stop = true;
+        MEMORY_FENCE_STORE();
+        pthread_join(receivers[index].thread, nullptr);
+    }
+
+    state.SetItemsProcessed((int64_t)state.iterations() * subscribers_count);
+
+    xalloc_free(receivers);
+    worker_mailbox_free(mailbox);
+}
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b
+            ->ArgsProduct({
+                                  { 1, 2, 4 },
+                                  { 100, 10000 },
+                          })
+            ->UseRealTime();
+}
+
+BENCHMARK(BM_ModuleRedisPubSub_FanOut)
+    ->Apply(BenchArguments);
@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <arpa/inet.h>
+#include <benchmark/benchmark.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "memory_fences.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_mailbox.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_pubsub.h"
+#include "module/redis/module_redis_tracking.h"
+
+#include "benchmark-program.hpp"
+#include "benchmark-support.hpp"
+
+#define BENCH_MODULE_REDIS_TRACKING_KEY_MAX_LENGTH (32)
+
+// A single worker with a single RESP2 client, not subscribed to the invalidation channel, so the invalidations are
+// dispatched but never queued to the connection.
+// The first benchmark measures the cost of the hook on the write path of the hashtable when a client is tracking keys
+// but not the ones being changed, the second one the cost of remembering the keys read by a client, with the amount of
+// keys going beyond the capacity of the table the evictions and the related invalidations are measured as well.
+
+typedef struct bench_module_redis_tracking_environment bench_module_redis_tracking_environment_t;
+struct bench_module_redis_tracking_environment {
+    worker_context_t *worker_context;
+    hashtable_t *hashtable;
+    storage_db_t *db;
+    module_redis_connection_context_t *connection_context;
+    char *keys;
+    uint64_t keys_count;
+};
+
+static void bench_module_redis_tracking_environment_init(
+        bench_module_redis_tracking_environment_t *environment,
+        uint64_t keys_count) {
+    environment->worker_context = (worker_context_t*)xalloc_alloc_zero(sizeof(worker_context_t));
+    environment->worker_context->worker_index = 0;
+    environment->worker_context->workers_count = 1;
+    worker_context_set(environment->worker_context);
+
+    environment->hashtable = (hashtable_t*)xalloc_alloc_zero(sizeof(hashtable_t));
+    environment->db = (storage_db_t*)xalloc_alloc_zero(sizeof(storage_db_t));
+    environment->db->hashtable = environment->hashtable;
+
+    environment->connection_context = (module_redis_connection_context_t*)xalloc_alloc_zero(
+            sizeof(module_redis_connection_context_t));
+    environment->connection_context->resp_version = PROTOCOL_REDIS_RESP_VERSION_2;
+    environment->connection_context->db = environment->db;
+    module_redis_tracking_connection_register(environment->connection_context);
+    module_redis_tracking_enable(environment->connection_context, 0, false, false, nullptr, 0);
+
+    environment->keys_count = keys_count;
+    environment->keys = (char*)xalloc_alloc(keys_count * BENCH_MODULE_REDIS_TRACKING_KEY_MAX_LENGTH);
+    for(uint64_t index = 0; index < keys_count; index++) {
+        snprintf(
+                environment->keys + (index * BENCH_MODULE_REDIS_TRACKING_KEY_MAX_LENGTH),
+                BENCH_MODULE_REDIS_TRACKING_KEY_MAX_LENGTH,
+                "bench-key-%lu",
+                index);
+    }
+}
+
+static void bench_module_redis_tracking_environment_free(
+        bench_module_redis_tracking_environment_t *environment) {
+    // Drops the keys touched in buckets left filled by the previous runs, nobody else would flush them
+    module_redis_tracking_flush();
+    module_redis_tracking_connection_unregister(environment->connection_context);
+
+    xalloc_free(environment->keys);
+    xalloc_free(environment->connection_context);
+    xalloc_free(environment->db);
+    xalloc_free(environment->hashtable);
+
+    worker_context_set(nullptr);
+    xalloc_free(environment->worker_context);
+}
+
+static void BM_ModuleRedisTracking_KeyTouched_NotTracked(benchmark::State& state) {
+    uint64_t index = 0;
+    bench_module_redis_tracking_environment_t environment = { nullptr };
+
+    bench_module_redis_tracking_environment_init(&environment, state.range(0));
+
+    for (auto _ : state) {
+        char *key = environment.keys + ((index % environment.keys_count) * BENCH_MODULE_REDIS_TRACKING_KEY_MAX_LENGTH);
+
+        // The hash is not relevant as long as it's spread, the buckets are empty unless filled by the previous runs
+        module_redis_tracking_key_touched(
+                (hashtable_hash_t)index * 0x9E3779B97F4A7C15ULL,
+                0,
+                key,
+                strlen(key));
+        index++;
+    }
+
+    state.SetItemsProcessed((int64_t)state.iterations());
+
+    bench_module_redis_tracking_environment_free(&environment);
+}
+
+static void BM_ModuleRedisTracking_RememberKey(benchmark::State& state) {
+    uint64_t index = 0;
+    bench_module_redis_tracking_environment_t environment = { nullptr };
+
+    bench_module_redis_tracking_environment_init(&environment, state.range(0));
+
+    for (auto _ : state) {
+        char *key = environment.keys + ((index % environment.keys_count) * BENCH_MODULE_REDIS_TRACKING_KEY_MAX_LENGTH);
+
+        module_redis_tracking_remember_key(
+                environment.connection_context,
+                key,
+                strlen(key));
+        index++;
+    }
+
+    state.SetItemsProcessed((int64_t)state.iterations());
+
+    bench_module_redis_tracking_environment_free(&environment);
+}
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b
+            ->Arg(1024)
+            ->Arg(64 * 1024)
+            ->Arg(1024 * 1024);
+}
+
+BENCHMARK(BM_ModuleRedisTracking_KeyTouched_NotTracked)
+    ->Apply(BenchArguments);
+
+BENCHMARK(BM_ModuleRedisTracking_RememberKey)
+    ->Apply(BenchArguments);
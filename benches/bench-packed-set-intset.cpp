@@ -0,0 +1,195 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstdlib>
+#include <numa.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark-program-simple.hpp"
+
+#include "data_structures/packed_set/packed_set_intset.h"
+
+// The first set contains the even integers, the second set the multiples of the step passed as second argument shifted
+// by one when the step is odd: with a step of 2 the sets are the same, with a step of 3 about a third of the integers
+// are in common and with a large odd step there is no intersection at all
+class IntsetIntersectFixture : public benchmark::Fixture {
+private:
+    int64_t *a = nullptr;
+    int64_t *b = nullptr;
+    int64_t *result = nullptr;
+    uint32_t count = 0;
+
+public:
+    int64_t* GetA() {
+        return this->a;
+    }
+
+    int64_t* GetB() {
+        return this->b;
+    }
+
+    int64_t* GetResult() {
+        return this->result;
+    }
+
+    uint32_t GetCount() {
+        return this->count;
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        int64_t step = state.range(1);
+        this->count = (uint32_t)state.range(0);
+
+        this->a = (int64_t*)malloc(sizeof(int64_t) * this->count);
+        this->b = (int64_t*)malloc(sizeof(int64_t) * this->count);
+        this->result = (int64_t*)malloc(sizeof(int64_t) * this->count);
+
+        for(uint32_t index = 0; index < this->count; index++) {
+            this->a[index] = (int64_t)index * 2;
+            this->b[index] = (int64_t)index * step + (step % 2);
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        free(this->a);
+        free(this->b);
+        free(this->result);
+        this->count = 0;
+    }
+};
+
+// The searched value falls in the middle of the set but it's not part of it, so the whole search path is always walked
+class IntsetSearchFixture : public benchmark::Fixture {
+private:
+    int64_t *integers = nullptr;
+    uint32_t count = 0;
+
+public:
+    int64_t* GetIntegers() {
+        return this->integers;
+    }
+
+    uint32_t GetCount() {
+        return this->count;
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        this->count = (uint32_t)state.range(0);
+        this->integers = (int64_t*)malloc(sizeof(int64_t) * this->count);
+
+        for(uint32_t index = 0; index < this->count; index++) {
+            this->integers[index] = (int64_t)index * 2;
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        free(this->integers);
+        this->count = 0;
+    }
+};
+
+BENCHMARK_DEFINE_F(IntsetIntersectFixture, IntersectLoop)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PACKED_SET_INTSET_NAME_IMPL(intersect, loop)(
+                this->GetA(),
+                this->GetCount(),
+                this->GetB(),
+                this->GetCount(),
+                this->GetResult()));
+    }
+}
+
+#if defined(__x86_64__)
+BENCHMARK_DEFINE_F(IntsetIntersectFixture, IntersectAvx2)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PACKED_SET_INTSET_NAME_IMPL(intersect, avx2)(
+                this->GetA(),
+                this->GetCount(),
+                this->GetB(),
+                this->GetCount(),
+                this->GetResult()));
+    }
+}
+#endif
+
+#if defined(__aarch64__)
+BENCHMARK_DEFINE_F(IntsetIntersectFixture, IntersectArmv8aNeon)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PACKED_SET_INTSET_NAME_IMPL(intersect, armv8a_neon)(
+                this->GetA(),
+                this->GetCount(),
+                this->GetB(),
+                this->GetCount(),
+                this->GetResult()));
+    }
+}
+#endif
+
+BENCHMARK_DEFINE_F(IntsetSearchFixture, SearchLoop)(benchmark::State& state) {
+    uint32_t position;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PACKED_SET_INTSET_NAME_IMPL(search, loop)(
+                this->GetIntegers(),
+                this->GetCount(),
+                (int64_t)this->GetCount() - 1,
+                &position));
+    }
+}
+
+#if defined(__x86_64__)
+BENCHMARK_DEFINE_F(IntsetSearchFixture, SearchAvx2)(benchmark::State& state) {
+    uint32_t position;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PACKED_SET_INTSET_NAME_IMPL(search, avx2)(
+                this->GetIntegers(),
+                this->GetCount(),
+                (int64_t)this->GetCount() - 1,
+                &position));
+    }
+}
+#endif
+
+#if defined(__aarch64__)
+BENCHMARK_DEFINE_F(IntsetSearchFixture, SearchArmv8aNeon)(benchmark::State& state) {
+    uint32_t position;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PACKED_SET_INTSET_NAME_IMPL(search, armv8a_neon)(
+                this->GetIntegers(),
+                this->GetCount(),
+                (int64_t)this->GetCount() - 1,
+                &position));
+    }
+}
+#endif
+
+static void BenchArgumentsIntersect(benchmark::internal::Benchmark* b) {
+    for(int64_t count = 8; count <= 512; count *= 4) {
+        for(int64_t step : { 2, 3, 1025 }) {
+            b->Args({ count, step });
+        }
+    }
+    b->Iterations(1000000);
+}
+
+static void BenchArgumentsSearch(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(2)->Range(8, 512)->Iterations(10000000);
+}
+
+BENCHMARK_REGISTER_F(IntsetIntersectFixture, IntersectLoop)->Apply(BenchArgumentsIntersect);
+BENCHMARK_REGISTER_F(IntsetSearchFixture, SearchLoop)->Apply(BenchArgumentsSearch);
+#if defined(__x86_64__)
+BENCHMARK_REGISTER_F(IntsetIntersectFixture, IntersectAvx2)->Apply(BenchArgumentsIntersect);
+BENCHMARK_REGISTER_F(IntsetSearchFixture, SearchAvx2)->Apply(BenchArgumentsSearch);
+#endif
+#if defined(__aarch64__)
+BENCHMARK_REGISTER_F(IntsetIntersectFixture, IntersectArmv8aNeon)->Apply(BenchArgumentsIntersect);
+BENCHMARK_REGISTER_F(IntsetSearchFixture, SearchArmv8aNeon)->Apply(BenchArgumentsSearch);
+#endif
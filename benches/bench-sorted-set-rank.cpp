@@ -0,0 +1,203 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <numa.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark-program-simple.hpp"
+
+#include "xalloc.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
+#include "data_structures/packed_sorted_set/packed_sorted_set.h"
+
+#define BENCH_SORTED_SET_MEMBER_MAX_LENGTH  (32)
+#define BENCH_SORTED_SET_LOOKUPS_COUNT      (4096)
+
+// The sorted set contains the members member-0 ... member-N with pseudo random scores, the members looked up are picked
+// in advance with the same generator so all the benchmarks search the same members in the same order
+class SortedSetRankFixture : public benchmark::Fixture {
+private:
+    sorted_set_t *sorted_set = nullptr;
+    char *packed_buffer = nullptr;
+    packed_sorted_set_t packed_sorted_set = { };
+    char (*lookups)[BENCH_SORTED_SET_MEMBER_MAX_LENGTH] = nullptr;
+    size_t *lookups_length = nullptr;
+    uint32_t count = 0;
+
+public:
+    sorted_set_t* GetSortedSet() {
+        return this->sorted_set;
+    }
+
+    packed_sorted_set_t* GetPackedSortedSet() {
+        return &this->packed_sorted_set;
+    }
+
+    char* GetLookup(
+            uint32_t index) {
+        return this->lookups[index % BENCH_SORTED_SET_LOOKUPS_COUNT];
+    }
+
+    size_t GetLookupLength(
+            uint32_t index) {
+        return this->lookups_length[index % BENCH_SORTED_SET_LOOKUPS_COUNT];
+    }
+
+    uint32_t GetCount() {
+        return this->count;
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        char member[BENCH_SORTED_SET_MEMBER_MAX_LENGTH];
+        uint64_t random_state = 42;
+        this->count = (uint32_t)state.range(0);
+
+        this->sorted_set = sorted_set_new();
+        for(uint32_t index = 0; index < this->count; index++) {
+            random_state = random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+            size_t member_length = snprintf(member, sizeof(member), "member-%u", index);
+
+            sorted_set_insert(this->sorted_set, member, member_length, (double)(random_state >> 40));
+        }
+
+        size_t packed_buffer_length = packed_sorted_set_serialized_length(this->sorted_set);
+        this->packed_buffer = (char*)xalloc_alloc(packed_buffer_length);
+        packed_sorted_set_serialize(this->sorted_set, this->packed_buffer, packed_buffer_length);
+        packed_sorted_set_init(&this->packed_sorted_set, this->packed_buffer, packed_buffer_length);
+
+        this->lookups = (char(*)[BENCH_SORTED_SET_MEMBER_MAX_LENGTH])malloc(
+                BENCH_SORTED_SET_MEMBER_MAX_LENGTH * BENCH_SORTED_SET_LOOKUPS_COUNT);
+        this->lookups_length = (size_t*)malloc(sizeof(size_t) * BENCH_SORTED_SET_LOOKUPS_COUNT);
+        for(uint32_t index = 0; index < BENCH_SORTED_SET_LOOKUPS_COUNT; index++) {
+            random_state = random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+            this->lookups_length[index] = snprintf(
+                    this->lookups[index],
+                    BENCH_SORTED_SET_MEMBER_MAX_LENGTH,
+                    "member-%u",
+                    (uint32_t)((random_state >> 33) % this->count));
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        sorted_set_free(this->sorted_set);
+        xalloc_free(this->packed_buffer);
+        free(this->lookups);
+        free(this->lookups_length);
+        this->count = 0;
+    }
+};
+
+// Baseline, the rank is the position of the member in the ordered entries found with a linear scan
+BENCHMARK_DEFINE_F(SortedSetRankFixture, RankLinearScan)(benchmark::State& state) {
+    uint32_t lookup_index = 0;
+    packed_sorted_set_entry_t entry;
+
+    for (auto _ : state) {
+        char *member = this->GetLookup(lookup_index);
+        size_t member_length = this->GetLookupLength(lookup_index);
+        uint32_t rank;
+
+        for(rank = 0; rank < this->GetCount(); rank++) {
+            packed_sorted_set_get(this->GetPackedSortedSet(), rank, &entry);
+            if (entry.member_length == member_length && memcmp(entry.member, member, member_length) == 0) {
+                break;
+            }
+        }
+
+        benchmark::DoNotOptimize(rank);
+        lookup_index++;
+    }
+}
+
+// The member is searched in the art_spsc index and its rank calculated walking down the skiplist summing the spans
+BENCHMARK_DEFINE_F(SortedSetRankFixture, RankSkiplist)(benchmark::State& state) {
+    uint32_t lookup_index = 0;
+
+    for (auto _ : state) {
+        sorted_set_node_t *node = sorted_set_get(
+                this->GetSortedSet(),
+                this->GetLookup(lookup_index),
+                this->GetLookupLength(lookup_index));
+
+        benchmark::DoNotOptimize(sorted_set_rank(this->GetSortedSet(), node));
+        lookup_index++;
+    }
+}
+
+// The rank is stored in the bucket of the member of the serialized sorted set
+BENCHMARK_DEFINE_F(SortedSetRankFixture, RankPacked)(benchmark::State& state) {
+    uint32_t lookup_index = 0;
+    uint32_t rank;
+    packed_sorted_set_entry_t entry;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(packed_sorted_set_find(
+                this->GetPackedSortedSet(),
+                this->GetLookup(lookup_index),
+                this->GetLookupLength(lookup_index),
+                &rank,
+                &entry));
+        lookup_index++;
+    }
+}
+
+BENCHMARK_DEFINE_F(SortedSetRankFixture, GetByRankSkiplist)(benchmark::State& state) {
+    uint64_t rank = 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sorted_set_get_by_rank(this->GetSortedSet(), rank));
+        rank = (rank + 7919) % this->GetCount();
+    }
+}
+
+BENCHMARK_DEFINE_F(SortedSetRankFixture, GetByRankPacked)(benchmark::State& state) {
+    uint32_t rank = 0;
+    packed_sorted_set_entry_t entry;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(packed_sorted_set_get(this->GetPackedSortedSet(), rank, &entry));
+        rank = (rank + 7919) % this->GetCount();
+    }
+}
+
+// The score of the member is moved back and forth, every update relinks the node in the skiplist
+BENCHMARK_DEFINE_F(SortedSetRankFixture, UpdateScoreSkiplist)(benchmark::State& state) {
+    uint32_t lookup_index = 0;
+
+    for (auto _ : state) {
+        sorted_set_node_t *node = sorted_set_get(
+                this->GetSortedSet(),
+                this->GetLookup(lookup_index),
+                this->GetLookupLength(lookup_index));
+
+        benchmark::DoNotOptimize(sorted_set_update_score(this->GetSortedSet(), node, -node->score));
+        lookup_index++;
+    }
+}
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(32)->Range(1024, 1024 * 1024);
+}
+
+static void BenchArgumentsLinearScan(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(32)->Range(1024, 1024 * 1024)->Iterations(1000);
+}
+
+BENCHMARK_REGISTER_F(SortedSetRankFixture, RankLinearScan)->Apply(BenchArgumentsLinearScan);
+BENCHMARK_REGISTER_F(SortedSetRankFixture, RankSkiplist)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(SortedSetRankFixture, RankPacked)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(SortedSetRankFixture, GetByRankSkiplist)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(SortedSetRankFixture, GetByRankPacked)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(SortedSetRankFixture, UpdateScoreSkiplist)->Apply(BenchArguments);
@@ -0,0 +1,203 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <numa.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark-program-simple.hpp"
+
+#include "xalloc.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
+#include "data_structures/packed_sorted_set/packed_sorted_set.h"
+
+#define BENCH_SORTED_SET_MEMBER_MAX_LENGTH  (32)
+#define BENCH_SORTED_SET_UPDATES_COUNT      (4096)
+
+// The sorted set contains the members member-0 ... member-N with pseudo random scores, the members updated are picked
+// in advance with the same generator so all the benchmarks change the same members in the same order.
+// Every iteration is the write done by a ZADD changing the score of an existing member.
+class SortedSetWriteFixture : public benchmark::Fixture {
+private:
+    sorted_set_t *sorted_set = nullptr;
+    char *packed_buffer = nullptr;
+    size_t packed_buffer_length = 0;
+    char (*updates)[BENCH_SORTED_SET_MEMBER_MAX_LENGTH] = nullptr;
+    size_t *updates_length = nullptr;
+
+public:
+    sorted_set_t* GetSortedSet() {
+        return this->sorted_set;
+    }
+
+    void SetSortedSet(
+            sorted_set_t *sorted_set_new) {
+        this->sorted_set = sorted_set_new;
+    }
+
+    char* GetPackedBuffer() {
+        return this->packed_buffer;
+    }
+
+    size_t GetPackedBufferLength() {
+        return this->packed_buffer_length;
+    }
+
+    void SetPackedBuffer(
+            char *buffer,
+            size_t buffer_length) {
+        this->packed_buffer = buffer;
+        this->packed_buffer_length = buffer_length;
+    }
+
+    char* GetUpdate(
+            uint32_t index) {
+        return this->updates[index % BENCH_SORTED_SET_UPDATES_COUNT];
+    }
+
+    size_t GetUpdateLength(
+            uint32_t index) {
+        return this->updates_length[index % BENCH_SORTED_SET_UPDATES_COUNT];
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        char member[BENCH_SORTED_SET_MEMBER_MAX_LENGTH];
+        uint64_t random_state = 42;
+        uint32_t count = (uint32_t)state.range(0);
+
+        this->sorted_set = sorted_set_new();
+        for(uint32_t index = 0; index < count; index++) {
+            random_state = random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+            size_t member_length = snprintf(member, sizeof(member), "member-%u", index);
+
+            sorted_set_insert(this->sorted_set, member, member_length, (double)(random_state >> 40));
+        }
+
+        this->packed_buffer_length = packed_sorted_set_serialized_length(this->sorted_set);
+        this->packed_buffer = (char*)xalloc_alloc(this->packed_buffer_length);
+        packed_sorted_set_serialize(this->sorted_set, this->packed_buffer, this->packed_buffer_length);
+
+        this->updates = (char(*)[BENCH_SORTED_SET_MEMBER_MAX_LENGTH])malloc(
+                BENCH_SORTED_SET_MEMBER_MAX_LENGTH * BENCH_SORTED_SET_UPDATES_COUNT);
+        this->updates_length = (size_t*)malloc(sizeof(size_t) * BENCH_SORTED_SET_UPDATES_COUNT);
+        for(uint32_t index = 0; index < BENCH_SORTED_SET_UPDATES_COUNT; index++) {
+            random_state = random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+            this->updates_length[index] = snprintf(
+                    this->updates[index],
+                    BENCH_SORTED_SET_MEMBER_MAX_LENGTH,
+                    "member-%u",
+                    (uint32_t)((random_state >> 33) % count));
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        sorted_set_free(this->sorted_set);
+        xalloc_free(this->packed_buffer);
+        free(this->updates);
+        free(this->updates_length);
+        this->packed_buffer_length = 0;
+    }
+};
+
+// Baseline, the value is stored serialized so every write loads it into a sorted set, changes it and serializes it
+// back into a new buffer
+BENCHMARK_DEFINE_F(SortedSetWriteFixture, UpdateScoreRebuild)(benchmark::State& state) {
+    uint32_t update_index = 0;
+    packed_sorted_set_t packed_sorted_set;
+
+    for (auto _ : state) {
+        sorted_set_t *sorted_set = sorted_set_new();
+        packed_sorted_set_init(&packed_sorted_set, this->GetPackedBuffer(), this->GetPackedBufferLength());
+        packed_sorted_set_load(&packed_sorted_set, sorted_set);
+
+        sorted_set_node_t *node = sorted_set_get(
+                sorted_set,
+                this->GetUpdate(update_index),
+                this->GetUpdateLength(update_index));
+        sorted_set_update_score(sorted_set, node, -node->score);
+
+        size_t buffer_length = packed_sorted_set_serialized_length(sorted_set);
+        char *buffer = (char*)xalloc_alloc(buffer_length);
+        packed_sorted_set_serialize(sorted_set, buffer, buffer_length);
+
+        xalloc_free(this->GetPackedBuffer());
+        this->SetPackedBuffer(buffer, buffer_length);
+        sorted_set_free(sorted_set);
+
+        update_index++;
+    }
+}
+
+// The sorted set is the stored value and nobody else is using it, the node is relinked in place
+BENCHMARK_DEFINE_F(SortedSetWriteFixture, UpdateScoreInPlace)(benchmark::State& state) {
+    uint32_t update_index = 0;
+
+    for (auto _ : state) {
+        sorted_set_node_t *node = sorted_set_get(
+                this->GetSortedSet(),
+                this->GetUpdate(update_index),
+                this->GetUpdateLength(update_index));
+
+        benchmark::DoNotOptimize(sorted_set_update_score(this->GetSortedSet(), node, -node->score));
+        update_index++;
+    }
+}
+
+// The sorted set is the stored value but a reader or the snapshot is using it, the sorted set is cloned, the clone is
+// changed and replaces the current one
+BENCHMARK_DEFINE_F(SortedSetWriteFixture, UpdateScoreCopyOnWrite)(benchmark::State& state) {
+    uint32_t update_index = 0;
+
+    for (auto _ : state) {
+        sorted_set_t *sorted_set = sorted_set_clone(this->GetSortedSet());
+
+        sorted_set_node_t *node = sorted_set_get(
+                sorted_set,
+                this->GetUpdate(update_index),
+                this->GetUpdateLength(update_index));
+        sorted_set_update_score(sorted_set, node, -node->score);
+
+        sorted_set_free(this->GetSortedSet());
+        this->SetSortedSet(sorted_set);
+
+        update_index++;
+    }
+}
+
+// A member is added and then removed, as done by a ZADD followed by a ZREM, on the stored sorted set
+BENCHMARK_DEFINE_F(SortedSetWriteFixture, AddRemoveInPlace)(benchmark::State& state) {
+    uint32_t update_index = 0;
+    char member[BENCH_SORTED_SET_MEMBER_MAX_LENGTH];
+
+    for (auto _ : state) {
+        size_t member_length = snprintf(member, sizeof(member), "new-%u", update_index);
+
+        sorted_set_insert(this->GetSortedSet(), member, member_length, (double)update_index);
+        benchmark::DoNotOptimize(sorted_set_remove(this->GetSortedSet(), member, member_length));
+        update_index++;
+    }
+}
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(32)->Range(1024, 1024 * 1024);
+}
+
+static void BenchArgumentsFullCopy(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(32)->Range(1024, 1024 * 1024)->Iterations(10);
+}
+
+BENCHMARK_REGISTER_F(SortedSetWriteFixture, UpdateScoreRebuild)->Apply(BenchArgumentsFullCopy);
+BENCHMARK_REGISTER_F(SortedSetWriteFixture, UpdateScoreInPlace)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(SortedSetWriteFixture, UpdateScoreCopyOnWrite)->Apply(BenchArgumentsFullCopy);
+BENCHMARK_REGISTER_F(SortedSetWriteFixture, AddRemoveInPlace)->Apply(BenchArguments);
@@ -0,0 +1,341 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstring>
+#include <numa.h>
+
+#include <benchmark/benchmark.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "log/log.h"
+#include "clock.h"
+#include "memory_fences.h"
+#include "config.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "utils_cpu.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+
+#include "../tests/support.h"
+
+#include "benchmark-program.hpp"
+#include "benchmark-support.hpp"
+
+// It is possible to control the amount of threads used for the test tuning the two defines below
+#define TEST_THREADS_RANGE_BEGIN (1)
+#define TEST_THREADS_RANGE_END (utils_cpu_count())
+
+#define TEST_KEYS_PER_BLOCK_MAX (16)
+#define TEST_VALUE_LENGTH (64)
+
+// All the threads update a small set of hot keys, a few keys at a time, to measure the throughput of the atomic blocks
+// executed by EXEC, which lock all the keys upfront in ascending chunk order, against the same updates carried out
+// one key at a time, which is what the clients have to do without MULTI/EXEC.
+// As for the other storage db benches, the db and the keys are set up by the thread 0 and shared with the others.
+volatile static storage_db *static_db = nullptr;
+volatile static char **static_keys = nullptr;
+
+class StorageDbOpLockKeysFixture : public benchmark::Fixture {
+private:
+    storage_db *_db = nullptr;
+    uint32_t _workers_count = 0;
+    char **_keys = nullptr;
+    uint32_t _keys_count = 0;
+
+public:
+    storage_db *GetDb() {
+        return this->_db;
+    }
+
+    [[nodiscard]] uint32_t GetWorkersCount() const {
+        return this->_workers_count;
+    }
+
+    char **GetKeys() {
+        return this->_keys;
+    }
+
+    [[nodiscard]] uint32_t GetKeysCount() const {
+        return this->_keys_count;
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        char error_message[150] = {0};
+
+        test_support_set_thread_affinity(state.thread_index());
+
+        this->_keys_count = state.range(0);
+
+        if (state.thread_index() == 0) {
+            if (BenchmarkSupport::CheckIfTooManyThreadsPerCore(
+                    state.threads(),
+                    BENCHES_MAX_THREADS_PER_CORE)) {
+                sprintf(error_message, "Too many threads per core, max allowed <%d>", BENCHES_MAX_THREADS_PER_CORE);
+                ((::benchmark::State &) state).SkipWithError(error_message);
+
+                return;
+            }
+
+            char **keys = (char**)xalloc_alloc(sizeof(char*) * this->_keys_count);
+            for(uint32_t index = 0; index < this->_keys_count; index++) {
+                keys[index] = (char*)xalloc_alloc(32);
+                snprintf(keys[index], 32, "hot-key-%u", index);
+            }
+
+            storage_db_config_t *db_config = storage_db_config_new();
+            db_config->limits.keys_count.hard_limit = 0xFFFFu;
+            db_config->backend_type = STORAGE_DB_BACKEND_TYPE_MEMORY;
+            static_db = storage_db_new(db_config, state.threads());
+            if (!static_db) {
+                storage_db_config_free(db_config);
+
+                sprintf(
+                        error_message,
+                        "Failed to allocate the storage db, unable to continue");
+                ((::benchmark::State &) state).SkipWithError(error_message);
+                return;
+            }
+
+            static_keys = (volatile char **)keys;
+
+            MEMORY_FENCE_STORE();
+        }
+
+        if (state.thread_index() != 0) {
+            while (!static_db) {
+                MEMORY_FENCE_LOAD();
+                sched_yield();
+            }
+
+            while (!static_keys) {
+                MEMORY_FENCE_LOAD();
+                sched_yield();
+            }
+        }
+
+        this->_db = (storage_db*)static_db;
+        this->_workers_count = state.threads();
+        this->_keys = (char **)static_keys;
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        if (state.thread_index() != 0) {
+            return;
+        }
+
+        if (this->_db != nullptr) {
+            storage_db_free(this->_db, this->_workers_count);
+        }
+
+        if (this->_keys != nullptr) {
+            for(uint32_t index = 0; index < this->_keys_count; index++) {
+                xalloc_free(this->_keys[index]);
+            }
+            xalloc_free(this->_keys);
+        }
+
+        this->_db = nullptr;
+        this->_workers_count = 0;
+        this->_keys = nullptr;
+        this->_keys_count = 0;
+
+        static_db = nullptr;
+        static_keys = nullptr;
+    }
+};
+
+static worker_context_t *bench_storage_db_op_lock_keys_setup_worker_context(
+        benchmark::State& state,
+        storage_db *db,
+        uint32_t workers_count) {
+    worker_context_t *worker_context;
+
+    // The worker_context is stored in a thread variable and the threads are managed internally by the benchmarking
+    // library, they can be recycled or re-created
+    if ((worker_context = worker_context_get()) == nullptr) {
+        // This assigned memory will be lost but this is a benchmark and we don't care
+        worker_context = (worker_context_t *)xalloc_alloc(sizeof(worker_context_t));
+        worker_context_set(worker_context);
+    }
+
+    worker_context->worker_index = state.thread_index();
+    worker_context->workers_count = workers_count;
+    worker_context->db = db;
+
+    transaction_set_worker_index(worker_context->worker_index);
+
+    return worker_context;
+}
+
+static void bench_storage_db_op_lock_keys_pick_keys(
+        uint64_t *random_state,
+        uint32_t keys_count,
+        uint32_t *key_indexes,
+        uint32_t key_indexes_count) {
+    for(uint32_t index = 0; index < key_indexes_count; index++) {
+        // xorshift64, it's enough to spread the blocks over the hot keys
+        *random_state ^= *random_state << 13;
+        *random_state ^= *random_state >> 7;
+        *random_state ^= *random_state << 17;
+        key_indexes[index] = *random_state % keys_count;
+    }
+}
+
+static bool bench_storage_db_op_lock_keys_set(
+        storage_db *db,
+        transaction_t *transaction,
+        char *key,
+        char *value,
+        size_t value_length) {
+    storage_db_chunk_sequence_t chunk_sequence = { 0 };
+    size_t key_length = strlen(key);
+
+    // The storage db takes the ownership of the key and of the value
+    char *key_copy = (char*)xalloc_alloc(key_length);
+    memcpy(key_copy, key, key_length);
+
+    if (!storage_db_chunk_sequence_allocate(db, &chunk_sequence, value_length)) {
+        xalloc_free(key_copy);
+        return false;
+    }
+
+    storage_db_chunk_write(db, storage_db_chunk_sequence_get(&chunk_sequence, 0), 0, value, value_length);
+
+    if (!storage_db_op_set(
+            db,
+            0,
+            transaction,
+            key_copy,
+            key_length,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+            &chunk_sequence,
+            STORAGE_DB_ENTRY_NO_EXPIRY)) {
+        xalloc_free(key_copy);
+        storage_db_chunk_sequence_free_chunks(db, &chunk_sequence);
+        return false;
+    }
+
+    return true;
+}
+
+BENCHMARK_DEFINE_F(StorageDbOpLockKeysFixture, storage_db_lock_keys_for_write_atomic_block)(benchmark::State& state) {
+    char value[TEST_VALUE_LENGTH] = { 0 };
+    uint32_t key_indexes[TEST_KEYS_PER_BLOCK_MAX];
+    storage_db_key_lock_index_t key_lock_indexes[TEST_KEYS_PER_BLOCK_MAX];
+    uint32_t keys_per_block = state.range(1);
+    uint64_t random_state = 0x9E3779B97F4A7C15ull + state.thread_index();
+    char **keys = this->GetKeys();
+    storage_db *db = this->GetDb();
+
+    test_support_set_thread_affinity(state.thread_index());
+    bench_storage_db_op_lock_keys_setup_worker_context(state, db, this->GetWorkersCount());
+    memset(value, 'a', sizeof(value));
+
+    for (auto _ : state) {
+        transaction_t transaction = { 0 };
+
+        bench_storage_db_op_lock_keys_pick_keys(&random_state, this->GetKeysCount(), key_indexes, keys_per_block);
+
+        // Same sequence of operations carried out by EXEC, all the keys are locked upfront and held till the end
+        transaction_acquire(&transaction);
+
+        for(uint32_t index = 0; index < keys_per_block; index++) {
+            key_lock_indexes[index] = storage_db_get_key_lock_index(
+                    db,
+                    0,
+                    keys[key_indexes[index]],
+                    strlen(keys[key_indexes[index]]));
+        }
+
+        if (!storage_db_lock_keys_for_write(db, &transaction, key_lock_indexes, keys_per_block)) {
+            transaction_release(&transaction);
+            state.SkipWithError("Unable to lock the keys");
+            break;
+        }
+
+        for(uint32_t index = 0; index < keys_per_block; index++) {
+            if (!bench_storage_db_op_lock_keys_set(db, &transaction, keys[key_indexes[index]], value, sizeof(value))) {
+                state.SkipWithError("Unable to set the key");
+                break;
+            }
+        }
+
+        transaction_release(&transaction);
+    }
+
+    state.SetItemsProcessed(state.iterations() * keys_per_block);
+}
+
+BENCHMARK_DEFINE_F(StorageDbOpLockKeysFixture, storage_db_op_set_per_key)(benchmark::State& state) {
+    char value[TEST_VALUE_LENGTH] = { 0 };
+    uint32_t key_indexes[TEST_KEYS_PER_BLOCK_MAX];
+    uint32_t keys_per_block = state.range(1);
+    uint64_t random_state = 0x9E3779B97F4A7C15ull + state.thread_index();
+    char **keys = this->GetKeys();
+    storage_db *db = this->GetDb();
+
+    test_support_set_thread_affinity(state.thread_index());
+    bench_storage_db_op_lock_keys_setup_worker_context(state, db, this->GetWorkersCount());
+    memset(value, 'a', sizeof(value));
+
+    for (auto _ : state) {
+        bench_storage_db_op_lock_keys_pick_keys(&random_state, this->GetKeysCount(), key_indexes, keys_per_block);
+
+        // Each key is updated with its own transaction, the block is not atomic
+        for(uint32_t index = 0; index < keys_per_block; index++) {
+            transaction_t transaction = { 0 };
+            transaction_acquire(&transaction);
+
+            bool result = bench_storage_db_op_lock_keys_set(
+                    db,
+                    &transaction,
+                    keys[key_indexes[index]],
+                    value,
+                    sizeof(value));
+
+            transaction_release(&transaction);
+
+            if (!result) {
+                state.SkipWithError("Unable to set the key");
+                break;
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * keys_per_block);
+}
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b
+            ->ArgsProduct({
+                                  { 16, 256, 4096 },
+                                  { 1, 4, TEST_KEYS_PER_BLOCK_MAX },
+                          })
+            ->ThreadRange(TEST_THREADS_RANGE_BEGIN, TEST_THREADS_RANGE_END)
+            ->UseRealTime();
+}
+
+BENCHMARK_REGISTER_F(StorageDbOpLockKeysFixture, storage_db_lock_keys_for_write_atomic_block)
+        ->Apply(BenchArguments);
+
+BENCHMARK_REGISTER_F(StorageDbOpLockKeysFixture, storage_db_op_set_per_key)
+        ->Apply(BenchArguments);
@@ -0,0 +1,171 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstdlib>
+#include <numa.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark-program-simple.hpp"
+
+#include "cmake_config.h"
+#include "utils_bitmap.h"
+
+// The buffers are filled with pseudo random bytes, the length is passed as argument and goes up to the size of a chunk
+// of the storage as the bitmap commands process the values one chunk at time
+class BitmapFixture : public benchmark::Fixture {
+private:
+    uint8_t *destination = nullptr;
+    uint8_t *source = nullptr;
+    size_t length = 0;
+
+public:
+    uint8_t* GetDestination() {
+        return this->destination;
+    }
+
+    uint8_t* GetSource() {
+        return this->source;
+    }
+
+    size_t GetLength() {
+        return this->length;
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        uint32_t seed = 0x12345678;
+        this->length = (size_t)state.range(0);
+
+        this->destination = (uint8_t*)malloc(this->length);
+        this->source = (uint8_t*)malloc(this->length);
+
+        for(size_t index = 0; index < this->length; index++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            this->destination[index] = (uint8_t)seed;
+            this->source[index] = (uint8_t)(seed >> 8);
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        free(this->destination);
+        free(this->source);
+        this->length = 0;
+    }
+};
+
+BENCHMARK_DEFINE_F(BitmapFixture, PopcountLoop)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(UTILS_BITMAP_NAME_IMPL(popcount, loop)(
+                this->GetSource(),
+                this->GetLength()));
+    }
+
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)this->GetLength());
+}
+
+BENCHMARK_DEFINE_F(BitmapFixture, BitopXorLoop)(benchmark::State& state) {
+    for (auto _ : state) {
+        UTILS_BITMAP_NAME_IMPL(bitop, loop)(
+                UTILS_BITMAP_OP_XOR,
+                this->GetDestination(),
+                this->GetSource(),
+                this->GetLength());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)this->GetLength());
+}
+
+#if defined(__x86_64__)
+BENCHMARK_DEFINE_F(BitmapFixture, PopcountAvx2)(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx2")) {
+        state.SkipWithError("AVX2 not supported");
+        return;
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(UTILS_BITMAP_NAME_IMPL(popcount, avx2)(
+                this->GetSource(),
+                this->GetLength()));
+    }
+
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)this->GetLength());
+}
+
+BENCHMARK_DEFINE_F(BitmapFixture, BitopXorAvx2)(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx2")) {
+        state.SkipWithError("AVX2 not supported");
+        return;
+    }
+
+    for (auto _ : state) {
+        UTILS_BITMAP_NAME_IMPL(bitop, avx2)(
+                UTILS_BITMAP_OP_XOR,
+                this->GetDestination(),
+                this->GetSource(),
+                this->GetLength());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)this->GetLength());
+}
+
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+BENCHMARK_DEFINE_F(BitmapFixture, PopcountAvx512)(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx512vpopcntdq")) {
+        state.SkipWithError("AVX512 VPOPCNTDQ not supported");
+        return;
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(UTILS_BITMAP_NAME_IMPL(popcount, avx512)(
+                this->GetSource(),
+                this->GetLength()));
+    }
+
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)this->GetLength());
+}
+
+BENCHMARK_DEFINE_F(BitmapFixture, BitopXorAvx512)(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx512f")) {
+        state.SkipWithError("AVX512F not supported");
+        return;
+    }
+
+    for (auto _ : state) {
+        UTILS_BITMAP_NAME_IMPL(bitop, avx512)(
+                UTILS_BITMAP_OP_XOR,
+                this->GetDestination(),
+                this->GetSource(),
+                this->GetLength());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)this->GetLength());
+}
+#endif
+#endif
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(4)->Range(64, 64 * 1024);
+}
+
+BENCHMARK_REGISTER_F(BitmapFixture, PopcountLoop)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(BitmapFixture, BitopXorLoop)->Apply(BenchArguments);
+#if defined(__x86_64__)
+BENCHMARK_REGISTER_F(BitmapFixture, PopcountAvx2)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(BitmapFixture, BitopXorAvx2)->Apply(BenchArguments);
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+BENCHMARK_REGISTER_F(BitmapFixture, PopcountAvx512)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(BitmapFixture, BitopXorAvx512)->Apply(BenchArguments);
+#endif
+#endif
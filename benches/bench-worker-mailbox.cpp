@@ -0,0 +1,191 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstring>
+#include <pthread.h>
+#include <liburing.h>
+#include <benchmark/benchmark.h>
+
+#include "benchmark-program.hpp"
+#include "benchmark-support.hpp"
+
+#include "exttypes.h"
+#include "memory_fences.h"
+#include "spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "support/io_uring/io_uring_support.h"
+#include "support/io_uring/io_uring_capabilities.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_mailbox.h"
+
+#define BENCH_WORKER_MAILBOX_QUEUE_SIZE (4096)
+#define BENCH_WORKER_MAILBOX_RING_ENTRIES (64)
+
+// The throughput benchmark measures the cost of posting closures from one worker to another through the spsc queues,
+// the receiver drains them inline as the mailbox fiber would do. The latency benchmark measures a round trip between
+// two threads woken up via IORING_OP_MSG_RING, which is the path followed when the receiver is idle.
+
+typedef struct bench_worker_mailbox_thread_context bench_worker_mailbox_thread_context_t;
+struct bench_worker_mailbox_thread_context {
+    worker_mailbox_t *mailbox;
+    io_uring_t *ring;
+    io_uring_t *peer_ring;
+    bool_volatile_t ready;
+    bool_volatile_t stop;
+};
+
+void bench_worker_mailbox_message_noop(void *user_data) {
+    (*(uint64_t*)user_data)++;
+}
+
+void *bench_worker_mailbox_consumer_thread_func(void *user_data) {
+    auto context = (bench_worker_mailbox_thread_context_t*)user_data;
+
+    context->ready = true;
+    MEMORY_FENCE_STORE();
+
+    do {
+        MEMORY_FENCE_LOAD();
+        worker_mailbox_process(context->mailbox, 1, false);
+    } while(!context->stop);
+
+    // Drain what's left
+    worker_mailbox_process(context->mailbox, 1, false);
+
+    return nullptr;
+}
+
+static void BM_WorkerMailbox_Throughput(benchmark::State& state) {
+    pthread_t consumer_thread;
+    uint64_t counter = 0;
+    bench_worker_mailbox_thread_context_t context = { nullptr };
+    bool wakeup_required;
+
+    context.mailbox = worker_mailbox_new(2, BENCH_WORKER_MAILBOX_QUEUE_SIZE);
+    pthread_create(&consumer_thread, nullptr, bench_worker_mailbox_consumer_thread_func, &context);
+
+    do {
+        MEMORY_FENCE_LOAD();
+    } while(!context.ready);
+
+    for (auto _ : state) {
+        while(!worker_mailbox_enqueue(
+                context.mailbox,
+                0,
+                1,
+                bench_worker_mailbox_message_noop,
+                &counter,
+                &wakeup_required)) {
+            // The queue is full, wait for the consumer
+        }
+    }
+
+    context.stop = true;
+    MEMORY_FENCE_STORE();
+    pthread_join(consumer_thread, nullptr);
+
+    state.SetItemsProcessed((int64_t)state.iterations());
+
+    worker_mailbox_free(context.mailbox);
+}
+
+void *bench_worker_mailbox_pong_thread_func(void *user_data) {
+    io_uring_cqe_t *cqe;
+    auto context = (bench_worker_mailbox_thread_context_t*)user_data;
+
+    context->ready = true;
+    MEMORY_FENCE_STORE();
+
+    while(true) {
+        if (io_uring_wait_cqe(context->ring, &cqe) < 0) {
+            break;
+        }
+
+        uint64_t cqe_user_data = cqe->user_data;
+        io_uring_cqe_seen(context->ring, cqe);
+
+        // The cqes with user data set to 0 are the completions of the msg ring operations sent by this thread
+        if (cqe_user_data == 0) {
+            continue;
+        }
+
+        MEMORY_FENCE_LOAD();
+        if (context->stop) {
+            break;
+        }
+
+        io_uring_support_sqe_enqueue_msg_ring(context->ring, context->peer_ring->ring_fd, 0, 1, 0, 0);
+        io_uring_submit(context->ring);
+    }
+
+    return nullptr;
+}
+
+static void BM_WorkerMailbox_MsgRing_PingPong_Latency(benchmark::State& state) {
+    pthread_t pong_thread;
+    io_uring_t ring_ping, ring_pong;
+    io_uring_cqe_t *cqe;
+    bench_worker_mailbox_thread_context_t context = { nullptr };
+
+    if (!io_uring_capabilities_is_msg_ring_supported()) {
+        state.SkipWithError("IORING_OP_MSG_RING not supported");
+        return;
+    }
+
+    io_uring_queue_init(BENCH_WORKER_MAILBOX_RING_ENTRIES, &ring_ping, 0);
+    io_uring_queue_init(BENCH_WORKER_MAILBOX_RING_ENTRIES, &ring_pong, 0);
+
+    context.ring = &ring_pong;
+    context.peer_ring = &ring_ping;
+    pthread_create(&pong_thread, nullptr, bench_worker_mailbox_pong_thread_func, &context);
+
+    do {
+        MEMORY_FENCE_LOAD();
+    } while(!context.ready);
+
+    for (auto _ : state) {
+        io_uring_support_sqe_enqueue_msg_ring(&ring_ping, ring_pong.ring_fd, 0, 1, 0, 0);
+        io_uring_submit(&ring_ping);
+
+        // Wait for the pong, skipping the completion of the msg ring operation
+        while(true) {
+            io_uring_wait_cqe(&ring_ping, &cqe);
+            uint64_t cqe_user_data = cqe->user_data;
+            io_uring_cqe_seen(&ring_ping, cqe);
+
+            if (cqe_user_data != 0) {
+                break;
+            }
+        }
+    }
+
+    context.stop = true;
+    MEMORY_FENCE_STORE();
+    io_uring_support_sqe_enqueue_msg_ring(&ring_ping, ring_pong.ring_fd, 0, 1, 0, 0);
+    io_uring_submit(&ring_ping);
+    pthread_join(pong_thread, nullptr);
+
+    state.SetItemsProcessed((int64_t)state.iterations());
+
+    io_uring_queue_exit(&ring_ping);
+    io_uring_queue_exit(&ring_pong);
+}
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b->UseRealTime();
+}
+
+BENCHMARK(BM_WorkerMailbox_Throughput)
+    ->Apply(BenchArguments);
+BENCHMARK(BM_WorkerMailbox_MsgRing_PingPong_Latency)
+    ->Apply(BenchArguments);
@@ -14,6 +14,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <arpa/inet.h>
+#include <sys/un.h>
 #include <sys/statvfs.h>
 #include <sys/sysinfo.h>
 #include <cyaml/cyaml.h>
@@ -513,6 +514,53 @@ bool config_validate_after_load_database(
     return return_result;
 }
 
+bool config_validate_after_load_network_polling(
+        config_t* config) {
+    bool return_result = true;
+    config_network_polling_t *polling = config->network->polling;
+
+    if (polling == NULL) {
+        return true;
+    }
+
+    if (polling->mode != CONFIG_NETWORK_POLLING_MODE_SQPOLL &&
+        (polling->sqpoll_shared || polling->sqpoll_idle_ms > 0)) {
+        LOG_E(
+                TAG,
+                "The network polling settings <sqpoll_shared> and <sqpoll_idle_ms> require the polling mode <sqpoll>");
+        return_result = false;
+    }
+
+    return return_result;
+}
+
+bool config_validate_after_load_network_rebalancing(
+        config_t* config) {
+    bool return_result = true;
+    config_network_rebalancing_t *rebalancing = config->network->rebalancing;
+
+    if (rebalancing == NULL) {
+        return true;
+    }
+
+    if (rebalancing->interval_ms == 0 || rebalancing->max_migrations_per_interval == 0) {
+        LOG_E(
+                TAG,
+                "The network rebalancing settings <interval_ms> and <max_migrations_per_interval> must be greater "
+                "than zero");
+        return_result = false;
+    }
+
+    if (rebalancing->imbalance_threshold_percent == 0 || rebalancing->imbalance_threshold_percent > 100) {
+        LOG_E(
+                TAG,
+                "The network rebalancing setting <imbalance_threshold_percent> must be between 1 and 100");
+        return_result = false;
+    }
+
+    return return_result;
+}
+
 bool config_validate_after_load_modules_network_timeout(
         config_module_t *module) {
     bool return_result = true;
@@ -544,6 +592,47 @@ bool config_validate_after_load_modules_network_bindings(
     for(int binding_index = 0; binding_index < module->network->bindings_count; binding_index++) {
         config_module_network_binding_t *binding = &module->network->bindings[binding_index];
 
+        // A binding is either a TCP binding (host and port) or a UNIX socket binding (path)
+        if ((binding->host == NULL) == (binding->path == NULL)) {
+            LOG_E(
+                    TAG,
+                    "In module <%s>, a binding must have either the host and the port or the path",
+                    module->type);
+            return_result = false;
+            continue;
+        }
+
+        if (binding->path) {
+            if (strlen(binding->path) >= sizeof(((struct sockaddr_un*)0)->sun_path)) {
+                LOG_E(
+                        TAG,
+                        "In module <%s>, the path <%s> of the binding is too long",
+                        module->type,
+                        binding->path);
+                return_result = false;
+            }
+
+            if (binding->tls) {
+                LOG_E(
+                        TAG,
+                        "In module <%s>, the binding <%s> is a UNIX socket, tls is not supported",
+                        module->type,
+                        binding->path);
+                return_result = false;
+            }
+
+            continue;
+        }
+
+        if (binding->port == 0) {
+            LOG_E(
+                    TAG,
+                    "In module <%s>, the binding <%s> requires a port",
+                    module->type,
+                    binding->host);
+            return_result = false;
+        }
+
         // Ensure that if the binding requires tls than tls is enabled
         if (binding->tls && tls_enabled == false) {
             LOG_E(
@@ -641,6 +730,25 @@ bool config_validate_after_load_modules_network_keepalive(
     return return_result;
 }
 
+bool config_validate_after_load_modules_network_output_buffer_limits(
+        config_module_t *module) {
+    config_module_network_output_buffer_limits_t *limits = module->network->output_buffer_limits;
+
+    if (limits == NULL || limits->soft == NULL) {
+        return true;
+    }
+
+    if (limits->soft->max_size > limits->hard->max_size) {
+        LOG_E(
+                TAG,
+                "In module <%s>, the soft output buffer limit has to be lower or equal than the hard limit",
+                module->type);
+        return false;
+    }
+
+    return true;
+}
+
 bool config_validate_after_load_modules_config_valid(
         config_t *config,
         config_module_t *config_module) {
@@ -677,6 +785,7 @@ bool config_validate_after_load_modules(
         if (config_validate_after_load_modules_config_valid(config, config_module) == false
             || config_validate_after_load_modules_network_timeout(config_module) == false
             || config_validate_after_load_modules_network_keepalive(config_module) == false
+            || config_validate_after_load_modules_network_output_buffer_limits(config_module) == false
             || config_validate_after_load_modules_network_tls(config_module) == false
             || config_validate_after_load_modules_network_bindings(config_module) == false) {
             return_result = false;
@@ -731,6 +840,8 @@ bool config_validate_after_load(
         || config_validate_after_load_database_limits(config) == false
         || config_validate_after_load_database_keys_eviction(config) == false
         || config_validate_after_load_database(config) == false
+        || config_validate_after_load_network_polling(config) == false
+        || config_validate_after_load_network_rebalancing(config) == false
         || config_validate_after_load_modules(config) == false
         || config_validate_after_load_logs(config) == false) {
         return_result = false;
@@ -1190,6 +1301,138 @@ bool config_process_string_values(
         }
     }
 
+    for(int module_index = 0; module_index < config->modules_count; module_index++) {
+        config_module_t *config_module = &config->modules[module_index];
+        config_module_network_output_buffer_limits_t *output_buffer_limits =
+                config_module->network->output_buffer_limits;
+
+        if (output_buffer_limits) {
+            // Convert the string value of the output buffer limits into a numeric value, only absolute values and size
+            // suffixes (e.g. GB, MB, KB, etc.) are allowed as there is nothing a percentage can be calculated from
+            bool result = config_parse_string_absolute_or_percent(
+                    output_buffer_limits->hard->max_size_str,
+                    strlen(output_buffer_limits->hard->max_size_str),
+                    false,
+                    false,
+                    false,
+                    true,
+                    true,
+                    &output_buffer_limits->hard->max_size,
+                    &return_value_type);
+
+            if (!result) {
+                LOG_E(TAG, "In module <%s>, failed to parse the hard output buffer limit", config_module->type);
+                return false;
+            }
+
+            if (output_buffer_limits->soft) {
+                result = config_parse_string_absolute_or_percent(
+                        output_buffer_limits->soft->max_size_str,
+                        strlen(output_buffer_limits->soft->max_size_str),
+                        false,
+                        false,
+                        false,
+                        true,
+                        true,
+                        &output_buffer_limits->soft->max_size,
+                        &return_value_type);
+
+                if (!result) {
+                    LOG_E(TAG, "In module <%s>, failed to parse the soft output buffer limit", config_module->type);
+                    return false;
+                }
+
+                result = config_parse_string_time(
+                        output_buffer_limits->soft->max_duration_str,
+                        strlen(output_buffer_limits->soft->max_duration_str),
+                        false,
+                        false,
+                        true,
+                        &output_buffer_limits->soft->max_duration_ms);
+
+                if (!result) {
+                    LOG_E(
+                            TAG,
+                            "In module <%s>, failed to parse the soft output buffer limit max duration",
+                            config_module->type);
+                    return false;
+                }
+
+                // The returned time is in seconds, so multiply by 1000 to convert to ms
+                output_buffer_limits->soft->max_duration_ms *= 1000;
+            }
+        }
+
+        config_module_network_tls_session_resumption_t *session_resumption =
+                config_module->network->tls ? config_module->network->tls->session_resumption : NULL;
+
+        if (session_resumption) {
+            // If the lifetime or the timeout are not set they are left to zero and the defaults will be used
+            session_resumption->tickets_lifetime_s = 0;
+            if (session_resumption->tickets_lifetime_str) {
+                bool result = config_parse_string_time(
+                        session_resumption->tickets_lifetime_str,
+                        strlen(session_resumption->tickets_lifetime_str),
+                        false,
+                        false,
+                        true,
+                        &session_resumption->tickets_lifetime_s);
+
+                if (!result) {
+                    LOG_E(
+                            TAG,
+                            "In module <%s>, failed to parse the tls session tickets lifetime",
+                            config_module->type);
+                    return false;
+                }
+            }
+
+            session_resumption->cache_timeout_s = 0;
+            if (session_resumption->cache_timeout_str) {
+                bool result = config_parse_string_time(
+                        session_resumption->cache_timeout_str,
+                        strlen(session_resumption->cache_timeout_str),
+                        false,
+                        false,
+                        true,
+                        &session_resumption->cache_timeout_s);
+
+                if (!result) {
+                    LOG_E(
+                            TAG,
+                            "In module <%s>, failed to parse the tls session cache timeout",
+                            config_module->type);
+                    return false;
+                }
+            }
+        }
+
+        for(int binding_index = 0; binding_index < config_module->network->bindings_count; binding_index++) {
+            config_module_network_binding_t *binding = &config_module->network->bindings[binding_index];
+
+            binding->permissions = 0;
+            if (binding->permissions_str == NULL) {
+                continue;
+            }
+
+            // The permissions are expressed in octal, as for chmod
+            char *end_ptr = NULL;
+            errno = 0;
+            unsigned long permissions = strtoul(binding->permissions_str, &end_ptr, 8);
+
+            if (errno != 0 || end_ptr == binding->permissions_str || *end_ptr != 0 || permissions > 07777) {
+                LOG_E(
+                        TAG,
+                        "In module <%s>, failed to parse the permissions <%s> of the binding",
+                        config_module->type,
+                        binding->permissions_str);
+                return false;
+            }
+
+            binding->permissions = (uint32_t)permissions;
+        }
+    }
+
     return true;
 }
 
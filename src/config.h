@@ -39,6 +39,12 @@ enum config_network_backend {
 };
 typedef enum config_network_backend config_network_backend_t;
 
+enum config_network_polling_mode {
+    CONFIG_NETWORK_POLLING_MODE_INTERRUPT,
+    CONFIG_NETWORK_POLLING_MODE_SQPOLL,
+};
+typedef enum config_network_polling_mode config_network_polling_mode_t;
+
 enum config_module_network_tls_min_version {
     CONFIG_MODULE_NETWORK_TLS_MIN_VERSION_ANY,
     CONFIG_MODULE_NETWORK_TLS_MIN_VERSION_TLS_1_0,
@@ -68,6 +74,9 @@ typedef struct config_module_network_binding config_module_network_binding_t;
 struct config_module_network_binding {
     char *host;
     uint16_t port;
+    char *path;
+    char *permissions_str;
+    uint32_t permissions;
     bool tls;
 };
 
@@ -84,6 +93,37 @@ struct config_module_network_keepalive {
     uint32_t probes;
 };
 
+typedef struct config_module_network_output_buffer_limits_hard config_module_network_output_buffer_limits_hard_t;
+struct config_module_network_output_buffer_limits_hard {
+    char *max_size_str;
+    int64_t max_size;
+};
+
+typedef struct config_module_network_output_buffer_limits_soft config_module_network_output_buffer_limits_soft_t;
+struct config_module_network_output_buffer_limits_soft {
+    char *max_size_str;
+    int64_t max_size;
+    char *max_duration_str;
+    int64_t max_duration_ms;
+};
+
+typedef struct config_module_network_output_buffer_limits config_module_network_output_buffer_limits_t;
+struct config_module_network_output_buffer_limits {
+    config_module_network_output_buffer_limits_hard_t *hard;
+    config_module_network_output_buffer_limits_soft_t *soft;
+};
+
+typedef struct config_module_network_tls_session_resumption config_module_network_tls_session_resumption_t;
+struct config_module_network_tls_session_resumption {
+    bool tickets;
+    char *tickets_lifetime_str;
+    int64_t tickets_lifetime_s;
+    bool cache;
+    uint32_t cache_max_entries;
+    char *cache_timeout_str;
+    int64_t cache_timeout_s;
+};
+
 typedef struct config_module_network_tls config_module_network_tls_t;
 struct config_module_network_tls {
     char *certificate_path;
@@ -94,6 +134,7 @@ struct config_module_network_tls {
     config_module_network_tls_min_version_t min_version;
     config_module_network_tls_max_version_t max_version;
     bool verify_client_certificate;
+    config_module_network_tls_session_resumption_t *session_resumption;
 };
 
 typedef struct config_module_redis config_module_redis_t;
@@ -114,6 +155,7 @@ struct config_module_network {
     config_module_network_timeout_t *timeout;
     config_module_network_keepalive_t *keepalive;
     config_module_network_tls_t *tls;
+    config_module_network_output_buffer_limits_t *output_buffer_limits;
 
     config_module_network_binding_t *bindings;
     unsigned bindings_count;
@@ -147,11 +189,29 @@ struct config_sentry {
     char *dsn;
 };
 
+typedef struct config_network_polling config_network_polling_t;
+struct config_network_polling {
+    config_network_polling_mode_t mode;
+    uint32_t sqpoll_idle_ms;
+    bool sqpoll_shared;
+    uint32_t busy_poll_us;
+    uint32_t spin_before_sleep_us;
+};
+
+typedef struct config_network_rebalancing config_network_rebalancing_t;
+struct config_network_rebalancing {
+    uint32_t interval_ms;
+    uint32_t imbalance_threshold_percent;
+    uint32_t max_migrations_per_interval;
+};
+
 typedef struct config_network config_network_t;
 struct config_network {
     config_network_backend_t backend;
     uint32_t max_clients;
     uint32_t listen_backlog;
+    config_network_polling_t *polling;
+    config_network_rebalancing_t *rebalancing;
 };
 enum config_database_keys_eviction_policy {
     CONFIG_DATABASE_KEYS_EVICTION_POLICY_LRU,
@@ -352,6 +412,12 @@ bool config_validate_after_load_database_backend_memory(
 bool config_validate_after_load_database_keys_eviction(
         config_t* config);
 
+bool config_validate_after_load_network_polling(
+        config_t* config);
+
+bool config_validate_after_load_network_rebalancing(
+        config_t* config);
+
 bool config_validate_after_load_modules_network_timeout(
         config_module_t *module);
 
@@ -361,6 +427,9 @@ bool config_validate_after_load_modules_network_bindings(
 bool config_validate_after_load_modules_network_tls(
         config_module_t *module);
 
+bool config_validate_after_load_modules_network_output_buffer_limits(
+        config_module_t *module);
+
 bool config_validate_after_load_modules(
         config_t* config);
 
@@ -25,11 +25,17 @@ const cyaml_schema_value_t config_generic_string_schema = {
 // Schema for config -> modules -> module -> network -> bindings -> binding
 const cyaml_schema_field_t config_module_binding_schema[] = {
         CYAML_FIELD_STRING_PTR(
-                "host", CYAML_FLAG_POINTER,
+                "host", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
                 config_module_network_binding_t, host, 0, CYAML_UNLIMITED),
         CYAML_FIELD_UINT(
-                "port", CYAML_FLAG_DEFAULT,
+                "port", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
                 config_module_network_binding_t, port),
+        CYAML_FIELD_STRING_PTR(
+                "path", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
+                config_module_network_binding_t, path, 0, CYAML_UNLIMITED),
+        CYAML_FIELD_STRING_PTR(
+                "permissions", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
+                config_module_network_binding_t, permissions_str, 0, CYAML_UNLIMITED),
         CYAML_FIELD_BOOL(
                 "tls", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
                 config_module_network_binding_t, tls),
@@ -61,6 +67,58 @@ const cyaml_schema_field_t config_module_network_keepalive_schema[] = {
         CYAML_FIELD_END
 };
 
+// Schema for config -> modules -> module -> network -> output_buffer_limits -> hard
+const cyaml_schema_field_t config_module_network_output_buffer_limits_hard_schema[] = {
+        CYAML_FIELD_STRING_PTR(
+                "max_size", CYAML_FLAG_DEFAULT,
+                config_module_network_output_buffer_limits_hard_t, max_size_str, 0, 20),
+        CYAML_FIELD_END
+};
+
+// Schema for config -> modules -> module -> network -> output_buffer_limits -> soft
+const cyaml_schema_field_t config_module_network_output_buffer_limits_soft_schema[] = {
+        CYAML_FIELD_STRING_PTR(
+                "max_size", CYAML_FLAG_DEFAULT,
+                config_module_network_output_buffer_limits_soft_t, max_size_str, 0, 20),
+        CYAML_FIELD_STRING_PTR(
+                "max_duration", CYAML_FLAG_DEFAULT,
+                config_module_network_output_buffer_limits_soft_t, max_duration_str, 0, 20),
+        CYAML_FIELD_END
+};
+
+// Schema for config -> modules -> module -> network -> output_buffer_limits
+const cyaml_schema_field_t config_module_network_output_buffer_limits_schema[] = {
+        CYAML_FIELD_MAPPING_PTR(
+                "hard", CYAML_FLAG_POINTER,
+                config_module_network_output_buffer_limits_t, hard,
+                config_module_network_output_buffer_limits_hard_schema),
+        CYAML_FIELD_MAPPING_PTR(
+                "soft", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
+                config_module_network_output_buffer_limits_t, soft,
+                config_module_network_output_buffer_limits_soft_schema),
+        CYAML_FIELD_END
+};
+
+// Schema for config -> modules -> module -> network -> tls -> session_resumption
+const cyaml_schema_field_t config_module_network_tls_session_resumption_schema[] = {
+        CYAML_FIELD_BOOL(
+                "tickets", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_module_network_tls_session_resumption_t, tickets),
+        CYAML_FIELD_STRING_PTR(
+                "tickets_lifetime", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_module_network_tls_session_resumption_t, tickets_lifetime_str, 0, 20),
+        CYAML_FIELD_BOOL(
+                "cache", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_module_network_tls_session_resumption_t, cache),
+        CYAML_FIELD_UINT(
+                "cache_max_entries", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_module_network_tls_session_resumption_t, cache_max_entries),
+        CYAML_FIELD_STRING_PTR(
+                "cache_timeout", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_module_network_tls_session_resumption_t, cache_timeout_str, 0, 20),
+        CYAML_FIELD_END
+};
+
 // Schema for config -> modules -> module -> network -> tls
 const cyaml_schema_field_t config_module_network_tls_schema[] = {
         CYAML_FIELD_STRING_PTR(
@@ -87,6 +145,9 @@ const cyaml_schema_field_t config_module_network_tls_schema[] = {
                 "max_version", CYAML_FLAG_DEFAULT | CYAML_FLAG_STRICT | CYAML_FLAG_OPTIONAL,
                 config_module_network_tls_t, max_version, config_module_network_tls_max_version_schema_strings,
                 CYAML_ARRAY_LEN(config_module_network_tls_max_version_schema_strings)),
+        CYAML_FIELD_MAPPING_PTR(
+                "session_resumption", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
+                config_module_network_tls_t, session_resumption, config_module_network_tls_session_resumption_schema),
         CYAML_FIELD_END
 };
 
@@ -137,6 +198,9 @@ const cyaml_schema_field_t config_module_network_fields_schema[] = {
         CYAML_FIELD_MAPPING_PTR(
                 "tls", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
                 config_module_network_t, tls, config_module_network_tls_schema),
+        CYAML_FIELD_MAPPING_PTR(
+                "output_buffer_limits", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
+                config_module_network_t, output_buffer_limits, config_module_network_output_buffer_limits_schema),
         CYAML_FIELD_SEQUENCE(
                 "bindings", CYAML_FLAG_POINTER,
                 config_module_network_t, bindings, &config_module_network_protocol_binding_list_schema, 0, CYAML_UNLIMITED),
@@ -172,6 +236,47 @@ const cyaml_strval_t config_network_backend_schema_strings[] = {
         { "io_uring", CONFIG_NETWORK_BACKEND_IO_URING },
 };
 
+// Allowed strings for config -> network -> polling -> mode
+const cyaml_strval_t config_network_polling_mode_schema_strings[] = {
+        { "interrupt", CONFIG_NETWORK_POLLING_MODE_INTERRUPT },
+        { "sqpoll", CONFIG_NETWORK_POLLING_MODE_SQPOLL },
+};
+
+// Schema for config -> network -> polling
+const cyaml_schema_field_t config_network_polling_schema[] = {
+        CYAML_FIELD_ENUM(
+                "mode", CYAML_FLAG_DEFAULT | CYAML_FLAG_STRICT,
+                config_network_polling_t, mode, config_network_polling_mode_schema_strings,
+                CYAML_ARRAY_LEN(config_network_polling_mode_schema_strings)),
+        CYAML_FIELD_UINT(
+                "sqpoll_idle_ms", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_network_polling_t, sqpoll_idle_ms),
+        CYAML_FIELD_BOOL(
+                "sqpoll_shared", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_network_polling_t, sqpoll_shared),
+        CYAML_FIELD_UINT(
+                "busy_poll_us", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_network_polling_t, busy_poll_us),
+        CYAML_FIELD_UINT(
+                "spin_before_sleep_us", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_network_polling_t, spin_before_sleep_us),
+        CYAML_FIELD_END
+};
+
+// Schema for config -> network -> rebalancing
+const cyaml_schema_field_t config_network_rebalancing_schema[] = {
+        CYAML_FIELD_UINT(
+                "interval_ms", CYAML_FLAG_DEFAULT,
+                config_network_rebalancing_t, interval_ms),
+        CYAML_FIELD_UINT(
+                "imbalance_threshold_percent", CYAML_FLAG_DEFAULT,
+                config_network_rebalancing_t, imbalance_threshold_percent),
+        CYAML_FIELD_UINT(
+                "max_migrations_per_interval", CYAML_FLAG_DEFAULT,
+                config_network_rebalancing_t, max_migrations_per_interval),
+        CYAML_FIELD_END
+};
+
 // Schema for config -> network
 const cyaml_schema_field_t config_network_schema[] = {
         CYAML_FIELD_ENUM(
@@ -184,6 +289,12 @@ const cyaml_schema_field_t config_network_schema[] = {
         CYAML_FIELD_UINT(
                 "listen_backlog", CYAML_FLAG_POINTER,
                 config_network_t, listen_backlog),
+        CYAML_FIELD_MAPPING_PTR(
+                "polling", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
+                config_network_t, polling, config_network_polling_schema),
+        CYAML_FIELD_MAPPING_PTR(
+                "rebalancing", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
+                config_network_t, rebalancing, config_network_rebalancing_schema),
         CYAML_FIELD_END
 };
 
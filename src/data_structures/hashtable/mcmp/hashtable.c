@@ -44,6 +44,7 @@ hashtable_t* hashtable_mcmp_init(hashtable_config_t* hashtable_config) {
     hashtable->ht_current = hashtable_data;
     hashtable->ht_old = NULL;
     hashtable->config = hashtable_config;
+    hashtable->key_touched_fp = NULL;
 
     return hashtable;
 }
@@ -162,13 +162,23 @@ struct hashtable_data {
  * the end of the resize, the is_resizing is updated to false, then the system waits for all the threads to finish their
  * work on the buckets in that hashtable and then ht_old is updated to point to null and all the data structures
  * associated are freed.
+ *
+ * The key_touched_fp, if set, is invoked every time a key is created, updated or deleted, while the chunk of the key is
+ * still locked for write, so it must be kept short and must not yield.
  **/
+typedef void (hashtable_mcmp_key_touched_fp_t)(
+        hashtable_hash_t hash,
+        hashtable_database_number_t database_number,
+        hashtable_key_data_t *key,
+        hashtable_key_length_t key_length);
+
 typedef struct hashtable hashtable_t;
 struct hashtable {
     hashtable_config_t* config;
     hashtable_data_volatile_t* ht_current;
     hashtable_data_volatile_t* ht_old;
     bool is_resizing;
+    hashtable_mcmp_key_touched_fp_t *key_touched_fp;
 };
 
 typedef struct hashtable_mcmp_op_rmw_transaction hashtable_mcmp_op_rmw_status_t;
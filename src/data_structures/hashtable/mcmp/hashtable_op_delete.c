@@ -26,6 +26,25 @@
 #include "hashtable_support_hash.h"
 #include "hashtable_support_op.h"
 
+static inline __attribute__((always_inline)) void hashtable_mcmp_op_delete_by_index_key_touched(
+        hashtable_t* hashtable,
+        hashtable_key_value_volatile_t* key_value) {
+    // The hash is not available when deleting by index, it's calculated only if someone is interested in the key
+    if (likely(hashtable->key_touched_fp == NULL)) {
+        return;
+    }
+
+    hashtable_mcmp_support_op_key_touched(
+            hashtable,
+            hashtable_mcmp_support_hash_calculate(
+                    key_value->database_number,
+                    (hashtable_key_data_t*)key_value->key,
+                    key_value->key_length),
+            key_value->database_number,
+            (hashtable_key_data_t*)key_value->key,
+            key_value->key_length);
+}
+
 bool hashtable_mcmp_op_delete(
         hashtable_t* hashtable,
         hashtable_database_number_t database_number,
@@ -121,6 +140,13 @@ bool hashtable_mcmp_op_delete(
 
             MEMORY_FENCE_STORE();
 
+            hashtable_mcmp_support_op_key_touched(
+                    hashtable,
+                    hash,
+                    database_number,
+                    (hashtable_key_data_t*)key_value->key,
+                    key_value->key_length);
+
             xalloc_free((hashtable_key_data_t*)key_value->key);
             key_value->database_number = 0;
             key_value->key = NULL;
@@ -216,6 +242,8 @@ bool hashtable_mcmp_op_delete_by_index(
 
         MEMORY_FENCE_STORE();
 
+        hashtable_mcmp_op_delete_by_index_key_touched(hashtable, key_value);
+
         xalloc_free((hashtable_key_data_t*)key_value->key);
         key_value->database_number = 0;
         key_value->key = NULL;
@@ -301,6 +329,8 @@ bool hashtable_mcmp_op_delete_by_index_all_databases(
 
         MEMORY_FENCE_STORE();
 
+        hashtable_mcmp_op_delete_by_index_key_touched(hashtable, key_value);
+
         xalloc_free((hashtable_key_data_t*)key_value->key);
         key_value->database_number = 0;
         key_value->key = NULL;
@@ -0,0 +1,109 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "memory_fences.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "log/log.h"
+
+#include "hashtable.h"
+#include "hashtable_op_lock.h"
+#include "hashtable_support_hash.h"
+#include "hashtable_support_index.h"
+
+static int hashtable_mcmp_op_lock_chunk_index_compare(
+        const void *a,
+        const void *b) {
+    hashtable_chunk_index_t chunk_index_a = *(hashtable_chunk_index_t*)a;
+    hashtable_chunk_index_t chunk_index_b = *(hashtable_chunk_index_t*)b;
+
+    return chunk_index_a < chunk_index_b ? -1 : (chunk_index_a > chunk_index_b ? 1 : 0);
+}
+
+hashtable_chunk_index_t hashtable_mcmp_op_lock_get_chunk_index(
+        hashtable_t *hashtable,
+        hashtable_database_number_t database_number,
+        hashtable_key_data_t *key,
+        hashtable_key_length_t key_length) {
+    hashtable_hash_t hash = hashtable_mcmp_support_hash_calculate(database_number, key, key_length);
+    hashtable_bucket_index_t bucket_index = hashtable_mcmp_support_index_from_hash(
+            hashtable->ht_current->buckets_count,
+            hash);
+
+    return bucket_index / HASHTABLE_MCMP_HALF_HASHES_CHUNK_SLOTS_COUNT;
+}
+
+bool hashtable_mcmp_op_lock_chunks_for_write(
+        hashtable_t *hashtable,
+        transaction_t *transaction,
+        hashtable_chunk_index_t *chunk_indexes,
+        uint32_t chunk_indexes_count) {
+    hashtable_data_volatile_t *hashtable_data = hashtable->ht_current;
+    hashtable_chunk_index_t locked_up_to_chunk_index = 0;
+    bool locked_any = false;
+
+    assert(transaction->transaction_id.id != TRANSACTION_ID_NOT_ACQUIRED);
+
+    // The chunks are always locked in ascending order, the same order followed by the single key operations when they
+    // lock the overflowed chunks, so two transactions locking an overlapping set of chunks can't deadlock
+    qsort(
+            chunk_indexes,
+            chunk_indexes_count,
+            sizeof(hashtable_chunk_index_t),
+            hashtable_mcmp_op_lock_chunk_index_compare);
+
+    for(uint32_t index = 0; index < chunk_indexes_count; index++) {
+        hashtable_chunk_index_t chunk_index_start = chunk_indexes[index];
+        hashtable_chunk_index_t chunk_index_end;
+
+        assert(chunk_index_start < hashtable_data->chunks_count);
+
+        // The overflowed chunks counter can be read only once the chunk has been locked, as the chunks following the
+        // first one might have already been locked while processing the previous keys they are skipped
+        if (!locked_any || chunk_index_start > locked_up_to_chunk_index) {
+            if (unlikely(!transaction_lock_for_write(
+                    transaction,
+                    &hashtable_data->half_hashes_chunk[chunk_index_start].lock))) {
+                return false;
+            }
+
+            locked_any = true;
+            locked_up_to_chunk_index = chunk_index_start;
+        }
+
+        chunk_index_end = chunk_index_start +
+                hashtable_data->half_hashes_chunk[chunk_index_start].metadata.overflowed_chunks_counter;
+        if (chunk_index_end >= hashtable_data->chunks_count) {
+            chunk_index_end = hashtable_data->chunks_count - 1;
+        }
+
+        for(
+                hashtable_chunk_index_t chunk_index = locked_up_to_chunk_index + 1;
+                chunk_index <= chunk_index_end;
+                chunk_index++) {
+            if (unlikely(!transaction_lock_for_write(
+                    transaction,
+                    &hashtable_data->half_hashes_chunk[chunk_index].lock))) {
+                return false;
+            }
+
+            locked_up_to_chunk_index = chunk_index;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,24 @@
+#ifndef CACHEGRAND_HASHTABLE_OP_LOCK_H
+#define CACHEGRAND_HASHTABLE_OP_LOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+hashtable_chunk_index_t hashtable_mcmp_op_lock_get_chunk_index(
+        hashtable_t *hashtable,
+        hashtable_database_number_t database_number,
+        hashtable_key_data_t *key,
+        hashtable_key_length_t key_length);
+
+bool hashtable_mcmp_op_lock_chunks_for_write(
+        hashtable_t *hashtable,
+        transaction_t *transaction,
+        hashtable_chunk_index_t *chunk_indexes,
+        uint32_t chunk_indexes_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_HASHTABLE_OP_LOCK_H
@@ -109,6 +109,13 @@ void hashtable_mcmp_op_rmw_commit_update(
         rmw_status->key_value->flags = flags;
     }
 
+    hashtable_mcmp_support_op_key_touched(
+            rmw_status->hashtable,
+            rmw_status->hash,
+            rmw_status->database_number,
+            rmw_status->key,
+            rmw_status->key_length);
+
     // Validate if the passed key can be freed because unused or because inlined
     if (!rmw_status->created_new) {
         xalloc_free(rmw_status->key);
@@ -129,6 +136,13 @@ void hashtable_mcmp_op_rmw_commit_delete(
 
         MEMORY_FENCE_STORE();
 
+        hashtable_mcmp_support_op_key_touched(
+                rmw_status->hashtable,
+                rmw_status->hash,
+                rmw_status->database_number,
+                (hashtable_key_data_t*)rmw_status->key_value->key,
+                rmw_status->key_value->key_length);
+
         xalloc_free((hashtable_key_data_t*)rmw_status->key_value->key);
         rmw_status->key_value->database_number = 0;
         rmw_status->key_value->key = NULL;
@@ -109,6 +109,8 @@ bool hashtable_mcmp_op_set(
         LOG_DI("key_value->flags = %d", key_value->flags);
     }
 
+    hashtable_mcmp_support_op_key_touched(hashtable, hash, database_number, key, key_length);
+
     LOG_DI("unlocking half_hashes_chunk 0x%016x", half_hashes_chunk);
 
     // Validate if the passed key can be freed because unused or because inlined
@@ -37,6 +37,17 @@ extern bool hashtable_mcmp_support_op_half_hashes_chunk_lock(
 extern void hashtable_mcmp_support_op_half_hashes_chunk_unlock(
         hashtable_half_hashes_chunk_volatile_t *half_hashes_chunk);
 
+static inline __attribute__((always_inline)) void hashtable_mcmp_support_op_key_touched(
+        hashtable_t *hashtable,
+        hashtable_hash_t hash,
+        hashtable_database_number_t database_number,
+        hashtable_key_data_t *key,
+        hashtable_key_length_t key_length) {
+    if (unlikely(hashtable->key_touched_fp != NULL)) {
+        hashtable->key_touched_fp(hash, database_number, key, key_length);
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,316 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "misc.h"
+#include "hash/hash_murmurhash64a.h"
+
+#include "hyperloglog_registers.h"
+#include "hyperloglog.h"
+
+#define TAG "hyperloglog"
+
+#define HYPERLOGLOG_ALPHA_INF                   (0.721347520444481703680)
+
+#define HYPERLOGLOG_SPARSE_OPCODE_MASK          (0xC0)
+#define HYPERLOGLOG_SPARSE_OPCODE_ZERO          (0x00)
+#define HYPERLOGLOG_SPARSE_OPCODE_XZERO         (0x40)
+
+static const char hyperloglog_magic[4] = { 'H', 'Y', 'L', 'L' };
+
+static double hyperloglog_sigma(
+        double x) {
+    double y = 1;
+    double z = x;
+    double z_previous;
+
+    if (x == 1.) {
+        return INFINITY;
+    }
+
+    do {
+        x *= x;
+        z_previous = z;
+        z += x * y;
+        y += y;
+    } while(z_previous != z);
+
+    return z;
+}
+
+static double hyperloglog_tau(
+        double x) {
+    double y = 1.0;
+    double z = 1 - x;
+    double z_previous;
+
+    if (x == 0. || x == 1.) {
+        return 0.;
+    }
+
+    do {
+        x = sqrt(x);
+        z_previous = z;
+        y *= 0.5;
+        z -= pow(1 - x, 2) * y;
+    } while(z_previous != z);
+
+    return z / 3;
+}
+
+static void hyperloglog_serialize_header(
+        hyperloglog_encoding_t encoding,
+        uint64_t cardinality,
+        char *buffer) {
+    hyperloglog_header_t *header = (hyperloglog_header_t*)buffer;
+
+    memcpy(header->magic, hyperloglog_magic, sizeof(header->magic));
+    header->encoding = encoding;
+    memset(header->unused, 0, sizeof(header->unused));
+
+    for(int index = 0; index < 8; index++) {
+        header->cardinality[index] = (cardinality >> (index * 8)) & 0xFF;
+    }
+}
+
+static size_t hyperloglog_serialize_dense(
+        const uint8_t *registers,
+        char *buffer) {
+    uint8_t *dense = (uint8_t*)buffer + HYPERLOGLOG_HEADER_LENGTH;
+
+    for(size_t index = 0; index < HYPERLOGLOG_REGISTERS_COUNT; index += 4, dense += 3) {
+        uint32_t group =
+                (uint32_t)registers[index] |
+                ((uint32_t)registers[index + 1] << 6) |
+                ((uint32_t)registers[index + 2] << 12) |
+                ((uint32_t)registers[index + 3] << 18);
+
+        dense[0] = group & 0xFF;
+        dense[1] = (group >> 8) & 0xFF;
+        dense[2] = (group >> 16) & 0xFF;
+    }
+
+    return HYPERLOGLOG_DENSE_LENGTH;
+}
+
+static size_t hyperloglog_serialize_sparse(
+        const uint8_t *registers,
+        char *buffer) {
+    uint8_t *sparse = (uint8_t*)buffer + HYPERLOGLOG_HEADER_LENGTH;
+    uint8_t *sparse_end = (uint8_t*)buffer + HYPERLOGLOG_SPARSE_LENGTH_MAX;
+    size_t index = 0;
+
+    while(index < HYPERLOGLOG_REGISTERS_COUNT) {
+        uint8_t value = registers[index];
+        size_t run_length = 1;
+
+        if (value > HYPERLOGLOG_SPARSE_VALUE_MAX) {
+            return 0;
+        }
+
+        while(index + run_length < HYPERLOGLOG_REGISTERS_COUNT && registers[index + run_length] == value) {
+            run_length++;
+        }
+        index += run_length;
+
+        while(run_length > 0) {
+            size_t opcode_length;
+
+            if (value > 0) {
+                opcode_length = MIN(run_length, HYPERLOGLOG_SPARSE_VAL_LENGTH_MAX);
+                if (sparse + 1 > sparse_end) {
+                    return 0;
+                }
+                *sparse++ = 0x80 | ((value - 1) << 2) | (opcode_length - 1);
+            } else if (run_length > HYPERLOGLOG_SPARSE_ZERO_LENGTH_MAX) {
+                opcode_length = MIN(run_length, HYPERLOGLOG_SPARSE_XZERO_LENGTH_MAX);
+                if (sparse + 2 > sparse_end) {
+                    return 0;
+                }
+                *sparse++ = HYPERLOGLOG_SPARSE_OPCODE_XZERO | ((opcode_length - 1) >> 8);
+                *sparse++ = (opcode_length - 1) & 0xFF;
+            } else {
+                opcode_length = run_length;
+                if (sparse + 1 > sparse_end) {
+                    return 0;
+                }
+                *sparse++ = HYPERLOGLOG_SPARSE_OPCODE_ZERO | (opcode_length - 1);
+            }
+
+            run_length -= opcode_length;
+        }
+    }
+
+    return (char*)sparse - buffer;
+}
+
+static bool hyperloglog_merge_sparse(
+        uint8_t *registers,
+        const uint8_t *sparse,
+        const uint8_t *sparse_end) {
+    size_t index = 0;
+
+    while(sparse < sparse_end) {
+        uint8_t opcode = *sparse++;
+        size_t run_length;
+
+        if ((opcode & HYPERLOGLOG_SPARSE_OPCODE_MASK) == HYPERLOGLOG_SPARSE_OPCODE_ZERO) {
+            run_length = (opcode & 0x3F) + 1;
+        } else if ((opcode & HYPERLOGLOG_SPARSE_OPCODE_MASK) == HYPERLOGLOG_SPARSE_OPCODE_XZERO) {
+            if (unlikely(sparse == sparse_end)) {
+                return false;
+            }
+            run_length = ((((size_t)opcode & 0x3F) << 8) | *sparse++) + 1;
+        } else {
+            uint8_t value = ((opcode >> 2) & 0x1F) + 1;
+            run_length = (opcode & 0x03) + 1;
+
+            if (unlikely(index + run_length > HYPERLOGLOG_REGISTERS_COUNT)) {
+                return false;
+            }
+
+            for(size_t run_index = index; run_index < index + run_length; run_index++) {
+                if (value > registers[run_index]) {
+                    registers[run_index] = value;
+                }
+            }
+        }
+
+        index += run_length;
+        if (unlikely(index > HYPERLOGLOG_REGISTERS_COUNT)) {
+            return false;
+        }
+    }
+
+    // The opcodes have to cover all the registers
+    return index == HYPERLOGLOG_REGISTERS_COUNT;
+}
+
+bool hyperloglog_validate(
+        const char *data,
+        size_t data_length,
+        hyperloglog_encoding_t *encoding) {
+    hyperloglog_header_t *header = (hyperloglog_header_t*)data;
+
+    if (data_length < HYPERLOGLOG_HEADER_LENGTH ||
+        memcmp(header->magic, hyperloglog_magic, sizeof(header->magic)) != 0) {
+        return false;
+    }
+
+    if (header->encoding == HYPERLOGLOG_ENCODING_DENSE) {
+        if (data_length != HYPERLOGLOG_DENSE_LENGTH) {
+            return false;
+        }
+    } else if (header->encoding == HYPERLOGLOG_ENCODING_SPARSE) {
+        if (data_length > HYPERLOGLOG_SPARSE_LENGTH_LIMIT) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    *encoding = header->encoding;
+    return true;
+}
+
+bool hyperloglog_cached_cardinality(
+        const char *data,
+        uint64_t *cardinality) {
+    hyperloglog_header_t *header = (hyperloglog_header_t*)data;
+
+    if (header->cardinality[7] & 0x80) {
+        return false;
+    }
+
+    *cardinality = 0;
+    for(int index = 0; index < 8; index++) {
+        *cardinality |= (uint64_t)header->cardinality[index] << (index * 8);
+    }
+
+    return true;
+}
+
+bool hyperloglog_merge(
+        uint8_t *registers,
+        const char *data,
+        size_t data_length) {
+    hyperloglog_header_t *header = (hyperloglog_header_t*)data;
+    const uint8_t *registers_data = (const uint8_t*)data + HYPERLOGLOG_HEADER_LENGTH;
+
+    if (header->encoding == HYPERLOGLOG_ENCODING_DENSE) {
+        hyperloglog_registers_merge_dense(registers, registers_data, HYPERLOGLOG_REGISTERS_COUNT);
+        return true;
+    }
+
+    return hyperloglog_merge_sparse(registers, registers_data, (const uint8_t*)data + data_length);
+}
+
+bool hyperloglog_add(
+        uint8_t *registers,
+        const char *element,
+        size_t element_length) {
+    uint64_t hash = hash_murmurhash64a(element, element_length, HYPERLOGLOG_HASH_SEED);
+    uint32_t index = hash & (HYPERLOGLOG_REGISTERS_COUNT - 1);
+
+    // The remaining bits are used to count the run of zeros, the bit Q is set to make sure the run ends
+    hash >>= HYPERLOGLOG_PRECISION;
+    hash |= (uint64_t)1 << HYPERLOGLOG_Q;
+    uint8_t value = __builtin_ctzll(hash) + 1;
+
+    if (value <= registers[index]) {
+        return false;
+    }
+
+    registers[index] = value;
+    return true;
+}
+
+uint64_t hyperloglog_cardinality(
+        const uint8_t *registers) {
+    double m = HYPERLOGLOG_REGISTERS_COUNT;
+    uint32_t registers_histogram[64] = { 0 };
+
+    for(size_t index = 0; index < HYPERLOGLOG_REGISTERS_COUNT; index++) {
+        registers_histogram[registers[index] & 0x3F]++;
+    }
+
+    // Improved estimator by Otmar Ertl, the same used by Redis so the cardinalities match
+    double z = m * hyperloglog_tau((m - registers_histogram[HYPERLOGLOG_Q + 1]) / m);
+    for(int value = HYPERLOGLOG_Q; value >= 1; value--) {
+        z += registers_histogram[value];
+        z *= 0.5;
+    }
+    z += m * hyperloglog_sigma(registers_histogram[0] / m);
+
+    return (uint64_t)llroundl(HYPERLOGLOG_ALPHA_INF * m * m / z);
+}
+
+size_t hyperloglog_serialize(
+        const uint8_t *registers,
+        hyperloglog_encoding_t encoding,
+        char *buffer) {
+    size_t length = 0;
+
+    if (encoding == HYPERLOGLOG_ENCODING_SPARSE) {
+        length = hyperloglog_serialize_sparse(registers, buffer);
+    }
+
+    if (length == 0) {
+        encoding = HYPERLOGLOG_ENCODING_DENSE;
+        length = hyperloglog_serialize_dense(registers, buffer);
+    }
+
+    hyperloglog_serialize_header(encoding, hyperloglog_cardinality(registers), buffer);
+
+    return length;
+}
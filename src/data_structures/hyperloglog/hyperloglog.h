@@ -0,0 +1,136 @@
+#ifndef CACHEGRAND_HYPERLOGLOG_H
+#define CACHEGRAND_HYPERLOGLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HYPERLOGLOG_PRECISION                   (14)
+#define HYPERLOGLOG_Q                           (64 - HYPERLOGLOG_PRECISION)
+#define HYPERLOGLOG_REGISTERS_COUNT             (1 << HYPERLOGLOG_PRECISION)
+#define HYPERLOGLOG_REGISTER_BITS               (6)
+#define HYPERLOGLOG_HASH_SEED                   (0xadc83b19)
+
+#define HYPERLOGLOG_HEADER_LENGTH               (sizeof(hyperloglog_header_t))
+#define HYPERLOGLOG_DENSE_LENGTH \
+    (HYPERLOGLOG_HEADER_LENGTH + ((HYPERLOGLOG_REGISTERS_COUNT * HYPERLOGLOG_REGISTER_BITS + 7) / 8))
+
+// As in Redis, a sparse HyperLogLog is converted to dense once longer than 3000 bytes, header included, the longest
+// valid sparse encoding uses an opcode of 2 bytes for each register
+#define HYPERLOGLOG_SPARSE_LENGTH_MAX           (3000)
+#define HYPERLOGLOG_SPARSE_LENGTH_LIMIT         (HYPERLOGLOG_HEADER_LENGTH + (HYPERLOGLOG_REGISTERS_COUNT * 2))
+#define HYPERLOGLOG_SPARSE_VALUE_MAX            (32)
+#define HYPERLOGLOG_SPARSE_ZERO_LENGTH_MAX      (64)
+#define HYPERLOGLOG_SPARSE_XZERO_LENGTH_MAX     (16384)
+#define HYPERLOGLOG_SPARSE_VAL_LENGTH_MAX       (4)
+
+/**
+ * HyperLogLog
+ *
+ * The HyperLogLogs are stored as strings using the same format of Redis so they can be moved back and forth via the
+ * RDB snapshots: a header with the magic HYLL, the encoding and the cached cardinality, followed by the registers.
+ *
+ * The dense encoding packs the 16384 registers of 6 bits each in 12288 bytes starting from the least significant bit,
+ * the sparse encoding is a run-length encoding of the registers made of three opcodes:
+ * - ZERO, 00xxxxxx, a run of 1 to 64 registers set to 0
+ * - XZERO, 01xxxxxx yyyyyyyy, a run of 1 to 16384 registers set to 0
+ * - VAL, 1vvvvvxx, a run of 1 to 4 registers set to a value between 1 and 32
+ *
+ * The cardinality is cached in little endian, the most significant bit of the last byte is set if the cache is not
+ * valid.
+ *
+ * The functions below work on an array of 16384 registers of one byte each, the serialized HyperLogLogs are merged
+ * into it and it is serialized back after the changes, the dense registers are merged with vectorized kernels.
+ */
+typedef struct hyperloglog_header hyperloglog_header_t;
+struct hyperloglog_header {
+    char magic[4];
+    uint8_t encoding;
+    uint8_t unused[3];
+    uint8_t cardinality[8];
+} __attribute__((packed));
+
+enum hyperloglog_encoding {
+    HYPERLOGLOG_ENCODING_DENSE = 0,
+    HYPERLOGLOG_ENCODING_SPARSE = 1,
+};
+typedef enum hyperloglog_encoding hyperloglog_encoding_t;
+
+/**
+ * Validate the header of a serialized HyperLogLog, the registers are validated only when merged
+ *
+ * @param data The serialized HyperLogLog
+ * @param data_length The length of the serialized HyperLogLog
+ * @param encoding Set to the encoding of the HyperLogLog
+ * @return true if the data is a HyperLogLog, false otherwise
+ */
+bool hyperloglog_validate(
+        const char *data,
+        size_t data_length,
+        hyperloglog_encoding_t *encoding);
+
+/**
+ * Read the cardinality cached in the header of a validated serialized HyperLogLog
+ *
+ * @param data The serialized HyperLogLog
+ * @param cardinality Set to the cached cardinality if valid
+ * @return true if the cached cardinality is valid, false otherwise
+ */
+bool hyperloglog_cached_cardinality(
+        const char *data,
+        uint64_t *cardinality);
+
+/**
+ * Merge a validated serialized HyperLogLog into the registers keeping the max value of each register
+ *
+ * @param registers The registers, HYPERLOGLOG_REGISTERS_COUNT bytes
+ * @param data The serialized HyperLogLog
+ * @param data_length The length of the serialized HyperLogLog
+ * @return true if the HyperLogLog has been merged, false if the sparse registers are corrupted
+ */
+bool hyperloglog_merge(
+        uint8_t *registers,
+        const char *data,
+        size_t data_length);
+
+/**
+ * Add an element to the registers
+ *
+ * @param registers The registers, HYPERLOGLOG_REGISTERS_COUNT bytes
+ * @param element The element
+ * @param element_length The length of the element
+ * @return true if a register has been changed, false otherwise
+ */
+bool hyperloglog_add(
+        uint8_t *registers,
+        const char *element,
+        size_t element_length);
+
+/**
+ * Estimate the cardinality using the same estimator of Redis
+ *
+ * @param registers The registers, HYPERLOGLOG_REGISTERS_COUNT bytes
+ * @return The estimated cardinality
+ */
+uint64_t hyperloglog_cardinality(
+        const uint8_t *registers);
+
+/**
+ * Serialize the registers caching the cardinality in the header, a sparse HyperLogLog is converted to dense if the
+ * sparse encoding can't hold a register or becomes too long
+ *
+ * @param registers The registers, HYPERLOGLOG_REGISTERS_COUNT bytes
+ * @param encoding The encoding to use, HYPERLOGLOG_ENCODING_SPARSE is only a preference
+ * @param buffer The buffer where to serialize the HyperLogLog, HYPERLOGLOG_DENSE_LENGTH bytes
+ * @return The length of the serialized HyperLogLog
+ */
+size_t hyperloglog_serialize(
+        const uint8_t *registers,
+        hyperloglog_encoding_t encoding,
+        char *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_HYPERLOGLOG_H
@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "misc.h"
+#include "cmake_config.h"
+#include "utils_string.h"
+
+#include "hyperloglog_registers.h"
+
+IFUNC_WRAPPER_RESOLVE(HYPERLOGLOG_REGISTERS_NAME_IFUNC(merge_dense)) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F
+    // The 512 bit byte shuffle and max are part of the BW extension
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, avx512);
+    }
+#endif
+    if (__builtin_cpu_supports("avx2")) {
+        return HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, avx2);
+    }
+#elif defined(__aarch64__)
+    // NEON is part of the base armv8-a instruction set
+    return HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, armv8a_neon);
+#endif
+
+    return HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, loop);
+}
+
+void IFUNC_WRAPPER(HYPERLOGLOG_REGISTERS_NAME_IFUNC(merge_dense), HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS);
+
+void HYPERLOGLOG_REGISTERS_SIGNATURE_IMPL(merge_dense, loop, HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS) {
+    for(size_t index = 0; index < registers_count; index += 4, dense += 3) {
+        uint32_t group = (uint32_t)dense[0] | ((uint32_t)dense[1] << 8) | ((uint32_t)dense[2] << 16);
+
+        for(size_t group_index = 0; group_index < 4; group_index++) {
+            uint8_t value = (group >> (group_index * 6)) & 0x3F;
+            if (value > registers[index + group_index]) {
+                registers[index + group_index] = value;
+            }
+        }
+    }
+}
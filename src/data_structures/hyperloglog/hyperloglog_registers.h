@@ -0,0 +1,41 @@
+#ifndef CACHEGRAND_HYPERLOGLOG_REGISTERS_H
+#define CACHEGRAND_HYPERLOGLOG_REGISTERS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HYPERLOGLOG_REGISTERS_NAME_IFUNC(NAME) hyperloglog_registers_##NAME
+#define HYPERLOGLOG_REGISTERS_SIGNATURE_IFUNC(NAME, ARGS) HYPERLOGLOG_REGISTERS_NAME_IFUNC(NAME) ARGS
+
+#define HYPERLOGLOG_REGISTERS_NAME_IMPL(NAME, METHOD) hyperloglog_registers_##NAME##_##METHOD
+#define HYPERLOGLOG_REGISTERS_SIGNATURE_IMPL(NAME, METHOD, ARGS) HYPERLOGLOG_REGISTERS_NAME_IMPL(NAME, METHOD) ARGS
+
+#define HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS \
+    (uint8_t *registers, const uint8_t *dense, size_t registers_count)
+
+/**
+ * Merge the registers of a dense HyperLogLog, 6 bits per register packed as in Redis, into an array of registers of
+ * one byte each keeping for each register the max value
+ *
+ * Every group of 3 bytes of the dense registers holds 4 registers, the implementations unpack and merge the groups
+ * with the max of the unsigned bytes, the vectorized ones process 8 or 16 groups at time
+ *
+ * @param registers The array of registers updated with the merge
+ * @param dense The dense registers
+ * @param registers_count The number of registers, has to be a multiple of 4
+ */
+void HYPERLOGLOG_REGISTERS_SIGNATURE_IFUNC(merge_dense, HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS);
+void HYPERLOGLOG_REGISTERS_SIGNATURE_IMPL(merge_dense, loop, HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS);
+#if defined(__x86_64__)
+void HYPERLOGLOG_REGISTERS_SIGNATURE_IMPL(merge_dense, avx2, HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS);
+void HYPERLOGLOG_REGISTERS_SIGNATURE_IMPL(merge_dense, avx512, HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS);
+#elif defined(__aarch64__)
+void HYPERLOGLOG_REGISTERS_SIGNATURE_IMPL(merge_dense, armv8a_neon, HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_HYPERLOGLOG_REGISTERS_H
@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <arm_neon.h>
+
+#include "misc.h"
+
+#include "hyperloglog_registers.h"
+
+void HYPERLOGLOG_REGISTERS_SIGNATURE_IMPL(merge_dense, armv8a_neon, HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS) {
+    size_t index = 0;
+
+    // The de-interleaving loads split 16 groups of 3 bytes in their first, second and third bytes and the registers in
+    // groups of 4, so each register of the group is rebuilt in its own vector without any shuffle
+    const uint8x16_t mask_low_6_vector = vdupq_n_u8(0x3F);
+    const uint8x16_t mask_low_4_vector = vdupq_n_u8(0x0F);
+    const uint8x16_t mask_low_2_vector = vdupq_n_u8(0x03);
+
+    for(; index + 64 <= registers_count; index += 64, dense += 48) {
+        uint8x16x3_t dense_vector = vld3q_u8(dense);
+        uint8x16x4_t registers_vector = vld4q_u8(registers + index);
+
+        uint8x16_t register_0_vector = vandq_u8(dense_vector.val[0], mask_low_6_vector);
+        uint8x16_t register_1_vector = vorrq_u8(
+                vshrq_n_u8(dense_vector.val[0], 6),
+                vshlq_n_u8(vandq_u8(dense_vector.val[1], mask_low_4_vector), 2));
+        uint8x16_t register_2_vector = vorrq_u8(
+                vshrq_n_u8(dense_vector.val[1], 4),
+                vshlq_n_u8(vandq_u8(dense_vector.val[2], mask_low_2_vector), 4));
+        uint8x16_t register_3_vector = vshrq_n_u8(dense_vector.val[2], 2);
+
+        registers_vector.val[0] = vmaxq_u8(registers_vector.val[0], register_0_vector);
+        registers_vector.val[1] = vmaxq_u8(registers_vector.val[1], register_1_vector);
+        registers_vector.val[2] = vmaxq_u8(registers_vector.val[2], register_2_vector);
+        registers_vector.val[3] = vmaxq_u8(registers_vector.val[3], register_3_vector);
+
+        vst4q_u8(registers + index, registers_vector);
+    }
+
+    HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, loop)(
+            registers + index,
+            dense,
+            registers_count - index);
+}
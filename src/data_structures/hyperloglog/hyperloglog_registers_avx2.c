@@ -0,0 +1,59 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <immintrin.h>
+
+#include "misc.h"
+
+#include "hyperloglog_registers.h"
+
+void HYPERLOGLOG_REGISTERS_SIGNATURE_IMPL(merge_dense, avx2, HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS) {
+    size_t index = 0;
+
+    // Each lane gets 4 groups of 3 bytes, the shuffle spreads each group in a 32 bit word and then each register is
+    // shifted in its own byte, as the registers are packed starting from the least significant bit the order of the
+    // bytes in the words matches the order of the registers
+    const __m256i spread_mask_vector = _mm256_setr_epi8(
+            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i register_0_mask_vector = _mm256_set1_epi32(0x0000003F);
+    const __m256i register_1_mask_vector = _mm256_set1_epi32(0x00003F00);
+    const __m256i register_2_mask_vector = _mm256_set1_epi32(0x003F0000);
+    const __m256i register_3_mask_vector = _mm256_set1_epi32(0x3F000000);
+
+    // Each iteration loads 28 bytes to use 24, the last 8 registers (6 bytes) are always left to the loop to avoid
+    // reading past the end of the dense registers
+    for(; index + 32 + 8 <= registers_count; index += 32, dense += 24) {
+        __m256i dense_vector = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128((__m128i*)dense)),
+                _mm_loadu_si128((__m128i*)(dense + 12)),
+                1);
+        __m256i groups_vector = _mm256_shuffle_epi8(dense_vector, spread_mask_vector);
+
+        __m256i unpacked_vector = _mm256_or_si256(
+                _mm256_or_si256(
+                        _mm256_and_si256(groups_vector, register_0_mask_vector),
+                        _mm256_and_si256(_mm256_slli_epi32(groups_vector, 2), register_1_mask_vector)),
+                _mm256_or_si256(
+                        _mm256_and_si256(_mm256_slli_epi32(groups_vector, 4), register_2_mask_vector),
+                        _mm256_and_si256(_mm256_slli_epi32(groups_vector, 6), register_3_mask_vector)));
+
+        __m256i registers_vector = _mm256_loadu_si256((__m256i*)(registers + index));
+        _mm256_storeu_si256(
+                (__m256i*)(registers + index),
+                _mm256_max_epu8(registers_vector, unpacked_vector));
+    }
+
+    HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, loop)(
+            registers + index,
+            dense,
+            registers_count - index);
+}
@@ -0,0 +1,55 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <immintrin.h>
+
+#include "misc.h"
+
+#include "hyperloglog_registers.h"
+
+void HYPERLOGLOG_REGISTERS_SIGNATURE_IMPL(merge_dense, avx512, HYPERLOGLOG_REGISTERS_MERGE_DENSE_ARGS) {
+    size_t index = 0;
+
+    // Same approach of the avx2 implementation with 4 lanes, the byte shuffle works within each 128 bit lane
+    const __m512i spread_mask_vector = _mm512_broadcast_i32x4(_mm_setr_epi8(
+            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+    const __m512i register_0_mask_vector = _mm512_set1_epi32(0x0000003F);
+    const __m512i register_1_mask_vector = _mm512_set1_epi32(0x00003F00);
+    const __m512i register_2_mask_vector = _mm512_set1_epi32(0x003F0000);
+    const __m512i register_3_mask_vector = _mm512_set1_epi32(0x3F000000);
+
+    // Each iteration loads 52 bytes to use 48, the last 8 registers (6 bytes) are always left to the loop
+    for(; index + 64 + 8 <= registers_count; index += 64, dense += 48) {
+        __m512i dense_vector = _mm512_castsi128_si512(_mm_loadu_si128((__m128i*)dense));
+        dense_vector = _mm512_inserti32x4(dense_vector, _mm_loadu_si128((__m128i*)(dense + 12)), 1);
+        dense_vector = _mm512_inserti32x4(dense_vector, _mm_loadu_si128((__m128i*)(dense + 24)), 2);
+        dense_vector = _mm512_inserti32x4(dense_vector, _mm_loadu_si128((__m128i*)(dense + 36)), 3);
+        __m512i groups_vector = _mm512_shuffle_epi8(dense_vector, spread_mask_vector);
+
+        __m512i unpacked_vector = _mm512_or_si512(
+                _mm512_or_si512(
+                        _mm512_and_si512(groups_vector, register_0_mask_vector),
+                        _mm512_and_si512(_mm512_slli_epi32(groups_vector, 2), register_1_mask_vector)),
+                _mm512_or_si512(
+                        _mm512_and_si512(_mm512_slli_epi32(groups_vector, 4), register_2_mask_vector),
+                        _mm512_and_si512(_mm512_slli_epi32(groups_vector, 6), register_3_mask_vector)));
+
+        __m512i registers_vector = _mm512_loadu_si512((__m512i*)(registers + index));
+        _mm512_storeu_si512(
+                (__m512i*)(registers + index),
+                _mm512_max_epu8(registers_vector, unpacked_vector));
+    }
+
+    HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, loop)(
+            registers + index,
+            dense,
+            registers_count - index);
+}
@@ -0,0 +1,588 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "xalloc.h"
+#include "hash/hash_crc32c.h"
+
+#include "packed_hash.h"
+
+#define TAG "packed_hash"
+
+static inline uint32_t packed_hash_hash_field(
+        char *field,
+        size_t field_length) {
+    return hash_crc32c(field, field_length, 0);
+}
+
+static inline uint32_t packed_hash_buckets_count_for(
+        uint32_t count,
+        uint32_t buckets_count_min) {
+    uint32_t buckets_count = buckets_count_min;
+
+    // The tables are kept at most half full to keep the probing chains short
+    while(buckets_count < (uint64_t)count * 2) {
+        buckets_count <<= 1;
+    }
+
+    return buckets_count;
+}
+
+static inline size_t packed_hash_varint_length(
+        size_t value) {
+    size_t length = 1;
+    while(value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+
+    return length;
+}
+
+static inline size_t packed_hash_varint_write(
+        char *buffer,
+        size_t value) {
+    size_t length = 0;
+    while(value >= 0x80) {
+        buffer[length++] = (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (char)value;
+
+    return length;
+}
+
+static inline bool packed_hash_varint_read(
+        char *buffer,
+        size_t buffer_length,
+        size_t *offset,
+        size_t *value) {
+    size_t result = 0;
+
+    for(uint8_t index = 0; index < PACKED_HASH_VARINT_MAX_LENGTH; index++) {
+        if (unlikely(*offset >= buffer_length)) {
+            return false;
+        }
+
+        uint8_t byte = (uint8_t)buffer[(*offset)++];
+        result |= (size_t)(byte & 0x7F) << (7 * index);
+
+        if (likely((byte & 0x80) == 0)) {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool packed_hash_entry_field_length_read(
+        char *buffer,
+        size_t buffer_length,
+        size_t *offset,
+        size_t *field_length,
+        bool *deleted) {
+    size_t field_length_and_flags;
+
+    if (unlikely(!packed_hash_varint_read(buffer, buffer_length, offset, &field_length_and_flags))) {
+        return false;
+    }
+
+    *field_length = field_length_and_flags >> 1;
+    *deleted = (field_length_and_flags & 1) != 0;
+
+    return true;
+}
+
+bool packed_hash_entry_value_length_read(
+        char *buffer,
+        size_t buffer_length,
+        size_t *offset,
+        size_t *value_length) {
+    return packed_hash_varint_read(buffer, buffer_length, offset, value_length);
+}
+
+static bool packed_hash_entry_read(
+        packed_hash_t *packed_hash,
+        size_t *offset,
+        packed_hash_entry_t *entry,
+        bool *deleted) {
+    if (unlikely(!packed_hash_entry_field_length_read(
+            packed_hash->entries,
+            packed_hash->entries_length,
+            offset,
+            &entry->field_length,
+            deleted))) {
+        return false;
+    }
+
+    if (unlikely(entry->field_length > packed_hash->entries_length - *offset)) {
+        return false;
+    }
+
+    entry->field = packed_hash->entries + *offset;
+    *offset += entry->field_length;
+
+    if (unlikely(!packed_hash_varint_read(
+            packed_hash->entries,
+            packed_hash->entries_length,
+            offset,
+            &entry->value_length))) {
+        return false;
+    }
+
+    if (unlikely(entry->value_length > packed_hash->entries_length - *offset)) {
+        return false;
+    }
+
+    entry->value = packed_hash->entries + *offset;
+    *offset += entry->value_length;
+
+    return true;
+}
+
+static inline bool packed_hash_entry_field_equals(
+        packed_hash_entry_t *entry,
+        char *field,
+        size_t field_length) {
+    return entry->field_length == field_length && memcmp(entry->field, field, field_length) == 0;
+}
+
+bool packed_hash_init(
+        packed_hash_t *packed_hash,
+        char *data,
+        size_t data_length) {
+    packed_hash_header_t *header = (packed_hash_header_t*)data;
+
+    if (unlikely(data_length < sizeof(packed_hash_header_t))) {
+        return false;
+    }
+
+    if (header->encoding == PACKED_HASH_ENCODING_COMPACT) {
+        // Only the table encoding is changed in place
+        if (unlikely(
+                header->buckets_count != 0 ||
+                header->deleted_entries_length != 0 ||
+                header->deleted_buckets_count != 0)) {
+            return false;
+        }
+    } else if (header->encoding == PACKED_HASH_ENCODING_TABLE) {
+        if (unlikely(
+                header->buckets_count < PACKED_HASH_TABLE_BUCKETS_MIN ||
+                (header->buckets_count & (header->buckets_count - 1)) != 0 ||
+                header->buckets_count < ((uint64_t)header->count + header->deleted_buckets_count) * 2 ||
+                header->deleted_entries_length > header->entries_length)) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    size_t buckets_length = (size_t)header->buckets_count * sizeof(uint32_t);
+    if (unlikely(sizeof(packed_hash_header_t) + buckets_length + header->entries_length != data_length)) {
+        return false;
+    }
+
+    packed_hash->encoding = header->encoding;
+    packed_hash->count = header->count;
+    packed_hash->buckets_count = header->buckets_count;
+    packed_hash->buckets = (uint32_t*)(data + sizeof(packed_hash_header_t));
+    packed_hash->entries = data + sizeof(packed_hash_header_t) + buckets_length;
+    packed_hash->entries_length = header->entries_length;
+
+    return true;
+}
+
+bool packed_hash_iter_next(
+        packed_hash_t *packed_hash,
+        size_t *offset,
+        packed_hash_entry_t *entry) {
+    bool deleted;
+
+    // The entries deleted in place are skipped
+    do {
+        if (*offset >= packed_hash->entries_length) {
+            return false;
+        }
+
+        if (unlikely(!packed_hash_entry_read(packed_hash, offset, entry, &deleted))) {
+            return false;
+        }
+    } while(deleted);
+
+    return true;
+}
+
+bool packed_hash_bucket_get(
+        packed_hash_t *packed_hash,
+        uint32_t bucket_index,
+        packed_hash_entry_t *entry) {
+    if (unlikely(bucket_index >= packed_hash->buckets_count)) {
+        return false;
+    }
+
+    bool deleted;
+    uint32_t bucket = packed_hash->buckets[bucket_index];
+    if (bucket == PACKED_HASH_BUCKET_EMPTY || bucket == PACKED_HASH_BUCKET_DELETED) {
+        return false;
+    }
+
+    // The buckets never point to a deleted entry
+    size_t offset = bucket - 1;
+    return packed_hash_entry_read(packed_hash, &offset, entry, &deleted) && likely(!deleted);
+}
+
+bool packed_hash_get(
+        packed_hash_t *packed_hash,
+        char *field,
+        size_t field_length,
+        packed_hash_entry_t *entry) {
+    if (packed_hash->encoding == PACKED_HASH_ENCODING_COMPACT) {
+        size_t offset = 0;
+        while(packed_hash_iter_next(packed_hash, &offset, entry)) {
+            if (packed_hash_entry_field_equals(entry, field, field_length)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    uint32_t buckets_mask = packed_hash->buckets_count - 1;
+    uint32_t bucket_index = packed_hash_hash_field(field, field_length) & buckets_mask;
+
+    for(uint32_t probes = 0; probes < packed_hash->buckets_count; probes++) {
+        uint32_t bucket = packed_hash->buckets[bucket_index];
+
+        if (bucket == PACKED_HASH_BUCKET_EMPTY) {
+            return false;
+        }
+
+        // The buckets of the deleted fields are part of the probing chains
+        if (bucket != PACKED_HASH_BUCKET_DELETED) {
+            if (unlikely(!packed_hash_bucket_get(packed_hash, bucket_index, entry))) {
+                return false;
+            }
+
+            if (packed_hash_entry_field_equals(entry, field, field_length)) {
+                return true;
+            }
+        }
+
+        bucket_index = (bucket_index + 1) & buckets_mask;
+    }
+
+    return false;
+}
+
+static void packed_hash_builder_index_insert(
+        packed_hash_builder_t *builder,
+        uint32_t entry_index) {
+    uint32_t buckets_mask = builder->index_buckets_count - 1;
+    uint32_t bucket_index = builder->entries[entry_index].hash & buckets_mask;
+
+    while(builder->index[bucket_index] != 0) {
+        bucket_index = (bucket_index + 1) & buckets_mask;
+    }
+
+    builder->index[bucket_index] = entry_index + 1;
+}
+
+static void packed_hash_builder_index_rebuild(
+        packed_hash_builder_t *builder,
+        uint32_t entries_count) {
+    if (builder->index) {
+        xalloc_free(builder->index);
+    }
+
+    builder->index_buckets_count = packed_hash_buckets_count_for(
+            entries_count,
+            PACKED_HASH_BUILDER_INDEX_BUCKETS_MIN);
+    builder->index = xalloc_alloc_zero(sizeof(uint32_t) * builder->index_buckets_count);
+
+    for(uint32_t entry_index = 0; entry_index < builder->entries_count; entry_index++) {
+        packed_hash_builder_index_insert(builder, entry_index);
+    }
+}
+
+static uint32_t packed_hash_builder_find(
+        packed_hash_builder_t *builder,
+        char *field,
+        size_t field_length,
+        uint32_t hash) {
+    uint32_t buckets_mask = builder->index_buckets_count - 1;
+    uint32_t bucket_index = hash & buckets_mask;
+
+    while(builder->index[bucket_index] != 0) {
+        uint32_t entry_index = builder->index[bucket_index] - 1;
+        packed_hash_builder_entry_t *builder_entry = &builder->entries[entry_index];
+
+        if (!builder_entry->deleted &&
+            builder_entry->hash == hash &&
+            packed_hash_entry_field_equals(&builder_entry->entry, field, field_length)) {
+            return entry_index;
+        }
+
+        bucket_index = (bucket_index + 1) & buckets_mask;
+    }
+
+    return UINT32_MAX;
+}
+
+static void packed_hash_builder_append(
+        packed_hash_builder_t *builder,
+        packed_hash_entry_t *entry,
+        uint32_t hash) {
+    if (builder->entries_count == builder->entries_size) {
+        builder->entries_size *= 2;
+        builder->entries = xalloc_realloc(
+                builder->entries,
+                sizeof(packed_hash_builder_entry_t) * builder->entries_size);
+    }
+
+    packed_hash_builder_entry_t *builder_entry = &builder->entries[builder->entries_count];
+    builder_entry->entry = *entry;
+    builder_entry->hash = hash;
+    builder_entry->deleted = false;
+
+    builder->entries_count++;
+    builder->count++;
+
+    if (entry->field_length > PACKED_HASH_COMPACT_MAX_ENTRY_LENGTH ||
+        entry->value_length > PACKED_HASH_COMPACT_MAX_ENTRY_LENGTH ||
+        builder->count > PACKED_HASH_COMPACT_MAX_ENTRIES) {
+        builder->encoding = PACKED_HASH_ENCODING_TABLE;
+    }
+}
+
+void packed_hash_builder_init(
+        packed_hash_builder_t *builder,
+        packed_hash_t *packed_hash) {
+    uint32_t count = packed_hash ? packed_hash->count : 0;
+
+    memset(builder, 0, sizeof(packed_hash_builder_t));
+    builder->encoding = packed_hash ? packed_hash->encoding : PACKED_HASH_ENCODING_COMPACT;
+    builder->entries_size = MAX(count, PACKED_HASH_BUILDER_INDEX_BUCKETS_MIN / 2);
+    builder->entries = xalloc_alloc(sizeof(packed_hash_builder_entry_t) * builder->entries_size);
+
+    if (packed_hash) {
+        size_t offset = 0;
+        packed_hash_entry_t entry;
+        while(packed_hash_iter_next(packed_hash, &offset, &entry)) {
+            packed_hash_builder_append(
+                    builder,
+                    &entry,
+                    packed_hash_hash_field(entry.field, entry.field_length));
+        }
+    }
+
+    packed_hash_builder_index_rebuild(builder, builder->entries_count);
+}
+
+void packed_hash_builder_free(
+        packed_hash_builder_t *builder) {
+    xalloc_free(builder->entries);
+    xalloc_free(builder->index);
+    builder->entries = NULL;
+    builder->index = NULL;
+}
+
+bool packed_hash_builder_get(
+        packed_hash_builder_t *builder,
+        char *field,
+        size_t field_length,
+        packed_hash_entry_t *entry) {
+    uint32_t entry_index = packed_hash_builder_find(
+            builder,
+            field,
+            field_length,
+            packed_hash_hash_field(field, field_length));
+
+    if (entry_index == UINT32_MAX) {
+        return false;
+    }
+
+    *entry = builder->entries[entry_index].entry;
+    return true;
+}
+
+bool packed_hash_builder_set(
+        packed_hash_builder_t *builder,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length) {
+    uint32_t hash = packed_hash_hash_field(field, field_length);
+    uint32_t entry_index = packed_hash_builder_find(builder, field, field_length, hash);
+
+    if (entry_index != UINT32_MAX) {
+        builder->entries[entry_index].entry.value = value;
+        builder->entries[entry_index].entry.value_length = value_length;
+
+        if (value_length > PACKED_HASH_COMPACT_MAX_ENTRY_LENGTH) {
+            builder->encoding = PACKED_HASH_ENCODING_TABLE;
+        }
+
+        return false;
+    }
+
+    packed_hash_entry_t entry = {
+            .field = field,
+            .field_length = field_length,
+            .value = value,
+            .value_length = value_length,
+    };
+    packed_hash_builder_append(builder, &entry, hash);
+
+    // The deleted entries are counted as well as they are kept in the index
+    if ((uint64_t)builder->entries_count * 2 > builder->index_buckets_count) {
+        packed_hash_builder_index_rebuild(builder, builder->entries_count);
+    } else {
+        packed_hash_builder_index_insert(builder, builder->entries_count - 1);
+    }
+
+    return true;
+}
+
+bool packed_hash_builder_delete(
+        packed_hash_builder_t *builder,
+        char *field,
+        size_t field_length) {
+    uint32_t entry_index = packed_hash_builder_find(
+            builder,
+            field,
+            field_length,
+            packed_hash_hash_field(field, field_length));
+
+    if (entry_index == UINT32_MAX) {
+        return false;
+    }
+
+    builder->entries[entry_index].deleted = true;
+    builder->count--;
+
+    return true;
+}
+
+size_t packed_hash_builder_serialized_length(
+        packed_hash_builder_t *builder) {
+    size_t entries_length = 0;
+
+    for(uint32_t entry_index = 0; entry_index < builder->entries_count; entry_index++) {
+        packed_hash_entry_t *entry = &builder->entries[entry_index].entry;
+
+        if (builder->entries[entry_index].deleted) {
+            continue;
+        }
+
+        entries_length += packed_hash_entry_length(entry->field_length, entry->value_length);
+    }
+
+    // The offsets of the entries in the buckets are 32 bit
+    if (unlikely(entries_length >= UINT32_MAX)) {
+        return 0;
+    }
+
+    builder->serialized_entries_length = entries_length;
+    // The table is built with room for half of the entries more so the fields can be added in place afterwards
+    // without having to rebuild the hash every few changes
+    builder->serialized_buckets_count = builder->encoding == PACKED_HASH_ENCODING_TABLE
+            ? packed_hash_buckets_count_for(
+                    builder->count + (builder->count / 2),
+                    PACKED_HASH_TABLE_BUCKETS_MIN)
+            : 0;
+
+    return sizeof(packed_hash_header_t) +
+        ((size_t)builder->serialized_buckets_count * sizeof(uint32_t)) +
+        builder->serialized_entries_length;
+}
+
+void packed_hash_builder_serialize(
+        packed_hash_builder_t *builder,
+        char *buffer,
+        size_t buffer_length) {
+    packed_hash_header_t *header = (packed_hash_header_t*)buffer;
+    uint32_t *buckets = (uint32_t*)(buffer + sizeof(packed_hash_header_t));
+    uint32_t buckets_mask = builder->serialized_buckets_count - 1;
+    size_t buckets_length = (size_t)builder->serialized_buckets_count * sizeof(uint32_t);
+    char *entries = buffer + sizeof(packed_hash_header_t) + buckets_length;
+    size_t offset = 0;
+
+    assert(buffer_length == sizeof(packed_hash_header_t) + buckets_length + builder->serialized_entries_length);
+
+    memset(header, 0, sizeof(packed_hash_header_t));
+    header->encoding = builder->encoding;
+    header->count = builder->count;
+    header->buckets_count = builder->serialized_buckets_count;
+    header->entries_length = builder->serialized_entries_length;
+
+    memset(buckets, 0, buckets_length);
+
+    for(uint32_t entry_index = 0; entry_index < builder->entries_count; entry_index++) {
+        packed_hash_builder_entry_t *builder_entry = &builder->entries[entry_index];
+        packed_hash_entry_t *entry = &builder_entry->entry;
+
+        if (builder_entry->deleted) {
+            continue;
+        }
+
+        if (builder->encoding == PACKED_HASH_ENCODING_TABLE) {
+            uint32_t bucket_index = builder_entry->hash & buckets_mask;
+            while(buckets[bucket_index] != 0) {
+                bucket_index = (bucket_index + 1) & buckets_mask;
+            }
+
+            buckets[bucket_index] = offset + 1;
+        }
+
+        offset += packed_hash_entry_write(
+                entries + offset,
+                entry->field,
+                entry->field_length,
+                entry->value,
+                entry->value_length);
+    }
+}
+
+uint32_t packed_hash_field_hash(
+        char *field,
+        size_t field_length) {
+    return packed_hash_hash_field(field, field_length);
+}
+
+size_t packed_hash_entry_length(
+        size_t field_length,
+        size_t value_length) {
+    return packed_hash_varint_length(field_length << 1) + field_length +
+        packed_hash_varint_length(value_length) + value_length;
+}
+
+size_t packed_hash_entry_write(
+        char *buffer,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length) {
+    size_t offset = 0;
+
+    offset += packed_hash_varint_write(buffer + offset, field_length << 1);
+    memcpy(buffer + offset, field, field_length);
+    offset += field_length;
+
+    offset += packed_hash_varint_write(buffer + offset, value_length);
+    memcpy(buffer + offset, value, value_length);
+    offset += value_length;
+
+    return offset;
+}
@@ -0,0 +1,356 @@
+#ifndef CACHEGRAND_PACKED_HASH_H
+#define CACHEGRAND_PACKED_HASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PACKED_HASH_COMPACT_MAX_ENTRIES         (128)
+#define PACKED_HASH_COMPACT_MAX_ENTRY_LENGTH    (64)
+#define PACKED_HASH_TABLE_BUCKETS_MIN           (8)
+#define PACKED_HASH_BUILDER_INDEX_BUCKETS_MIN   (16)
+#define PACKED_HASH_VARINT_MAX_LENGTH           (10)
+#define PACKED_HASH_BUCKET_EMPTY                (0)
+#define PACKED_HASH_BUCKET_DELETED              (UINT32_MAX)
+
+enum packed_hash_encoding {
+    PACKED_HASH_ENCODING_COMPACT = 1,
+    PACKED_HASH_ENCODING_TABLE = 2,
+};
+typedef enum packed_hash_encoding packed_hash_encoding_t;
+
+/**
+ * Packed hash
+ *
+ * The hashes are stored as a single blob made of a header, an optional array of buckets and the entries, each entry is
+ * the field followed by the value and both are prefixed by their length encoded as varint, the length of the field is
+ * shifted by one bit to make room for a flag that marks the entries deleted in place.
+ * The small hashes use the compact encoding, without buckets, and are scanned linearly as the entries are short and
+ * close to each other in memory. When a hash grows above PACKED_HASH_COMPACT_MAX_ENTRIES entries or an entry longer
+ * than PACKED_HASH_COMPACT_MAX_ENTRY_LENGTH is added, the hash is upgraded to the table encoding that prepends an
+ * open-addressing table, with linear probing, containing for each bucket the offset of the entry plus one (zero marks
+ * an empty bucket). The table is kept at most half full, counting the buckets of the deleted fields, and is built with
+ * room for half of the entries more to be added in place. A hash is never downgraded back to the compact encoding.
+ */
+typedef struct packed_hash_header packed_hash_header_t;
+struct packed_hash_header {
+    uint8_t encoding;
+    uint8_t reserved[3];
+    uint32_t count;
+    uint32_t buckets_count;
+    uint32_t entries_length;
+    uint32_t deleted_entries_length;
+    uint32_t deleted_buckets_count;
+} __attribute__((packed));
+
+typedef struct packed_hash packed_hash_t;
+struct packed_hash {
+    packed_hash_encoding_t encoding;
+    uint32_t count;
+    uint32_t buckets_count;
+    uint32_t *buckets;
+    char *entries;
+    size_t entries_length;
+};
+
+typedef struct packed_hash_entry packed_hash_entry_t;
+struct packed_hash_entry {
+    char *field;
+    size_t field_length;
+    char *value;
+    size_t value_length;
+};
+
+typedef struct packed_hash_builder_entry packed_hash_builder_entry_t;
+struct packed_hash_builder_entry {
+    packed_hash_entry_t entry;
+    uint32_t hash;
+    bool deleted;
+};
+
+/**
+ * Packed hash builder
+ *
+ * As the blobs are immutable, the changes are applied to a builder that references the entries of the source blob and
+ * the new fields and values, without copying them, and serializes a new blob. The memory referenced by the builder
+ * has to be kept alive by the caller until the builder is serialized.
+ * The builder keeps its own open-addressing index on the entries to avoid a linear scan per change, the deleted
+ * entries are only flagged and left in the index to preserve the probing chains.
+ */
+typedef struct packed_hash_builder packed_hash_builder_t;
+struct packed_hash_builder {
+    packed_hash_encoding_t encoding;
+    packed_hash_builder_entry_t *entries;
+    uint32_t entries_count;
+    uint32_t entries_size;
+    uint32_t count;
+    uint32_t *index;
+    uint32_t index_buckets_count;
+    size_t serialized_entries_length;
+    uint32_t serialized_buckets_count;
+};
+
+/**
+ * Parse and validate a serialized packed hash, the packed hash references the data passed that has to be kept alive
+ *
+ * @param packed_hash The packed hash to initialize
+ * @param data The serialized packed hash
+ * @param data_length The length of the serialized packed hash
+ * @return true if the data contains a valid packed hash, false otherwise
+ */
+bool packed_hash_init(
+        packed_hash_t *packed_hash,
+        char *data,
+        size_t data_length);
+
+/**
+ * Search for a field in the packed hash
+ *
+ * @param packed_hash The packed hash
+ * @param field The field to search
+ * @param field_length The length of the field
+ * @param entry Filled with the entry if found
+ * @return true if the field has been found, false otherwise
+ */
+bool packed_hash_get(
+        packed_hash_t *packed_hash,
+        char *field,
+        size_t field_length,
+        packed_hash_entry_t *entry);
+
+/**
+ * Iterate the entries of the packed hash in insertion order
+ *
+ * @param packed_hash The packed hash
+ * @param offset The offset of the entry to read, it's updated to point to the next entry, has to be 0 on the first call
+ * @param entry Filled with the entry read
+ * @return true if an entry has been read, false if there are no more entries
+ */
+bool packed_hash_iter_next(
+        packed_hash_t *packed_hash,
+        size_t *offset,
+        packed_hash_entry_t *entry);
+
+/**
+ * Read the entry pointed by a bucket of a packed hash using the table encoding
+ *
+ * @param packed_hash The packed hash
+ * @param bucket_index The index of the bucket
+ * @param entry Filled with the entry if the bucket is not empty
+ * @return true if the bucket is not empty, false otherwise
+ */
+bool packed_hash_bucket_get(
+        packed_hash_t *packed_hash,
+        uint32_t bucket_index,
+        packed_hash_entry_t *entry);
+
+/**
+ * Initialize a builder, optionally starting from the entries of an existing packed hash
+ *
+ * @param builder The builder to initialize
+ * @param packed_hash The source packed hash, can be NULL to build a new one
+ */
+void packed_hash_builder_init(
+        packed_hash_builder_t *builder,
+        packed_hash_t *packed_hash);
+
+/**
+ * Free the memory allocated by the builder, the fields and values referenced are not touched
+ *
+ * @param builder The builder
+ */
+void packed_hash_builder_free(
+        packed_hash_builder_t *builder);
+
+/**
+ * Search for a field in the builder
+ *
+ * @param builder The builder
+ * @param field The field to search
+ * @param field_length The length of the field
+ * @param entry Filled with the entry if found
+ * @return true if the field has been found, false otherwise
+ */
+bool packed_hash_builder_get(
+        packed_hash_builder_t *builder,
+        char *field,
+        size_t field_length,
+        packed_hash_entry_t *entry);
+
+/**
+ * Set the value of a field, if the field already exists its value is replaced in place
+ *
+ * @param builder The builder
+ * @param field The field to set
+ * @param field_length The length of the field
+ * @param value The value to set
+ * @param value_length The length of the value
+ * @return true if the field has been added, false if it already existed
+ */
+bool packed_hash_builder_set(
+        packed_hash_builder_t *builder,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length);
+
+/**
+ * Delete a field
+ *
+ * @param builder The builder
+ * @param field The field to delete
+ * @param field_length The length of the field
+ * @return true if the field has been deleted, false if it didn't exist
+ */
+bool packed_hash_builder_delete(
+        packed_hash_builder_t *builder,
+        char *field,
+        size_t field_length);
+
+/**
+ * Calculate the length of the serialized packed hash, it also picks the encoding
+ *
+ * @param builder The builder
+ * @return The length in bytes of the serialized packed hash or 0 if the entries don't fit in a packed hash
+ */
+size_t packed_hash_builder_serialized_length(
+        packed_hash_builder_t *builder);
+
+/**
+ * Serialize the builder into the buffer, packed_hash_builder_serialized_length has to be invoked first to calculate
+ * the length of the buffer
+ *
+ * @param builder The builder
+ * @param buffer The buffer where to serialize the packed hash
+ * @param buffer_length The length of the buffer
+ */
+void packed_hash_builder_serialize(
+        packed_hash_builder_t *builder,
+        char *buffer,
+        size_t buffer_length);
+
+/**
+ * Packed hash changes in place
+ *
+ * The table encoding can also be changed in place by the owner of the blob, without rebuilding it: a new entry, or
+ * an existing field with a value of a different length, is appended after the other entries, the entry replaced is
+ * flagged as deleted and the bucket of a deleted field is set to PACKED_HASH_BUCKET_DELETED to keep the probing chains
+ * intact. The functions below only deal with the encoding, the blob has to be rebuilt via the builder when the table
+ * has no room left or when the deleted entries take up too much space.
+ */
+
+/**
+ * Calculate the hash of a field used to pick its bucket
+ *
+ * @param field The field
+ * @param field_length The length of the field
+ * @return The hash of the field
+ */
+uint32_t packed_hash_field_hash(
+        char *field,
+        size_t field_length);
+
+/**
+ * Calculate the length of an entry once serialized
+ *
+ * @param field_length The length of the field
+ * @param value_length The length of the value
+ * @return The length of the serialized entry
+ */
+size_t packed_hash_entry_length(
+        size_t field_length,
+        size_t value_length);
+
+/**
+ * Serialize an entry, the buffer has to be at least packed_hash_entry_length bytes long
+ *
+ * @param buffer The buffer where to serialize the entry
+ * @param field The field
+ * @param field_length The length of the field
+ * @param value The value
+ * @param value_length The length of the value
+ * @return The length of the serialized entry
+ */
+size_t packed_hash_entry_write(
+        char *buffer,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length);
+
+/**
+ * Read the length of the field at the beginning of an entry
+ *
+ * @param buffer The buffer containing the entry
+ * @param buffer_length The length of the buffer
+ * @param offset The offset of the entry, it's updated to point to the field
+ * @param field_length Set to the length of the field
+ * @param deleted Set to true if the entry has been deleted
+ * @return true if the length has been read, false if the buffer is too short or the varint is invalid
+ */
+bool packed_hash_entry_field_length_read(
+        char *buffer,
+        size_t buffer_length,
+        size_t *offset,
+        size_t *field_length,
+        bool *deleted);
+
+/**
+ * Read the length of the value following the field of an entry
+ *
+ * @param buffer The buffer containing the entry
+ * @param buffer_length The length of the buffer
+ * @param offset The offset of the length of the value, it's updated to point to the value
+ * @param value_length Set to the length of the value
+ * @return true if the length has been read, false if the buffer is too short or the varint is invalid
+ */
+bool packed_hash_entry_value_length_read(
+        char *buffer,
+        size_t buffer_length,
+        size_t *offset,
+        size_t *value_length);
+
+/**
+ * Flag an entry as deleted, the length of the entry doesn't change
+ *
+ * @param entry The first byte of the entry
+ */
+static inline void packed_hash_entry_mark_deleted(
+        char *entry) {
+    *entry = (char)(*entry | 1);
+}
+
+/**
+ * Check if fields can be added in place to a packed hash using the table encoding without exceeding the load factor
+ *
+ * @param header The header of the packed hash
+ * @param fields_count The number of fields to add
+ * @return true if there is room for the fields, false if the table has to be rebuilt
+ */
+static inline bool packed_hash_header_table_has_room(
+        packed_hash_header_t *header,
+        uint32_t fields_count) {
+    return ((uint64_t)header->count + header->deleted_buckets_count + fields_count) * 2 <= header->buckets_count;
+}
+
+/**
+ * Check if the entries deleted in place take up more than half of the entries of the packed hash
+ *
+ * @param header The header of the packed hash
+ * @return true if the packed hash has to be rebuilt to drop the deleted entries
+ */
+static inline bool packed_hash_header_needs_compaction(
+        packed_hash_header_t *header) {
+    return (uint64_t)header->deleted_entries_length * 2 > header->entries_length;
+}
+
+static inline uint32_t packed_hash_builder_count(
+        packed_hash_builder_t *builder) {
+    return builder->count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_PACKED_HASH_H
@@ -0,0 +1,584 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "xalloc.h"
+
+#include "packed_list.h"
+
+#define TAG "packed_list"
+
+static inline size_t packed_list_varint_length(
+        size_t value) {
+    size_t length = 1;
+    while(value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+
+    return length;
+}
+
+static inline size_t packed_list_varint_write(
+        char *buffer,
+        size_t value) {
+    size_t length = 0;
+    while(value >= 0x80) {
+        buffer[length++] = (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (char)value;
+
+    return length;
+}
+
+static inline bool packed_list_varint_read(
+        char *buffer,
+        size_t buffer_length,
+        size_t *offset,
+        size_t *value) {
+    size_t result = 0;
+
+    for(uint8_t index = 0; index < PACKED_LIST_VARINT_MAX_LENGTH; index++) {
+        if (unlikely(*offset >= buffer_length)) {
+            return false;
+        }
+
+        uint8_t byte = (uint8_t)buffer[(*offset)++];
+        result |= (size_t)(byte & 0x7F) << (7 * index);
+
+        if (likely((byte & 0x80) == 0)) {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline size_t packed_list_entry_length(
+        size_t value_length) {
+    return packed_list_varint_length(value_length) + value_length;
+}
+
+static bool packed_list_entry_read(
+        char *buffer,
+        size_t buffer_length,
+        size_t *offset,
+        packed_list_entry_t *entry) {
+    if (unlikely(!packed_list_varint_read(buffer, buffer_length, offset, &entry->value_length))) {
+        return false;
+    }
+
+    if (unlikely(entry->value_length > buffer_length - *offset)) {
+        return false;
+    }
+
+    entry->value = buffer + *offset;
+    *offset += entry->value_length;
+
+    return true;
+}
+
+bool packed_list_init(
+        packed_list_t *packed_list,
+        char *data,
+        size_t data_length) {
+    packed_list_header_t *header = (packed_list_header_t*)data;
+    uint64_t count = 0;
+    size_t offset = 0;
+
+    if (unlikely(data_length < sizeof(packed_list_header_t))) {
+        return false;
+    }
+
+    if (unlikely(sizeof(packed_list_header_t) + header->nodes_length != data_length)) {
+        return false;
+    }
+
+    packed_list->count = header->count;
+    packed_list->nodes_count = header->nodes_count;
+    packed_list->nodes = data + sizeof(packed_list_header_t);
+    packed_list->nodes_length = header->nodes_length;
+
+    // Only the node headers are validated, the nodes are skipped when accessed so they have to be consistent
+    for(uint32_t node_index = 0; node_index < packed_list->nodes_count; node_index++) {
+        packed_list_node_header_t *node_header = (packed_list_node_header_t*)(packed_list->nodes + offset);
+
+        if (unlikely(packed_list->nodes_length - offset < sizeof(packed_list_node_header_t))) {
+            return false;
+        }
+
+        offset += sizeof(packed_list_node_header_t);
+        if (unlikely(
+                node_header->count == 0 ||
+                node_header->count > PACKED_LIST_NODE_MAX_ENTRIES ||
+                node_header->length > packed_list->nodes_length - offset)) {
+            return false;
+        }
+
+        offset += node_header->length;
+        count += node_header->count;
+    }
+
+    return offset == packed_list->nodes_length && count == packed_list->count;
+}
+
+bool packed_list_iter_init(
+        packed_list_t *packed_list,
+        packed_list_iter_t *iter,
+        uint32_t index) {
+    size_t node_offset = 0;
+
+    if (index >= packed_list->count) {
+        return false;
+    }
+
+    iter->packed_list = packed_list;
+
+    for(uint32_t node_index = 0; node_index < packed_list->nodes_count; node_index++) {
+        packed_list_node_header_t *node_header = (packed_list_node_header_t*)(packed_list->nodes + node_offset);
+
+        if (index >= node_header->count) {
+            index -= node_header->count;
+            node_offset += sizeof(packed_list_node_header_t) + node_header->length;
+            continue;
+        }
+
+        iter->node_offset = node_offset;
+        iter->node_remaining = packed_list->nodes_count - node_index - 1;
+        iter->entry_offset = node_offset + sizeof(packed_list_node_header_t);
+        iter->entry_offset_end = iter->entry_offset + node_header->length;
+
+        // Skip the entries of the node preceding the requested one
+        while(index > 0) {
+            packed_list_entry_t entry;
+            if (unlikely(!packed_list_entry_read(
+                    packed_list->nodes,
+                    iter->entry_offset_end,
+                    &iter->entry_offset,
+                    &entry))) {
+                return false;
+            }
+
+            index--;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool packed_list_iter_next(
+        packed_list_iter_t *iter,
+        packed_list_entry_t *entry) {
+    packed_list_t *packed_list = iter->packed_list;
+
+    if (iter->entry_offset >= iter->entry_offset_end) {
+        if (iter->node_remaining == 0) {
+            return false;
+        }
+
+        iter->node_offset = iter->entry_offset_end;
+        iter->node_remaining--;
+
+        packed_list_node_header_t *node_header = (packed_list_node_header_t*)(packed_list->nodes + iter->node_offset);
+        iter->entry_offset = iter->node_offset + sizeof(packed_list_node_header_t);
+        iter->entry_offset_end = iter->entry_offset + node_header->length;
+    }
+
+    return packed_list_entry_read(
+            packed_list->nodes,
+            iter->entry_offset_end,
+            &iter->entry_offset,
+            entry);
+}
+
+bool packed_list_get(
+        packed_list_t *packed_list,
+        uint32_t index,
+        packed_list_entry_t *entry) {
+    packed_list_iter_t iter;
+
+    if (!packed_list_iter_init(packed_list, &iter, index)) {
+        return false;
+    }
+
+    return packed_list_iter_next(&iter, entry);
+}
+
+static void packed_list_builder_node_decode(
+        packed_list_builder_node_t *node) {
+    size_t offset = 0;
+
+    if (node->entries) {
+        return;
+    }
+
+    node->entries = xalloc_alloc(sizeof(packed_list_entry_t) * PACKED_LIST_NODE_MAX_ENTRIES);
+
+    for(uint32_t entry_index = 0; entry_index < node->count; entry_index++) {
+        bool res = packed_list_entry_read(node->data, node->length, &offset, &node->entries[entry_index]);
+        assert(res);
+        (void)res;
+    }
+
+    node->data = NULL;
+}
+
+static void packed_list_builder_node_free(
+        packed_list_builder_node_t *node) {
+    if (node->entries) {
+        xalloc_free(node->entries);
+        node->entries = NULL;
+    }
+}
+
+static bool packed_list_builder_node_is_full(
+        packed_list_builder_node_t *node,
+        size_t value_length) {
+    // A node always accepts at least one entry, no matter how long it is
+    return node->count >= PACKED_LIST_NODE_MAX_ENTRIES ||
+        (node->count > 0 && node->length + packed_list_entry_length(value_length) > PACKED_LIST_NODE_MAX_LENGTH);
+}
+
+static packed_list_builder_node_t *packed_list_builder_node_insert(
+        packed_list_builder_t *builder,
+        uint32_t node_index) {
+    if (builder->nodes_count == builder->nodes_size) {
+        builder->nodes_size *= 2;
+        builder->nodes = xalloc_realloc(
+                builder->nodes,
+                sizeof(packed_list_builder_node_t) * builder->nodes_size);
+    }
+
+    memmove(
+            &builder->nodes[node_index + 1],
+            &builder->nodes[node_index],
+            sizeof(packed_list_builder_node_t) * (builder->nodes_count - node_index));
+    builder->nodes_count++;
+
+    packed_list_builder_node_t *node = &builder->nodes[node_index];
+    memset(node, 0, sizeof(packed_list_builder_node_t));
+    node->entries = xalloc_alloc(sizeof(packed_list_entry_t) * PACKED_LIST_NODE_MAX_ENTRIES);
+
+    return node;
+}
+
+static void packed_list_builder_node_remove(
+        packed_list_builder_t *builder,
+        uint32_t node_index) {
+    packed_list_builder_node_free(&builder->nodes[node_index]);
+
+    memmove(
+            &builder->nodes[node_index],
+            &builder->nodes[node_index + 1],
+            sizeof(packed_list_builder_node_t) * (builder->nodes_count - node_index - 1));
+    builder->nodes_count--;
+}
+
+void packed_list_builder_init(
+        packed_list_builder_t *builder,
+        packed_list_t *packed_list) {
+    uint32_t nodes_count = packed_list ? packed_list->nodes_count : 0;
+    size_t offset = 0;
+
+    memset(builder, 0, sizeof(packed_list_builder_t));
+    builder->nodes_size = MAX(nodes_count + 2, PACKED_LIST_BUILDER_NODES_MIN);
+    builder->nodes = xalloc_alloc(sizeof(packed_list_builder_node_t) * builder->nodes_size);
+
+    for(uint32_t node_index = 0; node_index < nodes_count; node_index++) {
+        packed_list_node_header_t *node_header = (packed_list_node_header_t*)(packed_list->nodes + offset);
+        packed_list_builder_node_t *node = &builder->nodes[node_index];
+
+        node->data = packed_list->nodes + offset + sizeof(packed_list_node_header_t);
+        node->count = node_header->count;
+        node->length = node_header->length;
+        node->entries = NULL;
+
+        offset += sizeof(packed_list_node_header_t) + node_header->length;
+    }
+
+    builder->nodes_count = nodes_count;
+    builder->count = packed_list ? packed_list->count : 0;
+}
+
+void packed_list_builder_free(
+        packed_list_builder_t *builder) {
+    for(uint32_t node_index = 0; node_index < builder->nodes_count; node_index++) {
+        packed_list_builder_node_free(&builder->nodes[node_index]);
+    }
+
+    xalloc_free(builder->nodes);
+    builder->nodes = NULL;
+    builder->nodes_count = 0;
+}
+
+void packed_list_builder_push(
+        packed_list_builder_t *builder,
+        bool head,
+        char *value,
+        size_t value_length) {
+    packed_list_builder_node_t *node = NULL;
+
+    if (builder->nodes_count > 0) {
+        node = &builder->nodes[head ? 0 : builder->nodes_count - 1];
+        if (packed_list_builder_node_is_full(node, value_length)) {
+            node = NULL;
+        }
+    }
+
+    if (node == NULL) {
+        node = packed_list_builder_node_insert(builder, head ? 0 : builder->nodes_count);
+    }
+
+    packed_list_builder_node_decode(node);
+
+    uint32_t entry_index = node->count;
+    if (head) {
+        memmove(&node->entries[1], &node->entries[0], sizeof(packed_list_entry_t) * node->count);
+        entry_index = 0;
+    }
+
+    node->entries[entry_index].value = value;
+    node->entries[entry_index].value_length = value_length;
+    node->count++;
+    node->length += packed_list_entry_length(value_length);
+
+    builder->count++;
+}
+
+bool packed_list_builder_pop(
+        packed_list_builder_t *builder,
+        bool head,
+        packed_list_entry_t *entry) {
+    if (builder->nodes_count == 0) {
+        return false;
+    }
+
+    uint32_t node_index = head ? 0 : builder->nodes_count - 1;
+    packed_list_builder_node_t *node = &builder->nodes[node_index];
+
+    packed_list_builder_node_decode(node);
+
+    if (head) {
+        *entry = node->entries[0];
+        memmove(&node->entries[0], &node->entries[1], sizeof(packed_list_entry_t) * (node->count - 1));
+    } else {
+        *entry = node->entries[node->count - 1];
+    }
+
+    node->count--;
+    node->length -= packed_list_entry_length(entry->value_length);
+    builder->count--;
+
+    if (node->count == 0) {
+        packed_list_builder_node_remove(builder, node_index);
+    }
+
+    return true;
+}
+
+void packed_list_builder_trim(
+        packed_list_builder_t *builder,
+        uint32_t start,
+        uint32_t stop) {
+    uint32_t nodes_count = 0;
+    uint32_t node_first_entry_index = 0;
+
+    assert(start <= stop && stop < builder->count);
+
+    for(uint32_t node_index = 0; node_index < builder->nodes_count; node_index++) {
+        packed_list_builder_node_t node = builder->nodes[node_index];
+        uint32_t node_last_entry_index = node_first_entry_index + node.count - 1;
+
+        // The nodes entirely outside of the range are dropped without decoding them
+        if (node_last_entry_index < start || node_first_entry_index > stop) {
+            node_first_entry_index += node.count;
+            packed_list_builder_node_free(&node);
+            continue;
+        }
+
+        if (node_first_entry_index < start || node_last_entry_index > stop) {
+            uint32_t keep_from = start > node_first_entry_index ? start - node_first_entry_index : 0;
+            uint32_t keep_to = MIN(stop, node_last_entry_index) - node_first_entry_index;
+
+            packed_list_builder_node_decode(&node);
+
+            memmove(
+                    &node.entries[0],
+                    &node.entries[keep_from],
+                    sizeof(packed_list_entry_t) * (keep_to - keep_from + 1));
+
+            node.count = keep_to - keep_from + 1;
+            node.length = 0;
+            for(uint32_t entry_index = 0; entry_index < node.count; entry_index++) {
+                node.length += packed_list_entry_length(node.entries[entry_index].value_length);
+            }
+        }
+
+        node_first_entry_index += builder->nodes[node_index].count;
+        builder->nodes[nodes_count++] = node;
+    }
+
+    builder->nodes_count = nodes_count;
+    builder->count = stop - start + 1;
+}
+
+size_t packed_list_builder_serialized_length(
+        packed_list_builder_t *builder) {
+    size_t nodes_length = 0;
+
+    for(uint32_t node_index = 0; node_index < builder->nodes_count; node_index++) {
+        packed_list_builder_node_t *node = &builder->nodes[node_index];
+
+        // The length of the nodes is 32 bit
+        if (unlikely(node->length >= UINT32_MAX)) {
+            return 0;
+        }
+
+        nodes_length += sizeof(packed_list_node_header_t) + node->length;
+    }
+
+    builder->serialized_nodes_length = nodes_length;
+
+    return sizeof(packed_list_header_t) + builder->serialized_nodes_length;
+}
+
+void packed_list_builder_serialize(
+        packed_list_builder_t *builder,
+        char *buffer,
+        size_t buffer_length) {
+    packed_list_header_t *header = (packed_list_header_t*)buffer;
+    char *nodes = buffer + sizeof(packed_list_header_t);
+    size_t offset = 0;
+
+    assert(buffer_length == sizeof(packed_list_header_t) + builder->serialized_nodes_length);
+
+    header->count = builder->count;
+    header->nodes_count = builder->nodes_count;
+    header->nodes_length = builder->serialized_nodes_length;
+
+    for(uint32_t node_index = 0; node_index < builder->nodes_count; node_index++) {
+        packed_list_builder_node_t *node = &builder->nodes[node_index];
+        packed_list_node_header_t *node_header = (packed_list_node_header_t*)(nodes + offset);
+
+        node_header->count = node->count;
+        node_header->length = node->length;
+        offset += sizeof(packed_list_node_header_t);
+
+        // The nodes that haven't been changed are copied as they are
+        if (node->entries == NULL) {
+            memcpy(nodes + offset, node->data, node->length);
+            offset += node->length;
+            continue;
+        }
+
+        for(uint32_t entry_index = 0; entry_index < node->count; entry_index++) {
+            packed_list_entry_t *entry = &node->entries[entry_index];
+
+            offset += packed_list_varint_write(nodes + offset, entry->value_length);
+            memcpy(nodes + offset, entry->value, entry->value_length);
+            offset += entry->value_length;
+        }
+    }
+}
+
+size_t packed_list_node_entry_length(
+        size_t value_length) {
+    return packed_list_entry_length(value_length);
+}
+
+void packed_list_node_init(
+        char *node) {
+    packed_list_node_header_t *node_header = (packed_list_node_header_t*)node;
+
+    node_header->count = 0;
+    node_header->length = 0;
+}
+
+bool packed_list_node_has_room(
+        char *node,
+        size_t value_length) {
+    packed_list_node_header_t *node_header = (packed_list_node_header_t*)node;
+
+    // Same limits used by the builder, a node always accepts at least one entry
+    return node_header->count < PACKED_LIST_NODE_MAX_ENTRIES &&
+        (node_header->count == 0 ||
+         node_header->length + packed_list_entry_length(value_length) <= PACKED_LIST_NODE_MAX_LENGTH);
+}
+
+void packed_list_node_push(
+        char *node,
+        bool head,
+        char *value,
+        size_t value_length) {
+    packed_list_node_header_t *node_header = (packed_list_node_header_t*)node;
+    char *entries = node + sizeof(packed_list_node_header_t);
+    size_t entry_length = packed_list_entry_length(value_length);
+    size_t offset = node_header->length;
+
+    if (head) {
+        memmove(entries + entry_length, entries, node_header->length);
+        offset = 0;
+    }
+
+    offset += packed_list_varint_write(entries + offset, value_length);
+    memcpy(entries + offset, value, value_length);
+
+    node_header->count++;
+    node_header->length += entry_length;
+}
+
+bool packed_list_node_edge_get(
+        char *node,
+        bool head,
+        packed_list_entry_t *entry) {
+    packed_list_node_header_t *node_header = (packed_list_node_header_t*)node;
+    char *entries = node + sizeof(packed_list_node_header_t);
+    size_t offset = 0;
+    uint32_t entries_to_read = head ? 1 : node_header->count;
+
+    if (unlikely(node_header->count == 0)) {
+        return false;
+    }
+
+    // The entries are prefixed by their length so the last one can be reached only scanning the node
+    for(uint32_t entry_index = 0; entry_index < entries_to_read; entry_index++) {
+        if (unlikely(!packed_list_entry_read(entries, node_header->length, &offset, entry))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void packed_list_node_edge_remove(
+        char *node,
+        bool head,
+        packed_list_entry_t *entry) {
+    packed_list_node_header_t *node_header = (packed_list_node_header_t*)node;
+    char *entries = node + sizeof(packed_list_node_header_t);
+    size_t entry_length = packed_list_entry_length(entry->value_length);
+
+    assert(node_header->count > 0 && node_header->length >= entry_length);
+
+    if (head) {
+        memmove(entries, entries + entry_length, node_header->length - entry_length);
+    }
+
+    node_header->count--;
+    node_header->length -= entry_length;
+}
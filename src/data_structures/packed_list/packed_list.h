@@ -0,0 +1,300 @@
+#ifndef CACHEGRAND_PACKED_LIST_H
+#define CACHEGRAND_PACKED_LIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PACKED_LIST_NODE_MAX_ENTRIES            (128)
+#define PACKED_LIST_NODE_MAX_LENGTH             (8 * 1024)
+#define PACKED_LIST_BUILDER_NODES_MIN           (8)
+#define PACKED_LIST_VARINT_MAX_LENGTH           (10)
+
+/**
+ * Packed list
+ *
+ * The lists are stored as a single immutable blob made of a header followed by a sequence of nodes, each node has its
+ * own header, with the number of entries and the length of the node, followed by the entries, each one prefixed by its
+ * length encoded as varint.
+ * The nodes hold at most PACKED_LIST_NODE_MAX_ENTRIES entries or PACKED_LIST_NODE_MAX_LENGTH bytes, unless the node
+ * contains a single entry, so accessing an entry by index only requires to skip the nodes preceding it and to scan
+ * one node linearly.
+ */
+typedef struct packed_list_header packed_list_header_t;
+struct packed_list_header {
+    uint32_t count;
+    uint32_t nodes_count;
+    uint64_t nodes_length;
+} __attribute__((packed));
+
+typedef struct packed_list_node_header packed_list_node_header_t;
+struct packed_list_node_header {
+    uint32_t count;
+    uint32_t length;
+} __attribute__((packed));
+
+typedef struct packed_list packed_list_t;
+struct packed_list {
+    uint32_t count;
+    uint32_t nodes_count;
+    char *nodes;
+    size_t nodes_length;
+};
+
+typedef struct packed_list_entry packed_list_entry_t;
+struct packed_list_entry {
+    char *value;
+    size_t value_length;
+};
+
+typedef struct packed_list_iter packed_list_iter_t;
+struct packed_list_iter {
+    packed_list_t *packed_list;
+    size_t node_offset;
+    uint32_t node_remaining;
+    size_t entry_offset;
+    size_t entry_offset_end;
+};
+
+/**
+ * Packed list builder
+ *
+ * As the blobs are immutable, the changes are applied to a builder that keeps the nodes of the source blob untouched
+ * and decodes only the nodes that are changed, as the entries are always pushed or popped at the head or at the tail
+ * only the nodes at the edges are decoded and the other ones are copied as they are when serializing.
+ * As for the packed hash, the builder references the entries without copying them, the memory referenced has to be
+ * kept alive by the caller until the builder is serialized.
+ */
+typedef struct packed_list_builder_node packed_list_builder_node_t;
+struct packed_list_builder_node {
+    char *data;
+    uint32_t count;
+    size_t length;
+    packed_list_entry_t *entries;
+};
+
+typedef struct packed_list_builder packed_list_builder_t;
+struct packed_list_builder {
+    packed_list_builder_node_t *nodes;
+    uint32_t nodes_count;
+    uint32_t nodes_size;
+    uint32_t count;
+    size_t serialized_nodes_length;
+};
+
+/**
+ * Parse and validate a serialized packed list, the packed list references the data passed that has to be kept alive
+ *
+ * @param packed_list The packed list to initialize
+ * @param data The serialized packed list
+ * @param data_length The length of the serialized packed list
+ * @return true if the data contains a valid packed list, false otherwise
+ */
+bool packed_list_init(
+        packed_list_t *packed_list,
+        char *data,
+        size_t data_length);
+
+/**
+ * Initialize an iterator positioned on the entry at the given index, the nodes before the one containing the entry
+ * are skipped without reading their entries
+ *
+ * @param packed_list The packed list
+ * @param iter The iterator to initialize
+ * @param index The index of the first entry to return
+ * @return true if the index is within the list, false otherwise
+ */
+bool packed_list_iter_init(
+        packed_list_t *packed_list,
+        packed_list_iter_t *iter,
+        uint32_t index);
+
+/**
+ * Read the next entry of the iterator
+ *
+ * @param iter The iterator
+ * @param entry Filled with the entry read
+ * @return true if an entry has been read, false if there are no more entries
+ */
+bool packed_list_iter_next(
+        packed_list_iter_t *iter,
+        packed_list_entry_t *entry);
+
+/**
+ * Read the entry at the given index
+ *
+ * @param packed_list The packed list
+ * @param index The index of the entry
+ * @param entry Filled with the entry if found
+ * @return true if the index is within the list, false otherwise
+ */
+bool packed_list_get(
+        packed_list_t *packed_list,
+        uint32_t index,
+        packed_list_entry_t *entry);
+
+/**
+ * Initialize a builder, optionally starting from the nodes of an existing packed list
+ *
+ * @param builder The builder to initialize
+ * @param packed_list The source packed list, can be NULL to build a new one
+ */
+void packed_list_builder_init(
+        packed_list_builder_t *builder,
+        packed_list_t *packed_list);
+
+/**
+ * Free the memory allocated by the builder, the entries referenced are not touched
+ *
+ * @param builder The builder
+ */
+void packed_list_builder_free(
+        packed_list_builder_t *builder);
+
+/**
+ * Push an entry at the head or at the tail of the list
+ *
+ * @param builder The builder
+ * @param head true to push the entry at the head, false to push it at the tail
+ * @param value The value to push
+ * @param value_length The length of the value
+ */
+void packed_list_builder_push(
+        packed_list_builder_t *builder,
+        bool head,
+        char *value,
+        size_t value_length);
+
+/**
+ * Pop an entry from the head or from the tail of the list, the entry references the memory passed to the builder
+ *
+ * @param builder The builder
+ * @param head true to pop the entry from the head, false to pop it from the tail
+ * @param entry Filled with the entry popped
+ * @return true if an entry has been popped, false if the list is empty
+ */
+bool packed_list_builder_pop(
+        packed_list_builder_t *builder,
+        bool head,
+        packed_list_entry_t *entry);
+
+/**
+ * Keep only the entries between start and stop, both included, the nodes outside the range are dropped without
+ * decoding them
+ *
+ * @param builder The builder
+ * @param start The index of the first entry to keep
+ * @param stop The index of the last entry to keep, has to be greater or equal than start and within the list
+ */
+void packed_list_builder_trim(
+        packed_list_builder_t *builder,
+        uint32_t start,
+        uint32_t stop);
+
+/**
+ * Calculate the length of the serialized packed list
+ *
+ * @param builder The builder
+ * @return The length in bytes of the serialized packed list or 0 if the entries don't fit in a packed list
+ */
+size_t packed_list_builder_serialized_length(
+        packed_list_builder_t *builder);
+
+/**
+ * Serialize the builder into the buffer, packed_list_builder_serialized_length has to be invoked first to calculate
+ * the length of the buffer
+ *
+ * @param builder The builder
+ * @param buffer The buffer where to serialize the packed list
+ * @param buffer_length The length of the buffer
+ */
+void packed_list_builder_serialize(
+        packed_list_builder_t *builder,
+        char *buffer,
+        size_t buffer_length);
+
+/**
+ * Packed list nodes
+ *
+ * When the nodes are stored separately, e.g. one per chunk, the node at the head or at the tail can be changed on its
+ * own, the functions below operate on a single node, made of its header followed by the entries.
+ */
+
+/**
+ * Calculate the length of an entry once serialized, including the varint prefix
+ *
+ * @param value_length The length of the value
+ * @return The length of the serialized entry
+ */
+size_t packed_list_node_entry_length(
+        size_t value_length);
+
+/**
+ * Initialize an empty node
+ *
+ * @param node The node
+ */
+void packed_list_node_init(
+        char *node);
+
+/**
+ * Check if an entry can be added to the node without exceeding its limits
+ *
+ * @param node The node
+ * @param value_length The length of the value to add
+ * @return true if the node has room for the entry, false otherwise
+ */
+bool packed_list_node_has_room(
+        char *node,
+        size_t value_length);
+
+/**
+ * Push an entry at the head or at the tail of the node, the node has to have been grown by the length of the entry
+ *
+ * @param node The node
+ * @param head true to push the entry at the head, false to push it at the tail
+ * @param value The value to push
+ * @param value_length The length of the value
+ */
+void packed_list_node_push(
+        char *node,
+        bool head,
+        char *value,
+        size_t value_length);
+
+/**
+ * Read the entry at the head or at the tail of the node, the entry references the node
+ *
+ * @param node The node
+ * @param head true to read the entry at the head, false to read the one at the tail
+ * @param entry Filled with the entry read
+ * @return true if the entry has been read, false if the node is empty or corrupted
+ */
+bool packed_list_node_edge_get(
+        char *node,
+        bool head,
+        packed_list_entry_t *entry);
+
+/**
+ * Remove the entry at the head or at the tail of the node previously read via packed_list_node_edge_get, the entry
+ * can't be accessed anymore once removed
+ *
+ * @param node The node
+ * @param head true to remove the entry at the head, false to remove the one at the tail
+ * @param entry The entry read via packed_list_node_edge_get
+ */
+void packed_list_node_edge_remove(
+        char *node,
+        bool head,
+        packed_list_entry_t *entry);
+
+static inline uint32_t packed_list_builder_count(
+        packed_list_builder_t *builder) {
+    return builder->count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_PACKED_LIST_H
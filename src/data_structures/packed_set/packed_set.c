@@ -0,0 +1,397 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "xalloc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+
+#include "packed_set.h"
+#include "packed_set_intset.h"
+
+#define TAG "packed_set"
+
+#define PACKED_SET_BUILDER_INTEGERS_MIN         (8)
+
+// The members of the sets using the hash encoding are stored as fields of a packed hash with an empty value
+static char packed_set_hash_value_empty[] = "";
+
+bool packed_set_integer_parse(
+        char *value,
+        size_t value_length,
+        int64_t *integer) {
+    size_t index = 0;
+    bool negative = false;
+    uint64_t result = 0;
+
+    if (value_length == 0 || value_length > PACKED_SET_INTEGER_MAX_LENGTH) {
+        return false;
+    }
+
+    if (value_length == 1 && value[0] == '0') {
+        *integer = 0;
+        return true;
+    }
+
+    if (value[0] == '-') {
+        negative = true;
+        index++;
+    }
+
+    // Leading zeros, and therefore -0, are not part of the canonical representation
+    if (index == value_length || value[index] < '1' || value[index] > '9') {
+        return false;
+    }
+
+    for(; index < value_length; index++) {
+        if (value[index] < '0' || value[index] > '9') {
+            return false;
+        }
+
+        uint64_t digit = value[index] - '0';
+        if (result > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+
+        result = (result * 10) + digit;
+    }
+
+    if (negative) {
+        if (result > (uint64_t)INT64_MAX + 1) {
+            return false;
+        }
+
+        *integer = result == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)result;
+    } else {
+        if (result > INT64_MAX) {
+            return false;
+        }
+
+        *integer = (int64_t)result;
+    }
+
+    return true;
+}
+
+size_t packed_set_integer_to_string(
+        int64_t integer,
+        char *buffer) {
+    return snprintf(buffer, PACKED_SET_INTEGER_MAX_LENGTH + 1, "%ld", integer);
+}
+
+bool packed_set_init(
+        packed_set_t *packed_set,
+        char *data,
+        size_t data_length) {
+    packed_set_header_t *header = (packed_set_header_t*)data;
+
+    if (unlikely(data_length < sizeof(packed_set_header_t))) {
+        return false;
+    }
+
+    if (header->encoding == PACKED_SET_ENCODING_INTSET) {
+        if (unlikely(
+                header->count > PACKED_SET_INTSET_MAX_ENTRIES ||
+                sizeof(packed_set_header_t) + ((size_t)header->count * sizeof(int64_t)) != data_length)) {
+            return false;
+        }
+
+        packed_set->integers = (int64_t*)(data + sizeof(packed_set_header_t));
+    } else if (header->encoding == PACKED_SET_ENCODING_HASH) {
+        if (unlikely(!packed_hash_init(
+                &packed_set->packed_hash,
+                data + sizeof(packed_set_header_t),
+                data_length - sizeof(packed_set_header_t)))) {
+            return false;
+        }
+
+        if (unlikely(packed_set->packed_hash.count != header->count)) {
+            return false;
+        }
+
+        packed_set->integers = NULL;
+    } else {
+        return false;
+    }
+
+    packed_set->encoding = header->encoding;
+    packed_set->count = header->count;
+
+    return true;
+}
+
+bool packed_set_contains(
+        packed_set_t *packed_set,
+        char *value,
+        size_t value_length) {
+    if (packed_set->encoding == PACKED_SET_ENCODING_INTSET) {
+        int64_t integer;
+        uint32_t position;
+
+        // A member that is not an integer can't be part of an intset
+        if (!packed_set_integer_parse(value, value_length, &integer)) {
+            return false;
+        }
+
+        return packed_set_intset_search(packed_set->integers, packed_set->count, integer, &position);
+    }
+
+    packed_hash_entry_t entry;
+    return packed_hash_get(&packed_set->packed_hash, value, value_length, &entry);
+}
+
+bool packed_set_iter_next(
+        packed_set_t *packed_set,
+        size_t *offset,
+        packed_set_member_t *member) {
+    if (packed_set->encoding == PACKED_SET_ENCODING_INTSET) {
+        if (*offset >= packed_set->count) {
+            return false;
+        }
+
+        member->is_integer = true;
+        member->integer = packed_set->integers[(*offset)++];
+        member->value = NULL;
+        member->value_length = 0;
+
+        return true;
+    }
+
+    packed_hash_entry_t entry;
+    if (!packed_hash_iter_next(&packed_set->packed_hash, offset, &entry)) {
+        return false;
+    }
+
+    member->is_integer = false;
+    member->value = entry.field;
+    member->value_length = entry.field_length;
+
+    return true;
+}
+
+void packed_set_builder_init(
+        packed_set_builder_t *builder,
+        packed_set_t *packed_set) {
+    memset(builder, 0, sizeof(packed_set_builder_t));
+
+    if (packed_set && packed_set->encoding == PACKED_SET_ENCODING_HASH) {
+        builder->encoding = PACKED_SET_ENCODING_HASH;
+        packed_hash_builder_init(&builder->hash_builder, &packed_set->packed_hash);
+        return;
+    }
+
+    builder->encoding = PACKED_SET_ENCODING_INTSET;
+    builder->integers_count = packed_set ? packed_set->count : 0;
+    builder->integers_size = MAX(builder->integers_count, PACKED_SET_BUILDER_INTEGERS_MIN);
+    builder->integers = xalloc_alloc(sizeof(int64_t) * builder->integers_size);
+
+    if (builder->integers_count > 0) {
+        memcpy(builder->integers, packed_set->integers, sizeof(int64_t) * builder->integers_count);
+    }
+}
+
+void packed_set_builder_free(
+        packed_set_builder_t *builder) {
+    if (builder->integers) {
+        xalloc_free(builder->integers);
+        builder->integers = NULL;
+    }
+
+    if (builder->integers_strings) {
+        xalloc_free(builder->integers_strings);
+        builder->integers_strings = NULL;
+    }
+
+    if (builder->encoding == PACKED_SET_ENCODING_HASH) {
+        packed_hash_builder_free(&builder->hash_builder);
+    }
+}
+
+static void packed_set_builder_upgrade(
+        packed_set_builder_t *builder) {
+    assert(builder->encoding == PACKED_SET_ENCODING_INTSET);
+    assert(builder->integers_strings == NULL);
+
+    // The packed hash builder only references the fields, the integers converted to strings have to be kept around
+    // till the builder is freed
+    builder->integers_strings = xalloc_alloc(
+            (PACKED_SET_INTEGER_MAX_LENGTH + 1) * MAX(builder->integers_count, 1));
+
+    packed_hash_builder_init(&builder->hash_builder, NULL);
+
+    for(uint32_t index = 0; index < builder->integers_count; index++) {
+        char *integer_string = builder->integers_strings + (index * (PACKED_SET_INTEGER_MAX_LENGTH + 1));
+        size_t integer_string_length = packed_set_integer_to_string(builder->integers[index], integer_string);
+
+        packed_hash_builder_set(
+                &builder->hash_builder,
+                integer_string,
+                integer_string_length,
+                packed_set_hash_value_empty,
+                0);
+    }
+
+    xalloc_free(builder->integers);
+    builder->integers = NULL;
+    builder->integers_count = 0;
+    builder->integers_size = 0;
+    builder->encoding = PACKED_SET_ENCODING_HASH;
+}
+
+bool packed_set_builder_add(
+        packed_set_builder_t *builder,
+        char *value,
+        size_t value_length) {
+    if (builder->encoding == PACKED_SET_ENCODING_INTSET) {
+        int64_t integer;
+        uint32_t position;
+
+        if (packed_set_integer_parse(value, value_length, &integer)) {
+            if (packed_set_intset_search(builder->integers, builder->integers_count, integer, &position)) {
+                return false;
+            }
+
+            if (builder->integers_count < PACKED_SET_INTSET_MAX_ENTRIES) {
+                if (builder->integers_count == builder->integers_size) {
+                    builder->integers_size *= 2;
+                    builder->integers = xalloc_realloc(
+                            builder->integers,
+                            sizeof(int64_t) * builder->integers_size);
+                }
+
+                memmove(
+                        builder->integers + position + 1,
+                        builder->integers + position,
+                        sizeof(int64_t) * (builder->integers_count - position));
+                builder->integers[position] = integer;
+                builder->integers_count++;
+
+                return true;
+            }
+        }
+
+        packed_set_builder_upgrade(builder);
+    }
+
+    return packed_hash_builder_set(
+            &builder->hash_builder,
+            value,
+            value_length,
+            packed_set_hash_value_empty,
+            0);
+}
+
+bool packed_set_builder_remove(
+        packed_set_builder_t *builder,
+        char *value,
+        size_t value_length) {
+    if (builder->encoding == PACKED_SET_ENCODING_INTSET) {
+        int64_t integer;
+        uint32_t position;
+
+        if (!packed_set_integer_parse(value, value_length, &integer)) {
+            return false;
+        }
+
+        if (!packed_set_intset_search(builder->integers, builder->integers_count, integer, &position)) {
+            return false;
+        }
+
+        memmove(
+                builder->integers + position,
+                builder->integers + position + 1,
+                sizeof(int64_t) * (builder->integers_count - position - 1));
+        builder->integers_count--;
+
+        return true;
+    }
+
+    return packed_hash_builder_delete(&builder->hash_builder, value, value_length);
+}
+
+bool packed_set_builder_iter_next(
+        packed_set_builder_t *builder,
+        size_t *offset,
+        packed_set_member_t *member) {
+    if (builder->encoding == PACKED_SET_ENCODING_INTSET) {
+        if (*offset >= builder->integers_count) {
+            return false;
+        }
+
+        member->is_integer = true;
+        member->integer = builder->integers[(*offset)++];
+        member->value = NULL;
+        member->value_length = 0;
+
+        return true;
+    }
+
+    while(*offset < builder->hash_builder.entries_count) {
+        packed_hash_builder_entry_t *builder_entry = &builder->hash_builder.entries[(*offset)++];
+
+        if (builder_entry->deleted) {
+            continue;
+        }
+
+        member->is_integer = false;
+        member->value = builder_entry->entry.field;
+        member->value_length = builder_entry->entry.field_length;
+
+        return true;
+    }
+
+    return false;
+}
+
+size_t packed_set_builder_serialized_length(
+        packed_set_builder_t *builder) {
+    if (builder->encoding == PACKED_SET_ENCODING_INTSET) {
+        return sizeof(packed_set_header_t) + ((size_t)builder->integers_count * sizeof(int64_t));
+    }
+
+    builder->serialized_hash_length = packed_hash_builder_serialized_length(&builder->hash_builder);
+    if (unlikely(builder->serialized_hash_length == 0)) {
+        return 0;
+    }
+
+    return sizeof(packed_set_header_t) + builder->serialized_hash_length;
+}
+
+void packed_set_builder_serialize(
+        packed_set_builder_t *builder,
+        char *buffer,
+        size_t buffer_length) {
+    packed_set_header_t *header = (packed_set_header_t*)buffer;
+
+    memset(header, 0, sizeof(packed_set_header_t));
+    header->encoding = builder->encoding;
+    header->count = packed_set_builder_count(builder);
+
+    if (builder->encoding == PACKED_SET_ENCODING_INTSET) {
+        assert(buffer_length == sizeof(packed_set_header_t) + ((size_t)builder->integers_count * sizeof(int64_t)));
+
+        memcpy(
+                buffer + sizeof(packed_set_header_t),
+                builder->integers,
+                sizeof(int64_t) * builder->integers_count);
+        return;
+    }
+
+    assert(buffer_length == sizeof(packed_set_header_t) + builder->serialized_hash_length);
+
+    packed_hash_builder_serialize(
+            &builder->hash_builder,
+            buffer + sizeof(packed_set_header_t),
+            builder->serialized_hash_length);
+}
@@ -0,0 +1,228 @@
+#ifndef CACHEGRAND_PACKED_SET_H
+#define CACHEGRAND_PACKED_SET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PACKED_SET_INTSET_MAX_ENTRIES           (512)
+#define PACKED_SET_INTEGER_MAX_LENGTH           (20)
+
+enum packed_set_encoding {
+    PACKED_SET_ENCODING_INTSET = 1,
+    PACKED_SET_ENCODING_HASH = 2,
+};
+typedef enum packed_set_encoding packed_set_encoding_t;
+
+/**
+ * Packed set
+ *
+ * The sets are stored as a single immutable blob made of a header followed by the members.
+ * When all the members are integers, in their canonical representation, and there are at most
+ * PACKED_SET_INTSET_MAX_ENTRIES of them, the set uses the intset encoding, a sorted array of int64 searched and
+ * intersected via the packed_set_intset functions that are vectorized when the hardware supports it.
+ * Otherwise the set is upgraded to the hash encoding, the members are stored in a packed hash, with empty values, that
+ * picks on its own between the compact and the table encoding. As for the packed hash, a set is never downgraded.
+ */
+typedef struct packed_set_header packed_set_header_t;
+struct packed_set_header {
+    uint8_t encoding;
+    uint8_t reserved[3];
+    uint32_t count;
+} __attribute__((packed));
+
+typedef struct packed_set packed_set_t;
+struct packed_set {
+    packed_set_encoding_t encoding;
+    uint32_t count;
+    int64_t *integers;
+    packed_hash_t packed_hash;
+};
+
+/**
+ * A member of a set, the integers of the intset encoding are not converted to strings, is_integer is set and the
+ * value is in integer
+ */
+typedef struct packed_set_member packed_set_member_t;
+struct packed_set_member {
+    bool is_integer;
+    int64_t integer;
+    char *value;
+    size_t value_length;
+};
+
+/**
+ * Packed set builder
+ *
+ * As for the packed hash, the builder references the members without copying them and the memory referenced has to
+ * be kept alive by the caller until the builder is serialized. The only exception are the integers converted to
+ * strings when the set is upgraded from the intset to the hash encoding, these are owned by the builder.
+ */
+typedef struct packed_set_builder packed_set_builder_t;
+struct packed_set_builder {
+    packed_set_encoding_t encoding;
+    int64_t *integers;
+    uint32_t integers_count;
+    uint32_t integers_size;
+    packed_hash_builder_t hash_builder;
+    char *integers_strings;
+    size_t serialized_hash_length;
+};
+
+/**
+ * Parse a member as an integer, only the canonical representation of an integer is accepted (no leading zeros, no
+ * plus sign, no spaces) so the member can be rebuilt from the integer
+ *
+ * @param value The member
+ * @param value_length The length of the member
+ * @param integer Set to the integer if the member is an integer
+ * @return true if the member is an integer, false otherwise
+ */
+bool packed_set_integer_parse(
+        char *value,
+        size_t value_length,
+        int64_t *integer);
+
+/**
+ * Convert an integer to its canonical representation
+ *
+ * @param integer The integer
+ * @param buffer The buffer, has to be at least PACKED_SET_INTEGER_MAX_LENGTH + 1 bytes long
+ * @return The length of the string written into the buffer
+ */
+size_t packed_set_integer_to_string(
+        int64_t integer,
+        char *buffer);
+
+/**
+ * Parse and validate a serialized packed set, the packed set references the data passed that has to be kept alive
+ *
+ * @param packed_set The packed set to initialize
+ * @param data The serialized packed set
+ * @param data_length The length of the serialized packed set
+ * @return true if the data contains a valid packed set, false otherwise
+ */
+bool packed_set_init(
+        packed_set_t *packed_set,
+        char *data,
+        size_t data_length);
+
+/**
+ * Check if a member is part of the set
+ *
+ * @param packed_set The packed set
+ * @param value The member to search
+ * @param value_length The length of the member
+ * @return true if the member is part of the set, false otherwise
+ */
+bool packed_set_contains(
+        packed_set_t *packed_set,
+        char *value,
+        size_t value_length);
+
+/**
+ * Iterate the members of the packed set
+ *
+ * @param packed_set The packed set
+ * @param offset The position of the member to read, it's updated to point to the next member, has to be 0 on the
+ * first call
+ * @param member Filled with the member read
+ * @return true if a member has been read, false if there are no more members
+ */
+bool packed_set_iter_next(
+        packed_set_t *packed_set,
+        size_t *offset,
+        packed_set_member_t *member);
+
+/**
+ * Initialize a builder, optionally starting from the members of an existing packed set
+ *
+ * @param builder The builder to initialize
+ * @param packed_set The source packed set, can be NULL to build a new one
+ */
+void packed_set_builder_init(
+        packed_set_builder_t *builder,
+        packed_set_t *packed_set);
+
+/**
+ * Free the memory allocated by the builder, the members referenced are not touched
+ *
+ * @param builder The builder
+ */
+void packed_set_builder_free(
+        packed_set_builder_t *builder);
+
+/**
+ * Add a member to the set
+ *
+ * @param builder The builder
+ * @param value The member to add
+ * @param value_length The length of the member
+ * @return true if the member has been added, false if it was already part of the set
+ */
+bool packed_set_builder_add(
+        packed_set_builder_t *builder,
+        char *value,
+        size_t value_length);
+
+/**
+ * Remove a member from the set
+ *
+ * @param builder The builder
+ * @param value The member to remove
+ * @param value_length The length of the member
+ * @return true if the member has been removed, false if it wasn't part of the set
+ */
+bool packed_set_builder_remove(
+        packed_set_builder_t *builder,
+        char *value,
+        size_t value_length);
+
+/**
+ * Iterate the members of the builder
+ *
+ * @param builder The builder
+ * @param offset The position of the member to read, it's updated to point to the next member, has to be 0 on the
+ * first call
+ * @param member Filled with the member read
+ * @return true if a member has been read, false if there are no more members
+ */
+bool packed_set_builder_iter_next(
+        packed_set_builder_t *builder,
+        size_t *offset,
+        packed_set_member_t *member);
+
+/**
+ * Calculate the length of the serialized packed set
+ *
+ * @param builder The builder
+ * @return The length in bytes of the serialized packed set or 0 if the members don't fit in a packed set
+ */
+size_t packed_set_builder_serialized_length(
+        packed_set_builder_t *builder);
+
+/**
+ * Serialize the builder into the buffer, packed_set_builder_serialized_length has to be invoked first to calculate
+ * the length of the buffer
+ *
+ * @param builder The builder
+ * @param buffer The buffer where to serialize the packed set
+ * @param buffer_length The length of the buffer
+ */
+void packed_set_builder_serialize(
+        packed_set_builder_t *builder,
+        char *buffer,
+        size_t buffer_length);
+
+static inline uint32_t packed_set_builder_count(
+        packed_set_builder_t *builder) {
+    return builder->encoding == PACKED_SET_ENCODING_INTSET
+           ? builder->integers_count
+           : packed_hash_builder_count(&builder->hash_builder);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_PACKED_SET_H
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "misc.h"
+#include "utils_string.h"
+
+#include "packed_set_intset.h"
+
+IFUNC_WRAPPER_RESOLVE(PACKED_SET_INTSET_NAME_IFUNC(search)) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return PACKED_SET_INTSET_NAME_IMPL(search, avx2);
+    }
+#elif defined(__aarch64__)
+    // NEON is part of the base armv8-a instruction set
+    return PACKED_SET_INTSET_NAME_IMPL(search, armv8a_neon);
+#endif
+
+    return PACKED_SET_INTSET_NAME_IMPL(search, loop);
+}
+
+bool IFUNC_WRAPPER(PACKED_SET_INTSET_NAME_IFUNC(search), PACKED_SET_INTSET_SEARCH_ARGS);
+
+IFUNC_WRAPPER_RESOLVE(PACKED_SET_INTSET_NAME_IFUNC(intersect)) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return PACKED_SET_INTSET_NAME_IMPL(intersect, avx2);
+    }
+#elif defined(__aarch64__)
+    return PACKED_SET_INTSET_NAME_IMPL(intersect, armv8a_neon);
+#endif
+
+    return PACKED_SET_INTSET_NAME_IMPL(intersect, loop);
+}
+
+uint32_t IFUNC_WRAPPER(PACKED_SET_INTSET_NAME_IFUNC(intersect), PACKED_SET_INTSET_INTERSECT_ARGS);
+
+bool PACKED_SET_INTSET_SIGNATURE_IMPL(search, loop, PACKED_SET_INTSET_SEARCH_ARGS) {
+    uint32_t low = 0;
+    uint32_t high = count;
+
+    while(high - low > PACKED_SET_INTSET_SEARCH_LINEAR_THRESHOLD) {
+        uint32_t middle = low + ((high - low) / 2);
+        if (integers[middle] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    while(low < high && integers[low] < value) {
+        low++;
+    }
+
+    *position = low;
+    return low < count && integers[low] == value;
+}
+
+uint32_t PACKED_SET_INTSET_SIGNATURE_IMPL(intersect, loop, PACKED_SET_INTSET_INTERSECT_ARGS) {
+    uint32_t a_index = 0, b_index = 0, result_count = 0;
+
+    while(a_index < a_count && b_index < b_count) {
+        if (a[a_index] < b[b_index]) {
+            a_index++;
+        } else if (a[a_index] > b[b_index]) {
+            b_index++;
+        } else {
+            result[result_count++] = a[a_index];
+            a_index++;
+            b_index++;
+        }
+    }
+
+    return result_count;
+}
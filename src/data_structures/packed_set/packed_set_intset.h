@@ -0,0 +1,62 @@
+#ifndef CACHEGRAND_PACKED_SET_INTSET_H
+#define CACHEGRAND_PACKED_SET_INTSET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Below this number of integers the binary search stops and the remaining range is scanned, the scan is vectorized
+// when the hardware supports it
+#define PACKED_SET_INTSET_SEARCH_LINEAR_THRESHOLD   (16)
+
+#define PACKED_SET_INTSET_NAME_IFUNC(NAME) packed_set_intset_##NAME
+#define PACKED_SET_INTSET_SIGNATURE_IFUNC(NAME, ARGS) PACKED_SET_INTSET_NAME_IFUNC(NAME) ARGS
+
+#define PACKED_SET_INTSET_NAME_IMPL(NAME, METHOD) packed_set_intset_##NAME##_##METHOD
+#define PACKED_SET_INTSET_SIGNATURE_IMPL(NAME, METHOD, ARGS) PACKED_SET_INTSET_NAME_IMPL(NAME, METHOD) ARGS
+
+#define PACKED_SET_INTSET_SEARCH_ARGS \
+    (const int64_t *integers, uint32_t count, int64_t value, uint32_t *position)
+#define PACKED_SET_INTSET_INTERSECT_ARGS \
+    (const int64_t *a, uint32_t a_count, const int64_t *b, uint32_t b_count, int64_t *result)
+
+/**
+ * Search an integer in a sorted array of unique integers
+ *
+ * @param integers The sorted array
+ * @param count The number of integers in the array
+ * @param value The integer to search
+ * @param position Set to the index of the integer if found or to the index where it should be inserted otherwise
+ * @return true if the integer has been found, false otherwise
+ */
+bool PACKED_SET_INTSET_SIGNATURE_IFUNC(search, PACKED_SET_INTSET_SEARCH_ARGS);
+bool PACKED_SET_INTSET_SIGNATURE_IMPL(search, loop, PACKED_SET_INTSET_SEARCH_ARGS);
+#if defined(__x86_64__)
+bool PACKED_SET_INTSET_SIGNATURE_IMPL(search, avx2, PACKED_SET_INTSET_SEARCH_ARGS);
+#elif defined(__aarch64__)
+bool PACKED_SET_INTSET_SIGNATURE_IMPL(search, armv8a_neon, PACKED_SET_INTSET_SEARCH_ARGS);
+#endif
+
+/**
+ * Intersect two sorted arrays of unique integers, the result is sorted as well
+ *
+ * @param a The first sorted array
+ * @param a_count The number of integers in the first array
+ * @param b The second sorted array
+ * @param b_count The number of integers in the second array
+ * @param result The array where to write the intersection, has to be large enough to contain the smaller input
+ * @return The number of integers written into result
+ */
+uint32_t PACKED_SET_INTSET_SIGNATURE_IFUNC(intersect, PACKED_SET_INTSET_INTERSECT_ARGS);
+uint32_t PACKED_SET_INTSET_SIGNATURE_IMPL(intersect, loop, PACKED_SET_INTSET_INTERSECT_ARGS);
+#if defined(__x86_64__)
+uint32_t PACKED_SET_INTSET_SIGNATURE_IMPL(intersect, avx2, PACKED_SET_INTSET_INTERSECT_ARGS);
+#elif defined(__aarch64__)
+uint32_t PACKED_SET_INTSET_SIGNATURE_IMPL(intersect, armv8a_neon, PACKED_SET_INTSET_INTERSECT_ARGS);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_PACKED_SET_INTSET_H
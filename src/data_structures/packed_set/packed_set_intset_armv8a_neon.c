@@ -0,0 +1,84 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <arm_neon.h>
+
+#include "misc.h"
+
+#include "packed_set_intset.h"
+
+bool PACKED_SET_INTSET_SIGNATURE_IMPL(search, armv8a_neon, PACKED_SET_INTSET_SEARCH_ARGS) {
+    uint32_t low = 0;
+    uint32_t high = count;
+
+    while(high - low > PACKED_SET_INTSET_SEARCH_LINEAR_THRESHOLD) {
+        uint32_t middle = low + ((high - low) / 2);
+        if (integers[middle] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    // Same approach of the avx2 implementation, the lanes set to all ones by the comparison are subtracted from the
+    // accumulator to count the integers lower than the value
+    int64x2_t value_vector = vdupq_n_s64(value);
+    uint64x2_t lower_count_vector = vdupq_n_u64(0);
+    uint32_t position_found = low;
+    for(; low + 2 <= high; low += 2) {
+        int64x2_t integers_vector = vld1q_s64(integers + low);
+        lower_count_vector = vsubq_u64(lower_count_vector, vcltq_s64(integers_vector, value_vector));
+    }
+    position_found += (uint32_t)vaddvq_u64(lower_count_vector);
+
+    for(; low < high; low++) {
+        position_found += integers[low] < value ? 1 : 0;
+    }
+
+    *position = position_found;
+    return position_found < count && integers[position_found] == value;
+}
+
+uint32_t PACKED_SET_INTSET_SIGNATURE_IMPL(intersect, armv8a_neon, PACKED_SET_INTSET_INTERSECT_ARGS) {
+    uint32_t a_index = 0, b_index = 0, result_count = 0;
+
+    while(a_index + 2 <= a_count && b_index + 2 <= b_count) {
+        int64x2_t a_vector = vld1q_s64(a + a_index);
+        int64x2_t b_vector = vld1q_s64(b + b_index);
+
+        uint64x2_t match_vector = vorrq_u64(
+                vceqq_s64(a_vector, b_vector),
+                vceqq_s64(a_vector, vextq_s64(b_vector, b_vector, 1)));
+
+        if (vgetq_lane_u64(match_vector, 0)) {
+            result[result_count++] = a[a_index];
+        }
+        if (vgetq_lane_u64(match_vector, 1)) {
+            result[result_count++] = a[a_index + 1];
+        }
+
+        int64_t a_max = a[a_index + 1];
+        int64_t b_max = b[b_index + 1];
+        if (a_max <= b_max) {
+            a_index += 2;
+        }
+        if (b_max <= a_max) {
+            b_index += 2;
+        }
+    }
+
+    return result_count + PACKED_SET_INTSET_NAME_IMPL(intersect, loop)(
+            a + a_index,
+            a_count - a_index,
+            b + b_index,
+            b_count - b_index,
+            result + result_count);
+}
@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <immintrin.h>
+
+#include "misc.h"
+
+#include "packed_set_intset.h"
+
+bool PACKED_SET_INTSET_SIGNATURE_IMPL(search, avx2, PACKED_SET_INTSET_SEARCH_ARGS) {
+    uint32_t low = 0;
+    uint32_t high = count;
+
+    while(high - low > PACKED_SET_INTSET_SEARCH_LINEAR_THRESHOLD) {
+        uint32_t middle = low + ((high - low) / 2);
+        if (integers[middle] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    // As the integers are sorted, the number of integers lower than the value in the remaining range is the offset of
+    // the insertion position, the comparisons are done 4 integers at time without branching on the results
+    __m256i value_vector = _mm256_set1_epi64x(value);
+    uint32_t position_found = low;
+    for(; low + 4 <= high; low += 4) {
+        __m256i integers_vector = _mm256_loadu_si256((__m256i*)(integers + low));
+        __m256i lower_mask_vector = _mm256_cmpgt_epi64(value_vector, integers_vector);
+        position_found += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(lower_mask_vector)));
+    }
+
+    for(; low < high; low++) {
+        position_found += integers[low] < value ? 1 : 0;
+    }
+
+    *position = position_found;
+    return position_found < count && integers[position_found] == value;
+}
+
+uint32_t PACKED_SET_INTSET_SIGNATURE_IMPL(intersect, avx2, PACKED_SET_INTSET_INTERSECT_ARGS) {
+    uint32_t a_index = 0, b_index = 0, result_count = 0;
+
+    // Each block of 4 integers of a is compared against all the rotations of the current block of b, the block with the
+    // lowest maximum is then skipped, both are skipped if the maximums are the same
+    while(a_index + 4 <= a_count && b_index + 4 <= b_count) {
+        __m256i a_vector = _mm256_loadu_si256((__m256i*)(a + a_index));
+        __m256i b_vector = _mm256_loadu_si256((__m256i*)(b + b_index));
+
+        __m256i match_vector = _mm256_cmpeq_epi64(a_vector, b_vector);
+        match_vector = _mm256_or_si256(match_vector, _mm256_cmpeq_epi64(
+                a_vector,
+                _mm256_permute4x64_epi64(b_vector, _MM_SHUFFLE(0, 3, 2, 1))));
+        match_vector = _mm256_or_si256(match_vector, _mm256_cmpeq_epi64(
+                a_vector,
+                _mm256_permute4x64_epi64(b_vector, _MM_SHUFFLE(1, 0, 3, 2))));
+        match_vector = _mm256_or_si256(match_vector, _mm256_cmpeq_epi64(
+                a_vector,
+                _mm256_permute4x64_epi64(b_vector, _MM_SHUFFLE(2, 1, 0, 3))));
+
+        uint32_t match_mask = _mm256_movemask_pd(_mm256_castsi256_pd(match_vector));
+        while(match_mask) {
+            result[result_count++] = a[a_index + __builtin_ctz(match_mask)];
+            match_mask &= match_mask - 1;
+        }
+
+        int64_t a_max = a[a_index + 3];
+        int64_t b_max = b[b_index + 3];
+        if (a_max <= b_max) {
+            a_index += 4;
+        }
+        if (b_max <= a_max) {
+            b_index += 4;
+        }
+    }
+
+    return result_count + PACKED_SET_INTSET_NAME_IMPL(intersect, loop)(
+            a + a_index,
+            a_count - a_index,
+            b + b_index,
+            b_count - b_index,
+            result + result_count);
+}
@@ -0,0 +1,251 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "xalloc.h"
+#include "hash/hash_crc32c.h"
+#include "pow2.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
+
+#include "packed_sorted_set.h"
+
+#define TAG "packed_sorted_set"
+
+static inline uint32_t packed_sorted_set_hash_member(
+        char *member,
+        size_t member_length) {
+    return hash_crc32c(member, member_length, 0);
+}
+
+static inline uint32_t packed_sorted_set_buckets_count_for(
+        uint32_t count) {
+    uint32_t buckets_count = PACKED_SORTED_SET_BUCKETS_MIN;
+
+    // As for the packed hash, the buckets are kept at most half full to keep the probing chains short
+    while(buckets_count < (uint64_t)count * 2) {
+        buckets_count <<= 1;
+    }
+
+    return buckets_count;
+}
+
+bool packed_sorted_set_init(
+        packed_sorted_set_t *packed_sorted_set,
+        char *data,
+        size_t data_length) {
+    packed_sorted_set_header_t *header = (packed_sorted_set_header_t*)data;
+
+    if (unlikely(data_length < sizeof(packed_sorted_set_header_t))) {
+        return false;
+    }
+
+    if (unlikely(!pow2_is(header->buckets_count) || header->buckets_count < header->count)) {
+        return false;
+    }
+
+    size_t tables_length = ((size_t)header->count + header->buckets_count) * sizeof(uint32_t);
+    if (unlikely(data_length - sizeof(packed_sorted_set_header_t) < tables_length)) {
+        return false;
+    }
+
+    packed_sorted_set->count = header->count;
+    packed_sorted_set->buckets_count = header->buckets_count;
+    packed_sorted_set->offsets = (uint32_t*)(data + sizeof(packed_sorted_set_header_t));
+    packed_sorted_set->buckets = packed_sorted_set->offsets + header->count;
+    packed_sorted_set->entries = (char*)(packed_sorted_set->buckets + header->buckets_count);
+    packed_sorted_set->entries_length = data_length - sizeof(packed_sorted_set_header_t) - tables_length;
+
+    return true;
+}
+
+bool packed_sorted_set_get(
+        packed_sorted_set_t *packed_sorted_set,
+        uint32_t rank,
+        packed_sorted_set_entry_t *entry) {
+    packed_sorted_set_entry_header_t entry_header;
+
+    if (unlikely(rank >= packed_sorted_set->count)) {
+        return false;
+    }
+
+    size_t offset = packed_sorted_set->offsets[rank];
+    if (unlikely(offset > packed_sorted_set->entries_length ||
+        packed_sorted_set->entries_length - offset < sizeof(packed_sorted_set_entry_header_t))) {
+        return false;
+    }
+
+    // The entries are not aligned
+    memcpy(&entry_header, packed_sorted_set->entries + offset, sizeof(packed_sorted_set_entry_header_t));
+    offset += sizeof(packed_sorted_set_entry_header_t);
+
+    if (unlikely(entry_header.member_length > packed_sorted_set->entries_length - offset)) {
+        return false;
+    }
+
+    entry->score = entry_header.score;
+    entry->member = packed_sorted_set->entries + offset;
+    entry->member_length = entry_header.member_length;
+
+    return true;
+}
+
+bool packed_sorted_set_find(
+        packed_sorted_set_t *packed_sorted_set,
+        char *member,
+        size_t member_length,
+        uint32_t *rank,
+        packed_sorted_set_entry_t *entry) {
+    if (packed_sorted_set->count == 0) {
+        return false;
+    }
+
+    uint32_t buckets_mask = packed_sorted_set->buckets_count - 1;
+    uint32_t bucket_index = packed_sorted_set_hash_member(member, member_length) & buckets_mask;
+
+    for(uint32_t probes = 0; probes < packed_sorted_set->buckets_count; probes++) {
+        uint32_t bucket = packed_sorted_set->buckets[bucket_index];
+
+        if (bucket == 0) {
+            return false;
+        }
+
+        if (likely(packed_sorted_set_get(packed_sorted_set, bucket - 1, entry)) &&
+            entry->member_length == member_length &&
+            memcmp(entry->member, member, member_length) == 0) {
+            *rank = bucket - 1;
+            return true;
+        }
+
+        bucket_index = (bucket_index + 1) & buckets_mask;
+    }
+
+    return false;
+}
+
+uint32_t packed_sorted_set_rank_by_score(
+        packed_sorted_set_t *packed_sorted_set,
+        double score,
+        bool exclusive) {
+    uint32_t low = 0;
+    uint32_t high = packed_sorted_set->count;
+
+    while(low < high) {
+        packed_sorted_set_entry_t entry;
+        uint32_t middle = low + ((high - low) / 2);
+
+        // A corrupted entry ends the search as if all the scores were lower
+        if (unlikely(!packed_sorted_set_get(packed_sorted_set, middle, &entry))) {
+            return packed_sorted_set->count;
+        }
+
+        if (exclusive ? entry.score <= score : entry.score < score) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+bool packed_sorted_set_load(
+        packed_sorted_set_t *packed_sorted_set,
+        sorted_set_t *sorted_set) {
+    packed_sorted_set_entry_t entry;
+
+    assert(sorted_set->count == 0);
+
+    for(uint32_t rank = 0; rank < packed_sorted_set->count; rank++) {
+        if (unlikely(!packed_sorted_set_get(packed_sorted_set, rank, &entry))) {
+            return false;
+        }
+
+        // The entries are already ordered, they can be appended without searching for their position
+        if (unlikely(sorted_set->tail && sorted_set_compare(
+                sorted_set->tail->score,
+                sorted_set->tail->member,
+                sorted_set->tail->member_length,
+                entry.score,
+                entry.member,
+                entry.member_length) >= 0)) {
+            return false;
+        }
+
+        sorted_set_append(sorted_set, entry.member, entry.member_length, entry.score);
+    }
+
+    return true;
+}
+
+size_t packed_sorted_set_serialized_length(
+        sorted_set_t *sorted_set) {
+    size_t entries_length = 0;
+
+    if (unlikely(sorted_set->count > UINT32_MAX / 2)) {
+        return 0;
+    }
+
+    for(sorted_set_node_t *node = sorted_set_first(sorted_set); node; node = sorted_set_next(node)) {
+        entries_length += sizeof(packed_sorted_set_entry_header_t) + node->member_length;
+    }
+
+    // The offsets of the entries are 32 bit
+    if (unlikely(entries_length > UINT32_MAX)) {
+        return 0;
+    }
+
+    return sizeof(packed_sorted_set_header_t) +
+        (((size_t)sorted_set->count + packed_sorted_set_buckets_count_for(sorted_set->count)) * sizeof(uint32_t)) +
+        entries_length;
+}
+
+void packed_sorted_set_serialize(
+        sorted_set_t *sorted_set,
+        char *buffer,
+        size_t buffer_length) {
+    uint32_t rank = 0;
+    size_t entries_offset = 0;
+    packed_sorted_set_header_t *header = (packed_sorted_set_header_t*)buffer;
+    uint32_t buckets_count = packed_sorted_set_buckets_count_for(sorted_set->count);
+    uint32_t buckets_mask = buckets_count - 1;
+    uint32_t *offsets = (uint32_t*)(buffer + sizeof(packed_sorted_set_header_t));
+    uint32_t *buckets = offsets + sorted_set->count;
+    char *entries = (char*)(buckets + buckets_count);
+
+    header->count = sorted_set->count;
+    header->buckets_count = buckets_count;
+    memset(buckets, 0, buckets_count * sizeof(uint32_t));
+
+    for(sorted_set_node_t *node = sorted_set_first(sorted_set); node; node = sorted_set_next(node), rank++) {
+        packed_sorted_set_entry_header_t entry_header = {
+                .score = node->score,
+                .member_length = node->member_length,
+        };
+
+        offsets[rank] = entries_offset;
+        memcpy(entries + entries_offset, &entry_header, sizeof(packed_sorted_set_entry_header_t));
+        entries_offset += sizeof(packed_sorted_set_entry_header_t);
+        memcpy(entries + entries_offset, node->member, node->member_length);
+        entries_offset += node->member_length;
+
+        uint32_t bucket_index = packed_sorted_set_hash_member(node->member, node->member_length) & buckets_mask;
+        while(buckets[bucket_index] != 0) {
+            bucket_index = (bucket_index + 1) & buckets_mask;
+        }
+        buckets[bucket_index] = rank + 1;
+    }
+
+    assert((char*)entries + entries_offset == buffer + buffer_length);
+}
@@ -0,0 +1,148 @@
+#ifndef CACHEGRAND_PACKED_SORTED_SET_H
+#define CACHEGRAND_PACKED_SORTED_SET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PACKED_SORTED_SET_BUCKETS_MIN           (8)
+
+/**
+ * Packed sorted set
+ *
+ * The sorted sets are stored as a single immutable blob made of a header, a table with the offsets of the entries in
+ * rank order, an open-addressing table of buckets indexing the members and the entries themselves, ordered by score
+ * and then by member, each one made of the score, the length of the member and the member.
+ *
+ * The offsets table gives access to the entry at a given rank in O(1), the ranges by score are found with a binary
+ * search over it. The buckets contain the rank of the member plus one, 0 marks an empty bucket, so a member is
+ * searched, and its rank found, with a single hash lookup without having to decode the blob.
+ *
+ * The blob is built from a sorted_set, that is also used to apply the changes, and can be loaded back into one in
+ * O(n) as the entries are already ordered.
+ */
+typedef struct packed_sorted_set_header packed_sorted_set_header_t;
+struct packed_sorted_set_header {
+    uint32_t count;
+    uint32_t buckets_count;
+} __attribute__((packed));
+
+typedef struct packed_sorted_set_entry_header packed_sorted_set_entry_header_t;
+struct packed_sorted_set_entry_header {
+    double score;
+    uint32_t member_length;
+} __attribute__((packed));
+
+typedef struct packed_sorted_set packed_sorted_set_t;
+struct packed_sorted_set {
+    uint32_t count;
+    uint32_t buckets_count;
+    uint32_t *offsets;
+    uint32_t *buckets;
+    char *entries;
+    size_t entries_length;
+};
+
+typedef struct packed_sorted_set_entry packed_sorted_set_entry_t;
+struct packed_sorted_set_entry {
+    double score;
+    char *member;
+    size_t member_length;
+};
+
+/**
+ * Parse and validate a serialized packed sorted set, the packed sorted set references the data passed that has to be
+ * kept alive
+ *
+ * @param packed_sorted_set The packed sorted set to initialize
+ * @param data The serialized packed sorted set
+ * @param data_length The length of the serialized packed sorted set
+ * @return true if the data contains a valid packed sorted set, false otherwise
+ */
+bool packed_sorted_set_init(
+        packed_sorted_set_t *packed_sorted_set,
+        char *data,
+        size_t data_length);
+
+/**
+ * Read the entry at a given rank, 0-based
+ *
+ * @param packed_sorted_set The packed sorted set
+ * @param rank The rank
+ * @param entry Filled with the entry read
+ * @return true if the entry has been read, false if the rank is out of range or the entry is corrupted
+ */
+bool packed_sorted_set_get(
+        packed_sorted_set_t *packed_sorted_set,
+        uint32_t rank,
+        packed_sorted_set_entry_t *entry);
+
+/**
+ * Search a member in the packed sorted set
+ *
+ * @param packed_sorted_set The packed sorted set
+ * @param member The member to search
+ * @param member_length The length of the member
+ * @param rank Set to the rank of the member if found
+ * @param entry Filled with the entry of the member if found
+ * @return true if the member is part of the sorted set, false otherwise
+ */
+bool packed_sorted_set_find(
+        packed_sorted_set_t *packed_sorted_set,
+        char *member,
+        size_t member_length,
+        uint32_t *rank,
+        packed_sorted_set_entry_t *entry);
+
+/**
+ * Calculate the rank of the first entry with a score greater than or equal to, or strictly greater than if exclusive
+ * is set, the score passed
+ *
+ * @param packed_sorted_set The packed sorted set
+ * @param score The score
+ * @param exclusive If the score is exclusive
+ * @return The rank of the entry found or the number of entries if all the scores are lower
+ */
+uint32_t packed_sorted_set_rank_by_score(
+        packed_sorted_set_t *packed_sorted_set,
+        double score,
+        bool exclusive);
+
+/**
+ * Load the entries of the packed sorted set into an empty sorted set
+ *
+ * @param packed_sorted_set The packed sorted set
+ * @param sorted_set The sorted set, has to be empty
+ * @return true if all the entries have been loaded, false if the packed sorted set is corrupted
+ */
+bool packed_sorted_set_load(
+        packed_sorted_set_t *packed_sorted_set,
+        sorted_set_t *sorted_set);
+
+/**
+ * Calculate the length of the serialized sorted set
+ *
+ * @param sorted_set The sorted set
+ * @return The length in bytes of the serialized packed sorted set or 0 if the entries don't fit in a packed sorted set
+ */
+size_t packed_sorted_set_serialized_length(
+        sorted_set_t *sorted_set);
+
+/**
+ * Serialize the sorted set into the buffer, packed_sorted_set_serialized_length has to be invoked first to calculate
+ * the length of the buffer
+ *
+ * @param sorted_set The sorted set
+ * @param buffer The buffer where to serialize the packed sorted set
+ * @param buffer_length The length of the buffer
+ */
+void packed_sorted_set_serialize(
+        sorted_set_t *sorted_set,
+        char *buffer,
+        size_t buffer_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_PACKED_SORTED_SET_H
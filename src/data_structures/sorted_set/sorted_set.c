@@ -0,0 +1,464 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "xalloc.h"
+#include "random.h"
+#include "data_structures/art_spsc/art_spsc.h"
+
+#include "sorted_set.h"
+
+#define TAG "sorted_set"
+
+#define SORTED_SET_MEMBER_KEY_SUFFIX    (0x01)
+
+static inline size_t sorted_set_node_size(
+        uint8_t levels_count,
+        size_t member_length) {
+    // The member, followed by the suffix used to index it in the art_spsc tree, is stored after the levels
+    return sizeof(sorted_set_node_t) + (sizeof(sorted_set_node_level_t) * levels_count) + member_length + 1;
+}
+
+static sorted_set_node_t *sorted_set_node_new(
+        uint8_t levels_count,
+        char *member,
+        size_t member_length,
+        double score) {
+    sorted_set_node_t *node = xalloc_alloc(sorted_set_node_size(levels_count, member_length));
+
+    node->score = score;
+    node->backward = NULL;
+    node->levels_count = levels_count;
+    node->member = (char*)&node->levels[levels_count];
+    node->member_length = member_length;
+
+    if (member_length > 0) {
+        memcpy(node->member, member, member_length);
+    }
+    node->member[member_length] = SORTED_SET_MEMBER_KEY_SUFFIX;
+
+    for(uint8_t level = 0; level < levels_count; level++) {
+        node->levels[level].forward = NULL;
+        node->levels[level].span = 0;
+    }
+
+    return node;
+}
+
+static uint8_t sorted_set_random_level() {
+    uint64_t random = random_generate();
+    uint8_t level = 1;
+
+    // A node is promoted to the next level with a probability of 1/4, 2 bits of the random number are consumed for
+    // each level so the 64 bits are enough to reach SORTED_SET_SKIPLIST_LEVELS_MAX
+    while((random & 0x03) == 0 && level < SORTED_SET_SKIPLIST_LEVELS_MAX) {
+        level++;
+        random >>= 2;
+    }
+
+    return level;
+}
+
+static char *sorted_set_member_key(
+        char *member,
+        size_t member_length,
+        char *key_stack) {
+    char *key = key_stack;
+
+    if (unlikely(member_length + 1 > SORTED_SET_MEMBER_KEY_STACK_MAX_LENGTH)) {
+        key = xalloc_alloc(member_length + 1);
+    }
+
+    if (member_length > 0) {
+        memcpy(key, member, member_length);
+    }
+    key[member_length] = SORTED_SET_MEMBER_KEY_SUFFIX;
+
+    return key;
+}
+
+static void sorted_set_skiplist_link(
+        sorted_set_t *sorted_set,
+        sorted_set_node_t *node) {
+    sorted_set_node_t *update[SORTED_SET_SKIPLIST_LEVELS_MAX];
+    uint64_t rank[SORTED_SET_SKIPLIST_LEVELS_MAX];
+    sorted_set_node_t *current = sorted_set->head;
+
+    for(int level = sorted_set->levels_count - 1; level >= 0; level--) {
+        rank[level] = level == sorted_set->levels_count - 1 ? 0 : rank[level + 1];
+
+        while(current->levels[level].forward && sorted_set_compare(
+                current->levels[level].forward->score,
+                current->levels[level].forward->member,
+                current->levels[level].forward->member_length,
+                node->score,
+                node->member,
+                node->member_length) < 0) {
+            rank[level] += current->levels[level].span;
+            current = current->levels[level].forward;
+        }
+
+        update[level] = current;
+    }
+
+    // The span of the links pointing to nothing is the distance of the node from the end of the skiplist, the levels
+    // not in use yet start from the head so their span is the number of nodes
+    if (node->levels_count > sorted_set->levels_count) {
+        for(int level = sorted_set->levels_count; level < node->levels_count; level++) {
+            rank[level] = 0;
+            update[level] = sorted_set->head;
+            update[level]->levels[level].span = sorted_set->count;
+        }
+
+        sorted_set->levels_count = node->levels_count;
+    }
+
+    for(int level = 0; level < node->levels_count; level++) {
+        node->levels[level].forward = update[level]->levels[level].forward;
+        update[level]->levels[level].forward = node;
+
+        node->levels[level].span = update[level]->levels[level].span - (rank[0] - rank[level]);
+        update[level]->levels[level].span = (rank[0] - rank[level]) + 1;
+
+        if (node->levels[level].forward == NULL) {
+            sorted_set->last[level] = node;
+        }
+    }
+
+    for(int level = node->levels_count; level < sorted_set->levels_count; level++) {
+        update[level]->levels[level].span++;
+    }
+
+    node->backward = update[0] == sorted_set->head ? NULL : update[0];
+    if (node->levels[0].forward) {
+        node->levels[0].forward->backward = node;
+    } else {
+        sorted_set->tail = node;
+    }
+
+    sorted_set->count++;
+}
+
+static void sorted_set_skiplist_unlink(
+        sorted_set_t *sorted_set,
+        sorted_set_node_t *node) {
+    sorted_set_node_t *update[SORTED_SET_SKIPLIST_LEVELS_MAX];
+    sorted_set_node_t *current = sorted_set->head;
+
+    for(int level = sorted_set->levels_count - 1; level >= 0; level--) {
+        while(current->levels[level].forward && sorted_set_compare(
+                current->levels[level].forward->score,
+                current->levels[level].forward->member,
+                current->levels[level].forward->member_length,
+                node->score,
+                node->member,
+                node->member_length) < 0) {
+            current = current->levels[level].forward;
+        }
+
+        update[level] = current;
+    }
+
+    assert(update[0]->levels[0].forward == node);
+
+    for(int level = 0; level < sorted_set->levels_count; level++) {
+        if (update[level]->levels[level].forward == node) {
+            update[level]->levels[level].span += node->levels[level].span - 1;
+            update[level]->levels[level].forward = node->levels[level].forward;
+
+            if (sorted_set->last[level] == node) {
+                sorted_set->last[level] = update[level];
+            }
+        } else {
+            update[level]->levels[level].span--;
+        }
+    }
+
+    if (node->levels[0].forward) {
+        node->levels[0].forward->backward = node->backward;
+    } else {
+        sorted_set->tail = node->backward;
+    }
+
+    while(sorted_set->levels_count > 1 &&
+        sorted_set->head->levels[sorted_set->levels_count - 1].forward == NULL) {
+        sorted_set->levels_count--;
+    }
+
+    sorted_set->count--;
+}
+
+sorted_set_t *sorted_set_new() {
+    sorted_set_t *sorted_set = xalloc_alloc_zero(sizeof(sorted_set_t));
+
+    art_tree_init(&sorted_set->members);
+    sorted_set->head = sorted_set_node_new(SORTED_SET_SKIPLIST_LEVELS_MAX, NULL, 0, 0);
+    sorted_set->tail = NULL;
+    sorted_set->count = 0;
+    sorted_set->nodes_size = sorted_set_node_size(SORTED_SET_SKIPLIST_LEVELS_MAX, 0);
+    sorted_set->levels_count = 1;
+
+    for(int level = 0; level < SORTED_SET_SKIPLIST_LEVELS_MAX; level++) {
+        sorted_set->last[level] = sorted_set->head;
+    }
+
+    return sorted_set;
+}
+
+void sorted_set_free(
+        sorted_set_t *sorted_set) {
+    sorted_set_node_t *node = sorted_set->head->levels[0].forward;
+
+    while(node) {
+        sorted_set_node_t *next = node->levels[0].forward;
+        xalloc_free(node);
+        node = next;
+    }
+
+    art_tree_destroy(&sorted_set->members);
+    xalloc_free(sorted_set->head);
+    xalloc_free(sorted_set);
+}
+
+sorted_set_t *sorted_set_clone(
+        sorted_set_t *sorted_set) {
+    sorted_set_t *sorted_set_cloned = sorted_set_new();
+
+    for(sorted_set_node_t *node = sorted_set_first(sorted_set); node; node = sorted_set_next(node)) {
+        sorted_set_append(sorted_set_cloned, node->member, node->member_length, node->score);
+    }
+
+    return sorted_set_cloned;
+}
+
+int sorted_set_compare(
+        double score_a,
+        char *member_a,
+        size_t member_a_length,
+        double score_b,
+        char *member_b,
+        size_t member_b_length) {
+    if (score_a < score_b) {
+        return -1;
+    } else if (score_a > score_b) {
+        return 1;
+    }
+
+    // Same score, the members are compared as binary strings, the shortest comes first if one is prefix of the other
+    int result = memcmp(member_a, member_b, MIN(member_a_length, member_b_length));
+    if (result != 0) {
+        return result;
+    }
+
+    return member_a_length < member_b_length ? -1 : (member_a_length > member_b_length ? 1 : 0);
+}
+
+sorted_set_node_t *sorted_set_get(
+        sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length) {
+    char key_stack[SORTED_SET_MEMBER_KEY_STACK_MAX_LENGTH];
+    char *key = sorted_set_member_key(member, member_length, key_stack);
+
+    sorted_set_node_t *node = art_search(&sorted_set->members, (unsigned char*)key, member_length + 1);
+
+    if (unlikely(key != key_stack)) {
+        xalloc_free(key);
+    }
+
+    return node;
+}
+
+sorted_set_node_t *sorted_set_insert(
+        sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        double score) {
+    sorted_set_node_t *node = sorted_set_node_new(sorted_set_random_level(), member, member_length, score);
+
+    sorted_set_skiplist_link(sorted_set, node);
+    sorted_set->nodes_size += sorted_set_node_size(node->levels_count, member_length);
+    art_insert(&sorted_set->members, (unsigned char*)node->member, member_length + 1, node);
+
+    return node;
+}
+
+sorted_set_node_t *sorted_set_append(
+        sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        double score) {
+    sorted_set_node_t *node = sorted_set_node_new(sorted_set_random_level(), member, member_length, score);
+
+    assert(sorted_set->tail == NULL || sorted_set_compare(
+            sorted_set->tail->score,
+            sorted_set->tail->member,
+            sorted_set->tail->member_length,
+            score,
+            member,
+            member_length) < 0);
+
+    if (node->levels_count > sorted_set->levels_count) {
+        for(int level = sorted_set->levels_count; level < node->levels_count; level++) {
+            sorted_set->head->levels[level].span = sorted_set->count;
+        }
+
+        sorted_set->levels_count = node->levels_count;
+    }
+
+    // The last node of each level is tracked so the new node can be linked without searching for the position, the
+    // span of the links pointing to nothing is the distance of the node from the end so it just grows by one
+    for(int level = 0; level < node->levels_count; level++) {
+        sorted_set->last[level]->levels[level].forward = node;
+        sorted_set->last[level]->levels[level].span++;
+        sorted_set->last[level] = node;
+    }
+
+    for(int level = node->levels_count; level < sorted_set->levels_count; level++) {
+        sorted_set->last[level]->levels[level].span++;
+    }
+
+    node->backward = sorted_set->tail;
+    sorted_set->tail = node;
+    sorted_set->count++;
+    sorted_set->nodes_size += sorted_set_node_size(node->levels_count, member_length);
+
+    art_insert(&sorted_set->members, (unsigned char*)node->member, member_length + 1, node);
+
+    return node;
+}
+
+sorted_set_node_t *sorted_set_update_score(
+        sorted_set_t *sorted_set,
+        sorted_set_node_t *node,
+        double score) {
+    sorted_set_node_t *next = node->levels[0].forward;
+
+    // If the node would stay where it is there is no need to unlink it
+    if ((node->backward == NULL || sorted_set_compare(
+            node->backward->score,
+            node->backward->member,
+            node->backward->member_length,
+            score,
+            node->member,
+            node->member_length) < 0) &&
+        (next == NULL || sorted_set_compare(
+            next->score,
+            next->member,
+            next->member_length,
+            score,
+            node->member,
+            node->member_length) > 0)) {
+        node->score = score;
+        return node;
+    }
+
+    // The node is relinked keeping its levels, the art_spsc tree keeps pointing to it
+    sorted_set_skiplist_unlink(sorted_set, node);
+    node->score = score;
+    sorted_set_skiplist_link(sorted_set, node);
+
+    return node;
+}
+
+bool sorted_set_remove(
+        sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length) {
+    sorted_set_node_t *node = sorted_set_get(sorted_set, member, member_length);
+
+    if (node == NULL) {
+        return false;
+    }
+
+    sorted_set_skiplist_unlink(sorted_set, node);
+    art_delete(&sorted_set->members, (unsigned char*)node->member, member_length + 1);
+    sorted_set->nodes_size -= sorted_set_node_size(node->levels_count, member_length);
+    xalloc_free(node);
+
+    return true;
+}
+
+uint64_t sorted_set_rank(
+        sorted_set_t *sorted_set,
+        sorted_set_node_t *node) {
+    uint64_t rank = 0;
+    sorted_set_node_t *current = sorted_set->head;
+
+    for(int level = sorted_set->levels_count - 1; level >= 0; level--) {
+        while(current->levels[level].forward && sorted_set_compare(
+                current->levels[level].forward->score,
+                current->levels[level].forward->member,
+                current->levels[level].forward->member_length,
+                node->score,
+                node->member,
+                node->member_length) <= 0) {
+            rank += current->levels[level].span;
+            current = current->levels[level].forward;
+        }
+
+        if (current == node) {
+            return rank - 1;
+        }
+    }
+
+    // Can't really happen, the node is always part of the sorted set
+    assert(false);
+    return 0;
+}
+
+sorted_set_node_t *sorted_set_get_by_rank(
+        sorted_set_t *sorted_set,
+        uint64_t rank) {
+    uint64_t traversed = 0;
+    sorted_set_node_t *current = sorted_set->head;
+
+    if (rank >= sorted_set->count) {
+        return NULL;
+    }
+
+    // The ranks are 0-based while the spans count the head as the node at position 0
+    rank++;
+
+    for(int level = sorted_set->levels_count - 1; level >= 0; level--) {
+        while(current->levels[level].forward && traversed + current->levels[level].span <= rank) {
+            traversed += current->levels[level].span;
+            current = current->levels[level].forward;
+        }
+
+        if (traversed == rank) {
+            return current;
+        }
+    }
+
+    return NULL;
+}
+
+sorted_set_node_t *sorted_set_first_by_score(
+        sorted_set_t *sorted_set,
+        double score,
+        bool exclusive) {
+    sorted_set_node_t *current = sorted_set->head;
+
+    for(int level = sorted_set->levels_count - 1; level >= 0; level--) {
+        while(current->levels[level].forward &&
+            (exclusive
+                ? current->levels[level].forward->score <= score
+                : current->levels[level].forward->score < score)) {
+            current = current->levels[level].forward;
+        }
+    }
+
+    return current->levels[0].forward;
+}
@@ -0,0 +1,218 @@
+#ifndef CACHEGRAND_SORTED_SET_H
+#define CACHEGRAND_SORTED_SET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SORTED_SET_SKIPLIST_LEVELS_MAX          (32)
+#define SORTED_SET_MEMBER_KEY_STACK_MAX_LENGTH  (256)
+
+/**
+ * Sorted set
+ *
+ * The members are kept ordered by score, and by member for the same score, in a skiplist where every link also tracks
+ * its span, the number of nodes it skips, so the rank of a node and the node at a given rank can be found in
+ * O(log n) walking down the levels. The members are indexed by an art_spsc radix tree that maps them to the nodes of
+ * the skiplist to fetch the score of a member without walking the skiplist.
+ *
+ * The art_spsc tree can't tell apart two keys that differ only for trailing NUL bytes, so the members are indexed with
+ * an additional trailing non-NUL byte.
+ *
+ * The sorted sets are stored in the database as they are, the size of the nodes is tracked to account the memory used
+ * by a sorted set, the inner nodes of the art_spsc tree are not accounted.
+ *
+ * The sorted set is not thread safe.
+ */
+typedef struct sorted_set_node sorted_set_node_t;
+typedef struct sorted_set_node_level sorted_set_node_level_t;
+struct sorted_set_node_level {
+    sorted_set_node_t *forward;
+    uint64_t span;
+};
+
+struct sorted_set_node {
+    double score;
+    char *member;
+    size_t member_length;
+    sorted_set_node_t *backward;
+    uint8_t levels_count;
+    sorted_set_node_level_t levels[];
+};
+
+typedef struct sorted_set sorted_set_t;
+struct sorted_set {
+    art_tree members;
+    sorted_set_node_t *head;
+    sorted_set_node_t *tail;
+    sorted_set_node_t *last[SORTED_SET_SKIPLIST_LEVELS_MAX];
+    uint64_t count;
+    size_t nodes_size;
+    uint8_t levels_count;
+};
+
+/**
+ * Allocate a new empty sorted set
+ *
+ * @return The sorted set
+ */
+sorted_set_t *sorted_set_new();
+
+/**
+ * Free the sorted set and all its nodes
+ *
+ * @param sorted_set The sorted set
+ */
+void sorted_set_free(
+        sorted_set_t *sorted_set);
+
+/**
+ * Clone a sorted set, the members are appended in order so the cost is O(n)
+ *
+ * @param sorted_set The sorted set to clone
+ * @return The new sorted set
+ */
+sorted_set_t *sorted_set_clone(
+        sorted_set_t *sorted_set);
+
+/**
+ * Compare two entries using the sorted set ordering, by score and then by member
+ *
+ * @return A negative value, 0 or a positive value if the first entry sorts before, is equal or sorts after the second
+ */
+int sorted_set_compare(
+        double score_a,
+        char *member_a,
+        size_t member_a_length,
+        double score_b,
+        char *member_b,
+        size_t member_b_length);
+
+/**
+ * Search a member in the sorted set
+ *
+ * @param sorted_set The sorted set
+ * @param member The member to search
+ * @param member_length The length of the member
+ * @return The node of the member or NULL if the member is not part of the sorted set
+ */
+sorted_set_node_t *sorted_set_get(
+        sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length);
+
+/**
+ * Insert a member in the sorted set, the member must not be already part of it, the member is copied
+ *
+ * @param sorted_set The sorted set
+ * @param member The member to insert
+ * @param member_length The length of the member
+ * @param score The score of the member
+ * @return The node of the member
+ */
+sorted_set_node_t *sorted_set_insert(
+        sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        double score);
+
+/**
+ * Append a member to the sorted set, it's faster than sorted_set_insert as it doesn't have to search for the insert
+ * position but the member must not be already part of the sorted set and must sort after all the other members.
+ * Used to load an already ordered list of members in O(n).
+ *
+ * @param sorted_set The sorted set
+ * @param member The member to append
+ * @param member_length The length of the member
+ * @param score The score of the member
+ * @return The node of the member
+ */
+sorted_set_node_t *sorted_set_append(
+        sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        double score);
+
+/**
+ * Update the score of a member, the node is relinked only if the new score changes its position, the node itself is
+ * never reallocated
+ *
+ * @param sorted_set The sorted set
+ * @param node The node of the member
+ * @param score The new score
+ * @return The node of the member
+ */
+sorted_set_node_t *sorted_set_update_score(
+        sorted_set_t *sorted_set,
+        sorted_set_node_t *node,
+        double score);
+
+/**
+ * Remove a member from the sorted set
+ *
+ * @param sorted_set The sorted set
+ * @param member The member to remove
+ * @param member_length The length of the member
+ * @return true if the member has been removed, false if it wasn't part of the sorted set
+ */
+bool sorted_set_remove(
+        sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length);
+
+/**
+ * Calculate the rank, 0-based, of a node
+ *
+ * @param sorted_set The sorted set
+ * @param node The node
+ * @return The rank of the node
+ */
+uint64_t sorted_set_rank(
+        sorted_set_t *sorted_set,
+        sorted_set_node_t *node);
+
+/**
+ * Fetch the node at a given rank, 0-based
+ *
+ * @param sorted_set The sorted set
+ * @param rank The rank
+ * @return The node or NULL if the rank is out of range
+ */
+sorted_set_node_t *sorted_set_get_by_rank(
+        sorted_set_t *sorted_set,
+        uint64_t rank);
+
+/**
+ * Fetch the first node with a score greater than or equal to, or strictly greater than if exclusive is set, the score
+ * passed
+ *
+ * @param sorted_set The sorted set
+ * @param score The minimum score
+ * @param exclusive If the minimum score is exclusive
+ * @return The node or NULL if all the scores are lower
+ */
+sorted_set_node_t *sorted_set_first_by_score(
+        sorted_set_t *sorted_set,
+        double score,
+        bool exclusive);
+
+static inline size_t sorted_set_size(
+        sorted_set_t *sorted_set) {
+    return sizeof(sorted_set_t) + sorted_set->nodes_size;
+}
+
+static inline sorted_set_node_t *sorted_set_first(
+        sorted_set_t *sorted_set) {
+    return sorted_set->head->levels[0].forward;
+}
+
+static inline sorted_set_node_t *sorted_set_next(
+        sorted_set_node_t *node) {
+    return node->levels[0].forward;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_SORTED_SET_H
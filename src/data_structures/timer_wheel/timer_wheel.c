@@ -0,0 +1,248 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "xalloc.h"
+
+#include "timer_wheel.h"
+
+#define TAG "timer_wheel"
+
+static inline uint64_t timer_wheel_level_shift(
+        uint8_t level) {
+    return (uint64_t)level * TIMER_WHEEL_SLOTS_BITS;
+}
+
+static inline uint64_t timer_wheel_ror64(
+        uint64_t value,
+        uint8_t shift) {
+    return shift == 0 ? value : (value >> shift) | (value << (64 - shift));
+}
+
+static void timer_wheel_slot_push(
+        timer_wheel_t *wheel,
+        timer_wheel_timer_t *timer) {
+    timer_wheel_timer_t **head = &wheel->slots[timer->level][timer->slot];
+
+    timer->prev = NULL;
+    timer->next = *head;
+    if (*head) {
+        (*head)->prev = timer;
+    }
+    *head = timer;
+
+    wheel->slots_bitmap[timer->level] |= 1ull << timer->slot;
+}
+
+static void timer_wheel_slot_unlink(
+        timer_wheel_t *wheel,
+        timer_wheel_timer_t *timer) {
+    timer_wheel_timer_t **head = &wheel->slots[timer->level][timer->slot];
+
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        *head = timer->next;
+    }
+
+    if (timer->next) {
+        timer->next->prev = timer->prev;
+    }
+
+    timer->prev = timer->next = NULL;
+
+    if (*head == NULL) {
+        wheel->slots_bitmap[timer->level] &= ~(1ull << timer->slot);
+    }
+}
+
+static void timer_wheel_insert(
+        timer_wheel_t *wheel,
+        timer_wheel_timer_t *timer) {
+    uint8_t level = 0;
+    uint64_t expires_at_tick = timer->expires_at_tick;
+    uint64_t delta = expires_at_tick - wheel->current_tick;
+
+    // The timers farther than the range covered by the wheel are parked in the last level, they will be cascaded again
+    // till their deadline falls within the range
+    if (unlikely(delta >= TIMER_WHEEL_MAX_TICKS)) {
+        delta = TIMER_WHEEL_MAX_TICKS - 1;
+        expires_at_tick = wheel->current_tick + delta;
+    }
+
+    while(delta >= (1ull << timer_wheel_level_shift(level + 1))) {
+        level++;
+    }
+
+    timer->level = level;
+    timer->slot = (expires_at_tick >> timer_wheel_level_shift(level)) & TIMER_WHEEL_SLOTS_MASK;
+
+    timer_wheel_slot_push(wheel, timer);
+}
+
+static void timer_wheel_cascade(
+        timer_wheel_t *wheel,
+        uint8_t level,
+        uint8_t slot) {
+    timer_wheel_timer_t *timer = wheel->slots[level][slot];
+
+    wheel->slots[level][slot] = NULL;
+    wheel->slots_bitmap[level] &= ~(1ull << slot);
+
+    // The timers are re-inserted relatively to the current tick so they always end up in a lower level
+    while(timer) {
+        timer_wheel_timer_t *next = timer->next;
+        timer_wheel_insert(wheel, timer);
+        timer = next;
+    }
+}
+
+timer_wheel_t *timer_wheel_new(
+        uint64_t tick_ms,
+        uint64_t now_ms) {
+    assert(tick_ms > 0);
+
+    timer_wheel_t *wheel = xalloc_alloc_zero(sizeof(timer_wheel_t));
+
+    wheel->tick_ms = tick_ms;
+    wheel->start_ms = now_ms;
+    wheel->current_tick = 0;
+
+    return wheel;
+}
+
+void timer_wheel_free(
+        timer_wheel_t *wheel) {
+    xalloc_free(wheel);
+}
+
+void timer_wheel_add(
+        timer_wheel_t *wheel,
+        timer_wheel_timer_t *timer,
+        uint64_t expires_at_ms,
+        timer_wheel_timer_fp_t *fp,
+        void *user_data) {
+    uint64_t expires_at_tick = 0;
+
+    if (timer->armed) {
+        timer_wheel_remove(wheel, timer);
+    }
+
+    // Round up to never fire a timer before its deadline
+    if (likely(expires_at_ms > wheel->start_ms)) {
+        expires_at_tick = ((expires_at_ms - wheel->start_ms) + wheel->tick_ms - 1) / wheel->tick_ms;
+    }
+
+    if (expires_at_tick <= wheel->current_tick) {
+        expires_at_tick = wheel->current_tick + 1;
+    }
+
+    timer->expires_at_tick = expires_at_tick;
+    timer->fp = fp;
+    timer->user_data = user_data;
+    timer->armed = true;
+
+    timer_wheel_insert(wheel, timer);
+    wheel->count++;
+}
+
+bool timer_wheel_remove(
+        timer_wheel_t *wheel,
+        timer_wheel_timer_t *timer) {
+    if (!timer->armed) {
+        return false;
+    }
+
+    timer_wheel_slot_unlink(wheel, timer);
+    timer->armed = false;
+    wheel->count--;
+
+    return true;
+}
+
+uint64_t timer_wheel_get_next_tick(
+        timer_wheel_t *wheel) {
+    uint64_t next_tick = UINT64_MAX;
+
+    if (wheel->count == 0) {
+        return next_tick;
+    }
+
+    for(uint8_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        uint64_t bitmap = wheel->slots_bitmap[level];
+        if (bitmap == 0) {
+            continue;
+        }
+
+        uint64_t shift = timer_wheel_level_shift(level);
+        uint64_t level_tick = wheel->current_tick >> shift;
+        uint8_t current_slot = level_tick & TIMER_WHEEL_SLOTS_MASK;
+
+        // The slot of the current tick has already been processed, if it has timers they belong to the next rotation
+        uint64_t rotated = timer_wheel_ror64(bitmap, current_slot) & ~1ull;
+        uint64_t distance = rotated ? (uint64_t)__builtin_ctzll(rotated) : TIMER_WHEEL_SLOTS;
+        uint64_t tick = (level_tick + distance) << shift;
+
+        if (tick < next_tick) {
+            next_tick = tick;
+        }
+    }
+
+    return next_tick;
+}
+
+uint32_t timer_wheel_advance(
+        timer_wheel_t *wheel,
+        uint64_t now_ms) {
+    uint32_t fired_count = 0;
+    uint64_t target_tick = now_ms > wheel->start_ms
+            ? (now_ms - wheel->start_ms) / wheel->tick_ms
+            : 0;
+
+    while(wheel->current_tick < target_tick) {
+        // Jump straight to the next tick with something to do, the ticks in between would only process empty slots
+        uint64_t tick = timer_wheel_get_next_tick(wheel);
+        if (tick > target_tick) {
+            wheel->current_tick = target_tick;
+            break;
+        }
+
+        wheel->current_tick = tick;
+
+        // Cascade from the highest level, the timers moved down might have to be cascaded again or fired in this tick
+        for(int8_t level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+            uint64_t shift = timer_wheel_level_shift(level);
+            if ((tick & ((1ull << shift) - 1)) != 0) {
+                continue;
+            }
+
+            uint8_t slot = (tick >> shift) & TIMER_WHEEL_SLOTS_MASK;
+            if (wheel->slots_bitmap[level] & (1ull << slot)) {
+                timer_wheel_cascade(wheel, level, slot);
+            }
+        }
+
+        // The callbacks can add or remove timers but, as the deadline is always at least one tick ahead, none will be
+        // added to the slot being processed
+        uint8_t slot = tick & TIMER_WHEEL_SLOTS_MASK;
+        timer_wheel_timer_t *timer;
+        while((timer = wheel->slots[0][slot]) != NULL) {
+            timer_wheel_remove(wheel, timer);
+            timer->fp(timer, timer->user_data);
+            fired_count++;
+        }
+    }
+
+    return fired_count;
+}
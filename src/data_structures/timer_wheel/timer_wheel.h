@@ -0,0 +1,154 @@
+#ifndef CACHEGRAND_TIMER_WHEEL_H
+#define CACHEGRAND_TIMER_WHEEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TIMER_WHEEL_LEVELS          (4)
+#define TIMER_WHEEL_SLOTS_BITS      (6)
+#define TIMER_WHEEL_SLOTS           (1u << TIMER_WHEEL_SLOTS_BITS)
+#define TIMER_WHEEL_SLOTS_MASK      (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_MAX_TICKS       (1ull << (TIMER_WHEEL_SLOTS_BITS * TIMER_WHEEL_LEVELS))
+
+typedef struct timer_wheel_timer timer_wheel_timer_t;
+typedef void (timer_wheel_timer_fp_t)(timer_wheel_timer_t *timer, void *user_data);
+
+/**
+ * Timer
+ *
+ * The timers are intrusive, the memory is owned by the caller that usually embeds them into the structure that needs
+ * the deadline (or keeps them on the stack of the fiber waiting for it) so adding or removing a timer never allocates.
+ */
+struct timer_wheel_timer {
+    timer_wheel_timer_t *prev;
+    timer_wheel_timer_t *next;
+    uint64_t expires_at_tick;
+    timer_wheel_timer_fp_t *fp;
+    void *user_data;
+    uint8_t level;
+    uint8_t slot;
+    bool armed;
+};
+
+/**
+ * Hierarchical timer wheel
+ *
+ * The wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots each, every level covers TIMER_WHEEL_SLOTS times
+ * the range of the previous one. The timers are placed in the level that covers their deadline and are cascaded to the
+ * lower levels as the time advances, only the timers in the first level are fired.
+ * With 4 levels of 64 slots and a 1ms tick the wheel covers ~4.6 hours, the timers with a farther deadline are parked
+ * in the last level and cascaded again till they expire.
+ * The slots_bitmap tracks, per level, which slots have timers to quickly find the next expiry without having to scan
+ * the slots.
+ */
+typedef struct timer_wheel timer_wheel_t;
+struct timer_wheel {
+    uint64_t tick_ms;
+    uint64_t start_ms;
+    uint64_t current_tick;
+    uint32_t count;
+    uint64_t slots_bitmap[TIMER_WHEEL_LEVELS];
+    timer_wheel_timer_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+
+/**
+ * Initialize a new timer wheel
+ *
+ * @param tick_ms The resolution of the wheel in milliseconds
+ * @param now_ms The current time in milliseconds, used as origin of the wheel
+ * @return A pointer to the new timer wheel
+ */
+timer_wheel_t *timer_wheel_new(
+        uint64_t tick_ms,
+        uint64_t now_ms);
+
+/**
+ * Free the timer wheel, the timers are owned by the caller and are not touched
+ *
+ * @param wheel The timer wheel
+ */
+void timer_wheel_free(
+        timer_wheel_t *wheel);
+
+/**
+ * Add a timer to the wheel, if the timer is already armed it is re-armed with the new deadline.
+ * The callback is never invoked before the deadline, the deadlines already expired are fired on the next tick.
+ *
+ * @param wheel The timer wheel
+ * @param timer The timer to add
+ * @param expires_at_ms The deadline of the timer in milliseconds
+ * @param fp The callback invoked when the timer expires
+ * @param user_data The user data passed to the callback
+ */
+void timer_wheel_add(
+        timer_wheel_t *wheel,
+        timer_wheel_timer_t *timer,
+        uint64_t expires_at_ms,
+        timer_wheel_timer_fp_t *fp,
+        void *user_data);
+
+/**
+ * Remove a timer from the wheel
+ *
+ * @param wheel The timer wheel
+ * @param timer The timer to remove
+ * @return true if the timer was armed, false otherwise
+ */
+bool timer_wheel_remove(
+        timer_wheel_t *wheel,
+        timer_wheel_timer_t *timer);
+
+/**
+ * Advance the wheel up to the given time firing the expired timers, the callbacks are allowed to add or remove timers
+ *
+ * @param wheel The timer wheel
+ * @param now_ms The current time in milliseconds
+ * @return The number of timers fired
+ */
+uint32_t timer_wheel_advance(
+        timer_wheel_t *wheel,
+        uint64_t now_ms);
+
+/**
+ * Return the tick at which the wheel has to be advanced next, it's never later than the deadline of the first timer
+ * to expire but, if the first timer is not in the first level, it can be earlier as the wheel has to cascade the timers
+ *
+ * @param wheel The timer wheel
+ * @return The next tick or UINT64_MAX if there are no timers
+ */
+uint64_t timer_wheel_get_next_tick(
+        timer_wheel_t *wheel);
+
+static inline void timer_wheel_timer_init(
+        timer_wheel_timer_t *timer) {
+    timer->prev = timer->next = NULL;
+    timer->armed = false;
+}
+
+static inline bool timer_wheel_timer_is_armed(
+        timer_wheel_timer_t *timer) {
+    return timer->armed;
+}
+
+static inline uint32_t timer_wheel_get_count(
+        timer_wheel_t *wheel) {
+    return wheel->count;
+}
+
+static inline bool timer_wheel_is_empty(
+        timer_wheel_t *wheel) {
+    return wheel->count == 0;
+}
+
+static inline uint64_t timer_wheel_tick_to_ms(
+        timer_wheel_t *wheel,
+        uint64_t tick) {
+    return wheel->start_ms + (tick * wheel->tick_ms);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_TIMER_WHEEL_H
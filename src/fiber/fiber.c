@@ -72,13 +72,67 @@ void fiber_stack_protection(
     }
 }
 
+static void fiber_context_init(
+        fiber_t *fiber,
+        fiber_start_fp_t *fiber_start_fp,
+        void *user_data) {
+    void *temp_swap_stack_ptr = NULL;
+
+    // Align the stack_pointer to 16 bytes and add some padding as required by the ABI adding abort to the stack
+    void **stack_pointer = (void**)(((uintptr_t)fiber->stack_base + fiber->stack_size) & -16L);
+
+#if defined(__aarch64__)
+    stack_pointer -= FIBER_CONTEXT_NUM_REGISTRIES;
+    *(stack_pointer + FIBER_CONTEXT_SP_PC_OFFSET) = fiber_new_first_run;
+    *(stack_pointer + FIBER_CONTEXT_SP_ABRT_OFFSET) = fiber_abort;
+#elif defined(__amd64)
+    *--stack_pointer = (void *)fiber_abort;
+    *--stack_pointer = (void *)fiber_new_first_run;
+    stack_pointer -= FIBER_CONTEXT_NUM_REGISTRIES;
+#else
+#error "Unsupported architecture"
+#endif
+
+    // Initialize the fiber context
+    fiber->start_fp = fiber_start_fp;
+    fiber->start_fp_user_data = user_data;
+
+    if (fiber_start_fp) {
+        // Do a fist swap to initialize the fiber stack content
+        fiber_new_first_run_fiber = fiber;
+        fiber_new_first_run_fiber_start_fp = fiber_start_fp;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wreturn-local-addr"
+        // CodeQL reports the below assignments as potentially dangerous because it is possible that the address of
+        // assgined might be later overwritten, these are local (stack) variables and the address should never be used
+        // outside of this function.
+        // However, the address is used only to pass the address of the variable to the fiber_new_first_run function
+        // and the fiber_new_first_run function will never use the address after the swap. This is required for the
+        // fiber context (stack) swap implementation and can't be avoided.
+        fiber_new_first_run_func_user_data = user_data;
+        fiber_new_first_run_from = &temp_swap_stack_ptr;
+        fiber_new_first_run_to = (void **)&stack_pointer;
+#pragma GCC diagnostic pop
+        fiber_context_swap(fiber_new_first_run_from, fiber_new_first_run_to);
+
+        fiber_new_first_run_fiber = NULL;
+        fiber_new_first_run_fiber_start_fp = NULL;
+        fiber_new_first_run_func_user_data = NULL;
+        fiber_new_first_run_from = NULL;
+        fiber_new_first_run_to = NULL;
+    }
+
+    // The stack pointer HAS to be updated after fiber_context_swap because it will be updated with the new value
+    // after the initial execution of the fiber
+    fiber->stack_pointer = stack_pointer;
+}
+
 fiber_t *fiber_new(
         char *name,
         size_t name_len,
         size_t stack_size,
         fiber_start_fp_t *fiber_start_fp,
         void *user_data) {
-    void *temp_swap_stack_ptr = NULL;
     size_t page_size = xalloc_get_page_size();
 
     // If user data are passed the start function must be passed too
@@ -111,32 +165,13 @@ fiber_t *fiber_new(
     fiber_t *fiber = xalloc_alloc_zero(sizeof(fiber_t));
     void *stack_base = xalloc_alloc_aligned_zero(page_size, stack_size_with_guard);
 
-    // Align the stack_pointer to 16 bytes and add some padding as required by the ABI adding abort to the stack
-    void **stack_pointer = (void**)(((uintptr_t)stack_base + stack_size_with_guard) & -16L);
-
-#if defined(__aarch64__)
-    stack_pointer -= FIBER_CONTEXT_NUM_REGISTRIES;
-    *(stack_pointer + FIBER_CONTEXT_SP_PC_OFFSET) = fiber_new_first_run;
-    *(stack_pointer + FIBER_CONTEXT_SP_ABRT_OFFSET) = fiber_abort;
-#elif defined(__amd64)
-    *--stack_pointer = (void *)fiber_abort;
-    *--stack_pointer = (void *)fiber_new_first_run;
-    stack_pointer -= FIBER_CONTEXT_NUM_REGISTRIES;
-#else
-#error "Unsupported architecture"
-#endif
-
-
     LOG_DI(
             "Initializing new fiber <%s> with a stack of <%lu (%lu with guard pages)> bytes starting at <%p>",
             name,
             stack_size,
             stack_size_with_guard,
-            stack_pointer);
+            stack_base);
 
-    // Initialize the fiber context
-    fiber->start_fp = fiber_start_fp;
-    fiber->start_fp_user_data = user_data;
     fiber->stack_base = stack_base;
     fiber->stack_size = stack_size_with_guard;
 
@@ -145,34 +180,7 @@ fiber_t *fiber_new(
     fiber->name = (char*)xalloc_alloc_zero(name_len + 1);
     strncpy(fiber->name, name, name_len);
 
-    if (fiber_start_fp) {
-        // Do a fist swap to initialize the fiber stack content
-        fiber_new_first_run_fiber = fiber;
-        fiber_new_first_run_fiber_start_fp = fiber_start_fp;
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wreturn-local-addr"
-        // CodeQL reports the below assignments as potentially dangerous because it is possible that the address of
-        // assgined might be later overwritten, these are local (stack) variables and the address should never be used
-        // outside of this function.
-        // However, the address is used only to pass the address of the variable to the fiber_new_first_run function
-        // and the fiber_new_first_run function will never use the address after the swap. This is required for the
-        // fiber context (stack) swap implementation and can't be avoided.
-        fiber_new_first_run_func_user_data = user_data;
-        fiber_new_first_run_from = &temp_swap_stack_ptr;
-        fiber_new_first_run_to = (void **)&stack_pointer;
-#pragma GCC diagnostic pop
-        fiber_context_swap(fiber_new_first_run_from, fiber_new_first_run_to);
-
-        fiber_new_first_run_fiber = NULL;
-        fiber_new_first_run_fiber_start_fp = NULL;
-        fiber_new_first_run_func_user_data = NULL;
-        fiber_new_first_run_from = NULL;
-        fiber_new_first_run_to = NULL;
-    }
-
-    // The stack pointer HAS to be updated after fiber_context_swap because it will be updated with the new value
-    // after the initial execution of the fiber
-    fiber->stack_pointer = stack_pointer;
+    fiber_context_init(fiber, fiber_start_fp, user_data);
 
 #if defined(HAS_VALGRIND)
     uintptr_t stack_base_addr = (uintptr_t)fiber->stack_base;
@@ -185,6 +193,34 @@ fiber_t *fiber_new(
     return fiber;
 }
 
+bool fiber_reuse(
+        fiber_t *fiber,
+        char *name,
+        size_t name_len,
+        fiber_start_fp_t *fiber_start_fp,
+        void *user_data) {
+    // If user data are passed the start function must be passed too
+    if (fiber_start_fp == NULL && user_data != NULL) {
+        return false;
+    }
+
+    // The stack is already allocated and the guard pages are still protected, there is no need to touch the memory
+    // protection or to zero the stack as the context is rebuilt from scratch starting from the top of the stack
+    fiber->terminate = false;
+    fiber->error_number = 0;
+    fiber->ret.uint64_value = 0;
+    fiber->transaction = NULL;
+    fiber->client_id = 0;
+
+    fiber->name = (char*)xalloc_realloc(fiber->name, name_len + 1);
+    strncpy(fiber->name, name, name_len);
+    fiber->name[name_len] = 0;
+
+    fiber_context_init(fiber, fiber_start_fp, user_data);
+
+    return true;
+}
+
 void fiber_free(
         fiber_t *fiber) {
     fiber_stack_protection(fiber, false);
@@ -50,6 +50,12 @@ struct fiber {
         int64_t int64_value;
     } ret;
     unsigned int valgrind_stack_id;
+    // When set, the transactions acquired by the fiber are nested into this one and the locks are held until it gets
+    // released, it's used to carry out a sequence of operations atomically
+    struct transaction *transaction;
+    // The id of the client whose command is being processed by the fiber, 0 if none, it's used to know which client
+    // changed a key
+    uint64_t client_id;
 #if DEBUG == 1
     struct {
         int line;
@@ -74,6 +80,13 @@ fiber_t* fiber_new(
         fiber_start_fp_t* fiber_start_fp,
         void* user_data);
 
+bool fiber_reuse(
+        fiber_t* fiber,
+        char *name,
+        size_t name_len,
+        fiber_start_fp_t* fiber_start_fp,
+        void* user_data);
+
 void fiber_free(
         fiber_t* fiber);
 
@@ -0,0 +1,109 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "misc.h"
+#include "xalloc.h"
+#include "log/log.h"
+#include "fiber.h"
+
+#include "fiber_pool.h"
+
+#define TAG "fiber_pool"
+
+#define FIBER_POOL_PREWARM_FIBER_NAME "pooled"
+
+fiber_pool_t *fiber_pool_new(
+        size_t stack_size,
+        uint32_t max_size) {
+    fiber_pool_t *fiber_pool = xalloc_alloc_zero(sizeof(fiber_pool_t));
+
+    fiber_pool->stack_size = stack_size;
+    fiber_pool->max_size = max_size;
+    fiber_pool->count = 0;
+    fiber_pool->fibers = xalloc_alloc_zero(sizeof(fiber_t*) * max_size);
+
+    return fiber_pool;
+}
+
+void fiber_pool_free(
+        fiber_pool_t *fiber_pool) {
+    for(uint32_t index = 0; index < fiber_pool->count; index++) {
+        fiber_free(fiber_pool->fibers[index]);
+    }
+
+    xalloc_free(fiber_pool->fibers);
+    xalloc_free(fiber_pool);
+}
+
+uint32_t fiber_pool_prewarm(
+        fiber_pool_t *fiber_pool,
+        uint32_t count) {
+    uint32_t prewarmed = 0;
+
+    // The fibers are allocated without an entrypoint, the context will be initialized when the fiber is acquired
+    while(fiber_pool->count < fiber_pool->max_size && prewarmed < count) {
+        fiber_t *fiber = fiber_new(
+                FIBER_POOL_PREWARM_FIBER_NAME,
+                strlen(FIBER_POOL_PREWARM_FIBER_NAME),
+                fiber_pool->stack_size,
+                NULL,
+                NULL);
+
+        if (unlikely(fiber == NULL)) {
+            LOG_E(TAG, "Failed to allocate the fiber to prewarm the pool");
+            break;
+        }
+
+        fiber_pool->fibers[fiber_pool->count++] = fiber;
+        prewarmed++;
+    }
+
+    return prewarmed;
+}
+
+fiber_t *fiber_pool_acquire(
+        fiber_pool_t *fiber_pool,
+        char *name,
+        size_t name_len,
+        fiber_start_fp_t *fiber_start_fp,
+        void *user_data) {
+    if (unlikely(fiber_pool->count == 0)) {
+        return fiber_new(
+                name,
+                name_len,
+                fiber_pool->stack_size,
+                fiber_start_fp,
+                user_data);
+    }
+
+    fiber_t *fiber = fiber_pool->fibers[--fiber_pool->count];
+    fiber_pool->fibers[fiber_pool->count] = NULL;
+
+    if (unlikely(!fiber_reuse(fiber, name, name_len, fiber_start_fp, user_data))) {
+        fiber_pool->fibers[fiber_pool->count++] = fiber;
+        return NULL;
+    }
+
+    return fiber;
+}
+
+void fiber_pool_release(
+        fiber_pool_t *fiber_pool,
+        fiber_t *fiber) {
+    if (unlikely(fiber_pool->count == fiber_pool->max_size)) {
+        fiber_free(fiber);
+        return;
+    }
+
+    fiber_pool->fibers[fiber_pool->count++] = fiber;
+}
@@ -0,0 +1,52 @@
+#ifndef CACHEGRAND_FIBER_POOL_H
+#define CACHEGRAND_FIBER_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The pool keeps around the fibers (and their stacks) of the terminated fibers to be able to recycle them when a new
+// fiber is needed, avoiding the allocation and the zeroing of the stack and, more importantly, the mprotect syscalls
+// required to set up and tear down the guard pages. The pool is not thread safe and it's meant to be used by a single
+// worker, the fibers are handed out in LIFO order so the stacks that are most likely still in the cache are reused
+// first.
+typedef struct fiber_pool fiber_pool_t;
+struct fiber_pool {
+    size_t stack_size;
+    uint32_t max_size;
+    uint32_t count;
+    fiber_t **fibers;
+};
+
+fiber_pool_t *fiber_pool_new(
+        size_t stack_size,
+        uint32_t max_size);
+
+void fiber_pool_free(
+        fiber_pool_t *fiber_pool);
+
+uint32_t fiber_pool_prewarm(
+        fiber_pool_t *fiber_pool,
+        uint32_t count);
+
+fiber_t *fiber_pool_acquire(
+        fiber_pool_t *fiber_pool,
+        char *name,
+        size_t name_len,
+        fiber_start_fp_t *fiber_start_fp,
+        void *user_data);
+
+void fiber_pool_release(
+        fiber_pool_t *fiber_pool,
+        fiber_t *fiber);
+
+static inline __attribute__((always_inline)) uint32_t fiber_pool_get_count(
+        fiber_pool_t *fiber_pool) {
+    return fiber_pool->count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_FIBER_POOL_H
@@ -18,6 +18,7 @@
 #include "log/log.h"
 #include "fatal.h"
 #include "fiber.h"
+#include "fiber_pool.h"
 #include "fiber_scheduler.h"
 #include "intrinsics.h"
 
@@ -30,6 +31,14 @@ thread_local fiber_scheduler_stack_t fiber_scheduler_stack = {
         .index = -1,
         .size = 0
 };
+thread_local fiber_pool_t *fiber_scheduler_fiber_pool = NULL;
+thread_local fiber_scheduler_ready_queue_t fiber_scheduler_ready_queue = {
+        .list = NULL,
+        .count = 0,
+        .size = 0
+};
+thread_local uint64_t fiber_scheduler_time_slice_cycles = 0;
+thread_local uint64_t fiber_scheduler_time_slice_start_tsc = 0;
 
 void fiber_scheduler_free() {
     if (fiber_scheduler_stack.list) {
@@ -39,6 +48,28 @@ void fiber_scheduler_free() {
 
     fiber_scheduler_stack.index = -1;
     fiber_scheduler_stack.size = 0;
+
+    if (fiber_scheduler_ready_queue.list) {
+        xalloc_free(fiber_scheduler_ready_queue.list);
+        fiber_scheduler_ready_queue.list = NULL;
+    }
+
+    fiber_scheduler_ready_queue.count = 0;
+    fiber_scheduler_ready_queue.size = 0;
+}
+
+void fiber_scheduler_set_fiber_pool(
+        fiber_pool_t *fiber_pool) {
+    fiber_scheduler_fiber_pool = fiber_pool;
+}
+
+fiber_pool_t *fiber_scheduler_get_fiber_pool() {
+    return fiber_scheduler_fiber_pool;
+}
+
+void fiber_scheduler_set_time_slice_us(
+        uint64_t time_slice_us) {
+    fiber_scheduler_time_slice_cycles = (intrinsics_frequency_max() / 1000000) * time_slice_us;
 }
 
 void fiber_scheduler_grow_stack() {
@@ -97,12 +128,26 @@ fiber_t* fiber_scheduler_new_fiber(
             .caller_user_data = user_data
     };
 
-    fiber_t* fiber = fiber_new(
-            name,
-            name_len,
-            FIBER_SCHEDULER_STACK_SIZE,
-            fiber_scheduler_new_fiber_entrypoint,
-            &fiber_scheduler_new_fiber_user_data);
+    fiber_t* fiber;
+    if (likely(fiber_scheduler_fiber_pool)) {
+        fiber = fiber_pool_acquire(
+                fiber_scheduler_fiber_pool,
+                name,
+                name_len,
+                fiber_scheduler_new_fiber_entrypoint,
+                &fiber_scheduler_new_fiber_user_data);
+    } else {
+        fiber = fiber_new(
+                name,
+                name_len,
+                FIBER_SCHEDULER_STACK_SIZE,
+                fiber_scheduler_new_fiber_entrypoint,
+                &fiber_scheduler_new_fiber_user_data);
+    }
+
+    if (unlikely(fiber == NULL)) {
+        return NULL;
+    }
 
     fiber_scheduler_switch_to(fiber);
 
@@ -150,6 +195,13 @@ void fiber_scheduler_switch_to(
     fiber_scheduler_stack.index++;
     fiber_scheduler_stack.list[fiber_scheduler_stack.index] = fiber;
 
+    // Each time a fiber is switched to it gets a new time slice, the time slice of the previous fiber is restored
+    // once the execution switches back
+    uint64_t previous_time_slice_start_tsc = fiber_scheduler_time_slice_start_tsc;
+    if (fiber_scheduler_time_slice_cycles > 0) {
+        fiber_scheduler_time_slice_start_tsc = intrinsics_tsc();
+    }
+
     LOG_DI("Switching from fiber <%s> to fiber <%s>, file <%s:%d>, function <%s>",
           previous_fiber->name,
           fiber->name,
@@ -173,10 +225,15 @@ void fiber_scheduler_switch_to(
     // Once the code switches back remove the fiber from the stack
     fiber_scheduler_stack.list[fiber_scheduler_stack.index] = NULL;
     fiber_scheduler_stack.index--;
+    fiber_scheduler_time_slice_start_tsc = previous_time_slice_start_tsc;
 
     if (fiber->terminate) {
         LOG_DI("Fiber marked for termination, cleaning up");
-        fiber_free(fiber);
+        if (likely(fiber_scheduler_fiber_pool)) {
+            fiber_pool_release(fiber_scheduler_fiber_pool, fiber);
+        } else {
+            fiber_free(fiber);
+        }
     }
 }
 
@@ -205,6 +262,84 @@ void fiber_scheduler_switch_back() {
             &fiber_scheduler_stack.list[fiber_scheduler_stack.index - 1]->stack_pointer);
 }
 
+void fiber_scheduler_enqueue_ready(
+        fiber_t *fiber) {
+    if (unlikely(fiber_scheduler_ready_queue.count == fiber_scheduler_ready_queue.size)) {
+        fiber_scheduler_ready_queue.size = fiber_scheduler_ready_queue.size == 0
+                ? FIBER_SCHEDULER_READY_QUEUE_INITIAL_SIZE
+                : fiber_scheduler_ready_queue.size * 2;
+        fiber_scheduler_ready_queue.list = xalloc_realloc(
+                fiber_scheduler_ready_queue.list,
+                sizeof(fiber_t*) * fiber_scheduler_ready_queue.size);
+    }
+
+    // The fiber is queued up and will be resumed by the worker loop after processing the pending events
+    fiber_scheduler_ready_queue.list[fiber_scheduler_ready_queue.count++] = fiber;
+}
+
+void fiber_scheduler_yield() {
+    fiber_scheduler_enqueue_ready(fiber_scheduler_get_current());
+    fiber_scheduler_switch_back();
+}
+
+bool fiber_scheduler_can_yield() {
+    // Yielding is possible only if a time slice has been set, which is done by the worker that takes care of resuming
+    // the fibers in the ready queue, and if the code is running within a fiber
+    return fiber_scheduler_time_slice_cycles > 0 && fiber_scheduler_stack.index >= 1;
+}
+
+bool fiber_scheduler_is_in_fiber() {
+    // The index 0 of the stack is always the scheduler itself
+    return fiber_scheduler_stack.index >= 1;
+}
+
+bool fiber_scheduler_time_slice_expired() {
+    if (likely(!fiber_scheduler_can_yield())) {
+        return false;
+    }
+
+    // A fiber running the commands of an EXEC holds the locks of all the keys touched until the EXEC ends, the nested
+    // transactions hand their locks over to it, so yielding would only keep the other fibers waiting on those locks
+    if (unlikely(fiber_scheduler_get_current()->transaction != NULL)) {
+        return false;
+    }
+
+    return intrinsics_tsc() - fiber_scheduler_time_slice_start_tsc >= fiber_scheduler_time_slice_cycles;
+}
+
+bool fiber_scheduler_yield_if_time_slice_expired() {
+    if (likely(!fiber_scheduler_time_slice_expired())) {
+        return false;
+    }
+
+    fiber_scheduler_yield();
+
+    return true;
+}
+
+bool fiber_scheduler_has_ready_fibers() {
+    return fiber_scheduler_ready_queue.count > 0;
+}
+
+void fiber_scheduler_resume_ready_fibers() {
+    // Only the fibers that were in the queue when the function has been invoked are resumed, if a fiber yields again
+    // it gets appended to the queue and will be resumed in the next iteration of the worker loop, after having
+    // processed the events, to avoid starving the other fibers
+    uint32_t count = fiber_scheduler_ready_queue.count;
+
+    for(uint32_t index = 0; index < count; index++) {
+        fiber_scheduler_switch_to(fiber_scheduler_ready_queue.list[index]);
+    }
+
+    fiber_scheduler_ready_queue.count -= count;
+    if (fiber_scheduler_ready_queue.count > 0) {
+        memmove(
+                fiber_scheduler_ready_queue.list,
+                fiber_scheduler_ready_queue.list + count,
+                sizeof(fiber_t*) * fiber_scheduler_ready_queue.count);
+    }
+}
+
 fiber_t *fiber_scheduler_get_current() {
     assert(fiber_scheduler_stack.list != NULL);
     assert(fiber_scheduler_stack.index > -1);
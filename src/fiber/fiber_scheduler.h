@@ -9,9 +9,14 @@ extern "C" {
 #define FIBER_SCHEDULER_STACK_MAX_SIZE 5
 #define FIBER_SCHEDULER_FIBER_NAME "scheduler"
 #define FIBER_SCHEDULER_COST_WARNINGS_LIMIT 10
+#define FIBER_SCHEDULER_READY_QUEUE_INITIAL_SIZE 16
+#define FIBER_SCHEDULER_TIME_SLICE_US_DEFAULT 500
 
 typedef void (fiber_scheduler_entrypoint_fp_t)(void *user_data);
 
+// Forward declaration, the pool is optional and not all the users of the scheduler need it
+typedef struct fiber_pool fiber_pool_t;
+
 typedef struct fiber_scheduler_stack fiber_scheduler_stack_t;
 struct fiber_scheduler_stack {
     fiber_t **list;
@@ -19,6 +24,13 @@ struct fiber_scheduler_stack {
     int8_t size;
 };
 
+typedef struct fiber_scheduler_ready_queue fiber_scheduler_ready_queue_t;
+struct fiber_scheduler_ready_queue {
+    fiber_t **list;
+    uint32_t count;
+    uint32_t size;
+};
+
 typedef struct fiber_scheduler_new_fiber_user_data fiber_scheduler_new_fiber_user_data_t;
 struct fiber_scheduler_new_fiber_user_data {
     fiber_scheduler_entrypoint_fp_t* caller_entrypoint_fp;
@@ -27,6 +39,14 @@ struct fiber_scheduler_new_fiber_user_data {
 
 void fiber_scheduler_free();
 
+void fiber_scheduler_set_fiber_pool(
+        fiber_pool_t *fiber_pool);
+
+fiber_pool_t *fiber_scheduler_get_fiber_pool();
+
+void fiber_scheduler_set_time_slice_us(
+        uint64_t time_slice_us);
+
 void fiber_scheduler_grow_stack();
 
 bool fiber_scheduler_stack_needs_growth();
@@ -53,6 +73,23 @@ void fiber_scheduler_switch_back_internal(
 void fiber_scheduler_switch_back();
 #endif
 
+bool fiber_scheduler_can_yield();
+
+bool fiber_scheduler_is_in_fiber();
+
+void fiber_scheduler_enqueue_ready(
+        fiber_t *fiber);
+
+void fiber_scheduler_yield();
+
+bool fiber_scheduler_time_slice_expired();
+
+bool fiber_scheduler_yield_if_time_slice_expired();
+
+bool fiber_scheduler_has_ready_fibers();
+
+void fiber_scheduler_resume_ready_fibers();
+
 fiber_t *fiber_scheduler_get_current();
 
 void fiber_scheduler_set_error(
@@ -0,0 +1,58 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "hash/hash_murmurhash64a.h"
+
+uint64_t hash_murmurhash64a(
+        const char* data,
+        size_t data_len,
+        uint32_t seed) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    const uint8_t *data_current = (const uint8_t*)data;
+    const uint8_t *data_end = data_current + (data_len - (data_len & 7));
+    uint64_t h = seed ^ (data_len * m);
+
+    while(data_current != data_end) {
+        uint64_t k;
+
+        // The data is not aligned, memcpy is turned into a plain load by the compiler
+        memcpy(&k, data_current, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+
+        data_current += sizeof(k);
+    }
+
+    switch(data_len & 7) {
+        case 7: h ^= (uint64_t)data_current[6] << 48; // fall through
+        case 6: h ^= (uint64_t)data_current[5] << 40; // fall through
+        case 5: h ^= (uint64_t)data_current[4] << 32; // fall through
+        case 4: h ^= (uint64_t)data_current[3] << 24; // fall through
+        case 3: h ^= (uint64_t)data_current[2] << 16; // fall through
+        case 2: h ^= (uint64_t)data_current[1] << 8; // fall through
+        case 1:
+            h ^= (uint64_t)data_current[0];
+            h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+
+    return h;
+}
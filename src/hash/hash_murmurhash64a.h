@@ -0,0 +1,26 @@
+#ifndef CACHEGRAND_HASH_MURMURHASH64A_H
+#define CACHEGRAND_HASH_MURMURHASH64A_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * MurmurHash64A by Austin Appleby, the results are the ones of the implementation used by Redis on little endian
+ * platforms so the hashes can be used to build data compatible with it (e.g. the HyperLogLogs)
+ *
+ * @param data The data to hash
+ * @param data_len The length of the data
+ * @param seed The seed
+ * @return The 64 bit hash
+ */
+uint64_t hash_murmurhash64a(
+        const char* data,
+        size_t data_len,
+        uint32_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_HASH_MURMURHASH64A_H
@@ -11,6 +11,7 @@ extern "C" {
 #define MEMORY_FENCE_LOAD() atomic_thread_fence(memory_order_acquire)
 #define MEMORY_FENCE_STORE() atomic_thread_fence(memory_order_release)
 #define MEMORY_FENCE_LOAD_STORE() atomic_thread_fence(memory_order_acq_rel)
+#define MEMORY_FENCE_FULL() atomic_thread_fence(memory_order_seq_cst)
 
 #ifdef __cplusplus
 }
@@ -37,7 +37,8 @@ module_id_t module_register(
         module_program_dtor_cb_t *program_dtor,
         module_worker_ctor_cb_t *worker_ctor,
         module_worker_dtor_cb_t *worker_dtor,
-        module_connection_accept_cb_t *connection_accept) {
+        module_connection_accept_cb_t *connection_accept,
+        module_connection_resume_cb_t *connection_resume) {
     assert(name != NULL);
     assert(connection_accept != NULL);
 
@@ -56,6 +57,7 @@ module_id_t module_register(
             .worker_ctor = worker_ctor,
             .worker_dtor = worker_dtor,
             .connection_accept = connection_accept,
+            .connection_resume = connection_resume,
     };
 
     return modules_registered_list_size - 1;
@@ -25,6 +25,9 @@ typedef bool (module_worker_dtor_cb_t)(
         config_module_t *module);
 typedef void (module_connection_accept_cb_t)(
         network_channel_t *network_channel);
+typedef void (module_connection_resume_cb_t)(
+        network_channel_t *network_channel,
+        void *connection_context);
 
 struct module {
     module_id_t id;
@@ -36,6 +39,7 @@ struct module {
     module_worker_ctor_cb_t *worker_ctor;
     module_worker_dtor_cb_t *worker_dtor;
     module_connection_accept_cb_t *connection_accept;
+    module_connection_resume_cb_t *connection_resume;
 };
 typedef struct module module_t;
 
@@ -62,7 +66,8 @@ module_id_t module_register(
         module_program_dtor_cb_t *program_dtor,
         module_worker_ctor_cb_t *worker_ctor,
         module_worker_dtor_cb_t *worker_dtor,
-        module_connection_accept_cb_t *connection_accept);
+        module_connection_accept_cb_t *connection_accept,
+        module_connection_resume_cb_t *connection_resume);
 
 #ifdef __cplusplus
 }
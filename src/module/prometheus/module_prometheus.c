@@ -57,14 +57,13 @@ FUNCTION_CTOR(module_prometheus_register_ctor, {
             NULL,
             NULL,
             NULL,
-            module_prometheus_connection_accept);
+            module_prometheus_connection_accept,
+            NULL);
 });
 
 void module_prometheus_client_new(
         module_prometheus_client_t *module_prometheus_client) {
-    module_prometheus_client->read_buffer.data =
-            (char *)xalloc_alloc_zero(NETWORK_CHANNEL_RECV_BUFFER_SIZE);
-    module_prometheus_client->read_buffer.length = NETWORK_CHANNEL_RECV_BUFFER_SIZE;
+    network_buffer_init(&module_prometheus_client->read_buffer, NETWORK_CHANNEL_RECV_BUFFER_SIZE);
 }
 
 void module_prometheus_client_cleanup(
@@ -87,7 +86,7 @@ void module_prometheus_client_cleanup(
         xalloc_free(http_request_data->headers.list);
     }
 
-    xalloc_free(module_prometheus_client->read_buffer.data);
+    network_buffer_free(&module_prometheus_client->read_buffer);
 }
 
 int module_prometheus_http_parser_on_message_complete(
@@ -637,11 +636,39 @@ bool module_prometheus_process_metrics_request(
                 { "network_active_connections", "%lu", worker_stats.network.active_connections },
                 { "network_accepted_tls_connections", "%lu", worker_stats.network.accepted_tls_connections },
                 { "network_active_tls_connections", "%lu", worker_stats.network.active_tls_connections },
+                { "network_output_buffers_size", "%lu", worker_stats.network.output_buffers_size },
+                { "network_output_buffers_size_max", "%lu", worker_stats.network.output_buffers_size_max },
+                { "network_output_buffers_limit_disconnections", "%lu",
+                  worker_stats.network.output_buffers_limit_disconnections },
+                { "network_buffers_size", "%lu", worker_stats.network.buffers_size },
+                { "network_tls_handshakes", "%lu", worker_stats.network.tls_handshakes },
+                { "network_tls_handshakes_failed", "%lu", worker_stats.network.tls_handshakes_failed },
+                { "network_tls_handshakes_duration_us", "%lu", worker_stats.network.tls_handshakes_duration_us },
+                { "network_tls_handshakes_duration_us_max", "%lu",
+                  worker_stats.network.tls_handshakes_duration_us_max },
+                { "network_tls_sessions_resumed", "%lu", worker_stats.network.tls_sessions_resumed },
+                { "network_migrated_connections", "%lu", worker_stats.network.migrated_connections },
                 { "storage_written_data", "%lu", worker_stats.storage.written_data },
                 { "storage_write_iops", "%lu", worker_stats.storage.write_iops },
                 { "storage_read_data", "%lu", worker_stats.storage.read_data },
                 { "storage_read_iops", "%lu", worker_stats.storage.read_iops },
                 { "storage_open_files", "%lu", worker_stats.storage.open_files },
+                { "iouring_syscalls", "%lu", worker_stats.iouring.syscalls },
+                { "iouring_completions", "%lu", worker_stats.iouring.completions },
+                { "blocking_blocked_clients", "%lu", worker_stats.blocking.blocked_clients },
+                { "blocking_served", "%lu", worker_stats.blocking.served },
+                { "blocking_timeouts", "%lu", worker_stats.blocking.timeouts },
+                { "blocking_push_to_pop_latency_us", "%lu", worker_stats.blocking.push_to_pop_latency_us },
+                { "blocking_push_to_pop_latency_us_max", "%lu", worker_stats.blocking.push_to_pop_latency_us_max },
+                { "pubsub_subscriptions", "%lu", worker_stats.pubsub.subscriptions },
+                { "pubsub_messages_published", "%lu", worker_stats.pubsub.messages_published },
+                { "pubsub_messages_delivered", "%lu", worker_stats.pubsub.messages_delivered },
+                { "pubsub_messages_dropped", "%lu", worker_stats.pubsub.messages_dropped },
+#if DEBUG == 1
+                { "debug_command_arena_commands", "%lu", worker_stats.debug.command_arena_commands },
+                { "debug_command_arena_allocations", "%lu", worker_stats.debug.command_arena_allocations },
+                { "debug_command_arena_allocations_max", "%lu", worker_stats.debug.command_arena_allocations_max },
+#endif
 
                 { NULL },
         };
@@ -784,12 +811,7 @@ void module_prometheus_connection_accept(
         }
 
         if (!exit_loop) {
-            if (network_buffer_needs_rewind(
-                    &module_prometheus_client.read_buffer,
-                    NETWORK_CHANNEL_MAX_PACKET_SIZE)) {
-                network_buffer_rewind(&module_prometheus_client.read_buffer);
-            }
-
+            // The read buffer is allocated, grown or rewound by network_receive as needed
             exit_loop = network_receive(
                     network_channel,
                     &module_prometheus_client.read_buffer,
@@ -0,0 +1,440 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "utils_string.h"
+#include "utils_bitmap.h"
+
+#include "module_redis_command_helper_bitmap.h"
+
+#define TAG "module_redis_command_helper_bitmap"
+
+bool module_redis_command_helper_bitmap_parse_int64(
+        char *value,
+        size_t value_length,
+        int64_t *number) {
+    bool invalid = false;
+
+    // utils_string_to_int64 accepts an empty string as 0
+    if (unlikely(value_length == 0)) {
+        return false;
+    }
+
+    *number = utils_string_to_int64(value, value_length, &invalid);
+
+    return !invalid;
+}
+
+bool module_redis_command_helper_bitmap_parse_bit_offset(
+        char *value,
+        size_t value_length,
+        uint64_t *bit_offset) {
+    int64_t number;
+
+    if (unlikely(!module_redis_command_helper_bitmap_parse_int64(value, value_length, &number))) {
+        return false;
+    }
+
+    if (unlikely(number < 0 || (uint64_t)number > MODULE_REDIS_COMMAND_HELPER_BITMAP_BIT_OFFSET_MAX)) {
+        return false;
+    }
+
+    *bit_offset = (uint64_t)number;
+
+    return true;
+}
+
+bool module_redis_command_helper_bitmap_parse_range_unit(
+        char *value,
+        size_t value_length,
+        bool *bit_unit) {
+    if (value_length == 3 && strncasecmp(value, "BIT", value_length) == 0) {
+        *bit_unit = true;
+    } else if (value_length == 4 && strncasecmp(value, "BYTE", value_length) == 0) {
+        *bit_unit = false;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_bitmap_normalize_range(
+        int64_t total_length,
+        int64_t *start,
+        int64_t *end) {
+    // As in Redis the negative indexes count from the end and the range is clamped to the length of the value
+    if (*start < 0) {
+        *start = total_length + *start;
+    }
+
+    if (*end < 0) {
+        *end = total_length + *end;
+    }
+
+    if (*start < 0) {
+        *start = 0;
+    }
+
+    if (*end < 0) {
+        *end = 0;
+    }
+
+    if (*end >= total_length) {
+        *end = total_length - 1;
+    }
+
+    return *start <= *end;
+}
+
+bool module_redis_command_helper_bitmap_read(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        uint64_t byte_offset,
+        uint8_t *buffer,
+        size_t length) {
+    size_t size = chunk_sequence ? chunk_sequence->size : 0;
+
+    // The bytes past the end of the value are read as zeros
+    while(length > 0 && byte_offset < size) {
+        // The chunk sequences are always allocated with chunks of the max size except the last one, the chunk
+        // containing an offset can be calculated directly
+        storage_db_chunk_index_t chunk_index = byte_offset / STORAGE_DB_CHUNK_MAX_SIZE;
+        size_t chunk_offset = byte_offset % STORAGE_DB_CHUNK_MAX_SIZE;
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+        size_t read_length = MIN(length, chunk_info->chunk_length - chunk_offset);
+
+        if (unlikely(!storage_db_chunk_read(db, chunk_info, (char*)buffer, (off_t)chunk_offset, read_length))) {
+            return false;
+        }
+
+        buffer += read_length;
+        byte_offset += read_length;
+        length -= read_length;
+    }
+
+    memset(buffer, 0, length);
+
+    return true;
+}
+
+bool module_redis_command_helper_bitmap_count(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        uint64_t start_byte_offset,
+        uint64_t end_byte_offset,
+        uint64_t *count) {
+    *count = 0;
+    end_byte_offset = MIN(end_byte_offset, chunk_sequence->size);
+
+    // The chunks are counted one by one directly from the storage, the value is never copied in a single buffer
+    while(start_byte_offset < end_byte_offset) {
+        bool allocated_new_buffer = false;
+        storage_db_chunk_index_t chunk_index = start_byte_offset / STORAGE_DB_CHUNK_MAX_SIZE;
+        size_t chunk_offset = start_byte_offset % STORAGE_DB_CHUNK_MAX_SIZE;
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+        size_t count_length = MIN(end_byte_offset - start_byte_offset, chunk_info->chunk_length - chunk_offset);
+
+        char *chunk_data = storage_db_get_chunk_data(db, chunk_info, &allocated_new_buffer);
+        if (unlikely(!chunk_data)) {
+            return false;
+        }
+
+        *count += utils_bitmap_popcount((uint8_t*)chunk_data + chunk_offset, count_length);
+
+        if (allocated_new_buffer) {
+            xalloc_free(chunk_data);
+        }
+
+        start_byte_offset += count_length;
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_bitmap_find(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        uint64_t start_byte_offset,
+        uint64_t end_byte_offset,
+        bool bit,
+        uint64_t *byte_offset) {
+    end_byte_offset = MIN(end_byte_offset, chunk_sequence->size);
+    *byte_offset = end_byte_offset;
+
+    while(start_byte_offset < end_byte_offset) {
+        bool allocated_new_buffer = false;
+        storage_db_chunk_index_t chunk_index = start_byte_offset / STORAGE_DB_CHUNK_MAX_SIZE;
+        size_t chunk_offset = start_byte_offset % STORAGE_DB_CHUNK_MAX_SIZE;
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+        size_t find_length = MIN(end_byte_offset - start_byte_offset, chunk_info->chunk_length - chunk_offset);
+
+        char *chunk_data = storage_db_get_chunk_data(db, chunk_info, &allocated_new_buffer);
+        if (unlikely(!chunk_data)) {
+            return false;
+        }
+
+        size_t found_offset = utils_bitmap_find_first_byte(
+                (uint8_t*)chunk_data + chunk_offset,
+                find_length,
+                bit);
+
+        if (allocated_new_buffer) {
+            xalloc_free(chunk_data);
+        }
+
+        if (found_offset < find_length) {
+            *byte_offset = start_byte_offset + found_offset;
+            break;
+        }
+
+        start_byte_offset += find_length;
+    }
+
+    return true;
+}
+
+static bool module_redis_command_helper_bitmap_grow_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t size) {
+    storage_db_chunk_index_t allocated_chunks_count = 0;
+    storage_db_chunk_index_t shared_chunks_count = chunk_sequence->count;
+    storage_db_chunk_sequence_t grown_chunk_sequence = { 0 };
+
+    // The full chunks are moved as they are to the grown sequence, only the last one, if partial, has to be replaced
+    if (shared_chunks_count > 0 &&
+        storage_db_chunk_sequence_get(chunk_sequence, shared_chunks_count - 1)->chunk_length <
+        STORAGE_DB_CHUNK_MAX_SIZE) {
+        shared_chunks_count--;
+    }
+
+    grown_chunk_sequence.size = size;
+    grown_chunk_sequence.count = storage_db_chunk_sequence_calculate_chunk_count(size);
+    grown_chunk_sequence.sequence = xalloc_alloc(sizeof(storage_db_chunk_info_t) * grown_chunk_sequence.count);
+
+    if (shared_chunks_count > 0) {
+        memcpy(
+                grown_chunk_sequence.sequence,
+                chunk_sequence->sequence,
+                sizeof(storage_db_chunk_info_t) * shared_chunks_count);
+    }
+
+    size_t remaining_length = size - ((size_t)shared_chunks_count * STORAGE_DB_CHUNK_MAX_SIZE);
+    for(
+            storage_db_chunk_index_t chunk_index = shared_chunks_count;
+            chunk_index < grown_chunk_sequence.count;
+            chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(&grown_chunk_sequence, chunk_index);
+        size_t chunk_length = MIN(remaining_length, STORAGE_DB_CHUNK_MAX_SIZE);
+        size_t copied_length = 0;
+
+        if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info, chunk_length))) {
+            for(storage_db_chunk_index_t index = 0; index < allocated_chunks_count; index++) {
+                storage_db_chunk_data_free(
+                        db,
+                        storage_db_chunk_sequence_get(&grown_chunk_sequence, shared_chunks_count + index));
+            }
+
+            xalloc_free(grown_chunk_sequence.sequence);
+            return false;
+        }
+
+        allocated_chunks_count++;
+
+        // Only the chunks in memory are changed in place, the data can be accessed directly
+        if (chunk_index < chunk_sequence->count) {
+            storage_db_chunk_info_t *source_chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+            copied_length = source_chunk_info->chunk_length;
+            memcpy(chunk_info->memory.chunk_data, source_chunk_info->memory.chunk_data, copied_length);
+        }
+
+        memset((char*)chunk_info->memory.chunk_data + copied_length, 0, chunk_length - copied_length);
+        remaining_length -= chunk_length;
+    }
+
+    for(
+            storage_db_chunk_index_t chunk_index = shared_chunks_count;
+            chunk_index < chunk_sequence->count;
+            chunk_index++) {
+        storage_db_chunk_data_free(db, storage_db_chunk_sequence_get(chunk_sequence, chunk_index));
+    }
+
+    if (chunk_sequence->sequence) {
+        xalloc_free(chunk_sequence->sequence);
+    }
+
+    *chunk_sequence = grown_chunk_sequence;
+
+    return true;
+}
+
+static bool module_redis_command_helper_bitmap_write_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t size,
+        module_redis_command_helper_bitmap_patch_t *patches,
+        uint32_t patches_count,
+        char **key) {
+    storage_db_chunk_sequence_t *chunk_sequence = &rmw_status->current_entry_index->value;
+    size_t previous_size = chunk_sequence->size;
+
+    assert(size >= previous_size);
+
+    if (size > previous_size && unlikely(!module_redis_command_helper_bitmap_grow_in_place(
+            db,
+            chunk_sequence,
+            size))) {
+        return false;
+    }
+
+    // Only the patched bytes are written, the patches are applied in order so the last one wins
+    for(uint32_t patch_index = 0; patch_index < patches_count; patch_index++) {
+        uint64_t byte_offset = patches[patch_index].byte_offset;
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(
+                chunk_sequence,
+                byte_offset / STORAGE_DB_CHUNK_MAX_SIZE);
+
+        if (unlikely(!storage_db_chunk_write(
+                db,
+                chunk_info,
+                (off_t)(byte_offset % STORAGE_DB_CHUNK_MAX_SIZE),
+                (char*)&patches[patch_index].value,
+                1))) {
+            return false;
+        }
+    }
+
+    if (unlikely(!storage_db_op_rmw_commit_update_in_place(db, rmw_status, previous_size))) {
+        return false;
+    }
+
+    // The ownership of the key is taken by the hashtable when the entry is updated
+    *key = NULL;
+
+    return true;
+}
+
+bool module_redis_command_helper_bitmap_write(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_chunk_sequence_t *source_chunk_sequence,
+        size_t size,
+        module_redis_command_helper_bitmap_patch_t *patches,
+        uint32_t patches_count,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key) {
+    bool return_res = false;
+    uint64_t chunk_byte_offset = 0;
+    uint8_t *buffer = NULL;
+    storage_db_chunk_sequence_t chunk_sequence = { 0 };
+
+    // If no one else is reading the entry only the patched bytes are written, the caller holds a reader on it
+    if (source_chunk_sequence &&
+        storage_db_op_rmw_current_entry_index_can_be_updated_in_place(db, rmw_status, 1)) {
+        return module_redis_command_helper_bitmap_write_in_place(
+                db,
+                rmw_status,
+                size,
+                patches,
+                patches_count,
+                key);
+    }
+
+    // Otherwise the entry can't be changed in place as it might be being read by other connections or by the snapshot,
+    // a new value is built chunk by chunk copying the current one, applying the patches and padding it with zeros
+    if (unlikely(!storage_db_chunk_sequence_allocate(db, &chunk_sequence, size))) {
+        goto end;
+    }
+
+    buffer = xalloc_alloc(STORAGE_DB_CHUNK_MAX_SIZE);
+
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence.count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(&chunk_sequence, chunk_index);
+
+        if (unlikely(!module_redis_command_helper_bitmap_read(
+                db,
+                source_chunk_sequence,
+                chunk_byte_offset,
+                buffer,
+                chunk_info->chunk_length))) {
+            goto end;
+        }
+
+        // The patches are applied in order, if a byte is patched more than once the last patch wins
+        for(uint32_t patch_index = 0; patch_index < patches_count; patch_index++) {
+            if (patches[patch_index].byte_offset >= chunk_byte_offset &&
+                patches[patch_index].byte_offset < chunk_byte_offset + chunk_info->chunk_length) {
+                buffer[patches[patch_index].byte_offset - chunk_byte_offset] = patches[patch_index].value;
+            }
+        }
+
+        if (unlikely(!storage_db_chunk_write(db, chunk_info, 0, (char*)buffer, chunk_info->chunk_length))) {
+            goto end;
+        }
+
+        chunk_byte_offset += chunk_info->chunk_length;
+    }
+
+    if (unlikely(!storage_db_op_rmw_commit_update(
+            db,
+            rmw_status,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+            &chunk_sequence,
+            expiry_time_ms))) {
+        goto end;
+    }
+
+    // The ownership of the key and of the chunks is taken by the hashtable when the entry is updated
+    *key = NULL;
+    chunk_sequence.sequence = NULL;
+    return_res = true;
+
+end:
+
+    if (buffer) {
+        xalloc_free(buffer);
+    }
+
+    if (unlikely(chunk_sequence.sequence)) {
+        storage_db_chunk_sequence_free_chunks(db, &chunk_sequence);
+    }
+
+    return return_res;
+}
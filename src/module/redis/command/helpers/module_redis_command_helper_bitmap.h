@@ -0,0 +1,73 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_BITMAP_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_BITMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// As in Redis the bitmaps are limited to 512MB, the max offset of a bit is 2^32 - 1
+#define MODULE_REDIS_COMMAND_HELPER_BITMAP_BIT_OFFSET_MAX   ((uint64_t)UINT32_MAX)
+
+typedef struct module_redis_command_helper_bitmap_patch module_redis_command_helper_bitmap_patch_t;
+struct module_redis_command_helper_bitmap_patch {
+    uint64_t byte_offset;
+    uint8_t value;
+};
+
+bool module_redis_command_helper_bitmap_parse_int64(
+        char *value,
+        size_t value_length,
+        int64_t *number);
+
+bool module_redis_command_helper_bitmap_parse_bit_offset(
+        char *value,
+        size_t value_length,
+        uint64_t *bit_offset);
+
+bool module_redis_command_helper_bitmap_parse_range_unit(
+        char *value,
+        size_t value_length,
+        bool *bit_unit);
+
+bool module_redis_command_helper_bitmap_normalize_range(
+        int64_t total_length,
+        int64_t *start,
+        int64_t *end);
+
+bool module_redis_command_helper_bitmap_read(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        uint64_t byte_offset,
+        uint8_t *buffer,
+        size_t length);
+
+bool module_redis_command_helper_bitmap_count(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        uint64_t start_byte_offset,
+        uint64_t end_byte_offset,
+        uint64_t *count);
+
+bool module_redis_command_helper_bitmap_find(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        uint64_t start_byte_offset,
+        uint64_t end_byte_offset,
+        bool bit,
+        uint64_t *byte_offset);
+
+bool module_redis_command_helper_bitmap_write(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_chunk_sequence_t *source_chunk_sequence,
+        size_t size,
+        module_redis_command_helper_bitmap_patch_t *patches,
+        uint32_t patches_count,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_BITMAP_H
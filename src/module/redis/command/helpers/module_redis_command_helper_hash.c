@@ -0,0 +1,657 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_command_helper_value_type.h"
+#include "module_redis_command_helper_hash.h"
+
+#define TAG "module_redis_command_helper_hash"
+
+char *module_redis_command_helper_hash_read(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        packed_hash_t *packed_hash,
+        bool *allocated_new_buffer) {
+    assert(entry_index->value_type == STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET);
+
+    char *buffer = storage_db_chunk_sequence_read_all(
+            db,
+            &entry_index->value,
+            allocated_new_buffer);
+
+    if (unlikely(buffer == NULL)) {
+        return NULL;
+    }
+
+    if (unlikely(!packed_hash_init(packed_hash, buffer, entry_index->value.size))) {
+        LOG_E(TAG, "The hash is corrupted, unable to read it");
+
+        if (*allocated_new_buffer) {
+            xalloc_free(buffer);
+            *allocated_new_buffer = false;
+        }
+
+        return NULL;
+    }
+
+    return buffer;
+}
+
+bool module_redis_command_helper_hash_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        packed_hash_builder_t *builder,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key) {
+    bool return_res;
+
+    // An empty hash is never stored, as in Redis the key is dropped when the last field is deleted
+    if (packed_hash_builder_count(builder) == 0) {
+        storage_db_op_rmw_commit_delete(db, rmw_status);
+        return true;
+    }
+
+    size_t buffer_length = packed_hash_builder_serialized_length(builder);
+    if (unlikely(buffer_length == 0)) {
+        LOG_E(TAG, "The hash is too large to be serialized");
+        return false;
+    }
+
+    char *buffer = xalloc_alloc(buffer_length);
+    packed_hash_builder_serialize(builder, buffer, buffer_length);
+
+    return_res = module_redis_command_helper_value_type_commit(
+            db,
+            rmw_status,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET,
+            buffer,
+            buffer_length,
+            expiry_time_ms,
+            key);
+
+    xalloc_free(buffer);
+
+    return return_res;
+}
+
+// The position of a field in a packed hash using the table encoding changed in place, the offsets of the entry and of
+// the value are relative to the beginning of the entries
+typedef struct module_redis_command_helper_hash_slot module_redis_command_helper_hash_slot_t;
+struct module_redis_command_helper_hash_slot {
+    bool found;
+    uint32_t bucket_index;
+    uint32_t free_bucket_index;
+    bool free_bucket_deleted;
+    size_t entry_offset;
+    size_t entry_length;
+    size_t value_offset;
+    size_t value_length;
+};
+
+static bool module_redis_command_helper_hash_header_read_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t packed_hash_offset,
+        packed_hash_header_t *header) {
+    if (unlikely(chunk_sequence->size < packed_hash_offset + sizeof(packed_hash_header_t))) {
+        return false;
+    }
+
+    return storage_db_chunk_sequence_read(
+            db,
+            chunk_sequence,
+            (char*)header,
+            packed_hash_offset,
+            sizeof(packed_hash_header_t));
+}
+
+static inline size_t module_redis_command_helper_hash_buckets_offset(
+        size_t packed_hash_offset) {
+    return packed_hash_offset + sizeof(packed_hash_header_t);
+}
+
+static inline size_t module_redis_command_helper_hash_entries_offset(
+        size_t packed_hash_offset,
+        packed_hash_header_t *header) {
+    return module_redis_command_helper_hash_buckets_offset(packed_hash_offset) +
+        ((size_t)header->buckets_count * sizeof(uint32_t));
+}
+
+static bool module_redis_command_helper_hash_entry_match_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t entries_offset,
+        packed_hash_header_t *header,
+        size_t entry_offset,
+        char *field,
+        size_t field_length,
+        bool *matches,
+        module_redis_command_helper_hash_slot_t *slot) {
+    char varint_buffer[PACKED_HASH_VARINT_MAX_LENGTH];
+    char compare_buffer[256];
+    size_t varint_buffer_length, varint_offset = 0, entry_field_length, entry_value_length;
+    bool deleted;
+
+    *matches = false;
+
+    if (unlikely(entry_offset >= header->entries_length)) {
+        return false;
+    }
+
+    varint_buffer_length = MIN(sizeof(varint_buffer), header->entries_length - entry_offset);
+    if (unlikely(!storage_db_chunk_sequence_read(
+            db,
+            chunk_sequence,
+            varint_buffer,
+            entries_offset + entry_offset,
+            varint_buffer_length))) {
+        return false;
+    }
+
+    // The buckets never point to a deleted entry
+    if (unlikely(!packed_hash_entry_field_length_read(
+            varint_buffer,
+            varint_buffer_length,
+            &varint_offset,
+            &entry_field_length,
+            &deleted) || deleted)) {
+        return false;
+    }
+
+    if (entry_field_length != field_length) {
+        return true;
+    }
+
+    size_t field_offset = entry_offset + varint_offset;
+    if (unlikely(field_length > header->entries_length - field_offset)) {
+        return false;
+    }
+
+    // The field is compared in slices as it might be spread across different chunks
+    for(size_t compared_length = 0; compared_length < field_length;) {
+        size_t compare_length = MIN(sizeof(compare_buffer), field_length - compared_length);
+
+        if (unlikely(!storage_db_chunk_sequence_read(
+                db,
+                chunk_sequence,
+                compare_buffer,
+                entries_offset + field_offset + compared_length,
+                compare_length))) {
+            return false;
+        }
+
+        if (memcmp(compare_buffer, field + compared_length, compare_length) != 0) {
+            return true;
+        }
+
+        compared_length += compare_length;
+    }
+
+    size_t value_length_offset = field_offset + field_length;
+    if (unlikely(value_length_offset >= header->entries_length)) {
+        return false;
+    }
+
+    varint_offset = 0;
+    varint_buffer_length = MIN(sizeof(varint_buffer), header->entries_length - value_length_offset);
+    if (unlikely(!storage_db_chunk_sequence_read(
+            db,
+            chunk_sequence,
+            varint_buffer,
+            entries_offset + value_length_offset,
+            varint_buffer_length))) {
+        return false;
+    }
+
+    if (unlikely(!packed_hash_entry_value_length_read(
+            varint_buffer,
+            varint_buffer_length,
+            &varint_offset,
+            &entry_value_length))) {
+        return false;
+    }
+
+    if (unlikely(entry_value_length > header->entries_length - (value_length_offset + varint_offset))) {
+        return false;
+    }
+
+    *matches = true;
+    slot->entry_offset = entry_offset;
+    slot->value_offset = value_length_offset + varint_offset;
+    slot->value_length = entry_value_length;
+    slot->entry_length = slot->value_offset + entry_value_length - entry_offset;
+
+    return true;
+}
+
+static bool module_redis_command_helper_hash_find_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t packed_hash_offset,
+        packed_hash_header_t *header,
+        char *field,
+        size_t field_length,
+        module_redis_command_helper_hash_slot_t *slot) {
+    uint32_t buckets_mask = header->buckets_count - 1;
+    uint32_t bucket_index = packed_hash_field_hash(field, field_length) & buckets_mask;
+    size_t buckets_offset = module_redis_command_helper_hash_buckets_offset(packed_hash_offset);
+    size_t entries_offset = module_redis_command_helper_hash_entries_offset(packed_hash_offset, header);
+
+    slot->found = false;
+    slot->free_bucket_index = UINT32_MAX;
+    slot->free_bucket_deleted = false;
+
+    for(uint32_t probes = 0; probes < header->buckets_count; probes++) {
+        uint32_t bucket;
+        bool matches;
+
+        if (unlikely(!storage_db_chunk_sequence_read(
+                db,
+                chunk_sequence,
+                (char*)&bucket,
+                buckets_offset + ((size_t)bucket_index * sizeof(uint32_t)),
+                sizeof(bucket)))) {
+            return false;
+        }
+
+        if (bucket == PACKED_HASH_BUCKET_EMPTY) {
+            if (slot->free_bucket_index == UINT32_MAX) {
+                slot->free_bucket_index = bucket_index;
+            }
+
+            return true;
+        }
+
+        // The first bucket of a deleted field found is reused if the field is not part of the hash
+        if (bucket == PACKED_HASH_BUCKET_DELETED) {
+            if (slot->free_bucket_index == UINT32_MAX) {
+                slot->free_bucket_index = bucket_index;
+                slot->free_bucket_deleted = true;
+            }
+        } else {
+            if (unlikely(!module_redis_command_helper_hash_entry_match_in_place(
+                    db,
+                    chunk_sequence,
+                    entries_offset,
+                    header,
+                    bucket - 1,
+                    field,
+                    field_length,
+                    &matches,
+                    slot))) {
+                return false;
+            }
+
+            if (matches) {
+                slot->found = true;
+                slot->bucket_index = bucket_index;
+                return true;
+            }
+        }
+
+        bucket_index = (bucket_index + 1) & buckets_mask;
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_hash_can_update_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t packed_hash_offset,
+        uint32_t new_fields_count,
+        size_t new_entries_length) {
+    packed_hash_header_t header;
+
+    if (!storage_db_op_rmw_current_entry_index_can_be_updated_in_place(db, rmw_status, 0)) {
+        return false;
+    }
+
+    storage_db_chunk_sequence_t *chunk_sequence = &rmw_status->current_entry_index->value;
+    if (unlikely(!module_redis_command_helper_hash_header_read_in_place(
+            db,
+            chunk_sequence,
+            packed_hash_offset,
+            &header))) {
+        return false;
+    }
+
+    // The compact encoding is small enough to be rebuilt every time, the table encoding is rebuilt only once there is no
+    // room left for the new fields or once the deleted entries take up too much space so the cost of rebuilding it is
+    // spread over the changes applied in place
+    return header.encoding == PACKED_HASH_ENCODING_TABLE &&
+        !packed_hash_header_needs_compaction(&header) &&
+        packed_hash_header_table_has_room(&header, new_fields_count) &&
+        (uint64_t)header.entries_length + new_entries_length < UINT32_MAX &&
+        storage_db_chunk_sequence_calculate_chunk_count(chunk_sequence->size + new_entries_length) <= UINT16_MAX;
+}
+
+bool module_redis_command_helper_hash_get_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t packed_hash_offset,
+        char *field,
+        size_t field_length,
+        char **value,
+        size_t *value_length,
+        bool *found) {
+    packed_hash_header_t header;
+    module_redis_command_helper_hash_slot_t slot;
+
+    *found = false;
+
+    if (unlikely(!module_redis_command_helper_hash_header_read_in_place(
+            db,
+            chunk_sequence,
+            packed_hash_offset,
+            &header))) {
+        return false;
+    }
+
+    if (unlikely(!module_redis_command_helper_hash_find_in_place(
+            db,
+            chunk_sequence,
+            packed_hash_offset,
+            &header,
+            field,
+            field_length,
+            &slot))) {
+        return false;
+    }
+
+    if (!slot.found) {
+        return true;
+    }
+
+    *value = xalloc_alloc(slot.value_length + 1);
+    if (unlikely(!storage_db_chunk_sequence_read(
+            db,
+            chunk_sequence,
+            *value,
+            module_redis_command_helper_hash_entries_offset(packed_hash_offset, &header) + slot.value_offset,
+            slot.value_length))) {
+        xalloc_free(*value);
+        *value = NULL;
+        return false;
+    }
+
+    *value_length = slot.value_length;
+    *found = true;
+
+    return true;
+}
+
+bool module_redis_command_helper_hash_set_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t packed_hash_offset,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length,
+        bool *added) {
+    packed_hash_header_t header;
+    module_redis_command_helper_hash_slot_t slot;
+    uint32_t bucket;
+    bool res;
+
+    if (unlikely(!module_redis_command_helper_hash_header_read_in_place(
+            db,
+            chunk_sequence,
+            packed_hash_offset,
+            &header))) {
+        return false;
+    }
+
+    size_t buckets_offset = module_redis_command_helper_hash_buckets_offset(packed_hash_offset);
+    size_t entries_offset = module_redis_command_helper_hash_entries_offset(packed_hash_offset, &header);
+
+    if (unlikely(!module_redis_command_helper_hash_find_in_place(
+            db,
+            chunk_sequence,
+            packed_hash_offset,
+            &header,
+            field,
+            field_length,
+            &slot))) {
+        return false;
+    }
+
+    *added = !slot.found;
+
+    // If the length of the value doesn't change only the value is overwritten
+    if (slot.found && slot.value_length == value_length) {
+        return storage_db_chunk_sequence_write(
+                db,
+                chunk_sequence,
+                entries_offset + slot.value_offset,
+                value,
+                value_length);
+    }
+
+    // The caller is expected to have checked that there is room for the new fields
+    if (unlikely(!slot.found && slot.free_bucket_index == UINT32_MAX)) {
+        return false;
+    }
+
+    // The entries are at the end of the packed hash, the new entry is appended after the others
+    assert(entries_offset + header.entries_length == chunk_sequence->size);
+
+    size_t entry_length = packed_hash_entry_length(field_length, value_length);
+    char *entry = xalloc_alloc(entry_length);
+    packed_hash_entry_write(entry, field, field_length, value, value_length);
+    res = storage_db_chunk_sequence_append_in_place(db, chunk_sequence, entry, entry_length);
+    xalloc_free(entry);
+
+    if (unlikely(!res)) {
+        return false;
+    }
+
+    bucket = header.entries_length + 1;
+    header.entries_length += entry_length;
+
+    if (slot.found) {
+        // The previous entry is flagged as deleted and the bucket is updated to point to the new one
+        char entry_first_byte;
+        if (unlikely(!storage_db_chunk_sequence_read(
+                db,
+                chunk_sequence,
+                &entry_first_byte,
+                entries_offset + slot.entry_offset,
+                1))) {
+            return false;
+        }
+
+        packed_hash_entry_mark_deleted(&entry_first_byte);
+        if (unlikely(!storage_db_chunk_sequence_write(
+                db,
+                chunk_sequence,
+                entries_offset + slot.entry_offset,
+                &entry_first_byte,
+                1))) {
+            return false;
+        }
+
+        header.deleted_entries_length += slot.entry_length;
+    } else {
+        slot.bucket_index = slot.free_bucket_index;
+
+        if (slot.free_bucket_deleted) {
+            header.deleted_buckets_count--;
+        }
+
+        header.count++;
+    }
+
+    if (unlikely(!storage_db_chunk_sequence_write(
+            db,
+            chunk_sequence,
+            buckets_offset + ((size_t)slot.bucket_index * sizeof(uint32_t)),
+            (char*)&bucket,
+            sizeof(bucket)))) {
+        return false;
+    }
+
+    return storage_db_chunk_sequence_write(
+            db,
+            chunk_sequence,
+            packed_hash_offset,
+            (char*)&header,
+            sizeof(header));
+}
+
+bool module_redis_command_helper_hash_delete_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t packed_hash_offset,
+        char *field,
+        size_t field_length,
+        bool *deleted) {
+    packed_hash_header_t header;
+    module_redis_command_helper_hash_slot_t slot;
+    uint32_t bucket = PACKED_HASH_BUCKET_DELETED;
+    char entry_first_byte;
+
+    *deleted = false;
+
+    if (unlikely(!module_redis_command_helper_hash_header_read_in_place(
+            db,
+            chunk_sequence,
+            packed_hash_offset,
+            &header))) {
+        return false;
+    }
+
+    size_t buckets_offset = module_redis_command_helper_hash_buckets_offset(packed_hash_offset);
+    size_t entries_offset = module_redis_command_helper_hash_entries_offset(packed_hash_offset, &header);
+
+    if (unlikely(!module_redis_command_helper_hash_find_in_place(
+            db,
+            chunk_sequence,
+            packed_hash_offset,
+            &header,
+            field,
+            field_length,
+            &slot))) {
+        return false;
+    }
+
+    if (!slot.found) {
+        return true;
+    }
+
+    // The entry is only flagged as deleted and its bucket is kept as part of the probing chains
+    if (unlikely(!storage_db_chunk_sequence_read(
+            db,
+            chunk_sequence,
+            &entry_first_byte,
+            entries_offset + slot.entry_offset,
+            1))) {
+        return false;
+    }
+
+    packed_hash_entry_mark_deleted(&entry_first_byte);
+    if (unlikely(!storage_db_chunk_sequence_write(
+            db,
+            chunk_sequence,
+            entries_offset + slot.entry_offset,
+            &entry_first_byte,
+            1))) {
+        return false;
+    }
+
+    if (unlikely(!storage_db_chunk_sequence_write(
+            db,
+            chunk_sequence,
+            buckets_offset + ((size_t)slot.bucket_index * sizeof(uint32_t)),
+            (char*)&bucket,
+            sizeof(bucket)))) {
+        return false;
+    }
+
+    header.count--;
+    header.deleted_buckets_count++;
+    header.deleted_entries_length += slot.entry_length;
+
+    if (unlikely(!storage_db_chunk_sequence_write(
+            db,
+            chunk_sequence,
+            packed_hash_offset,
+            (char*)&header,
+            sizeof(header)))) {
+        return false;
+    }
+
+    *deleted = true;
+
+    return true;
+}
+
+bool module_redis_command_helper_hash_commit_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t packed_hash_offset,
+        size_t previous_value_size,
+        char **key) {
+    packed_hash_header_t header;
+
+    if (unlikely(!module_redis_command_helper_hash_header_read_in_place(
+            db,
+            &rmw_status->current_entry_index->value,
+            packed_hash_offset,
+            &header))) {
+        return false;
+    }
+
+    // As in Redis the key is dropped when the last field is deleted
+    if (header.count == 0) {
+        storage_db_op_rmw_commit_delete(db, rmw_status);
+        return true;
+    }
+
+    if (unlikely(!storage_db_op_rmw_commit_update_in_place(db, rmw_status, previous_value_size))) {
+        return false;
+    }
+
+    // The ownership of the key is taken by the hashtable when the entry is updated
+    *key = NULL;
+
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_HASH_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_HASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char *module_redis_command_helper_hash_read(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        packed_hash_t *packed_hash,
+        bool *allocated_new_buffer);
+
+bool module_redis_command_helper_hash_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        packed_hash_builder_t *builder,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key);
+
+bool module_redis_command_helper_hash_can_update_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t packed_hash_offset,
+        uint32_t new_fields_count,
+        size_t new_entries_length);
+
+bool module_redis_command_helper_hash_get_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t packed_hash_offset,
+        char *field,
+        size_t field_length,
+        char **value,
+        size_t *value_length,
+        bool *found);
+
+bool module_redis_command_helper_hash_set_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t packed_hash_offset,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length,
+        bool *added);
+
+bool module_redis_command_helper_hash_delete_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t packed_hash_offset,
+        char *field,
+        size_t field_length,
+        bool *deleted);
+
+bool module_redis_command_helper_hash_commit_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t packed_hash_offset,
+        size_t previous_value_size,
+        char **key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_HASH_H
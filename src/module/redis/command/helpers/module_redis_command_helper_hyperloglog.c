@@ -0,0 +1,168 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/hyperloglog/hyperloglog.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_command_helper_value_type.h"
+#include "module_redis_command_helper_hyperloglog.h"
+
+#define TAG "module_redis_command_helper_hyperloglog"
+
+module_redis_command_helper_hyperloglog_result_t module_redis_command_helper_hyperloglog_read(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        char **buffer,
+        bool *allocated_new_buffer,
+        hyperloglog_encoding_t *encoding) {
+    if (entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING) {
+        return MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_WRONGTYPE;
+    }
+
+    // The HyperLogLogs are plain strings, the length is checked upfront to avoid reading long strings just to find
+    // out that they are not HyperLogLogs
+    if (entry_index->value.size < HYPERLOGLOG_HEADER_LENGTH ||
+        entry_index->value.size > MAX(HYPERLOGLOG_DENSE_LENGTH, HYPERLOGLOG_SPARSE_LENGTH_LIMIT)) {
+        return MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_INVALID;
+    }
+
+    *buffer = storage_db_chunk_sequence_read_all(
+            db,
+            &entry_index->value,
+            allocated_new_buffer);
+
+    if (unlikely(*buffer == NULL)) {
+        return MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_FAILED;
+    }
+
+    if (!hyperloglog_validate(*buffer, entry_index->value.size, encoding)) {
+        if (*allocated_new_buffer) {
+            xalloc_free(*buffer);
+            *allocated_new_buffer = false;
+        }
+
+        *buffer = NULL;
+        return MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_INVALID;
+    }
+
+    return MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK;
+}
+
+module_redis_command_helper_hyperloglog_result_t module_redis_command_helper_hyperloglog_merge(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        uint8_t *registers,
+        hyperloglog_encoding_t *encoding) {
+    char *buffer = NULL;
+    bool allocated_new_buffer = false;
+    module_redis_command_helper_hyperloglog_result_t result;
+
+    result = module_redis_command_helper_hyperloglog_read(
+            db,
+            entry_index,
+            &buffer,
+            &allocated_new_buffer,
+            encoding);
+
+    if (result != MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK) {
+        return result;
+    }
+
+    if (unlikely(!hyperloglog_merge(registers, buffer, entry_index->value.size))) {
+        result = MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_CORRUPTED;
+    }
+
+    if (allocated_new_buffer) {
+        xalloc_free(buffer);
+    }
+
+    return result;
+}
+
+bool module_redis_command_helper_hyperloglog_send_error(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_helper_hyperloglog_result_t result,
+        char *command_name) {
+    switch(result) {
+        case MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_WRONGTYPE:
+            return module_redis_command_helper_value_type_error_wrongtype(connection_context);
+
+        case MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_INVALID:
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "WRONGTYPE Key is not a valid HyperLogLog string value.");
+
+        case MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_CORRUPTED:
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "INVALIDOBJ Corrupted HLL object detected");
+
+        default:
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR %s failed",
+                    command_name);
+    }
+}
+
+bool module_redis_command_helper_hyperloglog_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        uint8_t *registers,
+        hyperloglog_encoding_t encoding,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key) {
+    bool return_res;
+    char *buffer = xalloc_alloc(HYPERLOGLOG_DENSE_LENGTH);
+
+    // The cardinality is calculated and cached while serializing, so PFCOUNT never has to update the value
+    size_t buffer_length = hyperloglog_serialize(registers, encoding, buffer);
+
+    return_res = module_redis_command_helper_value_type_commit(
+            db,
+            rmw_status,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+            buffer,
+            buffer_length,
+            expiry_time_ms,
+            key);
+
+    xalloc_free(buffer);
+
+    return return_res;
+}
@@ -0,0 +1,47 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum module_redis_command_helper_hyperloglog_result {
+    MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK,
+    MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_WRONGTYPE,
+    MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_INVALID,
+    MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_CORRUPTED,
+    MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_FAILED,
+};
+typedef enum module_redis_command_helper_hyperloglog_result module_redis_command_helper_hyperloglog_result_t;
+
+module_redis_command_helper_hyperloglog_result_t module_redis_command_helper_hyperloglog_read(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        char **buffer,
+        bool *allocated_new_buffer,
+        hyperloglog_encoding_t *encoding);
+
+module_redis_command_helper_hyperloglog_result_t module_redis_command_helper_hyperloglog_merge(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        uint8_t *registers,
+        hyperloglog_encoding_t *encoding);
+
+bool module_redis_command_helper_hyperloglog_send_error(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_helper_hyperloglog_result_t result,
+        char *command_name);
+
+bool module_redis_command_helper_hyperloglog_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        uint8_t *registers,
+        hyperloglog_encoding_t encoding,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_H
@@ -38,6 +38,7 @@
 #include "storage/db/storage_db.h"
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #include "module_redis_command_helper_incr_decr.h"
 
@@ -78,6 +79,12 @@ bool module_redis_command_helper_incr_decr(
         goto end;
     }
 
+    if (unlikely(current_entry_index &&
+            current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
     if (likely(current_entry_index)) {
         expiry_time_ms = current_entry_index->expiry_time_ms;
 
@@ -231,6 +238,12 @@ bool module_redis_command_helper_incr_decr_float(
         goto end;
     }
 
+    if (unlikely(current_entry_index &&
+            current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
     if (likely(current_entry_index)) {
         expiry_time_ms = current_entry_index->expiry_time_ms;
 
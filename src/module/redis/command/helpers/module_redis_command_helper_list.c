@@ -0,0 +1,1240 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "xalloc_arena.h"
+#include "fiber/fiber.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_list/packed_list.h"
+#include "data_structures/timer_wheel/timer_wheel.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/module_redis_blocking.h"
+
+#include "module_redis_command_helper_value_type.h"
+#include "module_redis_command_helper_long_string.h"
+#include "module_redis_command_helper_list.h"
+
+#define TAG "module_redis_command_helper_list"
+
+char *module_redis_command_helper_list_read(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        packed_list_t *packed_list,
+        bool *allocated_new_buffer) {
+    assert(entry_index->value_type == STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST);
+
+    char *buffer = storage_db_chunk_sequence_read_all(
+            db,
+            &entry_index->value,
+            allocated_new_buffer);
+
+    if (unlikely(buffer == NULL)) {
+        return NULL;
+    }
+
+    if (unlikely(!packed_list_init(packed_list, buffer, entry_index->value.size))) {
+        LOG_E(TAG, "The list is corrupted, unable to read it");
+
+        if (*allocated_new_buffer) {
+            xalloc_free(buffer);
+            *allocated_new_buffer = false;
+        }
+
+        return NULL;
+    }
+
+    return buffer;
+}
+
+// The lists not fitting in a single chunk are stored with the header of the list in the first chunk and then one node
+// per chunk, the chunks read in sequence are still the serialized packed list so the readers don't need to care but
+// the nodes at the edges can be replaced on their own when pushing and popping
+static bool module_redis_command_helper_list_is_stored_by_node(
+        storage_db_chunk_sequence_t *chunk_sequence) {
+    return chunk_sequence->count > 1 &&
+        storage_db_chunk_sequence_get(chunk_sequence, 0)->chunk_length == sizeof(packed_list_header_t);
+}
+
+static bool module_redis_command_helper_list_node_fits_in_chunk(
+        size_t node_length) {
+    return sizeof(packed_list_node_header_t) + node_length <= STORAGE_DB_CHUNK_MAX_SIZE;
+}
+
+static bool module_redis_command_helper_list_chunk_sequence_allocate_by_node(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *buffer,
+        size_t buffer_length) {
+    packed_list_header_t *header = (packed_list_header_t*)buffer;
+    storage_db_chunk_index_t allocated_chunks_count = 0;
+    size_t offset = sizeof(packed_list_header_t);
+
+    // If a node doesn't fit in a chunk, or there are more nodes than chunks, the list is stored as any other value
+    if (header->nodes_count >= UINT16_MAX) {
+        return false;
+    }
+
+    for(uint32_t node_index = 0; node_index < header->nodes_count; node_index++) {
+        packed_list_node_header_t *node_header = (packed_list_node_header_t*)(buffer + offset);
+        if (!module_redis_command_helper_list_node_fits_in_chunk(node_header->length)) {
+            return false;
+        }
+
+        offset += sizeof(packed_list_node_header_t) + node_header->length;
+    }
+
+    chunk_sequence->size = buffer_length;
+    chunk_sequence->count = header->nodes_count + 1;
+    chunk_sequence->sequence = xalloc_alloc(sizeof(storage_db_chunk_info_t) * chunk_sequence->count);
+
+    offset = 0;
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+        size_t chunk_length = chunk_index == 0
+                ? sizeof(packed_list_header_t)
+                : sizeof(packed_list_node_header_t) +
+                    ((packed_list_node_header_t*)(buffer + offset))->length;
+
+        if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info, chunk_length))) {
+            goto fail;
+        }
+
+        allocated_chunks_count++;
+
+        if (unlikely(!storage_db_chunk_write(db, chunk_info, 0, buffer + offset, chunk_length))) {
+            goto fail;
+        }
+
+        offset += chunk_length;
+    }
+
+    return true;
+
+fail:
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < allocated_chunks_count; chunk_index++) {
+        storage_db_chunk_data_free(db, storage_db_chunk_sequence_get(chunk_sequence, chunk_index));
+    }
+
+    xalloc_free(chunk_sequence->sequence);
+    chunk_sequence->sequence = NULL;
+    chunk_sequence->count = 0;
+    chunk_sequence->size = 0;
+
+    return false;
+}
+
+static bool module_redis_command_helper_list_can_update_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_entry_index_t *entry_index) {
+    return entry_index != NULL &&
+        module_redis_command_helper_list_is_stored_by_node(&entry_index->value) &&
+        storage_db_op_rmw_current_entry_index_can_be_updated_in_place(db, rmw_status, 0);
+}
+
+static bool module_redis_command_helper_list_push_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        bool head,
+        char *value,
+        size_t value_length) {
+    // Only the chunks in memory are changed in place, the data can be accessed directly
+    packed_list_header_t *header = storage_db_chunk_sequence_get(chunk_sequence, 0)->memory.chunk_data;
+    size_t entry_length = packed_list_node_entry_length(value_length);
+    storage_db_chunk_index_t node_chunk_index = head ? 1 : chunk_sequence->count - 1;
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, node_chunk_index);
+
+    if (packed_list_node_has_room(chunk_info->memory.chunk_data, value_length) &&
+        module_redis_command_helper_list_node_fits_in_chunk(
+                ((packed_list_node_header_t*)chunk_info->memory.chunk_data)->length + entry_length)) {
+        chunk_info->memory.chunk_data = xalloc_realloc(
+                chunk_info->memory.chunk_data,
+                chunk_info->chunk_length + entry_length);
+    } else {
+        // A new node is added at the edge, the nodes in between are not touched
+        storage_db_chunk_info_t new_chunk_info = { 0 };
+        if (unlikely(!storage_db_chunk_data_pre_allocate(
+                db,
+                &new_chunk_info,
+                sizeof(packed_list_node_header_t) + entry_length))) {
+            return false;
+        }
+
+        new_chunk_info.chunk_length = sizeof(packed_list_node_header_t);
+        packed_list_node_init(new_chunk_info.memory.chunk_data);
+
+        chunk_sequence->sequence = xalloc_realloc(
+                chunk_sequence->sequence,
+                sizeof(storage_db_chunk_info_t) * (chunk_sequence->count + 1));
+
+        node_chunk_index = head ? 1 : chunk_sequence->count;
+        memmove(
+                &chunk_sequence->sequence[node_chunk_index + 1],
+                &chunk_sequence->sequence[node_chunk_index],
+                sizeof(storage_db_chunk_info_t) * (chunk_sequence->count - node_chunk_index));
+        chunk_sequence->sequence[node_chunk_index] = new_chunk_info;
+        chunk_sequence->count++;
+        chunk_sequence->size += sizeof(packed_list_node_header_t);
+
+        // The sequence might have been moved
+        header = storage_db_chunk_sequence_get(chunk_sequence, 0)->memory.chunk_data;
+        header->nodes_count++;
+        header->nodes_length += sizeof(packed_list_node_header_t);
+
+        chunk_info = storage_db_chunk_sequence_get(chunk_sequence, node_chunk_index);
+    }
+
+    packed_list_node_push(chunk_info->memory.chunk_data, head, value, value_length);
+    chunk_info->chunk_length += entry_length;
+
+    header->count++;
+    header->nodes_length += entry_length;
+    chunk_sequence->size += entry_length;
+
+    return true;
+}
+
+static bool module_redis_command_helper_list_pop_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        bool head,
+        char **buffer,
+        size_t *buffer_length,
+        size_t *value_length) {
+    packed_list_entry_t entry;
+    packed_list_header_t *header = storage_db_chunk_sequence_get(chunk_sequence, 0)->memory.chunk_data;
+    storage_db_chunk_index_t node_chunk_index = head ? 1 : chunk_sequence->count - 1;
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, node_chunk_index);
+
+    if (chunk_sequence->count == 1) {
+        return false;
+    }
+
+    if (unlikely(!packed_list_node_edge_get(chunk_info->memory.chunk_data, head, &entry))) {
+        LOG_E(TAG, "The list is corrupted, unable to read it");
+        return false;
+    }
+
+    // The entry points to the node that is going to be changed, the value is appended to the buffer before
+    *value_length = entry.value_length;
+    *buffer = xalloc_realloc(*buffer, *buffer_length + entry.value_length + 1);
+    memcpy(*buffer + *buffer_length, entry.value, entry.value_length);
+    *buffer_length += entry.value_length;
+
+    size_t entry_length = packed_list_node_entry_length(entry.value_length);
+    packed_list_node_edge_remove(chunk_info->memory.chunk_data, head, &entry);
+    chunk_info->chunk_length -= entry_length;
+
+    header->count--;
+    header->nodes_length -= entry_length;
+    chunk_sequence->size -= entry_length;
+
+    // The empty nodes are dropped
+    if (((packed_list_node_header_t*)chunk_info->memory.chunk_data)->count == 0) {
+        storage_db_chunk_data_free(db, chunk_info);
+
+        memmove(
+                &chunk_sequence->sequence[node_chunk_index],
+                &chunk_sequence->sequence[node_chunk_index + 1],
+                sizeof(storage_db_chunk_info_t) * (chunk_sequence->count - node_chunk_index - 1));
+        chunk_sequence->count--;
+        chunk_sequence->size -= sizeof(packed_list_node_header_t);
+
+        header->nodes_count--;
+        header->nodes_length -= sizeof(packed_list_node_header_t);
+    }
+
+    return true;
+}
+
+static bool module_redis_command_helper_list_commit_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t previous_value_size,
+        char **key) {
+    packed_list_header_t *header =
+            storage_db_chunk_sequence_get(&rmw_status->current_entry_index->value, 0)->memory.chunk_data;
+
+    // As in Redis the key is dropped when the last element is popped
+    if (header->count == 0) {
+        storage_db_op_rmw_commit_delete(db, rmw_status);
+        return true;
+    }
+
+    if (unlikely(!storage_db_op_rmw_commit_update_in_place(db, rmw_status, previous_value_size))) {
+        return false;
+    }
+
+    // The ownership of the key is taken by the hashtable when the entry is updated
+    *key = NULL;
+
+    return true;
+}
+
+bool module_redis_command_helper_list_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        packed_list_builder_t *builder,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key) {
+    bool return_res;
+    storage_db_chunk_sequence_t chunk_sequence = { 0 };
+
+    // An empty list is never stored, as in Redis the key is dropped when the last element is popped
+    if (packed_list_builder_count(builder) == 0) {
+        storage_db_op_rmw_commit_delete(db, rmw_status);
+        return true;
+    }
+
+    size_t buffer_length = packed_list_builder_serialized_length(builder);
+    if (unlikely(buffer_length == 0)) {
+        LOG_E(TAG, "The list is too large to be serialized");
+        return false;
+    }
+
+    char *buffer = xalloc_alloc(buffer_length);
+    packed_list_builder_serialize(builder, buffer, buffer_length);
+
+    // The lists larger than a chunk are stored by node to be changed in place afterwards
+    if (buffer_length > STORAGE_DB_CHUNK_MAX_SIZE && module_redis_command_helper_list_chunk_sequence_allocate_by_node(
+            db,
+            &chunk_sequence,
+            buffer,
+            buffer_length)) {
+        xalloc_free(buffer);
+
+        if (unlikely(!storage_db_op_rmw_commit_update(
+                db,
+                rmw_status,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST,
+                &chunk_sequence,
+                expiry_time_ms))) {
+            storage_db_chunk_sequence_free_chunks(db, &chunk_sequence);
+            return false;
+        }
+
+        // The ownership of the key is always taken by the hashtable when the entry is updated
+        *key = NULL;
+
+        return true;
+    }
+
+    return_res = module_redis_command_helper_value_type_commit(
+            db,
+            rmw_status,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST,
+            buffer,
+            buffer_length,
+            expiry_time_ms,
+            key);
+
+    xalloc_free(buffer);
+
+    return return_res;
+}
+
+bool module_redis_command_helper_list_push(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *key,
+        module_redis_long_string_t *elements,
+        int elements_count,
+        bool head) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    bool allocated_new_buffer = false;
+    char *current_buffer = NULL;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_expiry_time_ms_t expiry_time_ms = STORAGE_DB_ENTRY_NO_EXPIRY;
+    packed_list_t packed_list = { 0 };
+    packed_list_builder_t builder = { 0 };
+    module_redis_command_helper_long_string_list_t values = { 0 };
+    bool update_in_place = false;
+    size_t previous_value_size = 0;
+    uint32_t count;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            key->key,
+            key->length,
+            &rmw_status,
+            &current_entry_index))) {
+        abort_rmw = false;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    if (current_entry_index) {
+        if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST)) {
+            return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+            goto end;
+        }
+
+        expiry_time_ms = current_entry_index->expiry_time_ms;
+    }
+
+    if (unlikely(!module_redis_command_helper_long_string_list_read(
+            connection_context->db,
+            elements,
+            elements_count,
+            &values))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    // Only the node at the edge is changed if the list is stored by node and every value fits in a node on its own,
+    // each value might need a new chunk so there has to be room for them in the sequence
+    update_in_place = module_redis_command_helper_list_can_update_in_place(
+            connection_context->db,
+            &rmw_status,
+            current_entry_index) &&
+        (size_t)current_entry_index->value.count + values.count <= UINT16_MAX;
+    for(int index = 0; update_in_place && index < values.count; index++) {
+        update_in_place = module_redis_command_helper_list_node_fits_in_chunk(
+                packed_list_node_entry_length(values.list[index].length));
+    }
+
+    if (update_in_place) {
+        previous_value_size = current_entry_index->value.size;
+
+        for(int index = 0; index < values.count; index++) {
+            if (unlikely(!module_redis_command_helper_list_push_in_place(
+                    connection_context->db,
+                    &current_entry_index->value,
+                    head,
+                    values.list[index].short_string,
+                    values.list[index].length))) {
+                return_res = module_redis_connection_error_message_printf_noncritical(
+                        connection_context,
+                        "ERR operation failed");
+                goto end;
+            }
+        }
+
+        count = ((packed_list_header_t*)storage_db_chunk_sequence_get(
+                &current_entry_index->value, 0)->memory.chunk_data)->count;
+    } else {
+        if (current_entry_index) {
+            current_buffer = module_redis_command_helper_list_read(
+                    connection_context->db,
+                    current_entry_index,
+                    &packed_list,
+                    &allocated_new_buffer);
+
+            if (unlikely(current_buffer == NULL)) {
+                return_res = module_redis_connection_error_message_printf_noncritical(
+                        connection_context,
+                        "ERR operation failed");
+                goto end;
+            }
+        }
+
+        packed_list_builder_init(&builder, current_buffer ? &packed_list : NULL);
+
+        for(int index = 0; index < values.count; index++) {
+            packed_list_builder_push(
+                    &builder,
+                    head,
+                    values.list[index].short_string,
+                    values.list[index].length);
+        }
+
+        count = packed_list_builder_count(&builder);
+    }
+
+    // The key is owned by the storage once committed, a copy is needed to wake up the clients waiting for it
+    size_t signal_key_length = key->length;
+    char *signal_key = xalloc_arena_alloc(connection_context->command.arena, signal_key_length);
+    memcpy(signal_key, key->key, signal_key_length);
+
+    if (unlikely(!(update_in_place
+            ? module_redis_command_helper_list_commit_in_place(
+                    connection_context->db,
+                    &rmw_status,
+                    previous_value_size,
+                    &key->key)
+            : module_redis_command_helper_list_commit(
+                    connection_context->db,
+                    &rmw_status,
+                    &builder,
+                    expiry_time_ms,
+                    &key->key)))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    abort_rmw = false;
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    module_redis_blocking_signal(
+            connection_context->database_number,
+            signal_key,
+            signal_key_length,
+            elements_count);
+
+    return_res = module_redis_connection_send_number(connection_context, count);
+
+end:
+
+    if (builder.nodes) {
+        packed_list_builder_free(&builder);
+    }
+
+    module_redis_command_helper_long_string_list_free(&values);
+
+    if (allocated_new_buffer) {
+        xalloc_free(current_buffer);
+    }
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    return return_res;
+}
+
+bool module_redis_command_helper_list_pop(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *key,
+        bool has_count,
+        int64_t count,
+        bool head) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    bool allocated_new_buffer = false;
+    char *current_buffer = NULL;
+    char *popped_buffer = NULL;
+    packed_list_entry_t *popped_entries = NULL;
+    uint32_t popped_count = 0;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    packed_list_t packed_list = { 0 };
+    packed_list_builder_t builder = { 0 };
+    bool update_in_place = false;
+    size_t previous_value_size = 0;
+
+    if (has_count && unlikely(count < 0)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR value is out of range, must be positive");
+    }
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            key->key,
+            key->length,
+            &rmw_status,
+            &current_entry_index))) {
+        abort_rmw = false;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    if (!current_entry_index || (has_count && count == 0)) {
+        bool is_wrongtype =
+                current_entry_index && current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST;
+
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+        abort_rmw = false;
+
+        transaction_release(&transaction);
+        release_transaction = false;
+
+        if (unlikely(is_wrongtype)) {
+            return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        } else if (current_entry_index) {
+            return_res = module_redis_connection_send_array(connection_context, 0);
+        } else {
+            return_res = module_redis_connection_send_string_null(connection_context);
+        }
+
+        goto end;
+    }
+
+    if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    size_t popped_buffer_length = 0;
+    size_t popped_buffer_offset = 0;
+    update_in_place = module_redis_command_helper_list_can_update_in_place(
+            connection_context->db,
+            &rmw_status,
+            current_entry_index);
+
+    if (update_in_place) {
+        // Only the node at the edge is changed, the values are copied out before they are removed from the node
+        packed_list_header_t *header = storage_db_chunk_sequence_get(
+                &current_entry_index->value, 0)->memory.chunk_data;
+        uint32_t pop_count = has_count ? (uint32_t)MIN((uint64_t)count, header->count) : 1;
+        previous_value_size = current_entry_index->value.size;
+        popped_entries = xalloc_alloc(sizeof(packed_list_entry_t) * pop_count);
+
+        while(popped_count < pop_count) {
+            size_t value_length;
+            if (unlikely(!module_redis_command_helper_list_pop_in_place(
+                    connection_context->db,
+                    &current_entry_index->value,
+                    head,
+                    &popped_buffer,
+                    &popped_buffer_length,
+                    &value_length))) {
+                break;
+            }
+
+            popped_entries[popped_count].value_length = value_length;
+            popped_count++;
+        }
+
+        if (unlikely(popped_count == 0)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+
+        // The buffer might have been moved while growing, the values are pointed only once all have been copied
+        for(uint32_t index = 0; index < popped_count; index++) {
+            popped_entries[index].value = popped_buffer + popped_buffer_offset;
+            popped_buffer_offset += popped_entries[index].value_length;
+        }
+    } else {
+        current_buffer = module_redis_command_helper_list_read(
+                connection_context->db,
+                current_entry_index,
+                &packed_list,
+                &allocated_new_buffer);
+
+        if (unlikely(current_buffer == NULL)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+
+        packed_list_builder_init(&builder, &packed_list);
+
+        uint32_t pop_count = has_count ? (uint32_t)MIN((uint64_t)count, packed_list.count) : 1;
+        popped_entries = xalloc_alloc(sizeof(packed_list_entry_t) * pop_count);
+
+        while(popped_count < pop_count && packed_list_builder_pop(&builder, head, &popped_entries[popped_count])) {
+            popped_buffer_length += popped_entries[popped_count].value_length;
+            popped_count++;
+        }
+
+        // The popped entries point to the current value that can be freed as soon as the list is updated so they have
+        // to be copied before committing
+        popped_buffer = xalloc_alloc(popped_buffer_length + 1);
+        for(uint32_t index = 0; index < popped_count; index++) {
+            memcpy(
+                    popped_buffer + popped_buffer_offset,
+                    popped_entries[index].value,
+                    popped_entries[index].value_length);
+            popped_entries[index].value = popped_buffer + popped_buffer_offset;
+            popped_buffer_offset += popped_entries[index].value_length;
+        }
+    }
+
+    if (unlikely(!(update_in_place
+            ? module_redis_command_helper_list_commit_in_place(
+                    connection_context->db,
+                    &rmw_status,
+                    previous_value_size,
+                    &key->key)
+            : module_redis_command_helper_list_commit(
+                    connection_context->db,
+                    &rmw_status,
+                    &builder,
+                    current_entry_index->expiry_time_ms,
+                    &key->key)))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    abort_rmw = false;
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    if (!has_count) {
+        return_res = module_redis_connection_send_blob_string(
+                connection_context,
+                popped_entries[0].value,
+                popped_entries[0].value_length);
+        goto end;
+    }
+
+    if (unlikely(!module_redis_connection_send_array(connection_context, popped_count))) {
+        goto end;
+    }
+
+    for(uint32_t index = 0; index < popped_count; index++) {
+        if (unlikely(!module_redis_connection_send_blob_string(
+                connection_context,
+                popped_entries[index].value,
+                popped_entries[index].value_length))) {
+            goto end;
+        }
+    }
+
+    return_res = true;
+
+end:
+
+    if (popped_buffer) {
+        xalloc_free(popped_buffer);
+    }
+
+    if (popped_entries) {
+        xalloc_free(popped_entries);
+    }
+
+    if (builder.nodes) {
+        packed_list_builder_free(&builder);
+    }
+
+    if (allocated_new_buffer) {
+        xalloc_free(current_buffer);
+    }
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    return return_res;
+}
+
+bool module_redis_command_helper_list_resolve_range(
+        uint32_t count,
+        int64_t start,
+        int64_t stop,
+        uint32_t *range_start,
+        uint32_t *range_stop) {
+    if (start < 0) {
+        start += count;
+    }
+
+    if (stop < 0) {
+        stop += count;
+    }
+
+    if (start < 0) {
+        start = 0;
+    }
+
+    if (stop >= count) {
+        stop = (int64_t)count - 1;
+    }
+
+    if (start > stop || start >= count) {
+        return false;
+    }
+
+    *range_start = (uint32_t)start;
+    *range_stop = (uint32_t)stop;
+
+    return true;
+}
+
+static bool module_redis_command_helper_list_try_move(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *source,
+        module_redis_key_t *destination,
+        bool from_head,
+        bool to_head,
+        char **value,
+        size_t *value_length,
+        bool *served) {
+    bool return_res = false;
+    bool moved = false;
+    bool abort_rmw_source = false, abort_rmw_destination = false;
+    bool release_transaction = true;
+    bool allocated_new_buffer_source = false, allocated_new_buffer_destination = false;
+    char *buffer_source = NULL, *buffer_destination = NULL;
+    char *key_source = NULL, *key_destination = NULL;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status_source = { 0 }, rmw_status_destination = { 0 };
+    storage_db_entry_index_t *entry_index_source = NULL, *entry_index_destination = NULL;
+    packed_list_t packed_list_source = { 0 }, packed_list_destination = { 0 };
+    packed_list_builder_t builder_source = { 0 }, builder_destination = { 0 };
+    packed_list_builder_t *builder_push = NULL;
+    packed_list_entry_t popped_entry = { 0 };
+    bool same_key =
+            destination &&
+            source->length == destination->length &&
+            memcmp(source->key, destination->key, source->length) == 0;
+
+    *served = false;
+    *value = NULL;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            source->key,
+            source->length,
+            &rmw_status_source,
+            &entry_index_source))) {
+        *served = true;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    abort_rmw_source = true;
+
+    if (!entry_index_source) {
+        return_res = true;
+        goto end;
+    }
+
+    if (unlikely(entry_index_source->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST)) {
+        *served = true;
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    if (destination && !same_key) {
+        if (unlikely(!storage_db_op_rmw_begin(
+                connection_context->db,
+                &transaction,
+                connection_context->database_number,
+                destination->key,
+                destination->length,
+                &rmw_status_destination,
+                &entry_index_destination))) {
+            *served = true;
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+
+        abort_rmw_destination = true;
+
+        if (entry_index_destination) {
+            if (unlikely(entry_index_destination->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST)) {
+                *served = true;
+                return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+                goto end;
+            }
+
+            buffer_destination = module_redis_command_helper_list_read(
+                    connection_context->db,
+                    entry_index_destination,
+                    &packed_list_destination,
+                    &allocated_new_buffer_destination);
+
+            if (unlikely(buffer_destination == NULL)) {
+                *served = true;
+                return_res = module_redis_connection_error_message_printf_noncritical(
+                        connection_context,
+                        "ERR operation failed");
+                goto end;
+            }
+        }
+    }
+
+    buffer_source = module_redis_command_helper_list_read(
+            connection_context->db,
+            entry_index_source,
+            &packed_list_source,
+            &allocated_new_buffer_source);
+
+    if (unlikely(buffer_source == NULL)) {
+        *served = true;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    packed_list_builder_init(&builder_source, &packed_list_source);
+    if (!packed_list_builder_pop(&builder_source, from_head, &popped_entry)) {
+        return_res = true;
+        goto end;
+    }
+
+    // The popped entry points to the current value that can be freed as soon as the list is updated
+    *value_length = popped_entry.value_length;
+    *value = xalloc_alloc(popped_entry.value_length + 1);
+    memcpy(*value, popped_entry.value, popped_entry.value_length);
+
+    if (destination) {
+        if (same_key) {
+            builder_push = &builder_source;
+        } else {
+            packed_list_builder_init(
+                    &builder_destination,
+                    buffer_destination ? &packed_list_destination : NULL);
+            builder_push = &builder_destination;
+        }
+
+        packed_list_builder_push(builder_push, to_head, *value, *value_length);
+    }
+
+    // The keys in the command context are still needed to reply and to wake up the clients, the storage takes the
+    // ownership of the keys passed when committing so copies are used
+    key_source = xalloc_alloc(source->length);
+    memcpy(key_source, source->key, source->length);
+
+    if (unlikely(!module_redis_command_helper_list_commit(
+            connection_context->db,
+            &rmw_status_source,
+            &builder_source,
+            entry_index_source->expiry_time_ms,
+            &key_source))) {
+        *served = true;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    abort_rmw_source = false;
+
+    if (builder_push == &builder_destination) {
+        key_destination = xalloc_alloc(destination->length);
+        memcpy(key_destination, destination->key, destination->length);
+
+        if (unlikely(!module_redis_command_helper_list_commit(
+                connection_context->db,
+                &rmw_status_destination,
+                &builder_destination,
+                entry_index_destination ? entry_index_destination->expiry_time_ms : STORAGE_DB_ENTRY_NO_EXPIRY,
+                &key_destination))) {
+            *served = true;
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+
+        abort_rmw_destination = false;
+    }
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    if (destination) {
+        module_redis_blocking_signal(
+                connection_context->database_number,
+                destination->key,
+                destination->length,
+                1);
+    }
+
+    moved = true;
+    *served = true;
+    return_res = true;
+
+end:
+
+    if (!moved && *value) {
+        xalloc_free(*value);
+        *value = NULL;
+    }
+
+    if (builder_destination.nodes) {
+        packed_list_builder_free(&builder_destination);
+    }
+
+    if (builder_source.nodes) {
+        packed_list_builder_free(&builder_source);
+    }
+
+    if (allocated_new_buffer_destination) {
+        xalloc_free(buffer_destination);
+    }
+
+    if (allocated_new_buffer_source) {
+        xalloc_free(buffer_source);
+    }
+
+    if (key_destination) {
+        xalloc_free(key_destination);
+    }
+
+    if (key_source) {
+        xalloc_free(key_source);
+    }
+
+    if (unlikely(abort_rmw_destination)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status_destination);
+    }
+
+    if (unlikely(abort_rmw_source)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status_source);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    return return_res;
+}
+
+static bool module_redis_command_helper_list_try_move_any(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *keys,
+        uint32_t keys_count,
+        module_redis_key_t *destination,
+        bool from_head,
+        bool to_head,
+        uint32_t *key_index,
+        char **value,
+        size_t *value_length,
+        bool *served) {
+    for(*key_index = 0; *key_index < keys_count; (*key_index)++) {
+        if (unlikely(!module_redis_command_helper_list_try_move(
+                connection_context,
+                &keys[*key_index],
+                destination,
+                from_head,
+                to_head,
+                value,
+                value_length,
+                served))) {
+            return false;
+        }
+
+        if (*served) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_list_blocking_move(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *keys,
+        uint32_t keys_count,
+        module_redis_key_t *destination,
+        bool from_head,
+        bool to_head,
+        long double timeout) {
+    bool return_res;
+    bool served = false, waiter_initialized = false;
+    uint32_t key_index = 0;
+    char *value = NULL;
+    size_t value_length = 0;
+    int64_t deadline_ms = 0;
+    module_redis_blocking_waiter_t waiter;
+
+    if (unlikely(timeout < 0)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR timeout is negative");
+    }
+
+    if (unlikely(timeout * 1000 >= (long double)(INT64_MAX / 2))) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR timeout is out of range");
+    }
+
+    if (unlikely(!(return_res = module_redis_command_helper_list_try_move_any(
+            connection_context,
+            keys,
+            keys_count,
+            destination,
+            from_head,
+            to_head,
+            &key_index,
+            &value,
+            &value_length,
+            &served)))) {
+        goto end;
+    }
+
+    // Inside a transaction the command can't block as the locks of the keys are held till the end of EXEC, as in Redis
+    // it behaves as if the timeout had expired
+    if (!served && !connection_context->transaction.executing) {
+        // A timeout set to 0 blocks the client indefinitely
+        if (timeout > 0) {
+            deadline_ms = clock_monotonic_int64_ms() + (int64_t)ceill(timeout * 1000);
+        }
+
+        module_redis_blocking_waiter_init(
+                &waiter,
+                connection_context->network_channel,
+                connection_context->database_number,
+                keys,
+                keys_count);
+        waiter_initialized = true;
+
+        while(true) {
+            module_redis_blocking_waiter_register(&waiter);
+
+            // The keys have to be checked again once registered, an element might have been pushed in the meantime
+            return_res = module_redis_command_helper_list_try_move_any(
+                    connection_context,
+                    keys,
+                    keys_count,
+                    destination,
+                    from_head,
+                    to_head,
+                    &key_index,
+                    &value,
+                    &value_length,
+                    &served);
+
+            if (unlikely(!return_res) || served) {
+                module_redis_blocking_waiter_cancel(&waiter);
+                break;
+            }
+
+            if (!module_redis_blocking_waiter_wait(&waiter, deadline_ms)) {
+                // The client has gone away while blocked, there is no one to reply to
+                if (unlikely(waiter.hangup)) {
+                    connection_context->terminate_connection = true;
+                    goto end;
+                }
+
+                break;
+            }
+
+            // Another client might have popped the element before the woken up one, in which case it has to wait again
+            if (unlikely(!(return_res = module_redis_command_helper_list_try_move_any(
+                    connection_context,
+                    keys,
+                    keys_count,
+                    destination,
+                    from_head,
+                    to_head,
+                    &key_index,
+                    &value,
+                    &value_length,
+                    &served)))) {
+                break;
+            }
+
+            if (served) {
+                if (value) {
+                    module_redis_blocking_waiter_served(&waiter);
+                }
+                break;
+            }
+        }
+    }
+
+    if (unlikely(!return_res)) {
+        goto end;
+    }
+
+    if (!served) {
+        return_res = destination
+                ? module_redis_connection_send_string_null(connection_context)
+                : module_redis_connection_send_array_null(connection_context);
+        goto end;
+    }
+
+    // If served is true but there isn't a value an error has been reported
+    if (!value) {
+        goto end;
+    }
+
+    if (destination) {
+        return_res = module_redis_connection_send_blob_string(connection_context, value, value_length);
+        goto end;
+    }
+
+    if (unlikely(!module_redis_connection_send_array(connection_context, 2))) {
+        return_res = false;
+        goto end;
+    }
+
+    if (unlikely(!module_redis_connection_send_blob_string(
+            connection_context,
+            keys[key_index].key,
+            keys[key_index].length))) {
+        return_res = false;
+        goto end;
+    }
+
+    return_res = module_redis_connection_send_blob_string(connection_context, value, value_length);
+
+end:
+
+    if (waiter_initialized) {
+        module_redis_blocking_waiter_free(&waiter);
+    }
+
+    if (value) {
+        xalloc_free(value);
+    }
+
+    return return_res;
+}
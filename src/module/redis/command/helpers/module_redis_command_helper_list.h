@@ -0,0 +1,55 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_LIST_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_LIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char *module_redis_command_helper_list_read(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        packed_list_t *packed_list,
+        bool *allocated_new_buffer);
+
+bool module_redis_command_helper_list_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        packed_list_builder_t *builder,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key);
+
+bool module_redis_command_helper_list_push(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *key,
+        module_redis_long_string_t *elements,
+        int elements_count,
+        bool head);
+
+bool module_redis_command_helper_list_pop(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *key,
+        bool has_count,
+        int64_t count,
+        bool head);
+
+bool module_redis_command_helper_list_blocking_move(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *keys,
+        uint32_t keys_count,
+        module_redis_key_t *destination,
+        bool from_head,
+        bool to_head,
+        long double timeout);
+
+bool module_redis_command_helper_list_resolve_range(
+        uint32_t count,
+        int64_t start,
+        int64_t stop,
+        uint32_t *range_start,
+        uint32_t *range_stop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_LIST_H
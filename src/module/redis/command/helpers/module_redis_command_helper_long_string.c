@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_command_helper_long_string.h"
+
+#define TAG "module_redis_command_helper_long_string"
+
+bool module_redis_command_helper_long_string_read(
+        storage_db_t *db,
+        module_redis_long_string_t *long_string,
+        module_redis_short_string_t *short_string,
+        bool *allocated_new_buffer) {
+    *allocated_new_buffer = false;
+    short_string->length = long_string->chunk_sequence.size;
+
+    // Empty strings don't have any chunk allocated
+    if (unlikely(long_string->chunk_sequence.count == 0)) {
+        short_string->short_string = "";
+        return true;
+    }
+
+    // When the value fits in one chunk and the backend is in memory the chunk is used directly without copying it
+    short_string->short_string = storage_db_chunk_sequence_read_all(
+            db,
+            &long_string->chunk_sequence,
+            allocated_new_buffer);
+
+    return short_string->short_string != NULL;
+}
+
+void module_redis_command_helper_long_string_free(
+        module_redis_short_string_t *short_string,
+        bool allocated_new_buffer) {
+    if (allocated_new_buffer) {
+        xalloc_free(short_string->short_string);
+    }
+
+    short_string->short_string = NULL;
+}
+
+bool module_redis_command_helper_long_string_list_read(
+        storage_db_t *db,
+        module_redis_long_string_t *long_strings,
+        int count,
+        module_redis_command_helper_long_string_list_t *list) {
+    list->count = 0;
+    list->list = xalloc_alloc(sizeof(module_redis_short_string_t) * count);
+    list->allocated_new_buffer = xalloc_alloc(sizeof(bool) * count);
+
+    for(int index = 0; index < count; index++) {
+        if (unlikely(!module_redis_command_helper_long_string_read(
+                db,
+                &long_strings[index],
+                &list->list[index],
+                &list->allocated_new_buffer[index]))) {
+            module_redis_command_helper_long_string_list_free(list);
+            return false;
+        }
+
+        list->count++;
+    }
+
+    return true;
+}
+
+void module_redis_command_helper_long_string_list_free(
+        module_redis_command_helper_long_string_list_t *list) {
+    if (list->list == NULL) {
+        return;
+    }
+
+    for(int index = 0; index < list->count; index++) {
+        module_redis_command_helper_long_string_free(&list->list[index], list->allocated_new_buffer[index]);
+    }
+
+    xalloc_free(list->list);
+    xalloc_free(list->allocated_new_buffer);
+    list->list = NULL;
+    list->allocated_new_buffer = NULL;
+    list->count = 0;
+}
@@ -0,0 +1,38 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_LONG_STRING_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_LONG_STRING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct module_redis_command_helper_long_string_list module_redis_command_helper_long_string_list_t;
+struct module_redis_command_helper_long_string_list {
+    module_redis_short_string_t *list;
+    bool *allocated_new_buffer;
+    int count;
+};
+
+bool module_redis_command_helper_long_string_read(
+        storage_db_t *db,
+        module_redis_long_string_t *long_string,
+        module_redis_short_string_t *short_string,
+        bool *allocated_new_buffer);
+
+void module_redis_command_helper_long_string_free(
+        module_redis_short_string_t *short_string,
+        bool allocated_new_buffer);
+
+bool module_redis_command_helper_long_string_list_read(
+        storage_db_t *db,
+        module_redis_long_string_t *long_strings,
+        int count,
+        module_redis_command_helper_long_string_list_t *list);
+
+void module_redis_command_helper_long_string_list_free(
+        module_redis_command_helper_long_string_list_t *list);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_LONG_STRING_H
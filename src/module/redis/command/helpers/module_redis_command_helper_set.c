@@ -0,0 +1,298 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "data_structures/packed_set/packed_set.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_command_helper_value_type.h"
+#include "module_redis_command_helper_hash.h"
+#include "module_redis_command_helper_set.h"
+
+#define TAG "module_redis_command_helper_set"
+
+char *module_redis_command_helper_set_read(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        packed_set_t *packed_set,
+        bool *allocated_new_buffer) {
+    assert(entry_index->value_type == STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET);
+
+    char *buffer = storage_db_chunk_sequence_read_all(
+            db,
+            &entry_index->value,
+            allocated_new_buffer);
+
+    if (unlikely(buffer == NULL)) {
+        return NULL;
+    }
+
+    if (unlikely(!packed_set_init(packed_set, buffer, entry_index->value.size))) {
+        LOG_E(TAG, "The set is corrupted, unable to read it");
+
+        if (*allocated_new_buffer) {
+            xalloc_free(buffer);
+            *allocated_new_buffer = false;
+        }
+
+        return NULL;
+    }
+
+    return buffer;
+}
+
+bool module_redis_command_helper_set_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        packed_set_builder_t *builder,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key) {
+    bool return_res;
+
+    // An empty set is never stored, as in Redis the key is dropped when the last member is removed
+    if (packed_set_builder_count(builder) == 0) {
+        storage_db_op_rmw_commit_delete(db, rmw_status);
+        return true;
+    }
+
+    size_t buffer_length = packed_set_builder_serialized_length(builder);
+    if (unlikely(buffer_length == 0)) {
+        LOG_E(TAG, "The set is too large to be serialized");
+        return false;
+    }
+
+    char *buffer = xalloc_alloc(buffer_length);
+    packed_set_builder_serialize(builder, buffer, buffer_length);
+
+    return_res = module_redis_command_helper_value_type_commit(
+            db,
+            rmw_status,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET,
+            buffer,
+            buffer_length,
+            expiry_time_ms,
+            key);
+
+    xalloc_free(buffer);
+
+    return return_res;
+}
+
+static bool module_redis_command_helper_set_count_update_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        int32_t delta) {
+    packed_set_header_t header;
+
+    if (unlikely(!storage_db_chunk_sequence_read(db, chunk_sequence, (char*)&header, 0, sizeof(header)))) {
+        return false;
+    }
+
+    header.count += delta;
+
+    return storage_db_chunk_sequence_write(db, chunk_sequence, 0, (char*)&header, sizeof(header));
+}
+
+bool module_redis_command_helper_set_can_update_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        uint32_t new_members_count,
+        size_t new_entries_length) {
+    packed_set_header_t header;
+
+    if (!storage_db_op_rmw_current_entry_index_can_be_updated_in_place(db, rmw_status, 0)) {
+        return false;
+    }
+
+    storage_db_chunk_sequence_t *chunk_sequence = &rmw_status->current_entry_index->value;
+    if (unlikely(chunk_sequence->size < sizeof(header))) {
+        return false;
+    }
+
+    if (unlikely(!storage_db_chunk_sequence_read(db, chunk_sequence, (char*)&header, 0, sizeof(header)))) {
+        return false;
+    }
+
+    // The intsets are small and kept sorted so they are always rebuilt, the members of the sets using the hash
+    // encoding are the fields of the packed hash following the header and are changed in place as the fields of a hash
+    return header.encoding == PACKED_SET_ENCODING_HASH && module_redis_command_helper_hash_can_update_in_place(
+            db,
+            rmw_status,
+            sizeof(packed_set_header_t),
+            new_members_count,
+            new_entries_length);
+}
+
+bool module_redis_command_helper_set_add_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *member,
+        size_t member_length,
+        bool *added) {
+    if (unlikely(!module_redis_command_helper_hash_set_in_place(
+            db,
+            chunk_sequence,
+            sizeof(packed_set_header_t),
+            member,
+            member_length,
+            "",
+            0,
+            added))) {
+        return false;
+    }
+
+    return *added
+        ? module_redis_command_helper_set_count_update_in_place(db, chunk_sequence, 1)
+        : true;
+}
+
+bool module_redis_command_helper_set_remove_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *member,
+        size_t member_length,
+        bool *removed) {
+    if (unlikely(!module_redis_command_helper_hash_delete_in_place(
+            db,
+            chunk_sequence,
+            sizeof(packed_set_header_t),
+            member,
+            member_length,
+            removed))) {
+        return false;
+    }
+
+    return *removed
+        ? module_redis_command_helper_set_count_update_in_place(db, chunk_sequence, -1)
+        : true;
+}
+
+bool module_redis_command_helper_set_commit_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t previous_value_size,
+        char **key) {
+    return module_redis_command_helper_hash_commit_in_place(
+            db,
+            rmw_status,
+            sizeof(packed_set_header_t),
+            previous_value_size,
+            key);
+}
+
+bool module_redis_command_helper_set_send_member(
+        module_redis_connection_context_t *connection_context,
+        packed_set_member_t *member) {
+    if (member->is_integer) {
+        char buffer[PACKED_SET_INTEGER_MAX_LENGTH + 1];
+        size_t buffer_length = packed_set_integer_to_string(member->integer, buffer);
+
+        return module_redis_connection_send_blob_string(connection_context, buffer, buffer_length);
+    }
+
+    return module_redis_connection_send_blob_string(connection_context, member->value, member->value_length);
+}
+
+bool module_redis_command_helper_set_sources_open(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *keys,
+        int keys_count,
+        module_redis_command_helper_set_source_t *sources,
+        bool *opened) {
+    transaction_t transaction = { 0 };
+
+    *opened = false;
+    memset(sources, 0, sizeof(module_redis_command_helper_set_source_t) * keys_count);
+
+    // The keys are only read, once the entry indexes have been acquired the transaction can be released right away
+    transaction_acquire(&transaction);
+    for(int index = 0; index < keys_count; index++) {
+        sources[index].entry_index = storage_db_get_entry_index_for_read(
+                connection_context->db,
+                connection_context->database_number,
+                &transaction,
+                keys[index].key,
+                keys[index].length);
+    }
+    transaction_release(&transaction);
+
+    for(int index = 0; index < keys_count; index++) {
+        module_redis_command_helper_set_source_t *source = &sources[index];
+
+        // A missing key is treated as an empty set
+        if (!source->entry_index) {
+            continue;
+        }
+
+        if (unlikely(source->entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET)) {
+            return module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        }
+
+        source->buffer = module_redis_command_helper_set_read(
+                connection_context->db,
+                source->entry_index,
+                &source->packed_set,
+                &source->allocated_new_buffer);
+
+        if (unlikely(source->buffer == NULL)) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+        }
+    }
+
+    *opened = true;
+
+    return true;
+}
+
+void module_redis_command_helper_set_sources_close(
+        module_redis_command_helper_set_source_t *sources,
+        int keys_count) {
+    for(int index = 0; index < keys_count; index++) {
+        module_redis_command_helper_set_source_t *source = &sources[index];
+
+        if (source->allocated_new_buffer) {
+            xalloc_free(source->buffer);
+        }
+
+        if (source->entry_index) {
+            storage_db_entry_index_status_decrease_readers_counter(source->entry_index, NULL);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SET_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct module_redis_command_helper_set_source module_redis_command_helper_set_source_t;
+struct module_redis_command_helper_set_source {
+    storage_db_entry_index_t *entry_index;
+    char *buffer;
+    bool allocated_new_buffer;
+    packed_set_t packed_set;
+};
+
+char *module_redis_command_helper_set_read(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        packed_set_t *packed_set,
+        bool *allocated_new_buffer);
+
+bool module_redis_command_helper_set_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        packed_set_builder_t *builder,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key);
+
+bool module_redis_command_helper_set_can_update_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        uint32_t new_members_count,
+        size_t new_entries_length);
+
+bool module_redis_command_helper_set_add_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *member,
+        size_t member_length,
+        bool *added);
+
+bool module_redis_command_helper_set_remove_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *member,
+        size_t member_length,
+        bool *removed);
+
+bool module_redis_command_helper_set_commit_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t previous_value_size,
+        char **key);
+
+bool module_redis_command_helper_set_send_member(
+        module_redis_connection_context_t *connection_context,
+        packed_set_member_t *member);
+
+bool module_redis_command_helper_set_sources_open(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *keys,
+        int keys_count,
+        module_redis_command_helper_set_source_t *sources,
+        bool *opened);
+
+void module_redis_command_helper_set_sources_close(
+        module_redis_command_helper_set_source_t *sources,
+        int keys_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SET_H
@@ -0,0 +1,591 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <math.h>
+#include <errno.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_command_helper_value_type.h"
+#include "module_redis_command_helper_sorted_set.h"
+
+
+#define TAG "module_redis_command_helper_sorted_set"
+
+static bool module_redis_command_helper_sorted_set_parse_index(
+        char *value,
+        size_t value_length,
+        int64_t *index) {
+    char buffer[MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NUMBER_MAX_LENGTH];
+    char *buffer_end = NULL;
+
+    // The short strings are not null terminated, strtoll needs a null terminated string
+    if (value_length == 0 || value_length >= sizeof(buffer)) {
+        return false;
+    }
+
+    memcpy(buffer, value, value_length);
+    buffer[value_length] = 0;
+
+    errno = 0;
+    *index = strtoll(buffer, &buffer_end, 10);
+
+    return errno != ERANGE && buffer_end == buffer + value_length;
+}
+
+static size_t module_redis_command_helper_sorted_set_score_to_string(
+        double score,
+        char *buffer,
+        size_t buffer_size) {
+    size_t length = 0;
+
+    // The shortest representation that gives back the same double is used, as done by Redis 7, so 0.1 is sent as 0.1
+    // and not as 0.10000000000000001
+    for(int precision = 15; precision <= 17; precision++) {
+        length = snprintf(buffer, buffer_size, "%.*g", precision, score);
+
+        if (strtod(buffer, NULL) == score) {
+            break;
+        }
+    }
+
+    return length;
+}
+
+sorted_set_t *module_redis_command_helper_sorted_set_get(
+        storage_db_entry_index_t *entry_index) {
+    assert(entry_index->value_type == STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET);
+    assert(entry_index->value_object != NULL);
+
+    return entry_index->value_object;
+}
+
+sorted_set_t *module_redis_command_helper_sorted_set_prepare_write(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_entry_index_t *current_entry_index,
+        bool *in_place) {
+    *in_place = false;
+
+    if (!current_entry_index) {
+        return sorted_set_new();
+    }
+
+    // The sorted set is changed directly if nobody else can see it, otherwise it's copied and the copy replaces the
+    // current entry index on commit, the readers and the snapshot keep using the sorted set they have fetched
+    if (storage_db_op_rmw_current_entry_index_can_be_updated_in_place(db, rmw_status, 0)) {
+        *in_place = true;
+        return module_redis_command_helper_sorted_set_get(current_entry_index);
+    }
+
+    return sorted_set_clone(module_redis_command_helper_sorted_set_get(current_entry_index));
+}
+
+bool module_redis_command_helper_sorted_set_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        sorted_set_t *sorted_set,
+        bool in_place,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key) {
+    // As in Redis the key is dropped when the last member is removed, the sorted set changed in place is freed together
+    // with the entry index
+    if (sorted_set->count == 0) {
+        if (!in_place) {
+            sorted_set_free(sorted_set);
+        }
+
+        storage_db_op_rmw_commit_delete(db, rmw_status);
+        return true;
+    }
+
+    if (in_place) {
+        storage_db_entry_index_t *entry_index = rmw_status->current_entry_index;
+        size_t previous_value_size = entry_index->value.size;
+        entry_index->value.size = sorted_set_size(sorted_set);
+
+        if (unlikely(!storage_db_op_rmw_commit_update_in_place(db, rmw_status, previous_value_size))) {
+            return false;
+        }
+    } else {
+        if (unlikely(!storage_db_op_rmw_commit_update_value_object(
+                db,
+                rmw_status,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET,
+                sorted_set,
+                sorted_set_size(sorted_set),
+                expiry_time_ms))) {
+            return false;
+        }
+    }
+
+    // The ownership of the key is always taken by the hashtable when the entry is updated
+    *key = NULL;
+
+    return true;
+}
+
+bool module_redis_command_helper_sorted_set_parse_score(
+        char *value,
+        size_t value_length,
+        double *score) {
+    char buffer[MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NUMBER_MAX_LENGTH];
+    char *buffer_end = NULL;
+
+    if (value_length == 0 || value_length >= sizeof(buffer) || isspace(value[0])) {
+        return false;
+    }
+
+    memcpy(buffer, value, value_length);
+    buffer[value_length] = 0;
+
+    // strtod already accepts inf, +inf and -inf, NaN is never a valid score
+    errno = 0;
+    *score = strtod(buffer, &buffer_end);
+
+    return !(errno == ERANGE && !isinf(*score)) && buffer_end == buffer + value_length && !isnan(*score);
+}
+
+bool module_redis_command_helper_sorted_set_parse_score_range(
+        char *value,
+        size_t value_length,
+        double *score,
+        bool *exclusive) {
+    *exclusive = value_length > 0 && value[0] == '(';
+
+    if (*exclusive) {
+        value++;
+        value_length--;
+    }
+
+    return module_redis_command_helper_sorted_set_parse_score(value, value_length, score);
+}
+
+bool module_redis_command_helper_sorted_set_send_score(
+        module_redis_connection_context_t *connection_context,
+        double score) {
+    char buffer[MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NUMBER_MAX_LENGTH];
+    size_t buffer_length = module_redis_command_helper_sorted_set_score_to_string(score, buffer, sizeof(buffer));
+
+    return module_redis_connection_send_blob_string(connection_context, buffer, buffer_length);
+}
+
+bool module_redis_command_helper_sorted_set_add(
+        module_redis_connection_context_t *connection_context,
+        char **key,
+        size_t key_length,
+        module_redis_command_helper_sorted_set_add_flags_t flags,
+        module_redis_command_helper_sorted_set_score_member_t *score_members,
+        uint32_t score_members_count) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    bool incr_score_set = false;
+    bool in_place = false;
+    double incr_score = 0;
+    int64_t added_count = 0, updated_count = 0;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_expiry_time_ms_t expiry_time_ms = STORAGE_DB_ENTRY_NO_EXPIRY;
+    sorted_set_t *sorted_set = NULL;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            *key,
+            key_length,
+            &rmw_status,
+            &current_entry_index))) {
+        abort_rmw = false;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    if (current_entry_index) {
+        if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET)) {
+            return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+            goto end;
+        }
+
+        expiry_time_ms = current_entry_index->expiry_time_ms;
+    }
+
+    sorted_set = module_redis_command_helper_sorted_set_prepare_write(
+            connection_context->db,
+            &rmw_status,
+            current_entry_index,
+            &in_place);
+
+    for(uint32_t index = 0; index < score_members_count; index++) {
+        module_redis_command_helper_sorted_set_score_member_t *score_member = &score_members[index];
+        sorted_set_node_t *node = sorted_set_get(sorted_set, score_member->member, score_member->member_length);
+
+        if (node) {
+            if (flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_NX) {
+                continue;
+            }
+
+            double new_score = (flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_INCR)
+                    ? node->score + score_member->score
+                    : score_member->score;
+
+            // Adding -inf to +inf, or vice versa, is the only way to get a NaN, INCR accepts only one pair so nothing
+            // has been changed yet
+            if (unlikely(isnan(new_score))) {
+                assert(added_count == 0 && updated_count == 0);
+                return_res = module_redis_connection_error_message_printf_noncritical(
+                        connection_context,
+                        "ERR resulting score is not a number (NaN)");
+                goto end;
+            }
+
+            if (((flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_GT) && new_score <= node->score) ||
+                ((flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_LT) && new_score >= node->score)) {
+                continue;
+            }
+
+            incr_score = new_score;
+            incr_score_set = true;
+
+            if (new_score != node->score) {
+                sorted_set_update_score(sorted_set, node, new_score);
+                updated_count++;
+            }
+        } else {
+            if (flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_XX) {
+                continue;
+            }
+
+            sorted_set_insert(sorted_set, score_member->member, score_member->member_length, score_member->score);
+            incr_score = score_member->score;
+            incr_score_set = true;
+            added_count++;
+        }
+    }
+
+    // Nothing to write back if no member has been added or updated
+    if (added_count > 0 || updated_count > 0) {
+        if (unlikely(!module_redis_command_helper_sorted_set_commit(
+                connection_context->db,
+                &rmw_status,
+                sorted_set,
+                in_place,
+                expiry_time_ms,
+                key))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+
+        // The sorted set is now owned by the entry index
+        sorted_set = NULL;
+        abort_rmw = false;
+    } else {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+        abort_rmw = false;
+    }
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    if (flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_INCR) {
+        return_res = incr_score_set
+                ? module_redis_command_helper_sorted_set_send_score(connection_context, incr_score)
+                : module_redis_connection_send_string_null(connection_context);
+    } else {
+        return_res = module_redis_connection_send_number(
+                connection_context,
+                added_count + ((flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_CH) ? updated_count : 0));
+    }
+
+end:
+
+    if (sorted_set && !in_place) {
+        sorted_set_free(sorted_set);
+    }
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    return return_res;
+}
+
+bool module_redis_command_helper_sorted_set_rank(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length,
+        char *member,
+        size_t member_length,
+        bool reverse) {
+    bool return_res = false;
+    sorted_set_t *sorted_set;
+    sorted_set_node_t *node;
+    storage_db_entry_index_t *entry_index = NULL;
+
+    transaction_t transaction = { 0 };
+    transaction_acquire(&transaction);
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            connection_context->database_number,
+            &transaction,
+            key,
+            key_length);
+
+    transaction_release(&transaction);
+
+    if (!entry_index) {
+        return_res = module_redis_connection_send_string_null(connection_context);
+        goto end;
+    }
+
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    // The member is found with a lookup in the art_spsc tree and the rank is calculated summing the spans of the
+    // skiplist levels
+    sorted_set = module_redis_command_helper_sorted_set_get(entry_index);
+    node = sorted_set_get(sorted_set, member, member_length);
+
+    if (!node) {
+        return_res = module_redis_connection_send_string_null(connection_context);
+        goto end;
+    }
+
+    uint64_t rank = sorted_set_rank(sorted_set, node);
+    return_res = module_redis_connection_send_number(
+            connection_context,
+            (int64_t)(reverse ? sorted_set->count - 1 - rank : rank));
+
+end:
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
+
+bool module_redis_command_helper_sorted_set_range(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length,
+        module_redis_short_string_t *start,
+        module_redis_short_string_t *stop,
+        bool by_score,
+        bool reverse,
+        bool has_limit,
+        int64_t limit_offset,
+        int64_t limit_count,
+        bool with_scores) {
+    bool return_res = false;
+    int64_t start_index = 0, stop_index = 0;
+    double min_score = 0, max_score = 0;
+    bool min_exclusive = false, max_exclusive = false;
+    uint64_t first_rank = 0, end_rank = 0, entries_count = 0;
+    sorted_set_t *sorted_set;
+    sorted_set_node_t *node;
+    storage_db_entry_index_t *entry_index = NULL;
+
+    if (has_limit && !by_score) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR syntax error, LIMIT is only supported in combination with either BYSCORE or BYLEX");
+    }
+
+    if (by_score) {
+        // When the range is reversed the first boundary is the max score
+        module_redis_short_string_t *min = reverse ? stop : start;
+        module_redis_short_string_t *max = reverse ? start : stop;
+
+        if (!module_redis_command_helper_sorted_set_parse_score_range(
+                min->short_string,
+                min->length,
+                &min_score,
+                &min_exclusive) ||
+            !module_redis_command_helper_sorted_set_parse_score_range(
+                    max->short_string,
+                    max->length,
+                    &max_score,
+                    &max_exclusive)) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR min or max is not a float");
+        }
+    } else {
+        if (!module_redis_command_helper_sorted_set_parse_index(start->short_string, start->length, &start_index) ||
+            !module_redis_command_helper_sorted_set_parse_index(stop->short_string, stop->length, &stop_index)) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR value is not an integer or out of range");
+        }
+    }
+
+    transaction_t transaction = { 0 };
+    transaction_acquire(&transaction);
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            connection_context->database_number,
+            &transaction,
+            key,
+            key_length);
+
+    transaction_release(&transaction);
+
+    if (!entry_index) {
+        return_res = module_redis_connection_send_array_header(connection_context, 0);
+        goto end;
+    }
+
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    sorted_set = module_redis_command_helper_sorted_set_get(entry_index);
+
+    // Both kinds of ranges are converted into a range of ranks [first_rank, end_rank), in ascending order, walked
+    // backward if the range is reversed
+    if (by_score) {
+        node = sorted_set_first_by_score(sorted_set, min_score, min_exclusive);
+        first_rank = node ? sorted_set_rank(sorted_set, node) : sorted_set->count;
+        node = sorted_set_first_by_score(sorted_set, max_score, !max_exclusive);
+        end_rank = node ? sorted_set_rank(sorted_set, node) : sorted_set->count;
+    } else {
+        int64_t count = (int64_t)sorted_set->count;
+
+        if (start_index < 0) {
+            start_index += count;
+        }
+        if (stop_index < 0) {
+            stop_index += count;
+        }
+        if (start_index < 0) {
+            start_index = 0;
+        }
+        if (stop_index >= count) {
+            stop_index = count - 1;
+        }
+
+        if (start_index <= stop_index && start_index < count) {
+            first_rank = reverse ? count - 1 - stop_index : start_index;
+            end_rank = reverse ? count - start_index : stop_index + 1;
+        }
+    }
+
+    if (first_rank < end_rank) {
+        entries_count = end_rank - first_rank;
+    }
+
+    if (has_limit) {
+        if (limit_offset < 0 || (uint64_t)limit_offset >= entries_count) {
+            entries_count = 0;
+        } else {
+            // The offset is applied along the direction of the range
+            if (reverse) {
+                end_rank -= limit_offset;
+            } else {
+                first_rank += limit_offset;
+            }
+
+            entries_count -= limit_offset;
+
+            if (limit_count >= 0 && (uint64_t)limit_count < entries_count) {
+                entries_count = limit_count;
+            }
+        }
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(
+            connection_context,
+            entries_count * (with_scores ? 2 : 1)))) {
+        goto end;
+    }
+
+    // Only the first node is looked up by rank, the others are reached walking the bottom level of the skiplist
+    node = entries_count > 0
+            ? sorted_set_get_by_rank(sorted_set, reverse ? end_rank - 1 : first_rank)
+            : NULL;
+    for(uint64_t index = 0; index < entries_count; index++) {
+        assert(node != NULL);
+
+        if (unlikely(!module_redis_connection_send_blob_string(
+                connection_context,
+                node->member,
+                node->member_length))) {
+            goto end;
+        }
+
+        if (with_scores) {
+            if (unlikely(!module_redis_command_helper_sorted_set_send_score(connection_context, node->score))) {
+                goto end;
+            }
+        }
+
+        node = reverse ? node->backward : sorted_set_next(node);
+    }
+
+    return_res = true;
+
+end:
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
@@ -0,0 +1,93 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SORTED_SET_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SORTED_SET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NUMBER_MAX_LENGTH    (128)
+
+enum module_redis_command_helper_sorted_set_add_flags {
+    MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_NONE = 0,
+    MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_NX = 1 << 0,
+    MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_XX = 1 << 1,
+    MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_GT = 1 << 2,
+    MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_LT = 1 << 3,
+    MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_CH = 1 << 4,
+    MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_INCR = 1 << 5,
+};
+typedef enum module_redis_command_helper_sorted_set_add_flags module_redis_command_helper_sorted_set_add_flags_t;
+
+typedef struct module_redis_command_helper_sorted_set_score_member module_redis_command_helper_sorted_set_score_member_t;
+struct module_redis_command_helper_sorted_set_score_member {
+    double score;
+    char *member;
+    size_t member_length;
+};
+
+sorted_set_t *module_redis_command_helper_sorted_set_get(
+        storage_db_entry_index_t *entry_index);
+
+sorted_set_t *module_redis_command_helper_sorted_set_prepare_write(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_entry_index_t *current_entry_index,
+        bool *in_place);
+
+bool module_redis_command_helper_sorted_set_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        sorted_set_t *sorted_set,
+        bool in_place,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key);
+
+bool module_redis_command_helper_sorted_set_parse_score(
+        char *value,
+        size_t value_length,
+        double *score);
+
+bool module_redis_command_helper_sorted_set_parse_score_range(
+        char *value,
+        size_t value_length,
+        double *score,
+        bool *exclusive);
+
+bool module_redis_command_helper_sorted_set_send_score(
+        module_redis_connection_context_t *connection_context,
+        double score);
+
+bool module_redis_command_helper_sorted_set_add(
+        module_redis_connection_context_t *connection_context,
+        char **key,
+        size_t key_length,
+        module_redis_command_helper_sorted_set_add_flags_t flags,
+        module_redis_command_helper_sorted_set_score_member_t *score_members,
+        uint32_t score_members_count);
+
+bool module_redis_command_helper_sorted_set_rank(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length,
+        char *member,
+        size_t member_length,
+        bool reverse);
+
+bool module_redis_command_helper_sorted_set_range(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length,
+        module_redis_short_string_t *start,
+        module_redis_short_string_t *stop,
+        bool by_score,
+        bool reverse,
+        bool has_limit,
+        int64_t limit_offset,
+        int64_t limit_count,
+        bool with_scores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SORTED_SET_H
@@ -0,0 +1,83 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_command_helper_value_type.h"
+
+#define TAG "module_redis_command_helper_value_type"
+
+bool module_redis_command_helper_value_type_error_wrongtype(
+        module_redis_connection_context_t *connection_context) {
+    return module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "WRONGTYPE Operation against a key holding the wrong kind of value");
+}
+
+bool module_redis_command_helper_value_type_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_entry_index_value_type_t value_type,
+        char *buffer,
+        size_t buffer_length,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key) {
+    storage_db_chunk_sequence_t chunk_sequence = { 0 };
+
+    if (unlikely(!storage_db_chunk_sequence_allocate(db, &chunk_sequence, buffer_length))) {
+        return false;
+    }
+
+    if (unlikely(!storage_db_chunk_sequence_write_all(db, &chunk_sequence, buffer, buffer_length))) {
+        storage_db_chunk_sequence_free_chunks(db, &chunk_sequence);
+        return false;
+    }
+
+    if (unlikely(!storage_db_op_rmw_commit_update(
+            db,
+            rmw_status,
+            value_type,
+            &chunk_sequence,
+            expiry_time_ms))) {
+        storage_db_chunk_sequence_free_chunks(db, &chunk_sequence);
+        return false;
+    }
+
+    // The ownership of the key is always taken by the hashtable when the entry is updated
+    *key = NULL;
+
+    return true;
+}
@@ -0,0 +1,24 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_VALUE_TYPE_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_VALUE_TYPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool module_redis_command_helper_value_type_error_wrongtype(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_command_helper_value_type_commit(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_entry_index_value_type_t value_type,
+        char *buffer,
+        size_t buffer_length,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        char **key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_VALUE_TYPE_H
@@ -40,6 +40,7 @@
 #include "storage/db/storage_db.h"
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_append"
 
@@ -85,6 +86,13 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(append) {
                 current_entry_index);
     }
 
+    if (unlikely(current_entry_index &&
+            current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
     if (likely(current_entry_index)) {
         destination_chunk_sequence_length += current_entry_index->value.size;
         chunk_sequences_to_splice[0] = &current_entry_index->value;
@@ -0,0 +1,164 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_bitmap.h"
+
+#define TAG "module_redis_command_bitcount"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(bitcount) {
+    bool return_res = false;
+    bool bit_unit = false;
+    int64_t start = 0, end = -1;
+    uint64_t count = 0;
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_bitcount_context_t *context = connection_context->command.context;
+
+    // The range is optional but if passed it must contain both the start and the end and, optionally, the unit
+    if (context->range.count == 1 || context->range.count > 3) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR syntax error");
+    }
+
+    if (context->range.count >= 2) {
+        if (!module_redis_command_helper_bitmap_parse_int64(
+                context->range.list[0].short_string,
+                context->range.list[0].length,
+                &start) ||
+            !module_redis_command_helper_bitmap_parse_int64(
+                context->range.list[1].short_string,
+                context->range.list[1].length,
+                &end)) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR value is not an integer or out of range");
+        }
+    }
+
+    if (context->range.count == 3 && !module_redis_command_helper_bitmap_parse_range_unit(
+            context->range.list[2].short_string,
+            context->range.list[2].length,
+            &bit_unit)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR syntax error");
+    }
+
+    transaction_t transaction = { 0 };
+    transaction_acquire(&transaction);
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            connection_context->database_number,
+            &transaction,
+            context->key.value.key,
+            context->key.value.length);
+
+    transaction_release(&transaction);
+
+    if (!entry_index) {
+        return_res = module_redis_connection_send_number(connection_context, 0);
+        goto end;
+    }
+
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    int64_t total_length = (int64_t)entry_index->value.size * (bit_unit ? 8 : 1);
+    if (!module_redis_command_helper_bitmap_normalize_range(total_length, &start, &end)) {
+        return_res = module_redis_connection_send_number(connection_context, 0);
+        goto end;
+    }
+
+    uint64_t start_byte = bit_unit ? start >> 3 : start;
+    uint64_t end_byte = bit_unit ? end >> 3 : end;
+
+    if (unlikely(!module_redis_command_helper_bitmap_count(
+            connection_context->db,
+            &entry_index->value,
+            start_byte,
+            end_byte + 1,
+            &count))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR bitcount failed");
+        goto end;
+    }
+
+    // With the bit unit the bits of the first and of the last byte outside the range have to be discounted
+    if (bit_unit) {
+        uint8_t first_byte, last_byte;
+        uint8_t first_byte_mask = (uint8_t)~(0xFF >> (start & 7));
+        uint8_t last_byte_mask = (uint8_t)(0xFF >> ((end & 7) + 1));
+
+        if (unlikely(!module_redis_command_helper_bitmap_read(
+                connection_context->db,
+                &entry_index->value,
+                start_byte,
+                &first_byte,
+                1) || !module_redis_command_helper_bitmap_read(
+                connection_context->db,
+                &entry_index->value,
+                end_byte,
+                &last_byte,
+                1))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR bitcount failed");
+            goto end;
+        }
+
+        count -= __builtin_popcount(first_byte & first_byte_mask);
+        count -= __builtin_popcount(last_byte & last_byte_mask);
+    }
+
+    return_res = module_redis_connection_send_number(connection_context, (int64_t)count);
+
+end:
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
@@ -0,0 +1,536 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_bitmap.h"
+
+#define TAG "module_redis_command_bitfield"
+
+// A field can span at most 9 bytes, when it's 64 bits long and doesn't start at the beginning of a byte
+#define MODULE_REDIS_COMMAND_BITFIELD_FIELD_MAX_BYTES   (9)
+
+enum module_redis_command_bitfield_op_type {
+    MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_GET,
+    MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_SET,
+    MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_INCRBY,
+};
+typedef enum module_redis_command_bitfield_op_type module_redis_command_bitfield_op_type_t;
+
+enum module_redis_command_bitfield_overflow {
+    MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_WRAP,
+    MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_SAT,
+    MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_FAIL,
+};
+typedef enum module_redis_command_bitfield_overflow module_redis_command_bitfield_overflow_t;
+
+typedef struct module_redis_command_bitfield_op module_redis_command_bitfield_op_t;
+struct module_redis_command_bitfield_op {
+    module_redis_command_bitfield_op_type_t type;
+    module_redis_command_bitfield_overflow_t overflow;
+    bool is_signed;
+    uint8_t bits;
+    uint64_t bit_offset;
+    int64_t value;
+    bool result_is_null;
+    int64_t result;
+};
+
+static bool module_redis_command_bitfield_parse_type(
+        module_redis_short_string_t *type,
+        bool *is_signed,
+        uint8_t *bits) {
+    int64_t number;
+
+    if (type->length < 2 || (tolower(type->short_string[0]) != 'i' && tolower(type->short_string[0]) != 'u')) {
+        return false;
+    }
+
+    *is_signed = tolower(type->short_string[0]) == 'i';
+
+    if (!module_redis_command_helper_bitmap_parse_int64(type->short_string + 1, type->length - 1, &number)) {
+        return false;
+    }
+
+    // As in Redis the unsigned fields are limited to 63 bits as the values are returned as signed 64 bit integers
+    if (number < 1 || number > (*is_signed ? 64 : 63)) {
+        return false;
+    }
+
+    *bits = (uint8_t)number;
+
+    return true;
+}
+
+static bool module_redis_command_bitfield_parse_offset(
+        module_redis_short_string_t *offset,
+        uint8_t bits,
+        uint64_t *bit_offset) {
+    int64_t number;
+    bool multiply_by_bits = offset->length > 0 && offset->short_string[0] == '#';
+
+    // The offsets prefixed by # are expressed in multiples of the size of the field
+    if (!module_redis_command_helper_bitmap_parse_int64(
+            offset->short_string + (multiply_by_bits ? 1 : 0),
+            offset->length - (multiply_by_bits ? 1 : 0),
+            &number) || number < 0) {
+        return false;
+    }
+
+    if (multiply_by_bits) {
+        if ((uint64_t)number > MODULE_REDIS_COMMAND_HELPER_BITMAP_BIT_OFFSET_MAX / bits) {
+            return false;
+        }
+
+        number *= bits;
+    }
+
+    if ((uint64_t)number + bits - 1 > MODULE_REDIS_COMMAND_HELPER_BITMAP_BIT_OFFSET_MAX) {
+        return false;
+    }
+
+    *bit_offset = (uint64_t)number;
+
+    return true;
+}
+
+static uint64_t module_redis_command_bitfield_field_get(
+        uint8_t *field_bytes,
+        uint64_t bit_offset,
+        uint8_t bits) {
+    uint64_t value = 0;
+
+    for(uint8_t index = 0; index < bits; index++) {
+        uint64_t bit = (bit_offset & 7) + index;
+        value = (value << 1) | ((field_bytes[bit >> 3] >> (7 - (bit & 7))) & 1);
+    }
+
+    return value;
+}
+
+static void module_redis_command_bitfield_field_set(
+        uint8_t *field_bytes,
+        uint64_t bit_offset,
+        uint8_t bits,
+        uint64_t value) {
+    for(uint8_t index = 0; index < bits; index++) {
+        uint64_t bit = (bit_offset & 7) + index;
+        uint8_t bit_mask = 1 << (7 - (bit & 7));
+
+        if ((value >> (bits - 1 - index)) & 1) {
+            field_bytes[bit >> 3] |= bit_mask;
+        } else {
+            field_bytes[bit >> 3] &= ~bit_mask;
+        }
+    }
+}
+
+static int64_t module_redis_command_bitfield_to_int64(
+        uint64_t value,
+        bool is_signed,
+        uint8_t bits) {
+    // The value is truncated to the size of the field and, if signed, sign extended
+    if (bits < 64) {
+        value &= (((uint64_t)1) << bits) - 1;
+
+        if (is_signed && (value >> (bits - 1)) & 1) {
+            value |= UINT64_MAX << bits;
+        }
+    }
+
+    return (int64_t)value;
+}
+
+static bool module_redis_command_bitfield_apply_increment(
+        module_redis_command_bitfield_op_t *op,
+        int64_t value,
+        int64_t increment,
+        int64_t *result) {
+    bool overflow = false, underflow = false;
+
+    if (op->is_signed) {
+        int64_t sum;
+        int64_t max = op->bits == 64 ? INT64_MAX : (int64_t)((((uint64_t)1) << (op->bits - 1)) - 1);
+        int64_t min = -max - 1;
+
+        if (__builtin_add_overflow(value, increment, &sum)) {
+            overflow = increment > 0;
+            underflow = increment < 0;
+        } else {
+            overflow = sum > max;
+            underflow = sum < min;
+        }
+
+        if (op->overflow == MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_SAT && (overflow || underflow)) {
+            *result = overflow ? max : min;
+            return true;
+        }
+    } else {
+        uint64_t sum;
+        uint64_t max = (((uint64_t)1) << op->bits) - 1;
+
+        // The value passed to SET is checked as an increment of 0, a negative value is treated as a huge unsigned one
+        if ((uint64_t)value > max) {
+            overflow = true;
+        } else if (increment >= 0) {
+            overflow = __builtin_add_overflow((uint64_t)value, (uint64_t)increment, &sum) || sum > max;
+        } else {
+            underflow = (uint64_t)0 - (uint64_t)increment > (uint64_t)value;
+        }
+
+        if (op->overflow == MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_SAT && (overflow || underflow)) {
+            *result = overflow ? (int64_t)max : 0;
+            return true;
+        }
+    }
+
+    if (op->overflow == MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_FAIL && (overflow || underflow)) {
+        return false;
+    }
+
+    *result = module_redis_command_bitfield_to_int64(
+            (uint64_t)value + (uint64_t)increment,
+            op->is_signed,
+            op->bits);
+
+    return true;
+}
+
+static bool module_redis_command_bitfield_parse(
+        module_redis_command_bitfield_context_t *context,
+        module_redis_command_bitfield_op_t *ops,
+        uint32_t *ops_count,
+        bool *has_writes,
+        char **error_message) {
+    module_redis_command_bitfield_overflow_t overflow = MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_WRAP;
+    module_redis_short_string_t *arguments = context->operation.list;
+    int arguments_count = context->operation.count;
+
+    *ops_count = 0;
+    *has_writes = false;
+
+    for(int index = 0; index < arguments_count;) {
+        module_redis_short_string_t *subcommand = &arguments[index];
+        module_redis_command_bitfield_op_t *op = &ops[*ops_count];
+        int required_arguments;
+
+        if (subcommand->length == 8 && strncasecmp(subcommand->short_string, "OVERFLOW", subcommand->length) == 0) {
+            if (index + 1 >= arguments_count) {
+                *error_message = "ERR syntax error";
+                return false;
+            }
+
+            module_redis_short_string_t *type = &arguments[index + 1];
+            if (type->length == 4 && strncasecmp(type->short_string, "WRAP", type->length) == 0) {
+                overflow = MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_WRAP;
+            } else if (type->length == 3 && strncasecmp(type->short_string, "SAT", type->length) == 0) {
+                overflow = MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_SAT;
+            } else if (type->length == 4 && strncasecmp(type->short_string, "FAIL", type->length) == 0) {
+                overflow = MODULE_REDIS_COMMAND_BITFIELD_OVERFLOW_FAIL;
+            } else {
+                *error_message = "ERR Invalid OVERFLOW type specified";
+                return false;
+            }
+
+            index += 2;
+            continue;
+        }
+
+        if (subcommand->length == 3 && strncasecmp(subcommand->short_string, "GET", subcommand->length) == 0) {
+            op->type = MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_GET;
+            required_arguments = 2;
+        } else if (subcommand->length == 3 && strncasecmp(subcommand->short_string, "SET", subcommand->length) == 0) {
+            op->type = MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_SET;
+            required_arguments = 3;
+        } else if (subcommand->length == 6 &&
+                   strncasecmp(subcommand->short_string, "INCRBY", subcommand->length) == 0) {
+            op->type = MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_INCRBY;
+            required_arguments = 3;
+        } else {
+            *error_message = "ERR syntax error";
+            return false;
+        }
+
+        if (index + required_arguments >= arguments_count) {
+            *error_message = "ERR syntax error";
+            return false;
+        }
+
+        if (!module_redis_command_bitfield_parse_type(&arguments[index + 1], &op->is_signed, &op->bits)) {
+            *error_message = "ERR Invalid bitfield type. Use something like i16 u8. Note that u64 is not supported "
+                    "but i64 is.";
+            return false;
+        }
+
+        if (!module_redis_command_bitfield_parse_offset(&arguments[index + 2], op->bits, &op->bit_offset)) {
+            *error_message = "ERR bit offset is not an integer or out of range";
+            return false;
+        }
+
+        if (op->type != MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_GET) {
+            if (!module_redis_command_helper_bitmap_parse_int64(
+                    arguments[index + 3].short_string,
+                    arguments[index + 3].length,
+                    &op->value)) {
+                *error_message = "ERR value is not an integer or out of range";
+                return false;
+            }
+
+            *has_writes = true;
+        }
+
+        op->overflow = overflow;
+        op->result_is_null = false;
+        op->result = 0;
+
+        (*ops_count)++;
+        index += required_arguments + 1;
+    }
+
+    return true;
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(bitfield) {
+    bool return_res = false;
+    bool abort_rmw = false;
+    bool release_transaction = false;
+    bool has_writes = false;
+    uint32_t ops_count = 0, patches_count = 0;
+    char *error_message = NULL;
+    size_t destination_size = 0;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_chunk_sequence_t *current_chunk_sequence = NULL;
+    storage_db_expiry_time_ms_t expiry_time_ms = STORAGE_DB_ENTRY_NO_EXPIRY;
+    module_redis_command_bitfield_op_t *ops = NULL;
+    module_redis_command_helper_bitmap_patch_t *patches = NULL;
+    module_redis_command_bitfield_context_t *context = connection_context->command.context;
+
+    // Every operation takes at least 3 arguments, the number of arguments is an upper bound for the operations
+    ops = xalloc_alloc(sizeof(module_redis_command_bitfield_op_t) * (context->operation.count + 1));
+
+    if (!module_redis_command_bitfield_parse(context, ops, &ops_count, &has_writes, &error_message)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "%s",
+                error_message);
+        goto end;
+    }
+
+    transaction_acquire(&transaction);
+    release_transaction = true;
+
+    // The key is locked for writing only if at least one of the operations changes the value
+    if (has_writes) {
+        if (unlikely(!storage_db_op_rmw_begin(
+                connection_context->db,
+                &transaction,
+                connection_context->database_number,
+                context->key.value.key,
+                context->key.value.length,
+                &rmw_status,
+                &current_entry_index))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR bitfield failed");
+            goto end;
+        }
+
+        abort_rmw = true;
+
+        if (current_entry_index) {
+            current_entry_index = storage_db_op_rmw_current_entry_index_prep_for_read(
+                    connection_context->db,
+                    &rmw_status,
+                    current_entry_index);
+        }
+    } else {
+        current_entry_index = storage_db_get_entry_index_for_read(
+                connection_context->db,
+                connection_context->database_number,
+                &transaction,
+                context->key.value.key,
+                context->key.value.length);
+
+        transaction_release(&transaction);
+        release_transaction = false;
+    }
+
+    if (current_entry_index) {
+        if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+            return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+            goto end;
+        }
+
+        current_chunk_sequence = &current_entry_index->value;
+        destination_size = current_chunk_sequence->size;
+        expiry_time_ms = current_entry_index->expiry_time_ms;
+    }
+
+    // The changes are tracked as a list of patched bytes that overlay the current value, applied in order
+    patches = xalloc_alloc(sizeof(module_redis_command_helper_bitmap_patch_t) *
+            MODULE_REDIS_COMMAND_BITFIELD_FIELD_MAX_BYTES * (ops_count + 1));
+
+    for(uint32_t op_index = 0; op_index < ops_count; op_index++) {
+        module_redis_command_bitfield_op_t *op = &ops[op_index];
+        uint8_t field_bytes[MODULE_REDIS_COMMAND_BITFIELD_FIELD_MAX_BYTES];
+        uint64_t first_byte_offset = op->bit_offset >> 3;
+        uint64_t last_byte_offset = (op->bit_offset + op->bits - 1) >> 3;
+        size_t field_bytes_count = last_byte_offset - first_byte_offset + 1;
+
+        if (unlikely(!module_redis_command_helper_bitmap_read(
+                connection_context->db,
+                current_chunk_sequence,
+                first_byte_offset,
+                field_bytes,
+                field_bytes_count))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR bitfield failed");
+            goto end;
+        }
+
+        for(uint32_t patch_index = 0; patch_index < patches_count; patch_index++) {
+            if (patches[patch_index].byte_offset >= first_byte_offset &&
+                patches[patch_index].byte_offset <= last_byte_offset) {
+                field_bytes[patches[patch_index].byte_offset - first_byte_offset] = patches[patch_index].value;
+            }
+        }
+
+        int64_t current_value = module_redis_command_bitfield_to_int64(
+                module_redis_command_bitfield_field_get(field_bytes, op->bit_offset, op->bits),
+                op->is_signed,
+                op->bits);
+
+        if (op->type == MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_GET) {
+            op->result = current_value;
+            continue;
+        }
+
+        int64_t new_value;
+        if (!module_redis_command_bitfield_apply_increment(
+                op,
+                op->type == MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_SET ? op->value : current_value,
+                op->type == MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_SET ? 0 : op->value,
+                &new_value)) {
+            op->result_is_null = true;
+            continue;
+        }
+
+        // SET returns the previous value, INCRBY the new one
+        op->result = op->type == MODULE_REDIS_COMMAND_BITFIELD_OP_TYPE_SET ? current_value : new_value;
+
+        module_redis_command_bitfield_field_set(field_bytes, op->bit_offset, op->bits, (uint64_t)new_value);
+
+        for(size_t byte_index = 0; byte_index < field_bytes_count; byte_index++) {
+            patches[patches_count].byte_offset = first_byte_offset + byte_index;
+            patches[patches_count].value = field_bytes[byte_index];
+            patches_count++;
+        }
+
+        destination_size = MAX(destination_size, last_byte_offset + 1);
+    }
+
+    if (has_writes) {
+        if (patches_count > 0) {
+            if (unlikely(!module_redis_command_helper_bitmap_write(
+                    connection_context->db,
+                    &rmw_status,
+                    current_chunk_sequence,
+                    destination_size,
+                    patches,
+                    patches_count,
+                    expiry_time_ms,
+                    &context->key.value.key))) {
+                return_res = module_redis_connection_error_message_printf_noncritical(
+                        connection_context,
+                        "ERR bitfield failed");
+                goto end;
+            }
+        } else {
+            storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+        }
+
+        abort_rmw = false;
+
+        transaction_release(&transaction);
+        release_transaction = false;
+    }
+
+    if (unlikely(!module_redis_connection_send_array(connection_context, ops_count))) {
+        goto end;
+    }
+
+    for(uint32_t op_index = 0; op_index < ops_count; op_index++) {
+        return_res = ops[op_index].result_is_null
+                ? module_redis_connection_send_string_null(connection_context)
+                : module_redis_connection_send_number(connection_context, ops[op_index].result);
+
+        if (unlikely(!return_res)) {
+            goto end;
+        }
+    }
+
+    return_res = true;
+
+end:
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    if (current_entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+    }
+
+    if (patches) {
+        xalloc_free(patches);
+    }
+
+    xalloc_free(ops);
+
+    return return_res;
+}
@@ -0,0 +1,267 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_bitmap.h"
+#include "utils_bitmap.h"
+
+#define TAG "module_redis_command_bitop"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(bitop) {
+    bool return_res = false;
+    utils_bitmap_op_t op;
+    size_t destination_size = 0;
+    uint8_t *buffer = NULL;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_entry_index_t **source_entry_indexes = NULL;
+    storage_db_chunk_sequence_t destination_chunk_sequence = { 0 };
+    module_redis_command_bitop_context_t *context = connection_context->command.context;
+    char *operation = context->operation.value.short_string;
+    size_t operation_length = context->operation.value.length;
+
+    if (operation_length == 3 && strncasecmp(operation, "AND", operation_length) == 0) {
+        op = UTILS_BITMAP_OP_AND;
+    } else if (operation_length == 2 && strncasecmp(operation, "OR", operation_length) == 0) {
+        op = UTILS_BITMAP_OP_OR;
+    } else if (operation_length == 3 && strncasecmp(operation, "XOR", operation_length) == 0) {
+        op = UTILS_BITMAP_OP_XOR;
+    } else if (operation_length == 3 && strncasecmp(operation, "NOT", operation_length) == 0) {
+        op = UTILS_BITMAP_OP_NOT;
+    } else {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR syntax error");
+    }
+
+    if (op == UTILS_BITMAP_OP_NOT && context->key.count != 1) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR BITOP NOT must be called with a single source key.");
+    }
+
+    // All the source keys are acquired for read upfront, a missing key is treated as an empty string
+    source_entry_indexes = xalloc_alloc_zero(sizeof(storage_db_entry_index_t*) * context->key.count);
+
+    transaction_acquire(&transaction);
+    for(int index = 0; index < context->key.count; index++) {
+        source_entry_indexes[index] = storage_db_get_entry_index_for_read(
+                connection_context->db,
+                connection_context->database_number,
+                &transaction,
+                context->key.list[index].key,
+                context->key.list[index].length);
+    }
+    transaction_release(&transaction);
+
+    for(int index = 0; index < context->key.count; index++) {
+        if (!source_entry_indexes[index]) {
+            continue;
+        }
+
+        if (unlikely(source_entry_indexes[index]->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+            return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+            goto end;
+        }
+
+        destination_size = MAX(destination_size, source_entry_indexes[index]->value.size);
+    }
+
+    // The destination is built chunk by chunk, before locking the destination key, combining with the vectorized
+    // kernels the data of each source chunk directly from the storage so the values are never concatenated
+    if (unlikely(!storage_db_chunk_sequence_allocate(
+            connection_context->db,
+            &destination_chunk_sequence,
+            destination_size))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR bitop failed");
+        goto end;
+    }
+
+    if (destination_size > 0) {
+        buffer = xalloc_alloc(STORAGE_DB_CHUNK_MAX_SIZE);
+    }
+
+    uint64_t chunk_byte_offset = 0;
+    for(
+            storage_db_chunk_index_t chunk_index = 0;
+            chunk_index < destination_chunk_sequence.count;
+            chunk_index++) {
+        storage_db_chunk_info_t *destination_chunk_info = storage_db_chunk_sequence_get(
+                &destination_chunk_sequence,
+                chunk_index);
+        size_t chunk_length = destination_chunk_info->chunk_length;
+
+        if (unlikely(!module_redis_command_helper_bitmap_read(
+                connection_context->db,
+                source_entry_indexes[0] ? &source_entry_indexes[0]->value : NULL,
+                chunk_byte_offset,
+                buffer,
+                chunk_length))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR bitop failed");
+            goto end;
+        }
+
+        if (op == UTILS_BITMAP_OP_NOT) {
+            utils_bitmap_bitop(op, buffer, buffer, chunk_length);
+        }
+
+        for(int index = 1; index < context->key.count; index++) {
+            size_t source_size = source_entry_indexes[index] ? source_entry_indexes[index]->value.size : 0;
+            size_t source_length = source_size > chunk_byte_offset
+                    ? MIN(chunk_length, source_size - chunk_byte_offset)
+                    : 0;
+
+            if (source_length > 0) {
+                bool allocated_new_buffer = false;
+                char *source_data = storage_db_get_chunk_data(
+                        connection_context->db,
+                        storage_db_chunk_sequence_get(&source_entry_indexes[index]->value, chunk_index),
+                        &allocated_new_buffer);
+
+                if (unlikely(!source_data)) {
+                    return_res = module_redis_connection_error_message_printf_noncritical(
+                            connection_context,
+                            "ERR bitop failed");
+                    goto end;
+                }
+
+                utils_bitmap_bitop(op, buffer, (uint8_t*)source_data, source_length);
+
+                if (allocated_new_buffer) {
+                    xalloc_free(source_data);
+                }
+            }
+
+            // The shorter sources are zero padded, only the AND is affected by the padding
+            if (op == UTILS_BITMAP_OP_AND && source_length < chunk_length) {
+                memset(buffer + source_length, 0, chunk_length - source_length);
+            }
+        }
+
+        if (unlikely(!storage_db_chunk_write(
+                connection_context->db,
+                destination_chunk_info,
+                0,
+                (char*)buffer,
+                chunk_length))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR bitop failed");
+            goto end;
+        }
+
+        chunk_byte_offset += chunk_length;
+    }
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            context->destkey.value.key,
+            context->destkey.value.length,
+            &rmw_status,
+            &current_entry_index))) {
+        transaction_release(&transaction);
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR bitop failed");
+        goto end;
+    }
+
+    // As in Redis the destination key is deleted if the result is empty and it's always overwritten otherwise
+    if (destination_size == 0) {
+        if (current_entry_index) {
+            storage_db_op_rmw_commit_delete(connection_context->db, &rmw_status);
+        } else {
+            storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+        }
+    } else {
+        if (unlikely(!storage_db_op_rmw_commit_update(
+                connection_context->db,
+                &rmw_status,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+                &destination_chunk_sequence,
+                STORAGE_DB_ENTRY_NO_EXPIRY))) {
+            storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+            transaction_release(&transaction);
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR bitop failed");
+            goto end;
+        }
+
+        context->destkey.value.key = NULL;
+        destination_chunk_sequence.sequence = NULL;
+    }
+
+    transaction_release(&transaction);
+
+    return_res = module_redis_connection_send_number(connection_context, (int64_t)destination_size);
+
+end:
+
+    if (buffer) {
+        xalloc_free(buffer);
+    }
+
+    if (source_entry_indexes) {
+        for(int index = 0; index < context->key.count; index++) {
+            if (source_entry_indexes[index]) {
+                storage_db_entry_index_status_decrease_readers_counter(source_entry_indexes[index], NULL);
+            }
+        }
+
+        xalloc_free(source_entry_indexes);
+    }
+
+    if (unlikely(destination_chunk_sequence.sequence)) {
+        storage_db_chunk_sequence_free_chunks(connection_context->db, &destination_chunk_sequence);
+    }
+
+    return return_res;
+}
@@ -0,0 +1,210 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_bitmap.h"
+
+#define TAG "module_redis_command_bitpos"
+
+static int module_redis_command_bitpos_find_in_byte(
+        uint8_t byte,
+        uint8_t ignore_mask,
+        bool bit) {
+    // The bits to ignore are set to the opposite of the bit searched, the bits are numbered from the most significant
+    byte = bit ? byte & ~ignore_mask : byte | ignore_mask;
+    byte = bit ? byte : ~byte;
+
+    return byte == 0 ? -1 : __builtin_clz((uint32_t)byte) - 24;
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(bitpos) {
+    bool return_res = false;
+    bool bit_unit = false, end_given = false;
+    int64_t bit, start = 0, end = -1, position = -1;
+    uint8_t byte;
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_bitpos_context_t *context = connection_context->command.context;
+
+    if (!module_redis_command_helper_bitmap_parse_int64(
+            context->bit.value.short_string,
+            context->bit.value.length,
+            &bit) || (bit != 0 && bit != 1)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR The bit argument must be 1 or 0.");
+    }
+
+    if (context->range.count > 3) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR syntax error");
+    }
+
+    if ((context->range.count >= 1 && !module_redis_command_helper_bitmap_parse_int64(
+            context->range.list[0].short_string,
+            context->range.list[0].length,
+            &start)) ||
+        (context->range.count >= 2 && !module_redis_command_helper_bitmap_parse_int64(
+            context->range.list[1].short_string,
+            context->range.list[1].length,
+            &end))) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR value is not an integer or out of range");
+    }
+
+    if (context->range.count == 3 && !module_redis_command_helper_bitmap_parse_range_unit(
+            context->range.list[2].short_string,
+            context->range.list[2].length,
+            &bit_unit)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR syntax error");
+    }
+
+    end_given = context->range.count >= 2;
+
+    transaction_t transaction = { 0 };
+    transaction_acquire(&transaction);
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            connection_context->database_number,
+            &transaction,
+            context->key.value.key,
+            context->key.value.length);
+
+    transaction_release(&transaction);
+
+    // A missing key is considered an empty string, as it's zero padded the first clear bit is always the first one
+    if (!entry_index) {
+        return_res = module_redis_connection_send_number(connection_context, bit ? -1 : 0);
+        goto end;
+    }
+
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    int64_t total_length = (int64_t)entry_index->value.size * (bit_unit ? 8 : 1);
+    if (!module_redis_command_helper_bitmap_normalize_range(total_length, &start, &end)) {
+        return_res = module_redis_connection_send_number(connection_context, -1);
+        goto end;
+    }
+
+    uint64_t start_byte = bit_unit ? start >> 3 : start;
+    uint64_t end_byte = bit_unit ? end >> 3 : end;
+    uint8_t first_byte_ignore_mask = bit_unit ? (uint8_t)~(0xFF >> (start & 7)) : 0;
+    uint8_t last_byte_ignore_mask = bit_unit ? (uint8_t)(0xFF >> ((end & 7) + 1)) : 0;
+
+    // The first and the last bytes might be partially part of the range so they are checked on their own, the bytes
+    // in between are scanned chunk by chunk skipping a word at time the ones that can't contain the bit
+    if (unlikely(!module_redis_command_helper_bitmap_read(
+            connection_context->db,
+            &entry_index->value,
+            start_byte,
+            &byte,
+            1))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR bitpos failed");
+        goto end;
+    }
+
+    int bit_index = module_redis_command_bitpos_find_in_byte(
+            byte,
+            first_byte_ignore_mask | (start_byte == end_byte ? last_byte_ignore_mask : 0),
+            bit);
+
+    if (bit_index >= 0) {
+        position = (int64_t)(start_byte * 8) + bit_index;
+    } else if (start_byte < end_byte) {
+        uint64_t found_byte_offset;
+
+        if (unlikely(!module_redis_command_helper_bitmap_find(
+                connection_context->db,
+                &entry_index->value,
+                start_byte + 1,
+                end_byte,
+                bit,
+                &found_byte_offset))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR bitpos failed");
+            goto end;
+        }
+
+        uint8_t ignore_mask = found_byte_offset == end_byte ? last_byte_ignore_mask : 0;
+
+        if (unlikely(!module_redis_command_helper_bitmap_read(
+                connection_context->db,
+                &entry_index->value,
+                found_byte_offset,
+                &byte,
+                1))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR bitpos failed");
+            goto end;
+        }
+
+        bit_index = module_redis_command_bitpos_find_in_byte(byte, ignore_mask, bit);
+
+        if (bit_index >= 0) {
+            position = (int64_t)(found_byte_offset * 8) + bit_index;
+        }
+    }
+
+    // As in Redis, when searching for a clear bit without an explicit end the value is considered padded with zeros
+    if (position == -1 && bit == 0 && !end_given) {
+        position = (int64_t)((end_byte + 1) * 8);
+    }
+
+    return_res = module_redis_connection_send_number(connection_context, position);
+
+end:
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
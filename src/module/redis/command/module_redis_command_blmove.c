@@ -0,0 +1,81 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_list/packed_list.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_list.h"
+
+#define TAG "module_redis_command_blmove"
+
+static bool module_redis_command_blmove_parse_where(
+        module_redis_short_string_t *where,
+        bool *head) {
+    if (where->length == 4 && strncasecmp(where->short_string, "LEFT", 4) == 0) {
+        *head = true;
+    } else if (where->length == 5 && strncasecmp(where->short_string, "RIGHT", 5) == 0) {
+        *head = false;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(blmove) {
+    bool from_head, to_head;
+    module_redis_command_blmove_context_t *context = connection_context->command.context;
+
+    if (unlikely(
+            !module_redis_command_blmove_parse_where(&context->wherefrom.value, &from_head) ||
+            !module_redis_command_blmove_parse_where(&context->whereto.value, &to_head))) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR syntax error");
+    }
+
+    return module_redis_command_helper_list_blocking_move(
+            connection_context,
+            &context->source.value,
+            1,
+            &context->destination.value,
+            from_head,
+            to_head,
+            context->timeout.value);
+}
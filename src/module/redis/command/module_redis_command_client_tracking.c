@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_pubsub.h"
+#include "module/redis/module_redis_tracking.h"
+
+#define TAG "module_redis_command_client_tracking"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(client_tracking) {
+    bool enable;
+    module_redis_command_client_tracking_context_t *context = connection_context->command.context;
+    module_redis_short_string_t *status = &context->status.value;
+
+    if (status->length == 2 && strncasecmp(status->short_string, "ON", status->length) == 0) {
+        enable = true;
+    } else if (status->length == 3 && strncasecmp(status->short_string, "OFF", status->length) == 0) {
+        enable = false;
+    } else {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR syntax error");
+    }
+
+    if (!enable) {
+        module_redis_tracking_disable(connection_context);
+        return module_redis_connection_send_ok(connection_context);
+    }
+
+    if (context->prefix_prefix.has_token && !context->bcast_bcast.has_token) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR PREFIX option requires BCAST mode to be enabled");
+    }
+
+    if (connection_context->tracking.enabled && connection_context->tracking.bcast != context->bcast_bcast.has_token) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR You can't switch BCAST mode on/off before disabling tracking for this client, and then re-enabling it with a different mode.");
+    }
+
+    if (context->redirect_client_id.has_token && context->redirect_client_id.value <= 0) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR The client ID you want redirect to does not exist");
+    }
+
+    if (!module_redis_tracking_enable(
+            connection_context,
+            context->redirect_client_id.has_token ? (uint64_t)context->redirect_client_id.value : 0,
+            context->bcast_bcast.has_token,
+            context->noloop_noloop.has_token,
+            context->prefix_prefix.list,
+            context->prefix_prefix.count)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR The client ID you want redirect to does not exist");
+    }
+
+    return module_redis_connection_send_ok(connection_context);
+}
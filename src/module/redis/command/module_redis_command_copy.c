@@ -27,6 +27,8 @@
 #include "data_structures/hashtable/mcmp/hashtable.h"
 #include "data_structures/hashtable/mcmp/hashtable_op_set.h"
 #include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
 #include "protocol/redis/protocol_redis.h"
 #include "protocol/redis/protocol_redis_reader.h"
 #include "protocol/redis/protocol_redis_writer.h"
@@ -53,6 +55,7 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(copy) {
     storage_db_entry_index_t *entry_index_destination_current = NULL;
     storage_db_chunk_sequence_t *chunk_sequence_source = NULL;
     storage_db_chunk_sequence_t chunk_sequence_destination = { 0 };
+    sorted_set_t *sorted_set_destination = NULL;
     bool allocated_new_buffer = false;
     char *source_chunk_data = NULL;
 
@@ -104,6 +107,28 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(copy) {
         goto end;
     }
 
+    // The sorted sets are kept as data structures and not as chunks, the source sorted set is cloned
+    if (entry_index_source->value_type == STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET) {
+        sorted_set_destination = sorted_set_clone(entry_index_source->value_object);
+
+        if (unlikely(!storage_db_op_rmw_commit_update_value_object(
+                connection_context->db,
+                &rmw_status,
+                entry_index_source->value_type,
+                sorted_set_destination,
+                sorted_set_size(sorted_set_destination),
+                STORAGE_DB_ENTRY_NO_EXPIRY))) {
+            error_found = true;
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR copy failed");
+            goto end;
+        }
+
+        sorted_set_destination = NULL;
+        goto value_committed;
+    }
+
     chunk_sequence_source = &entry_index_source->value;
     if (unlikely(!storage_db_chunk_sequence_allocate(
             connection_context->db,
@@ -199,6 +224,7 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(copy) {
         goto end;
     }
 
+value_committed:
     abort_rmw = false;
     value_copied = true;
     return_res = true;
@@ -226,6 +252,11 @@ end:
         entry_index_source = NULL;
     }
 
+    if (unlikely(sorted_set_destination)) {
+        sorted_set_free(sorted_set_destination);
+        sorted_set_destination = NULL;
+    }
+
     if (unlikely(chunk_sequence_destination.sequence)) {
         storage_db_chunk_sequence_free_chunks(connection_context->db, &chunk_sequence_destination);
         chunk_sequence_destination.sequence = NULL;
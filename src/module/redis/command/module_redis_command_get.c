@@ -37,6 +37,7 @@
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
 #include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_get"
 
@@ -60,6 +61,14 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(get) {
         goto end;
     }
 
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+        entry_index = NULL;
+
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
     return_res = module_redis_command_stream_entry(
             connection_context->network_channel,
             connection_context->db,
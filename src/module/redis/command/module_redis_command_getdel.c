@@ -37,6 +37,7 @@
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
 #include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_getdel"
 
@@ -73,6 +74,17 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(getdel) {
                 current_entry_index);
     }
 
+    if (unlikely(current_entry_index &&
+            current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+        transaction_release(&transaction);
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+        current_entry_index = NULL;
+
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
     if (unlikely(!current_entry_index)) {
         storage_db_op_rmw_abort(connection_context->db, &rmw_status);
     } else {
@@ -37,6 +37,7 @@
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
 #include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_getex"
 
@@ -80,6 +81,14 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(getex) {
         return module_redis_connection_send_string_null(connection_context);
     }
 
+    if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+        current_entry_index = NULL;
+
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
     storage_db_expiry_time_ms_t expiry_time_ms = current_entry_index->expiry_time_ms;
 
     if (context->expiration.value.pxat_unix_time_milliseconds.has_token) {
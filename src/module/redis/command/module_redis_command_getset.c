@@ -37,6 +37,7 @@
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
 #include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_getset"
 
@@ -73,6 +74,17 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(getset) {
                 previous_entry_index);
     }
 
+    if (unlikely(previous_entry_index &&
+            previous_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+        transaction_release(&transaction);
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+
+        // The key and the value are still owned by the context and will be freed with it
+        storage_db_entry_index_status_decrease_readers_counter(previous_entry_index, NULL);
+        return return_res;
+    }
+
     if (unlikely(!storage_db_op_rmw_commit_update(
             connection_context->db,
             &rmw_status,
@@ -0,0 +1,212 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_hash.h"
+
+#define TAG "module_redis_command_hdel"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(hdel) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    bool allocated_new_buffer = false;
+    char *current_buffer = NULL;
+    int64_t deleted_count = 0;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    packed_hash_t packed_hash = { 0 };
+    packed_hash_builder_t builder = { 0 };
+    module_redis_command_hdel_context_t *context = connection_context->command.context;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            context->key.value.key,
+            context->key.value.length,
+            &rmw_status,
+            &current_entry_index))) {
+        abort_rmw = false;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    if (!current_entry_index) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+        abort_rmw = false;
+
+        transaction_release(&transaction);
+        release_transaction = false;
+
+        return_res = module_redis_connection_send_number(connection_context, 0);
+        goto end;
+    }
+
+    if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    // The large hashes are changed in place, the entries of the deleted fields are only flagged as deleted
+    if (module_redis_command_helper_hash_can_update_in_place(
+            connection_context->db,
+            &rmw_status,
+            0,
+            0,
+            0)) {
+        size_t previous_value_size = current_entry_index->value.size;
+
+        for(int index = 0; index < context->field.count; index++) {
+            bool deleted;
+
+            if (unlikely(!module_redis_command_helper_hash_delete_in_place(
+                    connection_context->db,
+                    &current_entry_index->value,
+                    0,
+                    context->field.list[index].short_string,
+                    context->field.list[index].length,
+                    &deleted))) {
+                return_res = module_redis_connection_error_message_printf_noncritical(
+                        connection_context,
+                        "ERR operation failed");
+                goto end;
+            }
+
+            if (deleted) {
+                deleted_count++;
+            }
+        }
+
+        if (deleted_count == 0) {
+            storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+        } else if (unlikely(!module_redis_command_helper_hash_commit_in_place(
+                connection_context->db,
+                &rmw_status,
+                0,
+                previous_value_size,
+                &context->key.value.key))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+
+        abort_rmw = false;
+
+        transaction_release(&transaction);
+        release_transaction = false;
+
+        return_res = module_redis_connection_send_number(connection_context, deleted_count);
+        goto end;
+    }
+
+    current_buffer = module_redis_command_helper_hash_read(
+            connection_context->db,
+            current_entry_index,
+            &packed_hash,
+            &allocated_new_buffer);
+
+    if (unlikely(current_buffer == NULL)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    packed_hash_builder_init(&builder, &packed_hash);
+
+    for(int index = 0; index < context->field.count; index++) {
+        if (packed_hash_builder_delete(
+                &builder,
+                context->field.list[index].short_string,
+                context->field.list[index].length)) {
+            deleted_count++;
+        }
+    }
+
+    // If nothing has been deleted there is no need to rewrite the hash
+    if (deleted_count == 0) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    } else if (unlikely(!module_redis_command_helper_hash_commit(
+            connection_context->db,
+            &rmw_status,
+            &builder,
+            current_entry_index->expiry_time_ms,
+            &context->key.value.key))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    abort_rmw = false;
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    return_res = module_redis_connection_send_number(connection_context, deleted_count);
+
+end:
+
+    if (builder.entries) {
+        packed_hash_builder_free(&builder);
+    }
+
+    if (allocated_new_buffer) {
+        xalloc_free(current_buffer);
+    }
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    return return_res;
+}
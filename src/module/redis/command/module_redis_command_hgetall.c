@@ -0,0 +1,125 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_hash.h"
+
+#define TAG "module_redis_command_hgetall"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(hgetall) {
+    bool return_res = false;
+    bool allocated_new_buffer = false;
+    char *buffer = NULL;
+    packed_hash_t packed_hash = { 0 };
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_hgetall_context_t *context = connection_context->command.context;
+
+    transaction_t transaction = { 0 };
+    transaction_acquire(&transaction);
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            connection_context->database_number,
+            &transaction,
+            context->key.value.key,
+            context->key.value.length);
+
+    transaction_release(&transaction);
+
+    if (unlikely(!entry_index)) {
+        return_res = module_redis_connection_send_array_header(connection_context, 0);
+        goto end;
+    }
+
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    buffer = module_redis_command_helper_hash_read(
+            connection_context->db,
+            entry_index,
+            &packed_hash,
+            &allocated_new_buffer);
+
+    if (unlikely(buffer == NULL)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(connection_context, (uint64_t)packed_hash.count * 2))) {
+        goto end;
+    }
+
+    size_t offset = 0;
+    packed_hash_entry_t entry;
+    while(packed_hash_iter_next(&packed_hash, &offset, &entry)) {
+        if (unlikely(!module_redis_connection_send_blob_string(
+                connection_context,
+                entry.field,
+                entry.field_length))) {
+            goto end;
+        }
+
+        if (unlikely(!module_redis_connection_send_blob_string(
+                connection_context,
+                entry.value,
+                entry.value_length))) {
+            goto end;
+        }
+    }
+
+    return_res = true;
+
+end:
+
+    if (allocated_new_buffer) {
+        xalloc_free(buffer);
+    }
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
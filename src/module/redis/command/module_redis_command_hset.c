@@ -0,0 +1,295 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_hash.h"
+#include "module/redis/command/helpers/module_redis_command_helper_long_string.h"
+
+#define TAG "module_redis_command_hset"
+
+static bool module_redis_command_hset_read_field_values(
+        storage_db_t *db,
+        module_redis_command_hset_context_t *context,
+        module_redis_command_helper_long_string_list_t *fields,
+        module_redis_command_helper_long_string_list_t *values) {
+    int count = context->field_value.count;
+
+    fields->list = xalloc_alloc(sizeof(module_redis_short_string_t) * count);
+    fields->allocated_new_buffer = xalloc_alloc(sizeof(bool) * count);
+    values->list = xalloc_alloc(sizeof(module_redis_short_string_t) * count);
+    values->allocated_new_buffer = xalloc_alloc(sizeof(bool) * count);
+
+    for(int index = 0; index < count; index++) {
+        module_redis_command_hset_context_subargument_field_value_t *field_value = &context->field_value.list[index];
+
+        if (unlikely(!module_redis_command_helper_long_string_read(
+                db,
+                &field_value->field.value,
+                &fields->list[index],
+                &fields->allocated_new_buffer[index]))) {
+            return false;
+        }
+        fields->count++;
+
+        if (unlikely(!module_redis_command_helper_long_string_read(
+                db,
+                &field_value->value.value,
+                &values->list[index],
+                &values->allocated_new_buffer[index]))) {
+            return false;
+        }
+        values->count++;
+    }
+
+    return true;
+}
+
+static bool module_redis_command_hset_can_update_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        module_redis_command_helper_long_string_list_t *fields,
+        module_redis_command_helper_long_string_list_t *values) {
+    size_t new_entries_length = 0;
+
+    // Every field is accounted as new, the changes applied in place can't fail half way because of lack of room
+    for(int index = 0; index < fields->count; index++) {
+        new_entries_length += packed_hash_entry_length(fields->list[index].length, values->list[index].length);
+    }
+
+    return module_redis_command_helper_hash_can_update_in_place(
+            db,
+            rmw_status,
+            0,
+            fields->count,
+            new_entries_length);
+}
+
+static bool module_redis_command_hset_update_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        module_redis_command_helper_long_string_list_t *fields,
+        module_redis_command_helper_long_string_list_t *values,
+        char **key,
+        int64_t *added_count) {
+    size_t previous_value_size = rmw_status->current_entry_index->value.size;
+
+    for(int index = 0; index < fields->count; index++) {
+        bool added;
+
+        if (unlikely(!module_redis_command_helper_hash_set_in_place(
+                db,
+                &rmw_status->current_entry_index->value,
+                0,
+                fields->list[index].short_string,
+                fields->list[index].length,
+                values->list[index].short_string,
+                values->list[index].length,
+                &added))) {
+            return false;
+        }
+
+        if (added) {
+            (*added_count)++;
+        }
+    }
+
+    return module_redis_command_helper_hash_commit_in_place(
+            db,
+            rmw_status,
+            0,
+            previous_value_size,
+            key);
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(hset) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    bool allocated_new_buffer = false;
+    char *current_buffer = NULL;
+    int64_t added_count = 0;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_expiry_time_ms_t expiry_time_ms = STORAGE_DB_ENTRY_NO_EXPIRY;
+    packed_hash_t packed_hash = { 0 };
+    packed_hash_builder_t builder = { 0 };
+    module_redis_command_helper_long_string_list_t fields = { 0 };
+    module_redis_command_helper_long_string_list_t values = { 0 };
+    module_redis_command_hset_context_t *context = connection_context->command.context;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            context->key.value.key,
+            context->key.value.length,
+            &rmw_status,
+            &current_entry_index))) {
+        abort_rmw = false;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    if (current_entry_index) {
+        if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET)) {
+            return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+            goto end;
+        }
+    }
+
+    // The fields and the values are received as long strings, they are read before building the new hash as the
+    // builder keeps a reference to them until the commit
+    if (unlikely(!module_redis_command_hset_read_field_values(
+            connection_context->db,
+            context,
+            &fields,
+            &values))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    // The large hashes are changed in place, touching only the buckets and the entries of the fields set, unless the
+    // table has to be rebuilt
+    if (current_entry_index && module_redis_command_hset_can_update_in_place(
+            connection_context->db,
+            &rmw_status,
+            &fields,
+            &values)) {
+        if (unlikely(!module_redis_command_hset_update_in_place(
+                connection_context->db,
+                &rmw_status,
+                &fields,
+                &values,
+                &context->key.value.key,
+                &added_count))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+
+        abort_rmw = false;
+
+        transaction_release(&transaction);
+        release_transaction = false;
+
+        return_res = module_redis_connection_send_number(connection_context, added_count);
+        goto end;
+    }
+
+    if (current_entry_index) {
+        expiry_time_ms = current_entry_index->expiry_time_ms;
+        current_buffer = module_redis_command_helper_hash_read(
+                connection_context->db,
+                current_entry_index,
+                &packed_hash,
+                &allocated_new_buffer);
+
+        if (unlikely(current_buffer == NULL)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+    }
+
+    packed_hash_builder_init(&builder, current_buffer ? &packed_hash : NULL);
+
+    for(int index = 0; index < context->field_value.count; index++) {
+        if (packed_hash_builder_set(
+                &builder,
+                fields.list[index].short_string,
+                fields.list[index].length,
+                values.list[index].short_string,
+                values.list[index].length)) {
+            added_count++;
+        }
+    }
+
+    if (unlikely(!module_redis_command_helper_hash_commit(
+            connection_context->db,
+            &rmw_status,
+            &builder,
+            expiry_time_ms,
+            &context->key.value.key))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    abort_rmw = false;
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    return_res = module_redis_connection_send_number(connection_context, added_count);
+
+end:
+
+    if (builder.entries) {
+        packed_hash_builder_free(&builder);
+    }
+
+    module_redis_command_helper_long_string_list_free(&fields);
+    module_redis_command_helper_long_string_list_free(&values);
+
+    if (allocated_new_buffer) {
+        xalloc_free(current_buffer);
+    }
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    return return_res;
+}
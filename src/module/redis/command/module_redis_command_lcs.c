@@ -34,12 +34,14 @@
 #include "network/io/network_io_common.h"
 #include "config.h"
 #include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
 #include "network/channel/network_channel.h"
 #include "storage/io/storage_io_common.h"
 #include "storage/channel/storage_channel.h"
 #include "storage/db/storage_db.h"
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_lcs"
 
@@ -85,6 +87,9 @@ uint32_t *lcsmap_build(
     value_1_chunk_index = -1;
     value_1_chunk_offset = -1;
     for(uint32_t value_1_char_index = 0; value_1_char_index <= value_1->size; value_1_char_index++) {
+        // Building the map is quadratic, let the other fibers run if it's taking long
+        fiber_scheduler_yield_if_time_slice_expired();
+
         value_1_chunk_offset++;
         if (unlikely(value_1_chunk_index == -1 || value_1_chunk_offset >= value_1_chunk_info->chunk_length)) {
             if (unlikely(value_1_chunk_data_allocated_new)) {
@@ -227,6 +232,12 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(lcs) {
         goto end;
     }
 
+    if (unlikely(entry_index_1->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING ||
+            entry_index_2->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
     if (entry_index_1->value.size == 0 || entry_index_2->value.size == 0) {
         goto end;
     }
@@ -235,6 +246,12 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(lcs) {
     storage_db_chunk_sequence_t *value_1 = &entry_index_1->value;
     storage_db_chunk_sequence_t *value_2 = &entry_index_2->value;
 
+    // The entry indexes are kept alive by the readers counters, the locks acquired to fetch them can be released to
+    // be able to yield while building the map without blocking the writers on the same worker. Within an EXEC the
+    // locks are handed over to the EXEC transaction instead and the map is built without yielding.
+    transaction_release(&transaction);
+    transaction_acquire(&transaction);
+
     // Build the lcs map
     lcsmap = lcsmap_build(connection_context->db, value_1, value_2);
 
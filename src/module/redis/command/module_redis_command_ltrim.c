@@ -0,0 +1,162 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_list/packed_list.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_list.h"
+
+#define TAG "module_redis_command_ltrim"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(ltrim) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    bool allocated_new_buffer = false;
+    char *current_buffer = NULL;
+    uint32_t range_start, range_stop;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    packed_list_t packed_list = { 0 };
+    packed_list_builder_t builder = { 0 };
+    module_redis_command_ltrim_context_t *context = connection_context->command.context;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            context->key.value.key,
+            context->key.value.length,
+            &rmw_status,
+            &current_entry_index))) {
+        abort_rmw = false;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    if (!current_entry_index) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+        abort_rmw = false;
+
+        transaction_release(&transaction);
+        release_transaction = false;
+
+        return_res = module_redis_connection_send_ok(connection_context);
+        goto end;
+    }
+
+    if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    current_buffer = module_redis_command_helper_list_read(
+            connection_context->db,
+            current_entry_index,
+            &packed_list,
+            &allocated_new_buffer);
+
+    if (unlikely(current_buffer == NULL)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    packed_list_builder_init(&builder, &packed_list);
+
+    if (!module_redis_command_helper_list_resolve_range(
+            packed_list.count,
+            context->start.value,
+            context->stop.value,
+            &range_start,
+            &range_stop)) {
+        // An empty range drops the whole list
+        storage_db_op_rmw_commit_delete(connection_context->db, &rmw_status);
+    } else if (range_start == 0 && range_stop == packed_list.count - 1) {
+        // Nothing to trim, no need to rewrite the list
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    } else {
+        packed_list_builder_trim(&builder, range_start, range_stop);
+
+        if (unlikely(!module_redis_command_helper_list_commit(
+                connection_context->db,
+                &rmw_status,
+                &builder,
+                current_entry_index->expiry_time_ms,
+                &context->key.value.key))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+    }
+
+    abort_rmw = false;
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    return_res = module_redis_connection_send_ok(connection_context);
+
+end:
+
+    if (builder.nodes) {
+        packed_list_builder_free(&builder);
+    }
+
+    if (allocated_new_buffer) {
+        xalloc_free(current_buffer);
+    }
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    return return_res;
+}
@@ -37,6 +37,7 @@
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
 #include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_mget"
 
@@ -59,6 +60,12 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(mget) {
                 context->key.list[index].key,
                 context->key.list[index].length);
 
+        // As in Redis, the keys holding a value that is not a string are reported as missing
+        if (likely(entry_index) && unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+            storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+            entry_index = NULL;
+        }
+
         if (unlikely(!entry_index)) {
             if (!module_redis_connection_send_string_null(connection_context)) {
                 goto end;
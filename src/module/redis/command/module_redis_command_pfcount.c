@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/hyperloglog/hyperloglog.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_hyperloglog.h"
+
+#define TAG "module_redis_command_pfcount"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(pfcount) {
+    bool return_res = false;
+    uint64_t cardinality = 0;
+    uint8_t *registers = NULL;
+    hyperloglog_encoding_t encoding;
+    module_redis_command_helper_hyperloglog_result_t result;
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_pfcount_context_t *context = connection_context->command.context;
+
+    transaction_t transaction = { 0 };
+
+    // With a single key the cardinality cached in the header is used, the HyperLogLogs written by cachegrand always
+    // have a valid one, the registers are read only if the value has been created elsewhere (e.g. loaded from an RDB)
+    if (context->key.count == 1) {
+        char *buffer = NULL;
+        bool allocated_new_buffer = false;
+
+        transaction_acquire(&transaction);
+        entry_index = storage_db_get_entry_index_for_read(
+                connection_context->db,
+                connection_context->database_number,
+                &transaction,
+                context->key.list[0].key,
+                context->key.list[0].length);
+        transaction_release(&transaction);
+
+        if (!entry_index) {
+            return module_redis_connection_send_number(connection_context, 0);
+        }
+
+        result = module_redis_command_helper_hyperloglog_read(
+                connection_context->db,
+                entry_index,
+                &buffer,
+                &allocated_new_buffer,
+                &encoding);
+
+        if (likely(result == MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK) &&
+            !hyperloglog_cached_cardinality(buffer, &cardinality)) {
+            registers = xalloc_alloc_zero(HYPERLOGLOG_REGISTERS_COUNT);
+
+            if (likely(hyperloglog_merge(registers, buffer, entry_index->value.size))) {
+                cardinality = hyperloglog_cardinality(registers);
+            } else {
+                result = MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_CORRUPTED;
+            }
+        }
+
+        if (allocated_new_buffer) {
+            xalloc_free(buffer);
+        }
+
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    } else {
+        // With multiple keys the HyperLogLogs are merged on the fly, as Redis does, without changing any of them
+        registers = xalloc_alloc_zero(HYPERLOGLOG_REGISTERS_COUNT);
+        result = MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK;
+
+        for(int index = 0; index < context->key.count; index++) {
+            transaction_acquire(&transaction);
+            entry_index = storage_db_get_entry_index_for_read(
+                    connection_context->db,
+                    connection_context->database_number,
+                    &transaction,
+                    context->key.list[index].key,
+                    context->key.list[index].length);
+            transaction_release(&transaction);
+
+            if (!entry_index) {
+                continue;
+            }
+
+            result = module_redis_command_helper_hyperloglog_merge(
+                    connection_context->db,
+                    entry_index,
+                    registers,
+                    &encoding);
+
+            storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+
+            if (unlikely(result != MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK)) {
+                break;
+            }
+        }
+
+        if (likely(result == MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK)) {
+            cardinality = hyperloglog_cardinality(registers);
+        }
+    }
+
+    if (unlikely(result != MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK)) {
+        return_res = module_redis_command_helper_hyperloglog_send_error(connection_context, result, "pfcount");
+    } else {
+        return_res = module_redis_connection_send_number(connection_context, (int64_t)cardinality);
+    }
+
+    if (registers) {
+        xalloc_free(registers);
+    }
+
+    return return_res;
+}
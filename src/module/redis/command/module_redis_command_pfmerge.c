@@ -0,0 +1,177 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/hyperloglog/hyperloglog.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_hyperloglog.h"
+
+#define TAG "module_redis_command_pfmerge"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(pfmerge) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_entry_index_t *source_entry_index = NULL;
+    storage_db_expiry_time_ms_t expiry_time_ms = STORAGE_DB_ENTRY_NO_EXPIRY;
+    hyperloglog_encoding_t encoding;
+    hyperloglog_encoding_t destination_encoding = HYPERLOGLOG_ENCODING_SPARSE;
+    module_redis_command_helper_hyperloglog_result_t result;
+    module_redis_command_pfmerge_context_t *context = connection_context->command.context;
+    uint8_t *registers = xalloc_alloc_zero(HYPERLOGLOG_REGISTERS_COUNT);
+
+    // The sources are merged before locking the destination key, the dense registers are unpacked and merged with the
+    // vectorized kernels
+    for(int index = 0; index < context->sourcekey.count; index++) {
+        transaction_acquire(&transaction);
+        source_entry_index = storage_db_get_entry_index_for_read(
+                connection_context->db,
+                connection_context->database_number,
+                &transaction,
+                context->sourcekey.list[index].key,
+                context->sourcekey.list[index].length);
+        transaction_release(&transaction);
+
+        if (!source_entry_index) {
+            continue;
+        }
+
+        result = module_redis_command_helper_hyperloglog_merge(
+                connection_context->db,
+                source_entry_index,
+                registers,
+                &encoding);
+
+        storage_db_entry_index_status_decrease_readers_counter(source_entry_index, NULL);
+
+        if (unlikely(result != MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK)) {
+            abort_rmw = false;
+            release_transaction = false;
+            return_res = module_redis_command_helper_hyperloglog_send_error(connection_context, result, "pfmerge");
+            goto end;
+        }
+
+        // As in Redis the result is dense if any of the HyperLogLogs merged is dense
+        if (encoding == HYPERLOGLOG_ENCODING_DENSE) {
+            destination_encoding = HYPERLOGLOG_ENCODING_DENSE;
+        }
+    }
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            context->destkey.value.key,
+            context->destkey.value.length,
+            &rmw_status,
+            &current_entry_index))) {
+        abort_rmw = false;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR pfmerge failed");
+        goto end;
+    }
+
+    if (current_entry_index) {
+        current_entry_index = storage_db_op_rmw_current_entry_index_prep_for_read(
+                connection_context->db,
+                &rmw_status,
+                current_entry_index);
+
+        result = module_redis_command_helper_hyperloglog_merge(
+                connection_context->db,
+                current_entry_index,
+                registers,
+                &encoding);
+
+        if (unlikely(result != MODULE_REDIS_COMMAND_HELPER_HYPERLOGLOG_RESULT_OK)) {
+            return_res = module_redis_command_helper_hyperloglog_send_error(connection_context, result, "pfmerge");
+            goto end;
+        }
+
+        if (encoding == HYPERLOGLOG_ENCODING_DENSE) {
+            destination_encoding = HYPERLOGLOG_ENCODING_DENSE;
+        }
+
+        expiry_time_ms = current_entry_index->expiry_time_ms;
+    }
+
+    if (unlikely(!module_redis_command_helper_hyperloglog_commit(
+            connection_context->db,
+            &rmw_status,
+            registers,
+            destination_encoding,
+            expiry_time_ms,
+            &context->destkey.value.key))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR pfmerge failed");
+        goto end;
+    }
+
+    abort_rmw = false;
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    return_res = module_redis_connection_send_ok(connection_context);
+
+end:
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    if (current_entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+    }
+
+    xalloc_free(registers);
+
+    return return_res;
+}
@@ -36,11 +36,34 @@
 #include "storage/db/storage_db.h"
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_pubsub.h"
 
 #define TAG "module_redis_command_ping"
 
 MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(ping) {
     module_redis_command_ping_context_t *context = connection_context->command.context;
+
+    // With RESP2 the subscribed connections get back an array, as for the messages
+    if (module_redis_pubsub_connection_is_subscribed(connection_context) &&
+        connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        size_t string_length = context->message.value.length + 32 > NETWORK_CHANNEL_MAX_PACKET_SIZE
+                ? NETWORK_CHANNEL_MAX_PACKET_SIZE - 32
+                : context->message.value.length;
+
+        if (!module_redis_connection_send_array_header(connection_context, 2)) {
+            return false;
+        }
+
+        if (!module_redis_connection_send_blob_string(connection_context, "pong", strlen("pong"))) {
+            return false;
+        }
+
+        return module_redis_connection_send_blob_string(
+                connection_context,
+                context->message.value.short_string ? context->message.value.short_string : "",
+                string_length);
+    }
+
     if (context->message.value.short_string) {
         size_t string_length = context->message.value.length + 32 > NETWORK_CHANNEL_MAX_PACKET_SIZE
                 ? NETWORK_CHANNEL_MAX_PACKET_SIZE - 32
@@ -0,0 +1,69 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_pubsub.h"
+#include "module/redis/command/helpers/module_redis_command_helper_long_string.h"
+
+#define TAG "module_redis_command_publish"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(publish) {
+    bool message_allocated_new_buffer = false;
+    module_redis_short_string_t message = { 0 };
+    module_redis_command_publish_context_t *context = connection_context->command.context;
+
+    if (unlikely(!module_redis_command_helper_long_string_read(
+            connection_context->db,
+            &context->message.value,
+            &message,
+            &message_allocated_new_buffer))) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+    }
+
+    // The message is encoded once into a new buffer shared by all the receivers, the one read here can be freed
+    uint32_t receivers_count = module_redis_pubsub_publish(
+            context->channel.value.short_string,
+            context->channel.value.length,
+            message.short_string,
+            message.length);
+
+    module_redis_command_helper_long_string_free(&message, message_allocated_new_buffer);
+
+    return module_redis_connection_send_number(connection_context, receivers_count);
+}
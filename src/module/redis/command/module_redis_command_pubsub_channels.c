@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_pubsub.h"
+
+#define TAG "module_redis_command_pubsub_channels"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(pubsub_channels) {
+    bool return_res = false;
+    uint32_t channels_count = 0;
+    module_redis_command_pubsub_channels_context_t *context = connection_context->command.context;
+
+    module_redis_short_string_t *channels = module_redis_pubsub_registry_get_channels(
+            context->pattern.value.pattern,
+            context->pattern.value.length,
+            &channels_count);
+
+    if (!module_redis_connection_send_array_header(connection_context, channels_count)) {
+        goto end;
+    }
+
+    for(uint32_t index = 0; index < channels_count; index++) {
+        if (!module_redis_connection_send_blob_string(
+                connection_context,
+                channels[index].short_string,
+                channels[index].length)) {
+            goto end;
+        }
+    }
+
+    return_res = true;
+
+end:
+    module_redis_pubsub_registry_free_channels(channels, channels_count);
+
+    return return_res;
+}
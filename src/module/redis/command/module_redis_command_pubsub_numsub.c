@@ -0,0 +1,68 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_pubsub.h"
+
+#define TAG "module_redis_command_pubsub_numsub"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(pubsub_numsub) {
+    module_redis_command_pubsub_numsub_context_t *context = connection_context->command.context;
+
+    if (!module_redis_connection_send_array_header(connection_context, context->channel.count * 2)) {
+        return false;
+    }
+
+    for(int index = 0; index < context->channel.count; index++) {
+        if (!module_redis_connection_send_blob_string(
+                connection_context,
+                context->channel.list[index].short_string,
+                context->channel.list[index].length)) {
+            return false;
+        }
+
+        if (!module_redis_connection_send_number(
+                connection_context,
+                module_redis_pubsub_registry_get_channel_subscribers_count(
+                        context->channel.list[index].short_string,
+                        context->channel.list[index].length))) {
+            return false;
+        }
+    }
+
+    return true;
+}
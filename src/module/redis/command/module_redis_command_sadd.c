@@ -0,0 +1,234 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "data_structures/packed_set/packed_set.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_set.h"
+#include "module/redis/command/helpers/module_redis_command_helper_long_string.h"
+
+#define TAG "module_redis_command_sadd"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(sadd) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    bool allocated_new_buffer = false;
+    char *current_buffer = NULL;
+    int64_t added_count = 0;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_expiry_time_ms_t expiry_time_ms = STORAGE_DB_ENTRY_NO_EXPIRY;
+    packed_set_t packed_set = { 0 };
+    packed_set_builder_t builder = { 0 };
+    bool builder_initialized = false;
+    module_redis_command_helper_long_string_list_t members = { 0 };
+    module_redis_command_sadd_context_t *context = connection_context->command.context;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            context->key.value.key,
+            context->key.value.length,
+            &rmw_status,
+            &current_entry_index))) {
+        abort_rmw = false;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    if (current_entry_index) {
+        if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET)) {
+            return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+            goto end;
+        }
+
+    }
+
+    if (unlikely(!module_redis_command_helper_long_string_list_read(
+            connection_context->db,
+            context->member.list,
+            context->member.count,
+            &members))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    if (current_entry_index) {
+        size_t new_entries_length = 0;
+        for(int index = 0; index < members.count; index++) {
+            new_entries_length += packed_hash_entry_length(members.list[index].length, 0);
+        }
+
+        // The large sets are changed in place, touching only the buckets and the entries of the members added
+        if (module_redis_command_helper_set_can_update_in_place(
+                connection_context->db,
+                &rmw_status,
+                members.count,
+                new_entries_length)) {
+            size_t previous_value_size = current_entry_index->value.size;
+
+            for(int index = 0; index < members.count; index++) {
+                bool added;
+
+                if (unlikely(!module_redis_command_helper_set_add_in_place(
+                        connection_context->db,
+                        &current_entry_index->value,
+                        members.list[index].short_string,
+                        members.list[index].length,
+                        &added))) {
+                    return_res = module_redis_connection_error_message_printf_noncritical(
+                            connection_context,
+                            "ERR operation failed");
+                    goto end;
+                }
+
+                if (added) {
+                    added_count++;
+                }
+            }
+
+            if (added_count == 0) {
+                return_res = module_redis_connection_send_number(connection_context, 0);
+                goto end;
+            }
+
+            if (unlikely(!module_redis_command_helper_set_commit_in_place(
+                    connection_context->db,
+                    &rmw_status,
+                    previous_value_size,
+                    &context->key.value.key))) {
+                return_res = module_redis_connection_error_message_printf_noncritical(
+                        connection_context,
+                        "ERR operation failed");
+                goto end;
+            }
+
+            abort_rmw = false;
+
+            transaction_release(&transaction);
+            release_transaction = false;
+
+            return_res = module_redis_connection_send_number(connection_context, added_count);
+            goto end;
+        }
+
+        expiry_time_ms = current_entry_index->expiry_time_ms;
+        current_buffer = module_redis_command_helper_set_read(
+                connection_context->db,
+                current_entry_index,
+                &packed_set,
+                &allocated_new_buffer);
+
+        if (unlikely(current_buffer == NULL)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+    }
+
+    packed_set_builder_init(&builder, current_buffer ? &packed_set : NULL);
+    builder_initialized = true;
+
+    for(int index = 0; index < members.count; index++) {
+        if (packed_set_builder_add(
+                &builder,
+                members.list[index].short_string,
+                members.list[index].length)) {
+            added_count++;
+        }
+    }
+
+    // Nothing to write back if all the members were already part of the set
+    if (added_count == 0) {
+        return_res = module_redis_connection_send_number(connection_context, 0);
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_set_commit(
+            connection_context->db,
+            &rmw_status,
+            &builder,
+            expiry_time_ms,
+            &context->key.value.key))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR operation failed");
+        goto end;
+    }
+
+    abort_rmw = false;
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    return_res = module_redis_connection_send_number(connection_context, added_count);
+
+end:
+
+    if (builder_initialized) {
+        packed_set_builder_free(&builder);
+    }
+
+    module_redis_command_helper_long_string_list_free(&members);
+
+    if (allocated_new_buffer) {
+        xalloc_free(current_buffer);
+    }
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    return return_res;
+}
@@ -37,6 +37,7 @@
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
 #include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_set"
 
@@ -142,6 +143,14 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(set) {
                     previous_entry_index);
         }
 
+        // With GET the previous value is returned so, as in Redis, the command fails if it's not a string
+        if (unlikely(previous_entry_index && context->get_get.has_token &&
+                previous_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+            storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+            return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+            goto end;
+        }
+
         // Checks if the operation has to be aborted because the NX flag is set but a value exists or because the XX
         // flag is set but a value doesn't exist
         abort_rmw =
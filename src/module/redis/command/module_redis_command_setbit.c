@@ -0,0 +1,175 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_bitmap.h"
+
+#define TAG "module_redis_command_setbit"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(setbit) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    uint64_t bit_offset;
+    int64_t bit_value;
+    uint8_t current_byte;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_chunk_sequence_t *current_chunk_sequence = NULL;
+    storage_db_expiry_time_ms_t expiry_time_ms = STORAGE_DB_ENTRY_NO_EXPIRY;
+    module_redis_command_setbit_context_t *context = connection_context->command.context;
+
+    if (!module_redis_command_helper_bitmap_parse_bit_offset(
+            context->offset.value.short_string,
+            context->offset.value.length,
+            &bit_offset)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR bit offset is not an integer or out of range");
+    }
+
+    if (!module_redis_command_helper_bitmap_parse_int64(
+            context->value.value.short_string,
+            context->value.value.length,
+            &bit_value) || (bit_value != 0 && bit_value != 1)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR bit is not an integer or out of range");
+    }
+
+    uint64_t byte_offset = bit_offset >> 3;
+    uint8_t bit_mask = 1 << (7 - (bit_offset & 7));
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            connection_context->database_number,
+            context->key.value.key,
+            context->key.value.length,
+            &rmw_status,
+            &current_entry_index))) {
+        abort_rmw = false;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR setbit failed");
+        goto end;
+    }
+
+    if (current_entry_index) {
+        current_entry_index = storage_db_op_rmw_current_entry_index_prep_for_read(
+                connection_context->db,
+                &rmw_status,
+                current_entry_index);
+
+        if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+            return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+            goto end;
+        }
+
+        current_chunk_sequence = &current_entry_index->value;
+        expiry_time_ms = current_entry_index->expiry_time_ms;
+    }
+
+    if (unlikely(!module_redis_command_helper_bitmap_read(
+            connection_context->db,
+            current_chunk_sequence,
+            byte_offset,
+            &current_byte,
+            1))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR setbit failed");
+        goto end;
+    }
+
+    size_t current_size = current_chunk_sequence ? current_chunk_sequence->size : 0;
+    bool current_bit = (current_byte & bit_mask) != 0;
+
+    // The value is rewritten only if the bit changes or if it has to be grown to contain the bit
+    if (current_bit != (bit_value == 1) || byte_offset >= current_size) {
+        module_redis_command_helper_bitmap_patch_t patch = {
+                .byte_offset = byte_offset,
+                .value = bit_value ? current_byte | bit_mask : current_byte & ~bit_mask,
+        };
+
+        if (unlikely(!module_redis_command_helper_bitmap_write(
+                connection_context->db,
+                &rmw_status,
+                current_chunk_sequence,
+                MAX(current_size, byte_offset + 1),
+                &patch,
+                1,
+                expiry_time_ms,
+                &context->key.value.key))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR setbit failed");
+            goto end;
+        }
+    } else {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    abort_rmw = false;
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    return_res = module_redis_connection_send_number(connection_context, current_bit ? 1 : 0);
+
+end:
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    if (current_entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+    }
+
+    return return_res;
+}
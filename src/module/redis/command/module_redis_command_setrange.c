@@ -38,6 +38,7 @@
 #include "storage/db/storage_db.h"
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_setrange"
 
@@ -67,6 +68,7 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(setrange) {
     //       command can impact the overall performances
 
     transaction_acquire(&transaction);
+    release_transaction = true;
 
     if (unlikely(!storage_db_op_rmw_begin(
             connection_context->db,
@@ -89,6 +91,12 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(setrange) {
                 current_entry_index);
     }
 
+    if (unlikely(current_entry_index &&
+            current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
     if (likely(current_entry_index)) {
         current_chunk_sequence = &current_entry_index->value;
         current_chunk_sequence_length = current_chunk_sequence->size;
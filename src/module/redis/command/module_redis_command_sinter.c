@@ -0,0 +1,237 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "data_structures/packed_set/packed_set.h"
+#include "data_structures/packed_set/packed_set_intset.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_set.h"
+
+#define TAG "module_redis_command_sinter"
+
+// When a set is this many times larger than the current intersection, searching each integer is cheaper than merging
+#define MODULE_REDIS_COMMAND_SINTER_SEARCH_RATIO    (32)
+
+static bool module_redis_command_sinter_contains(
+        packed_set_t *packed_set,
+        packed_set_member_t *member) {
+    if (!member->is_integer) {
+        return packed_set_contains(packed_set, member->value, member->value_length);
+    }
+
+    if (packed_set->encoding == PACKED_SET_ENCODING_INTSET) {
+        uint32_t position;
+        return packed_set_intset_search(packed_set->integers, packed_set->count, member->integer, &position);
+    }
+
+    char buffer[PACKED_SET_INTEGER_MAX_LENGTH + 1];
+    size_t buffer_length = packed_set_integer_to_string(member->integer, buffer);
+
+    return packed_set_contains(packed_set, buffer, buffer_length);
+}
+
+static uint32_t module_redis_command_sinter_intsets(
+        module_redis_command_helper_set_source_t *sources,
+        int sources_count,
+        int smallest_index,
+        int64_t *result,
+        int64_t *result_temp) {
+    int64_t *result_current = result;
+    packed_set_t *smallest = &sources[smallest_index].packed_set;
+    uint32_t result_count = smallest->count;
+
+    memcpy(result_current, smallest->integers, sizeof(int64_t) * result_count);
+
+    for(int index = 0; index < sources_count && result_count > 0; index++) {
+        packed_set_t *packed_set = &sources[index].packed_set;
+
+        if (index == smallest_index) {
+            continue;
+        }
+
+        if ((uint64_t)result_count * MODULE_REDIS_COMMAND_SINTER_SEARCH_RATIO < packed_set->count) {
+            uint32_t result_temp_count = 0;
+            for(uint32_t result_index = 0; result_index < result_count; result_index++) {
+                uint32_t position;
+                if (packed_set_intset_search(
+                        packed_set->integers,
+                        packed_set->count,
+                        result_current[result_index],
+                        &position)) {
+                    result_temp[result_temp_count++] = result_current[result_index];
+                }
+            }
+
+            result_count = result_temp_count;
+        } else {
+            result_count = packed_set_intset_intersect(
+                    result_current,
+                    result_count,
+                    packed_set->integers,
+                    packed_set->count,
+                    result_temp);
+        }
+
+        int64_t *swap = result_current;
+        result_current = result_temp;
+        result_temp = swap;
+    }
+
+    if (result_current != result) {
+        memcpy(result, result_current, sizeof(int64_t) * result_count);
+    }
+
+    return result_count;
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(sinter) {
+    bool return_res = false;
+    bool opened = false;
+    bool all_intsets = true;
+    int smallest_index = -1;
+    uint32_t members_count = 0;
+    packed_set_member_t *members = NULL;
+    int64_t *integers = NULL;
+    module_redis_command_helper_set_source_t *sources = NULL;
+    module_redis_command_sinter_context_t *context = connection_context->command.context;
+
+    sources = xalloc_alloc(sizeof(module_redis_command_helper_set_source_t) * context->key.count);
+
+    return_res = module_redis_command_helper_set_sources_open(
+            connection_context,
+            context->key.list,
+            context->key.count,
+            sources,
+            &opened);
+
+    if (unlikely(!opened)) {
+        goto end;
+    }
+
+    for(int index = 0; index < context->key.count; index++) {
+        // The intersection with a missing key is always empty
+        if (!sources[index].entry_index) {
+            smallest_index = -1;
+            break;
+        }
+
+        if (sources[index].packed_set.encoding != PACKED_SET_ENCODING_INTSET) {
+            all_intsets = false;
+        }
+
+        if (smallest_index == -1 || sources[index].packed_set.count < sources[smallest_index].packed_set.count) {
+            smallest_index = index;
+        }
+    }
+
+    if (smallest_index == -1) {
+        return_res = module_redis_connection_send_array_header(connection_context, 0);
+        goto end;
+    }
+
+    if (all_intsets) {
+        uint32_t smallest_count = sources[smallest_index].packed_set.count;
+        integers = xalloc_alloc(sizeof(int64_t) * 2 * MAX(smallest_count, 1));
+        members_count = module_redis_command_sinter_intsets(
+                sources,
+                context->key.count,
+                smallest_index,
+                integers,
+                integers + smallest_count);
+    } else {
+        size_t offset = 0;
+        packed_set_member_t member;
+        packed_set_t *smallest = &sources[smallest_index].packed_set;
+
+        members = xalloc_alloc(sizeof(packed_set_member_t) * MAX(smallest->count, 1));
+
+        // The members of the smallest set are searched in all the other sets
+        while(packed_set_iter_next(smallest, &offset, &member)) {
+            bool is_member = true;
+            for(int index = 0; index < context->key.count && is_member; index++) {
+                if (index != smallest_index) {
+                    is_member = module_redis_command_sinter_contains(&sources[index].packed_set, &member);
+                }
+            }
+
+            if (is_member) {
+                members[members_count++] = member;
+            }
+        }
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(connection_context, members_count))) {
+        return_res = false;
+        goto end;
+    }
+
+    for(uint32_t index = 0; index < members_count; index++) {
+        packed_set_member_t member;
+
+        if (all_intsets) {
+            member.is_integer = true;
+            member.integer = integers[index];
+        } else {
+            member = members[index];
+        }
+
+        if (unlikely(!module_redis_command_helper_set_send_member(connection_context, &member))) {
+            return_res = false;
+            goto end;
+        }
+    }
+
+    return_res = true;
+
+end:
+
+    if (integers) {
+        xalloc_free(integers);
+    }
+
+    if (members) {
+        xalloc_free(members);
+    }
+
+    module_redis_command_helper_set_sources_close(sources, context->key.count);
+    xalloc_free(sources);
+
+    return return_res;
+}
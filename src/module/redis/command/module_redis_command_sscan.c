@@ -0,0 +1,195 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "utils_string.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "data_structures/packed_set/packed_set.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_set.h"
+
+#define TAG "module_redis_command_sscan"
+
+static bool module_redis_command_sscan_member_matches(
+        packed_set_member_t *member,
+        char *pattern,
+        size_t pattern_length) {
+    if (pattern == NULL) {
+        return true;
+    }
+
+    if (member->is_integer) {
+        char buffer[PACKED_SET_INTEGER_MAX_LENGTH + 1];
+        size_t buffer_length = packed_set_integer_to_string(member->integer, buffer);
+
+        return utils_string_glob_match(buffer, buffer_length, pattern, pattern_length);
+    }
+
+    return utils_string_glob_match(member->value, member->value_length, pattern, pattern_length);
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(sscan) {
+    bool return_res = false;
+    bool allocated_new_buffer = false;
+    char *buffer = NULL;
+    char *pattern = NULL;
+    size_t pattern_length = 0;
+    uint64_t count = 10;
+    uint64_t cursor_next = 0;
+    uint64_t members_count = 0;
+    packed_set_member_t *members = NULL;
+    packed_set_t packed_set = { 0 };
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_sscan_context_t *context = connection_context->command.context;
+
+    transaction_t transaction = { 0 };
+    transaction_acquire(&transaction);
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            connection_context->database_number,
+            &transaction,
+            context->key.value.key,
+            context->key.value.length);
+
+    transaction_release(&transaction);
+
+    if (entry_index && unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    if (likely(entry_index && context->cursor.value >= 0 &&
+        (!context->count_count.has_token ||
+            (context->count_count.has_token && context->count_count.value > 0)))) {
+        if (context->match_pattern.has_token) {
+            pattern = context->match_pattern.value.pattern;
+            pattern_length = context->match_pattern.value.length;
+        }
+
+        if (context->count_count.has_token) {
+            count = context->count_count.value;
+        }
+
+        buffer = module_redis_command_helper_set_read(
+                connection_context->db,
+                entry_index,
+                &packed_set,
+                &allocated_new_buffer);
+
+        if (unlikely(buffer == NULL)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR operation failed");
+            goto end;
+        }
+
+        members = xalloc_alloc(sizeof(packed_set_member_t) * MAX(packed_set.count, 1));
+
+        if (packed_set.encoding == PACKED_SET_ENCODING_INTSET ||
+            packed_set.packed_hash.encoding == PACKED_HASH_ENCODING_COMPACT) {
+            // As in Redis, the intsets and the compact sets are small enough to be returned in one go ignoring cursor
+            // and count
+            size_t offset = 0;
+            while(packed_set_iter_next(&packed_set, &offset, &members[members_count])) {
+                if (module_redis_command_sscan_member_matches(&members[members_count], pattern, pattern_length)) {
+                    members_count++;
+                }
+            }
+        } else {
+            // The cursor is the index of the bucket of the packed hash to resume from, as done by HSCAN
+            uint64_t bucket_index = context->cursor.value;
+            uint64_t visited_count = 0;
+            while(bucket_index < packed_set.packed_hash.buckets_count && visited_count < count) {
+                packed_hash_entry_t entry;
+                if (packed_hash_bucket_get(&packed_set.packed_hash, bucket_index, &entry)) {
+                    visited_count++;
+
+                    members[members_count].is_integer = false;
+                    members[members_count].value = entry.field;
+                    members[members_count].value_length = entry.field_length;
+
+                    if (module_redis_command_sscan_member_matches(&members[members_count], pattern, pattern_length)) {
+                        members_count++;
+                    }
+                }
+
+                bucket_index++;
+            }
+
+            cursor_next = bucket_index < packed_set.packed_hash.buckets_count ? bucket_index : 0;
+        }
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(connection_context, 2))) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_connection_send_number(connection_context, (int64_t)cursor_next))) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(connection_context, members_count))) {
+        goto end;
+    }
+
+    for(uint64_t index = 0; index < members_count; index++) {
+        if (unlikely(!module_redis_command_helper_set_send_member(connection_context, &members[index]))) {
+            goto end;
+        }
+    }
+
+    return_res = true;
+
+end:
+
+    if (members) {
+        xalloc_free(members);
+    }
+
+    if (allocated_new_buffer) {
+        xalloc_free(buffer);
+    }
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
@@ -36,6 +36,7 @@
 #include "storage/db/storage_db.h"
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_strlen"
 
@@ -53,6 +54,11 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(strlen) {
             context->key.value.key,
             context->key.value.length);
 
+    if (unlikely(entry_index && entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        transaction_release(&transaction);
+        return module_redis_command_helper_value_type_error_wrongtype(connection_context);
+    }
+
     if (likely(entry_index)) {
         length = (int64_t)entry_index->value.size;
     }
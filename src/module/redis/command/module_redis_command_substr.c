@@ -37,6 +37,7 @@
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
 #include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
 
 #define TAG "module_redis_command_substr"
 
@@ -60,6 +61,11 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(substr) {
         goto end;
     }
 
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
     off_t range_start = context->start.value;
     off_t range_end = context->end.value;
 
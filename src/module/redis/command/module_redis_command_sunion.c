@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "data_structures/packed_set/packed_set.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_set.h"
+
+#define TAG "module_redis_command_sunion"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(sunion) {
+    bool return_res = false;
+    bool opened = false;
+    uint64_t integers_count = 0;
+    char *integers_strings = NULL;
+    packed_set_builder_t builder = { 0 };
+    bool builder_initialized = false;
+    module_redis_command_helper_set_source_t *sources = NULL;
+    module_redis_command_sunion_context_t *context = connection_context->command.context;
+
+    sources = xalloc_alloc(sizeof(module_redis_command_helper_set_source_t) * context->key.count);
+
+    return_res = module_redis_command_helper_set_sources_open(
+            connection_context,
+            context->key.list,
+            context->key.count,
+            sources,
+            &opened);
+
+    if (unlikely(!opened)) {
+        goto end;
+    }
+
+    for(int index = 0; index < context->key.count; index++) {
+        if (sources[index].entry_index && sources[index].packed_set.encoding == PACKED_SET_ENCODING_INTSET) {
+            integers_count += sources[index].packed_set.count;
+        }
+    }
+
+    // The builder only references the members, the integers are converted to strings in a buffer kept around till
+    // the builder is freed
+    integers_strings = xalloc_alloc((PACKED_SET_INTEGER_MAX_LENGTH + 1) * MAX(integers_count, 1));
+    integers_count = 0;
+
+    packed_set_builder_init(&builder, NULL);
+    builder_initialized = true;
+
+    for(int index = 0; index < context->key.count; index++) {
+        size_t offset = 0;
+        packed_set_member_t member;
+
+        if (!sources[index].entry_index) {
+            continue;
+        }
+
+        while(packed_set_iter_next(&sources[index].packed_set, &offset, &member)) {
+            if (member.is_integer) {
+                member.value = integers_strings + (integers_count * (PACKED_SET_INTEGER_MAX_LENGTH + 1));
+                member.value_length = packed_set_integer_to_string(member.integer, member.value);
+                integers_count++;
+            }
+
+            packed_set_builder_add(&builder, member.value, member.value_length);
+        }
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(
+            connection_context,
+            packed_set_builder_count(&builder)))) {
+        return_res = false;
+        goto end;
+    }
+
+    size_t offset = 0;
+    packed_set_member_t member;
+    while(packed_set_builder_iter_next(&builder, &offset, &member)) {
+        if (unlikely(!module_redis_command_helper_set_send_member(connection_context, &member))) {
+            return_res = false;
+            goto end;
+        }
+    }
+
+    return_res = true;
+
+end:
+
+    if (builder_initialized) {
+        packed_set_builder_free(&builder);
+    }
+
+    if (integers_strings) {
+        xalloc_free(integers_strings);
+    }
+
+    module_redis_command_helper_set_sources_close(sources, context->key.count);
+    xalloc_free(sources);
+
+    return return_res;
+}
@@ -0,0 +1,62 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_transaction.h"
+
+#define TAG "module_redis_command_watch"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(watch) {
+    module_redis_command_watch_context_t *context = connection_context->command.context;
+
+    if (unlikely(connection_context->transaction.queueing)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR WATCH inside MULTI is not allowed");
+    }
+
+    for(int index = 0; index < context->key.count; index++) {
+        if (unlikely(!module_redis_transaction_watch_key(
+                connection_context,
+                context->key.list[index].key,
+                context->key.list[index].length))) {
+            return false;
+        }
+    }
+
+    return module_redis_connection_send_ok(connection_context);
+}
@@ -0,0 +1,161 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_sorted_set.h"
+
+#define TAG "module_redis_command_zadd"
+
+typedef struct module_redis_command_zadd_flag module_redis_command_zadd_flag_t;
+struct module_redis_command_zadd_flag {
+    char *name;
+    size_t name_length;
+    module_redis_command_helper_sorted_set_add_flags_t flag;
+};
+
+static module_redis_command_zadd_flag_t module_redis_command_zadd_flags[] = {
+        { "NX", 2, MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_NX },
+        { "XX", 2, MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_XX },
+        { "GT", 2, MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_GT },
+        { "LT", 2, MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_LT },
+        { "CH", 2, MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_CH },
+        { "INCR", 4, MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_INCR },
+};
+
+static bool module_redis_command_zadd_parse_flag(
+        module_redis_short_string_t *value,
+        module_redis_command_helper_sorted_set_add_flags_t *flag) {
+    for(int index = 0; index < ARRAY_SIZE(module_redis_command_zadd_flags); index++) {
+        module_redis_command_zadd_flag_t *zadd_flag = &module_redis_command_zadd_flags[index];
+
+        if (value->length == zadd_flag->name_length &&
+            strncasecmp(value->short_string, zadd_flag->name, zadd_flag->name_length) == 0) {
+            *flag = zadd_flag->flag;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(zadd) {
+    bool return_res = false;
+    int arguments_index = 0;
+    uint32_t score_members_count = 0;
+    module_redis_command_helper_sorted_set_add_flags_t flag;
+    module_redis_command_helper_sorted_set_add_flags_t flags = MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_NONE;
+    module_redis_command_helper_sorted_set_score_member_t *score_members = NULL;
+    module_redis_command_zadd_context_t *context = connection_context->command.context;
+
+    // The parser doesn't support tokens before positional arguments, the options are parsed here and the score member
+    // pairs start with the first argument that isn't an option
+    while(arguments_index < context->score_member.count &&
+        module_redis_command_zadd_parse_flag(&context->score_member.list[arguments_index], &flag)) {
+        flags |= flag;
+        arguments_index++;
+    }
+
+    int remaining_arguments = context->score_member.count - arguments_index;
+    if (remaining_arguments == 0 || remaining_arguments % 2 != 0) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR syntax error");
+    }
+
+    if ((flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_NX) &&
+        (flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_XX)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR XX and NX options at the same time are not compatible");
+    }
+
+    if (((flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_GT) &&
+         (flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_LT)) ||
+        ((flags & (MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_GT | MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_LT)) &&
+         (flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_NX))) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR GT, LT, and/or NX options at the same time are not compatible");
+    }
+
+    score_members_count = remaining_arguments / 2;
+    if ((flags & MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_INCR) && score_members_count > 1) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR INCR option supports a single increment-element pair");
+    }
+
+    score_members = xalloc_alloc(sizeof(module_redis_command_helper_sorted_set_score_member_t) * score_members_count);
+
+    for(uint32_t index = 0; index < score_members_count; index++) {
+        module_redis_short_string_t *score = &context->score_member.list[arguments_index + (index * 2)];
+        module_redis_short_string_t *member = &context->score_member.list[arguments_index + (index * 2) + 1];
+
+        if (!module_redis_command_helper_sorted_set_parse_score(
+                score->short_string,
+                score->length,
+                &score_members[index].score)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR value is not a valid float");
+            goto end;
+        }
+
+        score_members[index].member = member->short_string;
+        score_members[index].member_length = member->length;
+    }
+
+    return_res = module_redis_command_helper_sorted_set_add(
+            connection_context,
+            &context->key.value.key,
+            context->key.value.length,
+            flags,
+            score_members,
+            score_members_count);
+
+end:
+
+    xalloc_free(score_members);
+
+    return return_res;
+}
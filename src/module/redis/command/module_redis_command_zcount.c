@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_sorted_set.h"
+
+#define TAG "module_redis_command_zcount"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(zcount) {
+    bool return_res = false;
+    bool min_exclusive, max_exclusive;
+    double min_score, max_score;
+    uint64_t first_rank, end_rank;
+    sorted_set_t *sorted_set;
+    sorted_set_node_t *node;
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_zcount_context_t *context = connection_context->command.context;
+
+    if (!module_redis_command_helper_sorted_set_parse_score_range(
+            context->min.value.short_string,
+            context->min.value.length,
+            &min_score,
+            &min_exclusive) ||
+        !module_redis_command_helper_sorted_set_parse_score_range(
+                context->max.value.short_string,
+                context->max.value.length,
+                &max_score,
+                &max_exclusive)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR min or max is not a float");
+    }
+
+    transaction_t transaction = { 0 };
+    transaction_acquire(&transaction);
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            connection_context->database_number,
+            &transaction,
+            context->key.value.key,
+            context->key.value.length);
+
+    transaction_release(&transaction);
+
+    if (!entry_index) {
+        return_res = module_redis_connection_send_number(connection_context, 0);
+        goto end;
+    }
+
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET)) {
+        return_res = module_redis_command_helper_value_type_error_wrongtype(connection_context);
+        goto end;
+    }
+
+    // The entries are ordered by score, the count is the distance between the ranks of the two boundaries
+    sorted_set = module_redis_command_helper_sorted_set_get(entry_index);
+    node = sorted_set_first_by_score(sorted_set, min_score, min_exclusive);
+    first_rank = node ? sorted_set_rank(sorted_set, node) : sorted_set->count;
+    node = sorted_set_first_by_score(sorted_set, max_score, !max_exclusive);
+    end_rank = node ? sorted_set_rank(sorted_set, node) : sorted_set->count;
+
+    return_res = module_redis_connection_send_number(
+            connection_context,
+            end_rank > first_rank ? (int64_t)(end_rank - first_rank) : 0);
+
+end:
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_value_type.h"
+#include "module/redis/command/helpers/module_redis_command_helper_sorted_set.h"
+
+#define TAG "module_redis_command_zincrby"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(zincrby) {
+    module_redis_command_helper_sorted_set_score_member_t score_member;
+    module_redis_command_zincrby_context_t *context = connection_context->command.context;
+
+    if (!module_redis_command_helper_sorted_set_parse_score(
+            context->increment.value.short_string,
+            context->increment.value.length,
+            &score_member.score)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR value is not a valid float");
+    }
+
+    score_member.member = context->member.value.short_string;
+    score_member.member_length = context->member.value.length;
+
+    // ZINCRBY behaves exactly as ZADD INCR
+    return module_redis_command_helper_sorted_set_add(
+            connection_context,
+            &context->key.value.key,
+            context->key.value.length,
+            MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ADD_FLAGS_INCR,
+            &score_member,
+            1);
+}
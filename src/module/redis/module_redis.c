@@ -99,5 +99,6 @@ FUNCTION_CTOR(module_redis_register_ctor, {
             module_redis_program_dtor,
             module_redis_worker_ctor,
             NULL,
-            module_redis_connection_accept);
+            module_redis_connection_accept,
+            module_redis_connection_resume);
 });
@@ -8,6 +8,8 @@ extern "C" {
 #define MODULE_REDIS_COMPATIBILITY_SERVER_NAME "redis"
 #define MODULE_REDIS_COMPATIBILITY_SERVER_VERSION "6.2.12"
 #define MODULE_REDIS_COMMAND_MAX_LENGTH 24
+#define MODULE_REDIS_COMMAND_ARENA_BLOCK_SIZE (4 * 1024)
+#define MODULE_REDIS_COMMAND_STREAM_DIRECT_RECEIVE_MIN_LENGTH (16 * 1024)
 
 #include "module_redis_autogenerated_commands_enum.h"
 
@@ -147,10 +149,21 @@ struct module_redis_command_argument {
     bool has_sub_arguments;
     bool has_multiple_occurrences;
     bool has_multiple_token;
+    bool is_read_only_key;
     size_t argument_context_member_size;
     off_t argument_context_member_offset;
 };
 
+// Forward declaration, the header of the arena is not required by all the users of the module
+typedef struct xalloc_arena xalloc_arena_t;
+
+typedef void *(module_redis_command_argument_member_context_addr_fast_path_funcptr_t)(
+        xalloc_arena_t *arena,
+        module_redis_command_argument_t *argument,
+        bool is_in_block,
+        int block_argument_index,
+        void *context);
+
 typedef struct module_redis_command_info module_redis_command_info_t;
 struct module_redis_command_info {
     // The longest Redis command is 23 chars
@@ -167,6 +180,7 @@ struct module_redis_command_info {
     module_redis_command_argument_t *arguments;
     module_redis_command_end_funcptr_t *command_end_funcptr;
     module_redis_command_free_funcptr_t *command_free_funcptr;
+    module_redis_command_argument_member_context_addr_fast_path_funcptr_t *argument_member_context_addr_fast_path_funcptr;
     hashtable_spsc_t *tokens_hashtable;
 };
 
@@ -182,6 +196,7 @@ struct module_redis_command_parser_context_token_map_item {
 typedef struct module_redis_command_parser_context module_redis_command_parser_context_t;
 struct module_redis_command_parser_context {
     uint16_t positional_arguments_parsed_count;
+    uint32_t arguments_processed_count;
     struct {
         bool require_stream;
         void *member_context_addr;
@@ -191,9 +206,39 @@ struct module_redis_command_parser_context {
     } current_argument;
 };
 
+typedef struct module_redis_connection_transaction_queued_command
+        module_redis_connection_transaction_queued_command_t;
+struct module_redis_connection_transaction_queued_command {
+    module_redis_command_info_t *info;
+    module_redis_command_context_t *context;
+    struct xalloc_arena *arena;
+};
+
+typedef struct module_redis_connection_transaction_watched_key module_redis_connection_transaction_watched_key_t;
+struct module_redis_connection_transaction_watched_key {
+    uint32_t database_number;
+    char *key;
+    size_t key_length;
+    storage_db_key_lock_index_t key_lock_index;
+    storage_db_entry_index_version_t version;
+};
+
+// Forward declaration, the subscriptions are managed by module_redis_pubsub
+typedef struct module_redis_pubsub_subscription module_redis_pubsub_subscription_t;
+typedef struct module_redis_pubsub_message_local_ref module_redis_pubsub_message_local_ref_t;
+
+typedef struct module_redis_connection_pubsub_pending_message module_redis_connection_pubsub_pending_message_t;
+struct module_redis_connection_pubsub_pending_message {
+    module_redis_pubsub_message_local_ref_t *local_ref;
+    // Set only for the messages matched by a pattern, it's a copy as the subscription might go away in the meantime
+    char *pattern;
+    size_t pattern_length;
+};
+
 struct module_redis_connection_context {
     protocol_redis_resp_version_t resp_version;
     char *client_name;
+    uint64_t client_id;
     bool authenticated;
     protocol_redis_reader_context_t reader_context;
     network_channel_t *network_channel;
@@ -211,11 +256,65 @@ struct module_redis_connection_context {
         module_redis_command_info_t *info;
         module_redis_command_context_t *context;
         module_redis_command_parser_context_t parser_context;
+        struct xalloc_arena *arena;
         uint32_t arguments_offset;
         char *command_string_with_container;
         size_t command_string_with_container_length;
         bool skip;
     } command;
+    struct {
+        bool queueing;
+        bool executing;
+        bool has_errors;
+        // The database the keys of the queued commands will belong to, it's changed by the queued SELECT commands
+        uint32_t database_number;
+        struct {
+            module_redis_connection_transaction_queued_command_t *list;
+            uint32_t count;
+            uint32_t size;
+        } queued_commands;
+        struct {
+            module_redis_connection_transaction_watched_key_t *list;
+            uint32_t count;
+            uint32_t size;
+        } watched_keys;
+        struct {
+            storage_db_key_lock_index_t *list;
+            uint32_t count;
+            uint32_t size;
+        } key_lock_indexes;
+    } transaction;
+    struct {
+        // Set while the connection is waiting for new data, when the messages can be written out straight away
+        bool idle;
+        // Set while a fiber is writing out the pending messages
+        bool writing;
+        struct {
+            int64_t sec;
+            int64_t nsec;
+        } timeout_read;
+        struct {
+            module_redis_pubsub_subscription_t **list;
+            uint32_t count;
+            uint32_t size;
+        } channels;
+        struct {
+            module_redis_pubsub_subscription_t **list;
+            uint32_t count;
+            uint32_t size;
+        } patterns;
+        struct {
+            module_redis_connection_pubsub_pending_message_t *list;
+            uint32_t count;
+            uint32_t size;
+        } pending_messages;
+    } pubsub;
+    struct {
+        bool enabled;
+        bool bcast;
+        bool noloop;
+        uint64_t redirect_client_id;
+    } tracking;
 };
 
 #include "module_redis_autogenerated_commands_contexts.h"
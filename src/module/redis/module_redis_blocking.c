@@ -0,0 +1,405 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "memory_fences.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "hash/hash_fnv1.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/timer_wheel/timer_wheel.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_op.h"
+#include "worker/worker_mailbox.h"
+#include "worker/network/worker_network_op.h"
+#include "module/redis/module_redis.h"
+
+#include "module_redis_blocking.h"
+
+#define TAG "module_redis_blocking"
+
+static module_redis_blocking_bucket_t module_redis_blocking_buckets[MODULE_REDIS_BLOCKING_BUCKETS_COUNT] = { 0 };
+
+static inline uint32_t module_redis_blocking_bucket_index(
+        uint32_t database_number,
+        char *key,
+        size_t key_length) {
+    uint32_t hash = fnv_32_hash(key, (uint16_t)MIN(key_length, UINT16_MAX));
+    return (hash ^ database_number) & (MODULE_REDIS_BLOCKING_BUCKETS_COUNT - 1);
+}
+
+static void module_redis_blocking_waiter_timer_fp(
+        __attribute__((unused)) timer_wheel_timer_t *timer,
+        void *user_data) {
+    module_redis_blocking_waiter_t *waiter = user_data;
+
+    // The timer is armed only while the fiber is parked
+    waiter->timer_fired = true;
+    fiber_scheduler_switch_to(waiter->fiber);
+}
+
+static void module_redis_blocking_waiter_wakeup_fp(
+        void *user_data) {
+    module_redis_blocking_waiter_t *waiter = user_data;
+
+    waiter->wakeup_received = true;
+    worker_op_timer_remove(&waiter->timer);
+
+    // The fiber might not be parked yet, e.g. if it's still checking the keys after having registered itself, in which
+    // case it will notice the wakeup on its own
+    if (waiter->parked) {
+        fiber_scheduler_switch_to(waiter->fiber);
+    }
+}
+
+static void module_redis_blocking_waiter_wakeup_timer_fp(
+        __attribute__((unused)) timer_wheel_timer_t *timer,
+        void *user_data) {
+    module_redis_blocking_waiter_wakeup_fp(user_data);
+}
+
+static void module_redis_blocking_waiter_park(
+        module_redis_blocking_waiter_t *waiter) {
+    waiter->parked = true;
+
+    if (waiter->channel == NULL) {
+        fiber_scheduler_switch_back();
+    } else {
+        // The fiber is resumed by the hangup of the client as well, the operation returns -ECANCELED if it has been
+        // resumed by the wakeup or by the timer
+        int32_t res = worker_op_network_wait_hangup(waiter->channel);
+        if (unlikely(res == -ENOMEM)) {
+            // The socket can't be watched, the waiter falls back to the wakeup and the timer
+            fiber_scheduler_switch_back();
+        } else if (res != -ECANCELED) {
+            waiter->hangup = true;
+        }
+    }
+
+    waiter->parked = false;
+}
+
+static void module_redis_blocking_waiter_unlink(
+        module_redis_blocking_waiter_t *waiter) {
+    for(uint32_t index = 0; index < waiter->entries_count; index++) {
+        module_redis_blocking_waiter_entry_t *entry = &waiter->entries[index];
+
+        // Once unlinked by a pusher the entry is never linked again by anyone else, if the flag is still set it has
+        // to be checked again holding the lock
+        MEMORY_FENCE_LOAD();
+        if (!entry->linked) {
+            continue;
+        }
+
+        module_redis_blocking_bucket_t *bucket = &module_redis_blocking_buckets[entry->bucket_index];
+        spinlock_lock(&bucket->lock);
+
+        if (entry->linked) {
+            double_linked_list_remove_item(&bucket->waiters, &entry->item);
+            entry->linked = false;
+            __sync_fetch_and_sub(&bucket->waiters_count, 1);
+        }
+
+        spinlock_unlock(&bucket->lock);
+    }
+}
+
+static bool module_redis_blocking_waiter_try_claim(
+        module_redis_blocking_waiter_t *waiter) {
+    while(true) {
+        if (__sync_bool_compare_and_swap(
+                &waiter->state,
+                MODULE_REDIS_BLOCKING_WAITER_STATE_WAITING,
+                MODULE_REDIS_BLOCKING_WAITER_STATE_CANCELLED)) {
+            return true;
+        }
+
+        MEMORY_FENCE_LOAD();
+        if (waiter->state == MODULE_REDIS_BLOCKING_WAITER_STATE_WOKEN) {
+            return false;
+        }
+
+        // A pusher is posting the wakeup holding the lock of the bucket, it takes just a few instructions and it either
+        // succeeds or puts the waiter back in the waiting state
+    }
+}
+
+static void module_redis_blocking_waiter_receive_wakeup(
+        module_redis_blocking_waiter_t *waiter) {
+    // The message posted to the mailbox references the waiter, the fiber has to wait for it before going away
+    waiter->parked = true;
+    while(!waiter->wakeup_received) {
+        fiber_scheduler_switch_back();
+    }
+    waiter->parked = false;
+}
+
+void module_redis_blocking_waiter_init(
+        module_redis_blocking_waiter_t *waiter,
+        network_channel_t *channel,
+        uint32_t database_number,
+        module_redis_key_t *keys,
+        uint32_t keys_count) {
+    memset(waiter, 0, sizeof(module_redis_blocking_waiter_t));
+
+    waiter->fiber = fiber_scheduler_get_current();
+    waiter->channel = channel;
+    waiter->worker_index = worker_context_get()->worker_index;
+    waiter->database_number = database_number;
+    waiter->state = MODULE_REDIS_BLOCKING_WAITER_STATE_CANCELLED;
+    waiter->entries_count = keys_count;
+    waiter->entries = xalloc_alloc_zero(sizeof(module_redis_blocking_waiter_entry_t) * keys_count);
+    timer_wheel_timer_init(&waiter->timer);
+    timer_wheel_timer_init(&waiter->wakeup_timer);
+
+    for(uint32_t index = 0; index < keys_count; index++) {
+        module_redis_blocking_waiter_entry_t *entry = &waiter->entries[index];
+
+        entry->item.data = entry;
+        entry->waiter = waiter;
+        entry->key = &keys[index];
+        entry->bucket_index = module_redis_blocking_bucket_index(
+                database_number,
+                keys[index].key,
+                keys[index].length);
+    }
+}
+
+void module_redis_blocking_waiter_free(
+        module_redis_blocking_waiter_t *waiter) {
+    assert(waiter->state != MODULE_REDIS_BLOCKING_WAITER_STATE_WAITING);
+
+    xalloc_free(waiter->entries);
+    waiter->entries = NULL;
+    waiter->entries_count = 0;
+}
+
+void module_redis_blocking_waiter_register(
+        module_redis_blocking_waiter_t *waiter) {
+    waiter->timer_fired = false;
+    waiter->wakeup_received = false;
+    waiter->hangup = false;
+    waiter->state = MODULE_REDIS_BLOCKING_WAITER_STATE_WAITING;
+    MEMORY_FENCE_STORE();
+
+    for(uint32_t index = 0; index < waiter->entries_count; index++) {
+        module_redis_blocking_waiter_entry_t *entry = &waiter->entries[index];
+        module_redis_blocking_bucket_t *bucket = &module_redis_blocking_buckets[entry->bucket_index];
+
+        spinlock_lock(&bucket->lock);
+        double_linked_list_push_item(&bucket->waiters, &entry->item);
+        entry->linked = true;
+        __sync_fetch_and_add(&bucket->waiters_count, 1);
+        spinlock_unlock(&bucket->lock);
+    }
+
+    // Pairs with the fence in module_redis_blocking_signal, the caller checks the keys again after having registered
+    // the waiter so either the pusher sees the waiter or the caller sees the new elements
+    MEMORY_FENCE_FULL();
+}
+
+void module_redis_blocking_waiter_cancel(
+        module_redis_blocking_waiter_t *waiter) {
+    if (!module_redis_blocking_waiter_try_claim(waiter)) {
+        module_redis_blocking_waiter_receive_wakeup(waiter);
+
+        // The wakeup isn't needed anymore, it's passed on to the next waiter of the same key
+        module_redis_blocking_waiter_entry_t *entry = &waiter->entries[waiter->woken_entry_index];
+        module_redis_blocking_signal(
+                waiter->database_number,
+                entry->key->key,
+                entry->key->length,
+                1);
+    }
+
+    module_redis_blocking_waiter_unlink(waiter);
+}
+
+bool module_redis_blocking_waiter_wait(
+        module_redis_blocking_waiter_t *waiter,
+        int64_t deadline_ms) {
+    bool woken = false;
+    worker_stats_t *stats = worker_stats_get_internal_current();
+
+    stats->blocking.blocked_clients++;
+
+    while(!waiter->wakeup_received && !waiter->timer_fired && !waiter->hangup) {
+        if (deadline_ms > 0) {
+            int64_t now_ms = clock_monotonic_int64_ms();
+            if (now_ms >= deadline_ms) {
+                waiter->timer_fired = true;
+                break;
+            }
+
+            worker_op_timer_add_ms(
+                    &waiter->timer,
+                    deadline_ms - now_ms,
+                    module_redis_blocking_waiter_timer_fp,
+                    waiter);
+        }
+
+        module_redis_blocking_waiter_park(waiter);
+    }
+
+    if (unlikely(waiter->hangup)) {
+        // The client has gone away, the timer might still be armed and a wakeup might have been already delivered
+        worker_op_timer_remove(&waiter->timer);
+        module_redis_blocking_waiter_cancel(waiter);
+    } else {
+        if (waiter->wakeup_received) {
+            woken = true;
+        } else if (!module_redis_blocking_waiter_try_claim(waiter)) {
+            // The timer fired while a pusher was waking up the waiter
+            module_redis_blocking_waiter_receive_wakeup(waiter);
+            woken = true;
+        }
+
+        module_redis_blocking_waiter_unlink(waiter);
+    }
+
+    stats->blocking.blocked_clients--;
+
+    if (!woken && !waiter->hangup) {
+        stats->blocking.timeouts++;
+    }
+
+    return woken;
+}
+
+void module_redis_blocking_waiter_served(
+        module_redis_blocking_waiter_t *waiter) {
+    timespec_t now, latency;
+    worker_stats_t *stats = worker_stats_get_internal_current();
+
+    clock_monotonic(&now);
+    clock_diff(&now, &waiter->woken_on, &latency);
+    uint64_t latency_us = (latency.tv_sec * 1000000) + (latency.tv_nsec / 1000);
+
+    stats->blocking.served++;
+    stats->blocking.push_to_pop_latency_us += latency_us;
+    if (latency_us > stats->blocking.push_to_pop_latency_us_max) {
+        stats->blocking.push_to_pop_latency_us_max = latency_us;
+    }
+}
+
+uint32_t module_redis_blocking_signal(
+        uint32_t database_number,
+        char *key,
+        size_t key_length,
+        uint32_t count) {
+    uint32_t woken_count = 0;
+    worker_context_t *worker_context = worker_context_get();
+    module_redis_blocking_bucket_t *bucket = &module_redis_blocking_buckets[module_redis_blocking_bucket_index(
+            database_number,
+            key,
+            key_length)];
+
+    // Pairs with the fence in module_redis_blocking_waiter_register, the changes to the list have already been
+    // committed so a waiter not yet registered will see them
+    MEMORY_FENCE_FULL();
+    if (likely(bucket->waiters_count == 0)) {
+        return 0;
+    }
+
+    spinlock_lock(&bucket->lock);
+
+    // The waiters are woken up in the same order they have been registered
+    double_linked_list_item_t *item = bucket->waiters.head;
+    while(item != NULL && woken_count < count) {
+        double_linked_list_item_t *next = item->next;
+        module_redis_blocking_waiter_entry_t *entry = item->data;
+        module_redis_blocking_waiter_t *waiter = entry->waiter;
+
+        if (waiter->database_number != database_number ||
+            entry->key->length != key_length ||
+            memcmp(entry->key->key, key, key_length) != 0) {
+            item = next;
+            continue;
+        }
+
+        // The waiter might have been already claimed via another key or it might be timing out
+        if (!__sync_bool_compare_and_swap(
+                &waiter->state,
+                MODULE_REDIS_BLOCKING_WAITER_STATE_WAITING,
+                MODULE_REDIS_BLOCKING_WAITER_STATE_CLAIMING)) {
+            item = next;
+            continue;
+        }
+
+        clock_monotonic(&waiter->woken_on);
+        waiter->woken_entry_index = entry - waiter->entries;
+
+        // The mailbox never drops a message, posting fails only if there isn't a mailbox at all, in which case a
+        // waiter owned by the current worker is woken up via a timer firing on the next tick, it can't be resumed
+        // here as the caller might still be holding the locks of other keys
+        if (unlikely(!worker_mailbox_post(
+                waiter->worker_index,
+                module_redis_blocking_waiter_wakeup_fp,
+                waiter))) {
+            if (worker_context != NULL && worker_context->worker_index == waiter->worker_index) {
+                worker_op_timer_add_ms(
+                        &waiter->wakeup_timer,
+                        0,
+                        module_redis_blocking_waiter_wakeup_timer_fp,
+                        waiter);
+            } else {
+                // The element is left to the next waiter, this one will be woken up by the next push or by its timer
+                LOG_W(TAG, "Unable to post the wakeup to the worker <%u>", waiter->worker_index);
+                waiter->state = MODULE_REDIS_BLOCKING_WAITER_STATE_WAITING;
+                MEMORY_FENCE_STORE();
+                item = next;
+                continue;
+            }
+        }
+
+        double_linked_list_remove_item(&bucket->waiters, item);
+        __sync_fetch_and_sub(&bucket->waiters_count, 1);
+        waiter->state = MODULE_REDIS_BLOCKING_WAITER_STATE_WOKEN;
+
+        // Once linked is false the waiter can go away at any time, it has to be the last change made to it
+        MEMORY_FENCE_STORE();
+        entry->linked = false;
+        MEMORY_FENCE_STORE();
+
+        woken_count++;
+        item = next;
+    }
+
+    spinlock_unlock(&bucket->lock);
+
+    return woken_count;
+}
@@ -0,0 +1,95 @@
+#ifndef CACHEGRAND_MODULE_REDIS_BLOCKING_H
+#define CACHEGRAND_MODULE_REDIS_BLOCKING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODULE_REDIS_BLOCKING_BUCKETS_COUNT (1024)
+
+// The clients blocked waiting for a key are tracked in a registry shared by all the workers, the keys are spread over a
+// fixed set of buckets, each one protected by its own spinlock, and every waiter is linked to the bucket of each key
+// it's waiting for. As the connections are pinned to the workers, the worker pushing onto a list claims the waiters
+// and posts the wakeup to the worker owning each one of them via the mailbox, the fiber is then resumed by the wakeup
+// or by its own timer, whatever comes first. While parked the socket of the client is watched, if the client goes away
+// the waiter is cancelled and a wakeup already delivered to it is passed on to the next one.
+// The state of the waiter is changed only via CAS, a waiter can be claimed only once, either by a pusher or by itself
+// when the timer fires, so a wakeup is never lost or delivered twice.
+enum module_redis_blocking_waiter_state {
+    MODULE_REDIS_BLOCKING_WAITER_STATE_WAITING = 0,
+    MODULE_REDIS_BLOCKING_WAITER_STATE_CLAIMING,
+    MODULE_REDIS_BLOCKING_WAITER_STATE_WOKEN,
+    MODULE_REDIS_BLOCKING_WAITER_STATE_CANCELLED,
+};
+typedef enum module_redis_blocking_waiter_state module_redis_blocking_waiter_state_t;
+
+typedef struct module_redis_blocking_waiter module_redis_blocking_waiter_t;
+
+typedef struct module_redis_blocking_waiter_entry module_redis_blocking_waiter_entry_t;
+struct module_redis_blocking_waiter_entry {
+    double_linked_list_item_t item;
+    module_redis_blocking_waiter_t *waiter;
+    module_redis_key_t *key;
+    uint32_t bucket_index;
+    bool linked;
+};
+
+struct module_redis_blocking_waiter {
+    fiber_t *fiber;
+    network_channel_t *channel;
+    timer_wheel_timer_t timer;
+    timer_wheel_timer_t wakeup_timer;
+    uint32_t worker_index;
+    uint32_t database_number;
+    uint32_volatile_t state;
+    bool timer_fired;
+    bool wakeup_received;
+    bool hangup;
+    bool parked;
+    timespec_t woken_on;
+    uint32_t woken_entry_index;
+    module_redis_blocking_waiter_entry_t *entries;
+    uint32_t entries_count;
+};
+
+typedef struct module_redis_blocking_bucket module_redis_blocking_bucket_t;
+struct module_redis_blocking_bucket {
+    spinlock_lock_volatile_t lock;
+    uint32_volatile_t waiters_count;
+    double_linked_list_t waiters;
+} __attribute__((aligned(64)));
+
+void module_redis_blocking_waiter_init(
+        module_redis_blocking_waiter_t *waiter,
+        network_channel_t *channel,
+        uint32_t database_number,
+        module_redis_key_t *keys,
+        uint32_t keys_count);
+
+void module_redis_blocking_waiter_free(
+        module_redis_blocking_waiter_t *waiter);
+
+void module_redis_blocking_waiter_register(
+        module_redis_blocking_waiter_t *waiter);
+
+void module_redis_blocking_waiter_cancel(
+        module_redis_blocking_waiter_t *waiter);
+
+bool module_redis_blocking_waiter_wait(
+        module_redis_blocking_waiter_t *waiter,
+        int64_t deadline_ms);
+
+void module_redis_blocking_waiter_served(
+        module_redis_blocking_waiter_t *waiter);
+
+uint32_t module_redis_blocking_signal(
+        uint32_t database_number,
+        char *key,
+        size_t key_length,
+        uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_BLOCKING_H
@@ -20,7 +20,9 @@
 
 #include "misc.h"
 #include "exttypes.h"
+#include "pow2.h"
 #include "xalloc.h"
+#include "xalloc_arena.h"
 #include "log/log.h"
 #include "spinlock.h"
 #include "transaction.h"
@@ -44,6 +46,9 @@
 #include "storage/db/storage_db.h"
 #include "module/redis/module_redis.h"
 #include "module_redis_connection.h"
+#include "module_redis_transaction.h"
+#include "module_redis_pubsub.h"
+#include "module_redis_tracking.h"
 
 #include "module_redis_command.h"
 
@@ -54,7 +59,8 @@ bool module_redis_command_process_begin(
     module_redis_command_parser_context_t *command_parser_context = &connection_context->command.parser_context;
 
     if (connection_context->command.info->context_size > 0) {
-        if ((connection_context->command.context = xalloc_alloc_zero(
+        if ((connection_context->command.context = xalloc_arena_alloc_zero(
+                connection_context->command.arena,
                 connection_context->command.info->context_size)) == NULL) {
             LOG_D(TAG, "Unable to allocate the command context, terminating connection");
             return false;
@@ -135,32 +141,35 @@ void *module_redis_command_get_base_context_from_argument(
 }
 
 void *module_redis_command_context_list_expand_and_get_new_entry(
+        xalloc_arena_t *arena,
         module_redis_command_argument_t *argument,
         void *base_addr) {
-    void *list = NULL, *list_new = NULL, *new_list_entry;
+    void *list = NULL, *new_list_entry;
 
     int list_count = module_redis_command_context_list_get_count(argument, base_addr);
     int list_count_new = list_count + 1;
 
     // If the list_count is zero it's not necessary to get the current pointer
     if (list_count == 0) {
-        list = xalloc_alloc_zero(list_count_new * argument->argument_context_member_size);
+        list = xalloc_arena_alloc_zero(arena, list_count_new * argument->argument_context_member_size);
     } else {
         list = module_redis_command_context_list_get_list(argument, base_addr);
-        size_t current_size = list_count * argument->argument_context_member_size;
-        size_t new_size = list_count_new * argument->argument_context_member_size;
 
-        list_new = xalloc_realloc(
-                list,
-                new_size);
-
-        // Zero the new memory
-        memset(list_new + current_size, 0, new_size - current_size);
-
-        list = list_new;
-
-        if (!list) {
-            return NULL;
+        // The capacity of the list is always the power of 2 equal or greater than the count, therefore the list has to
+        // be expanded only when the count is a power of 2. If the list is the last allocation done in the arena, as it
+        // happens when the arguments are parsed in sequence, it's expanded in place without having to copy the data.
+        if (pow2_is(list_count)) {
+            size_t current_size = list_count * argument->argument_context_member_size;
+            size_t new_size = (list_count * 2) * argument->argument_context_member_size;
+
+            list = xalloc_arena_realloc(
+                    arena,
+                    list,
+                    current_size,
+                    new_size);
+
+            // Zero the new memory
+            memset(list + current_size, 0, new_size - current_size);
         }
     }
 
@@ -173,6 +182,7 @@ void *module_redis_command_context_list_expand_and_get_new_entry(
 }
 
 void *module_redis_command_context_get_argument_member_context_addr(
+        xalloc_arena_t *arena,
         module_redis_command_argument_t *argument,
         bool is_in_block,
         int block_argument_index,
@@ -199,6 +209,7 @@ void *module_redis_command_context_get_argument_member_context_addr(
         //   the list without expanding it
         if (is_in_block == false || block_argument_index == 0) {
             argument_member_context_addr = module_redis_command_context_list_expand_and_get_new_entry(
+                    arena,
                     stopped_at_list_argument,
                     argument_member_context_addr);
         } else if (block_argument_index > 0) {
@@ -232,6 +243,36 @@ void *module_redis_command_context_get_argument_member_context_addr(
     return argument_member_context_addr;
 }
 
+static inline __attribute__((always_inline)) void *module_redis_command_context_get_argument_member_context_addr_with_fast_path(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_argument_t *argument,
+        bool is_in_block,
+        int block_argument_index) {
+    module_redis_command_info_t *command_info = connection_context->command.info;
+
+    // The hottest commands have a generated resolver for the positional arguments that doesn't need to walk the
+    // arguments tree, if the argument isn't handled by it (e.g. tokens) the generic path is used
+    if (command_info->argument_member_context_addr_fast_path_funcptr != NULL) {
+        void *argument_member_context_addr = command_info->argument_member_context_addr_fast_path_funcptr(
+                connection_context->command.arena,
+                argument,
+                is_in_block,
+                block_argument_index,
+                connection_context->command.context);
+
+        if (likely(argument_member_context_addr != NULL)) {
+            return argument_member_context_addr;
+        }
+    }
+
+    return module_redis_command_context_get_argument_member_context_addr(
+            connection_context->command.arena,
+            argument,
+            is_in_block,
+            block_argument_index,
+            connection_context->command.context);
+}
+
 bool module_redis_command_is_key_pattern_allowed_length(
         module_redis_connection_context_t *connection_context,
         module_redis_command_argument_t *argument,
@@ -298,11 +339,11 @@ bool module_redis_command_process_argument_begin(
 
     if (expected_argument->type == MODULE_REDIS_COMMAND_ARGUMENT_TYPE_LONG_STRING) {
         command_parser_context->current_argument.member_context_addr =
-                module_redis_command_context_get_argument_member_context_addr(
+                module_redis_command_context_get_argument_member_context_addr_with_fast_path(
+                        connection_context,
                         expected_argument,
                         is_in_block,
-                        command_parser_context->current_argument.block_argument_index,
-                        connection_context->command.context);
+                        command_parser_context->current_argument.block_argument_index);
 
         module_redis_long_string_t *string = command_parser_context->current_argument.member_context_addr;
 
@@ -402,6 +443,54 @@ bool module_redis_command_process_argument_stream_data(
     return true;
 }
 
+char *module_redis_command_process_argument_stream_get_direct_buffer(
+        module_redis_connection_context_t *connection_context,
+        size_t *buffer_length) {
+    module_redis_long_string_t *string;
+    storage_db_chunk_info_t *chunk_info;
+    module_redis_command_parser_context_t *command_parser_context = &connection_context->command.parser_context;
+
+    // The data can be received directly only into the chunks allocated in memory, the file backend requires the data
+    // to be written via the storage channel
+    if (connection_context->db->config->backend_type != STORAGE_DB_BACKEND_TYPE_MEMORY) {
+        return NULL;
+    }
+
+    string = command_parser_context->current_argument.member_context_addr;
+    chunk_info = storage_db_chunk_sequence_get(
+            &string->chunk_sequence,
+            string->current_chunk.index);
+
+    if (unlikely(chunk_info == NULL)) {
+        return NULL;
+    }
+
+    *buffer_length = chunk_info->chunk_length - string->current_chunk.offset;
+    return (char*)chunk_info->memory.chunk_data + string->current_chunk.offset;
+}
+
+void module_redis_command_process_argument_stream_direct_data_received(
+        module_redis_connection_context_t *connection_context,
+        size_t received_length) {
+    module_redis_command_parser_context_t *command_parser_context = &connection_context->command.parser_context;
+    module_redis_long_string_t *string = command_parser_context->current_argument.member_context_addr;
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(
+            &string->chunk_sequence,
+            string->current_chunk.index);
+
+    // The buffer returned by module_redis_command_process_argument_stream_get_direct_buffer never crosses the chunk
+    // boundaries so at most the current chunk can be filled
+    assert(chunk_info != NULL);
+    assert(string->current_chunk.offset + received_length <= chunk_info->chunk_length);
+
+    string->current_chunk.offset += (off_t)received_length;
+
+    if (string->current_chunk.offset == chunk_info->chunk_length) {
+        string->current_chunk.index++;
+        string->current_chunk.offset = 0;
+    }
+}
+
 bool module_redis_command_process_argument_full(
         module_redis_connection_context_t *connection_context,
         char *chunk_data,
@@ -566,11 +655,11 @@ bool module_redis_command_process_argument_full(
     }
 
     command_parser_context->current_argument.member_context_addr =
-            module_redis_command_context_get_argument_member_context_addr(
+            module_redis_command_context_get_argument_member_context_addr_with_fast_path(
+                    connection_context,
                     guessed_argument,
                     is_in_block,
-                    block_argument_index,
-                    connection_context->command.context);
+                    block_argument_index);
 
     void *base_addr = module_redis_command_context_base_addr_skip_has_token(
             guessed_argument,
@@ -607,7 +696,14 @@ bool module_redis_command_process_argument_full(
                        guessed_argument->name);
             }
 
-            string_value = xalloc_alloc(chunk_length);
+            // The keys are always allocated on the heap as the ownership of the memory might be passed to the storage
+            // db by the commands, patterns and short strings are instead only used while processing the command so
+            // they can be allocated from the arena
+            if (guessed_argument->type == MODULE_REDIS_COMMAND_ARGUMENT_TYPE_KEY) {
+                string_value = xalloc_alloc(chunk_length);
+            } else {
+                string_value = xalloc_arena_alloc(connection_context->command.arena, chunk_length);
+            }
 
             if (!string_value) {
                 LOG_E(TAG, "Failed to allocate memory for the incoming data");
@@ -620,6 +716,18 @@ bool module_redis_command_process_argument_full(
                 module_redis_key_t *key = base_addr;
                 key->key = string_value;
                 key->length = chunk_length;
+
+                // The keys of the commands queued after MULTI are tracked to lock them all at once on EXEC
+                if (unlikely(connection_context->transaction.queueing)) {
+                    if (unlikely(!module_redis_transaction_track_key(connection_context, string_value, chunk_length))) {
+                        return false;
+                    }
+                }
+
+                // The keys read by the clients caching them are remembered to send the invalidations when they change
+                if (unlikely(connection_context->tracking.enabled && guessed_argument->is_read_only_key)) {
+                    module_redis_tracking_remember_key(connection_context, string_value, chunk_length);
+                }
             } else if (guessed_argument->type == MODULE_REDIS_COMMAND_ARGUMENT_TYPE_PATTERN) {
                 module_redis_pattern_t *pattern = base_addr;
                 pattern->pattern = string_value;
@@ -679,6 +787,8 @@ bool module_redis_command_process_argument_end(
     module_redis_command_argument_t *next_expected_argument =
             command_parser_context->current_argument.next_expected_argument;
 
+    command_parser_context->arguments_processed_count++;
+
     if (next_expected_argument) {
         command_parser_context->current_argument.next_expected_argument = NULL;
         command_parser_context->current_argument.expected_argument = next_expected_argument;
@@ -734,6 +844,34 @@ bool module_redis_command_process_argument_end(
                 }
             }
         }
+    } else {
+        // A positional argument with multiple occurrences consumes all the arguments unless it's followed by required
+        // positional arguments (e.g. BLPOP key [key ...] timeout), in which case it has to stop as soon as the
+        // arguments left are just enough to fill them
+        uint16_t trailing_arguments_count = 0;
+        for(
+                uint16_t index = command_parser_context->positional_arguments_parsed_count + 1;
+                index < connection_context->command.info->arguments_count;
+                index++) {
+            module_redis_command_argument_t *argument = &connection_context->command.info->arguments[index];
+            if (!argument->is_positional || argument->is_optional ||
+                argument->type == MODULE_REDIS_COMMAND_ARGUMENT_TYPE_BLOCK ||
+                argument->type == MODULE_REDIS_COMMAND_ARGUMENT_TYPE_ONEOF) {
+                break;
+            }
+
+            trailing_arguments_count++;
+        }
+
+        uint32_t arguments_left_count =
+                connection_context->reader_context.arguments.count - 1 - connection_context->command.arguments_offset -
+                command_parser_context->arguments_processed_count;
+
+        if (trailing_arguments_count > 0 && arguments_left_count == trailing_arguments_count) {
+            command_parser_context->positional_arguments_parsed_count++;
+            expected_argument = &connection_context->command.info->arguments[
+                    command_parser_context->positional_arguments_parsed_count];
+        }
     }
 
     command_parser_context->current_argument.expected_argument = expected_argument;
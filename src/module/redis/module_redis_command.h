@@ -21,6 +21,11 @@ struct module_redis_command_context_has_token_padding_detection {
 bool module_redis_command_process_begin(
         module_redis_connection_context_t *connection_context);
 
+void *module_redis_command_context_list_expand_and_get_new_entry(
+        struct xalloc_arena *arena,
+        module_redis_command_argument_t *argument,
+        void *base_addr);
+
 bool module_redis_command_process_argument_begin(
         module_redis_connection_context_t *connection_context,
         uint32_t argument_length);
@@ -30,6 +35,14 @@ bool module_redis_command_process_argument_stream_data(
         char *chunk_data,
         size_t chunk_length);
 
+char *module_redis_command_process_argument_stream_get_direct_buffer(
+        module_redis_connection_context_t *connection_context,
+        size_t *buffer_length);
+
+void module_redis_command_process_argument_stream_direct_data_received(
+        module_redis_connection_context_t *connection_context,
+        size_t received_length);
+
 bool module_redis_command_process_argument_full(
         module_redis_connection_context_t *connection_context,
         char *chunk_data,
@@ -60,15 +73,20 @@ bool module_redis_command_stream_entry_range_with_multiple_chunks(
         off_t offset,
         size_t length);
 
-static inline __attribute__((always_inline)) bool module_redis_command_process_end(
-        module_redis_connection_context_t *connection_context) {
+static inline __attribute__((always_inline)) bool module_redis_command_process_end_validate(
+        module_redis_connection_context_t *connection_context,
+        bool *valid) {
     module_redis_command_parser_context_t *command_parser_context = &connection_context->command.parser_context;
     module_redis_command_argument_t *expected_argument = command_parser_context->current_argument.expected_argument;
 
+    *valid = true;
+
     if (
             expected_argument &&
             expected_argument->type == MODULE_REDIS_COMMAND_ARGUMENT_TYPE_BLOCK &&
             command_parser_context->current_argument.block_argument_index > 0) {
+        *valid = false;
+
         if (expected_argument->is_positional) {
             return module_redis_connection_error_message_printf_noncritical(
                     connection_context,
@@ -83,6 +101,21 @@ static inline __attribute__((always_inline)) bool module_redis_command_process_e
         }
     }
 
+    return true;
+}
+
+static inline __attribute__((always_inline)) bool module_redis_command_process_end(
+        module_redis_connection_context_t *connection_context) {
+    bool valid;
+
+    if (unlikely(!module_redis_command_process_end_validate(connection_context, &valid))) {
+        return false;
+    }
+
+    if (unlikely(!valid)) {
+        return true;
+    }
+
     return connection_context->command.info->command_end_funcptr(
             connection_context);
 }
@@ -101,7 +134,7 @@ static inline __attribute__((always_inline)) void module_redis_command_process_f
     connection_context->command.info->command_free_funcptr(
             connection_context);
 
-    xalloc_free(connection_context->command.context);
+    // The command context is allocated from the arena, which is reset in module_redis_connection_context_reset
     connection_context->command.context = NULL;
 }
 
@@ -11,6 +11,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
+#include <strings.h>
 #include <arpa/inet.h>
 #include <assert.h>
 
@@ -22,6 +23,7 @@
 #include "clock.h"
 #include "config.h"
 #include "xalloc.h"
+#include "xalloc_arena.h"
 #include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
 #include "data_structures/double_linked_list/double_linked_list.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
@@ -37,28 +39,23 @@
 #include "storage/channel/storage_channel.h"
 #include "storage/db/storage_db.h"
 #include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
 
 #include "module_redis_commands.h"
 
 #include "module_redis_autogenerated_commands_callbacks.h"
 #include "module_redis_autogenerated_commands_arguments.h"
 #include "module_redis_autogenerated_commands_info_map.h"
+#include "module_redis_autogenerated_commands_dispatch.h"
 
 #define TAG "module_redis_commands"
 
-hashtable_spsc_t *module_redis_commands_hashtable = NULL;
 hashtable_spsc_t *module_redis_disabled_commands_hashtable = NULL;
 
 FUNCTION_CTOR(module_redis_commands_ctor, {
     uint32_t command_infos_map_count = sizeof(command_infos_map) / sizeof(module_redis_command_info_t);
 
-    module_redis_commands_hashtable = module_redis_commands_build_commands_hashtables(
-            command_infos_map,
-            command_infos_map_count);
-    if (!module_redis_commands_hashtable) {
-        FATAL(TAG, "Unable to generate the commands hashtable");
-    }
-
     if (!module_redis_commands_build_commands_arguments_token_entries_hashtable(
             command_infos_map,
             command_infos_map_count)) {
@@ -68,44 +65,44 @@ FUNCTION_CTOR(module_redis_commands_ctor, {
 
         FATAL(TAG, "Unable to generate the commands arguments tokens hashtables");
     }
+
+    module_redis_autogenerated_commands_dispatch_register_fast_paths(command_infos_map);
 });
 
 FUNCTION_DTOR(module_redis_commands_dtor, {
     uint32_t command_infos_map_count = sizeof(command_infos_map) / sizeof(module_redis_command_info_t);
 
-    if (module_redis_commands_hashtable) {
-        hashtable_spsc_free(module_redis_commands_hashtable);
-    }
-
     module_redis_commands_free_commands_arguments_token_entries_hashtable(
             command_infos_map,
             command_infos_map_count);
 });
 
-hashtable_spsc_t *module_redis_commands_build_commands_hashtables(
-        module_redis_command_info_t *command_infos,
-        uint32_t command_infos_count) {
-    hashtable_spsc_t *commands_hashtable = hashtable_spsc_new(
-            command_infos_count * 2,
-            32,
-            false);
-    for(
-            uint32_t command_info_index = 0;
-            command_info_index < command_infos_count;
-            command_info_index++) {
-        module_redis_command_info_t *command_info = &command_infos[command_info_index];
+module_redis_command_info_t *module_redis_commands_lookup(
+        char *command,
+        size_t command_length) {
+    module_redis_command_info_t *command_info;
 
-        if (!hashtable_spsc_op_try_set_ci(
-                commands_hashtable,
-                command_info->string,
-                command_info->string_len,
-                command_info)) {
-            hashtable_spsc_free(commands_hashtable);
-            return NULL;
-        }
+    if (unlikely(command_length > MODULE_REDIS_COMMAND_MAX_LENGTH)) {
+        return NULL;
+    }
+
+    // The dispatch table is generated at build time with a perfect hash function, every command maps to a different
+    // slot so the lookup requires only a single comparison to ensure that the command matches
+    uint16_t command_info_index = module_redis_autogenerated_commands_dispatch_table[
+            module_redis_autogenerated_commands_dispatch_hash(command, command_length)];
+
+    if (command_info_index == 0) {
+        return NULL;
+    }
+
+    command_info = &command_infos_map[command_info_index - 1];
+
+    if (command_info->string_len != command_length ||
+        strncasecmp(command_info->string, command, command_length) != 0) {
+        return NULL;
     }
 
-    return commands_hashtable;
+    return command_info;
 }
 
 void module_redis_commands_set_disabled_commands_hashtables(
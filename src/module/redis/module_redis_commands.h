@@ -5,7 +5,6 @@
 extern "C" {
 #endif
 
-extern hashtable_spsc_t *module_redis_commands_hashtable;
 extern hashtable_spsc_t *module_redis_disabled_commands_hashtable;
 
 void module_redis_commands_set_disabled_commands_hashtables(
@@ -20,9 +19,9 @@ hashtable_spsc_t *module_redis_commands_build_disabled_commands_hashtables(
 void module_redis_commands_free_disabled_commands_hashtables(
         hashtable_spsc_t *hashtable);
 
-hashtable_spsc_t *module_redis_commands_build_commands_hashtables(
-        module_redis_command_info_t *command_infos,
-        uint32_t command_infos_count);
+module_redis_command_info_t *module_redis_commands_lookup(
+        char *command,
+        size_t command_length);
 
 uint16_t module_redis_commands_count_tokens_in_command_arguments(
         module_redis_command_argument_t *arguments,
@@ -16,6 +16,8 @@
 
 #include "misc.h"
 #include "exttypes.h"
+#include "xalloc.h"
+#include "xalloc_arena.h"
 #include "log/log.h"
 #include "spinlock.h"
 #include "transaction.h"
@@ -37,6 +39,7 @@
 #include "storage/db/storage_db.h"
 #include "worker/worker_stats.h"
 #include "worker/worker_context.h"
+#include "worker/worker_rebalancer.h"
 #include "network/network.h"
 #include "protocol/redis/protocol_redis.h"
 #include "protocol/redis/protocol_redis_writer.h"
@@ -46,6 +49,9 @@
 #include "module_redis_connection.h"
 #include "module_redis_command.h"
 #include "module_redis_commands.h"
+#include "module_redis_transaction.h"
+#include "module_redis_pubsub.h"
+#include "module_redis_tracking.h"
 
 #define TAG "module_redis_connection"
 
@@ -58,8 +64,9 @@ void module_redis_connection_context_init(
     connection_context->db = db;
     connection_context->config = config;
     connection_context->network_channel = network_channel;
-    connection_context->read_buffer.data = (char *)xalloc_alloc_zero(NETWORK_CHANNEL_RECV_BUFFER_SIZE);
-    connection_context->read_buffer.length = NETWORK_CHANNEL_RECV_BUFFER_SIZE;
+    network_buffer_init(&connection_context->read_buffer, NETWORK_CHANNEL_RECV_BUFFER_SIZE);
+    connection_context->command.arena = xalloc_arena_new(MODULE_REDIS_COMMAND_ARENA_BLOCK_SIZE);
+    module_redis_tracking_connection_register(connection_context);
 }
 
 void module_redis_connection_context_cleanup(
@@ -67,7 +74,11 @@ void module_redis_connection_context_cleanup(
     if (connection_context->client_name) {
         xalloc_free(connection_context->client_name);
     }
-    xalloc_free(connection_context->read_buffer.data);
+    module_redis_transaction_cleanup(connection_context);
+    module_redis_tracking_connection_unregister(connection_context);
+    module_redis_pubsub_connection_cleanup(connection_context);
+    network_buffer_free(&connection_context->read_buffer);
+    xalloc_arena_free(connection_context->command.arena);
 }
 
 void module_redis_connection_context_reset(
@@ -89,6 +100,22 @@ void module_redis_connection_context_reset(
 
     memset(&connection_context->command.parser_context, 0, sizeof(module_redis_command_parser_context_t));
 
+#if DEBUG == 1
+    worker_stats_t *stats = worker_stats_get_internal_current();
+    uint32_t arena_allocations_count = xalloc_arena_get_allocations_count(connection_context->command.arena);
+    if (arena_allocations_count > 0) {
+        stats->debug.command_arena_allocations += arena_allocations_count;
+        if (arena_allocations_count > stats->debug.command_arena_allocations_max) {
+            stats->debug.command_arena_allocations_max = arena_allocations_count;
+        }
+        stats->debug.command_arena_commands++;
+    }
+#endif
+
+    // All the memory allocated from the arena while processing the command (the command context, the lists and the
+    // short strings) is released in one go
+    xalloc_arena_reset(connection_context->command.arena);
+
     if (connection_context->error.message != NULL) {
         xalloc_free(connection_context->error.message);
         connection_context->error.message = NULL;
@@ -537,6 +564,35 @@ bool module_redis_connection_send_array(
     return true;
 }
 
+bool module_redis_connection_send_array_null(
+        module_redis_connection_context_t *connection_context) {
+    network_channel_buffer_data_t *send_buffer, *send_buffer_start;
+    size_t slice_length = 16;
+    send_buffer = send_buffer_start = network_send_buffer_acquire_slice(
+            connection_context->network_channel,
+            slice_length);
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "Unable to acquire send buffer slice!");
+        return false;
+    }
+
+    if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        send_buffer_start = protocol_redis_writer_write_array_null(
+                send_buffer_start,
+                slice_length);
+    } else {
+        send_buffer_start = protocol_redis_writer_write_null(
+                send_buffer_start,
+                slice_length);
+    }
+
+    network_send_buffer_release_slice(
+            connection_context->network_channel,
+            send_buffer_start ? send_buffer_start - send_buffer : 0);
+
+    return true;
+}
+
 bool module_redis_connection_flush_and_close(
         module_redis_connection_context_t *connection_context) {
     if (network_flush_send_buffer(
@@ -558,6 +614,80 @@ bool module_redis_connection_command_too_long(
         connection_context->network_channel->module_config->redis->max_command_length;
 }
 
+bool module_redis_connection_can_receive_direct(
+        module_redis_connection_context_t *connection_context) {
+    protocol_redis_reader_context_t *reader_context = &connection_context->reader_context;
+
+    // The data can be received directly into the chunks only if everything in the read buffer has been processed, the
+    // reader is waiting for the data of a long string argument and there is enough data left to be worth it, the tail
+    // of the argument is received via the read buffer together with the end signature and the following commands
+    if (connection_context->read_buffer.data_size > 0 ||
+        connection_context->command.skip ||
+        connection_context->command.info == NULL ||
+        reader_context->state != PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA ||
+        !module_redis_command_process_argument_require_stream(connection_context)) {
+        return false;
+    }
+
+    size_t argument_waiting_data_length =
+            reader_context->arguments.current.length - reader_context->arguments.current.received_length;
+
+    if (argument_waiting_data_length < MODULE_REDIS_COMMAND_STREAM_DIRECT_RECEIVE_MIN_LENGTH) {
+        return false;
+    }
+
+    // Let the normal path report the error if the command is too long
+    if (connection_context->command.data_length + argument_waiting_data_length >
+        connection_context->network_channel->module_config->redis->max_command_length) {
+        return false;
+    }
+
+    return connection_context->db->config->backend_type == STORAGE_DB_BACKEND_TYPE_MEMORY;
+}
+
+bool module_redis_connection_receive_direct(
+        module_redis_connection_context_t *connection_context) {
+    size_t buffer_length, received_length;
+    protocol_redis_reader_context_t *reader_context = &connection_context->reader_context;
+    size_t argument_waiting_data_length =
+            reader_context->arguments.current.length - reader_context->arguments.current.received_length;
+
+    char *buffer = module_redis_command_process_argument_stream_get_direct_buffer(
+            connection_context,
+            &buffer_length);
+
+    if (unlikely(buffer == NULL)) {
+        return false;
+    }
+
+    if (buffer_length > argument_waiting_data_length) {
+        buffer_length = argument_waiting_data_length;
+    }
+
+    if (unlikely(network_receive_direct(
+            connection_context->network_channel,
+            buffer,
+            buffer_length,
+            &received_length) != NETWORK_OP_RESULT_OK)) {
+        return false;
+    }
+
+    module_redis_command_process_argument_stream_direct_data_received(
+            connection_context,
+            received_length);
+
+    // Update the reader context as if the data had been parsed, once all the data of the argument have been received
+    // the reader will wait for the end signature
+    reader_context->arguments.current.received_length += received_length;
+    connection_context->command.data_length += received_length;
+
+    if (received_length == argument_waiting_data_length) {
+        reader_context->state = PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA_END;
+    }
+
+    return true;
+}
+
 bool module_redis_connection_authenticate(
         module_redis_connection_context_t *connection_context,
         char *client_username,
@@ -597,57 +727,162 @@ bool module_redis_connection_is_authenticated(
         connection_context->authenticated;
 }
 
-void module_redis_connection_accept(
-        network_channel_t *network_channel) {
-    bool exit_loop = false;
-    module_redis_connection_context_t connection_context = { 0 };
+bool module_redis_connection_can_migrate(
+        module_redis_connection_context_t *connection_context) {
+    // The connection can be moved to another worker only between two commands, when everything received has been
+    // processed
+    return connection_context->read_buffer.data_size == 0 &&
+        connection_context->command.info == NULL &&
+        connection_context->reader_context.state == PROTOCOL_REDIS_READER_STATE_BEGIN &&
+        module_redis_pubsub_connection_can_migrate(connection_context) &&
+        module_redis_tracking_connection_can_migrate(connection_context);
+}
 
-    module_redis_connection_context_init(
-            &connection_context,
-            worker_context_get()->db,
-            worker_context_get()->config,
-            network_channel);
+bool module_redis_connection_try_migrate(
+        module_redis_connection_context_t *connection_context,
+        bool *migrated) {
+    uint32_t target_worker_index;
+    network_channel_t *network_channel = connection_context->network_channel;
 
-    do {
+    *migrated = false;
+
+    if (likely(!module_redis_connection_can_migrate(connection_context) ||
+        !worker_rebalancer_connection_should_migrate(network_channel, &target_worker_index))) {
+        return false;
+    }
+
+    if (network_flush_send_buffer(network_channel) != NETWORK_OP_RESULT_OK) {
+        return true;
+    }
+
+    // The connection can't be reached by the invalidations while it's moving, if some client started to redirect its
+    // invalidations to it the connection stays where it is
+    if (unlikely(!module_redis_tracking_connection_detach(connection_context))) {
+        return false;
+    }
+
+    // The read buffer is empty, no reason to copy it over
+    network_buffer_free(&connection_context->read_buffer);
+
+    module_redis_connection_context_t *connection_context_migrated =
+            xalloc_alloc(sizeof(module_redis_connection_context_t));
+    memcpy(connection_context_migrated, connection_context, sizeof(module_redis_connection_context_t));
+
+    if (unlikely(!worker_rebalancer_connection_migrate(
+            network_channel,
+            target_worker_index,
+            connection_context_migrated))) {
+        xalloc_free(connection_context_migrated);
+        module_redis_tracking_connection_attach(connection_context);
+
+        // If the connection couldn't be taken back it's not usable anymore
+        return network_channel->status != NETWORK_CHANNEL_STATUS_CONNECTED;
+    }
+
+    *migrated = true;
+    return true;
+}
+
+static void module_redis_connection_serve(
+        module_redis_connection_context_t *connection_context) {
+    bool migrated = false;
+    network_channel_t *network_channel = connection_context->network_channel;
+    bool exit_loop = network_channel->status != NETWORK_CHANNEL_STATUS_CONNECTED;
+
+    while(!exit_loop) {
         if (unlikely(!network_buffer_has_enough_space(
-                &connection_context.read_buffer,
+                &connection_context->read_buffer,
                 NETWORK_CHANNEL_MAX_PACKET_SIZE))) {
             module_redis_connection_error_message_printf_critical(
-                    &connection_context,
+                    connection_context,
                     "ERR command too long");
-            module_redis_connection_send_error(&connection_context);
+            module_redis_connection_send_error(connection_context);
 
             exit_loop = true;
         }
 
+        // If the client is not reading the replies, stop parsing its commands until the output buffer gets back
+        // within the limits or close the connection if they are exceeded
         if (likely(!exit_loop)) {
-            if (unlikely(network_buffer_needs_rewind(
-                    &connection_context.read_buffer,
-                    NETWORK_CHANNEL_MAX_PACKET_SIZE))) {
-                network_buffer_rewind(&connection_context.read_buffer);
-            }
+            exit_loop = network_output_buffer_wait_within_limits(network_channel) != NETWORK_OP_RESULT_OK;
+        }
+
+        // Large values are received directly into the chunks, skipping the copy from the read buffer
+        if (likely(!exit_loop) && module_redis_connection_can_receive_direct(connection_context)) {
+            exit_loop = !module_redis_connection_receive_direct(connection_context);
+            continue;
+        }
 
+        // The pub/sub messages delivered while the commands were being processed are written out before waiting for
+        // new data, the ones delivered while waiting are written out by a writer fiber
+        if (likely(!exit_loop)) {
+            exit_loop = !module_redis_pubsub_connection_before_receive(connection_context);
+        }
+
+        if (likely(!exit_loop)) {
+            // The read buffer is allocated, grown or rewound by network_receive as needed
             exit_loop = network_receive(
                     network_channel,
-                    &connection_context.read_buffer,
+                    &connection_context->read_buffer,
                     NETWORK_CHANNEL_MAX_PACKET_SIZE) != NETWORK_OP_RESULT_OK;
         }
 
+        module_redis_pubsub_connection_after_receive(connection_context);
+
         if (likely(!exit_loop)) {
             exit_loop = !module_redis_connection_process_data(
-                    &connection_context,
-                    &connection_context.read_buffer);
+                    connection_context,
+                    &connection_context->read_buffer);
         }
-    } while(!exit_loop);
+
+        // If the worker is overloaded the connection might be handed over to another worker
+        if (likely(!exit_loop)) {
+            exit_loop = module_redis_connection_try_migrate(connection_context, &migrated);
+        }
+    }
+
+    // The connection context is now owned by the worker that took over the connection
+    if (migrated) {
+        return;
+    }
 
     // Ensure that the command context is always freed if data are allocated when the peer closes the connection or
     // module_redis_process_data returns false and the receiving loop above terminates immediately
     module_redis_command_process_try_free(
-            &connection_context);
+            connection_context);
     module_redis_connection_context_reset(
-            &connection_context);
+            connection_context);
     module_redis_connection_context_cleanup(
-            &connection_context);
+            connection_context);
+}
+
+void module_redis_connection_accept(
+        network_channel_t *network_channel) {
+    module_redis_connection_context_t connection_context = { 0 };
+
+    module_redis_connection_context_init(
+            &connection_context,
+            worker_context_get()->db,
+            worker_context_get()->config,
+            network_channel);
+
+    module_redis_connection_serve(&connection_context);
+}
+
+void module_redis_connection_resume(
+        network_channel_t *network_channel,
+        void *connection_context_migrated) {
+    module_redis_connection_context_t connection_context;
+
+    memcpy(&connection_context, connection_context_migrated, sizeof(module_redis_connection_context_t));
+    xalloc_free(connection_context_migrated);
+
+    connection_context.network_channel = network_channel;
+    connection_context.db = worker_context_get()->db;
+    connection_context.config = worker_context_get()->config;
+    module_redis_tracking_connection_attach(&connection_context);
+
+    module_redis_connection_serve(&connection_context);
 }
 
 bool module_redis_connection_process_data(
@@ -754,8 +989,7 @@ bool module_redis_connection_process_data(
                     }
 
                     // Try to fetch the current command
-                    connection_context->command.info = hashtable_spsc_op_get_ci(
-                            module_redis_commands_hashtable,
+                    connection_context->command.info = module_redis_commands_lookup(
                             command_data_to_search,
                             command_data_to_search_length);
 
@@ -814,6 +1048,18 @@ bool module_redis_connection_process_data(
                             "[RECV][REDIS] <%s> command received",
                             connection_context->command.info->string);
 
+                    // With RESP2 the subscribed connections can only receive messages and manage the subscriptions
+                    if (unlikely(module_redis_pubsub_connection_is_subscribed(connection_context) &&
+                                 connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2 &&
+                                 !module_redis_pubsub_is_command_allowed_when_subscribed(
+                                         connection_context->command.info))) {
+                        module_redis_connection_error_message_printf_noncritical(
+                                connection_context,
+                                "ERR Can't execute '%s': only (P)SUBSCRIBE / (P)UNSUBSCRIBE / PING / QUIT are allowed in this context",
+                                connection_context->command.info->string);
+                        continue;
+                    }
+
                     // Check if the command has been found and if the required arguments are going to be provided else
                     if (unlikely(connection_context->command.info->required_arguments_count >
                                  connection_context->reader_context.arguments.count - 1 - connection_context->command.arguments_offset)) {
@@ -921,8 +1167,20 @@ bool module_redis_connection_process_data(
                         }
                     }
                 } else if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END) {
-                    if (unlikely(!module_redis_command_process_end(connection_context))) {
-                        goto end;
+                    // After MULTI the commands are queued instead of being executed
+                    if (unlikely(module_redis_transaction_should_queue_command(connection_context))) {
+                        if (unlikely(!module_redis_transaction_queue_command(connection_context))) {
+                            goto end;
+                        }
+                    } else {
+                        // The invalidations of the keys changed by the command are dispatched once it has been executed
+                        module_redis_tracking_command_begin(connection_context);
+                        bool command_processed = module_redis_command_process_end(connection_context);
+                        module_redis_tracking_command_end();
+
+                        if (unlikely(!command_processed)) {
+                            goto end;
+                        }
                     }
                 }
             }
@@ -933,6 +1191,11 @@ bool module_redis_connection_process_data(
                 connection_context->reader_context.error != PROTOCOL_REDIS_READER_ERROR_OK);
 
         if (unlikely(module_redis_connection_has_error(connection_context))) {
+            // A command that fails while being queued aborts the transaction
+            if (unlikely(connection_context->transaction.queueing)) {
+                module_redis_transaction_flag_error(connection_context);
+            }
+
             if (!module_redis_connection_send_error(connection_context)) {
                 goto end;
             }
@@ -8,6 +8,17 @@ extern "C" {
 void module_redis_connection_accept(
         network_channel_t *channel);
 
+void module_redis_connection_resume(
+        network_channel_t *network_channel,
+        void *connection_context_migrated);
+
+bool module_redis_connection_can_migrate(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_connection_try_migrate(
+        module_redis_connection_context_t *connection_context,
+        bool *migrated);
+
 bool module_redis_connection_process_data(
         module_redis_connection_context_t *connection_context,
         network_channel_buffer_t *read_buffer);
@@ -85,12 +96,21 @@ bool module_redis_connection_send_array(
         module_redis_connection_context_t *connection_context,
         uint32_t count);
 
+bool module_redis_connection_send_array_null(
+        module_redis_connection_context_t *connection_context);
+
 bool module_redis_connection_flush_and_close(
         module_redis_connection_context_t *connection_context);
 
 bool module_redis_connection_command_too_long(
         module_redis_connection_context_t *connection_context);
 
+bool module_redis_connection_can_receive_direct(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_connection_receive_direct(
+        module_redis_connection_context_t *connection_context);
+
 bool module_redis_connection_authenticate(
         module_redis_connection_context_t *connection_context,
         char *client_username,
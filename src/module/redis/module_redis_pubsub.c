@@ -0,0 +1,1277 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "memory_fences.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "utils_string.h"
+#include "hash/hash_fnv1.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "network/network.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_mailbox.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_pubsub.h"
+
+#define TAG "module_redis_pubsub"
+
+static module_redis_pubsub_registry_bucket_t module_redis_pubsub_registry_channels[MODULE_REDIS_PUBSUB_REGISTRY_BUCKETS_COUNT] = { 0 };
+static module_redis_pubsub_registry_bucket_t module_redis_pubsub_registry_patterns = { 0 };
+static uint32_volatile_t module_redis_pubsub_registry_patterns_count = 0;
+
+static thread_local module_redis_pubsub_local_t *module_redis_pubsub_local = NULL;
+
+static inline uint32_t module_redis_pubsub_hash(
+        char *name,
+        size_t name_length) {
+    return fnv_32_hash(name, (uint16_t)MIN(name_length, UINT16_MAX));
+}
+
+static module_redis_pubsub_registry_entry_t *module_redis_pubsub_registry_entry_find(
+        module_redis_pubsub_registry_bucket_t *bucket,
+        char *name,
+        size_t name_length) {
+    for(
+            double_linked_list_item_t *item = bucket->entries.head;
+            item != NULL;
+            item = item->next) {
+        module_redis_pubsub_registry_entry_t *entry = item->data;
+
+        if (entry->name_length == name_length && memcmp(entry->name, name, name_length) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void module_redis_pubsub_registry_add(
+        module_redis_pubsub_registry_bucket_t *bucket,
+        char *name,
+        size_t name_length) {
+    worker_context_t *worker_context = worker_context_get();
+
+    spinlock_lock(&bucket->lock);
+
+    module_redis_pubsub_registry_entry_t *entry = module_redis_pubsub_registry_entry_find(bucket, name, name_length);
+    if (entry == NULL) {
+        entry = xalloc_alloc_zero(sizeof(module_redis_pubsub_registry_entry_t));
+        entry->item.data = entry;
+        entry->name = xalloc_alloc(name_length);
+        entry->name_length = name_length;
+        entry->workers_count = worker_context->workers_count;
+        entry->workers_subscribers_count = xalloc_alloc_zero(sizeof(uint32_t) * entry->workers_count);
+        memcpy(entry->name, name, name_length);
+
+        double_linked_list_push_item(&bucket->entries, &entry->item);
+
+        if (bucket == &module_redis_pubsub_registry_patterns) {
+            __sync_fetch_and_add(&module_redis_pubsub_registry_patterns_count, 1);
+        }
+    }
+
+    entry->subscribers_count++;
+    entry->workers_subscribers_count[worker_context->worker_index]++;
+
+    spinlock_unlock(&bucket->lock);
+}
+
+static void module_redis_pubsub_registry_remove(
+        module_redis_pubsub_registry_bucket_t *bucket,
+        char *name,
+        size_t name_length) {
+    worker_context_t *worker_context = worker_context_get();
+
+    spinlock_lock(&bucket->lock);
+
+    module_redis_pubsub_registry_entry_t *entry = module_redis_pubsub_registry_entry_find(bucket, name, name_length);
+    assert(entry != NULL);
+
+    entry->subscribers_count--;
+    entry->workers_subscribers_count[worker_context->worker_index]--;
+
+    if (entry->subscribers_count == 0) {
+        double_linked_list_remove_item(&bucket->entries, &entry->item);
+
+        if (bucket == &module_redis_pubsub_registry_patterns) {
+            __sync_fetch_and_sub(&module_redis_pubsub_registry_patterns_count, 1);
+        }
+    } else {
+        entry = NULL;
+    }
+
+    spinlock_unlock(&bucket->lock);
+
+    if (entry != NULL) {
+        xalloc_free(entry->workers_subscribers_count);
+        xalloc_free(entry->name);
+        xalloc_free(entry);
+    }
+}
+
+static uint32_t module_redis_pubsub_registry_collect_receivers(
+        uint32_t channel_hash,
+        char *channel,
+        size_t channel_length,
+        uint32_t *workers_receivers_count) {
+    uint32_t receivers_count = 0;
+    module_redis_pubsub_registry_bucket_t *bucket =
+            &module_redis_pubsub_registry_channels[channel_hash & (MODULE_REDIS_PUBSUB_REGISTRY_BUCKETS_COUNT - 1)];
+
+    // The lock is not needed to find out that nobody is subscribed to any channel of the bucket, a subscription racing
+    // with the publish would anyway be free to come after it
+    MEMORY_FENCE_LOAD();
+    if (bucket->entries.count > 0) {
+        spinlock_lock(&bucket->lock);
+
+        module_redis_pubsub_registry_entry_t *entry = module_redis_pubsub_registry_entry_find(
+                bucket,
+                channel,
+                channel_length);
+        if (entry != NULL) {
+            receivers_count += entry->subscribers_count;
+            for(uint32_t worker_index = 0; worker_index < entry->workers_count; worker_index++) {
+                workers_receivers_count[worker_index] += entry->workers_subscribers_count[worker_index];
+            }
+        }
+
+        spinlock_unlock(&bucket->lock);
+    }
+
+    if (likely(module_redis_pubsub_registry_patterns_count == 0)) {
+        return receivers_count;
+    }
+
+    spinlock_lock(&module_redis_pubsub_registry_patterns.lock);
+
+    for(
+            double_linked_list_item_t *item = module_redis_pubsub_registry_patterns.entries.head;
+            item != NULL;
+            item = item->next) {
+        module_redis_pubsub_registry_entry_t *entry = item->data;
+
+        if (!utils_string_glob_match(channel, channel_length, entry->name, entry->name_length)) {
+            continue;
+        }
+
+        receivers_count += entry->subscribers_count;
+        for(uint32_t worker_index = 0; worker_index < entry->workers_count; worker_index++) {
+            workers_receivers_count[worker_index] += entry->workers_subscribers_count[worker_index];
+        }
+    }
+
+    spinlock_unlock(&module_redis_pubsub_registry_patterns.lock);
+
+    return receivers_count;
+}
+
+uint32_t module_redis_pubsub_registry_get_channel_subscribers_count(
+        char *channel,
+        size_t channel_length) {
+    uint32_t subscribers_count = 0;
+    module_redis_pubsub_registry_bucket_t *bucket = &module_redis_pubsub_registry_channels[
+            module_redis_pubsub_hash(channel, channel_length) & (MODULE_REDIS_PUBSUB_REGISTRY_BUCKETS_COUNT - 1)];
+
+    spinlock_lock(&bucket->lock);
+
+    module_redis_pubsub_registry_entry_t *entry = module_redis_pubsub_registry_entry_find(
+            bucket,
+            channel,
+            channel_length);
+    if (entry != NULL) {
+        subscribers_count = entry->subscribers_count;
+    }
+
+    spinlock_unlock(&bucket->lock);
+
+    return subscribers_count;
+}
+
+uint32_t module_redis_pubsub_registry_get_patterns_count() {
+    MEMORY_FENCE_LOAD();
+    return module_redis_pubsub_registry_patterns_count;
+}
+
+module_redis_short_string_t *module_redis_pubsub_registry_get_channels(
+        char *pattern,
+        size_t pattern_length,
+        uint32_t *channels_count) {
+    uint32_t channels_size = 0;
+    module_redis_short_string_t *channels = NULL;
+
+    *channels_count = 0;
+
+    for(uint32_t bucket_index = 0; bucket_index < MODULE_REDIS_PUBSUB_REGISTRY_BUCKETS_COUNT; bucket_index++) {
+        module_redis_pubsub_registry_bucket_t *bucket = &module_redis_pubsub_registry_channels[bucket_index];
+
+        MEMORY_FENCE_LOAD();
+        if (bucket->entries.count == 0) {
+            continue;
+        }
+
+        spinlock_lock(&bucket->lock);
+
+        for(
+                double_linked_list_item_t *item = bucket->entries.head;
+                item != NULL;
+                item = item->next) {
+            module_redis_pubsub_registry_entry_t *entry = item->data;
+
+            if (pattern != NULL &&
+                !utils_string_glob_match(entry->name, entry->name_length, pattern, pattern_length)) {
+                continue;
+            }
+
+            if (*channels_count == channels_size) {
+                channels_size = channels_size == 0 ? MODULE_REDIS_PUBSUB_LIST_INITIAL_SIZE : channels_size * 2;
+                channels = xalloc_realloc(channels, sizeof(module_redis_short_string_t) * channels_size);
+            }
+
+            // The names are copied, the entries can go away as soon as the lock is released
+            module_redis_short_string_t *channel = &channels[(*channels_count)++];
+            channel->short_string = xalloc_alloc(entry->name_length);
+            channel->length = entry->name_length;
+            memcpy(channel->short_string, entry->name, entry->name_length);
+        }
+
+        spinlock_unlock(&bucket->lock);
+    }
+
+    return channels;
+}
+
+void module_redis_pubsub_registry_free_channels(
+        module_redis_short_string_t *channels,
+        uint32_t channels_count) {
+    for(uint32_t index = 0; index < channels_count; index++) {
+        xalloc_free(channels[index].short_string);
+    }
+
+    if (channels != NULL) {
+        xalloc_free(channels);
+    }
+}
+
+module_redis_pubsub_message_t *module_redis_pubsub_message_new(
+        char *channel,
+        size_t channel_length,
+        char *payload,
+        size_t payload_length,
+        uint32_t refcount) {
+    size_t channel_header_length = 1 + protocol_redis_writer_uint64_str_length(channel_length) + 2;
+    size_t payload_header_length = 1 + protocol_redis_writer_uint64_str_length(payload_length) + 2;
+    size_t frame_tail_length =
+            channel_header_length + channel_length + 2 +
+            payload_header_length + payload_length + 2;
+
+    // The message and the frame are allocated in one go, the frame is never changed after this point
+    module_redis_pubsub_message_t *message = xalloc_alloc(sizeof(module_redis_pubsub_message_t) + frame_tail_length);
+    char *frame_tail = (char*)(message + 1);
+    char *frame_tail_end;
+
+    frame_tail_end = protocol_redis_writer_write_blob_string(
+            frame_tail,
+            frame_tail_length,
+            channel,
+            (int)channel_length);
+    frame_tail_end = protocol_redis_writer_write_blob_string(
+            frame_tail_end,
+            frame_tail_length - (frame_tail_end - frame_tail),
+            payload,
+            (int)payload_length);
+    assert(frame_tail_end - frame_tail == frame_tail_length);
+
+    message->refcount = refcount;
+    message->kind = MODULE_REDIS_PUBSUB_MESSAGE_KIND_MESSAGE;
+    message->channel_hash = module_redis_pubsub_hash(channel, channel_length);
+    message->channel = frame_tail + channel_header_length;
+    message->channel_length = channel_length;
+    message->frame_tail = frame_tail;
+    message->frame_tail_length = frame_tail_length;
+    message->payload_frame = NULL;
+    message->payload_frame_length = 0;
+    MEMORY_FENCE_STORE();
+
+    return message;
+}
+
+module_redis_pubsub_message_t *module_redis_pubsub_message_new_invalidation(
+        char *key,
+        size_t key_length,
+        uint32_t refcount) {
+    char *channel = MODULE_REDIS_PUBSUB_INVALIDATION_CHANNEL;
+    size_t channel_length = strlen(MODULE_REDIS_PUBSUB_INVALIDATION_CHANNEL);
+    size_t channel_header_length = 1 + protocol_redis_writer_uint64_str_length(channel_length) + 2;
+    size_t channel_frame_length = channel_header_length + channel_length + 2;
+
+    // The payload is an array with the key or, when all the keys have to be invalidated, a null array, with RESP3 the
+    // null is written out as a proper null
+    size_t payload_frame_length = key != NULL
+            ? 4 + 1 + protocol_redis_writer_uint64_str_length(key_length) + 2 + key_length + 2
+            : 5;
+    size_t frame_tail_length = channel_frame_length + payload_frame_length;
+
+    module_redis_pubsub_message_t *message = xalloc_alloc(sizeof(module_redis_pubsub_message_t) + frame_tail_length);
+    char *frame_tail = (char*)(message + 1);
+    char *frame_tail_end;
+
+    frame_tail_end = protocol_redis_writer_write_blob_string(
+            frame_tail,
+            frame_tail_length,
+            channel,
+            (int)channel_length);
+
+    if (key != NULL) {
+        frame_tail_end = protocol_redis_writer_write_array(
+                frame_tail_end,
+                frame_tail_length - (frame_tail_end - frame_tail),
+                1);
+        frame_tail_end = protocol_redis_writer_write_blob_string(
+                frame_tail_end,
+                frame_tail_length - (frame_tail_end - frame_tail),
+                key,
+                (int)key_length);
+    } else {
+        frame_tail_end = protocol_redis_writer_write_array_null(
+                frame_tail_end,
+                frame_tail_length - (frame_tail_end - frame_tail));
+    }
+    assert(frame_tail_end - frame_tail == frame_tail_length);
+
+    message->refcount = refcount;
+    message->kind = MODULE_REDIS_PUBSUB_MESSAGE_KIND_INVALIDATION;
+    message->channel_hash = module_redis_pubsub_hash(channel, channel_length);
+    message->channel = frame_tail + channel_header_length;
+    message->channel_length = channel_length;
+    message->frame_tail = frame_tail;
+    message->frame_tail_length = frame_tail_length;
+    message->payload_frame = key != NULL ? frame_tail + channel_frame_length : NULL;
+    message->payload_frame_length = key != NULL ? payload_frame_length : 0;
+    MEMORY_FENCE_STORE();
+
+    return message;
+}
+
+void module_redis_pubsub_message_release(
+        module_redis_pubsub_message_t *message) {
+    if (__sync_sub_and_fetch(&message->refcount, 1) == 0) {
+        xalloc_free(message);
+    }
+}
+
+static void module_redis_pubsub_message_local_ref_release(
+        module_redis_pubsub_message_local_ref_t *local_ref) {
+    if (--local_ref->refcount > 0) {
+        return;
+    }
+
+    module_redis_pubsub_message_release(local_ref->message);
+    xalloc_free(local_ref);
+}
+
+static void module_redis_pubsub_pending_message_release(
+        module_redis_connection_pubsub_pending_message_t *pending_message) {
+    if (pending_message->pattern != NULL) {
+        xalloc_free(pending_message->pattern);
+    }
+
+    module_redis_pubsub_message_local_ref_release(pending_message->local_ref);
+}
+
+static void module_redis_pubsub_writer_fiber_entrypoint(
+        void *user_data) {
+    module_redis_connection_context_t *connection_context = user_data;
+
+    module_redis_pubsub_connection_write_pending(connection_context);
+    connection_context->pubsub.writing = false;
+
+    fiber_scheduler_terminate_current_fiber();
+}
+
+static void module_redis_pubsub_connection_enqueue(
+        module_redis_connection_context_t *connection_context,
+        module_redis_pubsub_message_local_ref_t *local_ref,
+        char *pattern,
+        size_t pattern_length) {
+    if (connection_context->pubsub.pending_messages.count == connection_context->pubsub.pending_messages.size) {
+        connection_context->pubsub.pending_messages.size = connection_context->pubsub.pending_messages.size == 0
+                ? MODULE_REDIS_PUBSUB_LIST_INITIAL_SIZE
+                : connection_context->pubsub.pending_messages.size * 2;
+        connection_context->pubsub.pending_messages.list = xalloc_realloc(
+                connection_context->pubsub.pending_messages.list,
+                sizeof(module_redis_connection_pubsub_pending_message_t) *
+                connection_context->pubsub.pending_messages.size);
+    }
+
+    module_redis_connection_pubsub_pending_message_t *pending_message =
+            &connection_context->pubsub.pending_messages.list[connection_context->pubsub.pending_messages.count++];
+
+    pending_message->local_ref = local_ref;
+    pending_message->pattern = NULL;
+    pending_message->pattern_length = 0;
+    local_ref->refcount++;
+
+    if (pattern != NULL) {
+        pending_message->pattern = xalloc_alloc(pattern_length);
+        pending_message->pattern_length = pattern_length;
+        memcpy(pending_message->pattern, pattern, pattern_length);
+    }
+
+    // If the connection is waiting for new data nobody would write the message out, a writer fiber takes care of it.
+    // The fiber runs till the first network operation and then switches back here, all the writers of the subscribers
+    // of the channel are therefore sending their data at the same time.
+    if (connection_context->pubsub.idle && !connection_context->pubsub.writing) {
+        connection_context->pubsub.writing = true;
+        fiber_scheduler_new_fiber(
+                MODULE_REDIS_PUBSUB_WRITER_FIBER_NAME,
+                strlen(MODULE_REDIS_PUBSUB_WRITER_FIBER_NAME),
+                module_redis_pubsub_writer_fiber_entrypoint,
+                connection_context);
+    }
+}
+
+static module_redis_pubsub_local_channel_t *module_redis_pubsub_local_channel_find(
+        module_redis_pubsub_local_t *local,
+        uint32_t channel_hash,
+        char *channel,
+        size_t channel_length) {
+    double_linked_list_t *bucket = &local->channels_buckets[channel_hash & (MODULE_REDIS_PUBSUB_LOCAL_BUCKETS_COUNT - 1)];
+
+    for(
+            double_linked_list_item_t *item = bucket->head;
+            item != NULL;
+            item = item->next) {
+        module_redis_pubsub_local_channel_t *local_channel = item->data;
+
+        if (local_channel->channel_length == channel_length &&
+            memcmp(local_channel->channel, channel, channel_length) == 0) {
+            return local_channel;
+        }
+    }
+
+    return NULL;
+}
+
+void module_redis_pubsub_deliver(
+        void *user_data) {
+    uint64_t delivered_count = 0;
+    module_redis_pubsub_message_t *message = user_data;
+    module_redis_pubsub_local_t *local = module_redis_pubsub_local;
+
+    // All the subscribers might have gone away in the meantime
+    if (unlikely(local == NULL)) {
+        module_redis_pubsub_message_release(message);
+        return;
+    }
+
+    // The reference held by the worker is released once all the subscribers have written the message out
+    module_redis_pubsub_message_local_ref_t *local_ref = xalloc_alloc(sizeof(module_redis_pubsub_message_local_ref_t));
+    local_ref->message = message;
+    local_ref->refcount = 1;
+
+    module_redis_pubsub_local_channel_t *local_channel = module_redis_pubsub_local_channel_find(
+            local,
+            message->channel_hash,
+            message->channel,
+            message->channel_length);
+
+    if (local_channel != NULL) {
+        for(
+                double_linked_list_item_t *item = local_channel->subscriptions.head;
+                item != NULL;
+                item = item->next) {
+            module_redis_pubsub_subscription_t *subscription = item->data;
+
+            module_redis_pubsub_connection_enqueue(subscription->connection_context, local_ref, NULL, 0);
+            delivered_count++;
+        }
+    }
+
+    for(
+            double_linked_list_item_t *item = local->patterns_subscriptions.head;
+            item != NULL;
+            item = item->next) {
+        module_redis_pubsub_subscription_t *subscription = item->data;
+
+        if (!utils_string_glob_match(
+                message->channel,
+                message->channel_length,
+                subscription->pattern,
+                subscription->pattern_length)) {
+            continue;
+        }
+
+        module_redis_pubsub_connection_enqueue(
+                subscription->connection_context,
+                local_ref,
+                subscription->pattern,
+                subscription->pattern_length);
+        delivered_count++;
+    }
+
+    worker_stats_get_internal_current()->pubsub.messages_delivered += delivered_count;
+
+    module_redis_pubsub_message_local_ref_release(local_ref);
+}
+
+void module_redis_pubsub_deliver_to_connections(
+        module_redis_pubsub_message_t *message,
+        module_redis_connection_context_t **connection_contexts,
+        uint32_t connection_contexts_count) {
+    // As for the published messages the worker holds a single reference to the message
+    module_redis_pubsub_message_local_ref_t *local_ref = xalloc_alloc(sizeof(module_redis_pubsub_message_local_ref_t));
+    local_ref->message = message;
+    local_ref->refcount = 1;
+
+    for(uint32_t index = 0; index < connection_contexts_count; index++) {
+        module_redis_pubsub_connection_enqueue(connection_contexts[index], local_ref, NULL, 0);
+    }
+
+    worker_stats_get_internal_current()->pubsub.messages_delivered += connection_contexts_count;
+
+    module_redis_pubsub_message_local_ref_release(local_ref);
+}
+
+uint32_t module_redis_pubsub_publish(
+        char *channel,
+        size_t channel_length,
+        char *payload,
+        size_t payload_length) {
+    uint32_t target_workers_count = 0;
+    worker_context_t *worker_context = worker_context_get();
+    worker_stats_t *stats = worker_stats_get_internal_current();
+    uint32_t channel_hash = module_redis_pubsub_hash(channel, channel_length);
+    uint32_t *workers_receivers_count = xalloc_alloc_zero(sizeof(uint32_t) * worker_context->workers_count);
+
+    stats->pubsub.messages_published++;
+
+    uint32_t receivers_count = module_redis_pubsub_registry_collect_receivers(
+            channel_hash,
+            channel,
+            channel_length,
+            workers_receivers_count);
+
+    if (likely(receivers_count == 0)) {
+        xalloc_free(workers_receivers_count);
+        return 0;
+    }
+
+    for(uint32_t worker_index = 0; worker_index < worker_context->workers_count; worker_index++) {
+        if (workers_receivers_count[worker_index] > 0) {
+            target_workers_count++;
+        }
+    }
+
+    // Each worker reached holds one reference
+    module_redis_pubsub_message_t *message = module_redis_pubsub_message_new(
+            channel,
+            channel_length,
+            payload,
+            payload_length,
+            target_workers_count);
+
+    // The message is posted to the other workers first, then it's delivered to the subscribers of this worker
+    for(uint32_t worker_index = 0; worker_index < worker_context->workers_count; worker_index++) {
+        if (workers_receivers_count[worker_index] == 0 || worker_index == worker_context->worker_index) {
+            continue;
+        }
+
+        // When the queue towards the worker is full the mailbox keeps the message in its overflow list, the post
+        // fails only if the mailbox is not available
+        if (unlikely(!worker_mailbox_post(worker_index, module_redis_pubsub_deliver, message))) {
+            LOG_W(TAG, "Unable to post the message to the worker <%u>, dropping it", worker_index);
+
+            stats->pubsub.messages_dropped += workers_receivers_count[worker_index];
+            receivers_count -= workers_receivers_count[worker_index];
+            module_redis_pubsub_message_release(message);
+        }
+    }
+
+    if (workers_receivers_count[worker_context->worker_index] > 0) {
+        module_redis_pubsub_deliver(message);
+    }
+
+    xalloc_free(workers_receivers_count);
+
+    return receivers_count;
+}
+
+static module_redis_pubsub_local_t *module_redis_pubsub_local_get_or_create() {
+    if (unlikely(module_redis_pubsub_local == NULL)) {
+        module_redis_pubsub_local = xalloc_alloc_zero(sizeof(module_redis_pubsub_local_t));
+    }
+
+    return module_redis_pubsub_local;
+}
+
+static void module_redis_pubsub_connection_list_append(
+        module_redis_pubsub_subscription_t ***list,
+        uint32_t *count,
+        uint32_t *size,
+        module_redis_pubsub_subscription_t *subscription) {
+    if (*count == *size) {
+        *size = *size == 0 ? MODULE_REDIS_PUBSUB_LIST_INITIAL_SIZE : *size * 2;
+        *list = xalloc_realloc(*list, sizeof(module_redis_pubsub_subscription_t*) * *size);
+    }
+
+    (*list)[(*count)++] = subscription;
+}
+
+static int64_t module_redis_pubsub_connection_channels_find(
+        module_redis_connection_context_t *connection_context,
+        char *channel,
+        size_t channel_length) {
+    for(uint32_t index = 0; index < connection_context->pubsub.channels.count; index++) {
+        module_redis_pubsub_local_channel_t *local_channel =
+                connection_context->pubsub.channels.list[index]->local_channel;
+
+        if (local_channel->channel_length == channel_length &&
+            memcmp(local_channel->channel, channel, channel_length) == 0) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+static int64_t module_redis_pubsub_connection_patterns_find(
+        module_redis_connection_context_t *connection_context,
+        char *pattern,
+        size_t pattern_length) {
+    for(uint32_t index = 0; index < connection_context->pubsub.patterns.count; index++) {
+        module_redis_pubsub_subscription_t *subscription = connection_context->pubsub.patterns.list[index];
+
+        if (subscription->pattern_length == pattern_length &&
+            memcmp(subscription->pattern, pattern, pattern_length) == 0) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+static void module_redis_pubsub_connection_subscriptions_changed(
+        module_redis_connection_context_t *connection_context,
+        uint32_t previous_subscriptions_count) {
+    network_channel_t *network_channel = connection_context->network_channel;
+    uint32_t subscriptions_count = module_redis_pubsub_connection_subscriptions_count(connection_context);
+
+    // The subscribers can stay idle for an indefinite amount of time, the read timeout is suspended while the
+    // connection is subscribed to something
+    if (previous_subscriptions_count == 0 && subscriptions_count > 0) {
+        connection_context->pubsub.timeout_read.sec = network_channel->timeout.read.sec;
+        connection_context->pubsub.timeout_read.nsec = network_channel->timeout.read.nsec;
+        network_channel->timeout.read.sec = -1;
+        network_channel->timeout.read.nsec = -1;
+    } else if (previous_subscriptions_count > 0 && subscriptions_count == 0) {
+        network_channel->timeout.read.sec = connection_context->pubsub.timeout_read.sec;
+        network_channel->timeout.read.nsec = connection_context->pubsub.timeout_read.nsec;
+    }
+}
+
+static void module_redis_pubsub_subscription_free(
+        module_redis_pubsub_subscription_t *subscription) {
+    module_redis_pubsub_local_t *local = module_redis_pubsub_local;
+    module_redis_pubsub_local_channel_t *local_channel = subscription->local_channel;
+
+    assert(local != NULL);
+
+    if (local_channel != NULL) {
+        uint32_t channel_hash = module_redis_pubsub_hash(local_channel->channel, local_channel->channel_length);
+
+        double_linked_list_remove_item(&local_channel->subscriptions, &subscription->item);
+        module_redis_pubsub_registry_remove(
+                &module_redis_pubsub_registry_channels[channel_hash & (MODULE_REDIS_PUBSUB_REGISTRY_BUCKETS_COUNT - 1)],
+                local_channel->channel,
+                local_channel->channel_length);
+
+        if (local_channel->subscriptions.count == 0) {
+            double_linked_list_remove_item(
+                    &local->channels_buckets[channel_hash & (MODULE_REDIS_PUBSUB_LOCAL_BUCKETS_COUNT - 1)],
+                    &local_channel->item);
+            xalloc_free(local_channel->channel);
+            xalloc_free(local_channel);
+        }
+    } else {
+        double_linked_list_remove_item(&local->patterns_subscriptions, &subscription->item);
+        module_redis_pubsub_registry_remove(
+                &module_redis_pubsub_registry_patterns,
+                subscription->pattern,
+                subscription->pattern_length);
+        xalloc_free(subscription->pattern);
+    }
+
+    xalloc_free(subscription);
+
+    worker_stats_get_internal_current()->pubsub.subscriptions--;
+
+    local->subscriptions_count--;
+    if (local->subscriptions_count == 0) {
+        xalloc_free(local);
+        module_redis_pubsub_local = NULL;
+    }
+}
+
+bool module_redis_pubsub_channel_subscribe(
+        module_redis_connection_context_t *connection_context,
+        char *channel,
+        size_t channel_length) {
+    uint32_t previous_subscriptions_count = module_redis_pubsub_connection_subscriptions_count(connection_context);
+
+    if (module_redis_pubsub_connection_channels_find(connection_context, channel, channel_length) >= 0) {
+        return false;
+    }
+
+    module_redis_pubsub_local_t *local = module_redis_pubsub_local_get_or_create();
+    uint32_t channel_hash = module_redis_pubsub_hash(channel, channel_length);
+
+    module_redis_pubsub_local_channel_t *local_channel = module_redis_pubsub_local_channel_find(
+            local,
+            channel_hash,
+            channel,
+            channel_length);
+    if (local_channel == NULL) {
+        local_channel = xalloc_alloc_zero(sizeof(module_redis_pubsub_local_channel_t));
+        local_channel->item.data = local_channel;
+        local_channel->channel = xalloc_alloc(channel_length);
+        local_channel->channel_length = channel_length;
+        memcpy(local_channel->channel, channel, channel_length);
+
+        double_linked_list_push_item(
+                &local->channels_buckets[channel_hash & (MODULE_REDIS_PUBSUB_LOCAL_BUCKETS_COUNT - 1)],
+                &local_channel->item);
+    }
+
+    module_redis_pubsub_subscription_t *subscription = xalloc_alloc_zero(sizeof(module_redis_pubsub_subscription_t));
+    subscription->item.data = subscription;
+    subscription->connection_context = connection_context;
+    subscription->local_channel = local_channel;
+
+    double_linked_list_push_item(&local_channel->subscriptions, &subscription->item);
+    local->subscriptions_count++;
+
+    module_redis_pubsub_connection_list_append(
+            &connection_context->pubsub.channels.list,
+            &connection_context->pubsub.channels.count,
+            &connection_context->pubsub.channels.size,
+            subscription);
+
+    module_redis_pubsub_registry_add(
+            &module_redis_pubsub_registry_channels[channel_hash & (MODULE_REDIS_PUBSUB_REGISTRY_BUCKETS_COUNT - 1)],
+            channel,
+            channel_length);
+
+    worker_stats_get_internal_current()->pubsub.subscriptions++;
+    module_redis_pubsub_connection_subscriptions_changed(connection_context, previous_subscriptions_count);
+
+    return true;
+}
+
+static void module_redis_pubsub_connection_list_remove(
+        module_redis_pubsub_subscription_t **list,
+        uint32_t *count,
+        uint32_t index) {
+    // The order is preserved, UNSUBSCRIBE without arguments replies following the order of the subscriptions
+    memmove(
+            &list[index],
+            &list[index + 1],
+            sizeof(module_redis_pubsub_subscription_t*) * (*count - index - 1));
+    (*count)--;
+}
+
+bool module_redis_pubsub_channel_unsubscribe(
+        module_redis_connection_context_t *connection_context,
+        char *channel,
+        size_t channel_length) {
+    uint32_t previous_subscriptions_count = module_redis_pubsub_connection_subscriptions_count(connection_context);
+    int64_t index = module_redis_pubsub_connection_channels_find(connection_context, channel, channel_length);
+
+    if (index < 0) {
+        return false;
+    }
+
+    module_redis_pubsub_subscription_t *subscription = connection_context->pubsub.channels.list[index];
+    module_redis_pubsub_connection_list_remove(
+            connection_context->pubsub.channels.list,
+            &connection_context->pubsub.channels.count,
+            index);
+    module_redis_pubsub_subscription_free(subscription);
+
+    module_redis_pubsub_connection_subscriptions_changed(connection_context, previous_subscriptions_count);
+
+    return true;
+}
+
+bool module_redis_pubsub_pattern_subscribe(
+        module_redis_connection_context_t *connection_context,
+        char *pattern,
+        size_t pattern_length) {
+    uint32_t previous_subscriptions_count = module_redis_pubsub_connection_subscriptions_count(connection_context);
+
+    if (module_redis_pubsub_connection_patterns_find(connection_context, pattern, pattern_length) >= 0) {
+        return false;
+    }
+
+    module_redis_pubsub_local_t *local = module_redis_pubsub_local_get_or_create();
+
+    module_redis_pubsub_subscription_t *subscription = xalloc_alloc_zero(sizeof(module_redis_pubsub_subscription_t));
+    subscription->item.data = subscription;
+    subscription->connection_context = connection_context;
+    subscription->pattern = xalloc_alloc(pattern_length);
+    subscription->pattern_length = pattern_length;
+    memcpy(subscription->pattern, pattern, pattern_length);
+
+    double_linked_list_push_item(&local->patterns_subscriptions, &subscription->item);
+    local->subscriptions_count++;
+
+    module_redis_pubsub_connection_list_append(
+            &connection_context->pubsub.patterns.list,
+            &connection_context->pubsub.patterns.count,
+            &connection_context->pubsub.patterns.size,
+            subscription);
+
+    module_redis_pubsub_registry_add(
+            &module_redis_pubsub_registry_patterns,
+            pattern,
+            pattern_length);
+
+    worker_stats_get_internal_current()->pubsub.subscriptions++;
+    module_redis_pubsub_connection_subscriptions_changed(connection_context, previous_subscriptions_count);
+
+    return true;
+}
+
+bool module_redis_pubsub_pattern_unsubscribe(
+        module_redis_connection_context_t *connection_context,
+        char *pattern,
+        size_t pattern_length) {
+    uint32_t previous_subscriptions_count = module_redis_pubsub_connection_subscriptions_count(connection_context);
+    int64_t index = module_redis_pubsub_connection_patterns_find(connection_context, pattern, pattern_length);
+
+    if (index < 0) {
+        return false;
+    }
+
+    module_redis_pubsub_subscription_t *subscription = connection_context->pubsub.patterns.list[index];
+    module_redis_pubsub_connection_list_remove(
+            connection_context->pubsub.patterns.list,
+            &connection_context->pubsub.patterns.count,
+            index);
+    module_redis_pubsub_subscription_free(subscription);
+
+    module_redis_pubsub_connection_subscriptions_changed(connection_context, previous_subscriptions_count);
+
+    return true;
+}
+
+bool module_redis_pubsub_unsubscribe_all(
+        module_redis_connection_context_t *connection_context,
+        bool patterns,
+        bool send_replies) {
+    char *kind = patterns ? "punsubscribe" : "unsubscribe";
+    size_t kind_length = strlen(kind);
+    uint32_t *count = patterns
+            ? &connection_context->pubsub.patterns.count
+            : &connection_context->pubsub.channels.count;
+
+    if (*count == 0) {
+        return send_replies
+            ? module_redis_pubsub_send_subscription_reply(
+                    connection_context,
+                    kind,
+                    kind_length,
+                    NULL,
+                    0,
+                    module_redis_pubsub_connection_subscriptions_count(connection_context))
+            : true;
+    }
+
+    while(*count > 0) {
+        module_redis_pubsub_subscription_t *subscription = patterns
+                ? connection_context->pubsub.patterns.list[0]
+                : connection_context->pubsub.channels.list[0];
+        char *name = patterns ? subscription->pattern : subscription->local_channel->channel;
+        size_t name_length = patterns ? subscription->pattern_length : subscription->local_channel->channel_length;
+
+        // The reply is sent before unsubscribing as the name is owned by the subscription
+        if (send_replies && !module_redis_pubsub_send_subscription_reply(
+                connection_context,
+                kind,
+                kind_length,
+                name,
+                name_length,
+                module_redis_pubsub_connection_subscriptions_count(connection_context) - 1)) {
+            return false;
+        }
+
+        if (patterns) {
+            module_redis_pubsub_pattern_unsubscribe(connection_context, name, name_length);
+        } else {
+            module_redis_pubsub_channel_unsubscribe(connection_context, name, name_length);
+        }
+    }
+
+    return true;
+}
+
+uint32_t module_redis_pubsub_connection_subscriptions_count(
+        module_redis_connection_context_t *connection_context) {
+    return connection_context->pubsub.channels.count + connection_context->pubsub.patterns.count;
+}
+
+bool module_redis_pubsub_connection_is_subscribed(
+        module_redis_connection_context_t *connection_context) {
+    return module_redis_pubsub_connection_subscriptions_count(connection_context) > 0;
+}
+
+bool module_redis_pubsub_connection_is_subscribed_to_channel(
+        module_redis_connection_context_t *connection_context,
+        char *channel,
+        size_t channel_length) {
+    return module_redis_pubsub_connection_channels_find(connection_context, channel, channel_length) >= 0;
+}
+
+bool module_redis_pubsub_connection_can_migrate(
+        module_redis_connection_context_t *connection_context) {
+    // The subscriptions and the pending messages belong to the worker
+    return
+            !module_redis_pubsub_connection_is_subscribed(connection_context) &&
+            connection_context->pubsub.pending_messages.count == 0 &&
+            !connection_context->pubsub.writing;
+}
+
+bool module_redis_pubsub_is_command_allowed_when_subscribed(
+        module_redis_command_info_t *command_info) {
+    switch(command_info->command) {
+        case MODULE_REDIS_COMMAND_SUBSCRIBE:
+        case MODULE_REDIS_COMMAND_UNSUBSCRIBE:
+        case MODULE_REDIS_COMMAND_PSUBSCRIBE:
+        case MODULE_REDIS_COMMAND_PUNSUBSCRIBE:
+        case MODULE_REDIS_COMMAND_PING:
+        case MODULE_REDIS_COMMAND_QUIT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool module_redis_pubsub_send_subscription_reply(
+        module_redis_connection_context_t *connection_context,
+        char *kind,
+        size_t kind_length,
+        char *name,
+        size_t name_length,
+        uint32_t subscriptions_count) {
+    network_channel_buffer_data_t *send_buffer, *send_buffer_start;
+    size_t slice_length = 96 + kind_length + name_length;
+
+    send_buffer = send_buffer_start = network_send_buffer_acquire_slice(
+            connection_context->network_channel,
+            slice_length);
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "Unable to acquire send buffer slice!");
+        return false;
+    }
+
+    // With RESP3 the replies are pushes, as the messages, so the clients can tell them apart from the replies of the
+    // other commands
+    if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        send_buffer_start = protocol_redis_writer_write_array(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer),
+                3);
+    } else {
+        send_buffer_start = protocol_redis_writer_write_push(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer),
+                3);
+    }
+
+    send_buffer_start = protocol_redis_writer_write_blob_string(
+            send_buffer_start,
+            slice_length - (send_buffer_start - send_buffer),
+            kind,
+            (int)kind_length);
+
+    if (name != NULL) {
+        send_buffer_start = protocol_redis_writer_write_blob_string(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer),
+                name,
+                (int)name_length);
+    } else if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        send_buffer_start = protocol_redis_writer_write_blob_string_null(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer));
+    } else {
+        send_buffer_start = protocol_redis_writer_write_null(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer));
+    }
+
+    send_buffer_start = protocol_redis_writer_write_number(
+            send_buffer_start,
+            slice_length - (send_buffer_start - send_buffer),
+            subscriptions_count);
+
+    network_send_buffer_release_slice(
+            connection_context->network_channel,
+            send_buffer_start ? send_buffer_start - send_buffer : 0);
+
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "buffer length incorrectly calculated, not enough space!");
+        return false;
+    }
+
+    return true;
+}
+
+static bool module_redis_pubsub_connection_write_invalidation_push(
+        module_redis_connection_context_t *connection_context,
+        module_redis_pubsub_message_t *message) {
+    network_channel_buffer_data_t *send_buffer, *send_buffer_start;
+    size_t slice_length = 64;
+
+    send_buffer = send_buffer_start = network_send_buffer_acquire_slice(
+            connection_context->network_channel,
+            slice_length);
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "Unable to acquire send buffer slice!");
+        return false;
+    }
+
+    send_buffer_start = protocol_redis_writer_write_push(
+            send_buffer_start,
+            slice_length - (send_buffer_start - send_buffer),
+            2);
+    send_buffer_start = protocol_redis_writer_write_blob_string(
+            send_buffer_start,
+            slice_length - (send_buffer_start - send_buffer),
+            "invalidate",
+            10);
+
+    if (message->payload_frame == NULL) {
+        send_buffer_start = protocol_redis_writer_write_null(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer));
+    }
+
+    network_send_buffer_release_slice(
+            connection_context->network_channel,
+            send_buffer_start ? send_buffer_start - send_buffer : 0);
+
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "buffer length incorrectly calculated, not enough space!");
+        return false;
+    }
+
+    if (message->payload_frame == NULL) {
+        return true;
+    }
+
+    return network_send_buffered(
+            connection_context->network_channel,
+            message->payload_frame,
+            message->payload_frame_length) == NETWORK_OP_RESULT_OK;
+}
+
+static bool module_redis_pubsub_connection_write_message(
+        module_redis_connection_context_t *connection_context,
+        module_redis_connection_pubsub_pending_message_t *pending_message) {
+    network_channel_buffer_data_t *send_buffer, *send_buffer_start;
+    module_redis_pubsub_message_t *message = pending_message->local_ref->message;
+    bool is_pattern = pending_message->pattern != NULL;
+    size_t slice_length = 64 + pending_message->pattern_length;
+
+    // With RESP2 the invalidations are plain messages of the __redis__:invalidate channel
+    if (message->kind == MODULE_REDIS_PUBSUB_MESSAGE_KIND_INVALIDATION &&
+        connection_context->resp_version != PROTOCOL_REDIS_RESP_VERSION_2) {
+        return module_redis_pubsub_connection_write_invalidation_push(connection_context, message);
+    }
+
+    send_buffer = send_buffer_start = network_send_buffer_acquire_slice(
+            connection_context->network_channel,
+            slice_length);
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "Unable to acquire send buffer slice!");
+        return false;
+    }
+
+    if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        send_buffer_start = protocol_redis_writer_write_array(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer),
+                is_pattern ? 4 : 3);
+    } else {
+        send_buffer_start = protocol_redis_writer_write_push(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer),
+                is_pattern ? 4 : 3);
+    }
+
+    if (is_pattern) {
+        send_buffer_start = protocol_redis_writer_write_blob_string(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer),
+                "pmessage",
+                8);
+        send_buffer_start = protocol_redis_writer_write_blob_string(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer),
+                pending_message->pattern,
+                (int)pending_message->pattern_length);
+    } else {
+        send_buffer_start = protocol_redis_writer_write_blob_string(
+                send_buffer_start,
+                slice_length - (send_buffer_start - send_buffer),
+                "message",
+                7);
+    }
+
+    network_send_buffer_release_slice(
+            connection_context->network_channel,
+            send_buffer_start ? send_buffer_start - send_buffer : 0);
+
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "buffer length incorrectly calculated, not enough space!");
+        return false;
+    }
+
+    // The channel and the payload are copied straight from the frame shared by all the subscribers
+    return network_send_buffered(
+            connection_context->network_channel,
+            message->frame_tail,
+            message->frame_tail_length) == NETWORK_OP_RESULT_OK;
+}
+
+bool module_redis_pubsub_connection_write_pending(
+        module_redis_connection_context_t *connection_context) {
+    bool result = true;
+    network_channel_t *network_channel = connection_context->network_channel;
+
+    while(connection_context->pubsub.pending_messages.count > 0) {
+        // New messages can be appended, and the list reallocated, every time the fiber waits for the network
+        for(uint32_t index = 0; index < connection_context->pubsub.pending_messages.count; index++) {
+            module_redis_connection_pubsub_pending_message_t pending_message =
+                    connection_context->pubsub.pending_messages.list[index];
+
+            if (likely(result)) {
+                result = module_redis_pubsub_connection_write_message(connection_context, &pending_message);
+            }
+
+            module_redis_pubsub_pending_message_release(&pending_message);
+        }
+
+        connection_context->pubsub.pending_messages.count = 0;
+
+        if (likely(result) && network_should_flush_send_buffer(network_channel)) {
+            result = network_flush_send_buffer(network_channel) == NETWORK_OP_RESULT_OK;
+        }
+    }
+
+    return result;
+}
+
+void module_redis_pubsub_connection_drop_pending(
+        module_redis_connection_context_t *connection_context) {
+    for(uint32_t index = 0; index < connection_context->pubsub.pending_messages.count; index++) {
+        module_redis_pubsub_pending_message_release(&connection_context->pubsub.pending_messages.list[index]);
+    }
+
+    connection_context->pubsub.pending_messages.count = 0;
+}
+
+bool module_redis_pubsub_connection_before_receive(
+        module_redis_connection_context_t *connection_context) {
+    bool result = true;
+
+    // The messages delivered while processing the commands are written out between two commands
+    if (unlikely(connection_context->pubsub.pending_messages.count > 0)) {
+        connection_context->pubsub.writing = true;
+        result = module_redis_pubsub_connection_write_pending(connection_context);
+        connection_context->pubsub.writing = false;
+    }
+
+    connection_context->pubsub.idle = true;
+
+    return result;
+}
+
+void module_redis_pubsub_connection_after_receive(
+        module_redis_connection_context_t *connection_context) {
+    connection_context->pubsub.idle = false;
+
+    // A writer fiber might still be sending the messages delivered while the connection was idle, the send buffer
+    // can't be shared with it
+    while(unlikely(connection_context->pubsub.writing)) {
+        fiber_scheduler_yield();
+    }
+}
+
+void module_redis_pubsub_connection_cleanup(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_pubsub_unsubscribe_all(connection_context, false, false);
+    module_redis_pubsub_unsubscribe_all(connection_context, true, false);
+
+    connection_context->pubsub.idle = false;
+    while(unlikely(connection_context->pubsub.writing)) {
+        fiber_scheduler_yield();
+    }
+
+    module_redis_pubsub_connection_drop_pending(connection_context);
+
+    if (connection_context->pubsub.channels.list) {
+        xalloc_free(connection_context->pubsub.channels.list);
+        connection_context->pubsub.channels.list = NULL;
+        connection_context->pubsub.channels.size = 0;
+    }
+
+    if (connection_context->pubsub.patterns.list) {
+        xalloc_free(connection_context->pubsub.patterns.list);
+        connection_context->pubsub.patterns.list = NULL;
+        connection_context->pubsub.patterns.size = 0;
+    }
+
+    if (connection_context->pubsub.pending_messages.list) {
+        xalloc_free(connection_context->pubsub.pending_messages.list);
+        connection_context->pubsub.pending_messages.list = NULL;
+        connection_context->pubsub.pending_messages.size = 0;
+    }
+}
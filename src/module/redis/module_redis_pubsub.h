@@ -0,0 +1,209 @@
+#ifndef CACHEGRAND_MODULE_REDIS_PUBSUB_H
+#define CACHEGRAND_MODULE_REDIS_PUBSUB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODULE_REDIS_PUBSUB_REGISTRY_BUCKETS_COUNT (1024)
+#define MODULE_REDIS_PUBSUB_LOCAL_BUCKETS_COUNT (1024)
+#define MODULE_REDIS_PUBSUB_LIST_INITIAL_SIZE (4)
+#define MODULE_REDIS_PUBSUB_WRITER_FIBER_NAME "module-redis-pubsub-writer"
+#define MODULE_REDIS_PUBSUB_INVALIDATION_CHANNEL "__redis__:invalidate"
+
+// Each worker keeps its own table of the channels and of the patterns its connections are subscribed to, the table
+// is touched only by the worker so no locks are needed to deliver the messages.
+// The workers also keep up to date a registry shared by all of them, a fixed set of spinlock protected buckets, with
+// the amount of subscribers of each channel (and pattern) on every worker: PUBLISH uses it to know how many clients are
+// going to receive the message and which workers have to be reached, the message is then posted to them via the
+// mailbox, which is made of lock-free spsc queues and falls back to an overflow list when they are full so the
+// messages are never dropped.
+// The message is allocated once, already encoded in the RESP format, and shared read-only by all the workers, it's
+// freed by the last worker releasing it. On the receiving side each worker holds a single reference and keeps a local
+// (non-atomic) counter for the subscribers the message has been queued to, so the shared counter is touched only once
+// per worker and not once per subscriber.
+// The messages are written out by the connection itself between two commands or, if the connection is idle waiting
+// for new data, by a short-lived writer fiber spawned on delivery.
+enum module_redis_pubsub_message_kind {
+    MODULE_REDIS_PUBSUB_MESSAGE_KIND_MESSAGE,
+    // The invalidation messages of the client side caching, sent as invalidate pushes with RESP3 or as messages of the
+    // __redis__:invalidate channel with RESP2
+    MODULE_REDIS_PUBSUB_MESSAGE_KIND_INVALIDATION,
+};
+typedef enum module_redis_pubsub_message_kind module_redis_pubsub_message_kind_t;
+
+typedef struct module_redis_pubsub_message module_redis_pubsub_message_t;
+struct module_redis_pubsub_message {
+    uint32_volatile_t refcount;
+    module_redis_pubsub_message_kind_t kind;
+    uint32_t channel_hash;
+    char *channel;
+    size_t channel_length;
+    // The channel and the payload encoded as blob strings, common to the message and pmessage pushes
+    char *frame_tail;
+    size_t frame_tail_length;
+    // Only for the invalidations, the array with the key within the frame tail, NULL if all the keys are invalidated
+    char *payload_frame;
+    size_t payload_frame_length;
+};
+
+struct module_redis_pubsub_message_local_ref {
+    module_redis_pubsub_message_t *message;
+    uint32_t refcount;
+};
+
+typedef struct module_redis_pubsub_local_channel module_redis_pubsub_local_channel_t;
+struct module_redis_pubsub_local_channel {
+    double_linked_list_item_t item;
+    char *channel;
+    size_t channel_length;
+    double_linked_list_t subscriptions;
+};
+
+typedef struct module_redis_pubsub_local module_redis_pubsub_local_t;
+struct module_redis_pubsub_local {
+    double_linked_list_t channels_buckets[MODULE_REDIS_PUBSUB_LOCAL_BUCKETS_COUNT];
+    double_linked_list_t patterns_subscriptions;
+    uint32_t subscriptions_count;
+};
+
+struct module_redis_pubsub_subscription {
+    double_linked_list_item_t item;
+    module_redis_connection_context_t *connection_context;
+    // Set for the channels, the name is owned by the local channel
+    module_redis_pubsub_local_channel_t *local_channel;
+    // Set for the patterns
+    char *pattern;
+    size_t pattern_length;
+};
+
+typedef struct module_redis_pubsub_registry_entry module_redis_pubsub_registry_entry_t;
+struct module_redis_pubsub_registry_entry {
+    double_linked_list_item_t item;
+    char *name;
+    size_t name_length;
+    uint32_t subscribers_count;
+    uint32_t workers_count;
+    uint32_t *workers_subscribers_count;
+};
+
+typedef struct module_redis_pubsub_registry_bucket module_redis_pubsub_registry_bucket_t;
+struct module_redis_pubsub_registry_bucket {
+    spinlock_lock_volatile_t lock;
+    double_linked_list_t entries;
+} __attribute__((aligned(64)));
+
+module_redis_pubsub_message_t *module_redis_pubsub_message_new(
+        char *channel,
+        size_t channel_length,
+        char *payload,
+        size_t payload_length,
+        uint32_t refcount);
+
+module_redis_pubsub_message_t *module_redis_pubsub_message_new_invalidation(
+        char *key,
+        size_t key_length,
+        uint32_t refcount);
+
+void module_redis_pubsub_message_release(
+        module_redis_pubsub_message_t *message);
+
+void module_redis_pubsub_deliver(
+        void *user_data);
+
+void module_redis_pubsub_deliver_to_connections(
+        module_redis_pubsub_message_t *message,
+        module_redis_connection_context_t **connection_contexts,
+        uint32_t connection_contexts_count);
+
+uint32_t module_redis_pubsub_publish(
+        char *channel,
+        size_t channel_length,
+        char *payload,
+        size_t payload_length);
+
+bool module_redis_pubsub_channel_subscribe(
+        module_redis_connection_context_t *connection_context,
+        char *channel,
+        size_t channel_length);
+
+bool module_redis_pubsub_channel_unsubscribe(
+        module_redis_connection_context_t *connection_context,
+        char *channel,
+        size_t channel_length);
+
+bool module_redis_pubsub_pattern_subscribe(
+        module_redis_connection_context_t *connection_context,
+        char *pattern,
+        size_t pattern_length);
+
+bool module_redis_pubsub_pattern_unsubscribe(
+        module_redis_connection_context_t *connection_context,
+        char *pattern,
+        size_t pattern_length);
+
+bool module_redis_pubsub_unsubscribe_all(
+        module_redis_connection_context_t *connection_context,
+        bool patterns,
+        bool send_replies);
+
+uint32_t module_redis_pubsub_connection_subscriptions_count(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_pubsub_connection_is_subscribed(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_pubsub_connection_is_subscribed_to_channel(
+        module_redis_connection_context_t *connection_context,
+        char *channel,
+        size_t channel_length);
+
+bool module_redis_pubsub_connection_can_migrate(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_pubsub_is_command_allowed_when_subscribed(
+        module_redis_command_info_t *command_info);
+
+bool module_redis_pubsub_send_subscription_reply(
+        module_redis_connection_context_t *connection_context,
+        char *kind,
+        size_t kind_length,
+        char *name,
+        size_t name_length,
+        uint32_t subscriptions_count);
+
+bool module_redis_pubsub_connection_write_pending(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_pubsub_connection_drop_pending(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_pubsub_connection_before_receive(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_pubsub_connection_after_receive(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_pubsub_connection_cleanup(
+        module_redis_connection_context_t *connection_context);
+
+uint32_t module_redis_pubsub_registry_get_channel_subscribers_count(
+        char *channel,
+        size_t channel_length);
+
+uint32_t module_redis_pubsub_registry_get_patterns_count();
+
+module_redis_short_string_t *module_redis_pubsub_registry_get_channels(
+        char *pattern,
+        size_t pattern_length,
+        uint32_t *channels_count);
+
+void module_redis_pubsub_registry_free_channels(
+        module_redis_short_string_t *channels,
+        uint32_t channels_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_PUBSUB_H
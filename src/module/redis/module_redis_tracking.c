@@ -0,0 +1,743 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "memory_fences.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/mcmp/hashtable_support_hash.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_mailbox.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_pubsub.h"
+
+#include "module_redis_tracking.h"
+
+#define TAG "module_redis_tracking"
+
+static uint64_volatile_t module_redis_tracking_client_id_counter = 0;
+static module_redis_tracking_clients_bucket_t module_redis_tracking_clients[MODULE_REDIS_TRACKING_CLIENTS_BUCKETS_COUNT] = { 0 };
+static uint32_volatile_t module_redis_tracking_enabled_clients_count = 0;
+
+static spinlock_lock_volatile_t module_redis_tracking_table_lock = { 0 };
+static module_redis_tracking_table_bucket_t *module_redis_tracking_table = NULL;
+
+static spinlock_lock_volatile_t module_redis_tracking_prefixes_lock = { 0 };
+static double_linked_list_t module_redis_tracking_prefixes = { 0 };
+static uint32_volatile_t module_redis_tracking_prefixes_count = 0;
+
+static thread_local struct {
+    module_redis_tracking_touched_key_t *list;
+    uint32_t count;
+    uint32_t size;
+    bool flush_scheduled;
+} module_redis_tracking_touched_keys = { 0 };
+
+static inline module_redis_tracking_clients_bucket_t *module_redis_tracking_clients_bucket(
+        uint64_t client_id) {
+    return &module_redis_tracking_clients[client_id & (MODULE_REDIS_TRACKING_CLIENTS_BUCKETS_COUNT - 1)];
+}
+
+static module_redis_tracking_client_t *module_redis_tracking_client_find(
+        module_redis_tracking_clients_bucket_t *bucket,
+        uint64_t client_id) {
+    for(
+            double_linked_list_item_t *item = bucket->clients.head;
+            item != NULL;
+            item = item->next) {
+        module_redis_tracking_client_t *client = item->data;
+
+        if (client->client_id == client_id) {
+            return client;
+        }
+    }
+
+    return NULL;
+}
+
+static void module_redis_tracking_list_append(
+        uint64_t **list,
+        uint32_t *count,
+        uint32_t *size,
+        uint64_t client_id) {
+    if (*count == *size) {
+        *size = *size == 0 ? MODULE_REDIS_TRACKING_LIST_INITIAL_SIZE : *size * 2;
+        *list = xalloc_realloc(*list, sizeof(uint64_t) * *size);
+    }
+
+    (*list)[(*count)++] = client_id;
+}
+
+void module_redis_tracking_connection_register(
+        module_redis_connection_context_t *connection_context) {
+    connection_context->client_id = __sync_add_and_fetch(&module_redis_tracking_client_id_counter, 1);
+
+    module_redis_tracking_client_t *client = xalloc_alloc_zero(sizeof(module_redis_tracking_client_t));
+    client->item.data = client;
+    client->client_id = connection_context->client_id;
+    client->worker_index = worker_context_get()->worker_index;
+    client->connection_context = connection_context;
+
+    module_redis_tracking_clients_bucket_t *bucket = module_redis_tracking_clients_bucket(client->client_id);
+    spinlock_lock(&bucket->lock);
+    double_linked_list_push_item(&bucket->clients, &client->item);
+    spinlock_unlock(&bucket->lock);
+}
+
+void module_redis_tracking_connection_unregister(
+        module_redis_connection_context_t *connection_context) {
+    if (connection_context->client_id == 0) {
+        return;
+    }
+
+    module_redis_tracking_disable(connection_context);
+
+    module_redis_tracking_clients_bucket_t *bucket = module_redis_tracking_clients_bucket(
+            connection_context->client_id);
+    spinlock_lock(&bucket->lock);
+
+    module_redis_tracking_client_t *client = module_redis_tracking_client_find(bucket, connection_context->client_id);
+    assert(client != NULL);
+    double_linked_list_remove_item(&bucket->clients, &client->item);
+
+    spinlock_unlock(&bucket->lock);
+
+    xalloc_free(client);
+    connection_context->client_id = 0;
+}
+
+bool module_redis_tracking_connection_detach(
+        module_redis_connection_context_t *connection_context) {
+    bool detached = false;
+    module_redis_tracking_clients_bucket_t *bucket = module_redis_tracking_clients_bucket(
+            connection_context->client_id);
+
+    spinlock_lock(&bucket->lock);
+
+    // The connection can't be moved if some other client is redirecting the invalidations to it, the check is done
+    // under the lock as a client might start to redirect to it at any time
+    module_redis_tracking_client_t *client = module_redis_tracking_client_find(bucket, connection_context->client_id);
+    if (client != NULL && !client->enabled && client->referrers_count == 0) {
+        client->connection_context = NULL;
+        detached = true;
+    }
+
+    spinlock_unlock(&bucket->lock);
+
+    return detached;
+}
+
+void module_redis_tracking_connection_attach(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_tracking_clients_bucket_t *bucket = module_redis_tracking_clients_bucket(
+            connection_context->client_id);
+
+    spinlock_lock(&bucket->lock);
+
+    module_redis_tracking_client_t *client = module_redis_tracking_client_find(bucket, connection_context->client_id);
+    assert(client != NULL);
+    client->worker_index = worker_context_get()->worker_index;
+    client->connection_context = connection_context;
+
+    spinlock_unlock(&bucket->lock);
+}
+
+bool module_redis_tracking_connection_can_migrate(
+        module_redis_connection_context_t *connection_context) {
+    // The keys tracked and the prefixes refer to the client id, which doesn't change, but the invalidations might be
+    // already on their way to the current worker
+    return !connection_context->tracking.enabled;
+}
+
+static bool module_redis_tracking_client_update_referrers(
+        uint64_t client_id,
+        int32_t delta) {
+    module_redis_tracking_clients_bucket_t *bucket = module_redis_tracking_clients_bucket(client_id);
+
+    spinlock_lock(&bucket->lock);
+
+    module_redis_tracking_client_t *client = module_redis_tracking_client_find(bucket, client_id);
+    if (client != NULL) {
+        client->referrers_count += delta;
+    }
+
+    spinlock_unlock(&bucket->lock);
+
+    return client != NULL;
+}
+
+static void module_redis_tracking_client_update_settings(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_tracking_clients_bucket_t *bucket = module_redis_tracking_clients_bucket(
+            connection_context->client_id);
+
+    spinlock_lock(&bucket->lock);
+
+    module_redis_tracking_client_t *client = module_redis_tracking_client_find(bucket, connection_context->client_id);
+    assert(client != NULL);
+    client->enabled = connection_context->tracking.enabled;
+    client->noloop = connection_context->tracking.noloop;
+    client->redirect_client_id = connection_context->tracking.redirect_client_id;
+
+    spinlock_unlock(&bucket->lock);
+}
+
+static void module_redis_tracking_table_ensure_allocated() {
+    MEMORY_FENCE_LOAD();
+    if (likely(module_redis_tracking_table != NULL)) {
+        return;
+    }
+
+    spinlock_lock(&module_redis_tracking_table_lock);
+
+    if (module_redis_tracking_table == NULL) {
+        module_redis_tracking_table = xalloc_alloc_aligned_zero(
+                64,
+                sizeof(module_redis_tracking_table_bucket_t) * MODULE_REDIS_TRACKING_TABLE_BUCKETS_COUNT);
+        MEMORY_FENCE_STORE();
+    }
+
+    spinlock_unlock(&module_redis_tracking_table_lock);
+}
+
+static void module_redis_tracking_prefix_add(
+        uint64_t client_id,
+        char *prefix,
+        size_t prefix_length) {
+    module_redis_tracking_prefix_t *tracking_prefix = xalloc_alloc_zero(sizeof(module_redis_tracking_prefix_t));
+    tracking_prefix->item.data = tracking_prefix;
+    tracking_prefix->client_id = client_id;
+    tracking_prefix->prefix_length = prefix_length;
+
+    if (prefix_length > 0) {
+        tracking_prefix->prefix = xalloc_alloc(prefix_length);
+        memcpy(tracking_prefix->prefix, prefix, prefix_length);
+    }
+
+    spinlock_lock(&module_redis_tracking_prefixes_lock);
+    double_linked_list_push_item(&module_redis_tracking_prefixes, &tracking_prefix->item);
+    module_redis_tracking_prefixes_count++;
+    spinlock_unlock(&module_redis_tracking_prefixes_lock);
+}
+
+static void module_redis_tracking_prefixes_remove(
+        uint64_t client_id) {
+    spinlock_lock(&module_redis_tracking_prefixes_lock);
+
+    double_linked_list_item_t *item = module_redis_tracking_prefixes.head;
+    while(item != NULL) {
+        module_redis_tracking_prefix_t *tracking_prefix = item->data;
+        item = item->next;
+
+        if (tracking_prefix->client_id != client_id) {
+            continue;
+        }
+
+        double_linked_list_remove_item(&module_redis_tracking_prefixes, &tracking_prefix->item);
+        module_redis_tracking_prefixes_count--;
+
+        if (tracking_prefix->prefix) {
+            xalloc_free(tracking_prefix->prefix);
+        }
+        xalloc_free(tracking_prefix);
+    }
+
+    spinlock_unlock(&module_redis_tracking_prefixes_lock);
+}
+
+bool module_redis_tracking_enable(
+        module_redis_connection_context_t *connection_context,
+        uint64_t redirect_client_id,
+        bool bcast,
+        bool noloop,
+        module_redis_short_string_t *prefixes,
+        uint32_t prefixes_count) {
+    // The redirect target is acquired first, if it doesn't exist the current settings are left untouched
+    if (redirect_client_id != 0 && !module_redis_tracking_client_update_referrers(redirect_client_id, 1)) {
+        return false;
+    }
+
+    module_redis_tracking_disable(connection_context);
+
+    if (bcast) {
+        if (prefixes_count == 0) {
+            module_redis_tracking_prefix_add(connection_context->client_id, NULL, 0);
+        }
+
+        for(uint32_t index = 0; index < prefixes_count; index++) {
+            module_redis_tracking_prefix_add(
+                    connection_context->client_id,
+                    prefixes[index].short_string,
+                    prefixes[index].length);
+        }
+    } else {
+        module_redis_tracking_table_ensure_allocated();
+    }
+
+    connection_context->tracking.enabled = true;
+    connection_context->tracking.bcast = bcast;
+    connection_context->tracking.noloop = noloop;
+    connection_context->tracking.redirect_client_id = redirect_client_id;
+    module_redis_tracking_client_update_settings(connection_context);
+
+    __sync_fetch_and_add(&module_redis_tracking_enabled_clients_count, 1);
+
+    // The hook is never removed, when no client is tracking anything it returns straight away
+    connection_context->db->hashtable->key_touched_fp = module_redis_tracking_key_touched;
+    MEMORY_FENCE_STORE();
+
+    return true;
+}
+
+void module_redis_tracking_disable(
+        module_redis_connection_context_t *connection_context) {
+    if (!connection_context->tracking.enabled) {
+        return;
+    }
+
+    if (connection_context->tracking.redirect_client_id != 0) {
+        module_redis_tracking_client_update_referrers(connection_context->tracking.redirect_client_id, -1);
+    }
+
+    if (connection_context->tracking.bcast) {
+        module_redis_tracking_prefixes_remove(connection_context->client_id);
+    }
+
+    // The entries of the client in the table are left there, they are dropped when the keys are changed or evicted
+    connection_context->tracking.enabled = false;
+    connection_context->tracking.bcast = false;
+    connection_context->tracking.noloop = false;
+    connection_context->tracking.redirect_client_id = 0;
+    module_redis_tracking_client_update_settings(connection_context);
+
+    __sync_fetch_and_sub(&module_redis_tracking_enabled_clients_count, 1);
+}
+
+static void module_redis_tracking_dispatch(
+        char *key,
+        size_t key_length,
+        uint64_t *client_ids,
+        uint32_t client_ids_count,
+        uint64_t writer_client_id);
+
+void module_redis_tracking_remember_key(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length) {
+    uint64_t evicted_client_id = 0;
+
+    // In BCAST mode nothing is recorded on read
+    if (connection_context->tracking.bcast) {
+        return;
+    }
+
+    hashtable_hash_t hash = hashtable_mcmp_support_hash_calculate(
+            connection_context->database_number,
+            key,
+            key_length);
+    module_redis_tracking_table_bucket_t *bucket =
+            &module_redis_tracking_table[hash & (MODULE_REDIS_TRACKING_TABLE_BUCKETS_COUNT - 1)];
+
+    spinlock_lock(&bucket->lock);
+
+    for(uint8_t index = 0; index < bucket->count; index++) {
+        if (bucket->entries[index].hash == hash && bucket->entries[index].client_id == connection_context->client_id) {
+            spinlock_unlock(&bucket->lock);
+            return;
+        }
+    }
+
+    if (bucket->count == MODULE_REDIS_TRACKING_TABLE_BUCKET_ENTRIES_COUNT) {
+        evicted_client_id = bucket->entries[0].client_id;
+        memmove(
+                &bucket->entries[0],
+                &bucket->entries[1],
+                sizeof(module_redis_tracking_table_entry_t) * (MODULE_REDIS_TRACKING_TABLE_BUCKET_ENTRIES_COUNT - 1));
+        bucket->count--;
+    }
+
+    bucket->entries[bucket->count].hash = hash;
+    bucket->entries[bucket->count].client_id = connection_context->client_id;
+    bucket->count++;
+
+    spinlock_unlock(&bucket->lock);
+
+    // The key of the evicted entry isn't known, the client has to drop everything it has cached
+    if (unlikely(evicted_client_id != 0)) {
+        module_redis_tracking_dispatch(NULL, 0, &evicted_client_id, 1, 0);
+    }
+}
+
+void module_redis_tracking_command_begin(
+        module_redis_connection_context_t *connection_context) {
+    // The fibers switch while processing the commands, the client is tracked on the fiber processing the command so
+    // only the keys changed by that fiber are attributed to it
+    fiber_scheduler_get_current()->client_id = connection_context->client_id;
+}
+
+void module_redis_tracking_command_end() {
+    fiber_scheduler_get_current()->client_id = 0;
+    module_redis_tracking_flush();
+}
+
+static void module_redis_tracking_flush_mailbox_callback(
+        void *user_data) {
+    module_redis_tracking_touched_keys.flush_scheduled = false;
+    module_redis_tracking_flush();
+}
+
+void module_redis_tracking_key_touched(
+        hashtable_hash_t hash,
+        hashtable_database_number_t database_number,
+        hashtable_key_data_t *key,
+        hashtable_key_length_t key_length) {
+    worker_context_t *worker_context;
+
+    MEMORY_FENCE_LOAD();
+    if (likely(module_redis_tracking_enabled_clients_count == 0)) {
+        return;
+    }
+
+    // The hook is invoked while the hashtable holds the lock of the chunk, only the check and the copy of the key are
+    // done here, if nobody might be interested in the key nothing is done at all
+    module_redis_tracking_table_bucket_t *table = module_redis_tracking_table;
+    if (module_redis_tracking_prefixes_count == 0 &&
+        (table == NULL || table[hash & (MODULE_REDIS_TRACKING_TABLE_BUCKETS_COUNT - 1)].count == 0)) {
+        return;
+    }
+
+    if (unlikely((worker_context = worker_context_get()) == NULL)) {
+        return;
+    }
+
+    uint64_t writer_client_id = fiber_scheduler_is_in_fiber() ? fiber_scheduler_get_current()->client_id : 0;
+    bool in_command = writer_client_id != 0;
+
+    if (module_redis_tracking_touched_keys.count == module_redis_tracking_touched_keys.size) {
+        module_redis_tracking_touched_keys.size = module_redis_tracking_touched_keys.size == 0
+                ? MODULE_REDIS_TRACKING_LIST_INITIAL_SIZE
+                : module_redis_tracking_touched_keys.size * 2;
+        module_redis_tracking_touched_keys.list = xalloc_realloc(
+                module_redis_tracking_touched_keys.list,
+                sizeof(module_redis_tracking_touched_key_t) * module_redis_tracking_touched_keys.size);
+    }
+
+    module_redis_tracking_touched_key_t *touched_key =
+            &module_redis_tracking_touched_keys.list[module_redis_tracking_touched_keys.count++];
+    touched_key->hash = hash;
+    touched_key->key = xalloc_alloc(key_length);
+    touched_key->key_length = key_length;
+    touched_key->writer_client_id = writer_client_id;
+    memcpy(touched_key->key, key, key_length);
+
+    // The keys changed by the commands are flushed when the command ends, the ones changed by anything else (e.g. the
+    // expiration of the keys) are flushed by the mailbox of the worker
+    if (!in_command && !module_redis_tracking_touched_keys.flush_scheduled) {
+        module_redis_tracking_touched_keys.flush_scheduled = worker_mailbox_post(
+                worker_context->worker_index,
+                module_redis_tracking_flush_mailbox_callback,
+                NULL);
+    }
+}
+
+static bool module_redis_tracking_post(
+        uint32_t worker_index,
+        module_redis_tracking_delivery_t *delivery) {
+    for(uint32_t attempt = 0; attempt < MODULE_REDIS_TRACKING_POST_MAX_ATTEMPTS; attempt++) {
+        if (likely(worker_mailbox_post(worker_index, module_redis_tracking_deliver, delivery))) {
+            return true;
+        }
+
+        // The queue towards the worker is full, give it a chance to catch up
+        if (fiber_scheduler_is_in_fiber()) {
+            fiber_scheduler_yield();
+        }
+    }
+
+    return false;
+}
+
+static void module_redis_tracking_delivery_free(
+        module_redis_tracking_delivery_t *delivery) {
+    if (delivery->client_ids) {
+        xalloc_free(delivery->client_ids);
+    }
+
+    xalloc_free(delivery);
+}
+
+static void module_redis_tracking_dispatch(
+        char *key,
+        size_t key_length,
+        uint64_t *client_ids,
+        uint32_t client_ids_count,
+        uint64_t writer_client_id) {
+    uint32_t target_workers_count = 0;
+    worker_context_t *worker_context = worker_context_get();
+    module_redis_tracking_delivery_t **deliveries = xalloc_alloc_zero(
+            sizeof(module_redis_tracking_delivery_t*) * worker_context->workers_count);
+
+    // The settings of the clients are checked when the key is changed, the invalidations are sent to the clients the
+    // invalidations are redirected to, grouped per worker serving them
+    for(uint32_t index = 0; index < client_ids_count; index++) {
+        uint64_t target_client_id = 0;
+        uint32_t target_worker_index = UINT32_MAX;
+        module_redis_tracking_clients_bucket_t *bucket = module_redis_tracking_clients_bucket(client_ids[index]);
+
+        spinlock_lock(&bucket->lock);
+
+        module_redis_tracking_client_t *client = module_redis_tracking_client_find(bucket, client_ids[index]);
+        if (client != NULL && client->enabled && !(client->noloop && client->client_id == writer_client_id)) {
+            if (client->redirect_client_id == 0) {
+                target_client_id = client->client_id;
+                target_worker_index = client->worker_index;
+            } else {
+                target_client_id = client->redirect_client_id;
+            }
+        }
+
+        spinlock_unlock(&bucket->lock);
+
+        if (target_client_id != 0 && target_worker_index == UINT32_MAX) {
+            bucket = module_redis_tracking_clients_bucket(target_client_id);
+            spinlock_lock(&bucket->lock);
+
+            client = module_redis_tracking_client_find(bucket, target_client_id);
+            if (client != NULL) {
+                target_worker_index = client->worker_index;
+            }
+
+            spinlock_unlock(&bucket->lock);
+        }
+
+        if (target_worker_index == UINT32_MAX) {
+            continue;
+        }
+
+        if (deliveries[target_worker_index] == NULL) {
+            deliveries[target_worker_index] = xalloc_alloc_zero(sizeof(module_redis_tracking_delivery_t));
+            target_workers_count++;
+        }
+
+        module_redis_tracking_list_append(
+                &deliveries[target_worker_index]->client_ids,
+                &deliveries[target_worker_index]->count,
+                &deliveries[target_worker_index]->size,
+                target_client_id);
+    }
+
+    if (target_workers_count == 0) {
+        xalloc_free(deliveries);
+        return;
+    }
+
+    // Each worker reached holds one reference
+    module_redis_pubsub_message_t *message = module_redis_pubsub_message_new_invalidation(
+            key,
+            key_length,
+            target_workers_count);
+
+    for(uint32_t worker_index = 0; worker_index < worker_context->workers_count; worker_index++) {
+        module_redis_tracking_delivery_t *delivery = deliveries[worker_index];
+
+        if (delivery == NULL || worker_index == worker_context->worker_index) {
+            continue;
+        }
+
+        delivery->message = message;
+        if (unlikely(!module_redis_tracking_post(worker_index, delivery))) {
+            LOG_W(TAG, "Unable to post the invalidation to the worker <%u>, dropping it", worker_index);
+
+            module_redis_pubsub_message_release(message);
+            module_redis_tracking_delivery_free(delivery);
+        }
+    }
+
+    if (deliveries[worker_context->worker_index] != NULL) {
+        deliveries[worker_context->worker_index]->message = message;
+        module_redis_tracking_deliver(deliveries[worker_context->worker_index]);
+    }
+
+    xalloc_free(deliveries);
+}
+
+static void module_redis_tracking_invalidate_key(
+        module_redis_tracking_touched_key_t *touched_key) {
+    uint64_t *client_ids = NULL;
+    uint32_t client_ids_count = 0, client_ids_size = 0;
+    module_redis_tracking_table_bucket_t *table = module_redis_tracking_table;
+
+    // In the default mode the entries are dropped once the invalidation has been sent, the clients will read the key
+    // again if they are still interested in it
+    if (table != NULL) {
+        uint8_t kept_count = 0;
+        module_redis_tracking_table_bucket_t *bucket =
+                &table[touched_key->hash & (MODULE_REDIS_TRACKING_TABLE_BUCKETS_COUNT - 1)];
+
+        spinlock_lock(&bucket->lock);
+
+        for(uint8_t index = 0; index < bucket->count; index++) {
+            if (bucket->entries[index].hash != touched_key->hash) {
+                bucket->entries[kept_count++] = bucket->entries[index];
+                continue;
+            }
+
+            module_redis_tracking_list_append(
+                    &client_ids,
+                    &client_ids_count,
+                    &client_ids_size,
+                    bucket->entries[index].client_id);
+        }
+        bucket->count = kept_count;
+
+        spinlock_unlock(&bucket->lock);
+    }
+
+    MEMORY_FENCE_LOAD();
+    if (module_redis_tracking_prefixes_count > 0) {
+        spinlock_lock(&module_redis_tracking_prefixes_lock);
+
+        for(
+                double_linked_list_item_t *item = module_redis_tracking_prefixes.head;
+                item != NULL;
+                item = item->next) {
+            module_redis_tracking_prefix_t *tracking_prefix = item->data;
+            bool already_added = false;
+
+            if (tracking_prefix->prefix_length > touched_key->key_length ||
+                memcmp(tracking_prefix->prefix, touched_key->key, tracking_prefix->prefix_length) != 0) {
+                continue;
+            }
+
+            // A client receives one invalidation even if the key matches more than one of its prefixes
+            for(uint32_t index = 0; index < client_ids_count && !already_added; index++) {
+                already_added = client_ids[index] == tracking_prefix->client_id;
+            }
+
+            if (!already_added) {
+                module_redis_tracking_list_append(
+                        &client_ids,
+                        &client_ids_count,
+                        &client_ids_size,
+                        tracking_prefix->client_id);
+            }
+        }
+
+        spinlock_unlock(&module_redis_tracking_prefixes_lock);
+    }
+
+    if (client_ids_count > 0) {
+        module_redis_tracking_dispatch(
+                touched_key->key,
+                touched_key->key_length,
+                client_ids,
+                client_ids_count,
+                touched_key->writer_client_id);
+    }
+
+    if (client_ids) {
+        xalloc_free(client_ids);
+    }
+}
+
+void module_redis_tracking_flush() {
+    while(unlikely(module_redis_tracking_touched_keys.count > 0)) {
+        // The list is taken over as the dispatching might yield and other keys might be touched in the meantime
+        module_redis_tracking_touched_key_t *touched_keys = module_redis_tracking_touched_keys.list;
+        uint32_t touched_keys_count = module_redis_tracking_touched_keys.count;
+
+        module_redis_tracking_touched_keys.list = NULL;
+        module_redis_tracking_touched_keys.count = 0;
+        module_redis_tracking_touched_keys.size = 0;
+
+        for(uint32_t index = 0; index < touched_keys_count; index++) {
+            module_redis_tracking_invalidate_key(&touched_keys[index]);
+            xalloc_free(touched_keys[index].key);
+        }
+
+        xalloc_free(touched_keys);
+    }
+}
+
+void module_redis_tracking_deliver(
+        void *user_data) {
+    uint32_t connection_contexts_count = 0;
+    module_redis_tracking_delivery_t *delivery = user_data;
+    worker_context_t *worker_context = worker_context_get();
+    module_redis_connection_context_t **connection_contexts = xalloc_alloc(
+            sizeof(module_redis_connection_context_t*) * delivery->count);
+
+    for(uint32_t index = 0; index < delivery->count; index++) {
+        module_redis_connection_context_t *connection_context = NULL;
+        module_redis_tracking_clients_bucket_t *bucket = module_redis_tracking_clients_bucket(
+                delivery->client_ids[index]);
+
+        // The client might have gone away or be migrating, the connection context can be used only by the worker
+        // serving the connection
+        spinlock_lock(&bucket->lock);
+
+        module_redis_tracking_client_t *client = module_redis_tracking_client_find(bucket, delivery->client_ids[index]);
+        if (client != NULL && client->worker_index == worker_context->worker_index) {
+            connection_context = client->connection_context;
+        }
+
+        spinlock_unlock(&bucket->lock);
+
+        if (connection_context == NULL) {
+            continue;
+        }
+
+        // With RESP2 the invalidations can be received only through the __redis__:invalidate channel
+        if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2 &&
+            !module_redis_pubsub_connection_is_subscribed_to_channel(
+                    connection_context,
+                    MODULE_REDIS_PUBSUB_INVALIDATION_CHANNEL,
+                    strlen(MODULE_REDIS_PUBSUB_INVALIDATION_CHANNEL))) {
+            continue;
+        }
+
+        connection_contexts[connection_contexts_count++] = connection_context;
+    }
+
+    module_redis_pubsub_deliver_to_connections(
+            delivery->message,
+            connection_contexts,
+            connection_contexts_count);
+
+    xalloc_free(connection_contexts);
+    module_redis_tracking_delivery_free(delivery);
+}
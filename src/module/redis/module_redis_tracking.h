@@ -0,0 +1,138 @@
+#ifndef CACHEGRAND_MODULE_REDIS_TRACKING_H
+#define CACHEGRAND_MODULE_REDIS_TRACKING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODULE_REDIS_TRACKING_CLIENTS_BUCKETS_COUNT (1024)
+#define MODULE_REDIS_TRACKING_TABLE_BUCKETS_COUNT (128 * 1024)
+#define MODULE_REDIS_TRACKING_TABLE_BUCKET_ENTRIES_COUNT (3)
+#define MODULE_REDIS_TRACKING_LIST_INITIAL_SIZE (8)
+#define MODULE_REDIS_TRACKING_POST_MAX_ATTEMPTS (64)
+
+// Every connection gets an id, used by CLIENT ID and CLIENT TRACKING REDIRECT, and an entry in a registry shared by
+// all the workers, a fixed set of spinlock protected buckets, holding the worker currently serving the connection and
+// its tracking settings.
+// In the default mode the keys read by the clients are recorded in a table with a fixed amount of buckets, each one
+// fitting a cache line, keyed by the hash the hashtable calculates for the key; an entry is just the hash and the id of
+// the client, so the memory used is bounded and allocated only once the first client enables the tracking. If a bucket
+// is full the oldest entry is evicted and its client is asked to flush its whole cache, as the key isn't known anymore.
+// In the BCAST mode the clients register the prefixes they are interested in, without recording anything on read.
+// The hashtable calls a hook every time a key is changed or deleted, the hook only checks if any client might be
+// interested in the key and copies it in a per-worker list; the list is flushed at the end of the command, or via the
+// mailbox of the worker if the key was changed outside of a command, and the invalidation messages are posted to the
+// workers serving the clients and written out through the pub/sub machinery, as RESP3 pushes or, for the clients
+// redirecting to a RESP2 connection, as messages of the __redis__:invalidate channel.
+
+typedef struct module_redis_tracking_client module_redis_tracking_client_t;
+struct module_redis_tracking_client {
+    double_linked_list_item_t item;
+    uint64_t client_id;
+    uint32_t worker_index;
+    // Set to NULL while the connection is being migrated to another worker
+    module_redis_connection_context_t *connection_context;
+    bool enabled;
+    bool noloop;
+    uint64_t redirect_client_id;
+    // The amount of tracking clients redirecting to this client, it can't be migrated while they are there
+    uint32_t referrers_count;
+};
+
+typedef struct module_redis_tracking_clients_bucket module_redis_tracking_clients_bucket_t;
+struct module_redis_tracking_clients_bucket {
+    spinlock_lock_volatile_t lock;
+    double_linked_list_t clients;
+} __attribute__((aligned(64)));
+
+typedef struct module_redis_tracking_table_entry module_redis_tracking_table_entry_t;
+struct module_redis_tracking_table_entry {
+    uint64_t hash;
+    uint64_t client_id;
+};
+
+typedef struct module_redis_tracking_table_bucket module_redis_tracking_table_bucket_t;
+struct module_redis_tracking_table_bucket {
+    spinlock_lock_volatile_t lock;
+    uint8_volatile_t count;
+    // The entries are kept in insertion order, the first one is the oldest
+    module_redis_tracking_table_entry_t entries[MODULE_REDIS_TRACKING_TABLE_BUCKET_ENTRIES_COUNT];
+} __attribute__((aligned(64)));
+
+typedef struct module_redis_tracking_prefix module_redis_tracking_prefix_t;
+struct module_redis_tracking_prefix {
+    double_linked_list_item_t item;
+    uint64_t client_id;
+    char *prefix;
+    size_t prefix_length;
+};
+
+typedef struct module_redis_tracking_touched_key module_redis_tracking_touched_key_t;
+struct module_redis_tracking_touched_key {
+    uint64_t hash;
+    char *key;
+    size_t key_length;
+    // The id of the client that changed the key, 0 if not known, used only by NOLOOP
+    uint64_t writer_client_id;
+};
+
+typedef struct module_redis_tracking_delivery module_redis_tracking_delivery_t;
+struct module_redis_tracking_delivery {
+    module_redis_pubsub_message_t *message;
+    uint64_t *client_ids;
+    uint32_t count;
+    uint32_t size;
+};
+
+void module_redis_tracking_connection_register(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_tracking_connection_unregister(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_tracking_connection_detach(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_tracking_connection_attach(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_tracking_connection_can_migrate(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_tracking_enable(
+        module_redis_connection_context_t *connection_context,
+        uint64_t redirect_client_id,
+        bool bcast,
+        bool noloop,
+        module_redis_short_string_t *prefixes,
+        uint32_t prefixes_count);
+
+void module_redis_tracking_disable(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_tracking_remember_key(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length);
+
+void module_redis_tracking_command_begin(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_tracking_command_end();
+
+void module_redis_tracking_key_touched(
+        hashtable_hash_t hash,
+        hashtable_database_number_t database_number,
+        hashtable_key_data_t *key,
+        hashtable_key_length_t key_length);
+
+void module_redis_tracking_flush();
+
+void module_redis_tracking_deliver(
+        void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_TRACKING_H
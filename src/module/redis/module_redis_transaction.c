@@ -0,0 +1,481 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "xalloc.h"
+#include "xalloc_arena.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+
+#include "module_redis_transaction.h"
+
+#define TAG "module_redis_transaction"
+
+static bool module_redis_transaction_list_ensure_space(
+        void **list,
+        uint32_t count,
+        uint32_t *size,
+        size_t item_size) {
+    if (likely(count < *size)) {
+        return true;
+    }
+
+    uint32_t new_size = *size == 0 ? MODULE_REDIS_TRANSACTION_LIST_INITIAL_SIZE : *size * 2;
+    void *new_list = xalloc_realloc(*list, new_size * item_size);
+
+    if (unlikely(new_list == NULL)) {
+        LOG_E(TAG, "Unable to expand the transaction list to <%u> items", new_size);
+        return false;
+    }
+
+    *list = new_list;
+    *size = new_size;
+
+    return true;
+}
+
+static void module_redis_transaction_queued_command_free(
+        module_redis_connection_context_t *connection_context,
+        module_redis_connection_transaction_queued_command_t *queued_command) {
+    module_redis_command_info_t *command_info = connection_context->command.info;
+    module_redis_command_context_t *command_context = connection_context->command.context;
+    struct xalloc_arena *command_arena = connection_context->command.arena;
+
+    // The free callback of the commands operates on the command currently set in the connection context
+    connection_context->command.info = queued_command->info;
+    connection_context->command.context = queued_command->context;
+    connection_context->command.arena = queued_command->arena;
+
+    module_redis_command_process_try_free(connection_context);
+
+    connection_context->command.info = command_info;
+    connection_context->command.context = command_context;
+    connection_context->command.arena = command_arena;
+
+    xalloc_arena_free(queued_command->arena);
+}
+
+static void module_redis_transaction_queued_commands_free(
+        module_redis_connection_context_t *connection_context) {
+    for(uint32_t index = 0; index < connection_context->transaction.queued_commands.count; index++) {
+        module_redis_transaction_queued_command_free(
+                connection_context,
+                &connection_context->transaction.queued_commands.list[index]);
+    }
+
+    connection_context->transaction.queued_commands.count = 0;
+}
+
+bool module_redis_transaction_is_command_queueable(
+        module_redis_command_info_t *command_info) {
+    switch (command_info->command) {
+        case MODULE_REDIS_COMMAND_MULTI:
+        case MODULE_REDIS_COMMAND_EXEC:
+        case MODULE_REDIS_COMMAND_DISCARD:
+        case MODULE_REDIS_COMMAND_WATCH:
+        case MODULE_REDIS_COMMAND_UNWATCH:
+        case MODULE_REDIS_COMMAND_QUIT:
+            return false;
+
+        default:
+            return true;
+    }
+}
+
+bool module_redis_transaction_is_command_allowed(
+        module_redis_command_info_t *command_info) {
+    switch (command_info->command) {
+        // These commands lock the entries they access on demand, doing it while EXEC holds the locks of the queued
+        // keys would break the ascending locking order and might deadlock with another EXEC, SAVE would wait for the
+        // snapshot which in turn would wait for the locks held by EXEC
+        case MODULE_REDIS_COMMAND_KEYS:
+        case MODULE_REDIS_COMMAND_SCAN:
+        case MODULE_REDIS_COMMAND_RANDOMKEY:
+        case MODULE_REDIS_COMMAND_FLUSHDB:
+        case MODULE_REDIS_COMMAND_SORT:
+        case MODULE_REDIS_COMMAND_SORT_RO:
+        case MODULE_REDIS_COMMAND_SAVE:
+            return false;
+
+        default:
+            return true;
+    }
+}
+
+bool module_redis_transaction_should_queue_command(
+        module_redis_connection_context_t *connection_context) {
+    return
+            connection_context->transaction.queueing &&
+            module_redis_transaction_is_command_queueable(connection_context->command.info);
+}
+
+bool module_redis_transaction_track_key(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length) {
+    if (unlikely(!module_redis_transaction_list_ensure_space(
+            (void**)&connection_context->transaction.key_lock_indexes.list,
+            connection_context->transaction.key_lock_indexes.count,
+            &connection_context->transaction.key_lock_indexes.size,
+            sizeof(storage_db_key_lock_index_t)))) {
+        return false;
+    }
+
+    connection_context->transaction.key_lock_indexes.list[connection_context->transaction.key_lock_indexes.count] =
+            storage_db_get_key_lock_index(
+                    connection_context->db,
+                    connection_context->transaction.database_number,
+                    key,
+                    key_length);
+    connection_context->transaction.key_lock_indexes.count++;
+
+    return true;
+}
+
+bool module_redis_transaction_queue_command(
+        module_redis_connection_context_t *connection_context) {
+    bool valid;
+    module_redis_connection_transaction_queued_command_t *queued_command;
+
+    if (unlikely(!module_redis_command_process_end_validate(connection_context, &valid))) {
+        return false;
+    }
+
+    // The error is sent by the caller and the transaction is flagged as failed
+    if (unlikely(!valid)) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_transaction_is_command_allowed(connection_context->command.info))) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Command not allowed inside a transaction");
+    }
+
+    if (unlikely(!module_redis_transaction_list_ensure_space(
+            (void**)&connection_context->transaction.queued_commands.list,
+            connection_context->transaction.queued_commands.count,
+            &connection_context->transaction.queued_commands.size,
+            sizeof(module_redis_connection_transaction_queued_command_t)))) {
+        return false;
+    }
+
+    // The keys of the commands following a SELECT belong to the selected database, the index is validated again when
+    // the command is executed
+    if (connection_context->command.info->command == MODULE_REDIS_COMMAND_SELECT) {
+        module_redis_command_select_context_t *context = connection_context->command.context;
+        if (context->index.value >= 0 && context->index.value < connection_context->db->config->max_user_databases) {
+            connection_context->transaction.database_number = context->index.value;
+        }
+    }
+
+    // The context and all the memory allocated while parsing the command are moved into the queue, the connection
+    // gets a new arena for the commands that will follow
+    struct xalloc_arena *arena = xalloc_arena_new(MODULE_REDIS_COMMAND_ARENA_BLOCK_SIZE);
+    if (unlikely(arena == NULL)) {
+        return false;
+    }
+
+    queued_command = &connection_context->transaction.queued_commands.list[
+            connection_context->transaction.queued_commands.count];
+    queued_command->info = connection_context->command.info;
+    queued_command->context = connection_context->command.context;
+    queued_command->arena = connection_context->command.arena;
+    connection_context->transaction.queued_commands.count++;
+
+    connection_context->command.context = NULL;
+    connection_context->command.arena = arena;
+
+    return module_redis_connection_send_simple_string(
+            connection_context,
+            "QUEUED",
+            6);
+}
+
+void module_redis_transaction_flag_error(
+        module_redis_connection_context_t *connection_context) {
+    // The errors of the commands that are not queued, e.g. MULTI nested or WATCH inside MULTI, don't abort the
+    // transaction
+    if (connection_context->command.info == NULL ||
+        module_redis_transaction_is_command_queueable(connection_context->command.info)) {
+        connection_context->transaction.has_errors = true;
+    }
+}
+
+void module_redis_transaction_begin(
+        module_redis_connection_context_t *connection_context) {
+    connection_context->transaction.queueing = true;
+    connection_context->transaction.has_errors = false;
+    connection_context->transaction.database_number = connection_context->database_number;
+}
+
+void module_redis_transaction_discard(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_transaction_queued_commands_free(connection_context);
+
+    connection_context->transaction.queueing = false;
+    connection_context->transaction.has_errors = false;
+    connection_context->transaction.key_lock_indexes.count = 0;
+
+    module_redis_transaction_unwatch(connection_context);
+}
+
+static bool module_redis_transaction_watched_keys_changed(
+        module_redis_connection_context_t *connection_context,
+        transaction_t *transaction) {
+    for(uint32_t index = 0; index < connection_context->transaction.watched_keys.count; index++) {
+        module_redis_connection_transaction_watched_key_t *watched_key =
+                &connection_context->transaction.watched_keys.list[index];
+
+        storage_db_entry_index_version_t version = storage_db_get_entry_index_version(
+                connection_context->db,
+                watched_key->database_number,
+                transaction,
+                watched_key->key,
+                watched_key->key_length);
+
+        if (version != watched_key->version) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool module_redis_transaction_exec_queued_commands(
+        module_redis_connection_context_t *connection_context) {
+    bool return_res = true;
+    module_redis_command_info_t *command_info = connection_context->command.info;
+    module_redis_command_context_t *command_context = connection_context->command.context;
+    struct xalloc_arena *command_arena = connection_context->command.arena;
+    bool command_skip = connection_context->command.skip;
+
+    if (unlikely(!module_redis_connection_send_array(
+            connection_context,
+            connection_context->transaction.queued_commands.count))) {
+        return false;
+    }
+
+    connection_context->transaction.executing = true;
+
+    for(uint32_t index = 0; index < connection_context->transaction.queued_commands.count; index++) {
+        module_redis_connection_transaction_queued_command_t *queued_command =
+                &connection_context->transaction.queued_commands.list[index];
+
+        // If a reply can't be sent the connection is going to be closed, the remaining commands are only freed up
+        if (likely(return_res)) {
+            connection_context->command.info = queued_command->info;
+            connection_context->command.context = queued_command->context;
+            connection_context->command.arena = queued_command->arena;
+            connection_context->command.skip = false;
+
+            return_res = queued_command->info->command_end_funcptr(connection_context);
+
+            if (unlikely(module_redis_connection_has_error(connection_context))) {
+                return_res = module_redis_connection_send_error(connection_context) && return_res;
+            }
+
+            module_redis_command_process_try_free(connection_context);
+
+            connection_context->command.info = command_info;
+            connection_context->command.context = command_context;
+            connection_context->command.arena = command_arena;
+            connection_context->command.skip = command_skip;
+
+            xalloc_arena_free(queued_command->arena);
+        } else {
+            module_redis_transaction_queued_command_free(connection_context, queued_command);
+        }
+    }
+
+    connection_context->transaction.executing = false;
+    connection_context->transaction.queued_commands.count = 0;
+
+    return return_res;
+}
+
+bool module_redis_transaction_exec(
+        module_redis_connection_context_t *connection_context) {
+    bool return_res;
+    bool nested;
+    transaction_t transaction = { 0 };
+
+    if (unlikely(connection_context->transaction.has_errors)) {
+        module_redis_transaction_discard(connection_context);
+
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "EXECABORT Transaction discarded because of previous errors.");
+    }
+
+    connection_context->transaction.queueing = false;
+
+    // The chunks of the watched keys are locked as well so the versions can't change between the check and the
+    // execution of the queued commands
+    for(uint32_t index = 0; index < connection_context->transaction.watched_keys.count; index++) {
+        if (unlikely(!module_redis_transaction_list_ensure_space(
+                (void**)&connection_context->transaction.key_lock_indexes.list,
+                connection_context->transaction.key_lock_indexes.count,
+                &connection_context->transaction.key_lock_indexes.size,
+                sizeof(storage_db_key_lock_index_t)))) {
+            module_redis_transaction_discard(connection_context);
+            return false;
+        }
+
+        connection_context->transaction.key_lock_indexes.list[connection_context->transaction.key_lock_indexes.count] =
+                connection_context->transaction.watched_keys.list[index].key_lock_index;
+        connection_context->transaction.key_lock_indexes.count++;
+    }
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_lock_keys_for_write(
+            connection_context->db,
+            &transaction,
+            connection_context->transaction.key_lock_indexes.list,
+            connection_context->transaction.key_lock_indexes.count))) {
+        transaction_release(&transaction);
+        module_redis_transaction_discard(connection_context);
+
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR unable to lock the keys of the transaction");
+    }
+
+    if (module_redis_transaction_watched_keys_changed(connection_context, &transaction)) {
+        transaction_release(&transaction);
+        module_redis_transaction_discard(connection_context);
+
+        return module_redis_connection_send_array_null(connection_context);
+    }
+
+    // The transactions acquired by the queued commands are nested into this one so all the locks are held until the
+    // last command has been executed, if the code is not running in a fiber the commands will just lock on their own
+    nested = transaction_nesting_begin(&transaction);
+
+    return_res = module_redis_transaction_exec_queued_commands(connection_context);
+
+    if (likely(nested)) {
+        transaction_nesting_end(&transaction);
+    }
+
+    transaction_release(&transaction);
+    module_redis_transaction_discard(connection_context);
+
+    return return_res;
+}
+
+bool module_redis_transaction_watch_key(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length) {
+    module_redis_connection_transaction_watched_key_t *watched_key;
+    transaction_t transaction = { 0 };
+
+    // Watching the same key multiple times doesn't reset the version, as in Redis
+    for(uint32_t index = 0; index < connection_context->transaction.watched_keys.count; index++) {
+        watched_key = &connection_context->transaction.watched_keys.list[index];
+
+        if (watched_key->database_number == connection_context->database_number &&
+            watched_key->key_length == key_length &&
+            memcmp(watched_key->key, key, key_length) == 0) {
+            return true;
+        }
+    }
+
+    if (unlikely(!module_redis_transaction_list_ensure_space(
+            (void**)&connection_context->transaction.watched_keys.list,
+            connection_context->transaction.watched_keys.count,
+            &connection_context->transaction.watched_keys.size,
+            sizeof(module_redis_connection_transaction_watched_key_t)))) {
+        return false;
+    }
+
+    char *key_copy = xalloc_alloc(key_length);
+    if (unlikely(key_copy == NULL)) {
+        return false;
+    }
+    memcpy(key_copy, key, key_length);
+
+    watched_key = &connection_context->transaction.watched_keys.list[connection_context->transaction.watched_keys.count];
+    watched_key->database_number = connection_context->database_number;
+    watched_key->key = key_copy;
+    watched_key->key_length = key_length;
+    watched_key->key_lock_index = storage_db_get_key_lock_index(
+            connection_context->db,
+            connection_context->database_number,
+            key,
+            key_length);
+
+    transaction_acquire(&transaction);
+    watched_key->version = storage_db_get_entry_index_version(
+            connection_context->db,
+            connection_context->database_number,
+            &transaction,
+            key,
+            key_length);
+    transaction_release(&transaction);
+
+    connection_context->transaction.watched_keys.count++;
+
+    return true;
+}
+
+void module_redis_transaction_unwatch(
+        module_redis_connection_context_t *connection_context) {
+    for(uint32_t index = 0; index < connection_context->transaction.watched_keys.count; index++) {
+        xalloc_free(connection_context->transaction.watched_keys.list[index].key);
+    }
+
+    connection_context->transaction.watched_keys.count = 0;
+}
+
+void module_redis_transaction_cleanup(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_transaction_discard(connection_context);
+
+    if (connection_context->transaction.queued_commands.list) {
+        xalloc_free(connection_context->transaction.queued_commands.list);
+    }
+
+    if (connection_context->transaction.watched_keys.list) {
+        xalloc_free(connection_context->transaction.watched_keys.list);
+    }
+
+    if (connection_context->transaction.key_lock_indexes.list) {
+        xalloc_free(connection_context->transaction.key_lock_indexes.list);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef CACHEGRAND_MODULE_REDIS_TRANSACTION_H
+#define CACHEGRAND_MODULE_REDIS_TRANSACTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODULE_REDIS_TRANSACTION_LIST_INITIAL_SIZE (8)
+
+// The commands received after MULTI are parsed as usual but, instead of being executed, their context and the arena
+// they have been allocated from are moved into the queue of the connection, the chunks of the hashtable the keys
+// belong to are tracked while the arguments are parsed.
+// EXEC locks for write all the tracked chunks, together with the ones of the watched keys, in ascending order, so two
+// transactions can't deadlock, checks the versions of the watched keys and then replays the queued commands nesting
+// their transactions into the one of EXEC, so the locks are held until all the commands have been executed.
+// WATCH doesn't register the connection anywhere, it just copies the key and the version of its entry index, which is
+// stamped every time the key is changed, EXEC aborts if any of the versions doesn't match anymore.
+// The commands that would lock keys not known when they are queued, e.g. KEYS or SORT with BY/GET, are rejected and the
+// transaction is aborted, as they could only lock them on demand while EXEC already holds the sorted set of locks.
+
+bool module_redis_transaction_is_command_queueable(
+        module_redis_command_info_t *command_info);
+
+bool module_redis_transaction_is_command_allowed(
+        module_redis_command_info_t *command_info);
+
+bool module_redis_transaction_should_queue_command(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_transaction_track_key(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length);
+
+bool module_redis_transaction_queue_command(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_transaction_flag_error(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_transaction_begin(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_transaction_discard(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_transaction_exec(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_transaction_watch_key(
+        module_redis_connection_context_t *connection_context,
+        char *key,
+        size_t key_length);
+
+void module_redis_transaction_unwatch(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_transaction_cleanup(
+        module_redis_connection_context_t *connection_context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_TRANSACTION_H
@@ -63,7 +63,9 @@ typedef enum module_redis_snapshot_value_type module_redis_snapshot_value_type_t
 static const uint32_t module_snapshot_rdb_values_types[] = { MODULE_REDIS_SNAPSHOT_VALUES_TYPES };
 
 // List of supported value types in RDB snapshots
-#define MODULE_REDIS_SNAPSHOT_VALUES_TYPES_SUPPORTED MODULE_REDIS_SNAPSHOT_VALUE_TYPE_STRING
+#define MODULE_REDIS_SNAPSHOT_VALUES_TYPES_SUPPORTED MODULE_REDIS_SNAPSHOT_VALUE_TYPE_STRING, MODULE_REDIS_SNAPSHOT_VALUE_TYPE_LIST, \
+                                                     MODULE_REDIS_SNAPSHOT_VALUE_TYPE_SET, MODULE_REDIS_SNAPSHOT_VALUE_TYPE_HASH, \
+                                                     MODULE_REDIS_SNAPSHOT_VALUE_TYPE_ZSET_2
 
 #define MODULE_REDIS_SNAPSHOT_VALUES_TYPES_SUPPORTED_COUNT (sizeof(module_redis_snapshot_rdb_values_types_supported) / sizeof(uint32_t))
 
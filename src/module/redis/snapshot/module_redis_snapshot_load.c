@@ -14,6 +14,7 @@
 #include <string.h>
 #include <liblzf/lzf.h>
 #include <stdlib.h>
+#include <math.h>
 
 #include "exttypes.h"
 #include "misc.h"
@@ -29,6 +30,11 @@
 #include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
 #include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "data_structures/packed_list/packed_list.h"
+#include "data_structures/packed_set/packed_set.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
 #include "config.h"
 #include "module/module.h"
 #include "network/io/network_io_common.h"
@@ -50,6 +56,10 @@
 static off_t rdb_offset = 0;
 static uint64_t rdb_checksum = 0;
 static uint64_t counter_strings = 0;
+static uint64_t counter_lists = 0;
+static uint64_t counter_sets = 0;
+static uint64_t counter_hashes = 0;
+static uint64_t counter_sorted_sets = 0;
 static uint64_t counter_expires = 0;
 static uint64_t counter_expires_expired = 0;
 static uint64_t rdb_load_start;
@@ -325,10 +335,11 @@ bool module_redis_snapshot_load_write_key_value_string_chunk_sequence(
     return true;
 }
 
-bool module_redis_snapshot_load_write_key_value_string(
+bool module_redis_snapshot_load_write_key_value(
         storage_db_t *db,
         char* key,
         size_t key_length,
+        storage_db_entry_index_value_type_t value_type,
         char* value,
         size_t value_length,
         uint64_t expiry_ms) {
@@ -351,7 +362,7 @@ bool module_redis_snapshot_load_write_key_value_string(
             &transaction,
             key,
             key_length,
-            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+            value_type,
             &chunk_sequence,
             expiry_ms);
 
@@ -360,6 +371,23 @@ bool module_redis_snapshot_load_write_key_value_string(
     return result;
 }
 
+bool module_redis_snapshot_load_write_key_value_string(
+        storage_db_t *db,
+        char* key,
+        size_t key_length,
+        char* value,
+        size_t value_length,
+        uint64_t expiry_ms) {
+    return module_redis_snapshot_load_write_key_value(
+            db,
+            key,
+            key_length,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+            value,
+            value_length,
+            expiry_ms);
+}
+
 void module_redis_snapshot_load_process_value_string(
         storage_channel_t *channel,
         uint64_t expiry_ms) {
@@ -393,6 +421,306 @@ void module_redis_snapshot_load_process_value_string(
     }
 }
 
+void module_redis_snapshot_load_process_value_list(
+        storage_channel_t *channel,
+        uint64_t expiry_ms) {
+    bool set_failed = false;
+    size_t key_length = 0;
+    char *key, *buffer = NULL;
+    packed_list_builder_t builder;
+
+    key = module_redis_snapshot_load_read_string(channel, &key_length);
+    uint64_t elements_count = module_redis_snapshot_load_read_length_encoded_int(channel);
+
+    // The elements have to be kept around till the list is serialized as the builder only references them
+    char **strings = xalloc_alloc(sizeof(char*) * elements_count);
+    packed_list_builder_init(&builder, NULL);
+
+    for(uint64_t index = 0; index < elements_count; index++) {
+        size_t element_length = 0;
+        strings[index] = module_redis_snapshot_load_read_string(channel, &element_length);
+
+        packed_list_builder_push(&builder, false, strings[index], element_length);
+    }
+
+    counter_lists++;
+
+    if (likely((expiry_ms == 0 || expiry_ms > rdb_load_start) && packed_list_builder_count(&builder) > 0)) {
+        storage_db_t *db = worker_context_get()->db;
+
+        size_t buffer_length = packed_list_builder_serialized_length(&builder);
+        if (unlikely(buffer_length == 0)) {
+            set_failed = true;
+            goto end;
+        }
+
+        buffer = xalloc_alloc(buffer_length);
+        packed_list_builder_serialize(&builder, buffer, buffer_length);
+
+        if (!module_redis_snapshot_load_write_key_value(
+                db,
+                key,
+                key_length,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST,
+                buffer,
+                buffer_length,
+                expiry_ms)) {
+            set_failed = true;
+            goto end;
+        }
+    } else {
+        LOG_V(TAG, "> Skipping expired or empty list");
+        xalloc_free(key);
+    }
+
+    end:
+
+    packed_list_builder_free(&builder);
+
+    for(uint64_t index = 0; index < elements_count; index++) {
+        xalloc_free(strings[index]);
+    }
+    xalloc_free(strings);
+
+    if (buffer) {
+        xalloc_free(buffer);
+    }
+
+    if (set_failed) {
+        xalloc_free(key);
+        FATAL(TAG, "Unable to set key-list pair");
+    }
+}
+
+void module_redis_snapshot_load_process_value_set(
+        storage_channel_t *channel,
+        uint64_t expiry_ms) {
+    bool set_failed = false;
+    size_t key_length = 0;
+    char *key, *buffer = NULL;
+    packed_set_builder_t builder;
+
+    key = module_redis_snapshot_load_read_string(channel, &key_length);
+    uint64_t members_count = module_redis_snapshot_load_read_length_encoded_int(channel);
+
+    // The members have to be kept around till the set is serialized as the builder only references them
+    char **strings = xalloc_alloc(sizeof(char*) * members_count);
+    packed_set_builder_init(&builder, NULL);
+
+    for(uint64_t index = 0; index < members_count; index++) {
+        size_t member_length = 0;
+        strings[index] = module_redis_snapshot_load_read_string(channel, &member_length);
+
+        packed_set_builder_add(&builder, strings[index], member_length);
+    }
+
+    counter_sets++;
+
+    if (likely((expiry_ms == 0 || expiry_ms > rdb_load_start) && packed_set_builder_count(&builder) > 0)) {
+        storage_db_t *db = worker_context_get()->db;
+
+        size_t buffer_length = packed_set_builder_serialized_length(&builder);
+        if (unlikely(buffer_length == 0)) {
+            set_failed = true;
+            goto end;
+        }
+
+        buffer = xalloc_alloc(buffer_length);
+        packed_set_builder_serialize(&builder, buffer, buffer_length);
+
+        if (!module_redis_snapshot_load_write_key_value(
+                db,
+                key,
+                key_length,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET,
+                buffer,
+                buffer_length,
+                expiry_ms)) {
+            set_failed = true;
+            goto end;
+        }
+    } else {
+        LOG_V(TAG, "> Skipping expired or empty set");
+        xalloc_free(key);
+    }
+
+    end:
+
+    packed_set_builder_free(&builder);
+
+    for(uint64_t index = 0; index < members_count; index++) {
+        xalloc_free(strings[index]);
+    }
+    xalloc_free(strings);
+
+    if (buffer) {
+        xalloc_free(buffer);
+    }
+
+    if (set_failed) {
+        xalloc_free(key);
+        FATAL(TAG, "Unable to set key-set pair");
+    }
+}
+
+void module_redis_snapshot_load_process_value_hash(
+        storage_channel_t *channel,
+        uint64_t expiry_ms) {
+    bool set_failed = false;
+    size_t key_length = 0;
+    char *key, *buffer = NULL;
+    packed_hash_builder_t builder;
+
+    key = module_redis_snapshot_load_read_string(channel, &key_length);
+    uint64_t fields_count = module_redis_snapshot_load_read_length_encoded_int(channel);
+
+    // The fields and the values have to be kept around till the hash is serialized as the builder only references them
+    char **strings = xalloc_alloc(sizeof(char*) * fields_count * 2);
+    packed_hash_builder_init(&builder, NULL);
+
+    for(uint64_t index = 0; index < fields_count; index++) {
+        size_t field_length = 0, value_length = 0;
+        strings[index * 2] = module_redis_snapshot_load_read_string(channel, &field_length);
+        strings[(index * 2) + 1] = module_redis_snapshot_load_read_string(channel, &value_length);
+
+        packed_hash_builder_set(
+                &builder,
+                strings[index * 2],
+                field_length,
+                strings[(index * 2) + 1],
+                value_length);
+    }
+
+    counter_hashes++;
+
+    if (likely((expiry_ms == 0 || expiry_ms > rdb_load_start) && packed_hash_builder_count(&builder) > 0)) {
+        storage_db_t *db = worker_context_get()->db;
+
+        size_t buffer_length = packed_hash_builder_serialized_length(&builder);
+        if (unlikely(buffer_length == 0)) {
+            set_failed = true;
+            goto end;
+        }
+
+        buffer = xalloc_alloc(buffer_length);
+        packed_hash_builder_serialize(&builder, buffer, buffer_length);
+
+        if (!module_redis_snapshot_load_write_key_value(
+                db,
+                key,
+                key_length,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET,
+                buffer,
+                buffer_length,
+                expiry_ms)) {
+            set_failed = true;
+            goto end;
+        }
+    } else {
+        LOG_V(TAG, "> Skipping expired or empty hash");
+        xalloc_free(key);
+    }
+
+    end:
+
+    packed_hash_builder_free(&builder);
+
+    for(uint64_t index = 0; index < fields_count * 2; index++) {
+        xalloc_free(strings[index]);
+    }
+    xalloc_free(strings);
+
+    if (buffer) {
+        xalloc_free(buffer);
+    }
+
+    if (set_failed) {
+        xalloc_free(key);
+        FATAL(TAG, "Unable to set key-hash pair");
+    }
+}
+
+void module_redis_snapshot_load_process_value_sorted_set(
+        storage_channel_t *channel,
+        uint64_t expiry_ms) {
+    bool set_failed = false;
+    size_t key_length = 0;
+    char *key;
+    sorted_set_t *sorted_set = sorted_set_new();
+
+    key = module_redis_snapshot_load_read_string(channel, &key_length);
+    uint64_t members_count = module_redis_snapshot_load_read_length_encoded_int(channel);
+
+    for(uint64_t index = 0; index < members_count; index++) {
+        size_t member_length = 0;
+        double score = 0;
+        char *member = module_redis_snapshot_load_read_string(channel, &member_length);
+
+        // The ZSET_2 encoding stores the score as a binary little endian double, Redis saves the members starting from
+        // the highest score so they are inserted and not appended
+        module_redis_snapshot_load_read(channel, (char *) &score, sizeof(score));
+
+        if (unlikely(isnan(score))) {
+            xalloc_free(member);
+            set_failed = true;
+            goto end;
+        }
+
+        sorted_set_node_t *node = sorted_set_get(sorted_set, member, member_length);
+        if (unlikely(node)) {
+            sorted_set_update_score(sorted_set, node, score);
+        } else {
+            sorted_set_insert(sorted_set, member, member_length, score);
+        }
+
+        xalloc_free(member);
+    }
+
+    counter_sorted_sets++;
+
+    if (likely((expiry_ms == 0 || expiry_ms > rdb_load_start) && sorted_set->count > 0)) {
+        storage_db_t *db = worker_context_get()->db;
+
+        // The sorted set is stored as it is, the entry index takes the ownership
+        transaction_t transaction = { 0 };
+        transaction_acquire(&transaction);
+
+        bool result = storage_db_op_set_value_object(
+                db,
+                current_database_number,
+                &transaction,
+                key,
+                key_length,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET,
+                sorted_set,
+                sorted_set_size(sorted_set),
+                expiry_ms);
+
+        transaction_release(&transaction);
+
+        if (!result) {
+            set_failed = true;
+            goto end;
+        }
+
+        sorted_set = NULL;
+    } else {
+        LOG_V(TAG, "> Skipping expired or empty sorted set");
+        xalloc_free(key);
+    }
+
+    end:
+
+    if (sorted_set) {
+        sorted_set_free(sorted_set);
+    }
+
+    if (set_failed) {
+        xalloc_free(key);
+        FATAL(TAG, "Unable to set key-sorted set pair");
+    }
+}
+
 void module_redis_snapshot_load_data(
         storage_channel_t *channel) {
     uint8_t opcode = 0;
@@ -432,6 +760,22 @@ void module_redis_snapshot_load_data(
                 module_redis_snapshot_load_process_value_string(channel, expiry_ms);
                 break;
 
+            case MODULE_REDIS_SNAPSHOT_VALUE_TYPE_LIST:
+                module_redis_snapshot_load_process_value_list(channel, expiry_ms);
+                break;
+
+            case MODULE_REDIS_SNAPSHOT_VALUE_TYPE_SET:
+                module_redis_snapshot_load_process_value_set(channel, expiry_ms);
+                break;
+
+            case MODULE_REDIS_SNAPSHOT_VALUE_TYPE_HASH:
+                module_redis_snapshot_load_process_value_hash(channel, expiry_ms);
+                break;
+
+            case MODULE_REDIS_SNAPSHOT_VALUE_TYPE_ZSET_2:
+                module_redis_snapshot_load_process_value_sorted_set(channel, expiry_ms);
+                break;
+
             default:
                 FATAL(TAG, "Unknown opcode or value type <0x%X> at offset <%lu>", opcode, rdb_offset - 1);
         }
@@ -483,6 +827,10 @@ bool module_redis_snapshot_load(
     rdb_load_start = clock_realtime_int64_ms();
     rdb_checksum = 0;
     counter_strings = 0;
+    counter_lists = 0;
+    counter_sets = 0;
+    counter_hashes = 0;
+    counter_sorted_sets = 0;
     counter_expires = 0;
     counter_expires_expired = 0;
 
@@ -498,6 +846,10 @@ bool module_redis_snapshot_load(
     LOG_I(TAG, "Snapshot loaded");
     LOG_I(TAG, "Found:");
     LOG_I(TAG, "> %lu string(s)", counter_strings);
+    LOG_I(TAG, "> %lu list(s)", counter_lists);
+    LOG_I(TAG, "> %lu set(s)", counter_sets);
+    LOG_I(TAG, "> %lu hash(es)", counter_hashes);
+    LOG_I(TAG, "> %lu sorted set(s)", counter_sorted_sets);
     LOG_I(TAG, "> %lu value(s) with expirations", counter_expires - counter_expires_expired);
     LOG_I(TAG, "> %lu value(s) expired", counter_expires_expired);
 
@@ -48,6 +48,15 @@ bool module_redis_snapshot_load_write_key_value_string_chunk_sequence(
         size_t string_length,
         storage_db_chunk_sequence_t *chunk_sequence);
 
+bool module_redis_snapshot_load_write_key_value(
+        storage_db_t *db,
+        char* key,
+        size_t key_length,
+        storage_db_entry_index_value_type_t value_type,
+        char* value,
+        size_t value_length,
+        uint64_t expiry_ms);
+
 bool module_redis_snapshot_load_write_key_value_string(
         storage_db_t *db,
         char* key,
@@ -60,6 +69,22 @@ void module_redis_snapshot_load_process_value_string(
         storage_channel_t *channel,
         uint64_t expiry_ms);
 
+void module_redis_snapshot_load_process_value_list(
+        storage_channel_t *channel,
+        uint64_t expiry_ms);
+
+void module_redis_snapshot_load_process_value_set(
+        storage_channel_t *channel,
+        uint64_t expiry_ms);
+
+void module_redis_snapshot_load_process_value_hash(
+        storage_channel_t *channel,
+        uint64_t expiry_ms);
+
+void module_redis_snapshot_load_process_value_sorted_set(
+        storage_channel_t *channel,
+        uint64_t expiry_ms);
+
 void module_redis_snapshot_load_data(
         storage_channel_t *channel);
 
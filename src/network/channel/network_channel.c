@@ -10,7 +10,9 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <unistd.h>
 #include <arpa/inet.h>
+#include <sys/un.h>
 #include <assert.h>
 
 #include "exttypes.h"
@@ -29,9 +31,23 @@
 #include "data_structures/queue_mpmc/queue_mpmc.h"
 
 #include "network/channel/network_channel.h"
+#include "network/network.h"
 
 #define TAG "network_channel"
 
+// UNIX sockets don't support SO_REUSEPORT so the listener is created only once, by the first worker, and then shared
+// with the other workers, each one gets its own fd via dup to be able to register and close it independently
+typedef struct network_channel_listener_unix_shared network_channel_listener_unix_shared_t;
+struct network_channel_listener_unix_shared {
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    int fd;
+};
+
+static spinlock_lock_t network_channel_listener_unix_shared_lock = { 0 };
+static network_channel_listener_unix_shared_t
+        network_channel_listener_unix_shared[NETWORK_CHANNEL_LISTENER_UNIX_SHARED_MAX] = { 0 };
+static uint8_t network_channel_listener_unix_shared_count = 0;
+
 bool network_channel_client_setup(
         network_io_common_fd_t fd,
         uint32_t incoming_cpu) {
@@ -89,10 +105,12 @@ bool network_channel_init(
     channel->timeout.write.nsec = -1;
     channel->buffers.send.length = 0;
     channel->buffers.send.data = NULL;
+    channel->buffers.send.small_flushes_count = 0;
 
+    // The send buffer is allocated when the first reply is written, see network_send_buffer_ensure_free_space
     if (channel->type == NETWORK_CHANNEL_TYPE_CLIENT) {
-        channel->buffers.send.length = NETWORK_CHANNEL_SEND_BUFFER_SIZE;
-        channel->buffers.send.data = xalloc_alloc(channel->buffers.send.length);
+        channel->buffers.send.length_max = NETWORK_CHANNEL_SEND_BUFFER_SIZE;
+        channel->buffers.send.packet_length_hint = NETWORK_CHANNEL_BUFFER_LENGTH_MIN;
     }
 
     return true;
@@ -101,11 +119,49 @@ bool network_channel_init(
 void network_channel_cleanup(
         network_channel_t *channel) {
     if (channel->type == NETWORK_CHANNEL_TYPE_CLIENT) {
-        xalloc_free(channel->buffers.send.data);
-        channel->buffers.send.data = NULL;
+        network_buffer_free(&channel->buffers.send);
     }
 }
 
+static void network_channel_listener_new_setup(
+        network_channel_listener_new_callback_user_data_t *cb_user_data,
+        int fd,
+        struct sockaddr *socket_address,
+        socklen_t socket_address_size,
+        module_id_t module_id) {
+    network_channel_t* listener;
+
+    // TODO: all the networking is implemented in the worker but it's non sense and should be moved to the networking,
+    //       because of this nonsense it's not possible use worker_op_network_channel_multi_get here to get the
+    //       network_channel and the math is required. Has to be changed once the code is refactored.
+    // The size of the struct is dependant on the network backend, listeners can't be accessed as a plain array as the
+    // backend may have encapsulated the generic network_channel structure into its own structure and therefore
+    // accessing the elements past 0 would actually ending up overriding the network backend own data.
+    // The network_channel_size comes into help as the network backend can set it to the appropriate value to let the
+    // code properly handle the encapsulation as needed.
+    listener =
+            ((void*)cb_user_data->listeners) +
+            (cb_user_data->network_channel_size * cb_user_data->listeners_count);
+    listener->fd = fd;
+    listener->address.size = socket_address_size;
+    listener->module_id = module_id;
+    listener->type = NETWORK_CHANNEL_TYPE_LISTENER;
+
+    memcpy(
+            &listener->address.socket.base,
+            socket_address,
+            socket_address_size);
+
+    network_io_common_socket_address_str(
+            socket_address,
+            listener->address.str,
+            sizeof(listener->address.str));
+
+    LOG_V(TAG, "Created listener on <%s> for <%s>", listener->address.str, module_get_by_id(module_id)->name);
+
+    cb_user_data->listeners_count++;
+}
+
 bool network_channel_listener_new_callback(
         int family,
         struct sockaddr *socket_address,
@@ -115,7 +171,6 @@ bool network_channel_listener_new_callback(
         module_id_t module_id,
         void* user_data) {
     int fd;
-    network_channel_t* listener;
     network_channel_listener_new_callback_user_data_t *cb_user_data = user_data;
 
     // If listeners is set to null the callback will do nothing, this process is used only to
@@ -143,35 +198,12 @@ bool network_channel_listener_new_callback(
         return false;
     }
 
-    // TODO: all the networking is implemented in the worker but it's non sense and should be moved to the networking,
-    //       because of this nonsense it's not possible use worker_op_network_channel_multi_get here to get the
-    //       network_channel and the math is required. Has to be changed once the code is refactored.
-    // The size of the struct is dependant on the network backend, listeners can't be accessed as a plain array as the
-    // backend may have encapsulated the generic network_channel structure into its own structure and therefore
-    // accessing the elements past 0 would actually ending up overriding the network backend own data.
-    // The network_channel_size comes into help as the network backend can set it to the appropriate value to let the
-    // code properly handle the encapsulation as needed.
-    listener =
-            ((void*)cb_user_data->listeners) +
-            (cb_user_data->network_channel_size * cb_user_data->listeners_count);
-    listener->fd = fd;
-    listener->address.size = socket_address_size;
-    listener->module_id = module_id;
-    listener->type = NETWORK_CHANNEL_TYPE_LISTENER;
-
-    memcpy(
-            &listener->address.socket.base,
-            socket_address,
-            socket_address_size);
-
-    network_io_common_socket_address_str(
+    network_channel_listener_new_setup(
+            cb_user_data,
+            fd,
             socket_address,
-            listener->address.str,
-            sizeof(listener->address.str));
-
-    LOG_V(TAG, "Created listener on <%s> for <%s>", listener->address.str, module_get_by_id(module_id)->name);
-
-    cb_user_data->listeners_count++;
+            socket_address_size,
+            module_id);
 
     return true;
 }
@@ -198,3 +230,113 @@ bool network_channel_listener_new(
 
     return true;
 }
+
+static int network_channel_listener_new_unix_shared_fd(
+        char *path,
+        uint32_t permissions,
+        uint16_t backlog) {
+    int fd = -1;
+
+    spinlock_lock(&network_channel_listener_unix_shared_lock);
+
+    for(uint8_t index = 0; index < network_channel_listener_unix_shared_count; index++) {
+        if (strcmp(network_channel_listener_unix_shared[index].path, path) == 0) {
+            if ((fd = dup(network_channel_listener_unix_shared[index].fd)) < 0) {
+                LOG_E(TAG, "Unable to duplicate the fd of the UNIX socket listener <%s>", path);
+                LOG_E_OS_ERROR(TAG);
+            }
+
+            goto end;
+        }
+    }
+
+    if (network_channel_listener_unix_shared_count == NETWORK_CHANNEL_LISTENER_UNIX_SHARED_MAX) {
+        LOG_E(TAG, "Too many UNIX socket listeners, the maximum is <%d>", NETWORK_CHANNEL_LISTENER_UNIX_SHARED_MAX);
+        goto end;
+    }
+
+    int shared_fd = network_io_common_socket_unix_new_server(0, path, permissions, backlog);
+    if (shared_fd == -1) {
+        goto end;
+    }
+
+    if ((fd = dup(shared_fd)) < 0) {
+        LOG_E(TAG, "Unable to duplicate the fd of the UNIX socket listener <%s>", path);
+        LOG_E_OS_ERROR(TAG);
+
+        network_io_common_socket_close(shared_fd, false);
+        unlink(path);
+        goto end;
+    }
+
+    network_channel_listener_unix_shared_t *shared =
+            &network_channel_listener_unix_shared[network_channel_listener_unix_shared_count];
+    strncpy(shared->path, path, sizeof(shared->path) - 1);
+    shared->fd = shared_fd;
+    network_channel_listener_unix_shared_count++;
+
+end:
+    spinlock_unlock(&network_channel_listener_unix_shared_lock);
+
+    return fd;
+}
+
+void network_channel_listener_unix_shared_cleanup() {
+    spinlock_lock(&network_channel_listener_unix_shared_lock);
+
+    // The workers close their own fds, only the original fd is left open and the socket file has to be removed as the
+    // path can't be bound again otherwise
+    for(uint8_t index = 0; index < network_channel_listener_unix_shared_count; index++) {
+        network_channel_listener_unix_shared_t *shared = &network_channel_listener_unix_shared[index];
+
+        network_io_common_socket_close(shared->fd, false);
+        unlink(shared->path);
+
+        shared->fd = -1;
+        shared->path[0] = 0;
+    }
+
+    network_channel_listener_unix_shared_count = 0;
+
+    spinlock_unlock(&network_channel_listener_unix_shared_lock);
+}
+
+bool network_channel_listener_new_unix(
+        char* path,
+        uint32_t permissions,
+        uint16_t backlog,
+        module_id_t module_id,
+        network_channel_listener_new_callback_user_data_t *user_data) {
+    int fd;
+    struct sockaddr_un socket_address = { 0 };
+
+    if (user_data->listeners == NULL) {
+        user_data->listeners_count++;
+        return true;
+    }
+
+    if (user_data->network_channel_size == 0) {
+        return false;
+    }
+
+    if (strlen(path) >= sizeof(socket_address.sun_path)) {
+        LOG_E(TAG, "The UNIX socket path <%s> is too long", path);
+        return false;
+    }
+
+    socket_address.sun_family = AF_UNIX;
+    strncpy(socket_address.sun_path, path, sizeof(socket_address.sun_path) - 1);
+
+    if ((fd = network_channel_listener_new_unix_shared_fd(path, permissions, backlog)) < 0) {
+        return false;
+    }
+
+    network_channel_listener_new_setup(
+            user_data,
+            fd,
+            (struct sockaddr*)&socket_address,
+            sizeof(socket_address),
+            module_id);
+
+    return true;
+}
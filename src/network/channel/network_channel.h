@@ -8,6 +8,10 @@ extern "C" {
 #define NETWORK_CHANNEL_MAX_PACKET_SIZE     (32 * 1024)
 #define NETWORK_CHANNEL_RECV_BUFFER_SIZE    (NETWORK_CHANNEL_MAX_PACKET_SIZE * 2)
 #define NETWORK_CHANNEL_SEND_BUFFER_SIZE    (NETWORK_CHANNEL_MAX_PACKET_SIZE * 2)
+#define NETWORK_CHANNEL_BUFFER_LENGTH_MIN   (4 * 1024)
+#define NETWORK_CHANNEL_BUFFERS_IDLE_TIMEOUT_MS (1000)
+#define NETWORK_CHANNEL_SEND_BUFFER_SHRINK_SMALL_FLUSHES (32)
+#define NETWORK_CHANNEL_LISTENER_UNIX_SHARED_MAX (16)
 
 typedef char network_channel_buffer_data_t;
 
@@ -20,7 +24,8 @@ typedef enum network_channel_type network_channel_type_t;
 enum network_channel_status {
     NETWORK_CHANNEL_STATUS_UNDEFINED,
     NETWORK_CHANNEL_STATUS_CONNECTED,
-    NETWORK_CHANNEL_STATUS_CLOSED
+    NETWORK_CHANNEL_STATUS_CLOSED,
+    NETWORK_CHANNEL_STATUS_MIGRATED,
 };
 typedef enum network_channel_status network_channel_status_t;
 
@@ -37,17 +42,24 @@ struct network_channel_socket_address {
         struct sockaddr base;
         struct sockaddr_in ipv4;
         struct sockaddr_in6 ipv6;
+        struct sockaddr_storage storage;
     } socket;
     char str[INET6_ADDRSTRLEN + 1 + 5 + 1]; // ipv6 + : + port number + null
     socklen_t size;
 };
 
 typedef struct network_channel_buffer network_channel_buffer_t;
+// The buffers are allocated only when needed, they start small and grow up to length_max, packet_length_hint tracks
+// the size of the packets received to decide how much free space should be available before the next receive
 struct network_channel_buffer {
     network_channel_buffer_data_t *data;
     size_t data_offset;
     size_t data_size;
     size_t length;
+    size_t length_max;
+    size_t packet_length_hint;
+    // Used only by the send buffer, the amount of consecutive flushes much smaller than the buffer
+    uint32_t small_flushes_count;
 };
 
 typedef struct network_channel network_channel_t;
@@ -64,6 +76,10 @@ struct network_channel {
         size_t send_slice_acquired_length;
 #endif
     } buffers;
+    struct {
+        size_t size;
+        int64_t soft_limit_reached_at_ms;
+    } output_buffer;
     struct {
         bool enabled;
         bool handshake_completed;
@@ -123,6 +139,15 @@ bool network_channel_listener_new(
         module_id_t module_type,
         network_channel_listener_new_callback_user_data_t *user_data);
 
+void network_channel_listener_unix_shared_cleanup();
+
+bool network_channel_listener_new_unix(
+        char* path,
+        uint32_t permissions,
+        uint16_t backlog,
+        module_id_t module_id,
+        network_channel_listener_new_callback_user_data_t *user_data);
+
 #ifdef __cplusplus
 }
 #endif
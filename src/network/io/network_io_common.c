@@ -14,7 +14,11 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
 #include <linux/filter.h>
+#include <linux/sockios.h>
 
 #include "misc.h"
 #include "log/log.h"
@@ -146,6 +150,12 @@ bool network_io_common_socket_set_incoming_cpu(
     return network_io_common_socket_set_option(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu));
 }
 
+bool network_io_common_socket_set_busy_poll(
+        network_io_common_fd_t fd,
+        int busy_poll_us) {
+    return network_io_common_socket_set_option(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof(busy_poll_us));
+}
+
 bool network_io_common_socket_set_receive_buffer(
         network_io_common_fd_t fd,
         int size) {
@@ -158,6 +168,18 @@ bool network_io_common_socket_set_send_buffer(
     return network_io_common_socket_set_option(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
 }
 
+int32_t network_io_common_socket_get_send_queue_size(
+        network_io_common_fd_t fd) {
+    int size = 0;
+
+    // Amount of data written to the socket not yet sent (and acknowledged by the peer for TCP) by the kernel
+    if (ioctl(fd, SIOCOUTQ, &size) < 0) {
+        return -1;
+    }
+
+    return size;
+}
+
 bool network_io_common_socket_set_receive_timeout(
         network_io_common_fd_t fd,
         long seconds,
@@ -349,6 +371,70 @@ int network_io_common_socket_tcp6_new_server(
     return fd;
 }
 
+int network_io_common_socket_unix_new(
+        int flags) {
+    network_io_common_fd_t fd;
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM | flags, 0)) < 0) {
+        LOG_E(TAG, "Unable to create a new UNIX socket");
+        LOG_E_OS_ERROR(TAG);
+    }
+
+    return fd;
+}
+
+int network_io_common_socket_unix_new_server(
+        int flags,
+        char *path,
+        uint32_t permissions,
+        uint16_t backlog) {
+    network_io_common_fd_t fd;
+    struct stat path_stat;
+    struct sockaddr_un address = { 0 };
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        LOG_E(TAG, "The UNIX socket path <%s> is too long", path);
+        return -1;
+    }
+
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+    if ((fd = network_io_common_socket_unix_new(flags)) < 0) {
+        return -1;
+    }
+
+    // A socket left behind by a previous instance would make the bind fail, any other kind of file is left untouched
+    if (lstat(path, &path_stat) == 0 && S_ISSOCK(path_stat.st_mode)) {
+        unlink(path);
+    }
+
+    if (!network_io_common_socket_bind(
+            fd,
+            (struct sockaddr *)&address,
+            sizeof(address))) {
+        network_io_common_socket_close(fd, true);
+        return -1;
+    }
+
+    // The permissions have to be set before starting to listen to avoid accepting clients that shouldn't have access
+    if (permissions != 0 && chmod(path, (mode_t)permissions) < 0) {
+        LOG_E(TAG, "Unable to set the permissions <%o> on the UNIX socket <%s>", permissions, path);
+        LOG_E_OS_ERROR(TAG);
+        network_io_common_socket_close(fd, true);
+        return -1;
+    }
+
+    if (!network_io_common_socket_listen(
+            fd,
+            backlog)) {
+        network_io_common_socket_close(fd, true);
+        return -1;
+    }
+
+    return fd;
+}
+
 int network_io_common_socket_new_server(
         int family,
         int flags,
@@ -456,6 +542,18 @@ char* network_io_common_socket_address_str(
         struct sockaddr_in6 *address_ipv6 = (struct sockaddr_in6 *)address;
         inet_ntop(AF_INET6, &address_ipv6->sin6_addr, buffer, INET6_ADDRSTRLEN);
         port = address_ipv6->sin6_port;
+    } else if (address->sa_family == AF_UNIX) {
+        // The peers connecting via UNIX sockets are usually unnamed, the path is reported only if available and it
+        // gets truncated if it doesn't fit in the buffer
+        struct sockaddr_un *address_unix = (struct sockaddr_un *)address;
+        snprintf(
+                buffer,
+                buffer_len,
+                "unix:%.*s",
+                (int)strnlen(address_unix->sun_path, sizeof(address_unix->sun_path)),
+                address_unix->sun_path);
+
+        return buffer;
     } else {
         return NULL;
     }
@@ -79,6 +79,10 @@ bool network_io_common_socket_set_incoming_cpu(
         network_io_common_fd_t fd,
         int cpu);
 
+bool network_io_common_socket_set_busy_poll(
+        network_io_common_fd_t fd,
+        int busy_poll_us);
+
 bool network_io_common_socket_set_receive_buffer(
         network_io_common_fd_t fd,
         int size);
@@ -87,6 +91,9 @@ bool network_io_common_socket_set_send_buffer(
         network_io_common_fd_t fd,
         int size);
 
+int32_t network_io_common_socket_get_send_queue_size(
+        network_io_common_fd_t fd);
+
 bool network_io_common_socket_set_receive_timeout(
         network_io_common_fd_t fd,
         long seconds,
@@ -142,6 +149,15 @@ int network_io_common_socket_tcp6_new_server(
         network_io_common_socket_setup_server_cb_t socket_setup_server_cb,
         void *user_data);
 
+int network_io_common_socket_unix_new(
+        int flags);
+
+int network_io_common_socket_unix_new_server(
+        int flags,
+        char *path,
+        uint32_t permissions,
+        uint16_t backlog);
+
 int network_io_common_socket_new_server(
         int family,
         int flags,
@@ -20,6 +20,8 @@
 #include "misc.h"
 #include "exttypes.h"
 #include "clock.h"
+#include "pow2.h"
+#include "xalloc.h"
 #include "spinlock.h"
 #include "transaction.h"
 #include "log/log.h"
@@ -53,12 +55,89 @@
 
 #define TAG "network"
 
+static void network_buffer_update_stats(
+        int64_t length_delta) {
+    worker_context_t *worker_context = worker_context_get();
+
+    // The buffers can also be used outside of the workers, e.g. by the tests
+    if (likely(worker_context != NULL)) {
+        worker_context->stats.internal.network.buffers_size += length_delta;
+    }
+}
+
+static size_t network_buffer_length_for(
+        network_channel_buffer_t *network_channel_buffer,
+        size_t length_needed) {
+    size_t length = pow2_next(length_needed);
+
+    if (length < NETWORK_CHANNEL_BUFFER_LENGTH_MIN) {
+        length = NETWORK_CHANNEL_BUFFER_LENGTH_MIN;
+    }
+
+    if (length > network_channel_buffer->length_max) {
+        length = network_channel_buffer->length_max;
+    }
+
+    return length;
+}
+
+static void network_buffer_resize(
+        network_channel_buffer_t *network_channel_buffer,
+        size_t length) {
+    network_buffer_update_stats((int64_t)length - (int64_t)network_channel_buffer->length);
+
+    network_channel_buffer->data = xalloc_realloc(network_channel_buffer->data, length);
+    network_channel_buffer->length = length;
+}
+
+void network_buffer_init(
+        network_channel_buffer_t *network_channel_buffer,
+        size_t length_max) {
+    network_channel_buffer->data = NULL;
+    network_channel_buffer->data_offset = 0;
+    network_channel_buffer->data_size = 0;
+    network_channel_buffer->length = 0;
+    network_channel_buffer->length_max = length_max;
+    network_channel_buffer->packet_length_hint = MIN(NETWORK_CHANNEL_BUFFER_LENGTH_MIN, length_max);
+    network_channel_buffer->small_flushes_count = 0;
+}
+
+void network_buffer_free(
+        network_channel_buffer_t *network_channel_buffer) {
+    if (network_channel_buffer->data == NULL) {
+        return;
+    }
+
+    network_buffer_update_stats(-(int64_t)network_channel_buffer->length);
+
+    xalloc_free(network_channel_buffer->data);
+    network_channel_buffer->data = NULL;
+    network_channel_buffer->data_offset = 0;
+    network_channel_buffer->data_size = 0;
+    network_channel_buffer->length = 0;
+    network_channel_buffer->small_flushes_count = 0;
+}
+
+bool network_buffer_release_if_empty(
+        network_channel_buffer_t *network_channel_buffer) {
+    if (network_channel_buffer->data_size > 0) {
+        return false;
+    }
+
+    network_buffer_free(network_channel_buffer);
+    network_channel_buffer->packet_length_hint =
+            MIN(NETWORK_CHANNEL_BUFFER_LENGTH_MIN, network_channel_buffer->length_max);
+
+    return true;
+}
+
 bool network_buffer_has_enough_space(
         network_channel_buffer_t *network_channel_buffer,
         size_t read_length) {
     size_t network_channel_buffer_needed_size_min = network_channel_buffer->data_size + read_length;
 
-    return network_channel_buffer->length >= network_channel_buffer_needed_size_min;
+    // The buffer grows on demand, the check is carried out against the maximum length it can reach
+    return network_channel_buffer->length_max >= network_channel_buffer_needed_size_min;
 }
 
 bool network_buffer_needs_rewind(
@@ -73,30 +152,166 @@ bool network_buffer_needs_rewind(
 
 void network_buffer_rewind(
         network_channel_buffer_t *network_channel_buffer) {
-    memcpy(
-            network_channel_buffer->data,
-            network_channel_buffer->data +
-            network_channel_buffer->data_offset,
-            network_channel_buffer->data_size);
+    if (likely(network_channel_buffer->data_size > 0)) {
+        memmove(
+                network_channel_buffer->data,
+                network_channel_buffer->data +
+                network_channel_buffer->data_offset,
+                network_channel_buffer->data_size);
+    }
     network_channel_buffer->data_offset = 0;
 }
 
+bool network_buffer_ensure_free_space(
+        network_channel_buffer_t *network_channel_buffer,
+        size_t free_space) {
+    size_t data_end = network_channel_buffer->data_offset + network_channel_buffer->data_size;
+
+    if (likely(network_channel_buffer->length - data_end >= free_space)) {
+        return true;
+    }
+
+    if (unlikely(network_channel_buffer->data_size + free_space > network_channel_buffer->length_max)) {
+        return false;
+    }
+
+    // Try first to make room moving the data at the beginning of the buffer, if it's not enough the buffer is grown
+    if (network_channel_buffer->data_offset > 0) {
+        network_buffer_rewind(network_channel_buffer);
+
+        if (network_channel_buffer->length - network_channel_buffer->data_size >= free_space) {
+            return true;
+        }
+    }
+
+    network_buffer_resize(
+            network_channel_buffer,
+            network_buffer_length_for(
+                    network_channel_buffer,
+                    network_channel_buffer->data_size + free_space));
+
+    return true;
+}
+
+static void network_buffer_update_packet_length_hint(
+        network_channel_buffer_t *network_channel_buffer,
+        size_t free_space,
+        size_t received_length,
+        size_t receive_length_max) {
+    size_t packet_length_hint = network_channel_buffer->packet_length_hint;
+
+    // If the received data filled up all the free space there is probably more data pending, more space is made
+    // available for the next receive, if instead the received data are way smaller than expected the hint is lowered
+    if (received_length >= free_space) {
+        packet_length_hint = MIN(packet_length_hint * 2, receive_length_max);
+    } else if (received_length < packet_length_hint / 4) {
+        packet_length_hint = MAX(packet_length_hint / 2, NETWORK_CHANNEL_BUFFER_LENGTH_MIN);
+    }
+
+    network_channel_buffer->packet_length_hint = packet_length_hint;
+}
+
+static bool network_receive_can_wait_idle(
+        network_channel_t *channel,
+        network_channel_buffer_t *buffer) {
+    // The buffers can be released only if there is no data pending, mbedtls keeps its own buffers and might already
+    // have data available to be read therefore it can't be used with mbedtls
+    if (buffer->data_size > 0 || network_channel_tls_uses_mbedtls(channel)) {
+        return false;
+    }
+
+    // If the read timeout is shorter than the idle timeout there is no reason to wait
+    return channel->timeout.read.nsec == -1 ||
+           (channel->timeout.read.sec * 1000) + (channel->timeout.read.nsec / 1000000) >
+                NETWORK_CHANNEL_BUFFERS_IDLE_TIMEOUT_MS;
+}
+
+static network_op_result_t network_receive_internal_result(
+        network_channel_t *channel,
+        int32_t res,
+        size_t *received_length) {
+    if (unlikely(res == 0)) {
+        LOG_D(
+                TAG,
+                "[FD:%5d][RECV] The client <%s> closed the connection",
+                channel->fd,
+                channel->address.str);
+
+        return NETWORK_OP_RESULT_CLOSE_SOCKET;
+    } else if (unlikely(res == -ECANCELED)) {
+        LOG_I(
+                TAG,
+                "[FD:%5d][ERROR CLIENT] Receive timeout from client <%s>",
+                channel->fd,
+                channel->address.str);
+        return NETWORK_OP_RESULT_ERROR;
+    } else if (unlikely(res < 0)) {
+        int error_number = -res;
+        LOG_I(
+                TAG,
+                "[FD:%5d][ERROR CLIENT] Error <%s (%d)> from client <%s>",
+                channel->fd,
+                strerror(error_number),
+                error_number,
+                channel->address.str);
+
+        return NETWORK_OP_RESULT_ERROR;
+    }
+
+    *received_length = res;
+
+    return NETWORK_OP_RESULT_OK;
+}
+
+static network_op_result_t network_receive_idle_internal(
+        network_channel_t *channel,
+        network_channel_buffer_t *buffer,
+        size_t *received_length) {
+    *received_length = 0;
+
+    int32_t res = (int32_t)worker_op_network_receive_timeout(
+            channel,
+            buffer->data,
+            buffer->length,
+            NETWORK_CHANNEL_BUFFERS_IDLE_TIMEOUT_MS);
+
+    if (likely(res != -ECANCELED)) {
+        return network_receive_internal_result(channel, res, received_length);
+    }
+
+    // The connection is idle, the buffers are released while waiting for new data and allocated again, starting from
+    // the minimum size, once the socket becomes readable
+    network_buffer_release_if_empty(buffer);
+    network_buffer_release_if_empty(&channel->buffers.send);
+
+    res = (int32_t)worker_op_network_wait_readable(channel);
+    if (unlikely(res <= 0)) {
+        return network_receive_internal_result(channel, res, received_length);
+    }
+
+    network_buffer_ensure_free_space(buffer, buffer->packet_length_hint);
+
+    return network_receive_internal(
+            channel,
+            buffer->data,
+            buffer->packet_length_hint,
+            received_length);
+}
+
 network_op_result_t network_receive(
         network_channel_t *channel,
         network_channel_buffer_t *buffer,
         size_t receive_length) {
     size_t received_length;
+    size_t free_space = MIN(receive_length, buffer->packet_length_hint);
 
-    size_t buffer_data_offset = buffer->data_offset + buffer->data_size;
-    network_channel_buffer_data_t *buffer_data = buffer->data + buffer_data_offset;
-    size_t buffer_data_length = buffer->length - buffer_data_offset;
-
-    if (unlikely(buffer_data_length < receive_length)) {
+    // The buffer is allocated, or grown, only when data is about to be received
+    if (unlikely(!network_buffer_ensure_free_space(buffer, free_space))) {
         LOG_D(
                 TAG,
                 "Need <%lu> bytes in the buffer but only <%lu> are available for <%s>, too much data, closing connection",
-                receive_length,
-                buffer_data_length,
+                free_space,
+                buffer->length_max - buffer->data_size,
                 channel->address.str);
 
         fiber_scheduler_set_error(ENOMEM);
@@ -109,16 +324,25 @@ network_op_result_t network_receive(
 
     network_op_result_t res;
     if (network_channel_tls_uses_mbedtls(channel)) {
+        size_t buffer_data_offset = buffer->data_offset + buffer->data_size;
         res = (int32_t)network_tls_receive_internal(
                 channel,
-                buffer_data,
-                buffer_data_length,
+                buffer->data + buffer_data_offset,
+                buffer->length - buffer_data_offset,
+                &received_length);
+    } else if (network_receive_can_wait_idle(channel, buffer)) {
+        // The buffer is empty so the data are always received at the beginning of it
+        buffer->data_offset = 0;
+        res = network_receive_idle_internal(
+                channel,
+                buffer,
                 &received_length);
     } else {
+        size_t buffer_data_offset = buffer->data_offset + buffer->data_size;
         res = (int32_t)network_receive_internal(
                 channel,
-                buffer_data,
-                buffer_data_length,
+                buffer->data + buffer_data_offset,
+                buffer->length - buffer_data_offset,
                 &received_length);
     }
 
@@ -126,6 +350,12 @@ network_op_result_t network_receive(
         // Increase the amount of actual data (data_size) in the buffer
         buffer->data_size += received_length;
 
+        network_buffer_update_packet_length_hint(
+                buffer,
+                free_space,
+                received_length,
+                receive_length);
+
         // Update stats
         worker_stats_t *stats = worker_stats_get_internal_current();
         stats->network.received_packets++;
@@ -141,52 +371,64 @@ network_op_result_t network_receive(
     return res;
 }
 
-network_op_result_t network_receive_internal(
+network_op_result_t network_receive_direct(
         network_channel_t *channel,
         network_channel_buffer_data_t *buffer,
         size_t buffer_length,
         size_t *received_length) {
+    network_op_result_t res;
+
     *received_length = 0;
     if (unlikely(channel->status == NETWORK_CHANNEL_STATUS_CLOSED)) {
         return NETWORK_OP_RESULT_CLOSE_SOCKET;
     }
 
-    int32_t res = (int32_t)worker_op_network_receive(
-            channel,
-            buffer,
-            buffer_length);
+    if (network_channel_tls_uses_mbedtls(channel)) {
+        res = (int32_t)network_tls_receive_internal(
+                channel,
+                buffer,
+                buffer_length,
+                received_length);
+    } else {
+        res = (int32_t)network_receive_internal(
+                channel,
+                buffer,
+                buffer_length,
+                received_length);
+    }
 
-    if (unlikely(res == 0)) {
-        LOG_D(
-                TAG,
-                "[FD:%5d][RECV] The client <%s> closed the connection",
-                channel->fd,
-                channel->address.str);
+    if (likely(res == NETWORK_OP_RESULT_OK)) {
+        // Update stats
+        worker_stats_t *stats = worker_stats_get_internal_current();
+        stats->network.received_packets++;
+        stats->network.received_data += *received_length;
 
-        return NETWORK_OP_RESULT_CLOSE_SOCKET;
-    } else if (unlikely(res == -ECANCELED)) {
-        LOG_I(
-                TAG,
-                "[FD:%5d][ERROR CLIENT] Receive timeout from client <%s>",
-                channel->fd,
-                channel->address.str);
-        return NETWORK_OP_RESULT_ERROR;
-    } else if (unlikely(res < 0)) {
-        int error_number = -res;
-        LOG_I(
-                TAG,
-                "[FD:%5d][ERROR CLIENT] Error <%s (%d)> from client <%s>",
+        LOG_DI(
+                "[FD:%5d][RECV] Received <%lu> bytes directly from client <%s>",
                 channel->fd,
-                strerror(error_number),
-                error_number,
+                *received_length,
                 channel->address.str);
+    }
 
-        return NETWORK_OP_RESULT_ERROR;
+    return res;
+}
+
+network_op_result_t network_receive_internal(
+        network_channel_t *channel,
+        network_channel_buffer_data_t *buffer,
+        size_t buffer_length,
+        size_t *received_length) {
+    *received_length = 0;
+    if (unlikely(channel->status == NETWORK_CHANNEL_STATUS_CLOSED)) {
+        return NETWORK_OP_RESULT_CLOSE_SOCKET;
     }
 
-    *received_length = res;
+    int32_t res = (int32_t)worker_op_network_receive(
+            channel,
+            buffer,
+            buffer_length);
 
-    return NETWORK_OP_RESULT_OK;
+    return network_receive_internal_result(channel, res, received_length);
 }
 
 bool network_should_flush_send_buffer(
@@ -202,30 +444,66 @@ network_op_result_t network_flush_send_buffer(
         return NETWORK_OP_RESULT_OK;
     }
 
+    size_t flushed_size = channel->buffers.send.data_size;
     res = network_send_direct_wrapper(
             channel,
             channel->buffers.send.data,
-            channel->buffers.send.data_size);
+            flushed_size);
 
     // Resets data size and offset
     channel->buffers.send.data_size = 0;
     channel->buffers.send.data_offset = 0;
 
+    // If the replies are consistently much smaller than the buffer, the buffer is shrunk, a single large reply resets
+    // the count to avoid reallocating the buffer back and forth when small and large replies are mixed
+    network_channel_buffer_t *send_buffer = &channel->buffers.send;
+    if (flushed_size > send_buffer->length / 4) {
+        send_buffer->small_flushes_count = 0;
+    } else if (unlikely(
+            ++send_buffer->small_flushes_count >= NETWORK_CHANNEL_SEND_BUFFER_SHRINK_SMALL_FLUSHES &&
+            send_buffer->length > NETWORK_CHANNEL_BUFFER_LENGTH_MIN)) {
+        network_buffer_resize(send_buffer, send_buffer->length / 2);
+        send_buffer->small_flushes_count = 0;
+    }
+
     return res;
 }
 
+static bool network_send_buffer_ensure_free_space(
+        network_channel_t *channel,
+        size_t free_space) {
+    network_channel_buffer_t *send_buffer = &channel->buffers.send;
+
+    // In the send buffer data_offset always matches data_size, the data are always stored from the beginning
+    if (likely(send_buffer->length - send_buffer->data_size >= free_space)) {
+        return true;
+    }
+
+    if (unlikely(send_buffer->data_size + free_space > send_buffer->length_max)) {
+        return false;
+    }
+
+    network_buffer_resize(
+            send_buffer,
+            network_buffer_length_for(send_buffer, send_buffer->data_size + free_space));
+
+    return true;
+}
+
 network_channel_buffer_data_t *network_send_buffer_acquire_slice(
         network_channel_t *channel,
         size_t slice_length) {
     // Ensure that the slice requested can fit into the buffer and that there isn't already a slice acquired
-    assert(slice_length <= channel->buffers.send.length);
+    assert(slice_length <= channel->buffers.send.length_max);
     assert(channel->buffers.send_slice_acquired_length == 0);
 
-    // Check if there is enough space on the buffer, if not flush it
-    if (unlikely(channel->buffers.send.data_size + slice_length > channel->buffers.send.length)) {
+    // Check if there is enough space on the buffer, growing it if needed, if it can't grow further flush it
+    if (unlikely(!network_send_buffer_ensure_free_space(channel, slice_length))) {
         if (unlikely(network_flush_send_buffer(channel) != NETWORK_OP_RESULT_OK)) {
             return NULL;
         }
+
+        network_send_buffer_ensure_free_space(channel, slice_length);
     }
 
 #if DEBUG == 1
@@ -305,15 +583,17 @@ network_op_result_t network_send_buffered(
     assert(channel->buffers.send_slice_acquired_length == 0);
 
     do {
-        size_t buffer_length_can_be_sent = MIN(buffer_length, channel->buffers.send.length);
+        size_t buffer_length_can_be_sent = MIN(buffer_length, channel->buffers.send.length_max);
 
-        // Check if there is enough room in within send buffer, if not flush it
-        if (likely(channel->buffers.send.data_size + buffer_length_can_be_sent > channel->buffers.send.length)) {
+        // Check if there is enough room in within send buffer, growing it if needed, if it can't grow further flush it
+        if (unlikely(!network_send_buffer_ensure_free_space(channel, buffer_length_can_be_sent))) {
             network_op_result_t res = network_flush_send_buffer(channel);
 
             if (unlikely(res != NETWORK_OP_RESULT_OK)) {
                 return res;
             }
+
+            network_send_buffer_ensure_free_space(channel, buffer_length_can_be_sent);
         }
 
         // Copy the data to the send buffer and update data size and offset
@@ -381,6 +661,76 @@ network_op_result_t network_send_direct_internal(
     return NETWORK_OP_RESULT_OK;
 }
 
+size_t network_output_buffer_update_size(
+        network_channel_t *channel) {
+    worker_stats_t *stats = worker_stats_get_internal_current();
+    int32_t send_queue_size = worker_op_network_send_queue_size(channel);
+
+    // The output buffer of the connection is made by the data in the send buffer not flushed yet and by the data
+    // already written to the socket but not yet sent by the kernel, which is where the replies of a slow reader pile up
+    size_t size = channel->buffers.send.data_size + (send_queue_size > 0 ? send_queue_size : 0);
+
+    stats->network.output_buffers_size = stats->network.output_buffers_size - channel->output_buffer.size + size;
+    if (unlikely(size > stats->network.output_buffers_size_max)) {
+        stats->network.output_buffers_size_max = size;
+    }
+
+    channel->output_buffer.size = size;
+
+    return size;
+}
+
+network_op_result_t network_output_buffer_wait_within_limits(
+        network_channel_t *channel) {
+    config_module_network_output_buffer_limits_t *limits = channel->module_config->network->output_buffer_limits;
+
+    if (likely(limits == NULL)) {
+        return NETWORK_OP_RESULT_OK;
+    }
+
+    while(true) {
+        size_t size = network_output_buffer_update_size(channel);
+
+        if (unlikely(size > limits->hard->max_size)) {
+            LOG_I(
+                    TAG,
+                    "[FD:%5d] The output buffer of the client <%s> is <%lu> bytes, over the hard limit, closing connection",
+                    channel->fd,
+                    channel->address.str,
+                    size);
+            worker_stats_get_internal_current()->network.output_buffers_limit_disconnections++;
+
+            return NETWORK_OP_RESULT_CLOSE_SOCKET;
+        }
+
+        if (likely(limits->soft == NULL || size <= limits->soft->max_size)) {
+            channel->output_buffer.soft_limit_reached_at_ms = 0;
+            return NETWORK_OP_RESULT_OK;
+        }
+
+        int64_t now_ms = clock_monotonic_coarse_int64_ms();
+        if (channel->output_buffer.soft_limit_reached_at_ms == 0) {
+            channel->output_buffer.soft_limit_reached_at_ms = now_ms;
+        } else if (now_ms - channel->output_buffer.soft_limit_reached_at_ms >= limits->soft->max_duration_ms) {
+            LOG_I(
+                    TAG,
+                    "[FD:%5d] The output buffer of the client <%s> is <%lu> bytes, over the soft limit for too long, closing connection",
+                    channel->fd,
+                    channel->address.str,
+                    size);
+            worker_stats_get_internal_current()->network.output_buffers_limit_disconnections++;
+
+            return NETWORK_OP_RESULT_CLOSE_SOCKET;
+        }
+
+        // Nothing is read from the socket while waiting for the client to catch up, once the receive buffer of the
+        // socket fills up the client will be slowed down by the TCP flow control
+        if (unlikely(!worker_op_wait_ms(NETWORK_OUTPUT_BUFFER_LIMITS_WAIT_MS))) {
+            return NETWORK_OP_RESULT_CLOSE_SOCKET;
+        }
+    }
+}
+
 network_op_result_t network_close(
         network_channel_t *channel,
         bool shutdown_may_fail) {
@@ -407,6 +757,44 @@ network_op_result_t network_close(
             shutdown_may_fail);
 }
 
+network_io_common_fd_t network_detach(
+        network_channel_t *channel) {
+    network_io_common_fd_t fd;
+
+    // Only a plain connection with nothing left to send can be handed over to another worker
+    if (unlikely(channel->status != NETWORK_CHANNEL_STATUS_CONNECTED ||
+        network_channel_tls_is_enabled(channel) ||
+        channel->buffers.send.data_size > 0)) {
+        return -1;
+    }
+
+    if ((fd = worker_op_network_detach(channel)) < 0) {
+        return -1;
+    }
+
+    if (unlikely(channel->output_buffer.size > 0)) {
+        worker_stats_get_internal_current()->network.output_buffers_size -= channel->output_buffer.size;
+        channel->output_buffer.size = 0;
+    }
+
+    network_buffer_free(&channel->buffers.send);
+    channel->status = NETWORK_CHANNEL_STATUS_MIGRATED;
+
+    return fd;
+}
+
+bool network_attach(
+        network_channel_t *channel,
+        network_io_common_fd_t fd) {
+    if (unlikely(!worker_op_network_attach(channel, fd))) {
+        return false;
+    }
+
+    channel->status = NETWORK_CHANNEL_STATUS_CONNECTED;
+
+    return true;
+}
+
 network_op_result_t network_close_internal(
         network_channel_t *channel,
         bool shutdown_may_fail) {
@@ -415,6 +803,14 @@ network_op_result_t network_close_internal(
     assert(channel->status != NETWORK_CHANNEL_STATUS_UNDEFINED);
 
     if (channel->status != NETWORK_CHANNEL_STATUS_CLOSED) {
+        // The output buffer of the connection is not accounted anymore
+        if (unlikely(channel->output_buffer.size > 0)) {
+            worker_stats_get_internal_current()->network.output_buffers_size -= channel->output_buffer.size;
+            channel->output_buffer.size = 0;
+        }
+
+        network_buffer_free(&channel->buffers.send);
+
         res = worker_op_network_close(channel, shutdown_may_fail)
               ? NETWORK_OP_RESULT_OK
               : NETWORK_OP_RESULT_ERROR;
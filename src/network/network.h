@@ -5,6 +5,8 @@
 extern "C" {
 #endif
 
+#define NETWORK_OUTPUT_BUFFER_LIMITS_WAIT_MS (10)
+
 enum network_op_result {
     NETWORK_OP_RESULT_OK,
     NETWORK_OP_RESULT_CLOSE_SOCKET,
@@ -12,6 +14,20 @@ enum network_op_result {
 };
 typedef enum network_op_result network_op_result_t;
 
+void network_buffer_init(
+        network_channel_buffer_t *network_channel_buffer,
+        size_t length_max);
+
+void network_buffer_free(
+        network_channel_buffer_t *network_channel_buffer);
+
+bool network_buffer_release_if_empty(
+        network_channel_buffer_t *network_channel_buffer);
+
+bool network_buffer_ensure_free_space(
+        network_channel_buffer_t *network_channel_buffer,
+        size_t free_space);
+
 bool network_buffer_has_enough_space(
         network_channel_buffer_t *read_buffer,
         size_t read_length);
@@ -28,6 +44,12 @@ network_op_result_t network_receive(
         network_channel_buffer_t *buffer,
         size_t receive_length);
 
+network_op_result_t network_receive_direct(
+        network_channel_t *channel,
+        network_channel_buffer_data_t *buffer,
+        size_t buffer_length,
+        size_t *received_length);
+
 network_op_result_t network_receive_internal(
         network_channel_t *channel,
         network_channel_buffer_data_t *buffer,
@@ -69,6 +91,12 @@ network_op_result_t network_send_direct(
         network_channel_buffer_data_t *buffer,
         size_t buffer_length);
 
+size_t network_output_buffer_update_size(
+        network_channel_t *channel);
+
+network_op_result_t network_output_buffer_wait_within_limits(
+        network_channel_t *channel);
+
 network_op_result_t network_close(
         network_channel_t *channel,
         bool shutdown_may_fail);
@@ -77,6 +105,13 @@ network_op_result_t network_close_internal(
         network_channel_t *channel,
         bool shutdown_may_fail);
 
+network_io_common_fd_t network_detach(
+        network_channel_t *channel);
+
+bool network_attach(
+        network_channel_t *channel,
+        network_io_common_fd_t fd);
+
 #ifdef __cplusplus
 }
 #endif
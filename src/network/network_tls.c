@@ -22,6 +22,8 @@
 #include <mbedtls/error.h>
 #include <mbedtls/net_sockets.h>
 #include <mbedtls/ssl.h>
+#include <mbedtls/ssl_cache.h>
+#include <mbedtls/ssl_ticket.h>
 #include <mbedtls/version.h>
 
 #include "misc.h"
@@ -40,12 +42,26 @@
 #include "config.h"
 #include "network/channel/network_channel.h"
 #include "network.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
 
 #include "network_tls_mbedtls.h"
 #include "network_tls.h"
 
 #define TAG "network_tls"
 
+// The session cache and the ticket keys are shared by all the workers, as the connections of a client can land on any
+// worker, and are therefore protected by a spinlock, mbedtls might be built without MBEDTLS_THREADING_C
+struct network_tls_session_resumption {
+    spinlock_lock_t lock;
+    bool tickets_enabled;
+    bool cache_enabled;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    mbedtls_ssl_ticket_context ticket;
+    mbedtls_ssl_cache_context cache;
+};
+
 bool network_tls_is_ulp_tls_supported_internal() {
     bool result = true;
     struct sockaddr_in server_addr = {
@@ -407,6 +423,180 @@ void network_tls_config_free(
     xalloc_free(network_tls_config);
 }
 
+static void network_tls_session_resumption_stats_resumed() {
+    // The callbacks are invoked during the handshake, which always runs within a worker, the check is only for safety
+    if (likely(worker_context_get() != NULL)) {
+        worker_stats_get_internal_current()->network.tls_sessions_resumed++;
+    }
+}
+
+static int network_tls_session_resumption_cache_get(
+        void *data,
+        mbedtls_ssl_session *session) {
+    int res;
+    network_tls_session_resumption_t *network_tls_session_resumption = data;
+
+    spinlock_lock(&network_tls_session_resumption->lock);
+    res = mbedtls_ssl_cache_get(&network_tls_session_resumption->cache, session);
+    spinlock_unlock(&network_tls_session_resumption->lock);
+
+    if (res == 0) {
+        network_tls_session_resumption_stats_resumed();
+    }
+
+    return res;
+}
+
+static int network_tls_session_resumption_cache_set(
+        void *data,
+        const mbedtls_ssl_session *session) {
+    int res;
+    network_tls_session_resumption_t *network_tls_session_resumption = data;
+
+    spinlock_lock(&network_tls_session_resumption->lock);
+    res = mbedtls_ssl_cache_set(&network_tls_session_resumption->cache, session);
+    spinlock_unlock(&network_tls_session_resumption->lock);
+
+    return res;
+}
+
+static int network_tls_session_resumption_ticket_write(
+        void *data,
+        const mbedtls_ssl_session *session,
+        unsigned char *start,
+        const unsigned char *end,
+        size_t *tlen,
+        uint32_t *lifetime) {
+    int res;
+    network_tls_session_resumption_t *network_tls_session_resumption = data;
+
+    // The keys are rotated by mbedtls when a ticket is written or parsed after the lifetime has elapsed, the previous
+    // key is kept to be able to parse the tickets issued before the rotation
+    spinlock_lock(&network_tls_session_resumption->lock);
+    res = mbedtls_ssl_ticket_write(&network_tls_session_resumption->ticket, session, start, end, tlen, lifetime);
+    spinlock_unlock(&network_tls_session_resumption->lock);
+
+    return res;
+}
+
+static int network_tls_session_resumption_ticket_parse(
+        void *data,
+        mbedtls_ssl_session *session,
+        unsigned char *buf,
+        size_t len) {
+    int res;
+    network_tls_session_resumption_t *network_tls_session_resumption = data;
+
+    spinlock_lock(&network_tls_session_resumption->lock);
+    res = mbedtls_ssl_ticket_parse(&network_tls_session_resumption->ticket, session, buf, len);
+    spinlock_unlock(&network_tls_session_resumption->lock);
+
+    if (res == 0) {
+        network_tls_session_resumption_stats_resumed();
+    }
+
+    return res;
+}
+
+network_tls_session_resumption_t *network_tls_session_resumption_new(
+        config_module_network_tls_session_resumption_t *config_session_resumption) {
+    bool return_res = false;
+    network_tls_session_resumption_t *network_tls_session_resumption =
+            xalloc_alloc_zero(sizeof(network_tls_session_resumption_t));
+
+    spinlock_init(&network_tls_session_resumption->lock);
+    network_tls_session_resumption->tickets_enabled = config_session_resumption->tickets;
+    network_tls_session_resumption->cache_enabled = config_session_resumption->cache;
+
+    mbedtls_entropy_init(&network_tls_session_resumption->entropy);
+    mbedtls_ctr_drbg_init(&network_tls_session_resumption->ctr_drbg);
+    mbedtls_ssl_ticket_init(&network_tls_session_resumption->ticket);
+    mbedtls_ssl_cache_init(&network_tls_session_resumption->cache);
+
+    if (mbedtls_ctr_drbg_seed(
+            &network_tls_session_resumption->ctr_drbg,
+            mbedtls_entropy_func,
+            &network_tls_session_resumption->entropy,
+            NULL,
+            0) != 0) {
+        LOG_E(TAG, "Failed to seed the random generator for the tls session tickets");
+        goto end;
+    }
+
+    if (network_tls_session_resumption->tickets_enabled) {
+        int64_t tickets_lifetime_s = config_session_resumption->tickets_lifetime_s > 0
+                ? config_session_resumption->tickets_lifetime_s
+                : NETWORK_TLS_SESSION_TICKETS_LIFETIME_DEFAULT_S;
+
+        if (mbedtls_ssl_ticket_setup(
+                &network_tls_session_resumption->ticket,
+                mbedtls_ctr_drbg_random,
+                &network_tls_session_resumption->ctr_drbg,
+                MBEDTLS_CIPHER_AES_256_GCM,
+                (uint32_t)tickets_lifetime_s) != 0) {
+            LOG_E(TAG, "Failed to setup the tls session tickets");
+            goto end;
+        }
+    }
+
+    if (network_tls_session_resumption->cache_enabled) {
+        mbedtls_ssl_cache_set_max_entries(
+                &network_tls_session_resumption->cache,
+                config_session_resumption->cache_max_entries > 0
+                    ? (int)config_session_resumption->cache_max_entries
+                    : NETWORK_TLS_SESSION_CACHE_MAX_ENTRIES_DEFAULT);
+        mbedtls_ssl_cache_set_timeout(
+                &network_tls_session_resumption->cache,
+                config_session_resumption->cache_timeout_s > 0
+                    ? (int)config_session_resumption->cache_timeout_s
+                    : NETWORK_TLS_SESSION_CACHE_TIMEOUT_DEFAULT_S);
+    }
+
+    return_res = true;
+
+end:
+    if (!return_res) {
+        network_tls_session_resumption_free(network_tls_session_resumption);
+        network_tls_session_resumption = NULL;
+    }
+
+    return network_tls_session_resumption;
+}
+
+void network_tls_session_resumption_free(
+        network_tls_session_resumption_t *network_tls_session_resumption) {
+    if (network_tls_session_resumption == NULL) {
+        return;
+    }
+
+    mbedtls_ssl_cache_free(&network_tls_session_resumption->cache);
+    mbedtls_ssl_ticket_free(&network_tls_session_resumption->ticket);
+    mbedtls_ctr_drbg_free(&network_tls_session_resumption->ctr_drbg);
+    mbedtls_entropy_free(&network_tls_session_resumption->entropy);
+
+    xalloc_free(network_tls_session_resumption);
+}
+
+void network_tls_config_set_session_resumption(
+        network_tls_config_t *network_tls_config,
+        network_tls_session_resumption_t *network_tls_session_resumption) {
+    if (network_tls_session_resumption->tickets_enabled) {
+        mbedtls_ssl_conf_session_tickets_cb(
+                &network_tls_config->config,
+                network_tls_session_resumption_ticket_write,
+                network_tls_session_resumption_ticket_parse,
+                network_tls_session_resumption);
+    }
+
+    if (network_tls_session_resumption->cache_enabled) {
+        mbedtls_ssl_conf_session_cache(
+                &network_tls_config->config,
+                network_tls_session_resumption,
+                network_tls_session_resumption_cache_get,
+                network_tls_session_resumption_cache_set);
+    }
+}
+
 void network_tls_close_internal(
         network_channel_t *channel) {
     int32_t res;
@@ -6,10 +6,16 @@ extern "C" {
 #endif
 
 #define NETWORK_TLS_PROC_SYS_NET_IPV4_TCP_AVAILABLE_ULP "/proc/sys/net/ipv4/tcp_available_ulp"
+#define NETWORK_TLS_SESSION_TICKETS_LIFETIME_DEFAULT_S (12 * 60 * 60)
+#define NETWORK_TLS_SESSION_CACHE_MAX_ENTRIES_DEFAULT (10000)
+#define NETWORK_TLS_SESSION_CACHE_TIMEOUT_DEFAULT_S (60 * 60)
 
 // The struct is defined in network_tls_internal.h
 typedef struct network_tls_config network_tls_config_t;
 
+// The struct is defined in network_tls.c
+typedef struct network_tls_session_resumption network_tls_session_resumption_t;
+
 typedef struct network_tls_mbedtls_cipher_suite_info network_tls_mbedtls_cipher_suite_info_t;
 struct network_tls_mbedtls_cipher_suite_info
 {
@@ -39,6 +45,16 @@ network_tls_config_t *network_tls_config_init(
 void network_tls_config_free(
         network_tls_config_t *network_tls_config);
 
+network_tls_session_resumption_t *network_tls_session_resumption_new(
+        config_module_network_tls_session_resumption_t *config_session_resumption);
+
+void network_tls_session_resumption_free(
+        network_tls_session_resumption_t *network_tls_session_resumption);
+
+void network_tls_config_set_session_resumption(
+        network_tls_config_t *network_tls_config,
+        network_tls_session_resumption_t *network_tls_session_resumption);
+
 char* network_tls_mbedtls_version();
 
 network_tls_mbedtls_cipher_suite_info_t *network_tls_mbedtls_get_all_cipher_suites_info();
@@ -55,6 +55,7 @@
 #include "worker/worker_stats.h"
 #include "worker/worker_context.h"
 #include "worker/worker.h"
+#include "worker/worker_mailbox.h"
 #include "data_structures/hashtable/mcmp/hashtable_config.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
 #include "thread.h"
@@ -123,6 +124,10 @@ worker_context_t* program_workers_initialize_context(
     program_context->workers_context = workers_context =
             xalloc_alloc_zero(sizeof(worker_context_t) * program_context->workers_count);
 
+    program_context->workers_mailbox = worker_mailbox_new(
+            program_context->workers_count,
+            WORKER_MAILBOX_QUEUE_SIZE);
+
     for(uint32_t worker_index = 0; worker_index < program_context->workers_count; worker_index++) {
         worker_context_t *worker_context = &workers_context[worker_index];
 
@@ -135,6 +140,8 @@ worker_context_t* program_workers_initialize_context(
                 &program_context->storage_db_loaded,
                 program_context->config,
                 program_context->db);
+        worker_context->mailbox = program_context->workers_mailbox;
+        worker_context->network_tls_session_resumptions = program_context->network_tls_session_resumptions;
 
         LOG_V(TAG, "Setting up worker <%u>", worker_index);
 
@@ -621,6 +628,45 @@ bool program_cleanup_module(
     return true;
 }
 
+bool program_network_tls_session_resumptions_initialize(
+        program_context_t* program_context) {
+    config_t *config = program_context->config;
+
+    // The session cache and the session tickets keys are shared by all the workers to let a client resume a session
+    // regardless of the worker that accepts its connection, each module has its own to avoid cross-module resumptions
+    program_context->network_tls_session_resumptions =
+            xalloc_alloc_zero(sizeof(network_tls_session_resumption_t*) * config->modules_count);
+
+    for(int module_index = 0; module_index < config->modules_count; module_index++) {
+        config_module_t *config_module = &config->modules[module_index];
+
+        if (config_module->network->tls == NULL || config_module->network->tls->session_resumption == NULL) {
+            continue;
+        }
+
+        network_tls_session_resumption_t *network_tls_session_resumption = network_tls_session_resumption_new(
+                config_module->network->tls->session_resumption);
+        if (network_tls_session_resumption == NULL) {
+            LOG_E(TAG, "Unable to initialize the tls session resumption for the module <%s>", config_module->type);
+            return false;
+        }
+
+        program_context->network_tls_session_resumptions[module_index] = network_tls_session_resumption;
+    }
+
+    return true;
+}
+
+void program_network_tls_session_resumptions_cleanup(
+        program_context_t* program_context) {
+    for(int module_index = 0; module_index < program_context->config->modules_count; module_index++) {
+        network_tls_session_resumption_free(program_context->network_tls_session_resumptions[module_index]);
+    }
+
+    xalloc_free(program_context->network_tls_session_resumptions);
+    program_context->network_tls_session_resumptions = NULL;
+}
+
 void program_cleanup(
         program_context_t* program_context) {
     // TODO: free storage backend
@@ -632,6 +678,18 @@ void program_cleanup(
         xalloc_free(program_context->workers_context);
     }
 
+    // The workers have closed their listeners, the UNIX sockets shared by them can be closed and removed
+    network_channel_listener_unix_shared_cleanup();
+
+    if (program_context->workers_mailbox) {
+        worker_mailbox_free(program_context->workers_mailbox);
+        program_context->workers_mailbox = NULL;
+    }
+
+    if (program_context->network_tls_session_resumptions) {
+        program_network_tls_session_resumptions_cleanup(program_context);
+    }
+
     if (program_context->config) {
         program_cleanup_module(program_context);
     }
@@ -745,6 +803,10 @@ int program_main(
         goto end;
     }
 
+    if (program_network_tls_session_resumptions_initialize(program_context) == false) {
+        goto end;
+    }
+
     // Initialize the signal handler thread
     if (program_signal_handler_thread_initialize(
             program_context) == NULL) {
@@ -15,6 +15,8 @@ struct program_context {
     storage_db_t *db;
     uint32_t workers_count;
     worker_context_t *workers_context;
+    struct worker_mailbox *workers_mailbox;
+    struct network_tls_session_resumption **network_tls_session_resumptions;
     signal_handler_thread_context_t *signal_handler_thread_context;
     bool_volatile_t storage_db_loaded;
     bool_volatile_t workers_terminate_event_loop;
@@ -58,6 +60,12 @@ bool program_initialize_module(
 bool program_cleanup_module(
         program_context_t* program_context);
 
+bool program_network_tls_session_resumptions_initialize(
+        program_context_t* program_context);
+
+void program_network_tls_session_resumptions_cleanup(
+        program_context_t* program_context);
+
 bool program_config_thread_affinity_set_selected_cpus(
         program_context_t *program_context);
 
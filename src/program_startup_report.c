@@ -12,6 +12,7 @@
 #include <string.h>
 #include <sys/sysinfo.h>
 #include <sys/utsname.h>
+#include <arpa/inet.h>
 #include <liburing.h>
 
 #include "misc.h"
@@ -20,6 +21,11 @@
 #include "xalloc.h"
 #include "config.h"
 #include "log/log.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
 #include "network/network_tls.h"
 
 #include "program_startup_report.h"
@@ -118,6 +124,21 @@ void program_startup_report_machine_clock() {
             clock_monotonic_coarse_get_resolution_ms());
 }
 
+void program_startup_report_connection_memory() {
+    LOG_I(
+            TAG,
+            "> Per connection memory: %d KB fiber stack, %d KB to %d KB read buffer, %d KB to %d KB send buffer",
+            FIBER_SCHEDULER_STACK_SIZE / 1024,
+            NETWORK_CHANNEL_BUFFER_LENGTH_MIN / 1024,
+            NETWORK_CHANNEL_RECV_BUFFER_SIZE / 1024,
+            NETWORK_CHANNEL_BUFFER_LENGTH_MIN / 1024,
+            NETWORK_CHANNEL_SEND_BUFFER_SIZE / 1024);
+    LOG_I(
+            TAG,
+            "       The buffers are allocated on demand and released after %d ms of inactivity",
+            NETWORK_CHANNEL_BUFFERS_IDLE_TIMEOUT_MS);
+}
+
 void program_startup_report() {
     program_startup_report_build();
     program_startup_report_machine_uname();
@@ -125,4 +146,5 @@ void program_startup_report() {
     program_startup_report_machine_liburing();
     program_startup_report_machine_tls();
     program_startup_report_machine_clock();
+    program_startup_report_connection_memory();
 }
@@ -475,6 +475,12 @@ PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_ARRAY, array, (uint
         array_count)
 })
 
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_ARRAY, array_null, (), {
+    PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
+        protocol_redis_writer_write_argument_number,
+        -1)
+})
+
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_MAP, map, (uint32_t items_count), {
     PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
         protocol_redis_writer_write_argument_number,
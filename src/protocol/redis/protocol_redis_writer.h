@@ -63,6 +63,7 @@ PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(number, (long number));
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(double, (double number));
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(big_number, (char* bignumber, int bignumber_length));
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(array, (uint32_t array_count));
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(array_null, ());
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(map, (uint32_t items_count));
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(set, (uint32_t set_count));
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(attribute, (uint32_t attributes_count));
@@ -44,9 +44,12 @@
 #include "data_structures/hashtable/mcmp/hashtable_op_iter.h"
 #include "data_structures/hashtable/mcmp/hashtable_op_rmw.h"
 #include "data_structures/hashtable/mcmp/hashtable_op_get_random_key.h"
+#include "data_structures/hashtable/mcmp/hashtable_op_lock.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
 #include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
 #include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
 #include "fiber/fiber.h"
 #include "fiber/fiber_scheduler.h"
 #include "log/log.h"
@@ -63,6 +66,9 @@
 
 #define TAG "storage_db"
 
+// The versions are generated per worker and combined with the worker index so they are unique without having to share a
+// counter, the counter starts from 1 to never match STORAGE_DB_ENTRY_INDEX_VERSION_NONE
+static thread_local storage_db_entry_index_version_t storage_db_entry_index_version_counter = 0;
 
 char *storage_db_shard_build_path(
         char *basedir_path,
@@ -539,6 +545,12 @@ void storage_db_free(
     xalloc_free(db);
 }
 
+static inline __attribute__((always_inline)) storage_db_entry_index_version_t storage_db_entry_index_version_next() {
+    storage_db_entry_index_version_counter++;
+
+    return (storage_db_entry_index_version_counter << 16) | (worker_context_get()->worker_index & 0xFFFF);
+}
+
 storage_db_entry_index_t *storage_db_entry_index_ring_buffer_new(
         storage_db_t *db) {
     storage_db_entry_index_t *entry_index;
@@ -566,6 +578,7 @@ storage_db_entry_index_t *storage_db_entry_index_ring_buffer_new(
     }
 
     entry_index->created_time_ms = clock_monotonic_int64_ms();
+    entry_index->version = storage_db_entry_index_version_next();
 
     return entry_index;
 }
@@ -682,7 +695,13 @@ void storage_db_entry_index_chunks_free(
         }
     }
 
-    if (entry_index->value.size > 0) {
+    if (entry_index->value_object) {
+        // The values kept as data structures don't use the chunks, the size only tracks the memory used
+        assert(entry_index->value_type == STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET);
+        sorted_set_free(entry_index->value_object);
+        entry_index->value_object = NULL;
+        entry_index->value.size = 0;
+    } else if (entry_index->value.size > 0) {
         storage_db_chunk_sequence_free_chunks(db, &entry_index->value);
     }
 }
@@ -822,6 +841,193 @@ char *storage_db_get_chunk_data(
     return buffer;
 }
 
+char *storage_db_chunk_sequence_read_all(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        bool *allocated_new_buffer) {
+    *allocated_new_buffer = false;
+
+    // If the value fits in one chunk there is no need to copy it around
+    if (likely(chunk_sequence->count == 1)) {
+        return storage_db_get_chunk_data(
+                db,
+                storage_db_chunk_sequence_get(chunk_sequence, 0),
+                allocated_new_buffer);
+    }
+
+    size_t offset = 0;
+    char *buffer = xalloc_alloc(chunk_sequence->size);
+    *allocated_new_buffer = true;
+
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        if (unlikely(!storage_db_chunk_read(
+                db,
+                chunk_info,
+                buffer + offset,
+                0,
+                chunk_info->chunk_length))) {
+            xalloc_free(buffer);
+            *allocated_new_buffer = false;
+            return NULL;
+        }
+
+        offset += chunk_info->chunk_length;
+    }
+
+    return buffer;
+}
+
+bool storage_db_chunk_sequence_write_all(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *buffer,
+        size_t buffer_length) {
+    size_t offset = 0;
+
+    assert(buffer_length == chunk_sequence->size);
+
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        if (unlikely(!storage_db_chunk_write(
+                db,
+                chunk_info,
+                0,
+                buffer + offset,
+                chunk_info->chunk_length))) {
+            return false;
+        }
+
+        offset += chunk_info->chunk_length;
+    }
+
+    return true;
+}
+
+bool storage_db_chunk_sequence_read(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *buffer,
+        size_t offset,
+        size_t length) {
+    size_t read_length = 0;
+
+    // The chunks are expected to be all full but the last one, as allocated by storage_db_chunk_sequence_allocate, so
+    // the chunk containing the offset can be calculated right away
+    storage_db_chunk_index_t chunk_index = offset / STORAGE_DB_CHUNK_MAX_SIZE;
+    off_t chunk_offset = (off_t)(offset % STORAGE_DB_CHUNK_MAX_SIZE);
+
+    assert(offset + length <= chunk_sequence->size);
+
+    while(read_length < length) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+        size_t chunk_read_length = MIN(length - read_length, chunk_info->chunk_length - chunk_offset);
+
+        if (unlikely(!storage_db_chunk_read(
+                db,
+                chunk_info,
+                buffer + read_length,
+                chunk_offset,
+                chunk_read_length))) {
+            return false;
+        }
+
+        read_length += chunk_read_length;
+        chunk_offset = 0;
+        chunk_index++;
+    }
+
+    return true;
+}
+
+bool storage_db_chunk_sequence_write(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t offset,
+        char *buffer,
+        size_t buffer_length) {
+    size_t written_length = 0;
+
+    // As for storage_db_chunk_sequence_read, the chunks are expected to be all full but the last one
+    storage_db_chunk_index_t chunk_index = offset / STORAGE_DB_CHUNK_MAX_SIZE;
+    off_t chunk_offset = (off_t)(offset % STORAGE_DB_CHUNK_MAX_SIZE);
+
+    assert(offset + buffer_length <= chunk_sequence->size);
+
+    while(written_length < buffer_length) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+        size_t chunk_write_length = MIN(buffer_length - written_length, chunk_info->chunk_length - chunk_offset);
+
+        if (unlikely(!storage_db_chunk_write(
+                db,
+                chunk_info,
+                chunk_offset,
+                buffer + written_length,
+                chunk_write_length))) {
+            return false;
+        }
+
+        written_length += chunk_write_length;
+        chunk_offset = 0;
+        chunk_index++;
+    }
+
+    return true;
+}
+
+bool storage_db_chunk_sequence_append_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *buffer,
+        size_t buffer_length) {
+    size_t appended_length = 0;
+
+    // Only the chunks in memory can be grown in place
+    assert(db->config->backend_type == STORAGE_DB_BACKEND_TYPE_MEMORY);
+
+    if (unlikely(storage_db_chunk_sequence_calculate_chunk_count(chunk_sequence->size + buffer_length) >
+            UINT16_MAX)) {
+        return false;
+    }
+
+    // The last chunk is filled up before adding new ones to keep all the chunks full but the last one
+    while(appended_length < buffer_length) {
+        storage_db_chunk_info_t *chunk_info = chunk_sequence->count > 0
+                ? storage_db_chunk_sequence_get(chunk_sequence, chunk_sequence->count - 1)
+                : NULL;
+
+        if (chunk_info == NULL || chunk_info->chunk_length == STORAGE_DB_CHUNK_MAX_SIZE) {
+            chunk_sequence->sequence = xalloc_realloc(
+                    chunk_sequence->sequence,
+                    sizeof(storage_db_chunk_info_t) * (chunk_sequence->count + 1));
+            chunk_info = &chunk_sequence->sequence[chunk_sequence->count];
+            chunk_info->memory.chunk_data = NULL;
+            chunk_info->chunk_length = 0;
+            chunk_sequence->count++;
+        }
+
+        size_t chunk_append_length = MIN(
+                buffer_length - appended_length,
+                STORAGE_DB_CHUNK_MAX_SIZE - chunk_info->chunk_length);
+
+        chunk_info->memory.chunk_data = xalloc_realloc(
+                chunk_info->memory.chunk_data,
+                chunk_info->chunk_length + chunk_append_length);
+        memcpy(
+                (char*)chunk_info->memory.chunk_data + chunk_info->chunk_length,
+                buffer + appended_length,
+                chunk_append_length);
+
+        chunk_info->chunk_length += chunk_append_length;
+        chunk_sequence->size += chunk_append_length;
+        appended_length += chunk_append_length;
+    }
+
+    return true;
+}
+
 void storage_db_entry_index_status_increase_readers_counter(
         storage_db_entry_index_t* entry_index,
         storage_db_entry_index_status_t *old_status) {
@@ -1112,6 +1318,51 @@ storage_db_entry_index_t *storage_db_get_entry_index_for_read(
     return entry_index;
 }
 
+storage_db_entry_index_version_t storage_db_get_entry_index_version(
+        storage_db_t *db,
+        storage_db_database_number_t database_number,
+        transaction_t *transaction,
+        char *key,
+        size_t key_length) {
+    storage_db_entry_index_t *entry_index = storage_db_get_entry_index(
+            db,
+            database_number,
+            transaction,
+            key,
+            key_length);
+
+    // An expired key is equivalent to a missing one, it's not necessary to evict it here
+    if (entry_index == NULL || storage_db_entry_index_is_expired(entry_index)) {
+        return STORAGE_DB_ENTRY_INDEX_VERSION_NONE;
+    }
+
+    return entry_index->version;
+}
+
+storage_db_key_lock_index_t storage_db_get_key_lock_index(
+        storage_db_t *db,
+        storage_db_database_number_t database_number,
+        char *key,
+        size_t key_length) {
+    return hashtable_mcmp_op_lock_get_chunk_index(
+            db->hashtable,
+            database_number,
+            key,
+            key_length);
+}
+
+bool storage_db_lock_keys_for_write(
+        storage_db_t *db,
+        transaction_t *transaction,
+        storage_db_key_lock_index_t *key_lock_indexes,
+        uint32_t key_lock_indexes_count) {
+    return hashtable_mcmp_op_lock_chunks_for_write(
+            db->hashtable,
+            transaction,
+            key_lock_indexes,
+            key_lock_indexes_count);
+}
+
 bool storage_db_set_entry_index(
         storage_db_t *db,
         storage_db_database_number_t database_number,
@@ -1187,7 +1438,7 @@ bool storage_db_set_entry_index(
     return res;
 }
 
-bool storage_db_op_set(
+static bool storage_db_op_set_internal(
         storage_db_t *db,
         storage_db_database_number_t database_number,
         transaction_t *transaction,
@@ -1195,6 +1446,7 @@ bool storage_db_op_set(
         size_t key_length,
         storage_db_entry_index_value_type_t value_type,
         storage_db_chunk_sequence_t *value_chunk_sequence,
+        void *value_object,
         storage_db_expiry_time_ms_t expiry_time_ms) {
     storage_db_entry_index_t *entry_index = NULL;
     bool result_res = false;
@@ -1233,9 +1485,11 @@ bool storage_db_op_set(
 
     // Fetch a new entry and assign the key and the value as needed
     entry_index->database_number = database_number;
+    entry_index->value_type = value_type;
     entry_index->value.size = value_chunk_sequence->size;
     entry_index->value.count = value_chunk_sequence->count;
     entry_index->value.sequence = value_chunk_sequence->sequence;
+    entry_index->value_object = value_object;
     entry_index->expiry_time_ms = expiry_time_ms;
 
     // Try to store the entry index in the database
@@ -1251,6 +1505,7 @@ bool storage_db_op_set(
         entry_index->value.size = 0;
         entry_index->value.count = 0;
         entry_index->value.sequence = NULL;
+        entry_index->value_object = NULL;
         goto end;
     }
 
@@ -1265,6 +1520,51 @@ end:
     return result_res;
 }
 
+bool storage_db_op_set(
+        storage_db_t *db,
+        storage_db_database_number_t database_number,
+        transaction_t *transaction,
+        char *key,
+        size_t key_length,
+        storage_db_entry_index_value_type_t value_type,
+        storage_db_chunk_sequence_t *value_chunk_sequence,
+        storage_db_expiry_time_ms_t expiry_time_ms) {
+    return storage_db_op_set_internal(
+            db,
+            database_number,
+            transaction,
+            key,
+            key_length,
+            value_type,
+            value_chunk_sequence,
+            NULL,
+            expiry_time_ms);
+}
+
+bool storage_db_op_set_value_object(
+        storage_db_t *db,
+        storage_db_database_number_t database_number,
+        transaction_t *transaction,
+        char *key,
+        size_t key_length,
+        storage_db_entry_index_value_type_t value_type,
+        void *value_object,
+        size_t value_size,
+        storage_db_expiry_time_ms_t expiry_time_ms) {
+    storage_db_chunk_sequence_t value_chunk_sequence = { .count = 0, .sequence = NULL, .size = value_size };
+
+    return storage_db_op_set_internal(
+            db,
+            database_number,
+            transaction,
+            key,
+            key_length,
+            value_type,
+            &value_chunk_sequence,
+            value_object,
+            expiry_time_ms);
+}
+
 bool storage_db_op_rmw_begin(
         storage_db_t *db,
         transaction_t *transaction,
@@ -1320,6 +1620,7 @@ bool storage_db_op_rmw_commit_metadata(
         storage_db_op_rmw_status_t *rmw_status) {
     if (rmw_status->current_entry_index && !rmw_status->delete_entry_index_on_abort) {
         storage_db_entry_index_touch(rmw_status->current_entry_index);
+        rmw_status->current_entry_index->version = storage_db_entry_index_version_next();
     }
 
     hashtable_mcmp_op_rmw_commit_update(
@@ -1329,11 +1630,60 @@ bool storage_db_op_rmw_commit_metadata(
     return true;
 }
 
-bool storage_db_op_rmw_commit_update(
+bool storage_db_op_rmw_current_entry_index_can_be_updated_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        uint32_t owned_readers_counter) {
+    storage_db_entry_index_t *entry_index = rmw_status->current_entry_index;
+
+    if (entry_index == NULL || rmw_status->delete_entry_index_on_abort) {
+        return false;
+    }
+
+    // Only the chunks in memory, or the values kept as data structures, can be patched directly, the snapshot expects
+    // the entries it hasn't processed yet to be replaced and not changed
+    if (
+            (db->config->backend_type != STORAGE_DB_BACKEND_TYPE_MEMORY && entry_index->value_object == NULL) ||
+            storage_db_snapshot_is_in_progress(db)) {
+        return false;
+    }
+
+    // The readers fetch the entry index and increase the readers counter holding the lock for read, as the lock for
+    // write is held by the rmw operation no new reader can show up till the operation is committed or aborted, the
+    // caller might be holding its own readers
+    MEMORY_FENCE_LOAD();
+    return entry_index->status.readers_counter == owned_readers_counter;
+}
+
+bool storage_db_op_rmw_commit_update_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t previous_value_size) {
+    storage_db_entry_index_t *entry_index = rmw_status->current_entry_index;
+    size_t value_size = entry_index->value.size;
+
+    storage_db_entry_index_touch(entry_index);
+    entry_index->version = storage_db_entry_index_version_next();
+
+    hashtable_mcmp_op_rmw_commit_update(
+            &rmw_status->hashtable,
+            (uintptr_t)entry_index);
+
+    STORAGE_DB_COUNTERS_UPDATE(db, rmw_status->hashtable.database_number, {
+        counters->data_size += (int64_t)value_size - (int64_t)previous_value_size;
+        counters->keys_changed++;
+        counters->data_changed += (int64_t)value_size;
+    });
+
+    return true;
+}
+
+static bool storage_db_op_rmw_commit_update_internal(
         storage_db_t *db,
         storage_db_op_rmw_status_t *rmw_status,
         storage_db_entry_index_value_type_t value_type,
         storage_db_chunk_sequence_t *value_chunk_sequence,
+        void *value_object,
         storage_db_expiry_time_ms_t expiry_time_ms) {
     storage_db_entry_index_t *entry_index = NULL;
     bool result_res = false;
@@ -1372,9 +1722,11 @@ bool storage_db_op_rmw_commit_update(
 
     // Fetch a new entry and assign the key and the value as needed
     entry_index->database_number = rmw_status->hashtable.database_number;
+    entry_index->value_type = value_type;
     entry_index->value.size = value_chunk_sequence->size;
     entry_index->value.count = value_chunk_sequence->count;
     entry_index->value.sequence = value_chunk_sequence->sequence;
+    entry_index->value_object = value_object;
     entry_index->expiry_time_ms = expiry_time_ms;
 
     storage_db_entry_index_touch(entry_index);
@@ -1419,10 +1771,46 @@ end:
     return result_res;
 }
 
+bool storage_db_op_rmw_commit_update(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_entry_index_value_type_t value_type,
+        storage_db_chunk_sequence_t *value_chunk_sequence,
+        storage_db_expiry_time_ms_t expiry_time_ms) {
+    return storage_db_op_rmw_commit_update_internal(
+            db,
+            rmw_status,
+            value_type,
+            value_chunk_sequence,
+            NULL,
+            expiry_time_ms);
+}
+
+bool storage_db_op_rmw_commit_update_value_object(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_entry_index_value_type_t value_type,
+        void *value_object,
+        size_t value_size,
+        storage_db_expiry_time_ms_t expiry_time_ms) {
+    storage_db_chunk_sequence_t value_chunk_sequence = { .count = 0, .sequence = NULL, .size = value_size };
+
+    return storage_db_op_rmw_commit_update_internal(
+            db,
+            rmw_status,
+            value_type,
+            &value_chunk_sequence,
+            value_object,
+            expiry_time_ms);
+}
+
 void storage_db_op_rmw_commit_rename(
         storage_db_t *db,
         storage_db_op_rmw_status_t *rmw_status_source,
         storage_db_op_rmw_status_t *rmw_status_destination) {
+    // The entry index is moved to the destination key, which is therefore changed
+    rmw_status_source->current_entry_index->version = storage_db_entry_index_version_next();
+
     hashtable_mcmp_op_rmw_commit_update(
             &rmw_status_destination->hashtable,
             (uintptr_t)rmw_status_source->current_entry_index);
@@ -1627,6 +2015,9 @@ bool storage_db_op_flush_sync(
             db->hashtable,
             database_number,
             bucket_index)) != HASHTABLE_OP_ITER_END) {
+        // No transaction is held at this point, so it's safe to let the other fibers run if the flush is taking long
+        fiber_scheduler_yield_if_time_slice_expired();
+
         // To avoid long-running transactions, a transaction is created and destroyed for each entry
         transaction_t transaction = {0};
         transaction_acquire(&transaction);
@@ -1696,6 +2087,9 @@ storage_db_key_and_key_length_t *storage_db_op_get_keys(
 
     // Iterates over the hashtable to free up the entry index
     do {
+        // No transaction is held at this point, so it's safe to let the other fibers run if the scan is taking long
+        fiber_scheduler_yield_if_time_slice_expired();
+
         hashtable_bucket_index_t bucket_index = hashtable_mcmp_op_iter(
                 db->hashtable,
                 database_number,
@@ -25,6 +25,7 @@ extern "C" {
 #define STORAGE_DB_WORKER_ENTRY_INDEX_RING_BUFFER_SIZE 512
 
 #define STORAGE_DB_ENTRY_NO_EXPIRY (0)
+#define STORAGE_DB_ENTRY_INDEX_VERSION_NONE (0)
 
 typedef uint32_t storage_db_database_number_t;
 typedef uint16_t storage_db_chunk_index_t;
@@ -35,6 +36,8 @@ typedef uint64_t storage_db_create_time_ms_t;
 typedef uint64_t storage_db_last_access_time_ms_t;
 typedef uint64_t storage_db_snapshot_time_ms_t;
 typedef int64_t storage_db_expiry_time_ms_t;
+typedef uint64_t storage_db_entry_index_version_t;
+typedef hashtable_chunk_index_t storage_db_key_lock_index_t;
 
 struct storage_db_keys_eviction_kv_list_entry {
     uint64_t value;
@@ -81,7 +84,8 @@ enum storage_db_entry_index_value_type {
     STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING = 2,
     STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST = 3,
     STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET = 4,
-    STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET = 5
+    STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET = 5,
+    STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET = 6
 };
 typedef enum storage_db_entry_index_value_type storage_db_entry_index_value_type_t;
 
@@ -244,8 +248,14 @@ struct storage_db_entry_index {
     storage_db_expiry_time_ms_t expiry_time_ms;
     storage_db_last_access_time_ms_t last_access_time_ms;
     storage_db_snapshot_time_ms_t snapshot_time_ms;
+    // Stamp changed every time the entry index is created or its metadata are updated, it's used to detect if a key
+    // has been modified without having to keep track of who is watching it
+    storage_db_entry_index_version_t version;
     storage_db_chunk_sequence_t key;
     storage_db_chunk_sequence_t value;
+    // Values kept as data structures (the sorted sets) instead of being serialized into the chunks, the value chunk
+    // sequence is empty and its size tracks the memory used by the data structure
+    void *value_object;
 };
 
 typedef struct storage_db_op_rmw_transaction storage_db_op_rmw_status_t;
@@ -394,6 +404,37 @@ char *storage_db_get_chunk_data(
         storage_db_chunk_info_t *chunk_info,
         bool *allocated_new_buffer);
 
+char *storage_db_chunk_sequence_read_all(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        bool *allocated_new_buffer);
+
+bool storage_db_chunk_sequence_write_all(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *buffer,
+        size_t buffer_length);
+
+bool storage_db_chunk_sequence_read(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *buffer,
+        size_t offset,
+        size_t length);
+
+bool storage_db_chunk_sequence_write(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        size_t offset,
+        char *buffer,
+        size_t buffer_length);
+
+bool storage_db_chunk_sequence_append_in_place(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        char *buffer,
+        size_t buffer_length);
+
 void storage_db_chunk_sequence_free_chunks(
         storage_db_t *db,
         storage_db_chunk_sequence_t *sequence);
@@ -443,6 +484,25 @@ storage_db_entry_index_t *storage_db_get_entry_index_for_read(
         char *key,
         size_t key_length);
 
+storage_db_entry_index_version_t storage_db_get_entry_index_version(
+        storage_db_t *db,
+        storage_db_database_number_t database_number,
+        transaction_t *transaction,
+        char *key,
+        size_t key_length);
+
+storage_db_key_lock_index_t storage_db_get_key_lock_index(
+        storage_db_t *db,
+        storage_db_database_number_t database_number,
+        char *key,
+        size_t key_length);
+
+bool storage_db_lock_keys_for_write(
+        storage_db_t *db,
+        transaction_t *transaction,
+        storage_db_key_lock_index_t *key_lock_indexes,
+        uint32_t key_lock_indexes_count);
+
 bool storage_db_set_entry_index(
         storage_db_t *db,
         storage_db_database_number_t database_number,
@@ -461,6 +521,17 @@ bool storage_db_op_set(
         storage_db_chunk_sequence_t *value_chunk_sequence,
         storage_db_expiry_time_ms_t expiry_time_ms);
 
+bool storage_db_op_set_value_object(
+        storage_db_t *db,
+        storage_db_database_number_t database_number,
+        transaction_t *transaction,
+        char *key,
+        size_t key_length,
+        storage_db_entry_index_value_type_t value_type,
+        void *value_object,
+        size_t value_size,
+        storage_db_expiry_time_ms_t expiry_time_ms);
+
 bool storage_db_op_rmw_begin(
         storage_db_t *db,
         transaction_t *transaction,
@@ -479,6 +550,16 @@ bool storage_db_op_rmw_commit_metadata(
         storage_db_t *db,
         storage_db_op_rmw_status_t *rmw_status);
 
+bool storage_db_op_rmw_current_entry_index_can_be_updated_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        uint32_t owned_readers_counter);
+
+bool storage_db_op_rmw_commit_update_in_place(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        size_t previous_value_size);
+
 bool storage_db_op_rmw_commit_update(
         storage_db_t *db,
         storage_db_op_rmw_status_t *rmw_status,
@@ -486,6 +567,14 @@ bool storage_db_op_rmw_commit_update(
         storage_db_chunk_sequence_t *value_chunk_sequence,
         storage_db_expiry_time_ms_t expiry_time_ms);
 
+bool storage_db_op_rmw_commit_update_value_object(
+        storage_db_t *db,
+        storage_db_op_rmw_status_t *rmw_status,
+        storage_db_entry_index_value_type_t value_type,
+        void *value_object,
+        size_t value_size,
+        storage_db_expiry_time_ms_t expiry_time_ms);
+
 void storage_db_op_rmw_commit_rename(
         storage_db_t *db,
         storage_db_op_rmw_status_t *rmw_status_source,
@@ -34,6 +34,11 @@
 #include "data_structures/queue_mpmc/queue_mpmc.h"
 #include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
 #include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "data_structures/packed_list/packed_list.h"
+#include "data_structures/packed_set/packed_set.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
 #include "log/log.h"
 #include "config.h"
 #include "storage/io/storage_io_common.h"
@@ -421,6 +426,26 @@ bool storage_db_snapshot_rdb_ensure_prepared(
     return storage_db_snapshot_rdb_prepare(db);
 }
 
+static module_redis_snapshot_value_type_t storage_db_snapshot_rdb_value_type(
+        storage_db_entry_index_t *entry_index) {
+    switch(entry_index->value_type) {
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST:
+            return MODULE_REDIS_SNAPSHOT_VALUE_TYPE_LIST;
+
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET:
+            return MODULE_REDIS_SNAPSHOT_VALUE_TYPE_HASH;
+
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET:
+            return MODULE_REDIS_SNAPSHOT_VALUE_TYPE_SET;
+
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET:
+            return MODULE_REDIS_SNAPSHOT_VALUE_TYPE_ZSET_2;
+
+        default:
+            return MODULE_REDIS_SNAPSHOT_VALUE_TYPE_STRING;
+    }
+}
+
 bool storage_db_snapshot_rdb_write_value_header(
         storage_db_t *db,
         char *key,
@@ -463,7 +488,7 @@ bool storage_db_snapshot_rdb_write_value_header(
 
     // Serialize and write the value type opcode
     if (module_redis_snapshot_serialize_primitive_encode_opcode_value_type(
-            MODULE_REDIS_SNAPSHOT_VALUE_TYPE_STRING,
+            storage_db_snapshot_rdb_value_type(entry_index),
             (uint8_t*)buffer,
             buffer_size,
             buffer_offset,
@@ -668,6 +693,235 @@ end:
     return result;
 }
 
+static bool storage_db_snapshot_rdb_write_length(
+        storage_db_t *db,
+        uint64_t length) {
+    storage_buffered_channel_buffer_data_t *buffer;
+    size_t buffer_size = 128;
+    size_t buffer_offset = 0;
+
+    if ((buffer = storage_buffered_write_buffer_acquire_slice(
+            db->snapshot.storage_buffered_channel,
+            buffer_size)) == NULL) {
+        LOG_E(TAG, "Failed to acquire a slice for the length");
+        return false;
+    }
+
+    if (unlikely(module_redis_snapshot_serialize_primitive_encode_length(
+            length,
+            (uint8_t*)buffer,
+            buffer_size,
+            0,
+            &buffer_offset) != MODULE_REDIS_SNAPSHOT_SERIALIZE_PRIMITIVE_RESULT_OK)) {
+        LOG_E(TAG, "Failed to write the length");
+        return false;
+    }
+
+    storage_db_snapshot_rdb_release_slice(db, buffer_offset);
+
+    return true;
+}
+
+static bool storage_db_snapshot_rdb_write_string(
+        storage_db_t *db,
+        char *string,
+        size_t string_length) {
+    storage_buffered_channel_buffer_data_t *buffer;
+
+    if (unlikely(!storage_db_snapshot_rdb_write_length(db, string_length))) {
+        return false;
+    }
+
+    // The string is written in slices not larger than a chunk as the slices can't be larger than the write buffer
+    for(size_t offset = 0; offset < string_length; offset += STORAGE_DB_CHUNK_MAX_SIZE) {
+        size_t slice_length = MIN(string_length - offset, STORAGE_DB_CHUNK_MAX_SIZE);
+
+        if ((buffer = storage_buffered_write_buffer_acquire_slice(
+                db->snapshot.storage_buffered_channel,
+                slice_length)) == NULL) {
+            LOG_E(TAG, "Failed to acquire a slice for the string data");
+            return false;
+        }
+
+        memcpy(buffer, string + offset, slice_length);
+        storage_db_snapshot_rdb_release_slice(db, slice_length);
+    }
+
+    return true;
+}
+
+bool storage_db_snapshot_rdb_write_value_hash(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index) {
+    bool result = false;
+    bool allocated_new_buffer = false;
+    size_t offset = 0;
+    packed_hash_t packed_hash;
+    packed_hash_entry_t entry;
+
+    char *data = storage_db_chunk_sequence_read_all(db, &entry_index->value, &allocated_new_buffer);
+    if (unlikely(!data)) {
+        LOG_E(TAG, "Failed to read the hash data");
+        goto end;
+    }
+
+    if (unlikely(!packed_hash_init(&packed_hash, data, entry_index->value.size))) {
+        LOG_E(TAG, "Failed to parse the hash data");
+        goto end;
+    }
+
+    // The hashes are serialized using the plain RDB hash encoding, the number of fields followed by the fields and the
+    // values as strings
+    if (unlikely(!storage_db_snapshot_rdb_write_length(db, packed_hash.count))) {
+        goto end;
+    }
+
+    while(packed_hash_iter_next(&packed_hash, &offset, &entry)) {
+        if (unlikely(!storage_db_snapshot_rdb_write_string(db, entry.field, entry.field_length))) {
+            goto end;
+        }
+
+        if (unlikely(!storage_db_snapshot_rdb_write_string(db, entry.value, entry.value_length))) {
+            goto end;
+        }
+    }
+
+    result = true;
+
+end:
+    if (allocated_new_buffer) {
+        xalloc_free(data);
+    }
+
+    return result;
+}
+
+bool storage_db_snapshot_rdb_write_value_list(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index) {
+    bool result = false;
+    bool allocated_new_buffer = false;
+    packed_list_t packed_list;
+    packed_list_iter_t iter;
+    packed_list_entry_t entry;
+
+    char *data = storage_db_chunk_sequence_read_all(db, &entry_index->value, &allocated_new_buffer);
+    if (unlikely(!data)) {
+        LOG_E(TAG, "Failed to read the list data");
+        goto end;
+    }
+
+    if (unlikely(!packed_list_init(&packed_list, data, entry_index->value.size))) {
+        LOG_E(TAG, "Failed to parse the list data");
+        goto end;
+    }
+
+    // The lists are serialized using the plain RDB list encoding, the number of elements followed by the elements as
+    // strings
+    if (unlikely(!storage_db_snapshot_rdb_write_length(db, packed_list.count))) {
+        goto end;
+    }
+
+    if (packed_list_iter_init(&packed_list, &iter, 0)) {
+        while(packed_list_iter_next(&iter, &entry)) {
+            if (unlikely(!storage_db_snapshot_rdb_write_string(db, entry.value, entry.value_length))) {
+                goto end;
+            }
+        }
+    }
+
+    result = true;
+
+end:
+    if (allocated_new_buffer) {
+        xalloc_free(data);
+    }
+
+    return result;
+}
+
+bool storage_db_snapshot_rdb_write_value_set(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index) {
+    bool result = false;
+    bool allocated_new_buffer = false;
+    size_t offset = 0;
+    packed_set_t packed_set;
+    packed_set_member_t member;
+
+    char *data = storage_db_chunk_sequence_read_all(db, &entry_index->value, &allocated_new_buffer);
+    if (unlikely(!data)) {
+        LOG_E(TAG, "Failed to read the set data");
+        goto end;
+    }
+
+    if (unlikely(!packed_set_init(&packed_set, data, entry_index->value.size))) {
+        LOG_E(TAG, "Failed to parse the set data");
+        goto end;
+    }
+
+    // The sets are serialized using the plain RDB set encoding, the number of members followed by the members as
+    // strings, the integers of the intsets are converted to strings
+    if (unlikely(!storage_db_snapshot_rdb_write_length(db, packed_set.count))) {
+        goto end;
+    }
+
+    while(packed_set_iter_next(&packed_set, &offset, &member)) {
+        char integer_buffer[PACKED_SET_INTEGER_MAX_LENGTH + 1];
+
+        if (member.is_integer) {
+            member.value = integer_buffer;
+            member.value_length = packed_set_integer_to_string(member.integer, integer_buffer);
+        }
+
+        if (unlikely(!storage_db_snapshot_rdb_write_string(db, member.value, member.value_length))) {
+            goto end;
+        }
+    }
+
+    result = true;
+
+end:
+    if (allocated_new_buffer) {
+        xalloc_free(data);
+    }
+
+    return result;
+}
+
+bool storage_db_snapshot_rdb_write_value_sorted_set(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index) {
+    storage_buffered_channel_buffer_data_t *buffer;
+    sorted_set_t *sorted_set = entry_index->value_object;
+
+    // The snapshot holds a reader on the entry index, the writers copy the sorted set instead of changing it while the
+    // snapshot is in progress, so it can be walked directly.
+    // The sorted sets are serialized using the RDB ZSET_2 encoding, the number of members followed by the members as
+    // strings, each one followed by its score as a binary little endian double
+    if (unlikely(!storage_db_snapshot_rdb_write_length(db, sorted_set->count))) {
+        return false;
+    }
+
+    for(sorted_set_node_t *node = sorted_set_first(sorted_set); node; node = sorted_set_next(node)) {
+        if (unlikely(!storage_db_snapshot_rdb_write_string(db, node->member, node->member_length))) {
+            return false;
+        }
+
+        if ((buffer = storage_buffered_write_buffer_acquire_slice(
+                db->snapshot.storage_buffered_channel,
+                sizeof(node->score))) == NULL) {
+            LOG_E(TAG, "Failed to acquire a slice for the score");
+            return false;
+        }
+
+        memcpy(buffer, &node->score, sizeof(node->score));
+        storage_db_snapshot_rdb_release_slice(db, sizeof(node->score));
+    }
+
+    return true;
+}
+
 bool storage_db_snapshot_rdb_write_database_number(
         storage_db_t *db,
         storage_db_database_number_t database_number) {
@@ -730,10 +984,27 @@ bool storage_db_snapshot_rdb_process_entry_index(
     }
 
     // Depending on the value type, serialize the data
-    assert(entry_index->value_type == 0);
-    if (!storage_db_snapshot_rdb_write_value_string(db, entry_index)) {
-        result = false;
-        goto end;
+    switch(entry_index->value_type) {
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST:
+            result = storage_db_snapshot_rdb_write_value_list(db, entry_index);
+            break;
+
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET:
+            result = storage_db_snapshot_rdb_write_value_hash(db, entry_index);
+            break;
+
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET:
+            result = storage_db_snapshot_rdb_write_value_set(db, entry_index);
+            break;
+
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET:
+            result = storage_db_snapshot_rdb_write_value_sorted_set(db, entry_index);
+            break;
+
+        default:
+            assert(entry_index->value_type == STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING);
+            result = storage_db_snapshot_rdb_write_value_string(db, entry_index);
+            break;
     }
 
 end:
@@ -64,6 +64,22 @@ bool storage_db_snapshot_rdb_write_value_string(
         storage_db_t *db,
         storage_db_entry_index_t *entry_index);
 
+bool storage_db_snapshot_rdb_write_value_list(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index);
+
+bool storage_db_snapshot_rdb_write_value_hash(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index);
+
+bool storage_db_snapshot_rdb_write_value_set(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index);
+
+bool storage_db_snapshot_rdb_write_value_sorted_set(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index);
+
 bool storage_db_snapshot_rdb_write_database_number(
         storage_db_t *db,
         storage_db_database_number_t database_number);
@@ -26,6 +26,8 @@ const char* minimum_kernel_version_IORING_FEAT_FAST_POLL = "5.7.0";
 const char* minimum_kernel_version_IORING_SQPOLL = "5.11.0";
 const char* minimum_kernel_version_IORING_SETUP_COOP_TASKRUN = "5.19.0";
 const char* minimum_kernel_version_IORING_SETUP_SINGLE_ISSURE = "6.0.0";
+const char* minimum_kernel_version_IORING_SETUP_DEFER_TASKRUN = "6.1.0";
+const char* minimum_kernel_version_IORING_OP_MSG_RING = "5.18.0";
 
 #define TAG "io_uring_capabilities"
 
@@ -211,3 +213,32 @@ bool io_uring_capabilities_is_single_issuer_supported() {
     return true;
 }
 
+bool io_uring_capabilities_is_defer_taskrun_supported() {
+    long kernel_version[4] = {0};
+
+    // IORING_SETUP_DEFER_TASKRUN requires the kernel 6.1
+    version_parse(
+            (char*)minimum_kernel_version_IORING_SETUP_DEFER_TASKRUN,
+            (long*)kernel_version,
+            sizeof(kernel_version));
+    if (!version_kernel_min(kernel_version, 3)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool io_uring_capabilities_is_msg_ring_supported() {
+    long kernel_version[4] = {0};
+
+    // IORING_OP_MSG_RING requires the kernel 5.18
+    version_parse(
+            (char*)minimum_kernel_version_IORING_OP_MSG_RING,
+            (long*)kernel_version,
+            sizeof(kernel_version));
+    if (!version_kernel_min(kernel_version, 3)) {
+        return false;
+    }
+
+    return true;
+}
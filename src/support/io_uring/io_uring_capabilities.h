@@ -28,6 +28,10 @@ bool io_uring_capabilities_is_setup_taskrun_supported();
 
 bool io_uring_capabilities_is_single_issuer_supported();
 
+bool io_uring_capabilities_is_defer_taskrun_supported();
+
+bool io_uring_capabilities_is_msg_ring_supported();
+
 #ifdef __cplusplus
 }
 #endif
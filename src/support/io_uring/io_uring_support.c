@@ -196,6 +196,27 @@ bool io_uring_support_sqe_enqueue_link_timeout(
     return true;
 }
 
+bool io_uring_support_sqe_enqueue_msg_ring(
+        io_uring_t *ring,
+        int target_ring_fd,
+        uint32_t cqe_res,
+        uint64_t cqe_user_data,
+        uint8_t sqe_flags,
+        uint64_t user_data) {
+    io_uring_sqe_t *sqe = io_uring_support_get_sqe(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+
+    // The target ring will receive a cqe with res set to cqe_res and user_data set to cqe_user_data, the ring submitting
+    // the operation will instead receive a cqe with the outcome of the operation and user_data set to user_data
+    io_uring_prep_msg_ring(sqe, target_ring_fd, cqe_res, cqe_user_data, 0);
+    io_uring_sqe_set_flags(sqe, sqe_flags);
+    sqe->user_data = user_data;
+
+    return true;
+}
+
 bool io_uring_support_sqe_enqueue_nop(
         io_uring_t *ring,
         uint8_t sqe_flags,
@@ -214,6 +235,7 @@ bool io_uring_support_sqe_enqueue_nop(
 
 bool io_uring_support_sqe_enqueue_cancel(
         io_uring_t *ring,
+        uint64_t target_user_data,
         uint8_t sqe_flags,
         uint64_t user_data) {
     io_uring_sqe_t *sqe = io_uring_support_get_sqe(ring);
@@ -221,7 +243,7 @@ bool io_uring_support_sqe_enqueue_cancel(
         return false;
     }
 
-    io_uring_prep_cancel64(sqe, user_data, 0);
+    io_uring_prep_cancel64(sqe, target_user_data, 0);
     io_uring_sqe_set_flags(sqe, sqe_flags);
     sqe->user_data = user_data;
 
@@ -287,6 +309,24 @@ bool io_uring_support_sqe_enqueue_recv(
     return true;
 }
 
+bool io_uring_support_sqe_enqueue_poll_add(
+        io_uring_t *ring,
+        int fd,
+        uint32_t poll_mask,
+        uint8_t sqe_flags,
+        uint64_t user_data) {
+    io_uring_sqe_t *sqe = io_uring_support_get_sqe(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+
+    io_uring_prep_poll_add(sqe, fd, poll_mask);
+    io_uring_sqe_set_flags(sqe, sqe_flags);
+    sqe->user_data = user_data;
+
+    return true;
+}
+
 bool io_uring_support_sqe_enqueue_send(
         io_uring_t *ring,
         int fd,
@@ -59,6 +59,14 @@ bool io_uring_support_sqe_enqueue_link_timeout(
         uint8_t sqe_flags,
         uint64_t user_data);
 
+bool io_uring_support_sqe_enqueue_msg_ring(
+        io_uring_t *ring,
+        int target_ring_fd,
+        uint32_t cqe_res,
+        uint64_t cqe_user_data,
+        uint8_t sqe_flags,
+        uint64_t user_data);
+
 bool io_uring_support_sqe_enqueue_nop(
         io_uring_t *ring,
         uint8_t sqe_flags,
@@ -66,6 +74,7 @@ bool io_uring_support_sqe_enqueue_nop(
 
 bool io_uring_support_sqe_enqueue_cancel(
         io_uring_t *ring,
+        uint64_t target_user_data,
         uint8_t sqe_flags,
         uint64_t user_data);
 
@@ -87,6 +96,13 @@ bool io_uring_support_sqe_enqueue_recv(
         uint8_t sqe_flags,
         uint64_t user_data);
 
+bool io_uring_support_sqe_enqueue_poll_add(
+        io_uring_t *ring,
+        int fd,
+        uint32_t poll_mask,
+        uint8_t sqe_flags,
+        uint64_t user_data);
+
 bool io_uring_support_sqe_enqueue_send(
         io_uring_t *ring,
         int fd,
@@ -17,13 +17,17 @@
 #include "exttypes.h"
 #include "clock.h"
 #include "config.h"
+#include "spinlock.h"
+#include "log/log.h"
 #include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
 #include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
 #include "data_structures/double_linked_list/double_linked_list.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
 #include "worker/worker_stats.h"
 #include "worker/worker_context.h"
 #include "worker/worker.h"
+#include "worker/worker_mailbox.h"
 
 #include "transaction.h"
 
@@ -33,6 +37,12 @@ thread_local uint32_t transaction_manager_worker_index = 0;
 thread_local uint16_t transaction_manager_transaction_index = 0;
 thread_local bool_volatile_t transaction_manager_inited = false;
 
+transaction_rwspinlock_parking_lot_bucket_t transaction_rwspinlock_parking_lot[TRANSACTION_RWSPINLOCK_PARKING_LOT_BUCKETS] = { 0 };
+
+// Only the address matters, it's used to identify the thread a parked fiber belongs to also when the code is not
+// running within a worker
+static thread_local uint8_t transaction_rwspinlock_parking_lot_thread_marker = 0;
+
 void transaction_set_worker_index(
         uint32_t worker_index) {
     transaction_manager_worker_index = worker_index;
@@ -53,10 +63,117 @@ bool transaction_expand_locks_list(
     return transaction->locks.list != NULL;
 }
 
+bool transaction_rwspinlock_park(
+        transaction_rwspinlock_volatile_t *spinlock,
+        bool wait_for_readers,
+        uint16_t expected_readers) {
+    transaction_rwspinlock_t current_value;
+    transaction_rwspinlock_parked_fiber_t parked_fiber;
+    worker_context_t *worker_context = worker_context_get();
+    transaction_rwspinlock_parking_lot_bucket_t *bucket = transaction_rwspinlock_parking_lot_get_bucket(spinlock);
+
+    // When the code is not running within a worker fiber there is nothing that would resume it, the caller keeps
+    // spinning
+    if (!fiber_scheduler_can_yield()) {
+        return false;
+    }
+
+    // The entry lives on the stack of the fiber, which is kept around until the fiber is woken up
+    parked_fiber.spinlock = spinlock;
+    parked_fiber.fiber = fiber_scheduler_get_current();
+    parked_fiber.thread_marker = &transaction_rwspinlock_parking_lot_thread_marker;
+    parked_fiber.worker_index = worker_context != NULL ? worker_context->worker_index : UINT32_MAX;
+
+    spinlock_lock(&bucket->lock);
+
+    // The waiters count is incremented before checking the lock again, the release path does the opposite, it updates
+    // the lock and then checks the waiters count, so either the release is seen here or the waiter is seen there
+    __atomic_fetch_add(&bucket->waiters_count, 1, __ATOMIC_SEQ_CST);
+    current_value.atomic_var = __atomic_load_n(&spinlock->atomic_var, __ATOMIC_SEQ_CST);
+
+    if (current_value.internal_data.transaction_id == TRANSACTION_SPINLOCK_UNLOCKED &&
+        (!wait_for_readers || current_value.internal_data.readers_count == expected_readers)) {
+        __atomic_fetch_sub(&bucket->waiters_count, 1, __ATOMIC_SEQ_CST);
+        spinlock_unlock(&bucket->lock);
+
+        return false;
+    }
+
+    parked_fiber.next = bucket->head;
+    bucket->head = &parked_fiber;
+
+    spinlock_unlock(&bucket->lock);
+
+    // The fiber is not put in the ready queue, it will be resumed only once woken up by the release of the lock
+    fiber_scheduler_switch_back();
+
+    return true;
+}
+
+void transaction_rwspinlock_unpark_mailbox_fp(
+        void *user_data) {
+    fiber_scheduler_enqueue_ready((fiber_t*)user_data);
+}
+
+void transaction_rwspinlock_unpark(
+        transaction_rwspinlock_volatile_t *spinlock) {
+    transaction_rwspinlock_parked_fiber_t *parked_fiber, *next_parked_fiber, **parked_fiber_ptr;
+    transaction_rwspinlock_parked_fiber_t *unparked_fibers = NULL;
+    transaction_rwspinlock_parking_lot_bucket_t *bucket = transaction_rwspinlock_parking_lot_get_bucket(spinlock);
+
+    spinlock_lock(&bucket->lock);
+
+    // The bucket is shared with other locks, only the fibers waiting for this lock are unlinked
+    parked_fiber_ptr = &bucket->head;
+    while((parked_fiber = *parked_fiber_ptr) != NULL) {
+        if (parked_fiber->spinlock != spinlock) {
+            parked_fiber_ptr = &parked_fiber->next;
+            continue;
+        }
+
+        *parked_fiber_ptr = parked_fiber->next;
+        parked_fiber->next = unparked_fibers;
+        unparked_fibers = parked_fiber;
+
+        __atomic_fetch_sub(&bucket->waiters_count, 1, __ATOMIC_SEQ_CST);
+    }
+
+    spinlock_unlock(&bucket->lock);
+
+    // The entries live on the stack of the parked fibers, once a fiber is woken up its entry can't be accessed anymore
+    for(parked_fiber = unparked_fibers; parked_fiber != NULL; parked_fiber = next_parked_fiber) {
+        fiber_t *fiber = parked_fiber->fiber;
+        uint32_t worker_index = parked_fiber->worker_index;
+        bool is_local = parked_fiber->thread_marker == &transaction_rwspinlock_parking_lot_thread_marker;
+        next_parked_fiber = parked_fiber->next;
+
+        // A fiber parked on the current thread is put in the ready queue and resumed by the worker loop, the fibers
+        // parked on the other workers are handed over to their mailbox, they can't be touched from here
+        if (is_local) {
+            fiber_scheduler_enqueue_ready(fiber);
+        } else if (unlikely(!worker_mailbox_post(
+                worker_index,
+                transaction_rwspinlock_unpark_mailbox_fp,
+                fiber))) {
+            // The mailbox never drops a message, posting fails only if the lock has been released by a thread that is
+            // not a worker
+            LOG_E(TAG, "Unable to wake up the fiber parked on the worker <%u>", worker_index);
+        }
+    }
+}
+
 uint16_t transaction_peek_current_thread_index() {
     return transaction_manager_transaction_index;
 }
 
+static inline __attribute__((always_inline)) transaction_t *transaction_get_nesting_parent() {
+    if (likely(!fiber_scheduler_is_in_fiber())) {
+        return NULL;
+    }
+
+    return fiber_scheduler_get_current()->transaction;
+}
+
 bool transaction_acquire(
         transaction_t *transaction) {
     if (unlikely(transaction_manager_inited == false)) {
@@ -64,16 +181,23 @@ bool transaction_acquire(
         transaction_manager_inited = true;
     }
 
-    transaction_manager_transaction_index++;
+    transaction->parent = transaction_get_nesting_parent();
 
-    // Having both the worker index and the transaction index to 0 matches the transaction id not acquired value
-    // therefore we need to increment the transaction index by 1 to avoid it
-    if (unlikely(transaction_manager_worker_index == 0 && transaction_manager_transaction_index == 0)) {
+    if (unlikely(transaction->parent != NULL)) {
+        // The nested transaction shares the id with the parent so the locks already owned by the parent are re-entrant
+        transaction->transaction_id.id = transaction->parent->transaction_id.id;
+    } else {
         transaction_manager_transaction_index++;
-    }
 
-    transaction->transaction_id.worker_index = transaction_manager_worker_index;
-    transaction->transaction_id.transaction_index = transaction_manager_transaction_index;
+        // Having both the worker index and the transaction index to 0 matches the transaction id not acquired value
+        // therefore we need to increment the transaction index by 1 to avoid it
+        if (unlikely(transaction_manager_worker_index == 0 && transaction_manager_transaction_index == 0)) {
+            transaction_manager_transaction_index++;
+        }
+
+        transaction->transaction_id.worker_index = transaction_manager_worker_index;
+        transaction->transaction_id.transaction_index = transaction_manager_transaction_index;
+    }
 
     transaction->locks.size = 2;
     transaction->locks.count = 0;
@@ -96,6 +220,17 @@ void transaction_release(
         assert(entry->lock_type != TRANSACTION_LOCK_TYPE_NONE);
         assert(entry->spinlock != NULL);
 
+        // The locks of a nested transaction are handed over to the parent, they will be released together with the
+        // ones of the parent, if the list of the parent can't be expanded the lock is released right away
+        if (unlikely(transaction->parent != NULL)) {
+            if (likely(transaction_locks_list_add(
+                    transaction->parent,
+                    entry->spinlock,
+                    entry->lock_type))) {
+                continue;
+            }
+        }
+
         // There are always going to be more read locks than write locks
         if (unlikely(entry->lock_type == TRANSACTION_LOCK_TYPE_WRITE)) {
             transaction_rwspinlock_unlock_internal(
@@ -112,5 +247,31 @@ void transaction_release(
     xalloc_free(transaction->locks.list);
 
     transaction->locks.list = NULL;
+    transaction->parent = NULL;
     transaction->transaction_id.id = TRANSACTION_ID_NOT_ACQUIRED;
 }
+
+bool transaction_nesting_begin(
+        transaction_t *transaction) {
+    assert(transaction->transaction_id.id != TRANSACTION_ID_NOT_ACQUIRED);
+
+    // The nesting is tracked per fiber as it might yield while holding the locks and the other fibers running on the
+    // same worker must not join the transaction
+    if (unlikely(!fiber_scheduler_is_in_fiber())) {
+        return false;
+    }
+
+    fiber_t *fiber = fiber_scheduler_get_current();
+    assert(fiber->transaction == NULL);
+    fiber->transaction = transaction;
+
+    return true;
+}
+
+void transaction_nesting_end(
+        transaction_t *transaction) {
+    fiber_t *fiber = fiber_scheduler_get_current();
+
+    assert(fiber->transaction == transaction);
+    fiber->transaction = NULL;
+}
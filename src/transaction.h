@@ -14,6 +14,15 @@ extern "C" {
 #define TRANSACTION_ID_NOT_ACQUIRED (0)
 #define TRANSACTION_SPINLOCK_UNLOCKED   (0)
 
+// Amount of spins after which a fiber waiting for a contended lock gets parked until the lock is released, it must be
+// a power of 2
+#define TRANSACTION_RWSPINLOCK_SPINS_BEFORE_PARK    (1 << 10)
+
+// The fibers waiting for a lock are tracked in a parking lot shared by all the workers, the lock address is hashed to
+// pick the bucket, the amount of buckets must be a power of 2
+#define TRANSACTION_RWSPINLOCK_PARKING_LOT_BUCKETS_BITS (10)
+#define TRANSACTION_RWSPINLOCK_PARKING_LOT_BUCKETS      (1 << TRANSACTION_RWSPINLOCK_PARKING_LOT_BUCKETS_BITS)
+
 static uint32_t max_spins_before_probably_stuck = 1 << 26;
 
 enum transaction_lock_type {
@@ -50,6 +59,24 @@ struct transaction_rwspinlock {
     };
 } __attribute__((aligned(8)));
 
+typedef struct transaction_rwspinlock_parked_fiber transaction_rwspinlock_parked_fiber_t;
+struct transaction_rwspinlock_parked_fiber {
+    transaction_rwspinlock_volatile_t *spinlock;
+    struct fiber *fiber;
+    void *thread_marker;
+    uint32_t worker_index;
+    transaction_rwspinlock_parked_fiber_t *next;
+};
+
+typedef struct transaction_rwspinlock_parking_lot_bucket transaction_rwspinlock_parking_lot_bucket_t;
+struct transaction_rwspinlock_parking_lot_bucket {
+    spinlock_lock_volatile_t lock;
+    uint32_volatile_t waiters_count;
+    transaction_rwspinlock_parked_fiber_t *head;
+} __attribute__((aligned(64)));
+
+extern transaction_rwspinlock_parking_lot_bucket_t transaction_rwspinlock_parking_lot[];
+
 typedef struct transaction_locks_list_entry transaction_locks_list_entry_t;
 struct transaction_locks_list_entry {
     transaction_rwspinlock_volatile_t *spinlock;
@@ -64,6 +91,9 @@ struct transaction {
         uint32_t size;
         transaction_locks_list_entry_t *list;
     } locks;
+    // Set if the transaction has been acquired by a fiber while nesting was enabled, the nested transaction shares the
+    // id with the parent and all the locks are handed over to the parent when released
+    transaction_t *parent;
 };
 
 static inline __attribute__((always_inline)) void transaction_rwspinlock_init(
@@ -72,6 +102,31 @@ static inline __attribute__((always_inline)) void transaction_rwspinlock_init(
     spinlock->internal_data.readers_count = 0;
 }
 
+bool transaction_rwspinlock_park(
+        transaction_rwspinlock_volatile_t *spinlock,
+        bool wait_for_readers,
+        uint16_t expected_readers);
+
+void transaction_rwspinlock_unpark(
+        transaction_rwspinlock_volatile_t *spinlock);
+
+static inline __attribute__((always_inline)) transaction_rwspinlock_parking_lot_bucket_t *transaction_rwspinlock_parking_lot_get_bucket(
+        transaction_rwspinlock_volatile_t *spinlock) {
+    return &transaction_rwspinlock_parking_lot[
+            ((uintptr_t)spinlock * 0x9E3779B97F4A7C15UL) >> (64 - TRANSACTION_RWSPINLOCK_PARKING_LOT_BUCKETS_BITS)];
+}
+
+static inline __attribute__((always_inline)) void transaction_rwspinlock_unpark_if_parked(
+        transaction_rwspinlock_volatile_t *spinlock) {
+    // The load has to be sequentially consistent to pair with the increment of the waiters count done when parking,
+    // either the release is seen by the waiter or the waiter is seen here
+    if (unlikely(__atomic_load_n(
+            &transaction_rwspinlock_parking_lot_get_bucket(spinlock)->waiters_count,
+            __ATOMIC_SEQ_CST) > 0)) {
+        transaction_rwspinlock_unpark(spinlock);
+    }
+}
+
 static inline __attribute__((always_inline)) void transaction_rwspinlock_unlock_internal(
         transaction_rwspinlock_volatile_t* spinlock
 #if DEBUG == 1
@@ -83,8 +138,8 @@ static inline __attribute__((always_inline)) void transaction_rwspinlock_unlock_
     assert(spinlock->internal_data.transaction_id == transaction->transaction_id.id);
 #endif
 
-    spinlock->internal_data.transaction_id = TRANSACTION_SPINLOCK_UNLOCKED;
-    MEMORY_FENCE_STORE();
+    __atomic_store_n(&spinlock->internal_data.transaction_id, TRANSACTION_SPINLOCK_UNLOCKED, __ATOMIC_SEQ_CST);
+    transaction_rwspinlock_unpark_if_parked(spinlock);
 }
 
 static inline __attribute__((always_inline)) bool transaction_rwspinlock_is_write_locked(
@@ -133,6 +188,10 @@ static inline __attribute__((always_inline)) bool transaction_rwspinlock_wait_wr
         uint32_t src_line) {
     uint64_t spins = 0;
     while (unlikely(transaction_rwspinlock_is_write_locked(spinlock))) {
+        if (unlikely((spins & (TRANSACTION_RWSPINLOCK_SPINS_BEFORE_PARK - 1)) == 0 && spins > 0)) {
+            transaction_rwspinlock_park(spinlock, false, 0);
+        }
+
         if (unlikely(spins++ == max_spins_before_probably_stuck)) {
             LOG_E("transaction_rwspinlock", "Possible transactional spinlock stuck detected for thread %lu in %s:%u",
                   syscall(__NR_gettid), src_path, src_line);
@@ -151,6 +210,10 @@ static inline __attribute__((always_inline)) bool transaction_rwspinlock_write_l
         uint32_t src_line) {
     uint64_t spins = 0;
     while (unlikely(!transaction_rwspinlock_try_write_lock_internal(spinlock, transaction, expected_readers))) {
+        if (unlikely((spins & (TRANSACTION_RWSPINLOCK_SPINS_BEFORE_PARK - 1)) == 0 && spins > 0)) {
+            transaction_rwspinlock_park(spinlock, true, expected_readers);
+        }
+
         if (unlikely(spins++ == max_spins_before_probably_stuck)) {
             LOG_E("transaction_rwspinlock", "Possible transactional spinlock stuck detected for thread %lu in %s:%u",
                   syscall(__NR_gettid), src_path, src_line);
@@ -171,6 +234,9 @@ static inline __attribute__((always_inline)) void transaction_rwspinlock_readers
         transaction_rwspinlock_volatile_t *spinlock) {
     assert(spinlock->internal_data.readers_count > 0);
     __sync_fetch_and_sub(&spinlock->internal_data.readers_count, 1);
+
+    // A writer might be parked waiting for the readers to go away
+    transaction_rwspinlock_unpark_if_parked(spinlock);
 }
 
 void transaction_set_worker_index(
@@ -187,6 +253,12 @@ bool transaction_acquire(
 void transaction_release(
         transaction_t* transaction);
 
+bool transaction_nesting_begin(
+        transaction_t *transaction);
+
+void transaction_nesting_end(
+        transaction_t *transaction);
+
 static inline __attribute__((always_inline)) bool transaction_needs_expand_locks_list(
         transaction_t* transaction) {
     return transaction->locks.count == transaction->locks.size;
@@ -218,18 +290,21 @@ static inline __attribute__((always_inline)) bool transaction_lock_for_write_int
         transaction_rwspinlock_volatile_t *transaction_rwspinlock,
         const char* src_path,
         uint32_t src_line) {
-
-    if (likely(!transaction_rwspinlock_is_owned_by_transaction(
+    // If the lock is already owned it has already been added to the locks list of the transaction, or of the parent
+    // one, adding it again would cause a double unlock on release
+    if (unlikely(transaction_rwspinlock_is_owned_by_transaction(
             transaction_rwspinlock,
             transaction))) {
-        if (unlikely(!transaction_rwspinlock_write_lock_internal(
-                transaction_rwspinlock,
-                transaction,
-                0,
-                src_path,
-                src_line))) {
-            return false;
-        }
+        return true;
+    }
+
+    if (unlikely(!transaction_rwspinlock_write_lock_internal(
+            transaction_rwspinlock,
+            transaction,
+            0,
+            src_path,
+            src_line))) {
+        return false;
     }
 
     if (!transaction_locks_list_add(
@@ -257,17 +332,19 @@ static inline __attribute__((always_inline)) bool transaction_upgrade_lock_for_w
     assert(transaction != NULL);
     assert(transaction_rwspinlock != NULL);
 
-    if (likely(!transaction_rwspinlock_is_owned_by_transaction(
+    if (unlikely(transaction_rwspinlock_is_owned_by_transaction(
             transaction_rwspinlock,
             transaction))) {
-        if (unlikely(!transaction_rwspinlock_write_lock_internal(
-                transaction_rwspinlock,
-                transaction,
-                1,
-                src_path,
-                src_line))) {
-            return false;
-        }
+        return true;
+    }
+
+    if (unlikely(!transaction_rwspinlock_write_lock_internal(
+            transaction_rwspinlock,
+            transaction,
+            1,
+            src_path,
+            src_line))) {
+        return false;
     }
 
     if (!transaction_locks_list_add(
@@ -295,6 +372,17 @@ static inline __attribute__((always_inline)) bool transaction_lock_for_read_inte
         uint32_t src_line) {
     assert(transaction != NULL);
     assert(transaction_rwspinlock != NULL);
+
+    // A nested transaction holds its locks until the parent is released, a read lock would have to be upgraded later
+    // on while other readers might be waiting for the locks held by the parent, so the lock is always taken for write
+    if (unlikely(transaction->parent != NULL)) {
+        return transaction_lock_for_write_internal(
+                transaction,
+                transaction_rwspinlock,
+                src_path,
+                src_line);
+    }
+
     assert(transaction->transaction_id.id != transaction_rwspinlock->internal_data.transaction_id);
 
     // Increment the readers count
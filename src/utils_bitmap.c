@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "misc.h"
+#include "cmake_config.h"
+#include "utils_string.h"
+
+#include "utils_bitmap.h"
+
+IFUNC_WRAPPER_RESOLVE(UTILS_BITMAP_NAME_IFUNC(popcount)) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F
+    // The 512 bit popcount is part of the VPOPCNTDQ extension, not of AVX512F
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+        return UTILS_BITMAP_NAME_IMPL(popcount, avx512);
+    }
+#endif
+    if (__builtin_cpu_supports("avx2")) {
+        return UTILS_BITMAP_NAME_IMPL(popcount, avx2);
+    }
+#endif
+
+    return UTILS_BITMAP_NAME_IMPL(popcount, loop);
+}
+
+uint64_t IFUNC_WRAPPER(UTILS_BITMAP_NAME_IFUNC(popcount), UTILS_BITMAP_POPCOUNT_ARGS);
+
+IFUNC_WRAPPER_RESOLVE(UTILS_BITMAP_NAME_IFUNC(bitop)) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F
+    if (__builtin_cpu_supports("avx512f")) {
+        return UTILS_BITMAP_NAME_IMPL(bitop, avx512);
+    }
+#endif
+    if (__builtin_cpu_supports("avx2")) {
+        return UTILS_BITMAP_NAME_IMPL(bitop, avx2);
+    }
+#endif
+
+    return UTILS_BITMAP_NAME_IMPL(bitop, loop);
+}
+
+void IFUNC_WRAPPER(UTILS_BITMAP_NAME_IFUNC(bitop), UTILS_BITMAP_BITOP_ARGS);
+
+static inline uint64_t utils_bitmap_popcount_word(
+        uint64_t word) {
+    // The generic build doesn't enable the popcnt instruction, the bits are counted in parallel within the word
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+    return (word * 0x0101010101010101ULL) >> 56;
+}
+
+uint64_t UTILS_BITMAP_SIGNATURE_IMPL(popcount, loop, UTILS_BITMAP_POPCOUNT_ARGS) {
+    uint64_t count = 0;
+    size_t offset = 0;
+
+    for(; offset + sizeof(uint64_t) <= length; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + offset, sizeof(word));
+        count += utils_bitmap_popcount_word(word);
+    }
+
+    for(; offset < length; offset++) {
+        count += utils_bitmap_popcount_word(data[offset]);
+    }
+
+    return count;
+}
+
+void UTILS_BITMAP_SIGNATURE_IMPL(bitop, loop, UTILS_BITMAP_BITOP_ARGS) {
+    switch(op) {
+        case UTILS_BITMAP_OP_AND:
+            for(size_t offset = 0; offset < length; offset++) {
+                destination[offset] &= source[offset];
+            }
+            break;
+
+        case UTILS_BITMAP_OP_OR:
+            for(size_t offset = 0; offset < length; offset++) {
+                destination[offset] |= source[offset];
+            }
+            break;
+
+        case UTILS_BITMAP_OP_XOR:
+            for(size_t offset = 0; offset < length; offset++) {
+                destination[offset] ^= source[offset];
+            }
+            break;
+
+        case UTILS_BITMAP_OP_NOT:
+            for(size_t offset = 0; offset < length; offset++) {
+                destination[offset] = ~source[offset];
+            }
+            break;
+    }
+}
+
+size_t utils_bitmap_find_first_byte(
+        const uint8_t *data,
+        size_t length,
+        bool bit) {
+    size_t offset = 0;
+    uint64_t skip_word = bit ? 0 : UINT64_MAX;
+
+    // The bytes that can't contain the bit are all 0x00, or all 0xFF, so they are skipped a word at time
+    for(; offset + sizeof(uint64_t) <= length; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + offset, sizeof(word));
+
+        if (word != skip_word) {
+            break;
+        }
+    }
+
+    for(; offset < length; offset++) {
+        if (data[offset] != (uint8_t)skip_word) {
+            break;
+        }
+    }
+
+    return offset;
+}
@@ -0,0 +1,74 @@
+#ifndef CACHEGRAND_UTILS_BITMAP_H
+#define CACHEGRAND_UTILS_BITMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UTILS_BITMAP_NAME_IFUNC(NAME) utils_bitmap_##NAME
+#define UTILS_BITMAP_SIGNATURE_IFUNC(NAME, ARGS) UTILS_BITMAP_NAME_IFUNC(NAME) ARGS
+
+#define UTILS_BITMAP_NAME_IMPL(NAME, METHOD) utils_bitmap_##NAME##_##METHOD
+#define UTILS_BITMAP_SIGNATURE_IMPL(NAME, METHOD, ARGS) UTILS_BITMAP_NAME_IMPL(NAME, METHOD) ARGS
+
+enum utils_bitmap_op {
+    UTILS_BITMAP_OP_AND,
+    UTILS_BITMAP_OP_OR,
+    UTILS_BITMAP_OP_XOR,
+    UTILS_BITMAP_OP_NOT,
+};
+typedef enum utils_bitmap_op utils_bitmap_op_t;
+
+#define UTILS_BITMAP_POPCOUNT_ARGS \
+    (const uint8_t *data, size_t length)
+#define UTILS_BITMAP_BITOP_ARGS \
+    (utils_bitmap_op_t op, uint8_t *destination, const uint8_t *source, size_t length)
+
+/**
+ * Count the bits set in a buffer
+ *
+ * @param data The buffer
+ * @param length The length of the buffer in bytes
+ * @return The number of bits set
+ */
+uint64_t UTILS_BITMAP_SIGNATURE_IFUNC(popcount, UTILS_BITMAP_POPCOUNT_ARGS);
+uint64_t UTILS_BITMAP_SIGNATURE_IMPL(popcount, loop, UTILS_BITMAP_POPCOUNT_ARGS);
+#if defined(__x86_64__)
+uint64_t UTILS_BITMAP_SIGNATURE_IMPL(popcount, avx2, UTILS_BITMAP_POPCOUNT_ARGS);
+uint64_t UTILS_BITMAP_SIGNATURE_IMPL(popcount, avx512, UTILS_BITMAP_POPCOUNT_ARGS);
+#endif
+
+/**
+ * Apply a bitwise operation to a buffer, AND, OR and XOR combine the destination with the source while NOT writes
+ * into the destination the negated source, destination and source can be the same buffer
+ *
+ * @param op The operation
+ * @param destination The destination buffer
+ * @param source The source buffer
+ * @param length The length of both buffers in bytes
+ */
+void UTILS_BITMAP_SIGNATURE_IFUNC(bitop, UTILS_BITMAP_BITOP_ARGS);
+void UTILS_BITMAP_SIGNATURE_IMPL(bitop, loop, UTILS_BITMAP_BITOP_ARGS);
+#if defined(__x86_64__)
+void UTILS_BITMAP_SIGNATURE_IMPL(bitop, avx2, UTILS_BITMAP_BITOP_ARGS);
+void UTILS_BITMAP_SIGNATURE_IMPL(bitop, avx512, UTILS_BITMAP_BITOP_ARGS);
+#endif
+
+/**
+ * Search the first byte of a buffer containing at least a bit with the value requested
+ *
+ * @param data The buffer
+ * @param length The length of the buffer in bytes
+ * @param bit The value of the bit to search
+ * @return The offset of the byte found or length if no byte contains the bit
+ */
+size_t utils_bitmap_find_first_byte(
+        const uint8_t *data,
+        size_t length,
+        bool bit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_UTILS_BITMAP_H
@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <immintrin.h>
+
+#include "misc.h"
+
+#include "utils_bitmap.h"
+
+// Every byte counts at most 8 bits, the per-byte counters can be accumulated for up to 31 iterations before they
+// overflow, a lower number is used to keep the loop simple
+#define UTILS_BITMAP_POPCOUNT_AVX2_ACCUMULATE_ITERATIONS  (8)
+
+uint64_t UTILS_BITMAP_SIGNATURE_IMPL(popcount, avx2, UTILS_BITMAP_POPCOUNT_ARGS) {
+    size_t offset = 0;
+    uint64_t count = 0;
+
+    // The bits of each nibble are counted with a lookup table in a shuffle and the per-byte counters are summed into
+    // 64 bit counters with a sum of absolute differences against zero
+    const __m256i lookup_vector = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask_vector = _mm256_set1_epi8(0x0F);
+    __m256i total_vector = _mm256_setzero_si256();
+
+    while(offset + 32 <= length) {
+        __m256i byte_counters_vector = _mm256_setzero_si256();
+
+        for(
+                int iteration = 0;
+                iteration < UTILS_BITMAP_POPCOUNT_AVX2_ACCUMULATE_ITERATIONS && offset + 32 <= length;
+                iteration++, offset += 32) {
+            __m256i data_vector = _mm256_loadu_si256((__m256i*)(data + offset));
+            __m256i low_vector = _mm256_and_si256(data_vector, low_mask_vector);
+            __m256i high_vector = _mm256_and_si256(_mm256_srli_epi16(data_vector, 4), low_mask_vector);
+
+            byte_counters_vector = _mm256_add_epi8(
+                    byte_counters_vector,
+                    _mm256_add_epi8(
+                            _mm256_shuffle_epi8(lookup_vector, low_vector),
+                            _mm256_shuffle_epi8(lookup_vector, high_vector)));
+        }
+
+        total_vector = _mm256_add_epi64(
+                total_vector,
+                _mm256_sad_epu8(byte_counters_vector, _mm256_setzero_si256()));
+    }
+
+    count += (uint64_t)_mm256_extract_epi64(total_vector, 0);
+    count += (uint64_t)_mm256_extract_epi64(total_vector, 1);
+    count += (uint64_t)_mm256_extract_epi64(total_vector, 2);
+    count += (uint64_t)_mm256_extract_epi64(total_vector, 3);
+
+    return count + UTILS_BITMAP_NAME_IMPL(popcount, loop)(data + offset, length - offset);
+}
+
+void UTILS_BITMAP_SIGNATURE_IMPL(bitop, avx2, UTILS_BITMAP_BITOP_ARGS) {
+    size_t offset = 0;
+    const __m256i ones_vector = _mm256_set1_epi8((char)0xFF);
+
+    for(; offset + 32 <= length; offset += 32) {
+        __m256i result_vector;
+        __m256i source_vector = _mm256_loadu_si256((__m256i*)(source + offset));
+
+        if (op == UTILS_BITMAP_OP_NOT) {
+            result_vector = _mm256_xor_si256(source_vector, ones_vector);
+        } else {
+            __m256i destination_vector = _mm256_loadu_si256((__m256i*)(destination + offset));
+
+            if (op == UTILS_BITMAP_OP_AND) {
+                result_vector = _mm256_and_si256(destination_vector, source_vector);
+            } else if (op == UTILS_BITMAP_OP_OR) {
+                result_vector = _mm256_or_si256(destination_vector, source_vector);
+            } else {
+                result_vector = _mm256_xor_si256(destination_vector, source_vector);
+            }
+        }
+
+        _mm256_storeu_si256((__m256i*)(destination + offset), result_vector);
+    }
+
+    UTILS_BITMAP_NAME_IMPL(bitop, loop)(op, destination + offset, source + offset, length - offset);
+}
@@ -0,0 +1,58 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <immintrin.h>
+
+#include "misc.h"
+
+#include "utils_bitmap.h"
+
+uint64_t UTILS_BITMAP_SIGNATURE_IMPL(popcount, avx512, UTILS_BITMAP_POPCOUNT_ARGS) {
+    size_t offset = 0;
+    __m512i total_vector = _mm512_setzero_si512();
+
+    for(; offset + 64 <= length; offset += 64) {
+        __m512i data_vector = _mm512_loadu_si512((void*)(data + offset));
+        total_vector = _mm512_add_epi64(total_vector, _mm512_popcnt_epi64(data_vector));
+    }
+
+    return _mm512_reduce_add_epi64(total_vector) +
+        UTILS_BITMAP_NAME_IMPL(popcount, loop)(data + offset, length - offset);
+}
+
+void UTILS_BITMAP_SIGNATURE_IMPL(bitop, avx512, UTILS_BITMAP_BITOP_ARGS) {
+    size_t offset = 0;
+
+    // The ternary logic instruction applies the operation selected by the immediate to the 3 inputs, only the
+    // destination and the source are used
+    for(; offset + 64 <= length; offset += 64) {
+        __m512i result_vector;
+        __m512i source_vector = _mm512_loadu_si512((void*)(source + offset));
+
+        if (op == UTILS_BITMAP_OP_NOT) {
+            result_vector = _mm512_ternarylogic_epi64(source_vector, source_vector, source_vector, 0x55);
+        } else {
+            __m512i destination_vector = _mm512_loadu_si512((void*)(destination + offset));
+
+            if (op == UTILS_BITMAP_OP_AND) {
+                result_vector = _mm512_and_si512(destination_vector, source_vector);
+            } else if (op == UTILS_BITMAP_OP_OR) {
+                result_vector = _mm512_or_si512(destination_vector, source_vector);
+            } else {
+                result_vector = _mm512_xor_si512(destination_vector, source_vector);
+            }
+        }
+
+        _mm512_storeu_si512((void*)(destination + offset), result_vector);
+    }
+
+    UTILS_BITMAP_NAME_IMPL(bitop, loop)(op, destination + offset, source + offset, length - offset);
+}
@@ -6,11 +6,14 @@
  * of the BSD license.  See the LICENSE file for details.
  **/
 
+#define _GNU_SOURCE
+
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
 #include <arpa/inet.h>
 #include <liburing.h>
+#include <poll.h>
 #include <linux/tls.h>
 
 #include "misc.h"
@@ -27,6 +30,7 @@
 #include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
 #include "data_structures/hashtable/spsc/hashtable_spsc.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/timer_wheel/timer_wheel.h"
 #include "support/io_uring/io_uring_support.h"
 #include "module/module.h"
 #include "network/io/network_io_common.h"
@@ -69,6 +73,9 @@ network_channel_t* worker_network_iouring_op_network_accept_setup_new_channel(
     worker_context_t *worker_context = worker_context_get();
     worker_stats_t *stats = worker_stats_get_internal_current();
 
+    // The TCP level options (e.g. nodelay, keepalive, busy polling) can't be applied to the UNIX sockets
+    bool is_unix_socket = addr->sa_family == AF_UNIX;
+
     // Setup the new channel
     network_channel_iouring_t* new_channel = network_channel_iouring_new(NETWORK_CHANNEL_TYPE_CLIENT);
     memcpy(&new_channel->wrapped_channel.address.socket.base, addr, addr_len);
@@ -96,7 +103,7 @@ network_channel_t* worker_network_iouring_op_network_accept_setup_new_channel(
     }
 
     // Perform the initial setup on the new channel
-    if (unlikely(network_channel_client_setup(
+    if (!is_unix_socket && unlikely(network_channel_client_setup(
             new_channel->wrapped_channel.fd,
             context->core_index) == false)) {
         fiber_scheduler_set_error(errno);
@@ -113,7 +120,7 @@ network_channel_t* worker_network_iouring_op_network_accept_setup_new_channel(
         return NULL;
     }
 
-    if (listener_channel->wrapped_channel.module_config->network->keepalive != NULL) {
+    if (!is_unix_socket && listener_channel->wrapped_channel.module_config->network->keepalive != NULL) {
         bool error = false;
         error |= !network_io_common_socket_enable_keepalive(new_channel->wrapped_channel.fd, true);
         error |= !network_io_common_socket_set_keepalive_count(
@@ -135,6 +142,20 @@ network_channel_t* worker_network_iouring_op_network_accept_setup_new_channel(
         }
     }
 
+    if (!is_unix_socket &&
+        worker_context->config->network->polling != NULL &&
+        worker_context->config->network->polling->busy_poll_us > 0) {
+        if (!network_io_common_socket_set_busy_poll(
+                new_channel->wrapped_channel.fd,
+                (int)worker_context->config->network->polling->busy_poll_us)) {
+            LOG_W(
+                    TAG,
+                    "Failed to enable the busy polling for the connection <%s> coming from listener <%s>",
+                    new_channel->wrapped_channel.address.str,
+                    listener_channel->wrapped_channel.address.str);
+        }
+    }
+
     if (listener_channel->wrapped_channel.tls.enabled) {
         network_channel_tls_set_config(
                 &new_channel->wrapped_channel,
@@ -255,46 +276,78 @@ bool worker_network_iouring_op_network_close(
     return res;
 }
 
+static void worker_network_iouring_op_timeout_timer_fp(
+        timer_wheel_timer_t *timer,
+        void *user_data) {
+    worker_iouring_context_t *context = worker_iouring_context_get();
+
+    // The operation in flight is cancelled and will complete with -ECANCELED, as it was happening with the link
+    // timeout, the completion of the cancel request is skipped by the worker loop as its user data is set to 0
+    if (unlikely(!io_uring_support_sqe_enqueue_cancel(
+            context->ring,
+            (uintptr_t)user_data,
+            0,
+            0))) {
+        // Try again on the next tick
+        timer_wheel_add(
+                context->timer_wheel,
+                timer,
+                clock_monotonic_int64_ms(),
+                worker_network_iouring_op_timeout_timer_fp,
+                user_data);
+    }
+}
+
+static void worker_network_iouring_op_timeout_timer_add(
+        timer_wheel_timer_t *timer,
+        kernel_timespec_t *kernel_timespec) {
+    timer_wheel_timer_init(timer);
+
+    if (kernel_timespec->tv_nsec == -1) {
+        return;
+    }
+
+    timer_wheel_add(
+            worker_iouring_context_get()->timer_wheel,
+            timer,
+            clock_monotonic_int64_ms() + (kernel_timespec->tv_sec * 1000) + (kernel_timespec->tv_nsec / 1000000),
+            worker_network_iouring_op_timeout_timer_fp,
+            fiber_scheduler_get_current());
+}
+
+static void worker_network_iouring_op_timeout_timer_remove(
+        timer_wheel_timer_t *timer) {
+    timer_wheel_remove(worker_iouring_context_get()->timer_wheel, timer);
+}
+
 int32_t worker_network_iouring_op_network_receive_internal(
         network_channel_t *channel,
         char* buffer,
         size_t buffer_length,
         kernel_timespec_t *kernel_timespec) {
     int32_t res;
+    timer_wheel_timer_t timer;
     worker_iouring_context_t *context = worker_iouring_context_get();
 
     fiber_scheduler_reset_error();
 
-    do {
-        uint8_t extra_sqes = 0;
-
-        if (kernel_timespec->tv_nsec != -1) {
-            extra_sqes |= IOSQE_IO_LINK;
-        }
+    // The deadline is tracked by the timer wheel of the worker instead of linking a timeout to each recv
+    worker_network_iouring_op_timeout_timer_add(&timer, kernel_timespec);
 
+    do {
         if (unlikely(!io_uring_support_sqe_enqueue_recv(
                 context->ring,
                 channel->fd,
                 buffer,
                 buffer_length,
                 0,
-                ((network_channel_iouring_t*)channel)->base_sqe_flags | extra_sqes,
+                ((network_channel_iouring_t*)channel)->base_sqe_flags,
                 (uintptr_t) fiber_scheduler_get_current()))) {
+            worker_network_iouring_op_timeout_timer_remove(&timer);
             fiber_scheduler_set_error(ENOMEM);
             return -ENOMEM;
         }
 
-        if (kernel_timespec->tv_nsec != -1) {
-            if (unlikely(!io_uring_support_sqe_enqueue_link_timeout(
-                    context->ring,
-                    kernel_timespec,
-                    0,
-                    0))) {
-                fiber_scheduler_set_error(ENOMEM);
-                return -ENOMEM;
-            }
-        }
-
         // Switch the execution back to the scheduler
         fiber_scheduler_switch_back();
 
@@ -304,6 +357,8 @@ int32_t worker_network_iouring_op_network_receive_internal(
         res = cqe->res;
     } while(unlikely(res == -EAGAIN));
 
+    worker_network_iouring_op_timeout_timer_remove(&timer);
+
     // If kTLS is enabled, EPIPE, EIO or EBADMSG can be returned in case of a connection reset, we don't really want to
     // spam the logs with these messages so res gets set to 0 to "pretend" the connection has been closed by the remote
     // endpoint gracefully
@@ -349,11 +404,117 @@ int32_t worker_network_iouring_op_network_receive(
             &kernel_timespec);
 }
 
+int32_t worker_network_iouring_op_network_wait_readable(
+        network_channel_t *channel) {
+    int32_t res;
+    timer_wheel_timer_t timer;
+    worker_iouring_context_t *context = worker_iouring_context_get();
+    kernel_timespec_t kernel_timespec = {
+            .tv_sec = channel->timeout.read.sec,
+            .tv_nsec = channel->timeout.read.nsec,
+    };
+
+    fiber_scheduler_reset_error();
+
+    worker_network_iouring_op_timeout_timer_add(&timer, &kernel_timespec);
+
+    // Wait for the socket to become readable without providing a buffer, used to avoid keeping the buffers allocated
+    // for the idle connections
+    if (unlikely(!io_uring_support_sqe_enqueue_poll_add(
+            context->ring,
+            channel->fd,
+            POLLIN,
+            ((network_channel_iouring_t*)channel)->base_sqe_flags,
+            (uintptr_t) fiber_scheduler_get_current()))) {
+        worker_network_iouring_op_timeout_timer_remove(&timer);
+        fiber_scheduler_set_error(ENOMEM);
+        return -ENOMEM;
+    }
+
+    // Switch the execution back to the scheduler
+    fiber_scheduler_switch_back();
+
+    // When the fiber continues the execution, it has to fetch the return value
+    io_uring_cqe_t *cqe = (io_uring_cqe_t*)((fiber_scheduler_get_current())->ret.ptr_value);
+    res = cqe->res;
+
+    worker_network_iouring_op_timeout_timer_remove(&timer);
+
+    if (unlikely(res < 0)) {
+        fiber_scheduler_set_error(-res);
+    }
+
+    return res;
+}
+
+int32_t worker_network_iouring_op_network_wait_hangup(
+        network_channel_t *channel) {
+    int32_t res;
+    timer_wheel_timer_t timer;
+    fiber_t *fiber = fiber_scheduler_get_current();
+    worker_iouring_context_t *context = worker_iouring_context_get();
+
+    fiber_scheduler_reset_error();
+    timer_wheel_timer_init(&timer);
+
+    // Only the hangup of the peer is watched, the data sent in the meantime is left in the socket to be processed
+    // later, POLLHUP and POLLERR are always reported
+    if (unlikely(!io_uring_support_sqe_enqueue_poll_add(
+            context->ring,
+            channel->fd,
+            POLLRDHUP,
+            ((network_channel_iouring_t*)channel)->base_sqe_flags,
+            (uintptr_t)fiber))) {
+        fiber_scheduler_set_error(ENOMEM);
+        return -ENOMEM;
+    }
+
+    // The fiber can also be resumed by someone else (e.g. a timer or a wakeup delivered via the mailbox), the cqe is
+    // used to tell the two cases apart
+    fiber->ret.ptr_value = NULL;
+    fiber_scheduler_switch_back();
+
+    if (fiber->ret.ptr_value == NULL) {
+        // The poll has to be cancelled and its completion has to be waited for before returning, the cqe references
+        // the fiber and would resume it at a random point otherwise, if the cancel request can't be enqueued it's
+        // retried on the next tick
+        if (unlikely(!io_uring_support_sqe_enqueue_cancel(
+                context->ring,
+                (uintptr_t)fiber,
+                0,
+                0))) {
+            timer_wheel_add(
+                    context->timer_wheel,
+                    &timer,
+                    clock_monotonic_int64_ms(),
+                    worker_network_iouring_op_timeout_timer_fp,
+                    fiber);
+        }
+
+        // Other resumptions might happen in the meantime, they are ignored
+        while(fiber->ret.ptr_value == NULL) {
+            fiber_scheduler_switch_back();
+        }
+
+        worker_network_iouring_op_timeout_timer_remove(&timer);
+    }
+
+    io_uring_cqe_t *cqe = (io_uring_cqe_t*)(fiber->ret.ptr_value);
+    res = cqe->res;
+
+    if (unlikely(res < 0)) {
+        fiber_scheduler_set_error(-res);
+    }
+
+    return res;
+}
+
 int32_t worker_network_iouring_op_network_send(
         network_channel_t *channel,
         char* buffer,
         size_t buffer_length) {
     int32_t res;
+    timer_wheel_timer_t timer;
     worker_iouring_context_t *context = worker_iouring_context_get();
     kernel_timespec_t kernel_timespec = {
             .tv_sec = channel->timeout.read.sec,
@@ -362,36 +523,22 @@ int32_t worker_network_iouring_op_network_send(
 
     fiber_scheduler_reset_error();
 
-    do {
-        uint8_t extra_sqes = 0;
-
-        if (kernel_timespec.tv_nsec != -1) {
-            extra_sqes |= IOSQE_IO_LINK;
-        }
+    worker_network_iouring_op_timeout_timer_add(&timer, &kernel_timespec);
 
+    do {
         if (unlikely(!io_uring_support_sqe_enqueue_send(
                 context->ring,
                 channel->fd,
                 buffer,
                 buffer_length,
                 0,
-                ((network_channel_iouring_t*)channel)->base_sqe_flags | extra_sqes,
+                ((network_channel_iouring_t*)channel)->base_sqe_flags,
                 (uintptr_t) fiber_scheduler_get_current()))) {
+            worker_network_iouring_op_timeout_timer_remove(&timer);
             fiber_scheduler_set_error(ENOMEM);
             return -ENOMEM;
         }
 
-        if (kernel_timespec.tv_nsec != -1) {
-            if (unlikely(!io_uring_support_sqe_enqueue_link_timeout(
-                    context->ring,
-                    &kernel_timespec,
-                    0,
-                    0))) {
-                fiber_scheduler_set_error(ENOMEM);
-                return -ENOMEM;
-            }
-        }
-
         // Switch the execution back to the scheduler
         fiber_scheduler_switch_back();
 
@@ -401,6 +548,8 @@ int32_t worker_network_iouring_op_network_send(
         res = cqe->res;
     } while(unlikely(res == -EAGAIN));
 
+    worker_network_iouring_op_timeout_timer_remove(&timer);
+
     // If kTLS is enabled, EIO or EBADMSG can be returned in case of a connection reset, we don't really want to spam
     // the logs with these messages so res gets set to 0 to "pretend" the connection has been closed by the remote
     // endpoint gracefully
@@ -413,6 +562,71 @@ int32_t worker_network_iouring_op_network_send(
     return res;
 }
 
+network_io_common_fd_t worker_network_iouring_op_network_detach(
+        network_channel_t *channel) {
+    network_channel_iouring_t *channel_iouring = (network_channel_iouring_t *)channel;
+    network_io_common_fd_t fd = channel_iouring->fd;
+
+    if (likely(channel_iouring->has_mapped_fd)) {
+        // The registered file holds a reference to the socket, the slot has to be emptied as well otherwise the socket
+        // would be kept alive by this ring until the slot gets reused
+        int empty_fd = -1;
+        if (unlikely(io_uring_register_files_update(
+                worker_iouring_context_get()->ring,
+                channel->fd,
+                &empty_fd,
+                1) != 1)) {
+            LOG_E(
+                    TAG,
+                    "[FD:%5d] Failed to remove the connection <%s> from the registered files",
+                    fd,
+                    channel->address.str);
+            return -1;
+        }
+
+        worker_iouring_fds_map_remove(channel->fd);
+        channel_iouring->has_mapped_fd = false;
+        channel_iouring->base_sqe_flags &= ~IOSQE_FIXED_FILE;
+    }
+
+    channel_iouring->fd = channel->fd = -1;
+
+    return fd;
+}
+
+bool worker_network_iouring_op_network_attach(
+        network_channel_t *channel,
+        network_io_common_fd_t fd) {
+    worker_iouring_context_t *context = worker_iouring_context_get();
+    network_channel_iouring_t *channel_iouring = (network_channel_iouring_t *)channel;
+
+    channel_iouring->fd = channel->fd = fd;
+
+    // Deliver the incoming packets to the core of the worker that is taking over the connection
+    if (channel->address.socket.base.sa_family != AF_UNIX &&
+        !network_io_common_socket_set_incoming_cpu(fd, (int)context->core_index)) {
+        LOG_W(
+                TAG,
+                "[FD:%5d] Failed to update the incoming cpu for the connection <%s>",
+                fd,
+                channel->address.str);
+    }
+
+    return worker_iouring_fds_map_add_and_enqueue_files_update(
+            context->ring,
+            channel_iouring->fd,
+            WORKER_FDS_MAP_FILES_FD_TYPE_NETWORK_CHANNEL,
+            &channel_iouring->has_mapped_fd,
+            &channel_iouring->base_sqe_flags,
+            &channel_iouring->wrapped_channel.fd);
+}
+
+int32_t worker_network_iouring_op_network_send_queue_size(
+        network_channel_t *channel) {
+    // The fd in the wrapped channel might be the index of the registered file, the ioctl requires the actual fd
+    return network_io_common_socket_get_send_queue_size(((network_channel_iouring_t*)channel)->fd);
+}
+
 bool worker_network_iouring_initialize(
         __attribute__((unused)) worker_context_t *worker_context) {
     return true;
@@ -480,8 +694,13 @@ bool worker_network_iouring_op_register() {
     worker_op_network_accept = worker_network_iouring_op_network_accept;
     worker_op_network_receive = worker_network_iouring_op_network_receive;
     worker_op_network_receive_timeout = worker_network_iouring_op_network_receive_timeout;
+    worker_op_network_wait_readable = worker_network_iouring_op_network_wait_readable;
+    worker_op_network_wait_hangup = worker_network_iouring_op_network_wait_hangup;
     worker_op_network_send = worker_network_iouring_op_network_send;
+    worker_op_network_send_queue_size = worker_network_iouring_op_network_send_queue_size;
     worker_op_network_close = worker_network_iouring_op_network_close;
+    worker_op_network_detach = worker_network_iouring_op_network_detach;
+    worker_op_network_attach = worker_network_iouring_op_network_attach;
 
     return true;
 }
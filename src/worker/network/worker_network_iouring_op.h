@@ -33,11 +33,27 @@ int32_t worker_network_iouring_op_network_receive(
         char* buffer,
         size_t buffer_length);
 
+int32_t worker_network_iouring_op_network_wait_readable(
+        network_channel_t *channel);
+
+int32_t worker_network_iouring_op_network_wait_hangup(
+        network_channel_t *channel);
+
 int32_t worker_network_iouring_op_network_send(
         network_channel_t *channel,
         char* buffer,
         size_t buffer_length);
 
+network_io_common_fd_t worker_network_iouring_op_network_detach(
+        network_channel_t *channel);
+
+bool worker_network_iouring_op_network_attach(
+        network_channel_t *channel,
+        network_io_common_fd_t fd);
+
+int32_t worker_network_iouring_op_network_send_queue_size(
+        network_channel_t *channel);
+
 bool worker_network_iouring_initialize(
         __attribute__((unused)) worker_context_t *worker_context);
 
@@ -70,11 +70,17 @@ worker_op_network_channel_free_fp_t* worker_op_network_channel_free;
 worker_op_network_accept_fp_t* worker_op_network_accept;
 worker_op_network_receive_fp_t* worker_op_network_receive;
 worker_op_network_receive_timeout_fp_t* worker_op_network_receive_timeout;
+worker_op_network_wait_readable_fp_t* worker_op_network_wait_readable;
+worker_op_network_wait_hangup_fp_t* worker_op_network_wait_hangup;
 worker_op_network_send_fp_t* worker_op_network_send;
+worker_op_network_send_queue_size_fp_t* worker_op_network_send_queue_size;
 worker_op_network_close_fp_t* worker_op_network_close;
+worker_op_network_detach_fp_t* worker_op_network_detach;
+worker_op_network_attach_fp_t* worker_op_network_attach;
 
 worker_module_context_t *worker_module_contexts_initialize(
-        config_t *config) {
+        config_t *config,
+        struct network_tls_session_resumption **network_tls_session_resumptions) {
     bool result_ret = false;
     worker_module_context_t *worker_module_context = NULL;
 
@@ -115,6 +121,13 @@ worker_module_context_t *worker_module_contexts_initialize(
             goto end;
         }
 
+        // The session resumption is shared across the workers and is set up only if enabled for the module
+        if (network_tls_session_resumptions && network_tls_session_resumptions[module_index]) {
+            network_tls_config_set_session_resumption(
+                    network_tls_config,
+                    network_tls_session_resumptions[module_index]);
+        }
+
         worker_module_context[module_index].network_tls_config = network_tls_config;
     }
 
@@ -152,6 +165,28 @@ void worker_module_context_free(
 
 // TODO: the listener and accept operations should be refactored to split them in an user frontend operation and in an
 //       internal operation like for all the other ops (recv, send, close, etc.)
+static bool worker_network_listeners_new_binding(
+        config_module_network_binding_t *binding,
+        uint16_t backlog,
+        module_id_t module_id,
+        network_channel_listener_new_callback_user_data_t *listener_new_cb_user_data) {
+    if (binding->path) {
+        return network_channel_listener_new_unix(
+                binding->path,
+                binding->permissions,
+                backlog,
+                module_id,
+                listener_new_cb_user_data);
+    }
+
+    return network_channel_listener_new(
+            binding->host,
+            binding->port,
+            backlog,
+            module_id,
+            listener_new_cb_user_data);
+}
+
 bool worker_network_listeners_initialize(
         uint32_t worker_index,
         uint8_t core_index,
@@ -170,9 +205,8 @@ bool worker_network_listeners_initialize(
     for(int module_index = 0; module_index < config->modules_count; module_index++) {
         config_module_t *config_module = &config->modules[module_index];
         for(int binding_index = 0; binding_index < config_module->network->bindings_count; binding_index++) {
-            if (network_channel_listener_new(
-                    config_module->network->bindings[binding_index].host,
-                    config_module->network->bindings[binding_index].port,
+            if (worker_network_listeners_new_binding(
+                    &config_module->network->bindings[binding_index],
                     config->network->listen_backlog,
                     0,
                     &listener_new_cb_user_data) == false) {
@@ -197,17 +231,22 @@ bool worker_network_listeners_initialize(
         for(int binding_index = 0; binding_index < config_module->network->bindings_count; binding_index++) {
             config_module_network_binding_t *binding = &config_module->network->bindings[binding_index];
             uint8_t listeners_count_before = listener_new_cb_user_data.listeners_count;
-            if (network_channel_listener_new(
-                    binding->host,
-                    binding->port,
+            if (worker_network_listeners_new_binding(
+                    binding,
                     config->network->listen_backlog,
                     module_id,
                     &listener_new_cb_user_data) == false) {
 
-                LOG_E(TAG, "Unable to setup listener for <%s:%u> with protocol <%d>",
-                      binding->host,
-                      binding->port,
-                      module_id);
+                if (binding->path) {
+                    LOG_E(TAG, "Unable to setup listener for <%s> with protocol <%d>",
+                          binding->path,
+                          module_id);
+                } else {
+                    LOG_E(TAG, "Unable to setup listener for <%s:%u> with protocol <%d>",
+                          binding->host,
+                          binding->port,
+                          module_id);
+                }
 
                 return_res = false;
                 goto end;
@@ -237,8 +276,9 @@ bool worker_network_listeners_initialize(
                             false);
                 }
 
-                // Attach the cBPF program for reuse port only once, the worker with index 0 will always be initialized
-                if (worker_index == 0) {
+                // Attach the cBPF program for reuse port only once, the worker with index 0 will always be initialized,
+                // the UNIX sockets don't support SO_REUSEPORT and are shared across the workers
+                if (worker_index == 0 && channel_listener->address.socket.base.sa_family != AF_UNIX) {
                     if (!network_io_common_socket_attach_reuseport_cbpf(channel_listener->fd)) {
                         LOG_E(TAG, "Failed to attach the reuse port cbpf program to the listener");
                         return false;
@@ -298,7 +338,11 @@ void worker_network_new_client_fiber_entrypoint(
             goto end;
         }
 
+        timespec_t handshake_started_on, handshake_completed_on, handshake_duration;
+        clock_monotonic(&handshake_started_on);
+
         if (unlikely(!network_channel_tls_handshake(new_channel))) {
+            stats->network.tls_handshakes_failed++;
             LOG_V(
                     TAG,
                     "[FD:%5d] TLS handshake failed for the connection <%s>",
@@ -307,6 +351,18 @@ void worker_network_new_client_fiber_entrypoint(
             goto end;
         }
 
+        // The resumed sessions are counted by the session cache and session tickets callbacks
+        clock_monotonic(&handshake_completed_on);
+        clock_diff(&handshake_completed_on, &handshake_started_on, &handshake_duration);
+        uint64_t handshake_duration_us =
+                (handshake_duration.tv_sec * 1000000) + (handshake_duration.tv_nsec / 1000);
+
+        stats->network.tls_handshakes++;
+        stats->network.tls_handshakes_duration_us += handshake_duration_us;
+        if (handshake_duration_us > stats->network.tls_handshakes_duration_us_max) {
+            stats->network.tls_handshakes_duration_us_max = handshake_duration_us;
+        }
+
         tls_handshake_completed = true;
         stats->network.active_tls_connections++;
         stats->network.accepted_tls_connections++;
@@ -368,7 +424,10 @@ void worker_network_new_client_fiber_entrypoint(
 end:
     // TODO: when it gets here new_channel might have been already freed, the flow should always close the connection
     //       the connection here and not from within the module
-    if (new_channel->status != NETWORK_CHANNEL_STATUS_CLOSED) {
+    if (new_channel->status == NETWORK_CHANNEL_STATUS_MIGRATED) {
+        // The connection has been handed over to another worker, only the channel has to be freed
+        worker_op_network_channel_free(new_channel);
+    } else if (new_channel->status != NETWORK_CHANNEL_STATUS_CLOSED) {
         network_close(new_channel, true);
     }
 
@@ -46,15 +46,32 @@ typedef int32_t (worker_op_network_receive_timeout_fp_t)(
         size_t buffer_length,
         uint32_t timeout_ms);
 
+typedef int32_t (worker_op_network_wait_readable_fp_t)(
+        network_channel_t *channel);
+
+typedef int32_t (worker_op_network_wait_hangup_fp_t)(
+        network_channel_t *channel);
+
 typedef int32_t (worker_op_network_send_fp_t)(
         network_channel_t *channel,
         char* buffer,
         size_t buffer_length);
 
+typedef int32_t (worker_op_network_send_queue_size_fp_t)(
+        network_channel_t *channel);
+
+typedef network_io_common_fd_t (worker_op_network_detach_fp_t)(
+        network_channel_t *channel);
+
+typedef bool (worker_op_network_attach_fp_t)(
+        network_channel_t *channel,
+        network_io_common_fd_t fd);
+
 typedef size_t (worker_op_network_channel_size_fp_t)();
 
 worker_module_context_t *worker_module_contexts_initialize(
-        config_t *config);
+        config_t *config,
+        struct network_tls_session_resumption **network_tls_session_resumptions);
 
 void worker_module_context_free(
         config_t *config,
@@ -85,8 +102,13 @@ extern worker_op_network_channel_free_fp_t* worker_op_network_channel_free;
 extern worker_op_network_accept_fp_t* worker_op_network_accept;
 extern worker_op_network_receive_fp_t* worker_op_network_receive;
 extern worker_op_network_receive_timeout_fp_t* worker_op_network_receive_timeout;
+extern worker_op_network_wait_readable_fp_t* worker_op_network_wait_readable;
+extern worker_op_network_wait_hangup_fp_t* worker_op_network_wait_hangup;
 extern worker_op_network_send_fp_t* worker_op_network_send;
+extern worker_op_network_send_queue_size_fp_t* worker_op_network_send_queue_size;
 extern worker_op_network_close_fp_t* worker_op_network_close;
+extern worker_op_network_detach_fp_t* worker_op_network_detach;
+extern worker_op_network_attach_fp_t* worker_op_network_attach;
 extern worker_op_network_channel_size_fp_t* worker_op_network_channel_size;
 
 #ifdef __cplusplus
@@ -61,6 +61,8 @@
 #include "data_structures/queue_mpmc/queue_mpmc.h"
 #include "worker.h"
 #include "worker/worker_fiber.h"
+#include "worker/worker_mailbox.h"
+#include "worker/worker_rebalancer.h"
 #include "worker/fiber/worker_fiber_storage_db_gc_deleted_entries.h"
 #include "worker/fiber/worker_fiber_storage_db_initialize.h"
 #include "worker/fiber/worker_fiber_storage_db_keys_eviction.h"
@@ -141,8 +143,8 @@ bool worker_initialize_general(
         uint32_t max_connections_per_worker =
                 (uint32_t)(((double)worker_context->config->network->max_clients * 1.2f) / (double)worker_context->workers_count) + 1 + 10;
 
-        // The amount of entries has to be double the amount of connections because of the timeouts' management (extra
-        // sqe for LINK_TIMEOUT for reads and writes)
+        // The amount of entries is double the amount of connections to leave room for the sqes that don't belong to a
+        // specific read or write (files update, cancellations of the timed out operations, etc.)
         if (!worker_iouring_initialize(
                 worker_context,
                 max_connections_per_worker,
@@ -153,6 +155,16 @@ bool worker_initialize_general(
         }
 
         worker_iouring_op_register();
+
+        if (!worker_mailbox_worker_initialize(worker_context)) {
+            LOG_E(TAG, "Worker mailbox initialization failed, terminating");
+            return false;
+        }
+
+        if (!worker_rebalancer_worker_initialize(worker_context)) {
+            LOG_E(TAG, "Worker rebalancer initialization failed, terminating");
+            return false;
+        }
     }
 
     return true;
@@ -341,12 +353,18 @@ void worker_cleanup(
         uint8_t listeners_count,
         worker_module_context_t *worker_module_contexts,
         bool aborted) {
+    worker_mailbox_worker_cleanup(
+            worker_context);
+
     worker_cleanup_module(
             worker_context);
 
     worker_fiber_free(
             worker_context);
 
+    worker_rebalancer_worker_cleanup(
+            worker_context);
+
     worker_module_context_free(
             worker_context->config,
             worker_module_contexts);
@@ -424,7 +442,8 @@ void* worker_thread_func(
     }
 
     if ((worker_module_contexts = worker_module_contexts_initialize(
-            worker_context->config)) == NULL) {
+            worker_context->config,
+            worker_context->network_tls_session_resumptions)) == NULL) {
         LOG_E(TAG, "Unable to initialize the listeners!");
         goto end;
     }
@@ -40,6 +40,10 @@ struct worker_context {
         void* context;
     } storage;
     double_linked_list_t *fibers;
+    struct fiber_pool *fiber_pool;
+    struct worker_mailbox *mailbox;
+    struct worker_rebalancer *rebalancer;
+    struct network_tls_session_resumption **network_tls_session_resumptions;
     bool_volatile_t *storage_db_loaded;
 };
 
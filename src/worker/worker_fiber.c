@@ -17,6 +17,7 @@
 #include "config.h"
 #include "log/log.h"
 #include "fiber/fiber.h"
+#include "fiber/fiber_pool.h"
 #include "fiber/fiber_scheduler.h"
 #include "data_structures/double_linked_list/double_linked_list.h"
 #include "worker/worker_stats.h"
@@ -35,6 +36,28 @@ bool worker_fiber_init(
         return false;
     }
 
+    // The pool is sized to hold a fiber for each connection the worker may have to handle, the terminated fibers are
+    // recycled instead of being freed so the stacks and the guard pages don't have to be set up again on accept
+    uint32_t fiber_pool_max_size =
+            (uint32_t)(((double)worker_context->config->network->max_clients * 1.2f) /
+                (double)worker_context->workers_count) + 1 + WORKER_FIBER_POOL_INTERNAL_FIBERS_COUNT;
+
+    worker_context->fiber_pool = fiber_pool_new(
+            FIBER_SCHEDULER_STACK_SIZE,
+            fiber_pool_max_size);
+
+    uint32_t prewarm_count = fiber_pool_max_size < WORKER_FIBER_POOL_PREWARM_MAX_COUNT
+            ? fiber_pool_max_size
+            : WORKER_FIBER_POOL_PREWARM_MAX_COUNT;
+    if (unlikely(fiber_pool_prewarm(worker_context->fiber_pool, prewarm_count) != prewarm_count)) {
+        LOG_W(TAG, "Failed to prewarm the fiber pool, the fibers will be allocated on demand");
+    }
+
+    fiber_scheduler_set_fiber_pool(worker_context->fiber_pool);
+
+    // Long-running commands yield once they run for longer than the time slice to let the other fibers make progress
+    fiber_scheduler_set_time_slice_us(FIBER_SCHEDULER_TIME_SLICE_US_DEFAULT);
+
     return true;
 }
 
@@ -82,4 +105,11 @@ void worker_fiber_free(
 
     double_linked_list_free(worker_context->fibers);
     worker_context->fibers = NULL;
+
+    if (worker_context->fiber_pool) {
+        fiber_scheduler_set_fiber_pool(NULL);
+        fiber_scheduler_set_time_slice_us(0);
+        fiber_pool_free(worker_context->fiber_pool);
+        worker_context->fiber_pool = NULL;
+    }
 }
@@ -5,6 +5,13 @@
 extern "C" {
 #endif
 
+// Amount of fibers allocated upfront when the worker starts, the pool can hold enough fibers to serve all the clients
+// the worker can accept but pre-allocating all of them would waste memory when max_clients is set to a large value
+#define WORKER_FIBER_POOL_PREWARM_MAX_COUNT (128)
+
+// Extra room in the pool for the internal fibers (e.g. storage db, gc, eviction, snapshots)
+#define WORKER_FIBER_POOL_INTERNAL_FIBERS_COUNT (16)
+
 bool worker_fiber_init(
         worker_context_t* worker_context);
 
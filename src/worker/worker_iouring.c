@@ -35,6 +35,7 @@
 #include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
 #include "data_structures/hashtable/spsc/hashtable_spsc.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/timer_wheel/timer_wheel.h"
 #include "support/io_uring/io_uring_support.h"
 #include "support/io_uring/io_uring_capabilities.h"
 #include "module/module.h"
@@ -46,6 +47,7 @@
 #include "storage/db/storage_db.h"
 #include "worker/worker_stats.h"
 #include "worker/worker_context.h"
+#include "worker/worker_mailbox.h"
 #include "fiber/fiber_scheduler.h"
 #include "worker/worker.h"
 #include "worker/worker_op.h"
@@ -65,6 +67,11 @@ static thread_local uint32_t fds_map_last_free = 0;
 static thread_local bool io_uring_supports_op_files_update_link = false;
 static thread_local bool io_uring_supports_setup_taskrun = false;
 static thread_local bool io_uring_supports_single_issuer = false;
+static thread_local bool io_uring_supports_defer_taskrun = false;
+
+// When the SQPOLL threads are shared all the rings are attached to the first ring initialized
+static spinlock_lock_t worker_iouring_sqpoll_shared_lock = { 0 };
+static int worker_iouring_sqpoll_shared_ring_fd = -1;
 
 #define TAG "worker_iouring"
 
@@ -269,6 +276,17 @@ void worker_iouring_cqe_log(
             cqe->flags & 0xFFFFu);
 }
 
+static void worker_iouring_sqpoll_shared_ring_release(
+        io_uring_t *ring) {
+    // If the ring provides the shared sqpoll thread its fd can't be used anymore by the workers initialized afterwards,
+    // e.g. on restart, they will have to provide a new one
+    spinlock_lock(&worker_iouring_sqpoll_shared_lock);
+    if (worker_iouring_sqpoll_shared_ring_fd == ring->ring_fd) {
+        worker_iouring_sqpoll_shared_ring_fd = -1;
+    }
+    spinlock_unlock(&worker_iouring_sqpoll_shared_lock);
+}
+
 void worker_iouring_cleanup(
         worker_context_t *worker_context) {
     io_uring_t *ring;
@@ -277,10 +295,16 @@ void worker_iouring_cleanup(
     if (iouring_context != NULL) {
         ring = iouring_context->ring;
 
+        worker_iouring_sqpoll_shared_ring_release(ring);
+
         // Unregister the files
         io_uring_unregister_files(ring);
         io_uring_support_free(ring);
 
+        if (iouring_context->timer_wheel) {
+            timer_wheel_free(iouring_context->timer_wheel);
+        }
+
         // Free up the context
         xalloc_free(iouring_context);
     }
@@ -296,44 +320,161 @@ void worker_iouring_cleanup(
     worker_context->interface_context = NULL;
 }
 
+static bool worker_iouring_process_events_spin(
+        worker_iouring_context_t *context) {
+    uint64_t spin_until = intrinsics_tsc() + context->spin_before_sleep_cycles;
+
+    do {
+        if (io_uring_cq_ready(context->ring) > 0) {
+            return true;
+        }
+
+        // If the kernel has task work pending (coop taskrun) the completions will not show up till the ring is
+        // entered, no reason to keep spinning
+        if (IO_URING_READ_ONCE(*context->ring->sq.kflags) & IORING_SQ_TASKRUN) {
+            return false;
+        }
+    } while(intrinsics_tsc() < spin_until);
+
+    return false;
+}
+
+static bool worker_iouring_submit_requires_syscall(
+        io_uring_t *ring) {
+    if (io_uring_sq_ready(ring) == 0) {
+        return false;
+    }
+
+    // With sqpoll enabled the syscall is required only to wake up the kernel thread
+    if (ring->flags & IORING_SETUP_SQPOLL) {
+        return (IO_URING_READ_ONCE(*ring->sq.kflags) & IORING_SQ_NEED_WAKEUP) != 0;
+    }
+
+    return true;
+}
+
+static void worker_iouring_timer_wheel_arm(
+        worker_iouring_context_t *context) {
+    if (timer_wheel_is_empty(context->timer_wheel)) {
+        return;
+    }
+
+    // A single timeout is used to wake up the loop for all the timers of the worker, a new one is enqueued only if
+    // there isn't one already in flight expiring before the next tick the wheel has to process
+    uint64_t next_tick = timer_wheel_get_next_tick(context->timer_wheel);
+    if (next_tick >= context->timer_wheel_armed_tick) {
+        return;
+    }
+
+    int64_t now_ms = clock_monotonic_int64_ms();
+    int64_t next_tick_ms = (int64_t)timer_wheel_tick_to_ms(context->timer_wheel, next_tick);
+    int64_t wait_ms = next_tick_ms > now_ms ? next_tick_ms - now_ms : 0;
+    kernel_timespec_t kernel_timespec = {
+            .tv_sec = wait_ms / 1000,
+            .tv_nsec = (wait_ms % 1000) * 1000000,
+    };
+
+    if (unlikely(!io_uring_support_sqe_enqueue_timeout(
+            context->ring,
+            0,
+            &kernel_timespec,
+            0,
+            (uintptr_t)context->timer_wheel))) {
+        return;
+    }
+
+    context->timer_wheel_armed_tick = next_tick;
+}
+
 bool worker_iouring_process_events(
         worker_context_t *worker_context) {
     io_uring_cqe_t *cqe;
+    io_uring_cqe_t *cqes[WORKER_IOURING_CQE_BATCH_SIZE];
     worker_iouring_context_t *context;
     fiber_t *fiber;
-    uint32_t head, count = 0;
+    uint32_t count;
+    worker_stats_t *stats = worker_stats_get_internal_current();
 
     context = worker_context->interface_context;
 
-    io_uring_support_sqe_submit_and_wait(context->ring, 1);
+    worker_iouring_timer_wheel_arm(context);
 
-    io_uring_for_each_cqe(context->ring, head, cqe) {
-        count++;
-        fiber = (fiber_t*)cqe->user_data;
+    // If there are fibers that yielded waiting to be resumed the loop must not go to sleep, the sqes are submitted and
+    // whatever completion is available is processed before resuming them.
+    // The sqes enqueued by the fibers during the previous iteration are submitted all together here.
+    // If spinning is enabled, submit the sqes and busy wait for the completions for a while before going to sleep, with
+    // sqpoll enabled the submission doesn't require a syscall unless the kernel thread has to be woken up
+    if (fiber_scheduler_has_ready_fibers()) {
+        if (worker_iouring_submit_requires_syscall(context->ring)) {
+            stats->iouring.syscalls++;
+        }
+        io_uring_support_sqe_submit(context->ring);
+    } else if (context->spin_before_sleep_cycles > 0) {
+        if (worker_iouring_submit_requires_syscall(context->ring)) {
+            stats->iouring.syscalls++;
+        }
+        io_uring_support_sqe_submit(context->ring);
 
-        // When using link timeout a second CQE is issued that must not be processed so the user data is set to NULL
-        // therefore if fiber is set to NULL the cqe will be skipped
-        if (fiber == NULL) {
-            continue;
+        if (!worker_iouring_process_events_spin(context)) {
+            stats->iouring.syscalls++;
+            io_uring_support_sqe_submit_and_wait(context->ring, 1);
         }
+    } else {
+        stats->iouring.syscalls++;
+        io_uring_support_sqe_submit_and_wait(context->ring, 1);
+    }
+
+    // Reap the completions in batches, the cq is advanced only after the fibers have processed the cqes as they get
+    // a pointer to them
+    do {
+        count = io_uring_peek_batch_cqe(context->ring, cqes, WORKER_IOURING_CQE_BATCH_SIZE);
+
+        for(uint32_t index = 0; index < count; index++) {
+            cqe = cqes[index];
+            fiber = (fiber_t*)cqe->user_data;
+
+            // The cqes that must not be processed (e.g. the completion of the cancel requests issued for the
+            // operations timed out) have the user data set to NULL therefore if fiber is set to NULL the cqe will be
+            // skipped
+            if (fiber == NULL) {
+                continue;
+            }
+
+            // The timeout of the timer wheel doesn't belong to any fiber, it's only used to wake up the loop, the wheel
+            // is advanced once all the completions have been processed
+            if (unlikely(cqe->user_data == (uintptr_t)context->timer_wheel)) {
+                context->timer_wheel_armed_tick = UINT64_MAX;
+                continue;
+            }
+
+            // The outcome of the wakeups sent to the other workers via the mailbox, not bound to any fiber either
+            if (unlikely(worker_mailbox_is_wakeup_cqe(cqe->user_data))) {
+                worker_mailbox_wakeup_completed(cqe->user_data, cqe->res);
+                continue;
+            }
 
 #if DEBUG == 1
-        if (worker_iouring_cqe_is_error(cqe)) {
-            worker_iouring_cqe_log(cqe);
-        }
+            if (worker_iouring_cqe_is_error(cqe)) {
+                worker_iouring_cqe_log(cqe);
+            }
 #endif
 
-        if (cqe->user_data == 0) {
-            FATAL(
-                    TAG,
-                    "Malformed io_uring cqe, fiber is null!");
+            fiber->ret.ptr_value = cqe;
+            fiber_scheduler_switch_to(fiber);
         }
 
-        fiber->ret.ptr_value = cqe;
-        fiber_scheduler_switch_to(fiber);
-    }
+        io_uring_support_cq_advance(context->ring, count);
+        stats->iouring.completions += count;
+    } while(count == WORKER_IOURING_CQE_BATCH_SIZE);
 
-    io_uring_support_cq_advance(context->ring, count);
+    // Fire the expired timers, resuming the sleeping fibers and cancelling the operations that timed out, the wheel is
+    // advanced even if empty to keep its current tick in sync with the clock
+    timer_wheel_advance(context->timer_wheel, clock_monotonic_int64_ms());
+
+    // Resume the fibers that yielded because they were running for longer than their time slice
+    if (fiber_scheduler_has_ready_fibers()) {
+        fiber_scheduler_resume_ready_fibers();
+    }
 
     return true;
 }
@@ -344,6 +485,7 @@ void worker_iouring_check_capabilities() {
             io_uring_capabilities_is_linked_op_files_update_supported();
     io_uring_supports_setup_taskrun = io_uring_capabilities_is_setup_taskrun_supported();
     io_uring_supports_single_issuer = io_uring_capabilities_is_single_issuer_supported();
+    io_uring_supports_defer_taskrun = io_uring_capabilities_is_defer_taskrun_supported();
 }
 
 bool worker_iouring_initialize(
@@ -352,10 +494,27 @@ bool worker_iouring_initialize(
         uint32_t entries) {
     worker_iouring_context_t *context;
     io_uring_t *ring;
+    bool sqpoll_shared_lock_held = false;
+    config_network_polling_t *polling = worker_context->config->network->polling;
     io_uring_params_t *params = xalloc_alloc_zero(sizeof(io_uring_params_t));
 
     worker_iouring_check_capabilities();
 
+    bool sqpoll_enabled =
+            polling != NULL &&
+            polling->mode == CONFIG_NETWORK_POLLING_MODE_SQPOLL &&
+            io_uring_capabilities_is_sqpoll_supported();
+    bool spin_enabled = polling != NULL && polling->spin_before_sleep_us > 0;
+
+    // With defer taskrun the completions are posted only when the worker enters the ring to wait for them, it requires
+    // single issuer, it's not compatible with sqpoll and it's pointless when spinning as the completions would never
+    // show up without entering the ring
+    bool defer_taskrun_enabled =
+            io_uring_supports_defer_taskrun &&
+            io_uring_supports_single_issuer &&
+            !sqpoll_enabled &&
+            !spin_enabled;
+
     if (worker_context->worker_index == 0) {
         char available_features_str[512] = {0};
         LOG_V(
@@ -374,27 +533,71 @@ bool worker_iouring_initialize(
                         " performance penalty");
         }
 
-        if (io_uring_supports_setup_taskrun) {
+        if (defer_taskrun_enabled) {
+            LOG_V(TAG, "io_uring defer taskrun supported and enabled");
+        } else if (io_uring_supports_setup_taskrun && !sqpoll_enabled) {
             LOG_V(TAG, "io_uring coop taskrun supported and enabled");
-            params->flags |= IORING_SETUP_TASKRUN_FLAG | IORING_SETUP_COOP_TASKRUN;
         }
 
         if (io_uring_supports_single_issuer) {
             LOG_V(TAG, "io_uring single issuer supported and enabled");
-            params->flags |= IORING_SETUP_SINGLE_ISSUER;
+        }
+
+        if (polling != NULL && polling->mode == CONFIG_NETWORK_POLLING_MODE_SQPOLL && !sqpoll_enabled) {
+            LOG_W(TAG, "io_uring sqpoll not supported, falling back to the interrupt polling mode");
         }
     }
 
-    context = (worker_iouring_context_t*)xalloc_alloc(sizeof(worker_iouring_context_t));
+    // The kernel rejects the taskrun flags together with sqpoll, the task work is run by the sqpoll thread
+    if (defer_taskrun_enabled) {
+        params->flags |= IORING_SETUP_TASKRUN_FLAG | IORING_SETUP_DEFER_TASKRUN;
+    } else if (io_uring_supports_setup_taskrun && !sqpoll_enabled) {
+        params->flags |= IORING_SETUP_TASKRUN_FLAG | IORING_SETUP_COOP_TASKRUN;
+    }
+
+    if (io_uring_supports_single_issuer) {
+        params->flags |= IORING_SETUP_SINGLE_ISSUER;
+    }
+
+    if (sqpoll_enabled) {
+        params->flags |= IORING_SETUP_SQPOLL;
+        params->sq_thread_idle = polling->sqpoll_idle_ms > 0
+                ? polling->sqpoll_idle_ms
+                : WORKER_IOURING_SQPOLL_IDLE_MS_DEFAULT;
+
+        // The lock is held till the ring is initialized, the first worker initializing the ring will provide the
+        // sqpoll thread to which all the other workers will be attached
+        if (polling->sqpoll_shared) {
+            spinlock_lock(&worker_iouring_sqpoll_shared_lock);
+            sqpoll_shared_lock_held = true;
+
+            if (worker_iouring_sqpoll_shared_ring_fd != -1) {
+                params->flags |= IORING_SETUP_ATTACH_WQ;
+                params->wq_fd = worker_iouring_sqpoll_shared_ring_fd;
+            }
+        }
+    }
+
+    context = (worker_iouring_context_t*)xalloc_alloc_zero(sizeof(worker_iouring_context_t));
     worker_context->interface_context = context;
     uint32_t fds_count = max_fd;
 
     LOG_V(TAG, "Initializing local worker ring for io_uring");
 
-    if ((ring = io_uring_support_init(
+    ring = io_uring_support_init(
             entries,
             params,
-            NULL)) == NULL) {
+            NULL);
+
+    if (sqpoll_shared_lock_held) {
+        if (ring != NULL && worker_iouring_sqpoll_shared_ring_fd == -1) {
+            worker_iouring_sqpoll_shared_ring_fd = ring->ring_fd;
+        }
+
+        spinlock_unlock(&worker_iouring_sqpoll_shared_lock);
+    }
+
+    if (ring == NULL) {
         xalloc_free(params);
         xalloc_free(context);
 
@@ -408,9 +611,18 @@ bool worker_iouring_initialize(
     // to be cleaned up so better to do it afterwards.
     context->core_index = worker_context->core_index;
     context->ring = ring;
+    context->timer_wheel = timer_wheel_new(WORKER_IOURING_TIMER_WHEEL_TICK_MS, clock_monotonic_int64_ms());
+    context->timer_wheel_armed_tick = UINT64_MAX;
+
+    if (polling != NULL && polling->spin_before_sleep_us > 0) {
+        context->spin_before_sleep_cycles =
+                (intrinsics_frequency_max() / 1000000) * (uint64_t)polling->spin_before_sleep_us;
+    }
+
     worker_iouring_context_set(context);
 
     if (worker_iouring_fds_register(fds_count, ring) == false) {
+        worker_iouring_sqpoll_shared_ring_release(ring);
         io_uring_support_free(ring);
         return false;
     }
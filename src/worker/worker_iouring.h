@@ -5,6 +5,10 @@
 extern "C" {
 #endif
 
+#define WORKER_IOURING_SQPOLL_IDLE_MS_DEFAULT (10)
+#define WORKER_IOURING_CQE_BATCH_SIZE (64)
+#define WORKER_IOURING_TIMER_WHEEL_TICK_MS (1)
+
 #define WORKER_FDS_MA_FILES_FD_TYPE_GET(fd) ((fd) >> 31 == WORKER_FDS_MAP_FILES_FD_TYPE_NETWORK_CHANNEL)
 
 enum worker_iouring_fds_map_files_fd_type {
@@ -17,6 +21,9 @@ typedef struct worker_iouring_context worker_iouring_context_t;
 struct worker_iouring_context {
     uint32_t core_index;
     io_uring_t *ring;
+    uint64_t spin_before_sleep_cycles;
+    struct timer_wheel *timer_wheel;
+    uint64_t timer_wheel_armed_tick;
 };
 
 worker_iouring_context_t* worker_iouring_context_get();
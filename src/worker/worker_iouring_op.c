@@ -28,6 +28,7 @@
 #include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
 #include "data_structures/hashtable/spsc/hashtable_spsc.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/timer_wheel/timer_wheel.h"
 #include "support/io_uring/io_uring_support.h"
 #include "storage/io/storage_io_common.h"
 #include "storage/channel/storage_channel.h"
@@ -47,24 +48,30 @@
 
 #define TAG "worker_iouring_op"
 
+static void worker_iouring_op_wait_timer_fp(
+        __attribute__((unused)) timer_wheel_timer_t *timer,
+        void *user_data) {
+    fiber_t *fiber = user_data;
+
+    fiber->ret.ptr_value = NULL;
+    fiber_scheduler_switch_to(fiber);
+}
+
 bool worker_iouring_op_wait(
         long seconds,
         long long nanoseconds) {
-    kernel_timespec_t kernel_timespec = {
-            .tv_sec = seconds,
-            .tv_nsec = nanoseconds
-    };
+    timer_wheel_timer_t timer;
+    uint64_t ms = ((uint64_t)seconds * 1000ull) + (uint64_t)((nanoseconds + 999999ll) / 1000000ll);
 
-    bool res = io_uring_support_sqe_enqueue_timeout(
-            worker_iouring_context_get()->ring,
-            0,
-            &kernel_timespec,
-            0,
-            (uintptr_t) fiber_scheduler_get_current());
-
-    if (res == false) {
-        return false;
-    }
+    // The sleeping fibers are tracked by the timer wheel of the worker, no sqe is submitted per fiber, the timer lives
+    // on the stack of the fiber as it can't return before the timer has fired
+    timer_wheel_timer_init(&timer);
+    timer_wheel_add(
+            worker_iouring_context_get()->timer_wheel,
+            &timer,
+            clock_monotonic_int64_ms() + ms,
+            worker_iouring_op_wait_timer_fp,
+            fiber_scheduler_get_current());
 
     // Switch the execution back to the scheduler
     fiber_scheduler_switch_back();
@@ -82,7 +89,29 @@ bool worker_iouring_op_wait_ms(
     return worker_iouring_op_wait(kernel_timespec.tv_sec, kernel_timespec.tv_nsec);
 }
 
+void worker_iouring_op_timer_add_ms(
+        timer_wheel_timer_t *timer,
+        uint64_t ms,
+        timer_wheel_timer_fp_t *fp,
+        void *user_data) {
+    timer_wheel_add(
+            worker_iouring_context_get()->timer_wheel,
+            timer,
+            clock_monotonic_int64_ms() + ms,
+            fp,
+            user_data);
+}
+
+bool worker_iouring_op_timer_remove(
+        timer_wheel_timer_t *timer) {
+    return timer_wheel_remove(
+            worker_iouring_context_get()->timer_wheel,
+            timer);
+}
+
 void worker_iouring_op_register() {
     worker_op_wait = worker_iouring_op_wait;
     worker_op_wait_ms = worker_iouring_op_wait_ms;
+    worker_op_timer_add_ms = worker_iouring_op_timer_add_ms;
+    worker_op_timer_remove = worker_iouring_op_timer_remove;
 }
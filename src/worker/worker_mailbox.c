@@ -0,0 +1,410 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <liburing.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "memory_fences.h"
+#include "spinlock.h"
+#include "xalloc.h"
+#include "log/log.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "support/io_uring/io_uring_support.h"
+#include "support/io_uring/io_uring_capabilities.h"
+#include "network/io/network_io_common.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_op.h"
+#include "worker/worker_iouring.h"
+#include "worker/worker_fiber.h"
+
+#include "worker_mailbox.h"
+
+#define TAG "worker_mailbox"
+
+worker_mailbox_t *worker_mailbox_new(
+        uint32_t workers_count,
+        uint32_t queue_size) {
+    worker_mailbox_t *mailbox = xalloc_alloc_aligned_zero(
+            64,
+            sizeof(worker_mailbox_t) + (sizeof(worker_mailbox_worker_t) * workers_count));
+
+    mailbox->workers_count = workers_count;
+    mailbox->queue_size = queue_size;
+    mailbox->msg_ring_supported = io_uring_capabilities_is_msg_ring_supported();
+
+    for(uint32_t receiver_index = 0; receiver_index < workers_count; receiver_index++) {
+        worker_mailbox_worker_t *receiver = &mailbox->workers[receiver_index];
+
+        receiver->ring_fd = -1;
+        receiver->fiber = NULL;
+        receiver->ready = false;
+        receiver->wakeup_pending = 0;
+        receiver->queues = xalloc_alloc_zero(sizeof(ring_bounded_queue_spsc_voidptr_t*) * workers_count);
+        receiver->overflows = xalloc_alloc_aligned_zero(64, sizeof(worker_mailbox_overflow_t) * workers_count);
+
+        for(uint32_t sender_index = 0; sender_index < workers_count; sender_index++) {
+            receiver->queues[sender_index] = ring_bounded_queue_spsc_voidptr_init(queue_size);
+            spinlock_init(&receiver->overflows[sender_index].lock);
+        }
+    }
+
+    return mailbox;
+}
+
+void worker_mailbox_free(
+        worker_mailbox_t *mailbox) {
+    for(uint32_t receiver_index = 0; receiver_index < mailbox->workers_count; receiver_index++) {
+        worker_mailbox_worker_t *receiver = &mailbox->workers[receiver_index];
+
+        for(uint32_t sender_index = 0; sender_index < mailbox->workers_count; sender_index++) {
+            worker_mailbox_message_t *message;
+            ring_bounded_queue_spsc_voidptr_t *queue = receiver->queues[sender_index];
+
+            // The messages not yet processed are dropped
+            while((message = ring_bounded_queue_spsc_voidptr_dequeue(queue)) != NULL) {
+                xalloc_free(message);
+            }
+
+            ring_bounded_queue_spsc_voidptr_free(queue);
+
+            message = receiver->overflows[sender_index].head;
+            while(message != NULL) {
+                worker_mailbox_message_t *next = message->next;
+                xalloc_free(message);
+                message = next;
+            }
+        }
+
+        xalloc_free(receiver->queues);
+        xalloc_free(receiver->overflows);
+    }
+
+    xalloc_free(mailbox);
+}
+
+bool worker_mailbox_enqueue(
+        worker_mailbox_t *mailbox,
+        uint32_t sender_worker_index,
+        uint32_t receiver_worker_index,
+        worker_mailbox_message_fp_t *fp,
+        void *user_data,
+        bool *wakeup_required) {
+    assert(sender_worker_index < mailbox->workers_count);
+    assert(receiver_worker_index < mailbox->workers_count);
+
+    worker_mailbox_worker_t *receiver = &mailbox->workers[receiver_worker_index];
+    worker_mailbox_message_t *message = xalloc_alloc(sizeof(worker_mailbox_message_t));
+    message->fp = fp;
+    message->user_data = user_data;
+
+    if (unlikely(!ring_bounded_queue_spsc_voidptr_enqueue(receiver->queues[sender_worker_index], message))) {
+        xalloc_free(message);
+        *wakeup_required = false;
+        return false;
+    }
+
+    // Only the first message posted after the receiver has started to drain the queues has to wake it up
+    *wakeup_required = __sync_val_compare_and_swap(&receiver->wakeup_pending, 0, 1) == 0;
+
+    return true;
+}
+
+static void worker_mailbox_enqueue_overflow(
+        worker_mailbox_t *mailbox,
+        uint32_t sender_worker_index,
+        uint32_t receiver_worker_index,
+        worker_mailbox_message_fp_t *fp,
+        void *user_data,
+        bool *wakeup_required) {
+    worker_mailbox_worker_t *receiver = &mailbox->workers[receiver_worker_index];
+    worker_mailbox_overflow_t *overflow = &receiver->overflows[sender_worker_index];
+    worker_mailbox_message_t *message = xalloc_alloc(sizeof(worker_mailbox_message_t));
+    message->fp = fp;
+    message->user_data = user_data;
+    message->next = NULL;
+
+    spinlock_lock(&overflow->lock);
+
+    if (overflow->tail) {
+        overflow->tail->next = message;
+    } else {
+        overflow->head = message;
+    }
+    overflow->tail = message;
+    overflow->count++;
+
+    spinlock_unlock(&overflow->lock);
+
+    *wakeup_required = __sync_val_compare_and_swap(&receiver->wakeup_pending, 0, 1) == 0;
+}
+
+bool worker_mailbox_enqueue_or_overflow(
+        worker_mailbox_t *mailbox,
+        uint32_t sender_worker_index,
+        uint32_t receiver_worker_index,
+        worker_mailbox_message_fp_t *fp,
+        void *user_data,
+        bool *wakeup_required) {
+    assert(sender_worker_index < mailbox->workers_count);
+    assert(receiver_worker_index < mailbox->workers_count);
+
+    worker_mailbox_overflow_t *overflow =
+            &mailbox->workers[receiver_worker_index].overflows[sender_worker_index];
+
+    // The queue can be used only if there is nothing waiting in the overflow list, otherwise the message would be
+    // processed before the ones sent earlier
+    MEMORY_FENCE_LOAD();
+    if (likely(overflow->count == 0)) {
+        if (likely(worker_mailbox_enqueue(
+                mailbox,
+                sender_worker_index,
+                receiver_worker_index,
+                fp,
+                user_data,
+                wakeup_required))) {
+            return true;
+        }
+    }
+
+    worker_mailbox_enqueue_overflow(
+            mailbox,
+            sender_worker_index,
+            receiver_worker_index,
+            fp,
+            user_data,
+            wakeup_required);
+
+    return true;
+}
+
+static void worker_mailbox_message_fiber_entrypoint(
+        void *user_data) {
+    worker_mailbox_message_t *message = user_data;
+
+    message->fp(message->user_data);
+    xalloc_free(message);
+
+    fiber_scheduler_terminate_current_fiber();
+}
+
+static void worker_mailbox_process_message(
+        worker_mailbox_message_t *message,
+        bool run_in_fiber) {
+    if (likely(run_in_fiber)) {
+        fiber_scheduler_new_fiber(
+                WORKER_MAILBOX_MESSAGE_FIBER_NAME,
+                strlen(WORKER_MAILBOX_MESSAGE_FIBER_NAME),
+                worker_mailbox_message_fiber_entrypoint,
+                message);
+    } else {
+        message->fp(message->user_data);
+        xalloc_free(message);
+    }
+}
+
+uint32_t worker_mailbox_process(
+        worker_mailbox_t *mailbox,
+        uint32_t receiver_worker_index,
+        bool run_in_fiber) {
+    uint32_t processed_count = 0;
+    worker_mailbox_worker_t *receiver = &mailbox->workers[receiver_worker_index];
+
+    // The flag has to be cleared before draining the queues, if a sender enqueues a message after the queue has been
+    // checked it will also issue a new wakeup
+    __sync_fetch_and_and(&receiver->wakeup_pending, 0);
+
+    for(uint32_t sender_index = 0; sender_index < mailbox->workers_count; sender_index++) {
+        ring_bounded_queue_spsc_voidptr_t *queue = receiver->queues[sender_index];
+
+        worker_mailbox_overflow_t *overflow = &receiver->overflows[sender_index];
+
+        // Only the messages already in the queue are processed to avoid being starved by a sender that keeps posting
+        uint32_t length = ring_bounded_queue_spsc_voidptr_get_length(queue);
+        for(uint32_t index = 0; index < length; index++) {
+            worker_mailbox_process_message(ring_bounded_queue_spsc_voidptr_dequeue(queue), run_in_fiber);
+            processed_count++;
+        }
+
+        MEMORY_FENCE_LOAD();
+        if (likely(overflow->count == 0)) {
+            continue;
+        }
+
+        // The overflow list is taken only once the queue is empty, the messages in the queue are always older. If the
+        // queue is not empty yet the list will be taken by one of the next runs, the messages of the sender keep
+        // going to the list until then so the wakeup_pending flag is set again by them or by the ones in the queue.
+        worker_mailbox_message_t *message = NULL;
+        spinlock_lock(&overflow->lock);
+        if (ring_bounded_queue_spsc_voidptr_get_length(queue) == 0) {
+            message = overflow->head;
+            overflow->head = NULL;
+            overflow->tail = NULL;
+            overflow->count = 0;
+        }
+        spinlock_unlock(&overflow->lock);
+
+        while(message != NULL) {
+            worker_mailbox_message_t *next = message->next;
+            worker_mailbox_process_message(message, run_in_fiber);
+            message = next;
+            processed_count++;
+        }
+    }
+
+    return processed_count;
+}
+
+static void worker_mailbox_wakeup(
+        worker_mailbox_worker_t *receiver) {
+    MEMORY_FENCE_LOAD();
+    if (unlikely(!receiver->ready)) {
+        return;
+    }
+
+    // The cqe posted onto the ring of the receiver carries the pointer to its mailbox fiber so the worker loop will
+    // switch to it as for any other completion, the cqe posted onto the ring of the sender carries the tagged pointer
+    // to the receiver to let worker_mailbox_wakeup_completed check the outcome of the operation
+    if (unlikely(!io_uring_support_sqe_enqueue_msg_ring(
+            worker_iouring_context_get()->ring,
+            receiver->ring_fd,
+            0,
+            (uintptr_t)receiver->fiber,
+            0,
+            (uintptr_t)receiver | WORKER_MAILBOX_WAKEUP_CQE_USER_DATA_TAG))) {
+        LOG_W(TAG, "Unable to wake up a worker, the message will be processed with the next wakeup");
+
+        // Reset the flag to let the next message try again to wake up the receiver
+        __sync_fetch_and_and(&receiver->wakeup_pending, 0);
+    }
+}
+
+void worker_mailbox_wakeup_completed(
+        uint64_t user_data,
+        int32_t res) {
+    worker_mailbox_worker_t *receiver =
+            (worker_mailbox_worker_t*)(uintptr_t)(user_data & ~WORKER_MAILBOX_WAKEUP_CQE_USER_DATA_TAG);
+
+    if (likely(res >= 0)) {
+        return;
+    }
+
+    // The cqe hasn't been posted onto the ring of the receiver (e.g. its cq is full), the flag is still set and would
+    // prevent any other wakeup, if nobody else has already issued a new wakeup it's sent again as the messages already
+    // enqueued would otherwise never be processed
+    LOG_D(TAG, "Failed to wake up a worker, error <%d>, trying again", res);
+
+    __sync_fetch_and_and(&receiver->wakeup_pending, 0);
+
+    // If the receiver is not ready it will drain the queues on its own once started
+    MEMORY_FENCE_LOAD();
+    if (receiver->ready && __sync_val_compare_and_swap(&receiver->wakeup_pending, 0, 1) == 0) {
+        worker_mailbox_wakeup(receiver);
+    }
+}
+
+bool worker_mailbox_post(
+        uint32_t receiver_worker_index,
+        worker_mailbox_message_fp_t *fp,
+        void *user_data) {
+    bool wakeup_required = false;
+    worker_context_t *worker_context = worker_context_get();
+
+    if (unlikely(worker_context == NULL || worker_context->mailbox == NULL)) {
+        return false;
+    }
+
+    worker_mailbox_t *mailbox = worker_context->mailbox;
+    if (unlikely(receiver_worker_index >= mailbox->workers_count)) {
+        return false;
+    }
+
+    if (unlikely(!worker_mailbox_enqueue_or_overflow(
+            mailbox,
+            worker_context->worker_index,
+            receiver_worker_index,
+            fp,
+            user_data,
+            &wakeup_required))) {
+        return false;
+    }
+
+    // If the receiver is polling or its mailbox fiber hasn't started yet, it will pick up the message on its own
+    if (!wakeup_required || !mailbox->msg_ring_supported) {
+        return true;
+    }
+
+    worker_mailbox_wakeup(&mailbox->workers[receiver_worker_index]);
+
+    return true;
+}
+
+void worker_mailbox_fiber_entrypoint(
+        void *user_data) {
+    worker_context_t *worker_context = worker_context_get();
+    worker_mailbox_t *mailbox = worker_context->mailbox;
+    worker_mailbox_worker_t *receiver = &mailbox->workers[worker_context->worker_index];
+
+    receiver->fiber = fiber_scheduler_get_current();
+    receiver->ring_fd = worker_iouring_context_get()->ring->ring_fd;
+    MEMORY_FENCE_STORE();
+    receiver->ready = true;
+    MEMORY_FENCE_STORE();
+
+    while(true) {
+        worker_mailbox_process(mailbox, worker_context->worker_index, true);
+
+        if (likely(mailbox->msg_ring_supported)) {
+            // Resumed by the cqe posted via IORING_OP_MSG_RING by the senders
+            fiber_scheduler_switch_back();
+        } else if (!worker_op_wait_ms(WORKER_MAILBOX_POLL_INTERVAL_MS)) {
+            break;
+        }
+    }
+
+    // Switch back
+    fiber_scheduler_switch_back();
+}
+
+bool worker_mailbox_worker_initialize(
+        worker_context_t *worker_context) {
+    if (worker_context->mailbox == NULL) {
+        return true;
+    }
+
+    return worker_fiber_register(
+            worker_context,
+            WORKER_MAILBOX_FIBER_NAME,
+            worker_mailbox_fiber_entrypoint,
+            NULL);
+}
+
+void worker_mailbox_worker_cleanup(
+        worker_context_t *worker_context) {
+    if (worker_context->mailbox == NULL) {
+        return;
+    }
+
+    worker_mailbox_t *mailbox = worker_context->mailbox;
+    worker_mailbox_worker_t *receiver = &mailbox->workers[worker_context->worker_index];
+
+    // Stop the other workers from sending wakeups, the ring is going to be closed
+    receiver->ready = false;
+    MEMORY_FENCE_STORE();
+}
@@ -0,0 +1,117 @@
+#ifndef CACHEGRAND_WORKER_MAILBOX_H
+#define CACHEGRAND_WORKER_MAILBOX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WORKER_MAILBOX_QUEUE_SIZE (4096)
+#define WORKER_MAILBOX_POLL_INTERVAL_MS (1)
+#define WORKER_MAILBOX_FIBER_NAME "worker-mailbox"
+#define WORKER_MAILBOX_MESSAGE_FIBER_NAME "worker-mailbox-message"
+
+// The user data of the cqe of the MSG_RING operation received by the sender is the pointer to the receiver tagged with
+// the lowest bit, the fibers and the receivers are aligned so it can't be mistaken for a fiber
+#define WORKER_MAILBOX_WAKEUP_CQE_USER_DATA_TAG (0x1ULL)
+
+typedef void (worker_mailbox_message_fp_t)(void *user_data);
+
+typedef struct worker_mailbox_message worker_mailbox_message_t;
+struct worker_mailbox_message {
+    worker_mailbox_message_fp_t *fp;
+    void *user_data;
+    // Only used when the message is put in the overflow list
+    worker_mailbox_message_t *next;
+};
+
+// When the queue towards a receiver is full the messages are appended to an overflow list, protected by a spinlock, so
+// they are never dropped. Once a sender has something in the overflow list all its new messages go there as well, and
+// the receiver takes the list only when the queue is empty, so the order of the messages of each sender is preserved.
+// Only the sender appends to the list, it can therefore check the count without taking the lock.
+typedef struct worker_mailbox_overflow worker_mailbox_overflow_t;
+struct worker_mailbox_overflow {
+    spinlock_lock_volatile_t lock;
+    uint32_volatile_t count;
+    worker_mailbox_message_t *head;
+    worker_mailbox_message_t *tail;
+} __attribute__((aligned(64)));
+
+// Each worker owns a set of spsc queues, one per sender, so the messages can be enqueued without any lock. The sender
+// wakes up the receiver via IORING_OP_MSG_RING, posting a cqe that carries the pointer to the mailbox fiber of the
+// receiver. The wakeup_pending flag ensures that only one wakeup is in flight, regardless of how many messages are
+// being posted, the receiver clears the flag before draining the queues to avoid losing any wakeup. If the MSG_RING
+// operation fails the sender clears the flag and sends the wakeup again.
+typedef struct worker_mailbox_worker worker_mailbox_worker_t;
+struct worker_mailbox_worker {
+    ring_bounded_queue_spsc_voidptr_t **queues;
+    worker_mailbox_overflow_t *overflows;
+    fiber_t *fiber;
+    int ring_fd;
+    bool_volatile_t ready;
+    uint32_volatile_t wakeup_pending;
+} __attribute__((aligned(64)));
+
+typedef struct worker_mailbox worker_mailbox_t;
+struct worker_mailbox {
+    uint32_t workers_count;
+    uint32_t queue_size;
+    bool msg_ring_supported;
+    worker_mailbox_worker_t workers[];
+};
+
+worker_mailbox_t *worker_mailbox_new(
+        uint32_t workers_count,
+        uint32_t queue_size);
+
+void worker_mailbox_free(
+        worker_mailbox_t *mailbox);
+
+bool worker_mailbox_enqueue(
+        worker_mailbox_t *mailbox,
+        uint32_t sender_worker_index,
+        uint32_t receiver_worker_index,
+        worker_mailbox_message_fp_t *fp,
+        void *user_data,
+        bool *wakeup_required);
+
+bool worker_mailbox_enqueue_or_overflow(
+        worker_mailbox_t *mailbox,
+        uint32_t sender_worker_index,
+        uint32_t receiver_worker_index,
+        worker_mailbox_message_fp_t *fp,
+        void *user_data,
+        bool *wakeup_required);
+
+uint32_t worker_mailbox_process(
+        worker_mailbox_t *mailbox,
+        uint32_t receiver_worker_index,
+        bool run_in_fiber);
+
+bool worker_mailbox_post(
+        uint32_t receiver_worker_index,
+        worker_mailbox_message_fp_t *fp,
+        void *user_data);
+
+static inline __attribute__((always_inline)) bool worker_mailbox_is_wakeup_cqe(
+        uint64_t user_data) {
+    return (user_data & WORKER_MAILBOX_WAKEUP_CQE_USER_DATA_TAG) != 0;
+}
+
+void worker_mailbox_wakeup_completed(
+        uint64_t user_data,
+        int32_t res);
+
+void worker_mailbox_fiber_entrypoint(
+        void *user_data);
+
+bool worker_mailbox_worker_initialize(
+        worker_context_t *worker_context);
+
+void worker_mailbox_worker_cleanup(
+        worker_context_t *worker_context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_WORKER_MAILBOX_H
@@ -15,3 +15,5 @@
 
 worker_op_wait_fp_t* worker_op_wait;
 worker_op_wait_ms_fp_t* worker_op_wait_ms;
+worker_op_timer_add_ms_fp_t* worker_op_timer_add_ms;
+worker_op_timer_remove_fp_t* worker_op_timer_remove;
@@ -12,8 +12,21 @@ typedef bool (worker_op_wait_fp_t)(
 typedef bool (worker_op_wait_ms_fp_t)(
         uint64_t ms);
 
+struct timer_wheel_timer;
+
+typedef void (worker_op_timer_add_ms_fp_t)(
+        struct timer_wheel_timer *timer,
+        uint64_t ms,
+        void (*fp)(struct timer_wheel_timer *timer, void *user_data),
+        void *user_data);
+
+typedef bool (worker_op_timer_remove_fp_t)(
+        struct timer_wheel_timer *timer);
+
 extern worker_op_wait_fp_t* worker_op_wait;
 extern worker_op_wait_ms_fp_t* worker_op_wait_ms;
+extern worker_op_timer_add_ms_fp_t* worker_op_timer_add_ms;
+extern worker_op_timer_remove_fp_t* worker_op_timer_remove;
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,337 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "xalloc.h"
+#include "spinlock.h"
+#include "log/log.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
+#include "network/network.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_op.h"
+#include "worker/worker_fiber.h"
+#include "worker/worker_mailbox.h"
+#include "worker/network/worker_network_op.h"
+
+#include "worker_rebalancer.h"
+
+#define TAG "worker_rebalancer"
+
+worker_rebalancer_t *worker_rebalancer_new(
+        uint32_t workers_count) {
+    worker_rebalancer_t *rebalancer = xalloc_alloc_zero(sizeof(worker_rebalancer_t));
+
+    rebalancer->workers_count = workers_count;
+    rebalancer->received_packets_last = xalloc_alloc_zero(sizeof(uint64_t) * workers_count);
+    rebalancer->last_update_timestamp = xalloc_alloc_zero(sizeof(struct timespec) * workers_count);
+    rebalancer->load = xalloc_alloc_zero(sizeof(uint64_t) * workers_count);
+    rebalancer->active_connections = xalloc_alloc_zero(sizeof(uint16_t) * workers_count);
+
+    return rebalancer;
+}
+
+void worker_rebalancer_free(
+        worker_rebalancer_t *rebalancer) {
+    xalloc_free(rebalancer->received_packets_last);
+    xalloc_free(rebalancer->last_update_timestamp);
+    xalloc_free(rebalancer->load);
+    xalloc_free(rebalancer->active_connections);
+    xalloc_free(rebalancer);
+}
+
+uint32_t worker_rebalancer_evaluate(
+        worker_rebalancer_t *rebalancer,
+        uint32_t worker_index,
+        uint32_t imbalance_threshold_percent,
+        uint32_t max_migrations_per_interval) {
+    uint64_t load_total = 0;
+    uint32_t target_worker_index = UINT32_MAX;
+
+    // The budget is recalculated at every interval, what was left from the previous one is dropped
+    rebalancer->migrations_budget = 0;
+
+    for(uint32_t index = 0; index < rebalancer->workers_count; index++) {
+        load_total += rebalancer->load[index];
+    }
+
+    uint64_t load_mean = load_total / rebalancer->workers_count;
+    uint64_t load_own = rebalancer->load[worker_index];
+    uint16_t active_connections_own = rebalancer->active_connections[worker_index];
+
+    // Moving the only connection of a worker would just move the hotspot somewhere else
+    if (load_mean == 0 || active_connections_own <= 1) {
+        return 0;
+    }
+
+    if (load_own * 100 <= load_mean * (100 + imbalance_threshold_percent)) {
+        return 0;
+    }
+
+    for(uint32_t index = 0; index < rebalancer->workers_count; index++) {
+        if (index == worker_index ||
+            rebalancer->load[index] * 100 >= load_mean * (100 - imbalance_threshold_percent)) {
+            continue;
+        }
+
+        if (target_worker_index == UINT32_MAX || rebalancer->load[index] < rebalancer->load[target_worker_index]) {
+            target_worker_index = index;
+        }
+    }
+
+    if (target_worker_index == UINT32_MAX) {
+        return 0;
+    }
+
+    // Assuming that all the connections of the worker generate the same load, move enough connections to bring either
+    // this worker or the target one back to the mean without overshooting
+    uint64_t load_per_connection = load_own / active_connections_own;
+    uint64_t load_to_move = MIN(load_own - load_mean, load_mean - rebalancer->load[target_worker_index]);
+    uint64_t connections_to_move = load_per_connection > 0 ? load_to_move / load_per_connection : 0;
+
+    if (connections_to_move == 0) {
+        connections_to_move = 1;
+    }
+
+    rebalancer->target_worker_index = target_worker_index;
+    rebalancer->migrations_budget = (uint32_t)MIN(
+            MIN(connections_to_move, (uint64_t)max_migrations_per_interval),
+            (uint64_t)active_connections_own - 1);
+
+    return rebalancer->migrations_budget;
+}
+
+static void worker_rebalancer_update_load(
+        worker_rebalancer_t *rebalancer) {
+    worker_stats_t stats;
+
+    for(uint32_t index = 0; index < rebalancer->workers_count; index++) {
+        if (!worker_stats_get_shared_by_index(index, &stats)) {
+            continue;
+        }
+
+        // The shared stats are published periodically, if nothing has changed the previous load is kept
+        struct timespec *last_update_timestamp = &rebalancer->last_update_timestamp[index];
+        if (stats.last_update_timestamp.tv_sec == last_update_timestamp->tv_sec &&
+            stats.last_update_timestamp.tv_nsec == last_update_timestamp->tv_nsec) {
+            continue;
+        }
+
+        if (last_update_timestamp->tv_sec != 0) {
+            int64_t elapsed_ms =
+                    ((stats.last_update_timestamp.tv_sec - last_update_timestamp->tv_sec) * 1000) +
+                    ((stats.last_update_timestamp.tv_nsec - last_update_timestamp->tv_nsec) / 1000000);
+
+            if (elapsed_ms > 0) {
+                rebalancer->load[index] =
+                        ((stats.network.received_packets - rebalancer->received_packets_last[index]) * 1000) /
+                        elapsed_ms;
+            }
+        }
+
+        rebalancer->received_packets_last[index] = stats.network.received_packets;
+        rebalancer->active_connections[index] = stats.network.active_connections;
+        *last_update_timestamp = stats.last_update_timestamp;
+    }
+
+    rebalancer->samples++;
+}
+
+bool worker_rebalancer_connection_should_migrate(
+        network_channel_t *network_channel,
+        uint32_t *target_worker_index) {
+    worker_rebalancer_t *rebalancer = worker_context_get()->rebalancer;
+
+    if (likely(rebalancer == NULL || rebalancer->migrations_budget == 0)) {
+        return false;
+    }
+
+    // The state of the TLS sessions is bound to the worker that performed the handshake
+    if (network_channel->tls.enabled) {
+        return false;
+    }
+
+    rebalancer->migrations_budget--;
+    *target_worker_index = rebalancer->target_worker_index;
+
+    return true;
+}
+
+static void worker_rebalancer_connection_migrated(
+        void *user_data) {
+    worker_rebalancer_migration_t *migration = user_data;
+    worker_stats_t *stats = worker_stats_get_internal_current();
+    module_t *module = module_get_by_id(migration->module_id);
+
+    network_channel_t *network_channel = worker_op_network_channel_new(NETWORK_CHANNEL_TYPE_CLIENT);
+    network_channel->module_id = migration->module_id;
+    network_channel->module_config = migration->module_config;
+    memcpy(&network_channel->address, &migration->address, sizeof(network_channel->address));
+    network_channel->timeout.read.sec = migration->timeout_read_sec;
+    network_channel->timeout.read.nsec = migration->timeout_read_nsec;
+    network_channel->timeout.write.sec = migration->timeout_write_sec;
+    network_channel->timeout.write.nsec = migration->timeout_write_nsec;
+
+    bool attached = network_attach(network_channel, migration->fd);
+    if (unlikely(!attached)) {
+        LOG_E(
+                TAG,
+                "[FD:%5d] Unable to take over the connection <%s>, closing it",
+                migration->fd,
+                migration->address.str);
+        network_io_common_socket_close(migration->fd, true);
+        network_channel->status = NETWORK_CHANNEL_STATUS_CLOSED;
+    } else {
+        stats->network.active_connections++;
+    }
+
+    // The module always takes the ownership of the connection context, if the connection couldn't be attached it will
+    // only free it up
+    module->connection_resume(network_channel, migration->connection_context);
+
+    if (unlikely(!attached) || network_channel->status == NETWORK_CHANNEL_STATUS_MIGRATED) {
+        worker_op_network_channel_free(network_channel);
+    } else if (network_channel->status != NETWORK_CHANNEL_STATUS_CLOSED) {
+        network_close(network_channel, true);
+    }
+
+    if (likely(attached)) {
+        stats->network.active_connections--;
+    }
+
+    xalloc_free(migration);
+}
+
+bool worker_rebalancer_connection_migrate(
+        network_channel_t *network_channel,
+        uint32_t target_worker_index,
+        void *connection_context) {
+    if (unlikely(module_get_by_id(network_channel->module_id)->connection_resume == NULL)) {
+        return false;
+    }
+
+    worker_rebalancer_migration_t *migration = xalloc_alloc_zero(sizeof(worker_rebalancer_migration_t));
+    migration->module_id = network_channel->module_id;
+    migration->module_config = network_channel->module_config;
+    memcpy(&migration->address, &network_channel->address, sizeof(migration->address));
+    migration->timeout_read_sec = network_channel->timeout.read.sec;
+    migration->timeout_read_nsec = network_channel->timeout.read.nsec;
+    migration->timeout_write_sec = network_channel->timeout.write.sec;
+    migration->timeout_write_nsec = network_channel->timeout.write.nsec;
+    migration->connection_context = connection_context;
+
+    if ((migration->fd = network_detach(network_channel)) < 0) {
+        xalloc_free(migration);
+        return false;
+    }
+
+    if (unlikely(!worker_mailbox_post(target_worker_index, worker_rebalancer_connection_migrated, migration))) {
+        network_io_common_fd_t fd = migration->fd;
+        xalloc_free(migration);
+
+        // The mailbox of the target is full, the connection is taken back, if it fails the connection is closed and
+        // the caller will find the channel not connected anymore
+        if (unlikely(!network_attach(network_channel, fd))) {
+            LOG_E(
+                    TAG,
+                    "[FD:%5d] Unable to take back the connection <%s>, closing it",
+                    fd,
+                    network_channel->address.str);
+            network_io_common_socket_close(fd, true);
+        }
+
+        return false;
+    }
+
+    LOG_V(
+            TAG,
+            "[FD:%5d] Connection <%s> moved to worker <%u>",
+            migration->fd,
+            migration->address.str,
+            target_worker_index);
+
+    worker_stats_get_internal_current()->network.migrated_connections++;
+
+    return true;
+}
+
+void worker_rebalancer_fiber_entrypoint(
+        void *user_data) {
+    worker_context_t *worker_context = worker_context_get();
+    worker_rebalancer_t *rebalancer = worker_context->rebalancer;
+    config_network_rebalancing_t *config_rebalancing = worker_context->config->network->rebalancing;
+
+    while(worker_op_wait_ms(config_rebalancing->interval_ms)) {
+        worker_rebalancer_update_load(rebalancer);
+
+        // The first sample only sets the baseline of the counters
+        if (rebalancer->samples < 2) {
+            continue;
+        }
+
+        uint32_t migrations_budget = worker_rebalancer_evaluate(
+                rebalancer,
+                worker_context->worker_index,
+                config_rebalancing->imbalance_threshold_percent,
+                config_rebalancing->max_migrations_per_interval);
+
+        if (migrations_budget > 0) {
+            LOG_V(
+                    TAG,
+                    "Worker overloaded, moving up to <%u> connections to worker <%u>",
+                    migrations_budget,
+                    rebalancer->target_worker_index);
+        }
+    }
+
+    // Switch back
+    fiber_scheduler_switch_back();
+}
+
+bool worker_rebalancer_worker_initialize(
+        worker_context_t *worker_context) {
+    // The connections are handed over via the mailbox
+    if (worker_context->config->network->rebalancing == NULL ||
+        worker_context->mailbox == NULL ||
+        worker_context->workers_count < 2) {
+        return true;
+    }
+
+    worker_context->rebalancer = worker_rebalancer_new(worker_context->workers_count);
+
+    return worker_fiber_register(
+            worker_context,
+            WORKER_REBALANCER_FIBER_NAME,
+            worker_rebalancer_fiber_entrypoint,
+            NULL);
+}
+
+void worker_rebalancer_worker_cleanup(
+        worker_context_t *worker_context) {
+    if (worker_context->rebalancer == NULL) {
+        return;
+    }
+
+    worker_rebalancer_free(worker_context->rebalancer);
+    worker_context->rebalancer = NULL;
+}
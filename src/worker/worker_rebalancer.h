@@ -0,0 +1,73 @@
+#ifndef CACHEGRAND_WORKER_REBALANCER_H
+#define CACHEGRAND_WORKER_REBALANCER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WORKER_REBALANCER_FIBER_NAME "worker-rebalancer"
+
+// Each worker runs a rebalancer fiber that periodically compares its load, measured as the amount of received packets
+// per second, with the load of the other workers. If the worker is overloaded it picks the least loaded worker as
+// target and sets a budget of connections to move, the connections are then moved by the modules between two commands
+// handing over the fd and the connection context via the mailbox of the target worker.
+typedef struct worker_rebalancer worker_rebalancer_t;
+struct worker_rebalancer {
+    uint32_t workers_count;
+    uint32_t target_worker_index;
+    uint32_t migrations_budget;
+    uint32_t samples;
+    uint64_t *received_packets_last;
+    struct timespec *last_update_timestamp;
+    uint64_t *load;
+    uint16_t *active_connections;
+};
+
+typedef struct worker_rebalancer_migration worker_rebalancer_migration_t;
+struct worker_rebalancer_migration {
+    network_io_common_fd_t fd;
+    module_id_t module_id;
+    config_module_t *module_config;
+    network_channel_socket_address_t address;
+    int64_t timeout_read_sec;
+    int64_t timeout_read_nsec;
+    int64_t timeout_write_sec;
+    int64_t timeout_write_nsec;
+    void *connection_context;
+};
+
+worker_rebalancer_t *worker_rebalancer_new(
+        uint32_t workers_count);
+
+void worker_rebalancer_free(
+        worker_rebalancer_t *rebalancer);
+
+uint32_t worker_rebalancer_evaluate(
+        worker_rebalancer_t *rebalancer,
+        uint32_t worker_index,
+        uint32_t imbalance_threshold_percent,
+        uint32_t max_migrations_per_interval);
+
+bool worker_rebalancer_connection_should_migrate(
+        network_channel_t *network_channel,
+        uint32_t *target_worker_index);
+
+bool worker_rebalancer_connection_migrate(
+        network_channel_t *network_channel,
+        uint32_t target_worker_index,
+        void *connection_context);
+
+void worker_rebalancer_fiber_entrypoint(
+        void *user_data);
+
+bool worker_rebalancer_worker_initialize(
+        worker_context_t *worker_context);
+
+void worker_rebalancer_worker_cleanup(
+        worker_context_t *worker_context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_WORKER_REBALANCER_H
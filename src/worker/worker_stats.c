@@ -61,6 +61,24 @@ void worker_stats_publish(
             (void*)&worker_stats_public->storage,
             &worker_stats_internal->storage,
             sizeof(worker_stats_public->storage));
+    memcpy(
+            (void*)&worker_stats_public->iouring,
+            &worker_stats_internal->iouring,
+            sizeof(worker_stats_public->iouring));
+    memcpy(
+            (void*)&worker_stats_public->blocking,
+            &worker_stats_internal->blocking,
+            sizeof(worker_stats_public->blocking));
+    memcpy(
+            (void*)&worker_stats_public->pubsub,
+            &worker_stats_internal->pubsub,
+            sizeof(worker_stats_public->pubsub));
+#if DEBUG == 1
+    memcpy(
+            (void*)&worker_stats_public->debug,
+            &worker_stats_internal->debug,
+            sizeof(worker_stats_public->debug));
+#endif
 }
 
 bool worker_stats_should_publish_totals_after_interval(
@@ -122,6 +140,32 @@ worker_stats_t *worker_stats_aggregate(
                 worker_stats_shared->network.accepted_tls_connections;
         aggregated_stats->network.active_tls_connections +=
                 worker_stats_shared->network.active_tls_connections;
+        aggregated_stats->network.output_buffers_size +=
+                worker_stats_shared->network.output_buffers_size;
+        if (worker_stats_shared->network.output_buffers_size_max >
+            aggregated_stats->network.output_buffers_size_max) {
+            aggregated_stats->network.output_buffers_size_max =
+                    worker_stats_shared->network.output_buffers_size_max;
+        }
+        aggregated_stats->network.output_buffers_limit_disconnections +=
+                worker_stats_shared->network.output_buffers_limit_disconnections;
+        aggregated_stats->network.buffers_size +=
+                worker_stats_shared->network.buffers_size;
+        aggregated_stats->network.tls_handshakes +=
+                worker_stats_shared->network.tls_handshakes;
+        aggregated_stats->network.tls_handshakes_failed +=
+                worker_stats_shared->network.tls_handshakes_failed;
+        aggregated_stats->network.tls_handshakes_duration_us +=
+                worker_stats_shared->network.tls_handshakes_duration_us;
+        if (worker_stats_shared->network.tls_handshakes_duration_us_max >
+            aggregated_stats->network.tls_handshakes_duration_us_max) {
+            aggregated_stats->network.tls_handshakes_duration_us_max =
+                    worker_stats_shared->network.tls_handshakes_duration_us_max;
+        }
+        aggregated_stats->network.tls_sessions_resumed +=
+                worker_stats_shared->network.tls_sessions_resumed;
+        aggregated_stats->network.migrated_connections +=
+                worker_stats_shared->network.migrated_connections;
 
         aggregated_stats->storage.written_data +=
                 worker_stats_shared->storage.written_data;
@@ -134,6 +178,46 @@ worker_stats_t *worker_stats_aggregate(
         aggregated_stats->storage.open_files +=
                 worker_stats_shared->storage.open_files;
 
+        aggregated_stats->iouring.syscalls +=
+                worker_stats_shared->iouring.syscalls;
+        aggregated_stats->iouring.completions +=
+                worker_stats_shared->iouring.completions;
+
+        aggregated_stats->blocking.blocked_clients +=
+                worker_stats_shared->blocking.blocked_clients;
+        aggregated_stats->blocking.served +=
+                worker_stats_shared->blocking.served;
+        aggregated_stats->blocking.timeouts +=
+                worker_stats_shared->blocking.timeouts;
+        aggregated_stats->blocking.push_to_pop_latency_us +=
+                worker_stats_shared->blocking.push_to_pop_latency_us;
+        if (worker_stats_shared->blocking.push_to_pop_latency_us_max >
+            aggregated_stats->blocking.push_to_pop_latency_us_max) {
+            aggregated_stats->blocking.push_to_pop_latency_us_max =
+                    worker_stats_shared->blocking.push_to_pop_latency_us_max;
+        }
+
+        aggregated_stats->pubsub.subscriptions +=
+                worker_stats_shared->pubsub.subscriptions;
+        aggregated_stats->pubsub.messages_published +=
+                worker_stats_shared->pubsub.messages_published;
+        aggregated_stats->pubsub.messages_delivered +=
+                worker_stats_shared->pubsub.messages_delivered;
+        aggregated_stats->pubsub.messages_dropped +=
+                worker_stats_shared->pubsub.messages_dropped;
+
+#if DEBUG == 1
+        aggregated_stats->debug.command_arena_commands +=
+                worker_stats_shared->debug.command_arena_commands;
+        aggregated_stats->debug.command_arena_allocations +=
+                worker_stats_shared->debug.command_arena_allocations;
+        if (worker_stats_shared->debug.command_arena_allocations_max >
+            aggregated_stats->debug.command_arena_allocations_max) {
+            aggregated_stats->debug.command_arena_allocations_max =
+                    worker_stats_shared->debug.command_arena_allocations_max;
+        }
+#endif
+
         if (worker_stats_shared->last_update_timestamp.tv_sec >
             aggregated_stats->last_update_timestamp.tv_sec) {
             aggregated_stats->last_update_timestamp.tv_sec =
@@ -18,6 +18,16 @@ struct worker_stats {
         uint16_t active_connections;
         uint64_t accepted_tls_connections;
         uint16_t active_tls_connections;
+        uint64_t output_buffers_size;
+        uint64_t output_buffers_size_max;
+        uint64_t output_buffers_limit_disconnections;
+        uint64_t buffers_size;
+        uint64_t tls_handshakes;
+        uint64_t tls_handshakes_failed;
+        uint64_t tls_handshakes_duration_us;
+        uint64_t tls_handshakes_duration_us_max;
+        uint64_t tls_sessions_resumed;
+        uint64_t migrated_connections;
     } network;
     struct {
         uint64_t written_data;
@@ -26,6 +36,30 @@ struct worker_stats {
         uint64_t read_iops;
         uint16_t open_files;
     } storage;
+    struct {
+        uint64_t syscalls;
+        uint64_t completions;
+    } iouring;
+    struct {
+        uint32_t blocked_clients;
+        uint64_t served;
+        uint64_t timeouts;
+        uint64_t push_to_pop_latency_us;
+        uint64_t push_to_pop_latency_us_max;
+    } blocking;
+    struct {
+        uint32_t subscriptions;
+        uint64_t messages_published;
+        uint64_t messages_delivered;
+        uint64_t messages_dropped;
+    } pubsub;
+#if DEBUG == 1
+    struct {
+        uint64_t command_arena_commands;
+        uint64_t command_arena_allocations;
+        uint64_t command_arena_allocations_max;
+    } debug;
+#endif
     struct timespec started_on_timestamp;
     struct timespec last_update_timestamp;
 };
@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "xalloc.h"
+
+#include "xalloc_arena.h"
+
+#define TAG "xalloc_arena"
+
+static xalloc_arena_block_t *xalloc_arena_block_new(
+        size_t size) {
+    xalloc_arena_block_t *block = xalloc_alloc_aligned(
+            XALLOC_ARENA_ALIGNMENT,
+            sizeof(xalloc_arena_block_t) + size);
+
+    block->next = NULL;
+    block->size = size;
+    block->offset = 0;
+
+    return block;
+}
+
+xalloc_arena_t *xalloc_arena_new(
+        size_t block_size) {
+    xalloc_arena_t *arena = xalloc_alloc_zero(sizeof(xalloc_arena_t));
+
+    arena->block_size = XALLOC_ARENA_ALIGN_SIZE(block_size);
+    arena->head = arena->current = xalloc_arena_block_new(arena->block_size);
+
+    return arena;
+}
+
+void xalloc_arena_free(
+        xalloc_arena_t *arena) {
+    xalloc_arena_block_t *block = arena->head;
+
+    while(block) {
+        xalloc_arena_block_t *next = block->next;
+        xalloc_free(block);
+        block = next;
+    }
+
+    xalloc_free(arena);
+}
+
+void xalloc_arena_reset(
+        xalloc_arena_t *arena) {
+    xalloc_arena_block_t *block = arena->head->next;
+
+    // Only the first block is kept, the overflow blocks are released to avoid keeping around a potentially large
+    // amount of memory for a connection that had to process a single large command
+    while(unlikely(block != NULL)) {
+        xalloc_arena_block_t *next = block->next;
+        xalloc_free(block);
+        block = next;
+    }
+
+    arena->head->next = NULL;
+    arena->head->offset = 0;
+    arena->current = arena->head;
+    arena->last_allocation = NULL;
+    arena->allocations_count = 0;
+}
+
+void *xalloc_arena_alloc_slow_path(
+        xalloc_arena_t *arena,
+        size_t size) {
+    size_t block_size = size > arena->block_size ? size : arena->block_size;
+    xalloc_arena_block_t *block = xalloc_arena_block_new(block_size);
+
+    arena->current->next = block;
+    arena->current = block;
+
+    block->offset = size;
+    arena->last_allocation = block->data;
+
+    return block->data;
+}
+
+void *xalloc_arena_realloc(
+        xalloc_arena_t *arena,
+        void *memptr,
+        size_t current_size,
+        size_t new_size) {
+    xalloc_arena_block_t *block = arena->current;
+    size_t current_aligned_size = XALLOC_ARENA_ALIGN_SIZE(current_size);
+    size_t new_aligned_size = XALLOC_ARENA_ALIGN_SIZE(new_size);
+
+    if (unlikely(memptr == NULL)) {
+        return xalloc_arena_alloc(arena, new_size);
+    }
+
+    // If the memory being resized is the last allocation and there is enough space in the current block it can be
+    // expanded in place, which is the common case when growing a list while parsing the arguments
+    if (likely(memptr == arena->last_allocation &&
+            block->offset - current_aligned_size + new_aligned_size <= block->size)) {
+        block->offset = block->offset - current_aligned_size + new_aligned_size;
+        return memptr;
+    }
+
+    void *memptr_new = xalloc_arena_alloc(arena, new_size);
+    memcpy(memptr_new, memptr, current_size < new_size ? current_size : new_size);
+
+    return memptr_new;
+}
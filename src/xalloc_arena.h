@@ -0,0 +1,88 @@
+#ifndef CACHEGRAND_XALLOC_ARENA_H
+#define CACHEGRAND_XALLOC_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XALLOC_ARENA_ALIGNMENT (16)
+#define XALLOC_ARENA_ALIGN_SIZE(SIZE) (((SIZE) + (XALLOC_ARENA_ALIGNMENT - 1)) & ~(XALLOC_ARENA_ALIGNMENT - 1))
+
+typedef struct xalloc_arena_block xalloc_arena_block_t;
+struct xalloc_arena_block {
+    xalloc_arena_block_t *next;
+    size_t size;
+    size_t offset;
+    char data[] __attribute__((__aligned__(XALLOC_ARENA_ALIGNMENT)));
+};
+
+// The arena is a bump allocator meant to hold short-lived allocations that are all released at the same time (e.g. the
+// data allocated to parse a command), the memory is never freed on a per-allocation basis but only when the arena is
+// reset. The first block is kept across the resets to avoid hitting the allocator for the common cases, the blocks
+// allocated to handle the overflows are instead freed.
+typedef struct xalloc_arena xalloc_arena_t;
+struct xalloc_arena {
+    xalloc_arena_block_t *head;
+    xalloc_arena_block_t *current;
+    size_t block_size;
+    void *last_allocation;
+    uint32_t allocations_count;
+};
+
+xalloc_arena_t *xalloc_arena_new(
+        size_t block_size);
+
+void xalloc_arena_free(
+        xalloc_arena_t *arena);
+
+void xalloc_arena_reset(
+        xalloc_arena_t *arena);
+
+void *xalloc_arena_alloc_slow_path(
+        xalloc_arena_t *arena,
+        size_t size);
+
+void *xalloc_arena_realloc(
+        xalloc_arena_t *arena,
+        void *memptr,
+        size_t current_size,
+        size_t new_size);
+
+static inline __attribute__((always_inline)) void *xalloc_arena_alloc(
+        xalloc_arena_t *arena,
+        size_t size) {
+    xalloc_arena_block_t *block = arena->current;
+    size_t aligned_size = XALLOC_ARENA_ALIGN_SIZE(size);
+
+    arena->allocations_count++;
+
+    if (unlikely(block->offset + aligned_size > block->size)) {
+        return xalloc_arena_alloc_slow_path(arena, aligned_size);
+    }
+
+    void *memptr = block->data + block->offset;
+    block->offset += aligned_size;
+    arena->last_allocation = memptr;
+
+    return memptr;
+}
+
+static inline __attribute__((always_inline)) void *xalloc_arena_alloc_zero(
+        xalloc_arena_t *arena,
+        size_t size) {
+    void *memptr = xalloc_arena_alloc(arena, size);
+    memset(memptr, 0, size);
+
+    return memptr;
+}
+
+static inline __attribute__((always_inline)) uint32_t xalloc_arena_get_allocations_count(
+        xalloc_arena_t *arena) {
+    return arena->allocations_count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_XALLOC_ARENA_H
@@ -0,0 +1,276 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "cmake_config.h"
+#include "data_structures/hyperloglog/hyperloglog.h"
+#include "data_structures/hyperloglog/hyperloglog_registers.h"
+
+void test_hyperloglog_add_range(
+        uint8_t *registers,
+        uint32_t start,
+        uint32_t count) {
+    for(uint32_t index = start; index < start + count; index++) {
+        std::string element = std::to_string(index);
+        hyperloglog_add(registers, element.c_str(), element.length());
+    }
+}
+
+TEST_CASE("data_structures/hyperloglog/hyperloglog.c", "[data_structures][hyperloglog]") {
+    std::vector<uint8_t> registers(HYPERLOGLOG_REGISTERS_COUNT, 0);
+    std::vector<uint8_t> registers_loaded(HYPERLOGLOG_REGISTERS_COUNT, 0);
+    std::vector<char> buffer(HYPERLOGLOG_DENSE_LENGTH);
+    hyperloglog_encoding_t encoding;
+    uint64_t cardinality;
+
+    SECTION("hyperloglog_add") {
+        SECTION("new element") {
+            REQUIRE(hyperloglog_add(registers.data(), "foo", 3));
+        }
+
+        SECTION("same element") {
+            REQUIRE(hyperloglog_add(registers.data(), "foo", 3));
+            REQUIRE(!hyperloglog_add(registers.data(), "foo", 3));
+        }
+
+        SECTION("empty element") {
+            REQUIRE(hyperloglog_add(registers.data(), "", 0));
+        }
+    }
+
+    SECTION("hyperloglog_cardinality") {
+        SECTION("empty") {
+            REQUIRE(hyperloglog_cardinality(registers.data()) == 0);
+        }
+
+        SECTION("few elements") {
+            hyperloglog_add(registers.data(), "foo", 3);
+            hyperloglog_add(registers.data(), "bar", 3);
+            hyperloglog_add(registers.data(), "zap", 3);
+
+            REQUIRE(hyperloglog_cardinality(registers.data()) == 3);
+        }
+
+        SECTION("standard error") {
+            uint32_t added = 0;
+
+            // The standard error with 16384 registers is 0.81%, the check is done with a larger margin
+            for(uint32_t count : { 1000, 10000, 100000, 1000000 }) {
+                test_hyperloglog_add_range(registers.data(), added, count - added);
+                added = count;
+
+                double error = ((double)hyperloglog_cardinality(registers.data()) - count) / count;
+                REQUIRE(error > -0.03);
+                REQUIRE(error < 0.03);
+            }
+        }
+    }
+
+    SECTION("hyperloglog_serialize") {
+        SECTION("empty sparse") {
+            size_t length = hyperloglog_serialize(registers.data(), HYPERLOGLOG_ENCODING_SPARSE, buffer.data());
+
+            // A single XZERO opcode covers all the registers
+            REQUIRE(length == HYPERLOGLOG_HEADER_LENGTH + 2);
+            REQUIRE(memcmp(buffer.data(), "HYLL", 4) == 0);
+            REQUIRE(buffer[4] == HYPERLOGLOG_ENCODING_SPARSE);
+            REQUIRE((uint8_t)buffer[HYPERLOGLOG_HEADER_LENGTH] == 0x7F);
+            REQUIRE((uint8_t)buffer[HYPERLOGLOG_HEADER_LENGTH + 1] == 0xFF);
+        }
+
+        SECTION("empty dense") {
+            size_t length = hyperloglog_serialize(registers.data(), HYPERLOGLOG_ENCODING_DENSE, buffer.data());
+
+            REQUIRE(length == HYPERLOGLOG_DENSE_LENGTH);
+            REQUIRE(length == 12304);
+            REQUIRE(buffer[4] == HYPERLOGLOG_ENCODING_DENSE);
+        }
+
+        SECTION("cardinality cached") {
+            test_hyperloglog_add_range(registers.data(), 0, 100);
+            size_t length = hyperloglog_serialize(registers.data(), HYPERLOGLOG_ENCODING_SPARSE, buffer.data());
+
+            REQUIRE(hyperloglog_validate(buffer.data(), length, &encoding));
+            REQUIRE(hyperloglog_cached_cardinality(buffer.data(), &cardinality));
+            REQUIRE(cardinality == hyperloglog_cardinality(registers.data()));
+        }
+
+        SECTION("sparse promoted to dense when too long") {
+            test_hyperloglog_add_range(registers.data(), 0, 10000);
+            size_t length = hyperloglog_serialize(registers.data(), HYPERLOGLOG_ENCODING_SPARSE, buffer.data());
+
+            REQUIRE(length == HYPERLOGLOG_DENSE_LENGTH);
+            REQUIRE(buffer[4] == HYPERLOGLOG_ENCODING_DENSE);
+        }
+
+        SECTION("sparse promoted to dense when a register is too large") {
+            registers[10] = HYPERLOGLOG_SPARSE_VALUE_MAX + 1;
+            size_t length = hyperloglog_serialize(registers.data(), HYPERLOGLOG_ENCODING_SPARSE, buffer.data());
+
+            REQUIRE(length == HYPERLOGLOG_DENSE_LENGTH);
+            REQUIRE(buffer[4] == HYPERLOGLOG_ENCODING_DENSE);
+        }
+    }
+
+    SECTION("hyperloglog_merge") {
+        SECTION("round trip") {
+            for(hyperloglog_encoding_t requested_encoding : {
+                    HYPERLOGLOG_ENCODING_SPARSE, HYPERLOGLOG_ENCODING_DENSE }) {
+                for(uint32_t count : { 0, 1, 100, 1000, 50000 }) {
+                    std::fill(registers.begin(), registers.end(), 0);
+                    std::fill(registers_loaded.begin(), registers_loaded.end(), 0);
+                    test_hyperloglog_add_range(registers.data(), 0, count);
+
+                    size_t length = hyperloglog_serialize(registers.data(), requested_encoding, buffer.data());
+                    REQUIRE(hyperloglog_validate(buffer.data(), length, &encoding));
+                    REQUIRE(hyperloglog_merge(registers_loaded.data(), buffer.data(), length));
+                    REQUIRE(registers_loaded == registers);
+                }
+            }
+        }
+
+        SECTION("union") {
+            std::vector<uint8_t> registers_other(HYPERLOGLOG_REGISTERS_COUNT, 0);
+            test_hyperloglog_add_range(registers.data(), 0, 5000);
+            test_hyperloglog_add_range(registers_other.data(), 2500, 5000);
+
+            size_t length = hyperloglog_serialize(registers.data(), HYPERLOGLOG_ENCODING_DENSE, buffer.data());
+            REQUIRE(hyperloglog_merge(registers_loaded.data(), buffer.data(), length));
+            length = hyperloglog_serialize(registers_other.data(), HYPERLOGLOG_ENCODING_SPARSE, buffer.data());
+            REQUIRE(hyperloglog_merge(registers_loaded.data(), buffer.data(), length));
+
+            for(size_t index = 0; index < HYPERLOGLOG_REGISTERS_COUNT; index++) {
+                REQUIRE(registers_loaded[index] == std::max(registers[index], registers_other[index]));
+            }
+        }
+
+        SECTION("corrupted sparse") {
+            size_t length = hyperloglog_serialize(registers.data(), HYPERLOGLOG_ENCODING_SPARSE, buffer.data());
+
+            SECTION("registers missing") {
+                buffer[HYPERLOGLOG_HEADER_LENGTH + 1] = (char)0xFE;
+                REQUIRE(!hyperloglog_merge(registers_loaded.data(), buffer.data(), length));
+            }
+
+            SECTION("registers in excess") {
+                buffer[length] = 0x00;
+                REQUIRE(!hyperloglog_merge(registers_loaded.data(), buffer.data(), length + 1));
+            }
+
+            SECTION("truncated opcode") {
+                REQUIRE(!hyperloglog_merge(registers_loaded.data(), buffer.data(), length - 1));
+            }
+        }
+    }
+
+    SECTION("hyperloglog_validate") {
+        size_t length = hyperloglog_serialize(registers.data(), HYPERLOGLOG_ENCODING_SPARSE, buffer.data());
+
+        SECTION("valid") {
+            REQUIRE(hyperloglog_validate(buffer.data(), length, &encoding));
+            REQUIRE(encoding == HYPERLOGLOG_ENCODING_SPARSE);
+        }
+
+        SECTION("too short") {
+            REQUIRE(!hyperloglog_validate(buffer.data(), HYPERLOGLOG_HEADER_LENGTH - 1, &encoding));
+        }
+
+        SECTION("wrong magic") {
+            buffer[0] = 'X';
+            REQUIRE(!hyperloglog_validate(buffer.data(), length, &encoding));
+        }
+
+        SECTION("unknown encoding") {
+            buffer[4] = 2;
+            REQUIRE(!hyperloglog_validate(buffer.data(), length, &encoding));
+        }
+
+        SECTION("dense with the wrong length") {
+            buffer[4] = HYPERLOGLOG_ENCODING_DENSE;
+            REQUIRE(!hyperloglog_validate(buffer.data(), length, &encoding));
+        }
+    }
+
+    SECTION("hyperloglog_cached_cardinality") {
+        hyperloglog_serialize(registers.data(), HYPERLOGLOG_ENCODING_SPARSE, buffer.data());
+
+        SECTION("valid") {
+            buffer[8] = 5;
+            buffer[9] = 1;
+            REQUIRE(hyperloglog_cached_cardinality(buffer.data(), &cardinality));
+            REQUIRE(cardinality == 261);
+        }
+
+        SECTION("invalid") {
+            buffer[15] = (char)0x80;
+            REQUIRE(!hyperloglog_cached_cardinality(buffer.data(), &cardinality));
+        }
+    }
+}
+
+TEST_CASE("data_structures/hyperloglog/hyperloglog_registers.c", "[data_structures][hyperloglog][hyperloglog_registers]") {
+    SECTION("hyperloglog_registers_merge_dense") {
+        std::vector<uint8_t> source(HYPERLOGLOG_REGISTERS_COUNT);
+        std::vector<uint8_t> initial(HYPERLOGLOG_REGISTERS_COUNT);
+        std::vector<char> buffer(HYPERLOGLOG_DENSE_LENGTH);
+
+        srand(42);
+        for(size_t index = 0; index < HYPERLOGLOG_REGISTERS_COUNT; index++) {
+            source[index] = rand() % 64;
+            initial[index] = rand() % 64;
+        }
+
+        hyperloglog_serialize(source.data(), HYPERLOGLOG_ENCODING_DENSE, buffer.data());
+        uint8_t *dense = (uint8_t*)buffer.data() + HYPERLOGLOG_HEADER_LENGTH;
+
+        // The counts not multiple of the vectors test the tails, the last registers are always merged by the loop
+        for(size_t registers_count : { 4, 32, 36, 40, 44, 72, 76, 132, HYPERLOGLOG_REGISTERS_COUNT }) {
+            std::vector<uint8_t> expected(initial.begin(), initial.begin() + registers_count);
+            for(size_t index = 0; index < registers_count; index++) {
+                expected[index] = std::max(initial[index], source[index]);
+            }
+
+            std::vector<uint8_t> registers(initial.begin(), initial.begin() + registers_count);
+            HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, loop)(registers.data(), dense, registers_count);
+            REQUIRE(registers == expected);
+
+            registers.assign(initial.begin(), initial.begin() + registers_count);
+            hyperloglog_registers_merge_dense(registers.data(), dense, registers_count);
+            REQUIRE(registers == expected);
+
+#if defined(__x86_64__)
+            if (__builtin_cpu_supports("avx2")) {
+                registers.assign(initial.begin(), initial.begin() + registers_count);
+                HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, avx2)(registers.data(), dense, registers_count);
+                REQUIRE(registers == expected);
+            }
+
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+                registers.assign(initial.begin(), initial.begin() + registers_count);
+                HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, avx512)(registers.data(), dense, registers_count);
+                REQUIRE(registers == expected);
+            }
+#endif
+#elif defined(__aarch64__)
+            registers.assign(initial.begin(), initial.begin() + registers_count);
+            HYPERLOGLOG_REGISTERS_NAME_IMPL(merge_dense, armv8a_neon)(registers.data(), dense, registers_count);
+            REQUIRE(registers == expected);
+#endif
+        }
+    }
+}
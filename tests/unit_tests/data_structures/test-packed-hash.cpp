@@ -0,0 +1,309 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstring>
+#include <string>
+
+#include "xalloc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+
+char *test_packed_hash_serialize(
+        packed_hash_builder_t *builder,
+        size_t *length) {
+    *length = packed_hash_builder_serialized_length(builder);
+    char *buffer = (char*)xalloc_alloc(*length);
+    packed_hash_builder_serialize(builder, buffer, *length);
+
+    return buffer;
+}
+
+bool test_packed_hash_get_equals(
+        packed_hash_t *packed_hash,
+        const char *field,
+        const char *value) {
+    packed_hash_entry_t entry = { nullptr };
+
+    if (!packed_hash_get(packed_hash, (char*)field, strlen(field), &entry)) {
+        return false;
+    }
+
+    return entry.value_length == strlen(value) && memcmp(entry.value, value, entry.value_length) == 0;
+}
+
+TEST_CASE("data_structures/packed_hash/packed_hash.c", "[data_structures][packed_hash]") {
+    packed_hash_t packed_hash = { };
+    packed_hash_builder_t builder = { };
+    packed_hash_entry_t entry = { nullptr };
+    size_t length = 0;
+    char *buffer = nullptr;
+
+    SECTION("packed_hash_init") {
+        SECTION("empty hash") {
+            packed_hash_builder_init(&builder, nullptr);
+            buffer = test_packed_hash_serialize(&builder, &length);
+
+            REQUIRE(length == sizeof(packed_hash_header_t));
+            REQUIRE(packed_hash_init(&packed_hash, buffer, length));
+            REQUIRE(packed_hash.encoding == PACKED_HASH_ENCODING_COMPACT);
+            REQUIRE(packed_hash.count == 0);
+            REQUIRE(!packed_hash_get(&packed_hash, (char*)"field", 5, &entry));
+        }
+
+        SECTION("too short") {
+            char data[4] = { 0 };
+            REQUIRE(!packed_hash_init(&packed_hash, data, sizeof(data)));
+        }
+
+        SECTION("invalid encoding") {
+            packed_hash_header_t header = { };
+            header.encoding = 99;
+            REQUIRE(!packed_hash_init(&packed_hash, (char*)&header, sizeof(header)));
+        }
+
+        SECTION("invalid length") {
+            packed_hash_builder_init(&builder, nullptr);
+            packed_hash_builder_set(&builder, (char*)"field", 5, (char*)"value", 5);
+            buffer = test_packed_hash_serialize(&builder, &length);
+
+            REQUIRE(!packed_hash_init(&packed_hash, buffer, length - 1));
+        }
+    }
+
+    SECTION("compact encoding") {
+        packed_hash_builder_init(&builder, nullptr);
+
+        REQUIRE(packed_hash_builder_set(&builder, (char*)"field1", 6, (char*)"value1", 6));
+        REQUIRE(packed_hash_builder_set(&builder, (char*)"field2", 6, (char*)"value2", 6));
+        REQUIRE(!packed_hash_builder_set(&builder, (char*)"field1", 6, (char*)"value3", 6));
+        REQUIRE(packed_hash_builder_count(&builder) == 2);
+
+        buffer = test_packed_hash_serialize(&builder, &length);
+
+        REQUIRE(packed_hash_init(&packed_hash, buffer, length));
+        REQUIRE(packed_hash.encoding == PACKED_HASH_ENCODING_COMPACT);
+        REQUIRE(packed_hash.count == 2);
+        REQUIRE(test_packed_hash_get_equals(&packed_hash, "field1", "value3"));
+        REQUIRE(test_packed_hash_get_equals(&packed_hash, "field2", "value2"));
+        REQUIRE(!packed_hash_get(&packed_hash, (char*)"field3", 6, &entry));
+
+        SECTION("packed_hash_iter_next") {
+            size_t offset = 0;
+
+            REQUIRE(packed_hash_iter_next(&packed_hash, &offset, &entry));
+            REQUIRE(std::string(entry.field, entry.field_length) == "field1");
+            REQUIRE(packed_hash_iter_next(&packed_hash, &offset, &entry));
+            REQUIRE(std::string(entry.field, entry.field_length) == "field2");
+            REQUIRE(!packed_hash_iter_next(&packed_hash, &offset, &entry));
+        }
+    }
+
+    SECTION("upgrade to table encoding") {
+        SECTION("too many entries") {
+            char fields[PACKED_HASH_COMPACT_MAX_ENTRIES + 1][16];
+
+            packed_hash_builder_init(&builder, nullptr);
+            for(int index = 0; index < PACKED_HASH_COMPACT_MAX_ENTRIES + 1; index++) {
+                size_t field_length = snprintf(fields[index], sizeof(fields[index]), "field%d", index);
+                REQUIRE(packed_hash_builder_set(&builder, fields[index], field_length, fields[index], field_length));
+            }
+
+            buffer = test_packed_hash_serialize(&builder, &length);
+
+            REQUIRE(packed_hash_init(&packed_hash, buffer, length));
+            REQUIRE(packed_hash.encoding == PACKED_HASH_ENCODING_TABLE);
+            REQUIRE(packed_hash.count == PACKED_HASH_COMPACT_MAX_ENTRIES + 1);
+            REQUIRE(packed_hash.buckets_count >= packed_hash.count * 2);
+
+            for(int index = 0; index < PACKED_HASH_COMPACT_MAX_ENTRIES + 1; index++) {
+                REQUIRE(test_packed_hash_get_equals(&packed_hash, fields[index], fields[index]));
+            }
+            REQUIRE(!packed_hash_get(&packed_hash, (char*)"missing", 7, &entry));
+
+            SECTION("packed_hash_bucket_get") {
+                uint32_t found = 0;
+                for(uint32_t bucket_index = 0; bucket_index < packed_hash.buckets_count; bucket_index++) {
+                    if (packed_hash_bucket_get(&packed_hash, bucket_index, &entry)) {
+                        found++;
+                    }
+                }
+
+                REQUIRE(found == packed_hash.count);
+            }
+        }
+
+        SECTION("long value") {
+            std::string value(PACKED_HASH_COMPACT_MAX_ENTRY_LENGTH + 1, 'a');
+
+            packed_hash_builder_init(&builder, nullptr);
+            packed_hash_builder_set(&builder, (char*)"field", 5, (char*)value.c_str(), value.length());
+            buffer = test_packed_hash_serialize(&builder, &length);
+
+            REQUIRE(packed_hash_init(&packed_hash, buffer, length));
+            REQUIRE(packed_hash.encoding == PACKED_HASH_ENCODING_TABLE);
+            REQUIRE(test_packed_hash_get_equals(&packed_hash, "field", value.c_str()));
+        }
+    }
+
+    SECTION("changes in place") {
+        char fields[PACKED_HASH_COMPACT_MAX_ENTRIES + 1][16];
+        packed_hash_entry_t entry_deleted = { nullptr };
+        uint32_t bucket_index_deleted = UINT32_MAX;
+
+        packed_hash_builder_init(&builder, nullptr);
+        for(int index = 0; index < PACKED_HASH_COMPACT_MAX_ENTRIES + 1; index++) {
+            size_t field_length = snprintf(fields[index], sizeof(fields[index]), "field%d", index);
+            REQUIRE(packed_hash_builder_set(&builder, fields[index], field_length, fields[index], field_length));
+        }
+
+        buffer = test_packed_hash_serialize(&builder, &length);
+        REQUIRE(packed_hash_init(&packed_hash, buffer, length));
+        REQUIRE(packed_hash.encoding == PACKED_HASH_ENCODING_TABLE);
+
+        auto header = (packed_hash_header_t*)buffer;
+        REQUIRE(header->deleted_entries_length == 0);
+        REQUIRE(header->deleted_buckets_count == 0);
+        REQUIRE(packed_hash_header_table_has_room(header, packed_hash.count / 2));
+        REQUIRE(!packed_hash_header_needs_compaction(header));
+
+        SECTION("packed_hash_entry_write") {
+            char entry_buffer[64];
+            size_t entry_length = packed_hash_entry_write(entry_buffer, (char*)"field", 5, (char*)"value", 5);
+            size_t offset = 0, field_length, value_length;
+            bool deleted;
+
+            REQUIRE(entry_length == packed_hash_entry_length(5, 5));
+            REQUIRE(packed_hash_entry_field_length_read(entry_buffer, entry_length, &offset, &field_length, &deleted));
+            REQUIRE(field_length == 5);
+            REQUIRE(!deleted);
+            REQUIRE(memcmp(entry_buffer + offset, "field", 5) == 0);
+
+            offset += field_length;
+            REQUIRE(packed_hash_entry_value_length_read(entry_buffer, entry_length, &offset, &value_length));
+            REQUIRE(value_length == 5);
+            REQUIRE(memcmp(entry_buffer + offset, "value", 5) == 0);
+
+            offset = 0;
+            packed_hash_entry_mark_deleted(entry_buffer);
+            REQUIRE(packed_hash_entry_field_length_read(entry_buffer, entry_length, &offset, &field_length, &deleted));
+            REQUIRE(field_length == 5);
+            REQUIRE(deleted);
+        }
+
+        SECTION("deleted entry") {
+            for(uint32_t bucket_index = 0; bucket_index < packed_hash.buckets_count; bucket_index++) {
+                if (packed_hash_bucket_get(&packed_hash, bucket_index, &entry_deleted) &&
+                    entry_deleted.field_length == 6 && memcmp(entry_deleted.field, "field0", 6) == 0) {
+                    bucket_index_deleted = bucket_index;
+                    break;
+                }
+            }
+            REQUIRE(bucket_index_deleted != UINT32_MAX);
+
+            // Delete the field as it would be done in place
+            packed_hash_entry_mark_deleted(packed_hash.entries + packed_hash.buckets[bucket_index_deleted] - 1);
+            packed_hash.buckets[bucket_index_deleted] = PACKED_HASH_BUCKET_DELETED;
+            header->count--;
+            header->deleted_buckets_count++;
+            header->deleted_entries_length += packed_hash_entry_length(6, 6);
+
+            REQUIRE(packed_hash_init(&packed_hash, buffer, length));
+            REQUIRE(packed_hash.count == PACKED_HASH_COMPACT_MAX_ENTRIES);
+            REQUIRE(!packed_hash_get(&packed_hash, (char*)"field0", 6, &entry));
+            REQUIRE(!packed_hash_bucket_get(&packed_hash, bucket_index_deleted, &entry));
+
+            for(int index = 1; index < PACKED_HASH_COMPACT_MAX_ENTRIES + 1; index++) {
+                REQUIRE(test_packed_hash_get_equals(&packed_hash, fields[index], fields[index]));
+            }
+
+            size_t offset = 0;
+            uint32_t iterated = 0;
+            while(packed_hash_iter_next(&packed_hash, &offset, &entry)) {
+                REQUIRE(!(entry.field_length == 6 && memcmp(entry.field, "field0", 6) == 0));
+                iterated++;
+            }
+            REQUIRE(iterated == packed_hash.count);
+
+            SECTION("rebuilt by the builder") {
+                packed_hash_builder_t builder_update = { };
+                size_t length_update;
+
+                packed_hash_builder_init(&builder_update, &packed_hash);
+                REQUIRE(packed_hash_builder_count(&builder_update) == PACKED_HASH_COMPACT_MAX_ENTRIES);
+
+                char *buffer_update = test_packed_hash_serialize(&builder_update, &length_update);
+                REQUIRE(packed_hash_init(&packed_hash, buffer_update, length_update));
+                REQUIRE(((packed_hash_header_t*)buffer_update)->deleted_entries_length == 0);
+                REQUIRE(((packed_hash_header_t*)buffer_update)->deleted_buckets_count == 0);
+                REQUIRE(!packed_hash_get(&packed_hash, (char*)"field0", 6, &entry));
+                REQUIRE(test_packed_hash_get_equals(&packed_hash, fields[1], fields[1]));
+
+                packed_hash_builder_free(&builder_update);
+                xalloc_free(buffer_update);
+            }
+        }
+
+        SECTION("invalid deleted entries length") {
+            header->deleted_entries_length = header->entries_length + 1;
+            REQUIRE(!packed_hash_init(&packed_hash, buffer, length));
+        }
+    }
+
+    SECTION("packed_hash_builder_init from an existing hash") {
+        packed_hash_builder_t builder_update = { };
+        char *buffer_update = nullptr;
+        size_t length_update;
+
+        packed_hash_builder_init(&builder, nullptr);
+        packed_hash_builder_set(&builder, (char*)"field1", 6, (char*)"value1", 6);
+        packed_hash_builder_set(&builder, (char*)"field2", 6, (char*)"value2", 6);
+        buffer = test_packed_hash_serialize(&builder, &length);
+        REQUIRE(packed_hash_init(&packed_hash, buffer, length));
+
+        packed_hash_builder_init(&builder_update, &packed_hash);
+        REQUIRE(packed_hash_builder_count(&builder_update) == 2);
+        REQUIRE(packed_hash_builder_get(&builder_update, (char*)"field2", 6, &entry));
+        REQUIRE(std::string(entry.value, entry.value_length) == "value2");
+
+        SECTION("packed_hash_builder_delete") {
+            REQUIRE(packed_hash_builder_delete(&builder_update, (char*)"field1", 6));
+            REQUIRE(!packed_hash_builder_delete(&builder_update, (char*)"field1", 6));
+            REQUIRE(!packed_hash_builder_get(&builder_update, (char*)"field1", 6, &entry));
+            REQUIRE(packed_hash_builder_count(&builder_update) == 1);
+
+            buffer_update = test_packed_hash_serialize(&builder_update, &length_update);
+            REQUIRE(packed_hash_init(&packed_hash, buffer_update, length_update));
+            REQUIRE(packed_hash.count == 1);
+            REQUIRE(!packed_hash_get(&packed_hash, (char*)"field1", 6, &entry));
+            REQUIRE(test_packed_hash_get_equals(&packed_hash, "field2", "value2"));
+        }
+
+        SECTION("set after delete") {
+            REQUIRE(packed_hash_builder_delete(&builder_update, (char*)"field1", 6));
+            REQUIRE(packed_hash_builder_set(&builder_update, (char*)"field1", 6, (char*)"value3", 6));
+            REQUIRE(packed_hash_builder_count(&builder_update) == 2);
+
+            buffer_update = test_packed_hash_serialize(&builder_update, &length_update);
+            REQUIRE(packed_hash_init(&packed_hash, buffer_update, length_update));
+            REQUIRE(test_packed_hash_get_equals(&packed_hash, "field1", "value3"));
+        }
+
+        packed_hash_builder_free(&builder_update);
+        if (buffer_update) {
+            xalloc_free(buffer_update);
+        }
+    }
+
+    packed_hash_builder_free(&builder);
+    if (buffer) {
+        xalloc_free(buffer);
+    }
+}
@@ -0,0 +1,279 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "xalloc.h"
+#include "data_structures/packed_list/packed_list.h"
+
+char *test_packed_list_serialize(
+        packed_list_builder_t *builder,
+        size_t *length) {
+    *length = packed_list_builder_serialized_length(builder);
+    char *buffer = (char*)xalloc_alloc(*length);
+    packed_list_builder_serialize(builder, buffer, *length);
+
+    return buffer;
+}
+
+bool test_packed_list_equals(
+        packed_list_t *packed_list,
+        std::vector<std::string> &expected) {
+    packed_list_iter_t iter;
+    packed_list_entry_t entry;
+
+    if (packed_list->count != expected.size()) {
+        return false;
+    }
+
+    if (expected.empty()) {
+        return !packed_list_iter_init(packed_list, &iter, 0);
+    }
+
+    if (!packed_list_iter_init(packed_list, &iter, 0)) {
+        return false;
+    }
+
+    for(auto &value: expected) {
+        if (!packed_list_iter_next(&iter, &entry) || std::string(entry.value, entry.value_length) != value) {
+            return false;
+        }
+    }
+
+    return !packed_list_iter_next(&iter, &entry);
+}
+
+TEST_CASE("data_structures/packed_list/packed_list.c", "[data_structures][packed_list]") {
+    packed_list_t packed_list = { };
+    packed_list_builder_t builder = { };
+    packed_list_entry_t entry = { nullptr };
+    size_t length = 0;
+    char *buffer = nullptr;
+
+    SECTION("packed_list_init") {
+        SECTION("empty list") {
+            packed_list_builder_init(&builder, nullptr);
+            buffer = test_packed_list_serialize(&builder, &length);
+
+            REQUIRE(length == sizeof(packed_list_header_t));
+            REQUIRE(packed_list_init(&packed_list, buffer, length));
+            REQUIRE(packed_list.count == 0);
+            REQUIRE(!packed_list_get(&packed_list, 0, &entry));
+        }
+
+        SECTION("too short") {
+            char data[4] = { 0 };
+            REQUIRE(!packed_list_init(&packed_list, data, sizeof(data)));
+        }
+
+        SECTION("invalid length") {
+            packed_list_builder_init(&builder, nullptr);
+            packed_list_builder_push(&builder, false, (char*)"value", 5);
+            buffer = test_packed_list_serialize(&builder, &length);
+
+            REQUIRE(!packed_list_init(&packed_list, buffer, length - 1));
+        }
+
+        SECTION("invalid count") {
+            packed_list_builder_init(&builder, nullptr);
+            packed_list_builder_push(&builder, false, (char*)"value", 5);
+            buffer = test_packed_list_serialize(&builder, &length);
+            ((packed_list_header_t*)buffer)->count = 2;
+
+            REQUIRE(!packed_list_init(&packed_list, buffer, length));
+        }
+    }
+
+    SECTION("packed_list_builder_push") {
+        std::vector<std::string> expected = { "c", "b", "a", "d", "e" };
+
+        packed_list_builder_init(&builder, nullptr);
+        packed_list_builder_push(&builder, true, (char*)"a", 1);
+        packed_list_builder_push(&builder, true, (char*)"b", 1);
+        packed_list_builder_push(&builder, true, (char*)"c", 1);
+        packed_list_builder_push(&builder, false, (char*)"d", 1);
+        packed_list_builder_push(&builder, false, (char*)"e", 1);
+        REQUIRE(packed_list_builder_count(&builder) == 5);
+
+        buffer = test_packed_list_serialize(&builder, &length);
+
+        REQUIRE(packed_list_init(&packed_list, buffer, length));
+        REQUIRE(packed_list.nodes_count == 1);
+        REQUIRE(test_packed_list_equals(&packed_list, expected));
+
+        SECTION("packed_list_get") {
+            REQUIRE(packed_list_get(&packed_list, 3, &entry));
+            REQUIRE(std::string(entry.value, entry.value_length) == "d");
+            REQUIRE(!packed_list_get(&packed_list, 5, &entry));
+        }
+    }
+
+    SECTION("multiple nodes") {
+        std::vector<std::string> values;
+        std::vector<std::string> expected;
+        uint32_t count = (PACKED_LIST_NODE_MAX_ENTRIES * 3) + 10;
+
+        for(uint32_t index = 0; index < count; index++) {
+            values.push_back("value" + std::to_string(index));
+        }
+
+        packed_list_builder_init(&builder, nullptr);
+        for(auto &value: values) {
+            packed_list_builder_push(&builder, false, (char*)value.c_str(), value.length());
+        }
+
+        buffer = test_packed_list_serialize(&builder, &length);
+
+        REQUIRE(packed_list_init(&packed_list, buffer, length));
+        REQUIRE(packed_list.count == count);
+        REQUIRE(packed_list.nodes_count == 4);
+        REQUIRE(test_packed_list_equals(&packed_list, values));
+
+        for(uint32_t index = 0; index < count; index += 37) {
+            REQUIRE(packed_list_get(&packed_list, index, &entry));
+            REQUIRE(std::string(entry.value, entry.value_length) == values[index]);
+        }
+
+        SECTION("packed_list_iter_init in the middle of a node") {
+            packed_list_iter_t iter;
+            uint32_t start = PACKED_LIST_NODE_MAX_ENTRIES + 5;
+
+            REQUIRE(packed_list_iter_init(&packed_list, &iter, start));
+            for(uint32_t index = start; index < count; index++) {
+                REQUIRE(packed_list_iter_next(&iter, &entry));
+                REQUIRE(std::string(entry.value, entry.value_length) == values[index]);
+            }
+            REQUIRE(!packed_list_iter_next(&iter, &entry));
+        }
+
+        SECTION("packed_list_builder_init from an existing list") {
+            packed_list_builder_t builder_update = { };
+            char *buffer_update = nullptr;
+            size_t length_update;
+
+            packed_list_builder_init(&builder_update, &packed_list);
+            REQUIRE(packed_list_builder_count(&builder_update) == count);
+
+            SECTION("packed_list_builder_pop") {
+                REQUIRE(packed_list_builder_pop(&builder_update, true, &entry));
+                REQUIRE(std::string(entry.value, entry.value_length) == values.front());
+                REQUIRE(packed_list_builder_pop(&builder_update, false, &entry));
+                REQUIRE(std::string(entry.value, entry.value_length) == values.back());
+
+                expected.assign(values.begin() + 1, values.end() - 1);
+            }
+
+            SECTION("packed_list_builder_trim") {
+                uint32_t start = PACKED_LIST_NODE_MAX_ENTRIES + 5;
+                uint32_t stop = (PACKED_LIST_NODE_MAX_ENTRIES * 2) + 3;
+                packed_list_builder_trim(&builder_update, start, stop);
+                REQUIRE(packed_list_builder_count(&builder_update) == stop - start + 1);
+
+                expected.assign(values.begin() + start, values.begin() + stop + 1);
+            }
+
+            SECTION("pop everything") {
+                for(uint32_t index = 0; index < count; index++) {
+                    REQUIRE(packed_list_builder_pop(&builder_update, true, &entry));
+                }
+                REQUIRE(!packed_list_builder_pop(&builder_update, true, &entry));
+                REQUIRE(builder_update.nodes_count == 0);
+            }
+
+            buffer_update = test_packed_list_serialize(&builder_update, &length_update);
+            REQUIRE(packed_list_init(&packed_list, buffer_update, length_update));
+            REQUIRE(test_packed_list_equals(&packed_list, expected));
+
+            packed_list_builder_free(&builder_update);
+            xalloc_free(buffer_update);
+        }
+    }
+
+    SECTION("long entries") {
+        std::string value(PACKED_LIST_NODE_MAX_LENGTH, 'a');
+        std::vector<std::string> expected = { value, value };
+
+        packed_list_builder_init(&builder, nullptr);
+        packed_list_builder_push(&builder, false, (char*)value.c_str(), value.length());
+        packed_list_builder_push(&builder, false, (char*)value.c_str(), value.length());
+        buffer = test_packed_list_serialize(&builder, &length);
+
+        REQUIRE(packed_list_init(&packed_list, buffer, length));
+        REQUIRE(packed_list.nodes_count == 2);
+        REQUIRE(test_packed_list_equals(&packed_list, expected));
+    }
+
+    SECTION("packed_list_node") {
+        std::vector<std::string> expected = { "b", "a", "cc" };
+        size_t node_length = sizeof(packed_list_node_header_t);
+        char node[sizeof(packed_list_header_t) + sizeof(packed_list_node_header_t) + 64] = { 0 };
+        char *node_data = node + sizeof(packed_list_header_t);
+
+        packed_list_node_init(node_data);
+        REQUIRE(packed_list_node_has_room(node_data, PACKED_LIST_NODE_MAX_LENGTH * 2));
+        REQUIRE(!packed_list_node_edge_get(node_data, true, &entry));
+
+        packed_list_node_push(node_data, false, (char*)"a", 1);
+        packed_list_node_push(node_data, true, (char*)"b", 1);
+        packed_list_node_push(node_data, false, (char*)"cc", 2);
+        node_length += packed_list_node_entry_length(1) * 2 + packed_list_node_entry_length(2);
+
+        REQUIRE(((packed_list_node_header_t*)node_data)->count == 3);
+        REQUIRE(((packed_list_node_header_t*)node_data)->length == node_length - sizeof(packed_list_node_header_t));
+
+        SECTION("the header followed by the node is a valid packed list") {
+            auto header = (packed_list_header_t*)node;
+            header->count = 3;
+            header->nodes_count = 1;
+            header->nodes_length = node_length;
+
+            REQUIRE(packed_list_init(&packed_list, node, sizeof(packed_list_header_t) + node_length));
+            REQUIRE(test_packed_list_equals(&packed_list, expected));
+        }
+
+        SECTION("packed_list_node_edge_get and packed_list_node_edge_remove") {
+            REQUIRE(packed_list_node_edge_get(node_data, true, &entry));
+            REQUIRE(std::string(entry.value, entry.value_length) == "b");
+            packed_list_node_edge_remove(node_data, true, &entry);
+
+            REQUIRE(packed_list_node_edge_get(node_data, false, &entry));
+            REQUIRE(std::string(entry.value, entry.value_length) == "cc");
+            packed_list_node_edge_remove(node_data, false, &entry);
+
+            REQUIRE(packed_list_node_edge_get(node_data, true, &entry));
+            REQUIRE(std::string(entry.value, entry.value_length) == "a");
+            packed_list_node_edge_remove(node_data, true, &entry);
+
+            REQUIRE(((packed_list_node_header_t*)node_data)->count == 0);
+            REQUIRE(((packed_list_node_header_t*)node_data)->length == 0);
+            REQUIRE(!packed_list_node_edge_get(node_data, false, &entry));
+        }
+
+        SECTION("packed_list_node_has_room") {
+            auto node_header = (packed_list_node_header_t*)node_data;
+
+            node_header->count = PACKED_LIST_NODE_MAX_ENTRIES;
+            REQUIRE(!packed_list_node_has_room(node_data, 1));
+
+            node_header->count = 1;
+            node_header->length = PACKED_LIST_NODE_MAX_LENGTH - 1;
+            REQUIRE(!packed_list_node_has_room(node_data, 1));
+        }
+    }
+
+    packed_list_builder_free(&builder);
+    if (buffer) {
+        xalloc_free(buffer);
+    }
+}
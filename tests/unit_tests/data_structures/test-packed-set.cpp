@@ -0,0 +1,279 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+#include "xalloc.h"
+#include "data_structures/packed_hash/packed_hash.h"
+#include "data_structures/packed_set/packed_set.h"
+#include "data_structures/packed_set/packed_set_intset.h"
+
+char *test_packed_set_serialize(
+        packed_set_builder_t *builder,
+        size_t *length) {
+    *length = packed_set_builder_serialized_length(builder);
+    char *buffer = (char*)xalloc_alloc(*length);
+    packed_set_builder_serialize(builder, buffer, *length);
+
+    return buffer;
+}
+
+bool test_packed_set_contains(
+        packed_set_t *packed_set,
+        const char *value) {
+    return packed_set_contains(packed_set, (char*)value, strlen(value));
+}
+
+bool test_packed_set_builder_add(
+        packed_set_builder_t *builder,
+        const char *value) {
+    return packed_set_builder_add(builder, (char*)value, strlen(value));
+}
+
+std::vector<int64_t> test_packed_set_intset_build(
+        uint32_t count,
+        int64_t start,
+        int64_t step) {
+    std::vector<int64_t> integers;
+    for(uint32_t index = 0; index < count; index++) {
+        integers.push_back(start + ((int64_t)index * step));
+    }
+
+    return integers;
+}
+
+TEST_CASE("data_structures/packed_set/packed_set.c", "[data_structures][packed_set]") {
+    packed_set_t packed_set = { };
+    packed_set_builder_t builder = { };
+    size_t length = 0;
+    char *buffer = nullptr;
+
+    SECTION("packed_set_integer_parse") {
+        int64_t integer = 0;
+
+        REQUIRE(packed_set_integer_parse((char*)"0", 1, &integer));
+        REQUIRE(integer == 0);
+        REQUIRE(packed_set_integer_parse((char*)"-123", 4, &integer));
+        REQUIRE(integer == -123);
+        REQUIRE(packed_set_integer_parse((char*)"9223372036854775807", 19, &integer));
+        REQUIRE(integer == INT64_MAX);
+        REQUIRE(packed_set_integer_parse((char*)"-9223372036854775808", 20, &integer));
+        REQUIRE(integer == INT64_MIN);
+
+        REQUIRE(!packed_set_integer_parse((char*)"", 0, &integer));
+        REQUIRE(!packed_set_integer_parse((char*)"9223372036854775808", 19, &integer));
+        REQUIRE(!packed_set_integer_parse((char*)"007", 3, &integer));
+        REQUIRE(!packed_set_integer_parse((char*)"-0", 2, &integer));
+        REQUIRE(!packed_set_integer_parse((char*)"+1", 2, &integer));
+        REQUIRE(!packed_set_integer_parse((char*)"1a", 2, &integer));
+        REQUIRE(!packed_set_integer_parse((char*)"-", 1, &integer));
+    }
+
+    SECTION("packed_set_builder") {
+        packed_set_builder_init(&builder, nullptr);
+
+        SECTION("empty set") {
+            buffer = test_packed_set_serialize(&builder, &length);
+
+            REQUIRE(length == sizeof(packed_set_header_t));
+            REQUIRE(packed_set_init(&packed_set, buffer, length));
+            REQUIRE(packed_set.encoding == PACKED_SET_ENCODING_INTSET);
+            REQUIRE(packed_set.count == 0);
+            REQUIRE(!test_packed_set_contains(&packed_set, "1"));
+        }
+
+        SECTION("integers are kept sorted") {
+            REQUIRE(test_packed_set_builder_add(&builder, "30"));
+            REQUIRE(test_packed_set_builder_add(&builder, "-10"));
+            REQUIRE(test_packed_set_builder_add(&builder, "20"));
+            REQUIRE(!test_packed_set_builder_add(&builder, "20"));
+
+            buffer = test_packed_set_serialize(&builder, &length);
+
+            REQUIRE(packed_set_init(&packed_set, buffer, length));
+            REQUIRE(packed_set.encoding == PACKED_SET_ENCODING_INTSET);
+            REQUIRE(packed_set.count == 3);
+            REQUIRE(packed_set.integers[0] == -10);
+            REQUIRE(packed_set.integers[1] == 20);
+            REQUIRE(packed_set.integers[2] == 30);
+            REQUIRE(test_packed_set_contains(&packed_set, "20"));
+            REQUIRE(!test_packed_set_contains(&packed_set, "21"));
+            REQUIRE(!test_packed_set_contains(&packed_set, "020"));
+            REQUIRE(!test_packed_set_contains(&packed_set, "abc"));
+        }
+
+        SECTION("remove") {
+            REQUIRE(test_packed_set_builder_add(&builder, "1"));
+            REQUIRE(test_packed_set_builder_add(&builder, "2"));
+            REQUIRE(packed_set_builder_remove(&builder, (char*)"1", 1));
+            REQUIRE(!packed_set_builder_remove(&builder, (char*)"1", 1));
+            REQUIRE(!packed_set_builder_remove(&builder, (char*)"abc", 3));
+            REQUIRE(packed_set_builder_count(&builder) == 1);
+        }
+
+        SECTION("upgrade to hash on a non integer member") {
+            REQUIRE(test_packed_set_builder_add(&builder, "1"));
+            REQUIRE(test_packed_set_builder_add(&builder, "2"));
+            REQUIRE(test_packed_set_builder_add(&builder, "a"));
+            REQUIRE(!test_packed_set_builder_add(&builder, "1"));
+
+            buffer = test_packed_set_serialize(&builder, &length);
+
+            REQUIRE(packed_set_init(&packed_set, buffer, length));
+            REQUIRE(packed_set.encoding == PACKED_SET_ENCODING_HASH);
+            REQUIRE(packed_set.count == 3);
+            REQUIRE(test_packed_set_contains(&packed_set, "1"));
+            REQUIRE(test_packed_set_contains(&packed_set, "2"));
+            REQUIRE(test_packed_set_contains(&packed_set, "a"));
+            REQUIRE(!test_packed_set_contains(&packed_set, "b"));
+
+            size_t offset = 0;
+            packed_set_member_t member = { };
+            uint32_t members_count = 0;
+            while(packed_set_iter_next(&packed_set, &offset, &member)) {
+                REQUIRE(!member.is_integer);
+                members_count++;
+            }
+            REQUIRE(members_count == 3);
+        }
+
+        SECTION("upgrade to hash when too many integers") {
+            for(int index = 0; index < PACKED_SET_INTSET_MAX_ENTRIES + 1; index++) {
+                std::string value = std::to_string(index);
+                REQUIRE(packed_set_builder_add(&builder, (char*)value.c_str(), value.length()));
+            }
+
+            buffer = test_packed_set_serialize(&builder, &length);
+
+            REQUIRE(packed_set_init(&packed_set, buffer, length));
+            REQUIRE(packed_set.encoding == PACKED_SET_ENCODING_HASH);
+            REQUIRE(packed_set.count == PACKED_SET_INTSET_MAX_ENTRIES + 1);
+            REQUIRE(test_packed_set_contains(&packed_set, "0"));
+            REQUIRE(test_packed_set_contains(&packed_set, "512"));
+            REQUIRE(!test_packed_set_contains(&packed_set, "513"));
+        }
+
+        SECTION("builder from an existing set") {
+            REQUIRE(test_packed_set_builder_add(&builder, "1"));
+            REQUIRE(test_packed_set_builder_add(&builder, "2"));
+            buffer = test_packed_set_serialize(&builder, &length);
+            REQUIRE(packed_set_init(&packed_set, buffer, length));
+
+            packed_set_builder_t builder_new = { };
+            packed_set_builder_init(&builder_new, &packed_set);
+            REQUIRE(!test_packed_set_builder_add(&builder_new, "2"));
+            REQUIRE(test_packed_set_builder_add(&builder_new, "3"));
+            REQUIRE(packed_set_builder_count(&builder_new) == 3);
+
+            size_t offset = 0;
+            packed_set_member_t member = { };
+            std::vector<int64_t> integers;
+            while(packed_set_builder_iter_next(&builder_new, &offset, &member)) {
+                REQUIRE(member.is_integer);
+                integers.push_back(member.integer);
+            }
+            REQUIRE(integers == std::vector<int64_t>{ 1, 2, 3 });
+
+            packed_set_builder_free(&builder_new);
+        }
+
+        packed_set_builder_free(&builder);
+    }
+
+    SECTION("packed_set_init") {
+        SECTION("invalid encoding") {
+            packed_set_header_t header = { };
+            header.encoding = 0;
+            REQUIRE(!packed_set_init(&packed_set, (char*)&header, sizeof(header)));
+        }
+
+        SECTION("truncated intset") {
+            packed_set_header_t header = { };
+            header.encoding = PACKED_SET_ENCODING_INTSET;
+            header.count = 1;
+            REQUIRE(!packed_set_init(&packed_set, (char*)&header, sizeof(header)));
+        }
+    }
+
+    if (buffer) {
+        xalloc_free(buffer);
+    }
+}
+
+TEST_CASE("data_structures/packed_set/packed_set_intset.c", "[data_structures][packed_set][packed_set_intset]") {
+    uint32_t counts[] = { 0, 1, 3, 7, 16, 17, 33, 100, 512 };
+
+    SECTION("packed_set_intset_search") {
+        for(uint32_t count : counts) {
+            std::vector<int64_t> integers = test_packed_set_intset_build(count, -10, 2);
+
+            // Search for all the integers in the set, for the ones in between and for the ones outside the range
+            for(int64_t value = -13; value <= -10 + ((int64_t)count * 2) + 1; value++) {
+                uint32_t expected_position =
+                        std::lower_bound(integers.begin(), integers.end(), value) - integers.begin();
+                bool expected_found = expected_position < count && integers[expected_position] == value;
+                uint32_t position = UINT32_MAX;
+
+                REQUIRE(PACKED_SET_INTSET_NAME_IMPL(search, loop)(
+                        integers.data(), count, value, &position) == expected_found);
+                REQUIRE(position == expected_position);
+
+                position = UINT32_MAX;
+                REQUIRE(packed_set_intset_search(integers.data(), count, value, &position) == expected_found);
+                REQUIRE(position == expected_position);
+
+#if defined(__x86_64__)
+                if (__builtin_cpu_supports("avx2")) {
+                    position = UINT32_MAX;
+                    REQUIRE(PACKED_SET_INTSET_NAME_IMPL(search, avx2)(
+                            integers.data(), count, value, &position) == expected_found);
+                    REQUIRE(position == expected_position);
+                }
+#endif
+            }
+        }
+    }
+
+    SECTION("packed_set_intset_intersect") {
+        for(uint32_t a_count : counts) {
+            for(uint32_t b_count : counts) {
+                std::vector<int64_t> a = test_packed_set_intset_build(a_count, 0, 2);
+                std::vector<int64_t> b = test_packed_set_intset_build(b_count, 0, 3);
+                std::vector<int64_t> result(std::max(std::min(a_count, b_count), 1u));
+                std::vector<int64_t> expected;
+
+                std::set_intersection(
+                        a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+
+                uint32_t result_count = PACKED_SET_INTSET_NAME_IMPL(intersect, loop)(
+                        a.data(), a_count, b.data(), b_count, result.data());
+                REQUIRE(std::vector<int64_t>(result.begin(), result.begin() + result_count) == expected);
+
+                result_count = packed_set_intset_intersect(
+                        a.data(), a_count, b.data(), b_count, result.data());
+                REQUIRE(std::vector<int64_t>(result.begin(), result.begin() + result_count) == expected);
+
+#if defined(__x86_64__)
+                if (__builtin_cpu_supports("avx2")) {
+                    result_count = PACKED_SET_INTSET_NAME_IMPL(intersect, avx2)(
+                            a.data(), a_count, b.data(), b_count, result.data());
+                    REQUIRE(std::vector<int64_t>(result.begin(), result.begin() + result_count) == expected);
+                }
+#endif
+            }
+        }
+    }
+}
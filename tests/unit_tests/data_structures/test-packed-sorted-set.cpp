@@ -0,0 +1,171 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstring>
+#include <string>
+
+#include "xalloc.h"
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
+#include "data_structures/packed_sorted_set/packed_sorted_set.h"
+
+char *test_packed_sorted_set_serialize(
+        sorted_set_t *sorted_set,
+        size_t *length) {
+    *length = packed_sorted_set_serialized_length(sorted_set);
+    char *buffer = (char*)xalloc_alloc(*length);
+    packed_sorted_set_serialize(sorted_set, buffer, *length);
+
+    return buffer;
+}
+
+bool test_packed_sorted_set_find(
+        packed_sorted_set_t *packed_sorted_set,
+        const char *member,
+        uint32_t *rank,
+        packed_sorted_set_entry_t *entry) {
+    return packed_sorted_set_find(packed_sorted_set, (char*)member, strlen(member), rank, entry);
+}
+
+TEST_CASE("data_structures/packed_sorted_set/packed_sorted_set.c", "[data_structures][packed_sorted_set]") {
+    size_t length = 0;
+    uint32_t rank = 0;
+    packed_sorted_set_t packed_sorted_set = { };
+    packed_sorted_set_entry_t entry = { };
+    sorted_set_t *sorted_set = sorted_set_new();
+
+    SECTION("empty sorted set") {
+        char *buffer = test_packed_sorted_set_serialize(sorted_set, &length);
+
+        REQUIRE(packed_sorted_set_init(&packed_sorted_set, buffer, length));
+        REQUIRE(packed_sorted_set.count == 0);
+        REQUIRE(packed_sorted_set.buckets_count == PACKED_SORTED_SET_BUCKETS_MIN);
+        REQUIRE(!test_packed_sorted_set_find(&packed_sorted_set, "a", &rank, &entry));
+        REQUIRE(!packed_sorted_set_get(&packed_sorted_set, 0, &entry));
+        REQUIRE(packed_sorted_set_rank_by_score(&packed_sorted_set, 0, false) == 0);
+
+        xalloc_free(buffer);
+    }
+
+    SECTION("packed_sorted_set_init") {
+        char *buffer = test_packed_sorted_set_serialize(sorted_set, &length);
+
+        SECTION("too short") {
+            REQUIRE(!packed_sorted_set_init(&packed_sorted_set, buffer, sizeof(packed_sorted_set_header_t) - 1));
+        }
+
+        SECTION("buckets count not a power of 2") {
+            ((packed_sorted_set_header_t*)buffer)->buckets_count = 7;
+            REQUIRE(!packed_sorted_set_init(&packed_sorted_set, buffer, length));
+        }
+
+        SECTION("tables longer than the data") {
+            ((packed_sorted_set_header_t*)buffer)->count = 4;
+            REQUIRE(!packed_sorted_set_init(&packed_sorted_set, buffer, length));
+        }
+
+        xalloc_free(buffer);
+    }
+
+    SECTION("serialize and read") {
+        sorted_set_insert(sorted_set, (char*)"c", 1, 3);
+        sorted_set_insert(sorted_set, (char*)"a", 1, 1);
+        sorted_set_insert(sorted_set, (char*)"b", 1, 2);
+        sorted_set_insert(sorted_set, (char*)"bb", 2, 2);
+        sorted_set_insert(sorted_set, (char*)"a\0", 2, 5);
+
+        char *buffer = test_packed_sorted_set_serialize(sorted_set, &length);
+        REQUIRE(packed_sorted_set_init(&packed_sorted_set, buffer, length));
+        REQUIRE(packed_sorted_set.count == 5);
+
+        SECTION("packed_sorted_set_get") {
+            const char *members[] = { "a", "b", "bb", "c" };
+            double scores[] = { 1, 2, 2, 3 };
+
+            for(uint32_t index = 0; index < 4; index++) {
+                REQUIRE(packed_sorted_set_get(&packed_sorted_set, index, &entry));
+                REQUIRE(entry.score == scores[index]);
+                REQUIRE(std::string(entry.member, entry.member_length) == members[index]);
+            }
+
+            REQUIRE(packed_sorted_set_get(&packed_sorted_set, 4, &entry));
+            REQUIRE(entry.member_length == 2);
+            REQUIRE(memcmp(entry.member, "a\0", 2) == 0);
+            REQUIRE(!packed_sorted_set_get(&packed_sorted_set, 5, &entry));
+        }
+
+        SECTION("packed_sorted_set_find") {
+            REQUIRE(test_packed_sorted_set_find(&packed_sorted_set, "a", &rank, &entry));
+            REQUIRE(rank == 0);
+            REQUIRE(entry.score == 1);
+            REQUIRE(test_packed_sorted_set_find(&packed_sorted_set, "bb", &rank, &entry));
+            REQUIRE(rank == 2);
+            REQUIRE(packed_sorted_set_find(&packed_sorted_set, (char*)"a\0", 2, &rank, &entry));
+            REQUIRE(rank == 4);
+            REQUIRE(!test_packed_sorted_set_find(&packed_sorted_set, "d", &rank, &entry));
+            REQUIRE(!test_packed_sorted_set_find(&packed_sorted_set, "", &rank, &entry));
+        }
+
+        SECTION("packed_sorted_set_rank_by_score") {
+            REQUIRE(packed_sorted_set_rank_by_score(&packed_sorted_set, 0, false) == 0);
+            REQUIRE(packed_sorted_set_rank_by_score(&packed_sorted_set, 1, false) == 0);
+            REQUIRE(packed_sorted_set_rank_by_score(&packed_sorted_set, 1, true) == 1);
+            REQUIRE(packed_sorted_set_rank_by_score(&packed_sorted_set, 2, false) == 1);
+            REQUIRE(packed_sorted_set_rank_by_score(&packed_sorted_set, 2, true) == 3);
+            REQUIRE(packed_sorted_set_rank_by_score(&packed_sorted_set, 5, true) == 5);
+        }
+
+        SECTION("packed_sorted_set_load") {
+            size_t reloaded_length = 0;
+            sorted_set_t *reloaded_sorted_set = sorted_set_new();
+
+            REQUIRE(packed_sorted_set_load(&packed_sorted_set, reloaded_sorted_set));
+            REQUIRE(reloaded_sorted_set->count == 5);
+
+            char *reloaded_buffer = test_packed_sorted_set_serialize(reloaded_sorted_set, &reloaded_length);
+            REQUIRE(reloaded_length == length);
+            REQUIRE(memcmp(reloaded_buffer, buffer, length) == 0);
+
+            xalloc_free(reloaded_buffer);
+            sorted_set_free(reloaded_sorted_set);
+        }
+
+        xalloc_free(buffer);
+    }
+
+    SECTION("many members") {
+        for(int index = 0; index < 5000; index++) {
+            std::string member = "member-" + std::to_string(index);
+            sorted_set_insert(sorted_set, (char*)member.c_str(), member.length(), index % 100);
+        }
+
+        char *buffer = test_packed_sorted_set_serialize(sorted_set, &length);
+        REQUIRE(packed_sorted_set_init(&packed_sorted_set, buffer, length));
+        REQUIRE(packed_sorted_set.count == 5000);
+        REQUIRE(packed_sorted_set.buckets_count >= 10000);
+
+        for(int index = 0; index < 5000; index++) {
+            std::string member = "member-" + std::to_string(index);
+            sorted_set_node_t *node = sorted_set_get(sorted_set, (char*)member.c_str(), member.length());
+
+            REQUIRE(packed_sorted_set_find(&packed_sorted_set, (char*)member.c_str(), member.length(), &rank, &entry));
+            REQUIRE(rank == sorted_set_rank(sorted_set, node));
+            REQUIRE(entry.score == index % 100);
+        }
+
+        REQUIRE(packed_sorted_set_rank_by_score(&packed_sorted_set, 50, false) == 2500);
+
+        xalloc_free(buffer);
+    }
+
+    sorted_set_free(sorted_set);
+}
@@ -0,0 +1,292 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <utility>
+
+#include "data_structures/art_spsc/art_spsc.h"
+#include "data_structures/sorted_set/sorted_set.h"
+
+sorted_set_node_t *test_sorted_set_insert(
+        sorted_set_t *sorted_set,
+        const char *member,
+        double score) {
+    return sorted_set_insert(sorted_set, (char*)member, strlen(member), score);
+}
+
+sorted_set_node_t *test_sorted_set_get(
+        sorted_set_t *sorted_set,
+        const char *member) {
+    return sorted_set_get(sorted_set, (char*)member, strlen(member));
+}
+
+bool test_sorted_set_remove(
+        sorted_set_t *sorted_set,
+        const char *member) {
+    return sorted_set_remove(sorted_set, (char*)member, strlen(member));
+}
+
+std::string test_sorted_set_node_member(
+        sorted_set_node_t *node) {
+    return std::string(node->member, node->member_length);
+}
+
+void test_sorted_set_validate(
+        sorted_set_t *sorted_set,
+        std::set<std::pair<double, std::string>> &expected) {
+    uint64_t rank = 0;
+    sorted_set_node_t *previous = NULL;
+
+    REQUIRE(sorted_set->count == expected.size());
+
+    sorted_set_node_t *node = sorted_set_first(sorted_set);
+    for(auto &entry : expected) {
+        REQUIRE(node != NULL);
+        REQUIRE(node->score == entry.first);
+        REQUIRE(test_sorted_set_node_member(node) == entry.second);
+        REQUIRE(node->backward == previous);
+        REQUIRE(sorted_set_rank(sorted_set, node) == rank);
+        REQUIRE(sorted_set_get_by_rank(sorted_set, rank) == node);
+        REQUIRE(sorted_set_get(sorted_set, node->member, node->member_length) == node);
+
+        previous = node;
+        node = sorted_set_next(node);
+        rank++;
+    }
+
+    REQUIRE(node == NULL);
+    REQUIRE(sorted_set->tail == previous);
+    REQUIRE(sorted_set_get_by_rank(sorted_set, rank) == NULL);
+}
+
+TEST_CASE("data_structures/sorted_set/sorted_set.c", "[data_structures][sorted_set]") {
+    SECTION("sorted_set_new") {
+        sorted_set_t *sorted_set = sorted_set_new();
+
+        REQUIRE(sorted_set != NULL);
+        REQUIRE(sorted_set->count == 0);
+        REQUIRE(sorted_set_first(sorted_set) == NULL);
+        REQUIRE(sorted_set->tail == NULL);
+
+        sorted_set_free(sorted_set);
+    }
+
+    SECTION("sorted_set_compare") {
+        REQUIRE(sorted_set_compare(1, (char*)"b", 1, 2, (char*)"a", 1) < 0);
+        REQUIRE(sorted_set_compare(2, (char*)"a", 1, 1, (char*)"b", 1) > 0);
+        REQUIRE(sorted_set_compare(1, (char*)"a", 1, 1, (char*)"b", 1) < 0);
+        REQUIRE(sorted_set_compare(1, (char*)"a", 1, 1, (char*)"ab", 2) < 0);
+        REQUIRE(sorted_set_compare(1, (char*)"a", 1, 1, (char*)"a", 1) == 0);
+    }
+
+    SECTION("sorted_set_insert") {
+        sorted_set_t *sorted_set = sorted_set_new();
+
+        SECTION("single member") {
+            sorted_set_node_t *node = test_sorted_set_insert(sorted_set, "member", 1.5);
+
+            REQUIRE(node != NULL);
+            REQUIRE(node->score == 1.5);
+            REQUIRE(test_sorted_set_node_member(node) == "member");
+            REQUIRE(sorted_set->count == 1);
+            REQUIRE(test_sorted_set_get(sorted_set, "member") == node);
+            REQUIRE(test_sorted_set_get(sorted_set, "missing") == NULL);
+        }
+
+        SECTION("ordered by score and then by member") {
+            std::set<std::pair<double, std::string>> expected;
+
+            test_sorted_set_insert(sorted_set, "c", 2);
+            test_sorted_set_insert(sorted_set, "b", 2);
+            test_sorted_set_insert(sorted_set, "a", 3);
+            test_sorted_set_insert(sorted_set, "d", -1);
+            expected.insert({ 2, "c" });
+            expected.insert({ 2, "b" });
+            expected.insert({ 3, "a" });
+            expected.insert({ -1, "d" });
+
+            test_sorted_set_validate(sorted_set, expected);
+        }
+
+        SECTION("members differing only for trailing nul bytes") {
+            sorted_set_node_t *node_empty = sorted_set_insert(sorted_set, (char*)"", 0, 1);
+            sorted_set_node_t *node_a = sorted_set_insert(sorted_set, (char*)"a", 1, 2);
+            sorted_set_node_t *node_a_nul = sorted_set_insert(sorted_set, (char*)"a\0", 2, 3);
+
+            REQUIRE(sorted_set->count == 3);
+            REQUIRE(sorted_set_get(sorted_set, (char*)"", 0) == node_empty);
+            REQUIRE(sorted_set_get(sorted_set, (char*)"a", 1) == node_a);
+            REQUIRE(sorted_set_get(sorted_set, (char*)"a\0", 2) == node_a_nul);
+            REQUIRE(sorted_set_get(sorted_set, (char*)"a\0\0", 3) == NULL);
+        }
+
+        sorted_set_free(sorted_set);
+    }
+
+    SECTION("sorted_set_append") {
+        sorted_set_t *sorted_set = sorted_set_new();
+        std::set<std::pair<double, std::string>> expected;
+
+        for(int index = 0; index < 1000; index++) {
+            std::string member = "member-" + std::to_string(1000 + index);
+            sorted_set_append(sorted_set, (char*)member.c_str(), member.length(), index / 10);
+            expected.insert({ index / 10, member });
+        }
+
+        test_sorted_set_validate(sorted_set, expected);
+
+        // The nodes appended have to be fully linked, inserting and removing in the middle must keep the spans right
+        test_sorted_set_insert(sorted_set, "inserted", 50.5);
+        expected.insert({ 50.5, "inserted" });
+        REQUIRE(test_sorted_set_remove(sorted_set, "member-1500"));
+        expected.erase({ 50, "member-1500" });
+
+        test_sorted_set_validate(sorted_set, expected);
+
+        sorted_set_free(sorted_set);
+    }
+
+    SECTION("sorted_set_update_score") {
+        sorted_set_t *sorted_set = sorted_set_new();
+        std::set<std::pair<double, std::string>> expected;
+
+        test_sorted_set_insert(sorted_set, "a", 1);
+        test_sorted_set_insert(sorted_set, "b", 2);
+        sorted_set_node_t *node = test_sorted_set_insert(sorted_set, "c", 3);
+        expected.insert({ 1, "a" });
+        expected.insert({ 2, "b" });
+
+        SECTION("same position") {
+            REQUIRE(sorted_set_update_score(sorted_set, node, 4) == node);
+            expected.insert({ 4, "c" });
+
+            test_sorted_set_validate(sorted_set, expected);
+        }
+
+        SECTION("new position") {
+            REQUIRE(sorted_set_update_score(sorted_set, node, 0) == node);
+            expected.insert({ 0, "c" });
+
+            test_sorted_set_validate(sorted_set, expected);
+        }
+
+        sorted_set_free(sorted_set);
+    }
+
+    SECTION("sorted_set_remove") {
+        sorted_set_t *sorted_set = sorted_set_new();
+        std::set<std::pair<double, std::string>> expected;
+        size_t empty_size = sorted_set_size(sorted_set);
+
+        test_sorted_set_insert(sorted_set, "a", 1);
+        test_sorted_set_insert(sorted_set, "b", 2);
+        test_sorted_set_insert(sorted_set, "c", 3);
+        expected.insert({ 1, "a" });
+        expected.insert({ 3, "c" });
+
+        REQUIRE(test_sorted_set_remove(sorted_set, "b"));
+        REQUIRE(!test_sorted_set_remove(sorted_set, "b"));
+        REQUIRE(!test_sorted_set_remove(sorted_set, "missing"));
+        REQUIRE(test_sorted_set_get(sorted_set, "b") == NULL);
+
+        test_sorted_set_validate(sorted_set, expected);
+
+        REQUIRE(test_sorted_set_remove(sorted_set, "a"));
+        REQUIRE(test_sorted_set_remove(sorted_set, "c"));
+        REQUIRE(sorted_set->count == 0);
+        REQUIRE(sorted_set_first(sorted_set) == NULL);
+        REQUIRE(sorted_set->tail == NULL);
+        REQUIRE(sorted_set_size(sorted_set) == empty_size);
+
+        sorted_set_free(sorted_set);
+    }
+
+    SECTION("sorted_set_clone") {
+        sorted_set_t *sorted_set = sorted_set_new();
+        std::set<std::pair<double, std::string>> expected;
+
+        for(int index = 0; index < 1000; index++) {
+            std::string member = "member" + std::to_string(index);
+            test_sorted_set_insert(sorted_set, member.c_str(), index % 10);
+            expected.insert({ index % 10, member });
+        }
+
+        sorted_set_t *sorted_set_cloned = sorted_set_clone(sorted_set);
+        test_sorted_set_validate(sorted_set_cloned, expected);
+
+        SECTION("changes to the clone don't affect the original") {
+            REQUIRE(test_sorted_set_remove(sorted_set_cloned, "member0"));
+            test_sorted_set_insert(sorted_set_cloned, "new", 5);
+            sorted_set_update_score(sorted_set_cloned, test_sorted_set_get(sorted_set_cloned, "member1"), 100);
+
+            test_sorted_set_validate(sorted_set, expected);
+        }
+
+        sorted_set_free(sorted_set_cloned);
+        sorted_set_free(sorted_set);
+    }
+
+    SECTION("sorted_set_first_by_score") {
+        sorted_set_t *sorted_set = sorted_set_new();
+
+        test_sorted_set_insert(sorted_set, "a", 1);
+        test_sorted_set_insert(sorted_set, "b", 2);
+        test_sorted_set_insert(sorted_set, "c", 2);
+        test_sorted_set_insert(sorted_set, "d", 3);
+
+        REQUIRE(test_sorted_set_node_member(sorted_set_first_by_score(sorted_set, 0, false)) == "a");
+        REQUIRE(test_sorted_set_node_member(sorted_set_first_by_score(sorted_set, 2, false)) == "b");
+        REQUIRE(test_sorted_set_node_member(sorted_set_first_by_score(sorted_set, 2, true)) == "d");
+        REQUIRE(test_sorted_set_node_member(sorted_set_first_by_score(sorted_set, 2.5, false)) == "d");
+        REQUIRE(sorted_set_first_by_score(sorted_set, 3, true) == NULL);
+
+        sorted_set_free(sorted_set);
+    }
+
+    SECTION("random operations") {
+        sorted_set_t *sorted_set = sorted_set_new();
+        std::set<std::pair<double, std::string>> expected;
+        std::map<std::string, double> scores;
+        uint64_t state = 42;
+
+        for(int index = 0; index < 20000; index++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            std::string member = "m" + std::to_string((state >> 33) % 500);
+            double score = (double)((state >> 20) % 100);
+            uint64_t operation = (state >> 10) % 3;
+            sorted_set_node_t *node = sorted_set_get(sorted_set, (char*)member.c_str(), member.length());
+
+            if (operation == 0 && node) {
+                REQUIRE(sorted_set_remove(sorted_set, (char*)member.c_str(), member.length()));
+                expected.erase({ scores[member], member });
+                scores.erase(member);
+            } else if (node) {
+                sorted_set_update_score(sorted_set, node, score);
+                expected.erase({ scores[member], member });
+                expected.insert({ score, member });
+                scores[member] = score;
+            } else {
+                sorted_set_insert(sorted_set, (char*)member.c_str(), member.length(), score);
+                expected.insert({ score, member });
+                scores[member] = score;
+            }
+        }
+
+        test_sorted_set_validate(sorted_set, expected);
+
+        sorted_set_free(sorted_set);
+    }
+}
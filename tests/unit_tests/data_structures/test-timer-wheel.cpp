@@ -0,0 +1,203 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdbool>
+
+#include "data_structures/timer_wheel/timer_wheel.h"
+
+typedef struct test_timer_wheel_fired test_timer_wheel_fired_t;
+struct test_timer_wheel_fired {
+    uint32_t count;
+    uint64_t at_ms;
+    uint64_t *now_ms;
+};
+
+void test_timer_wheel_timer_fp(
+        timer_wheel_timer_t *timer,
+        void *user_data) {
+    auto fired = (test_timer_wheel_fired_t*)user_data;
+    fired->count++;
+    fired->at_ms = *fired->now_ms;
+}
+
+TEST_CASE("data_structures/timer_wheel/timer_wheel.c", "[data_structures][timer_wheel]") {
+    uint64_t now_ms = 1000;
+
+    SECTION("timer_wheel_new") {
+        timer_wheel_t *wheel = timer_wheel_new(1, now_ms);
+
+        REQUIRE(wheel != nullptr);
+        REQUIRE(wheel->tick_ms == 1);
+        REQUIRE(wheel->start_ms == now_ms);
+        REQUIRE(wheel->current_tick == 0);
+        REQUIRE(timer_wheel_is_empty(wheel));
+        REQUIRE(timer_wheel_get_next_tick(wheel) == UINT64_MAX);
+
+        timer_wheel_free(wheel);
+    }
+
+    SECTION("timer_wheel_add") {
+        timer_wheel_timer_t timer;
+        test_timer_wheel_fired_t fired = { 0, 0, &now_ms };
+        timer_wheel_t *wheel = timer_wheel_new(1, now_ms);
+        timer_wheel_timer_init(&timer);
+
+        SECTION("first level") {
+            timer_wheel_add(wheel, &timer, now_ms + 10, test_timer_wheel_timer_fp, &fired);
+
+            REQUIRE(timer_wheel_timer_is_armed(&timer));
+            REQUIRE(timer_wheel_get_count(wheel) == 1);
+            REQUIRE(timer.level == 0);
+            REQUIRE(timer_wheel_get_next_tick(wheel) == 10);
+        }
+
+        SECTION("second level") {
+            timer_wheel_add(wheel, &timer, now_ms + 1000, test_timer_wheel_timer_fp, &fired);
+
+            REQUIRE(timer.level == 1);
+            REQUIRE(timer_wheel_get_next_tick(wheel) == (1000 / TIMER_WHEEL_SLOTS) * TIMER_WHEEL_SLOTS);
+        }
+
+        SECTION("beyond the range of the wheel") {
+            timer_wheel_add(wheel, &timer, now_ms + TIMER_WHEEL_MAX_TICKS * 2, test_timer_wheel_timer_fp, &fired);
+
+            REQUIRE(timer.level == TIMER_WHEEL_LEVELS - 1);
+            REQUIRE(timer.expires_at_tick == TIMER_WHEEL_MAX_TICKS * 2);
+        }
+
+        SECTION("deadline already expired") {
+            timer_wheel_add(wheel, &timer, now_ms - 10, test_timer_wheel_timer_fp, &fired);
+
+            REQUIRE(timer.expires_at_tick == 1);
+        }
+
+        SECTION("re-arm") {
+            timer_wheel_add(wheel, &timer, now_ms + 10, test_timer_wheel_timer_fp, &fired);
+            timer_wheel_add(wheel, &timer, now_ms + 20, test_timer_wheel_timer_fp, &fired);
+
+            REQUIRE(timer_wheel_get_count(wheel) == 1);
+            REQUIRE(timer_wheel_get_next_tick(wheel) == 20);
+        }
+
+        timer_wheel_remove(wheel, &timer);
+        timer_wheel_free(wheel);
+    }
+
+    SECTION("timer_wheel_remove") {
+        timer_wheel_timer_t timer;
+        test_timer_wheel_fired_t fired = { 0, 0, &now_ms };
+        timer_wheel_t *wheel = timer_wheel_new(1, now_ms);
+        timer_wheel_timer_init(&timer);
+
+        REQUIRE(!timer_wheel_remove(wheel, &timer));
+
+        timer_wheel_add(wheel, &timer, now_ms + 10, test_timer_wheel_timer_fp, &fired);
+        REQUIRE(timer_wheel_remove(wheel, &timer));
+        REQUIRE(!timer_wheel_timer_is_armed(&timer));
+        REQUIRE(timer_wheel_is_empty(wheel));
+        REQUIRE(wheel->slots_bitmap[0] == 0);
+
+        now_ms += 100;
+        REQUIRE(timer_wheel_advance(wheel, now_ms) == 0);
+        REQUIRE(fired.count == 0);
+
+        timer_wheel_free(wheel);
+    }
+
+    SECTION("timer_wheel_advance") {
+        timer_wheel_t *wheel = timer_wheel_new(1, now_ms);
+
+        SECTION("not expired") {
+            timer_wheel_timer_t timer;
+            test_timer_wheel_fired_t fired = { 0, 0, &now_ms };
+            timer_wheel_timer_init(&timer);
+
+            timer_wheel_add(wheel, &timer, now_ms + 10, test_timer_wheel_timer_fp, &fired);
+            now_ms += 9;
+
+            REQUIRE(timer_wheel_advance(wheel, now_ms) == 0);
+            REQUIRE(timer_wheel_timer_is_armed(&timer));
+
+            timer_wheel_remove(wheel, &timer);
+        }
+
+        SECTION("fired at the deadline across the levels") {
+            uint64_t deadlines_ms[] = { 1, 63, 64, 65, 1000, 4095, 4096, 4097, 300000 };
+            const int timers_count = sizeof(deadlines_ms) / sizeof(uint64_t);
+            timer_wheel_timer_t timers[timers_count];
+            test_timer_wheel_fired_t fired[timers_count];
+            uint64_t start_ms = now_ms;
+
+            for(int index = 0; index < timers_count; index++) {
+                fired[index] = { 0, 0, &now_ms };
+                timer_wheel_timer_init(&timers[index]);
+                timer_wheel_add(
+                        wheel,
+                        &timers[index],
+                        start_ms + deadlines_ms[index],
+                        test_timer_wheel_timer_fp,
+                        &fired[index]);
+            }
+
+            while(!timer_wheel_is_empty(wheel)) {
+                now_ms++;
+                timer_wheel_advance(wheel, now_ms);
+            }
+
+            for(int index = 0; index < timers_count; index++) {
+                REQUIRE(fired[index].count == 1);
+                REQUIRE(fired[index].at_ms == start_ms + deadlines_ms[index]);
+            }
+        }
+
+        SECTION("large jump") {
+            timer_wheel_timer_t timer1, timer2;
+            test_timer_wheel_fired_t fired1 = { 0, 0, &now_ms };
+            test_timer_wheel_fired_t fired2 = { 0, 0, &now_ms };
+            timer_wheel_timer_init(&timer1);
+            timer_wheel_timer_init(&timer2);
+
+            timer_wheel_add(wheel, &timer1, now_ms + 100, test_timer_wheel_timer_fp, &fired1);
+            timer_wheel_add(wheel, &timer2, now_ms + 200000, test_timer_wheel_timer_fp, &fired2);
+
+            now_ms += 150000;
+            REQUIRE(timer_wheel_advance(wheel, now_ms) == 1);
+            REQUIRE(fired1.count == 1);
+            REQUIRE(fired2.count == 0);
+
+            now_ms += 50000;
+            REQUIRE(timer_wheel_advance(wheel, now_ms) == 1);
+            REQUIRE(fired2.count == 1);
+            REQUIRE(timer_wheel_is_empty(wheel));
+        }
+
+        SECTION("next tick is never after the first deadline") {
+            timer_wheel_timer_t timer;
+            test_timer_wheel_fired_t fired = { 0, 0, &now_ms };
+            timer_wheel_timer_init(&timer);
+
+            timer_wheel_add(wheel, &timer, now_ms + 10000, test_timer_wheel_timer_fp, &fired);
+
+            while(timer_wheel_timer_is_armed(&timer)) {
+                uint64_t next_tick = timer_wheel_get_next_tick(wheel);
+                REQUIRE(next_tick <= timer.expires_at_tick);
+
+                now_ms = timer_wheel_tick_to_ms(wheel, next_tick);
+                timer_wheel_advance(wheel, now_ms);
+            }
+
+            REQUIRE(fired.count == 1);
+            REQUIRE(fired.at_ms == wheel->start_ms + 10000);
+        }
+
+        timer_wheel_free(wheel);
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#include "hash/hash_murmurhash64a.h"
+
+TEST_CASE("hash/hash_murmurhash64a.c", "[hash][hash_murmurhash64a]") {
+    SECTION("empty data") {
+        REQUIRE(hash_murmurhash64a("", 0, 0) == 0);
+        REQUIRE(hash_murmurhash64a("", 0, 0xadc83b19) == 15627466953755236146ULL);
+    }
+
+    SECTION("short data") {
+        REQUIRE(hash_murmurhash64a("hello", 5, 0xadc83b19) == 1109414937308947456ULL);
+    }
+
+    SECTION("smhasher verification") {
+        // Same verification done by SMHasher, keys of length 0 to 255 hashed with seed 256 - length, the hashes are
+        // then hashed with seed 0 and the lower 32 bits have to match the reference value of MurmurHash64A
+        char key[256];
+        uint8_t hashes[256 * sizeof(uint64_t)];
+
+        for(int length = 0; length < 256; length++) {
+            key[length] = (char)length;
+            uint64_t hash = hash_murmurhash64a(key, length, 256 - length);
+            memcpy(hashes + (length * sizeof(uint64_t)), &hash, sizeof(uint64_t));
+        }
+
+        uint64_t hash = hash_murmurhash64a((char*)hashes, sizeof(hashes), 0);
+        REQUIRE((uint32_t)hash == 0x1F0D3804);
+    }
+}
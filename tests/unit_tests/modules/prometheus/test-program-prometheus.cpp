@@ -178,11 +178,33 @@ TEST_CASE("program.c-prometheus", "[program-prometheus]") {
                 { "cachegrand_network_active_connections", true },
                 { "cachegrand_network_accepted_tls_connections", true },
                 { "cachegrand_network_active_tls_connections", true },
+                { "cachegrand_network_output_buffers_size", true },
+                { "cachegrand_network_output_buffers_size_max", true },
+                { "cachegrand_network_output_buffers_limit_disconnections", true },
+                { "cachegrand_network_buffers_size", true },
+                { "cachegrand_network_tls_handshakes", true },
+                { "cachegrand_network_tls_handshakes_failed", true },
+                { "cachegrand_network_tls_handshakes_duration_us", true },
+                { "cachegrand_network_tls_handshakes_duration_us_max", true },
+                { "cachegrand_network_tls_sessions_resumed", true },
+                { "cachegrand_network_migrated_connections", true },
                 { "cachegrand_storage_written_data", true },
                 { "cachegrand_storage_write_iops", true },
                 { "cachegrand_storage_read_data", true },
                 { "cachegrand_storage_read_iops", true },
                 { "cachegrand_storage_open_files", true },
+                { "cachegrand_iouring_syscalls", true },
+                { "cachegrand_iouring_completions", true },
+                { "cachegrand_blocking_blocked_clients", true },
+                { "cachegrand_blocking_served", true },
+                { "cachegrand_blocking_timeouts", true },
+                { "cachegrand_blocking_push_to_pop_latency_us", true },
+                { "cachegrand_blocking_push_to_pop_latency_us_max", true },
+#if DEBUG == 1
+                { "cachegrand_debug_command_arena_commands", true },
+                { "cachegrand_debug_command_arena_allocations", true },
+                { "cachegrand_debug_command_arena_allocations_max", true },
+#endif
 
                 nullptr,
         };
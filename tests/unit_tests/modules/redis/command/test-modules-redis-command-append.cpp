@@ -13,7 +13,9 @@
 #include <memory>
 #include <string>
 
+#include <unistd.h>
 #include <netinet/in.h>
+#include <sys/socket.h>
 
 #include "clock.h"
 #include "exttypes.h"
@@ -343,5 +345,120 @@ TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - APPEND", "[r
         }
     }
 
+    SECTION("Existing key - value received directly into the chunks") {
+        char *value1 = "b_value";
+        size_t value1_len = strlen(value1);
+        size_t append_value_length = (STORAGE_DB_CHUNK_MAX_SIZE * 2) + 4321;
+        size_t packet_length = (STORAGE_DB_CHUNK_MAX_SIZE / 3) + 5;
+        char header[128];
+        char expected_append_response[32];
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", value1},
+                "+OK\r\n"));
+
+        size_t header_length = snprintf(
+                header,
+                sizeof(header),
+                "*3\r\n$6\r\nAPPEND\r\n$5\r\na_key\r\n$%lu\r\n",
+                append_value_length);
+        REQUIRE(send(this->c->fd, header, header_length, 0) == (ssize_t)header_length);
+
+        // The value is sent in packets not aligned to the chunks with a pause after each one, so it's received across
+        // several reads and across the chunk boundaries
+        for(size_t offset = 0; offset < append_value_length; offset += packet_length) {
+            size_t length = MIN(packet_length, append_value_length - offset);
+            REQUIRE(send(this->c->fd, long_value + offset, length, 0) == (ssize_t)length);
+            usleep(5000);
+        }
+
+        REQUIRE(send(this->c->fd, "\r\n", 2, 0) == 2);
+
+        size_t expected_append_response_length = snprintf(
+                expected_append_response,
+                sizeof(expected_append_response),
+                ":%lu\r\n",
+                value1_len + append_value_length);
+        size_t received_length = 0;
+        while(received_length < expected_append_response_length) {
+            ssize_t recv_length = recv(
+                    this->c->fd,
+                    buffer_recv + received_length,
+                    sizeof(buffer_recv) - received_length,
+                    0);
+            REQUIRE(recv_length > 0);
+            received_length += recv_length;
+        }
+        REQUIRE(received_length == expected_append_response_length);
+        REQUIRE(memcmp(buffer_recv, expected_append_response, expected_append_response_length) == 0);
+
+        size_t expected_response_length = snprintf(
+                nullptr,
+                0,
+                "$%lu\r\n%s%.*s\r\n",
+                value1_len + append_value_length,
+                value1,
+                (int) append_value_length,
+                long_value);
+        char *expected_response = (char *) malloc(expected_response_length + 1);
+        snprintf(
+                expected_response,
+                expected_response_length + 1,
+                "$%lu\r\n%s%.*s\r\n",
+                value1_len + append_value_length,
+                value1,
+                (int) append_value_length,
+                long_value);
+
+        REQUIRE(send_recv_resp_command_multi_recv_and_validate_recv(
+                std::vector<std::string>{"GET", "a_key"},
+                expected_response,
+                expected_response_length));
+
+        free(expected_response);
+    }
+
+    SECTION("Wrong type") {
+        SECTION("Hash") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSET", "a_key", "field1", "value1"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"APPEND", "a_key", "b_value"},
+                    "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+        }
+
+        SECTION("List") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LPUSH", "a_key", "value1"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"APPEND", "a_key", "b_value"},
+                    "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+        }
+
+        SECTION("Set") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SADD", "a_key", "value1"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"APPEND", "a_key", "b_value"},
+                    "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+        }
+
+        SECTION("Sorted set") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"ZADD", "a_key", "1", "value1"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"APPEND", "a_key", "b_value"},
+                    "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+        }
+    }
+
     free(long_value);
 }
@@ -0,0 +1,158 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - BITFIELD", "[redis][command][BITFIELD]") {
+    SECTION("Non-existing key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "GET", "u8", "0", "GET", "i16", "100"},
+                "*2\r\n:0\r\n:0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXISTS", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("SET and GET") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "SET", "u8", "0", "255", "GET", "u8", "0", "GET", "i8", "0"},
+                "*3\r\n:0\r\n:255\r\n:-1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "SET", "u4", "#1", "0", "GET", "u8", "0"},
+                "*2\r\n:15\r\n:240\r\n"));
+    }
+
+    SECTION("INCRBY") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "INCRBY", "i5", "100", "1", "INCRBY", "i5", "100", "1"},
+                "*2\r\n:1\r\n:2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "GET", "i5", "100"},
+                "*1\r\n:2\r\n"));
+    }
+
+    SECTION("Overflow") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "SET", "u8", "0", "250"},
+                "*1\r\n:0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "INCRBY", "u8", "0", "10"},
+                "*1\r\n:4\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "OVERFLOW", "SAT", "INCRBY", "u8", "0", "300"},
+                "*1\r\n:255\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "OVERFLOW", "FAIL", "INCRBY", "u8", "0", "1"},
+                "*1\r\n$-1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "OVERFLOW", "SAT", "SET", "i8", "0", "200", "GET", "i8", "0"},
+                "*2\r\n:-1\r\n:127\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "OVERFLOW", "WRAP", "INCRBY", "i8", "0", "1"},
+                "*1\r\n:-128\r\n"));
+    }
+
+    SECTION("64 bit fields") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "SET", "i64", "3", "-1", "GET", "u63", "3"},
+                "*2\r\n:0\r\n:9223372036854775807\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "INCRBY", "i64", "3", "1"},
+                "*1\r\n:0\r\n"));
+    }
+
+    SECTION("Multiple chunks") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "SET", "u16", "524280", "65535"},
+                "*1\r\n:0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"STRLEN", "a_key"},
+                ":65537\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "GET", "u8", "524280", "GET", "u8", "524288"},
+                "*2\r\n:255\r\n:255\r\n"));
+    }
+
+    SECTION("Errors") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "GET", "u64", "0"},
+                "-ERR Invalid bitfield type. Use something like i16 u8. Note that u64 is not supported but i64 is.\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "GET", "u8", "-1"},
+                "-ERR bit offset is not an integer or out of range\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "OVERFLOW", "FOO"},
+                "-ERR Invalid OVERFLOW type specified\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "GET", "u8"},
+                "-ERR syntax error\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "SET", "u8", "0", "a"},
+                "-ERR value is not an integer or out of range\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXISTS", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BITFIELD", "a_key", "GET", "u8", "0"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - BLMOVE", "[redis][command][BLMOVE]") {
+    SECTION("Existing list") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a", "b", "c"},
+                ":3\r\n"));
+
+        SECTION("LEFT to RIGHT") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"RPUSH", "b_key", "x"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"BLMOVE", "a_key", "b_key", "LEFT", "RIGHT", "0"},
+                    "$1\r\na\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LRANGE", "a_key", "0", "-1"},
+                    "*2\r\n$1\r\nb\r\n$1\r\nc\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LRANGE", "b_key", "0", "-1"},
+                    "*2\r\n$1\r\nx\r\n$1\r\na\r\n"));
+        }
+
+        SECTION("RIGHT to LEFT, new destination") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"BLMOVE", "a_key", "b_key", "right", "left", "0"},
+                    "$1\r\nc\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LRANGE", "b_key", "0", "-1"},
+                    "*1\r\n$1\r\nc\r\n"));
+        }
+
+        SECTION("Same source and destination rotates the list") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"BLMOVE", "a_key", "a_key", "LEFT", "RIGHT", "0"},
+                    "$1\r\na\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LRANGE", "a_key", "0", "-1"},
+                    "*3\r\n$1\r\nb\r\n$1\r\nc\r\n$1\r\na\r\n"));
+        }
+
+        SECTION("Destination wrong type") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "b_key", "b_value"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"BLMOVE", "a_key", "b_key", "LEFT", "RIGHT", "0"},
+                    "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LLEN", "a_key"},
+                    ":3\r\n"));
+        }
+    }
+
+    SECTION("Timeout") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BLMOVE", "a_key", "b_key", "LEFT", "RIGHT", "0.1"},
+                "$-1\r\n"));
+    }
+
+    SECTION("Invalid direction") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BLMOVE", "a_key", "b_key", "UP", "RIGHT", "0"},
+                "-ERR syntax error\r\n"));
+    }
+}
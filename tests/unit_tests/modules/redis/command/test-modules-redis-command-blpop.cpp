@@ -0,0 +1,138 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <unistd.h>
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - BLPOP", "[redis][command][BLPOP]") {
+    SECTION("Existing list") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a", "b", "c"},
+                ":3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BLPOP", "a_key", "0"},
+                "*2\r\n$5\r\na_key\r\n$1\r\na\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "0", "-1"},
+                "*2\r\n$1\r\nb\r\n$1\r\nc\r\n"));
+    }
+
+    SECTION("Pop the last element") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BLPOP", "a_key", "0"},
+                "*2\r\n$5\r\na_key\r\n$1\r\na\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXISTS", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("Multiple keys, first non-empty list is used") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "b_key", "a", "b"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BLPOP", "a_key", "b_key", "0"},
+                "*2\r\n$5\r\nb_key\r\n$1\r\na\r\n"));
+    }
+
+    SECTION("Timeout") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BLPOP", "a_key", "b_key", "0.1"},
+                "*-1\r\n"));
+    }
+
+    SECTION("Blocked client disconnecting") {
+        redisContext *blocked = redisConnect(
+                config_module_network_binding.host,
+                config_module_network_binding.port);
+        REQUIRE(blocked != nullptr);
+        REQUIRE(blocked->err == 0);
+
+        // The command is only sent, the client goes away while blocked without ever reading the reply
+        int done = 0;
+        REQUIRE(redisAppendCommand(blocked, "BLPOP a_key 0") == REDIS_OK);
+        while(!done) {
+            REQUIRE(redisBufferWrite(blocked, &done) == REDIS_OK);
+        }
+
+        usleep(100000);
+        redisFree(blocked);
+        usleep(100000);
+
+        // The element must not be handed over to the client that has gone away
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "0", "-1"},
+                "*1\r\n$1\r\na\r\n"));
+    }
+
+    SECTION("Negative timeout") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BLPOP", "a_key", "-1"},
+                "-ERR timeout is negative\r\n"));
+    }
+
+    SECTION("Missing timeout") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BLPOP", "a_key"},
+                "-ERR wrong number of arguments for 'blpop' command\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BLPOP", "a_key", "0"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
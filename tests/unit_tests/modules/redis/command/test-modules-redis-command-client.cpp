@@ -0,0 +1,324 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+static bool test_modules_redis_command_client_recv_and_validate(
+        int fd,
+        char *expected) {
+    char buffer[1024] = { 0 };
+    size_t expected_length = strlen(expected);
+    size_t total_recv_length = 0;
+
+    // The invalidations are pushed by the server without any request, they might be split across multiple packets
+    while(total_recv_length < expected_length) {
+        ssize_t recv_length = recv(
+                fd,
+                buffer + total_recv_length,
+                sizeof(buffer) - total_recv_length,
+                0);
+
+        if (recv_length <= 0) {
+            return false;
+        }
+
+        total_recv_length += recv_length;
+    }
+
+    return total_recv_length == expected_length && memcmp(buffer, expected, expected_length) == 0;
+}
+
+static bool test_modules_redis_command_client_set_from_other_connection(
+        char *host,
+        uint16_t port,
+        char *key,
+        char *value) {
+    redisContext *writer = redisConnect(host, port);
+
+    if (writer == nullptr || writer->err) {
+        return false;
+    }
+
+    auto reply = (redisReply*)redisCommand(writer, "SET %s %s", key, value);
+    bool result = reply != nullptr;
+
+    freeReplyObject(reply);
+    redisFree(writer);
+
+    return result;
+}
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - CLIENT", "[redis][command][CLIENT]") {
+    char buffer_recv[1024] = { 0 };
+    size_t buffer_recv_length = 0;
+
+    SECTION("CLIENT ID") {
+        REQUIRE(send_recv_resp_command_multi_recv(
+                std::vector<std::string>{"CLIENT", "ID"},
+                buffer_recv,
+                &buffer_recv_length));
+
+        REQUIRE(buffer_recv[0] == ':');
+        REQUIRE(strtoll(buffer_recv + 1, nullptr, 10) > 0);
+    }
+
+    SECTION("CLIENT GETREDIR") {
+        SECTION("Tracking disabled") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "GETREDIR"},
+                    ":-1\r\n"));
+        }
+
+        SECTION("Tracking enabled") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "ON"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "GETREDIR"},
+                    ":0\r\n"));
+        }
+    }
+
+    SECTION("CLIENT TRACKING") {
+        SECTION("On and off") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "on"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "OFF"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "GETREDIR"},
+                    ":-1\r\n"));
+        }
+
+        SECTION("Invalid status") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "MAYBE"},
+                    "-ERR syntax error\r\n"));
+        }
+
+        SECTION("Redirect to a missing client") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "ON", "REDIRECT", "999999999"},
+                    "-ERR The client ID you want redirect to does not exist\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "GETREDIR"},
+                    ":-1\r\n"));
+        }
+
+        SECTION("Prefix without BCAST") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "ON", "PREFIX", "a_"},
+                    "-ERR PREFIX option requires BCAST mode to be enabled\r\n"));
+        }
+
+        SECTION("Switching BCAST mode") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "ON"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "ON", "BCAST"},
+                    "-ERR You can't switch BCAST mode on/off before disabling tracking for this client, and then "
+                    "re-enabling it with a different mode.\r\n"));
+        }
+
+        SECTION("Invalidation pushed with RESP3") {
+            REQUIRE(send_recv_resp_command_multi_recv(
+                    std::vector<std::string>{"HELLO", "3"},
+                    buffer_recv,
+                    &buffer_recv_length));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "ON"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "a_key", "b_value"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", "a_key"},
+                    "$7\r\nb_value\r\n"));
+
+            REQUIRE(test_modules_redis_command_client_set_from_other_connection(
+                    config_module_network_binding.host,
+                    config_module_network_binding.port,
+                    "a_key",
+                    "c_value"));
+
+            REQUIRE(test_modules_redis_command_client_recv_and_validate(
+                    this->c->fd,
+                    ">2\r\n$10\r\ninvalidate\r\n*1\r\n$5\r\na_key\r\n"));
+        }
+
+        SECTION("No invalidation after turning the tracking off") {
+            REQUIRE(send_recv_resp_command_multi_recv(
+                    std::vector<std::string>{"HELLO", "3"},
+                    buffer_recv,
+                    &buffer_recv_length));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "ON"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", "a_key"},
+                    "_\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "OFF"},
+                    "+OK\r\n"));
+
+            REQUIRE(test_modules_redis_command_client_set_from_other_connection(
+                    config_module_network_binding.host,
+                    config_module_network_binding.port,
+                    "a_key",
+                    "b_value"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"PING"},
+                    "+PONG\r\n"));
+        }
+
+        SECTION("Invalidation redirected to a RESP2 connection") {
+            REQUIRE(send_recv_resp_command_multi_recv(
+                    std::vector<std::string>{"CLIENT", "ID"},
+                    buffer_recv,
+                    &buffer_recv_length));
+            long long client_id = strtoll(buffer_recv + 1, nullptr, 10);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SUBSCRIBE", "__redis__:invalidate"},
+                    "*3\r\n$9\r\nsubscribe\r\n$20\r\n__redis__:invalidate\r\n:1\r\n"));
+
+            redisContext *tracker = redisConnect(
+                    config_module_network_binding.host,
+                    config_module_network_binding.port);
+            REQUIRE(tracker != nullptr);
+            REQUIRE(tracker->err == 0);
+
+            auto reply = (redisReply*)redisCommand(tracker, "CLIENT TRACKING ON REDIRECT %lld", client_id);
+            REQUIRE(reply != nullptr);
+            freeReplyObject(reply);
+
+            reply = (redisReply*)redisCommand(tracker, "CLIENT GETREDIR");
+            REQUIRE(reply != nullptr);
+            REQUIRE(reply->type == REDIS_REPLY_INTEGER);
+            REQUIRE(reply->integer == client_id);
+            freeReplyObject(reply);
+
+            reply = (redisReply*)redisCommand(tracker, "GET a_key");
+            REQUIRE(reply != nullptr);
+            freeReplyObject(reply);
+
+            reply = (redisReply*)redisCommand(tracker, "SET a_key b_value");
+            REQUIRE(reply != nullptr);
+            freeReplyObject(reply);
+
+            REQUIRE(test_modules_redis_command_client_recv_and_validate(
+                    this->c->fd,
+                    "*3\r\n$7\r\nmessage\r\n$20\r\n__redis__:invalidate\r\n*1\r\n$5\r\na_key\r\n"));
+
+            redisFree(tracker);
+        }
+
+        SECTION("BCAST with prefixes") {
+            REQUIRE(send_recv_resp_command_multi_recv(
+                    std::vector<std::string>{"HELLO", "3"},
+                    buffer_recv,
+                    &buffer_recv_length));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "ON", "BCAST", "PREFIX", "a_", "PREFIX", "b_"},
+                    "+OK\r\n"));
+
+            // The keys are not read, in BCAST mode the clients are notified about all the keys matching the prefixes
+            REQUIRE(test_modules_redis_command_client_set_from_other_connection(
+                    config_module_network_binding.host,
+                    config_module_network_binding.port,
+                    "c_key",
+                    "a_value"));
+
+            REQUIRE(test_modules_redis_command_client_set_from_other_connection(
+                    config_module_network_binding.host,
+                    config_module_network_binding.port,
+                    "b_key",
+                    "a_value"));
+
+            REQUIRE(test_modules_redis_command_client_recv_and_validate(
+                    this->c->fd,
+                    ">2\r\n$10\r\ninvalidate\r\n*1\r\n$5\r\nb_key\r\n"));
+        }
+
+        SECTION("BCAST with NOLOOP") {
+            REQUIRE(send_recv_resp_command_multi_recv(
+                    std::vector<std::string>{"HELLO", "3"},
+                    buffer_recv,
+                    &buffer_recv_length));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLIENT", "TRACKING", "ON", "BCAST", "NOLOOP"},
+                    "+OK\r\n"));
+
+            // The key changed by the client itself is not notified back to it
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "a_key", "b_value"},
+                    "+OK\r\n"));
+
+            REQUIRE(test_modules_redis_command_client_set_from_other_connection(
+                    config_module_network_binding.host,
+                    config_module_network_binding.port,
+                    "b_key",
+                    "a_value"));
+
+            REQUIRE(test_modules_redis_command_client_recv_and_validate(
+                    this->c->fd,
+                    ">2\r\n$10\r\ninvalidate\r\n*1\r\n$5\r\nb_key\r\n"));
+        }
+    }
+}
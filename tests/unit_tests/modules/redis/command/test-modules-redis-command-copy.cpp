@@ -142,4 +142,26 @@ TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - COPY", "[red
                 std::vector<std::string>{"GET", "b_key"},
                 "$7\r\nb_value\r\n"));
     }
+
+    SECTION("Existent key - Sorted set") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "1", "a", "2", "b"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"COPY", "a_key", "b_key"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "b_key", "3", "c"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGE", "a_key", "0", "-1"},
+                "*2\r\n$1\r\na\r\n$1\r\nb\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGE", "b_key", "0", "-1"},
+                "*3\r\n$1\r\na\r\n$1\r\nb\r\n$1\r\nc\r\n"));
+    }
 }
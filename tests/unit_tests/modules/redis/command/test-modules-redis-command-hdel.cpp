@@ -0,0 +1,137 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - HDEL", "[redis][command][HDEL]") {
+    SECTION("Non-existing key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HDEL", "a_key", "field1"},
+                ":0\r\n"));
+    }
+
+    SECTION("Existing key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", "value1", "field2", "value2"},
+                ":2\r\n"));
+
+        SECTION("Delete one field") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HDEL", "a_key", "field1", "field3"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HMGET", "a_key", "field1", "field2"},
+                    "*2\r\n$-1\r\n$6\r\nvalue2\r\n"));
+        }
+
+        SECTION("Delete non-existing field") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HDEL", "a_key", "field3"},
+                    ":0\r\n"));
+        }
+
+        SECTION("Delete all the fields") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HDEL", "a_key", "field1", "field2"},
+                    ":2\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"EXISTS", "a_key"},
+                    ":0\r\n"));
+        }
+    }
+
+    SECTION("Large hash") {
+        std::vector<std::string> command{"HSET", "a_key"};
+        for(int index = 0; index < 200; index++) {
+            command.push_back("field" + std::to_string(index));
+            command.push_back("value" + std::to_string(index));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                command,
+                ":200\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HDEL", "a_key", "field0", "field199", "field200"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HLEN", "a_key"},
+                ":198\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HMGET", "a_key", "field0", "field1", "field199"},
+                "*3\r\n$-1\r\n$6\r\nvalue1\r\n$-1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field0", "new_value0"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "field0"},
+                "$10\r\nnew_value0\r\n"));
+
+        for(int index = 0; index < 200; index += 10) {
+            std::vector<std::string> command_delete{"HDEL", "a_key"};
+            for(int field_index = index; field_index < index + 10; field_index++) {
+                command_delete.push_back("field" + std::to_string(field_index));
+            }
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    command_delete,
+                    (char*)(index == 190 ? ":9\r\n" : ":10\r\n")));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXISTS", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HDEL", "a_key", "field1"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
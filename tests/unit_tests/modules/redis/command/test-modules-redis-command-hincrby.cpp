@@ -0,0 +1,138 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - HINCRBY", "[redis][command][HINCRBY]") {
+    SECTION("Non-existing key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "field1", "5"},
+                ":5\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "field1"},
+                "$1\r\n5\r\n"));
+    }
+
+    SECTION("Existing field") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", "10", "field2", "value2"},
+                ":2\r\n"));
+
+        SECTION("Positive increment") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HINCRBY", "a_key", "field1", "5"},
+                    ":15\r\n"));
+        }
+
+        SECTION("Negative increment") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HINCRBY", "a_key", "field1", "-15"},
+                    ":-5\r\n"));
+        }
+
+        SECTION("Non-existing field") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HINCRBY", "a_key", "field3", "1"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HMGET", "a_key", "field1", "field2", "field3"},
+                    "*3\r\n$2\r\n10\r\n$6\r\nvalue2\r\n$1\r\n1\r\n"));
+        }
+
+        SECTION("Not an integer") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HINCRBY", "a_key", "field2", "1"},
+                    "-ERR hash value is not an integer\r\n"));
+        }
+    }
+
+    SECTION("Large hash") {
+        std::vector<std::string> command{"HSET", "a_key"};
+        for(int index = 0; index < 200; index++) {
+            command.push_back("field" + std::to_string(index));
+            command.push_back(std::to_string(index));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                command,
+                ":200\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "field5", "1"},
+                ":6\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "field5", "1000"},
+                ":1006\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "field200", "-7"},
+                ":-7\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HMGET", "a_key", "field4", "field5", "field6", "field200"},
+                "*4\r\n$1\r\n4\r\n$4\r\n1006\r\n$1\r\n6\r\n$2\r\n-7\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HLEN", "a_key"},
+                ":201\r\n"));
+    }
+
+    SECTION("Overflow") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", "9223372036854775807"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "field1", "1"},
+                "-ERR increment or decrement would overflow\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "field1", "1"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - HSCAN", "[redis][command][HSCAN]") {
+    SECTION("Non-existing key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSCAN", "a_key", "0"},
+                "*2\r\n:0\r\n*0\r\n"));
+    }
+
+    SECTION("Compact hash") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", "value1", "other", "value2"},
+                ":2\r\n"));
+
+        SECTION("All the fields") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSCAN", "a_key", "0"},
+                    "*2\r\n:0\r\n*4\r\n$6\r\nfield1\r\n$6\r\nvalue1\r\n$5\r\nother\r\n$6\r\nvalue2\r\n"));
+        }
+
+        SECTION("Match") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSCAN", "a_key", "0", "MATCH", "field*"},
+                    "*2\r\n:0\r\n*2\r\n$6\r\nfield1\r\n$6\r\nvalue1\r\n"));
+        }
+    }
+
+    SECTION("Large hash") {
+        for(int index = 0; index < 200; index++) {
+            std::string field = "field" + std::to_string(index);
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSET", "a_key", field, "value"},
+                    ":1\r\n"));
+        }
+
+        SECTION("Match nothing") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSCAN", "a_key", "0", "MATCH", "nomatch", "COUNT", "1000"},
+                    "*2\r\n:0\r\n*0\r\n"));
+        }
+
+        SECTION("Cursor past the end") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSCAN", "a_key", "100000"},
+                    "*2\r\n:0\r\n*0\r\n"));
+        }
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSCAN", "a_key", "0"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
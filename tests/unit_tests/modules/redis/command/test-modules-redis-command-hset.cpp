@@ -0,0 +1,171 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - HSET", "[redis][command][HSET]") {
+    SECTION("New hash") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", "value1"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "field1"},
+                "$6\r\nvalue1\r\n"));
+    }
+
+    SECTION("Multiple fields") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", "value1", "field2", "value2"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "field2"},
+                "$6\r\nvalue2\r\n"));
+    }
+
+    SECTION("Update existing field") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", "value1"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", "value2", "field2", "value2"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "field1"},
+                "$6\r\nvalue2\r\n"));
+    }
+
+    SECTION("Large hash") {
+        for(int index = 0; index < 200; index++) {
+            std::string field = "field" + std::to_string(index);
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSET", "a_key", field, field},
+                    ":1\r\n"));
+        }
+
+        for(int index = 0; index < 200; index++) {
+            std::string field = "field" + std::to_string(index);
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HGET", "a_key", field},
+                    (char*)("$" + std::to_string(field.length()) + "\r\n" + field + "\r\n").c_str()));
+        }
+    }
+
+    SECTION("Large hash - update fields") {
+        std::vector<std::string> command{"HSET", "a_key"};
+        for(int index = 0; index < 200; index++) {
+            command.push_back("field" + std::to_string(index));
+            command.push_back("value" + std::to_string(index));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                command,
+                ":200\r\n"));
+
+        // Same length, longer value and new field
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{
+                    "HSET", "a_key", "field1", "VALUE1", "field2", "a_longer_value2", "field200", "value200"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HMGET", "a_key", "field1", "field2", "field3", "field200"},
+                "*4\r\n$6\r\nVALUE1\r\n$15\r\na_longer_value2\r\n$6\r\nvalue3\r\n$8\r\nvalue200\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HLEN", "a_key"},
+                ":201\r\n"));
+
+        // Keep updating the same field until the hash has to be rebuilt to drop the replaced entries
+        for(int index = 0; index < 1000; index++) {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSET", "a_key", "field2", std::string(index % 100, 'a')},
+                    ":0\r\n"));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "field2"},
+                (char*)("$99\r\n" + std::string(99, 'a') + "\r\n").c_str()));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HLEN", "a_key"},
+                ":201\r\n"));
+    }
+
+    SECTION("Empty field and value") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "", ""},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGETALL", "a_key"},
+                "*2\r\n$0\r\n\r\n$0\r\n\r\n"));
+    }
+
+    SECTION("Value longer than the max key length") {
+        std::string value(config_module_redis.max_key_length * 4, 'a');
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", value},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "field1"},
+                (char*)("$" + std::to_string(value.length()) + "\r\n" + value + "\r\n").c_str()));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1", "value1"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+
+    SECTION("Missing value") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "field1"},
+                "-ERR wrong number of arguments for 'hset' command\r\n"));
+    }
+}
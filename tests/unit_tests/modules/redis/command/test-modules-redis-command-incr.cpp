@@ -159,4 +159,46 @@ TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - INCR", "[red
                     "-ERR increment or decrement would overflow\r\n"));
         }
     }
+
+    SECTION("Wrong type") {
+        SECTION("Hash") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSET", "a_key", "field1", "value1"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"INCR", "a_key"},
+                    "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+        }
+
+        SECTION("List") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LPUSH", "a_key", "value1"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"INCR", "a_key"},
+                    "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+        }
+
+        SECTION("Set") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SADD", "a_key", "value1"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"INCR", "a_key"},
+                    "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+        }
+
+        SECTION("Sorted set") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"ZADD", "a_key", "1", "value1"},
+                    ":1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"INCR", "a_key"},
+                    "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+        }
+    }
 }
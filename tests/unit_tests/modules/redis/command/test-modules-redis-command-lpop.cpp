@@ -0,0 +1,164 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - LPOP", "[redis][command][LPOP]") {
+    SECTION("Non-existing key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LPOP", "a_key"},
+                "$-1\r\n"));
+    }
+
+    SECTION("Existing list") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a", "b", "c"},
+                ":3\r\n"));
+
+        SECTION("Pop one element") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LPOP", "a_key"},
+                    "$1\r\na\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LLEN", "a_key"},
+                    ":2\r\n"));
+        }
+
+        SECTION("Pop with count") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LPOP", "a_key", "2"},
+                    "*2\r\n$1\r\na\r\n$1\r\nb\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LRANGE", "a_key", "0", "-1"},
+                    "*1\r\n$1\r\nc\r\n"));
+        }
+
+        SECTION("Pop with count larger than the list") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LPOP", "a_key", "10"},
+                    "*3\r\n$1\r\na\r\n$1\r\nb\r\n$1\r\nc\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"EXISTS", "a_key"},
+                    ":0\r\n"));
+        }
+
+        SECTION("Pop with count zero") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LPOP", "a_key", "0"},
+                    "*0\r\n"));
+        }
+
+        SECTION("Negative count") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LPOP", "a_key", "-1"},
+                    "-ERR value is out of range, must be positive\r\n"));
+        }
+    }
+
+    SECTION("List larger than a chunk") {
+        for(int batch = 0; batch < 100; batch++) {
+            std::vector<std::string> command{"RPUSH", "a_key"};
+            for(int index = 0; index < 100; index++) {
+                command.push_back("value" + std::to_string((batch * 100) + index));
+            }
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    command,
+                    (char*)(":" + std::to_string((batch + 1) * 100) + "\r\n").c_str()));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LPUSH", "a_key", "head"},
+                ":10001\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "tail"},
+                ":10002\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LPOP", "a_key"},
+                "$4\r\nhead\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key"},
+                "$4\r\ntail\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LPOP", "a_key", "2"},
+                "*2\r\n$6\r\nvalue0\r\n$6\r\nvalue1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LLEN", "a_key"},
+                ":9998\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LINDEX", "a_key", "-1"},
+                "$9\r\nvalue9999\r\n"));
+
+        for(int batch_start = 2; batch_start < 10000; batch_start += 100) {
+            int batch_end = std::min(batch_start + 100, 10000);
+            std::string expected_response = "*" + std::to_string(batch_end - batch_start) + "\r\n";
+            for(int index = batch_start; index < batch_end; index++) {
+                std::string value = "value" + std::to_string(index);
+                expected_response += "$" + std::to_string(value.length()) + "\r\n" + value + "\r\n";
+            }
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"LPOP", "a_key", "100"},
+                    (char*)expected_response.c_str()));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXISTS", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LPOP", "a_key"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
@@ -0,0 +1,187 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+static bool test_modules_redis_command_publish_recv_and_validate(
+        int fd,
+        char *expected) {
+    char buffer[4096] = { 0 };
+    size_t expected_length = strlen(expected);
+    size_t total_recv_length = 0;
+
+    // The messages are pushed by the server without any request, they might be split across multiple packets
+    while(total_recv_length < expected_length) {
+        ssize_t recv_length = recv(
+                fd,
+                buffer + total_recv_length,
+                sizeof(buffer) - total_recv_length,
+                0);
+
+        if (recv_length <= 0) {
+            return false;
+        }
+
+        total_recv_length += recv_length;
+    }
+
+    return total_recv_length == expected_length && memcmp(buffer, expected, expected_length) == 0;
+}
+
+static int64_t test_modules_redis_command_publish_from_other_connection(
+        char *host,
+        uint16_t port,
+        char *channel,
+        char *message) {
+    int64_t receivers_count = -1;
+    redisContext *publisher = redisConnect(host, port);
+
+    if (publisher == nullptr || publisher->err) {
+        return -1;
+    }
+
+    auto reply = (redisReply*)redisCommand(publisher, "PUBLISH %s %s", channel, message);
+    if (reply != nullptr && reply->type == REDIS_REPLY_INTEGER) {
+        receivers_count = reply->integer;
+    }
+
+    freeReplyObject(reply);
+    redisFree(publisher);
+
+    return receivers_count;
+}
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - PUBLISH", "[redis][command][PUBLISH]") {
+    SECTION("No subscribers") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBLISH", "a_channel", "a_message"},
+                ":0\r\n"));
+    }
+
+    SECTION("Delivered to the channel subscribers") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(test_modules_redis_command_publish_from_other_connection(
+                config_module_network_binding.host,
+                config_module_network_binding.port,
+                "a_channel",
+                "a_message") == 1);
+
+        REQUIRE(test_modules_redis_command_publish_recv_and_validate(
+                this->c->fd,
+                "*3\r\n$7\r\nmessage\r\n$9\r\na_channel\r\n$9\r\na_message\r\n"));
+    }
+
+    SECTION("Delivered to the channel and to the pattern subscribers") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PSUBSCRIBE", "a_*"},
+                "*3\r\n$10\r\npsubscribe\r\n$3\r\na_*\r\n:2\r\n"));
+
+        REQUIRE(test_modules_redis_command_publish_from_other_connection(
+                config_module_network_binding.host,
+                config_module_network_binding.port,
+                "a_channel",
+                "a_message") == 2);
+
+        REQUIRE(test_modules_redis_command_publish_recv_and_validate(
+                this->c->fd,
+                "*3\r\n$7\r\nmessage\r\n$9\r\na_channel\r\n$9\r\na_message\r\n"
+                "*4\r\n$8\r\npmessage\r\n$3\r\na_*\r\n$9\r\na_channel\r\n$9\r\na_message\r\n"));
+    }
+
+    SECTION("Empty message") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(test_modules_redis_command_publish_from_other_connection(
+                config_module_network_binding.host,
+                config_module_network_binding.port,
+                "a_channel",
+                "") == 1);
+
+        REQUIRE(test_modules_redis_command_publish_recv_and_validate(
+                this->c->fd,
+                "*3\r\n$7\r\nmessage\r\n$9\r\na_channel\r\n$0\r\n\r\n"));
+    }
+
+    SECTION("Message longer than the max key length") {
+        std::string message(config_module_redis.max_key_length * 4, 'a');
+        std::string expected =
+                "*3\r\n$7\r\nmessage\r\n$9\r\na_channel\r\n$" + std::to_string(message.length()) + "\r\n" +
+                message + "\r\n";
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(test_modules_redis_command_publish_from_other_connection(
+                config_module_network_binding.host,
+                config_module_network_binding.port,
+                "a_channel",
+                (char*)message.c_str()) == 1);
+
+        REQUIRE(test_modules_redis_command_publish_recv_and_validate(
+                this->c->fd,
+                (char*)expected.c_str()));
+    }
+
+    SECTION("Not delivered after unsubscribing") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"UNSUBSCRIBE", "a_channel"},
+                "*3\r\n$11\r\nunsubscribe\r\n$9\r\na_channel\r\n:0\r\n"));
+
+        REQUIRE(test_modules_redis_command_publish_from_other_connection(
+                config_module_network_binding.host,
+                config_module_network_binding.port,
+                "a_channel",
+                "a_message") == 0);
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/slots_bitmap_mpmc/slots_bitmap_mpmc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - PUBSUB", "[redis][command][PUBSUB]") {
+    SECTION("NUMPAT") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBSUB", "NUMPAT"},
+                ":0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PSUBSCRIBE", "a_*", "b_*"},
+                "*3\r\n$10\r\npsubscribe\r\n$3\r\na_*\r\n:1\r\n*3\r\n$10\r\npsubscribe\r\n$3\r\nb_*\r\n:2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUNSUBSCRIBE"},
+                "*3\r\n$12\r\npunsubscribe\r\n$3\r\na_*\r\n:1\r\n*3\r\n$12\r\npunsubscribe\r\n$3\r\nb_*\r\n:0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBSUB", "NUMPAT"},
+                ":0\r\n"));
+    }
+
+    SECTION("NUMSUB") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBSUB", "NUMSUB"},
+                "*0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBSUB", "NUMSUB", "a_channel", "b_channel"},
+                "*4\r\n$9\r\na_channel\r\n:0\r\n$9\r\nb_channel\r\n:0\r\n"));
+    }
+
+    SECTION("CHANNELS") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBSUB", "CHANNELS"},
+                "*0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBSUB", "CHANNELS", "a_*"},
+                "*0\r\n"));
+    }
+
+    SECTION("With subscribers") {
+        redisContext *subscriber = redisConnect(
+                config_module_network_binding.host,
+                config_module_network_binding.port);
+        REQUIRE(subscriber != nullptr);
+        REQUIRE(subscriber->err == 0);
+
+        // The subscriptions are done on another connection, with RESP2 a subscribed connection can't run PUBSUB
+        auto reply = (redisReply*)redisCommand(subscriber, "SUBSCRIBE a_channel b_channel");
+        REQUIRE(reply != nullptr);
+        freeReplyObject(reply);
+        REQUIRE(redisGetReply(subscriber, (void**)&reply) == REDIS_OK);
+        freeReplyObject(reply);
+
+        reply = (redisReply*)redisCommand(subscriber, "PSUBSCRIBE a_*");
+        REQUIRE(reply != nullptr);
+        freeReplyObject(reply);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBSUB", "NUMSUB", "a_channel", "c_channel"},
+                "*4\r\n$9\r\na_channel\r\n:1\r\n$9\r\nc_channel\r\n:0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBSUB", "NUMPAT"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBSUB", "CHANNELS", "a_*"},
+                "*1\r\n$9\r\na_channel\r\n"));
+
+        redisFree(subscriber);
+    }
+}
@@ -15,6 +15,7 @@
 
 #include <unistd.h>
 #include <netinet/in.h>
+#include <sys/socket.h>
 
 #include "clock.h"
 #include "exttypes.h"
@@ -42,6 +43,26 @@
 
 #pragma GCC diagnostic ignored "-Wwrite-strings"
 
+static bool test_modules_redis_command_set_send_in_packets(
+        int fd,
+        const char *data,
+        size_t data_length,
+        size_t packet_length) {
+    // Each packet is followed by a pause to let the worker process it before the next one arrives, so the value is
+    // received across several reads instead of being already available in the socket buffer
+    for(size_t offset = 0; offset < data_length; offset += packet_length) {
+        size_t length = MIN(packet_length, data_length - offset);
+
+        if (send(fd, data + offset, length, 0) != (ssize_t)length) {
+            return false;
+        }
+
+        usleep(5000);
+    }
+
+    return true;
+}
+
 TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - SET", "[redis][command][SET]") {
     transaction_t transaction = { 0 };
     transaction_acquire(&transaction);
@@ -485,6 +506,112 @@ TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - SET", "[redi
         free(expected_response);
     }
 
+    SECTION("New key - received directly into the chunks") {
+        char *key = "a_key";
+        // Not a multiple of the chunk size to have the last chunk partially filled
+        size_t long_value_length = (STORAGE_DB_CHUNK_MAX_SIZE * 3) + 1234;
+        char *long_value = (char *) malloc(long_value_length);
+        char header[128];
+
+        char range = 'z' - 'a';
+        for (size_t i = 0; i < long_value_length; i++) {
+            long_value[i] = (char)(i % range) + 'a';
+        }
+
+        size_t header_length = snprintf(
+                header,
+                sizeof(header),
+                "*3\r\n$3\r\nSET\r\n$%lu\r\n%s\r\n$%lu\r\n",
+                strlen(key),
+                key,
+                long_value_length);
+
+        SECTION("Value split across several packets") {
+            // The header is sent together with the beginning of the value, the rest of the value is received once the
+            // read buffer has been processed
+            REQUIRE(send(this->c->fd, header, header_length, 0) == (ssize_t)header_length);
+
+            // The size of the packets is not aligned to the chunks to receive data across the chunk boundaries
+            REQUIRE(test_modules_redis_command_set_send_in_packets(
+                    this->c->fd,
+                    long_value,
+                    long_value_length,
+                    (STORAGE_DB_CHUNK_MAX_SIZE / 2) + 17));
+
+            // The end signature is sent with a pipelined command, it has to be parsed from the read buffer once the
+            // value has been received directly
+            char *tail = "\r\n*1\r\n$4\r\nPING\r\n";
+            REQUIRE(send(this->c->fd, tail, strlen(tail), 0) == (ssize_t)strlen(tail));
+
+            char *expected = "+OK\r\n+PONG\r\n";
+            size_t expected_length = strlen(expected);
+            size_t received_length = 0;
+            while(received_length < expected_length) {
+                ssize_t recv_length = recv(
+                        this->c->fd,
+                        buffer_recv + received_length,
+                        sizeof(buffer_recv) - received_length,
+                        0);
+                REQUIRE(recv_length > 0);
+                received_length += recv_length;
+            }
+            REQUIRE(received_length == expected_length);
+            REQUIRE(memcmp(buffer_recv, expected, expected_length) == 0);
+
+            storage_db_entry_index_t *entry_index = storage_db_get_entry_index(
+                    db,
+                    0,
+                    &transaction,
+                    key,
+                    strlen(key));
+            REQUIRE(entry_index != nullptr);
+            REQUIRE(entry_index->value.size == long_value_length);
+            REQUIRE(entry_index->value.count == 4);
+
+            size_t offset = 0;
+            for(storage_db_chunk_index_t index = 0; index < entry_index->value.count; index++) {
+                storage_db_chunk_info_t *chunk_info = &entry_index->value.sequence[index];
+                REQUIRE(memcmp(chunk_info->memory.chunk_data, long_value + offset, chunk_info->chunk_length) == 0);
+                offset += chunk_info->chunk_length;
+            }
+            REQUIRE(offset == long_value_length);
+        }
+
+        SECTION("Client disconnecting while the value is being received") {
+            redisContext *writer = redisConnect(
+                    config_module_network_binding.host,
+                    config_module_network_binding.port);
+            REQUIRE(writer != nullptr);
+            REQUIRE(writer->err == 0);
+
+            REQUIRE(send(writer->fd, header, header_length, 0) == (ssize_t)header_length);
+
+            // Stops in the middle of the second chunk
+            REQUIRE(test_modules_redis_command_set_send_in_packets(
+                    writer->fd,
+                    long_value,
+                    STORAGE_DB_CHUNK_MAX_SIZE + (STORAGE_DB_CHUNK_MAX_SIZE / 2),
+                    STORAGE_DB_CHUNK_MAX_SIZE / 4));
+
+            redisFree(writer);
+
+            // The command must be discarded, the other connections must keep working
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", key},
+                    "$-1\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", key, "b_value"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", key},
+                    "$7\r\nb_value\r\n"));
+        }
+
+        free(long_value);
+    }
+
     SECTION("Invalid EX") {
         REQUIRE(send_recv_resp_command_text_and_validate_recv(
                 std::vector<std::string>{"SET", "a_key", "b_value", "EX", "0"},
@@ -84,25 +84,6 @@ TEST_CASE("module/redis/module_redis_commands.c", "[module][redis][module_redis_
         }
     }
 
-    SECTION("module_redis_commands_build_commands_hashtables") {
-        hashtable_spsc_t *hashtable = module_redis_commands_build_commands_hashtables(
-                command_infos_map, ARRAY_SIZE(command_infos_map));
-
-        REQUIRE(hashtable != nullptr);
-
-        REQUIRE(hashtable_spsc_op_get_ci(
-                hashtable,
-                command_infos_map[0].string,
-                command_infos_map[0].string_len) == &command_infos_map[0]);
-
-        REQUIRE(hashtable_spsc_op_get_ci(
-                hashtable,
-                command_infos_map[1].string,
-                command_infos_map[1].string_len) == &command_infos_map[1]);
-
-        hashtable_spsc_free(hashtable);
-    }
-
     SECTION("module_redis_commands_count_tokens_in_command_arguments") {
         SECTION("command with tokens") {
             uint16_t tokens_count = module_redis_commands_count_tokens_in_command_arguments(
@@ -286,4 +267,44 @@ TEST_CASE("module/redis/module_redis_commands.c", "[module][redis][module_redis_
         REQUIRE(command_infos_map[0].tokens_hashtable == nullptr);
         REQUIRE(command_infos_map[1].tokens_hashtable == nullptr);
     }
+
+    SECTION("module_redis_commands_lookup") {
+        SECTION("existing command") {
+            module_redis_command_info_t *command_info = module_redis_commands_lookup("GET", strlen("GET"));
+
+            REQUIRE(command_info != nullptr);
+            REQUIRE(command_info->command == MODULE_REDIS_COMMAND_GET);
+            REQUIRE(command_info->argument_member_context_addr_fast_path_funcptr != nullptr);
+        }
+
+        SECTION("existing command case insensitive") {
+            module_redis_command_info_t *command_info = module_redis_commands_lookup("gEt", strlen("gEt"));
+
+            REQUIRE(command_info != nullptr);
+            REQUIRE(command_info->command == MODULE_REDIS_COMMAND_GET);
+        }
+
+        SECTION("existing command without fast path") {
+            module_redis_command_info_t *command_info = module_redis_commands_lookup("APPEND", strlen("APPEND"));
+
+            REQUIRE(command_info != nullptr);
+            REQUIRE(command_info->command == MODULE_REDIS_COMMAND_APPEND);
+            REQUIRE(command_info->argument_member_context_addr_fast_path_funcptr == nullptr);
+        }
+
+        SECTION("non-existing command") {
+            REQUIRE(module_redis_commands_lookup("NOTACOMMAND", strlen("NOTACOMMAND")) == nullptr);
+        }
+
+        SECTION("prefix of an existing command") {
+            REQUIRE(module_redis_commands_lookup("GE", strlen("GE")) == nullptr);
+        }
+
+        SECTION("command too long") {
+            char command[MODULE_REDIS_COMMAND_MAX_LENGTH + 2] = { 0 };
+            memset(command, 'A', sizeof(command) - 1);
+
+            REQUIRE(module_redis_commands_lookup(command, strlen(command)) == nullptr);
+        }
+    }
 }
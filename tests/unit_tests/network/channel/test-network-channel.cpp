@@ -11,7 +11,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <unistd.h>
 #include <arpa/inet.h>
+#include <sys/un.h>
 
 #include "../network_tests_support.h"
 
@@ -424,4 +426,129 @@ TEST_CASE("network/channel/network_channel.c", "[network][network_channel][netwo
             REQUIRE(listener_new_cb_user_data.listeners_count == 0);
         }
     }
+
+    SECTION("network_channel_listener_new_unix") {
+        char path[64];
+        network_channel_t test_listeners[10] = { 0 };
+        network_channel_listener_new_callback_user_data_t listener_new_cb_user_data = { 0 };
+        listener_new_cb_user_data.network_channel_size = sizeof(network_channel_t);
+
+        SECTION("count") {
+            snprintf(path, sizeof(path), "/tmp/cachegrand-test-channel-count-%d.sock", getpid());
+
+            REQUIRE(network_channel_listener_new_unix(
+                    path,
+                    0,
+                    10,
+                    0,
+                    &listener_new_cb_user_data));
+
+            REQUIRE(listener_new_cb_user_data.listeners_count == 1);
+        }
+
+        SECTION("new listener") {
+            snprintf(path, sizeof(path), "/tmp/cachegrand-test-channel-new-%d.sock", getpid());
+            unlink(path);
+
+            listener_new_cb_user_data.listeners = test_listeners;
+            REQUIRE(network_channel_listener_new_unix(
+                    path,
+                    0,
+                    10,
+                    0,
+                    &listener_new_cb_user_data));
+
+            REQUIRE(listener_new_cb_user_data.listeners_count == 1);
+            REQUIRE(listener_new_cb_user_data.listeners[0].fd > 0);
+            REQUIRE(listener_new_cb_user_data.listeners[0].address.size == sizeof(struct sockaddr_un));
+            REQUIRE(listener_new_cb_user_data.listeners[0].address.socket.base.sa_family == AF_UNIX);
+            REQUIRE(strncmp(listener_new_cb_user_data.listeners[0].address.str, "unix:/tmp/", 10) == 0);
+
+            REQUIRE(network_io_common_socket_close(listener_new_cb_user_data.listeners[0].fd, false));
+
+            network_channel_listener_unix_shared_cleanup();
+            REQUIRE(access(path, F_OK) == -1);
+        }
+
+        SECTION("shared listener") {
+            snprintf(path, sizeof(path), "/tmp/cachegrand-test-channel-shared-%d.sock", getpid());
+            unlink(path);
+
+            listener_new_cb_user_data.listeners = test_listeners;
+            REQUIRE(network_channel_listener_new_unix(
+                    path,
+                    0,
+                    10,
+                    0,
+                    &listener_new_cb_user_data));
+            REQUIRE(network_channel_listener_new_unix(
+                    path,
+                    0,
+                    10,
+                    0,
+                    &listener_new_cb_user_data));
+
+            REQUIRE(listener_new_cb_user_data.listeners_count == 2);
+            REQUIRE(listener_new_cb_user_data.listeners[0].fd > 0);
+            REQUIRE(listener_new_cb_user_data.listeners[1].fd > 0);
+            REQUIRE(listener_new_cb_user_data.listeners[0].fd != listener_new_cb_user_data.listeners[1].fd);
+
+            REQUIRE(network_io_common_socket_close(listener_new_cb_user_data.listeners[0].fd, false));
+            REQUIRE(network_io_common_socket_close(listener_new_cb_user_data.listeners[1].fd, false));
+
+            network_channel_listener_unix_shared_cleanup();
+            REQUIRE(access(path, F_OK) == -1);
+        }
+
+        SECTION("shared listener recreated after cleanup") {
+            snprintf(path, sizeof(path), "/tmp/cachegrand-test-channel-recreate-%d.sock", getpid());
+            unlink(path);
+
+            listener_new_cb_user_data.listeners = test_listeners;
+            REQUIRE(network_channel_listener_new_unix(
+                    path,
+                    0,
+                    10,
+                    0,
+                    &listener_new_cb_user_data));
+            REQUIRE(network_io_common_socket_close(listener_new_cb_user_data.listeners[0].fd, false));
+
+            network_channel_listener_unix_shared_cleanup();
+
+            // A new socket has to be created, the fd of the previous one has been closed
+            REQUIRE(network_channel_listener_new_unix(
+                    path,
+                    0,
+                    10,
+                    0,
+                    &listener_new_cb_user_data));
+            REQUIRE(listener_new_cb_user_data.listeners_count == 2);
+
+            struct sockaddr_un address = { 0 };
+            socklen_t address_length = sizeof(address);
+            REQUIRE(getsockname(listener_new_cb_user_data.listeners[1].fd, (struct sockaddr*)&address, &address_length) == 0);
+            REQUIRE(strcmp(address.sun_path, path) == 0);
+
+            REQUIRE(network_io_common_socket_close(listener_new_cb_user_data.listeners[1].fd, false));
+
+            network_channel_listener_unix_shared_cleanup();
+            REQUIRE(access(path, F_OK) == -1);
+        }
+
+        SECTION("path too long") {
+            char path_too_long[256];
+            memset(path_too_long, 'a', sizeof(path_too_long) - 1);
+            path_too_long[sizeof(path_too_long) - 1] = 0;
+
+            listener_new_cb_user_data.listeners = test_listeners;
+            REQUIRE(!network_channel_listener_new_unix(
+                    path_too_long,
+                    0,
+                    10,
+                    0,
+                    &listener_new_cb_user_data));
+
+            REQUIRE(listener_new_cb_user_data.listeners_count == 0);
+        }
+    }
 }
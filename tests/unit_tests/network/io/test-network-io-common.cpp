@@ -14,7 +14,10 @@
 #include <cerrno>
 #include <strings.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
 
@@ -792,6 +795,128 @@ TEST_CASE("network/io/network_io_common.c", "[network][network_io][network_io_co
         }
     }
 
+    SECTION("network_io_common_socket_get_send_queue_size") {
+        SECTION("valid socket fd") {
+            int fds[2];
+            char buffer[128] = { 0 };
+            REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+            REQUIRE(network_io_common_socket_get_send_queue_size(fds[0]) == 0);
+            REQUIRE(send(fds[0], buffer, sizeof(buffer), 0) == sizeof(buffer));
+            REQUIRE(network_io_common_socket_get_send_queue_size(fds[0]) > 0);
+
+            REQUIRE(recv(fds[1], buffer, sizeof(buffer), 0) == sizeof(buffer));
+            REQUIRE(network_io_common_socket_get_send_queue_size(fds[0]) == 0);
+
+            close(fds[0]);
+            close(fds[1]);
+        }
+
+        SECTION("invalid socket fd") {
+            REQUIRE(network_io_common_socket_get_send_queue_size(-1) == -1);
+        }
+    }
+
+    SECTION("network_io_common_socket_unix_new_server") {
+        char path[64];
+        struct stat path_stat = { 0 };
+        snprintf(path, sizeof(path), "/tmp/cachegrand-test-%d.sock", getpid());
+        unlink(path);
+
+        SECTION("valid path") {
+            int fd = network_io_common_socket_unix_new_server(0, path, 0, 10);
+
+            REQUIRE(fd > 0);
+            REQUIRE(lstat(path, &path_stat) == 0);
+            REQUIRE(S_ISSOCK(path_stat.st_mode));
+
+            close(fd);
+        }
+
+        SECTION("valid path with permissions") {
+            int fd = network_io_common_socket_unix_new_server(0, path, 0600, 10);
+
+            REQUIRE(fd > 0);
+            REQUIRE(lstat(path, &path_stat) == 0);
+            REQUIRE((path_stat.st_mode & 07777) == 0600);
+
+            close(fd);
+        }
+
+        SECTION("stale socket is replaced") {
+            int fd_stale = network_io_common_socket_unix_new_server(0, path, 0, 10);
+            REQUIRE(fd_stale > 0);
+            close(fd_stale);
+
+            int fd = network_io_common_socket_unix_new_server(0, path, 0, 10);
+            REQUIRE(fd > 0);
+
+            close(fd);
+        }
+
+        SECTION("not a socket file is left untouched") {
+            int file_fd = open(path, O_CREAT | O_WRONLY, 0600);
+            REQUIRE(file_fd > 0);
+            close(file_fd);
+
+            REQUIRE(network_io_common_socket_unix_new_server(0, path, 0, 10) == -1);
+            REQUIRE(lstat(path, &path_stat) == 0);
+            REQUIRE(S_ISREG(path_stat.st_mode));
+        }
+
+        SECTION("path too long") {
+            char path_too_long[256];
+            memset(path_too_long, 'a', sizeof(path_too_long) - 1);
+            path_too_long[sizeof(path_too_long) - 1] = 0;
+
+            REQUIRE(network_io_common_socket_unix_new_server(0, path_too_long, 0, 10) == -1);
+        }
+
+        SECTION("accept a client") {
+            struct sockaddr_un address = { 0 };
+            address.sun_family = AF_UNIX;
+            strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+            int fd = network_io_common_socket_unix_new_server(0, path, 0, 10);
+            REQUIRE(fd > 0);
+
+            int client_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            REQUIRE(connect(client_fd, (struct sockaddr*)&address, sizeof(address)) == 0);
+
+            int accepted_fd = accept(fd, nullptr, nullptr);
+            REQUIRE(accepted_fd > 0);
+
+            close(accepted_fd);
+            close(client_fd);
+            close(fd);
+        }
+
+        unlink(path);
+    }
+
+    SECTION("network_io_common_socket_address_str") {
+        char buffer[INET6_ADDRSTRLEN + 1 + 5 + 1] = { 0 };
+
+        SECTION("unix socket") {
+            struct sockaddr_un address = { 0 };
+            address.sun_family = AF_UNIX;
+            strcpy(address.sun_path, "/tmp/cachegrand.sock");
+
+            network_io_common_socket_address_str((struct sockaddr*)&address, buffer, sizeof(buffer));
+
+            REQUIRE(strcmp(buffer, "unix:/tmp/cachegrand.sock") == 0);
+        }
+
+        SECTION("unnamed unix socket") {
+            struct sockaddr_un address = { 0 };
+            address.sun_family = AF_UNIX;
+
+            network_io_common_socket_address_str((struct sockaddr*)&address, buffer, sizeof(buffer));
+
+            REQUIRE(strcmp(buffer, "unix:") == 0);
+        }
+    }
+
     SECTION("network_io_common_socket_close") {
         uint16_t socket_port_free_ipv4 = network_tests_support_search_free_port_ipv4();
         uint16_t socket_port_free_ipv6 = network_tests_support_search_free_port_ipv6();
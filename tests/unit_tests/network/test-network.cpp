@@ -0,0 +1,132 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "xalloc.h"
+#include "spinlock.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
+#include "network/network.h"
+
+TEST_CASE("network/network.c", "[network][network]") {
+    network_channel_buffer_t buffer = { nullptr };
+
+    network_buffer_init(&buffer, NETWORK_CHANNEL_RECV_BUFFER_SIZE);
+
+    SECTION("network_buffer_init") {
+        REQUIRE(buffer.data == nullptr);
+        REQUIRE(buffer.length == 0);
+        REQUIRE(buffer.length_max == NETWORK_CHANNEL_RECV_BUFFER_SIZE);
+        REQUIRE(buffer.packet_length_hint == NETWORK_CHANNEL_BUFFER_LENGTH_MIN);
+    }
+
+    SECTION("network_buffer_ensure_free_space") {
+        SECTION("allocate the minimum length") {
+            REQUIRE(network_buffer_ensure_free_space(&buffer, 10));
+            REQUIRE(buffer.data != nullptr);
+            REQUIRE(buffer.length == NETWORK_CHANNEL_BUFFER_LENGTH_MIN);
+        }
+
+        SECTION("grow to the next power of two") {
+            REQUIRE(network_buffer_ensure_free_space(&buffer, 10));
+            buffer.data_size = 10;
+            memcpy(buffer.data, "0123456789", 10);
+
+            REQUIRE(network_buffer_ensure_free_space(&buffer, NETWORK_CHANNEL_BUFFER_LENGTH_MIN));
+            REQUIRE(buffer.length == NETWORK_CHANNEL_BUFFER_LENGTH_MIN * 2);
+            REQUIRE(memcmp(buffer.data, "0123456789", 10) == 0);
+        }
+
+        SECTION("rewind before growing") {
+            REQUIRE(network_buffer_ensure_free_space(&buffer, NETWORK_CHANNEL_BUFFER_LENGTH_MIN));
+            memcpy(buffer.data + 100, "0123456789", 10);
+            buffer.data_offset = 100;
+            buffer.data_size = 10;
+
+            REQUIRE(network_buffer_ensure_free_space(&buffer, NETWORK_CHANNEL_BUFFER_LENGTH_MIN - 10));
+            REQUIRE(buffer.length == NETWORK_CHANNEL_BUFFER_LENGTH_MIN);
+            REQUIRE(buffer.data_offset == 0);
+            REQUIRE(memcmp(buffer.data, "0123456789", 10) == 0);
+        }
+
+        SECTION("exceed the maximum length") {
+            REQUIRE(!network_buffer_ensure_free_space(&buffer, NETWORK_CHANNEL_RECV_BUFFER_SIZE + 1));
+            REQUIRE(buffer.data == nullptr);
+        }
+
+        SECTION("capped to the maximum length") {
+            REQUIRE(network_buffer_ensure_free_space(&buffer, NETWORK_CHANNEL_RECV_BUFFER_SIZE - 1));
+            REQUIRE(buffer.length == NETWORK_CHANNEL_RECV_BUFFER_SIZE);
+        }
+    }
+
+    SECTION("network_buffer_release_if_empty") {
+        SECTION("empty buffer") {
+            REQUIRE(network_buffer_ensure_free_space(&buffer, NETWORK_CHANNEL_BUFFER_LENGTH_MIN * 4));
+            buffer.packet_length_hint = NETWORK_CHANNEL_BUFFER_LENGTH_MIN * 4;
+
+            REQUIRE(network_buffer_release_if_empty(&buffer));
+            REQUIRE(buffer.data == nullptr);
+            REQUIRE(buffer.length == 0);
+            REQUIRE(buffer.packet_length_hint == NETWORK_CHANNEL_BUFFER_LENGTH_MIN);
+        }
+
+        SECTION("buffer with data") {
+            REQUIRE(network_buffer_ensure_free_space(&buffer, 10));
+            buffer.data_size = 10;
+
+            REQUIRE(!network_buffer_release_if_empty(&buffer));
+            REQUIRE(buffer.data != nullptr);
+        }
+    }
+
+    SECTION("buffers_size stat") {
+        worker_context_t worker_context = { 0 };
+        worker_context_set(&worker_context);
+
+        SECTION("network_buffer_free") {
+            REQUIRE(network_buffer_ensure_free_space(&buffer, 10));
+            REQUIRE(worker_context.stats.internal.network.buffers_size == NETWORK_CHANNEL_BUFFER_LENGTH_MIN);
+
+            network_buffer_free(&buffer);
+            REQUIRE(worker_context.stats.internal.network.buffers_size == 0);
+        }
+
+        SECTION("network_channel_cleanup") {
+            network_channel_t channel = { 0 };
+            channel.type = NETWORK_CHANNEL_TYPE_CLIENT;
+            network_buffer_init(&channel.buffers.send, NETWORK_CHANNEL_SEND_BUFFER_SIZE);
+
+            REQUIRE(network_buffer_ensure_free_space(&channel.buffers.send, 10));
+            REQUIRE(worker_context.stats.internal.network.buffers_size == NETWORK_CHANNEL_BUFFER_LENGTH_MIN);
+
+            network_channel_cleanup(&channel);
+            REQUIRE(channel.buffers.send.data == nullptr);
+            REQUIRE(worker_context.stats.internal.network.buffers_size == 0);
+        }
+
+        worker_context_set(nullptr);
+    }
+
+    network_buffer_free(&buffer);
+    REQUIRE(buffer.data == nullptr);
+}
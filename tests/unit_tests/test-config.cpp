@@ -123,6 +123,16 @@ network:
   backend: io_uring
   max_clients: 10000
   listen_backlog: 100
+  polling:
+    mode: sqpoll
+    sqpoll_idle_ms: 10
+    sqpoll_shared: true
+    busy_poll_us: 50
+    spin_before_sleep_us: 50
+  rebalancing:
+    interval_ms: 1000
+    imbalance_threshold_percent: 25
+    max_migrations_per_interval: 8
 modules:
   - type: redis
     redis:
@@ -138,6 +148,12 @@ modules:
         time: 10
         interval: 20
         probes: 30
+      output_buffer_limits:
+        hard:
+          max_size: 2MB
+        soft:
+          max_size: 512KB
+          max_duration: 60s
       tls:
         certificate_path: "/path/to/certificate.pem"
         private_key_path: "/path/to/certificate.key"
@@ -145,6 +161,12 @@ modules:
         max_version: any
         cipher_suites:
           - TLS-ECDHE-RSA-WITH-AES-256-GCM-SHA384
+        session_resumption:
+          tickets: true
+          tickets_lifetime: 12h
+          cache: true
+          cache_max_entries: 10000
+          cache_timeout: 1h
       bindings:
         - host: 0.0.0.0
           port: 6379
@@ -838,6 +860,33 @@ TEST_CASE("config.c", "[config]") {
         }
     }
 
+    SECTION("config_process_string_values") {
+        SECTION("tls session resumption") {
+            err = cyaml_load_data(
+                    (const uint8_t *)(test_config_correct_all_fields_yaml_data.c_str()),
+                    test_config_correct_all_fields_yaml_data.length(),
+                    config_cyaml_config,
+                    config_top_schema,
+                    (cyaml_data_t **)&config,
+                    nullptr);
+
+            REQUIRE(config != nullptr);
+            REQUIRE(err == CYAML_OK);
+            REQUIRE(config_process_string_values(config));
+
+            config_module_network_tls_session_resumption_t *session_resumption =
+                    config->modules[0].network->tls->session_resumption;
+            REQUIRE(session_resumption != nullptr);
+            REQUIRE(session_resumption->tickets);
+            REQUIRE(session_resumption->tickets_lifetime_s == 12 * 60 * 60);
+            REQUIRE(session_resumption->cache);
+            REQUIRE(session_resumption->cache_max_entries == 10000);
+            REQUIRE(session_resumption->cache_timeout_s == 60 * 60);
+
+            cyaml_free(config_cyaml_config, config_top_schema, config, 0);
+        }
+    }
+
     SECTION("config_validate_after_load_cpus") {
         SECTION("valid") {
              err = cyaml_load_data(
@@ -946,6 +995,63 @@ TEST_CASE("config.c", "[config]") {
         }
     }
 
+    SECTION("config_validate_after_load_network_polling") {
+        err = cyaml_load_data(
+                (const uint8_t *)(test_config_correct_all_fields_yaml_data.c_str()),
+                test_config_correct_all_fields_yaml_data.length(),
+                config_cyaml_config,
+                config_top_schema,
+                (cyaml_data_t **)&config,
+                nullptr);
+
+        REQUIRE(config != nullptr);
+        REQUIRE(err == CYAML_OK);
+        REQUIRE(config->network->polling != nullptr);
+        REQUIRE(config->network->polling->mode == CONFIG_NETWORK_POLLING_MODE_SQPOLL);
+
+        SECTION("valid") {
+            REQUIRE(config_validate_after_load_network_polling(config));
+        }
+
+        SECTION("sqpoll settings without sqpoll mode") {
+            config->network->polling->mode = CONFIG_NETWORK_POLLING_MODE_INTERRUPT;
+            REQUIRE(!config_validate_after_load_network_polling(config));
+        }
+
+        cyaml_free(config_cyaml_config, config_top_schema, config, 0);
+    }
+
+    SECTION("config_validate_after_load_network_rebalancing") {
+        err = cyaml_load_data(
+                (const uint8_t *)(test_config_correct_all_fields_yaml_data.c_str()),
+                test_config_correct_all_fields_yaml_data.length(),
+                config_cyaml_config,
+                config_top_schema,
+                (cyaml_data_t **)&config,
+                nullptr);
+
+        REQUIRE(config != nullptr);
+        REQUIRE(err == CYAML_OK);
+        REQUIRE(config->network->rebalancing != nullptr);
+        REQUIRE(config->network->rebalancing->interval_ms == 1000);
+
+        SECTION("valid") {
+            REQUIRE(config_validate_after_load_network_rebalancing(config));
+        }
+
+        SECTION("interval zero") {
+            config->network->rebalancing->interval_ms = 0;
+            REQUIRE(!config_validate_after_load_network_rebalancing(config));
+        }
+
+        SECTION("imbalance threshold out of range") {
+            config->network->rebalancing->imbalance_threshold_percent = 101;
+            REQUIRE(!config_validate_after_load_network_rebalancing(config));
+        }
+
+        cyaml_free(config_cyaml_config, config_top_schema, config, 0);
+    }
+
     SECTION("config_validate_after_load_modules_network_timeout") {
         SECTION("valid") {
              err = cyaml_load_data(
@@ -982,6 +1088,83 @@ TEST_CASE("config.c", "[config]") {
 
             cyaml_free(config_cyaml_config, config_top_schema, config, 0);
         }
+
+        SECTION("unix socket") {
+            config_module_network_binding_t binding = { 0 };
+            config_module_network_t network = { 0 };
+            config_module_t module = { 0 };
+            module.type = (char*)"redis";
+            module.network = &network;
+            network.bindings = &binding;
+            network.bindings_count = 1;
+
+            SECTION("valid") {
+                binding.path = (char*)"/tmp/cachegrand.sock";
+                REQUIRE(config_validate_after_load_modules_network_bindings(&module));
+            }
+
+            SECTION("host and path") {
+                binding.host = (char*)"127.0.0.1";
+                binding.port = 6379;
+                binding.path = (char*)"/tmp/cachegrand.sock";
+                REQUIRE(!config_validate_after_load_modules_network_bindings(&module));
+            }
+
+            SECTION("no host and no path") {
+                REQUIRE(!config_validate_after_load_modules_network_bindings(&module));
+            }
+
+            SECTION("host without port") {
+                binding.host = (char*)"127.0.0.1";
+                REQUIRE(!config_validate_after_load_modules_network_bindings(&module));
+            }
+
+            SECTION("tls not supported") {
+                binding.path = (char*)"/tmp/cachegrand.sock";
+                binding.tls = true;
+                REQUIRE(!config_validate_after_load_modules_network_bindings(&module));
+            }
+        }
+    }
+
+    SECTION("config_validate_after_load_modules_network_output_buffer_limits") {
+        config_module_network_output_buffer_limits_hard_t hard = { 0 };
+        config_module_network_output_buffer_limits_soft_t soft = { 0 };
+        config_module_network_output_buffer_limits_t limits = { 0 };
+        config_module_network_t network = { 0 };
+        config_module_t module = { 0 };
+        module.type = (char*)"redis";
+        module.network = &network;
+        limits.hard = &hard;
+
+        SECTION("no limits") {
+            REQUIRE(config_validate_after_load_modules_network_output_buffer_limits(&module));
+        }
+
+        SECTION("only hard limit") {
+            network.output_buffer_limits = &limits;
+            hard.max_size = 1024 * 1024;
+
+            REQUIRE(config_validate_after_load_modules_network_output_buffer_limits(&module));
+        }
+
+        SECTION("soft limit lower than hard limit") {
+            network.output_buffer_limits = &limits;
+            limits.soft = &soft;
+            hard.max_size = 1024 * 1024;
+            soft.max_size = 1024;
+
+            REQUIRE(config_validate_after_load_modules_network_output_buffer_limits(&module));
+        }
+
+        SECTION("soft limit greater than hard limit") {
+            network.output_buffer_limits = &limits;
+            limits.soft = &soft;
+            hard.max_size = 1024;
+            soft.max_size = 1024 * 1024;
+
+            REQUIRE(!config_validate_after_load_modules_network_output_buffer_limits(&module));
+        }
     }
 
     SECTION("config_validate_after_load_modules_network_tls") {
@@ -0,0 +1,160 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#include "xalloc.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_pool.h"
+
+#define TEST_FIBER_POOL_STACK_SIZE (4096 * 10)
+
+char test_fiber_pool_fiber_name[] = "test-fiber-pool";
+size_t test_fiber_pool_fiber_name_len = strlen(test_fiber_pool_fiber_name);
+
+void test_fiber_pool_fiber_entrypoint(void *user_data) {
+    // do nothing
+}
+
+TEST_CASE("fiber/fiber_pool.c", "[fiber][fiber_pool]") {
+    SECTION("fiber_pool_new") {
+        fiber_pool_t *fiber_pool = fiber_pool_new(TEST_FIBER_POOL_STACK_SIZE, 4);
+
+        REQUIRE(fiber_pool != nullptr);
+        REQUIRE(fiber_pool->stack_size == TEST_FIBER_POOL_STACK_SIZE);
+        REQUIRE(fiber_pool->max_size == 4);
+        REQUIRE(fiber_pool_get_count(fiber_pool) == 0);
+        REQUIRE(fiber_pool->fibers != nullptr);
+
+        fiber_pool_free(fiber_pool);
+    }
+
+    SECTION("fiber_pool_prewarm") {
+        fiber_pool_t *fiber_pool = fiber_pool_new(TEST_FIBER_POOL_STACK_SIZE, 4);
+
+        SECTION("less than max size") {
+            REQUIRE(fiber_pool_prewarm(fiber_pool, 2) == 2);
+            REQUIRE(fiber_pool_get_count(fiber_pool) == 2);
+        }
+
+        SECTION("more than max size") {
+            REQUIRE(fiber_pool_prewarm(fiber_pool, 10) == 4);
+            REQUIRE(fiber_pool_get_count(fiber_pool) == 4);
+        }
+
+        fiber_pool_free(fiber_pool);
+    }
+
+    SECTION("fiber_pool_acquire") {
+        fiber_pool_t *fiber_pool = fiber_pool_new(TEST_FIBER_POOL_STACK_SIZE, 4);
+
+        SECTION("empty pool") {
+            fiber_t *fiber = fiber_pool_acquire(
+                    fiber_pool,
+                    test_fiber_pool_fiber_name,
+                    test_fiber_pool_fiber_name_len,
+                    test_fiber_pool_fiber_entrypoint,
+                    nullptr);
+
+            REQUIRE(fiber != nullptr);
+            REQUIRE(fiber->start_fp == test_fiber_pool_fiber_entrypoint);
+            REQUIRE(strcmp(fiber->name, test_fiber_pool_fiber_name) == 0);
+            REQUIRE(fiber_pool_get_count(fiber_pool) == 0);
+
+            fiber_free(fiber);
+        }
+
+        SECTION("prewarmed pool") {
+            fiber_pool_prewarm(fiber_pool, 2);
+            fiber_t *fiber_expected = fiber_pool->fibers[1];
+            void *stack_base = fiber_expected->stack_base;
+
+            fiber_t *fiber = fiber_pool_acquire(
+                    fiber_pool,
+                    test_fiber_pool_fiber_name,
+                    test_fiber_pool_fiber_name_len,
+                    test_fiber_pool_fiber_entrypoint,
+                    nullptr);
+
+            REQUIRE(fiber == fiber_expected);
+            REQUIRE(fiber->stack_base == stack_base);
+            REQUIRE(fiber->start_fp == test_fiber_pool_fiber_entrypoint);
+            REQUIRE(fiber->terminate == false);
+            REQUIRE(strcmp(fiber->name, test_fiber_pool_fiber_name) == 0);
+            REQUIRE(fiber_pool_get_count(fiber_pool) == 1);
+            REQUIRE(fiber_pool->fibers[1] == nullptr);
+
+            fiber_free(fiber);
+        }
+
+        SECTION("user data without entrypoint") {
+            fiber_pool_prewarm(fiber_pool, 1);
+
+            REQUIRE(fiber_pool_acquire(
+                    fiber_pool,
+                    test_fiber_pool_fiber_name,
+                    test_fiber_pool_fiber_name_len,
+                    nullptr,
+                    (void*)test_fiber_pool_fiber_name) == nullptr);
+            REQUIRE(fiber_pool_get_count(fiber_pool) == 1);
+        }
+
+        fiber_pool_free(fiber_pool);
+    }
+
+    SECTION("fiber_pool_release") {
+        fiber_pool_t *fiber_pool = fiber_pool_new(TEST_FIBER_POOL_STACK_SIZE, 1);
+
+        SECTION("fiber is recycled") {
+            fiber_t *fiber = fiber_pool_acquire(
+                    fiber_pool,
+                    test_fiber_pool_fiber_name,
+                    test_fiber_pool_fiber_name_len,
+                    test_fiber_pool_fiber_entrypoint,
+                    nullptr);
+            fiber->terminate = true;
+            fiber->error_number = 1;
+
+            fiber_pool_release(fiber_pool, fiber);
+            REQUIRE(fiber_pool_get_count(fiber_pool) == 1);
+
+            fiber_t *fiber_new = fiber_pool_acquire(
+                    fiber_pool,
+                    (char*)"new",
+                    3,
+                    test_fiber_pool_fiber_entrypoint,
+                    nullptr);
+
+            REQUIRE(fiber_new == fiber);
+            REQUIRE(fiber_new->terminate == false);
+            REQUIRE(fiber_new->error_number == 0);
+            REQUIRE(strcmp(fiber_new->name, "new") == 0);
+
+            fiber_free(fiber_new);
+        }
+
+        SECTION("pool full") {
+            fiber_pool_prewarm(fiber_pool, 1);
+            fiber_t *fiber = fiber_new(
+                    test_fiber_pool_fiber_name,
+                    test_fiber_pool_fiber_name_len,
+                    TEST_FIBER_POOL_STACK_SIZE,
+                    test_fiber_pool_fiber_entrypoint,
+                    nullptr);
+
+            fiber_pool_release(fiber_pool, fiber);
+            REQUIRE(fiber_pool_get_count(fiber_pool) == 1);
+            REQUIRE(fiber_pool->fibers[0] != fiber);
+        }
+
+        fiber_pool_free(fiber_pool);
+    }
+}
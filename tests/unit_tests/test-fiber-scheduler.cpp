@@ -72,6 +72,31 @@ void test_fiber_scheduler_fiber_switch_to_test_entrypoint(void *user_data) {
     fiber_scheduler_switch_back();
 }
 
+int test_fiber_scheduler_yield_counter = 0;
+void test_fiber_scheduler_fiber_yield_entrypoint(void *user_data) {
+    test_fiber_scheduler_yield_counter++;
+    fiber_scheduler_yield();
+    test_fiber_scheduler_yield_counter++;
+    fiber_scheduler_yield();
+    test_fiber_scheduler_yield_counter++;
+
+    fiber_scheduler_switch_back();
+}
+
+bool test_fiber_scheduler_time_slice_expired_without_time_slice = true;
+bool test_fiber_scheduler_time_slice_yielded = false;
+void test_fiber_scheduler_fiber_yield_if_time_slice_expired_entrypoint(void *user_data) {
+    test_fiber_scheduler_time_slice_expired_without_time_slice = fiber_scheduler_time_slice_expired();
+
+    fiber_scheduler_set_time_slice_us(1);
+    while(!fiber_scheduler_yield_if_time_slice_expired()) {
+        // do nothing
+    }
+    test_fiber_scheduler_time_slice_yielded = true;
+
+    fiber_scheduler_switch_back();
+}
+
 TEST_CASE("fiber_scheduler.c", "[fiber_scheduler]") {
     size_t page_size = getpagesize();
     size_t stack_size = page_size * 8;
@@ -311,6 +336,66 @@ TEST_CASE("fiber_scheduler.c", "[fiber_scheduler]") {
         fiber_scheduler_stack.size = 0;
     }
 
+    SECTION("fiber_scheduler_yield") {
+        test_fiber_scheduler_yield_counter = 0;
+
+        fiber_t *fiber = fiber_scheduler_new_fiber(
+                test_fiber_scheduler_fixture_fiber_name,
+                test_fiber_scheduler_fixture_fiber_name_leb,
+                test_fiber_scheduler_fiber_yield_entrypoint,
+                nullptr);
+
+        REQUIRE(test_fiber_scheduler_yield_counter == 1);
+        REQUIRE(fiber_scheduler_has_ready_fibers());
+
+        fiber_scheduler_resume_ready_fibers();
+        REQUIRE(test_fiber_scheduler_yield_counter == 2);
+        REQUIRE(fiber_scheduler_has_ready_fibers());
+
+        fiber_scheduler_resume_ready_fibers();
+        REQUIRE(test_fiber_scheduler_yield_counter == 3);
+        REQUIRE(!fiber_scheduler_has_ready_fibers());
+
+        fiber_free(fiber);
+        fiber_scheduler_free();
+    }
+
+    SECTION("fiber_scheduler_yield_if_time_slice_expired") {
+        SECTION("outside of a fiber") {
+            fiber_scheduler_set_time_slice_us(1);
+            usleep(10);
+
+            REQUIRE(!fiber_scheduler_time_slice_expired());
+            REQUIRE(!fiber_scheduler_yield_if_time_slice_expired());
+            REQUIRE(!fiber_scheduler_has_ready_fibers());
+        }
+
+        SECTION("inside a fiber") {
+            test_fiber_scheduler_time_slice_expired_without_time_slice = true;
+            test_fiber_scheduler_time_slice_yielded = false;
+
+            fiber_t *fiber = fiber_scheduler_new_fiber(
+                    test_fiber_scheduler_fixture_fiber_name,
+                    test_fiber_scheduler_fixture_fiber_name_leb,
+                    test_fiber_scheduler_fiber_yield_if_time_slice_expired_entrypoint,
+                    nullptr);
+
+            REQUIRE(!test_fiber_scheduler_time_slice_expired_without_time_slice);
+            REQUIRE(!test_fiber_scheduler_time_slice_yielded);
+            REQUIRE(fiber_scheduler_has_ready_fibers());
+
+            fiber_scheduler_resume_ready_fibers();
+
+            REQUIRE(test_fiber_scheduler_time_slice_yielded);
+            REQUIRE(!fiber_scheduler_has_ready_fibers());
+
+            fiber_free(fiber);
+        }
+
+        fiber_scheduler_set_time_slice_us(0);
+        fiber_scheduler_free();
+    }
+
     SECTION("fiber_scheduler_set_error") {
         fiber_t fiber = {
                 .start_fp = nullptr,
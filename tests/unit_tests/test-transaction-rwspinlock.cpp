@@ -154,6 +154,19 @@ void* test_transaction_rwspinlock_lock_counter_thread_func(void* rawdata) {
     return nullptr;
 }
 
+bool test_transaction_rwspinlock_lock_contended_fiber_locked = false;
+void test_transaction_rwspinlock_lock_contended_fiber_entrypoint(void *user_data) {
+    auto* lock = (transaction_rwspinlock_volatile_t*)user_data;
+    transaction_t transaction = { .transaction_id = { }, .locks = { .count = 0 , .size = 0, .list = nullptr, } };
+
+    transaction_acquire(&transaction);
+    REQUIRE(transaction_lock_for_write(&transaction, lock));
+    test_transaction_rwspinlock_lock_contended_fiber_locked = true;
+    transaction_release(&transaction);
+
+    fiber_scheduler_switch_back();
+}
+
 TEST_CASE("transaction.c (transaction_rwspinlock)", "[transaction][transaction_rwspinlock]") {
     worker_context_t worker_context = { 0 };
     worker_context.worker_index = UINT16_MAX;
@@ -286,6 +299,82 @@ TEST_CASE("transaction.c (transaction_rwspinlock)", "[transaction][transaction_r
             REQUIRE(lock.internal_data.transaction_id == TRANSACTION_SPINLOCK_UNLOCKED);
         }
 
+        SECTION("lock - contended within a fiber parks") {
+            transaction_t transaction = { .transaction_id = { }, .locks = { .count = 0 , .size = 0, .list = nullptr, } };
+            transaction_rwspinlock_t lock = {0};
+            test_transaction_rwspinlock_lock_contended_fiber_locked = false;
+
+            transaction_rwspinlock_init(&lock);
+            fiber_scheduler_set_time_slice_us(FIBER_SCHEDULER_TIME_SLICE_US_DEFAULT);
+
+            transaction_acquire(&transaction);
+            REQUIRE(transaction_lock_for_write(&transaction, &lock));
+
+            // The fiber can't acquire the lock and, instead of spinning forever, it gets parked until the lock is
+            // released, it's not in the ready queue
+            fiber_t *fiber = fiber_scheduler_new_fiber(
+                    (char*)"test-fiber",
+                    strlen("test-fiber"),
+                    test_transaction_rwspinlock_lock_contended_fiber_entrypoint,
+                    (void*)&lock);
+
+            REQUIRE(!test_transaction_rwspinlock_lock_contended_fiber_locked);
+            REQUIRE(!fiber_scheduler_has_ready_fibers());
+            REQUIRE(transaction_rwspinlock_parking_lot_get_bucket(&lock)->waiters_count == 1);
+
+            // Releasing the lock wakes up the parked fiber
+            transaction_release(&transaction);
+
+            REQUIRE(fiber_scheduler_has_ready_fibers());
+            REQUIRE(transaction_rwspinlock_parking_lot_get_bucket(&lock)->waiters_count == 0);
+
+            fiber_scheduler_resume_ready_fibers();
+
+            REQUIRE(test_transaction_rwspinlock_lock_contended_fiber_locked);
+            REQUIRE(!fiber_scheduler_has_ready_fibers());
+            REQUIRE(lock.internal_data.transaction_id == TRANSACTION_SPINLOCK_UNLOCKED);
+
+            fiber_scheduler_set_time_slice_us(0);
+            fiber_free(fiber);
+            fiber_scheduler_free();
+        }
+
+        SECTION("lock - waiting for a reader within a fiber parks") {
+            transaction_t transaction = { .transaction_id = { }, .locks = { .count = 0 , .size = 0, .list = nullptr, } };
+            transaction_rwspinlock_t lock = {0};
+            test_transaction_rwspinlock_lock_contended_fiber_locked = false;
+
+            transaction_rwspinlock_init(&lock);
+            fiber_scheduler_set_time_slice_us(FIBER_SCHEDULER_TIME_SLICE_US_DEFAULT);
+
+            transaction_acquire(&transaction);
+            REQUIRE(transaction_lock_for_read(&transaction, &lock));
+
+            fiber_t *fiber = fiber_scheduler_new_fiber(
+                    (char*)"test-fiber",
+                    strlen("test-fiber"),
+                    test_transaction_rwspinlock_lock_contended_fiber_entrypoint,
+                    (void*)&lock);
+
+            REQUIRE(!test_transaction_rwspinlock_lock_contended_fiber_locked);
+            REQUIRE(!fiber_scheduler_has_ready_fibers());
+
+            // Releasing the read lock wakes up the writer parked waiting for the readers to go away
+            transaction_release(&transaction);
+
+            REQUIRE(fiber_scheduler_has_ready_fibers());
+
+            fiber_scheduler_resume_ready_fibers();
+
+            REQUIRE(test_transaction_rwspinlock_lock_contended_fiber_locked);
+            REQUIRE(lock.internal_data.transaction_id == TRANSACTION_SPINLOCK_UNLOCKED);
+            REQUIRE(lock.internal_data.readers_count == 0);
+
+            fiber_scheduler_set_time_slice_us(0);
+            fiber_free(fiber);
+            fiber_scheduler_free();
+        }
+
         SECTION("lock - wait for reader") {
             int res, pthread_return_val, *pthread_return = nullptr;
             transaction_t transaction = { .transaction_id = { }, .locks = { .count = 0 , .size = 0, .list = nullptr, } };
@@ -32,6 +32,51 @@
 #include "worker/worker_context.h"
 #include "worker/worker.h"
 
+bool test_transaction_nesting_fiber_completed = false;
+
+void test_transaction_nesting_fiber_entrypoint(void *user_data) {
+    auto* lock = (transaction_rwspinlock_volatile_t*)user_data;
+    transaction_t transaction = { 0 };
+    transaction_t nested_transaction = { 0 };
+
+    REQUIRE(transaction_acquire(&transaction));
+    REQUIRE(transaction_nesting_begin(&transaction));
+
+    REQUIRE(transaction_acquire(&nested_transaction));
+    REQUIRE(nested_transaction.parent == &transaction);
+    REQUIRE(nested_transaction.transaction_id.id == transaction.transaction_id.id);
+
+    // The read locks of the nested transactions are taken for write
+    REQUIRE(transaction_lock_for_read(&nested_transaction, lock));
+    REQUIRE(lock->internal_data.transaction_id == transaction.transaction_id.id);
+    REQUIRE(lock->internal_data.readers_count == 0);
+    REQUIRE(nested_transaction.locks.count == 1);
+    REQUIRE(nested_transaction.locks.list[0].lock_type == TRANSACTION_LOCK_TYPE_WRITE);
+
+    transaction_release(&nested_transaction);
+
+    // The lock is handed over to the parent
+    REQUIRE(lock->internal_data.transaction_id == transaction.transaction_id.id);
+    REQUIRE(transaction.locks.count == 1);
+    REQUIRE(transaction.locks.list[0].spinlock == lock);
+
+    // The lock is already owned by the parent so it's not added to the list of the nested transaction
+    REQUIRE(transaction_acquire(&nested_transaction));
+    REQUIRE(transaction_lock_for_write(&nested_transaction, lock));
+    REQUIRE(nested_transaction.locks.count == 0);
+    transaction_release(&nested_transaction);
+
+    transaction_nesting_end(&transaction);
+    REQUIRE(fiber_scheduler_get_current()->transaction == nullptr);
+
+    transaction_release(&transaction);
+    REQUIRE(lock->internal_data.transaction_id == TRANSACTION_SPINLOCK_UNLOCKED);
+
+    test_transaction_nesting_fiber_completed = true;
+
+    fiber_scheduler_switch_back();
+}
+
 TEST_CASE("transaction.c", "[transaction]") {
     worker_context_t worker_context = { 0 };
     worker_context.worker_index = UINT16_MAX;
@@ -265,6 +310,14 @@ TEST_CASE("transaction.c", "[transaction]") {
             REQUIRE(transaction.locks.list[0].lock_type == TRANSACTION_LOCK_TYPE_WRITE);
         }
 
+        SECTION("Lock already owned") {
+            REQUIRE(transaction_lock_for_write(&transaction, &lock));
+            REQUIRE(transaction_lock_for_write(&transaction, &lock));
+
+            REQUIRE(lock.internal_data.transaction_id == transaction.transaction_id.id);
+            REQUIRE(transaction.locks.count == 1);
+        }
+
         SECTION("Failing lock with readers") {
             lock.internal_data.readers_count = 1;
 
@@ -369,4 +422,31 @@ TEST_CASE("transaction.c", "[transaction]") {
             REQUIRE(transaction.locks.list[0].lock_type == TRANSACTION_LOCK_TYPE_READ);
         }
     }
+
+    SECTION("transaction_nesting_begin") {
+        SECTION("Not in a fiber") {
+            transaction_t transaction = { 0 };
+            REQUIRE(transaction_acquire(&transaction));
+
+            REQUIRE(!transaction_nesting_begin(&transaction));
+
+            transaction_release(&transaction);
+        }
+
+        SECTION("Nested transactions in a fiber") {
+            transaction_rwspinlock_volatile_t lock = { 0 };
+            test_transaction_nesting_fiber_completed = false;
+
+            fiber_t *fiber = fiber_scheduler_new_fiber(
+                    (char*)"test-fiber",
+                    strlen("test-fiber"),
+                    test_transaction_nesting_fiber_entrypoint,
+                    (void*)&lock);
+
+            REQUIRE(test_transaction_nesting_fiber_completed);
+
+            fiber_free(fiber);
+            fiber_scheduler_free();
+        }
+    }
 }
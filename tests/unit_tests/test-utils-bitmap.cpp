@@ -0,0 +1,173 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "misc.h"
+#include "cmake_config.h"
+#include "utils_bitmap.h"
+
+static std::vector<uint8_t> test_utils_bitmap_build(
+        size_t length,
+        uint32_t seed) {
+    std::vector<uint8_t> data(length);
+
+    // A simple xorshift is enough to get bytes with different densities of bits set
+    for(size_t index = 0; index < length; index++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        data[index] = (uint8_t)seed;
+    }
+
+    return data;
+}
+
+static uint64_t test_utils_bitmap_popcount_reference(
+        const std::vector<uint8_t> &data,
+        size_t offset,
+        size_t length) {
+    uint64_t count = 0;
+
+    for(size_t index = offset; index < offset + length; index++) {
+        for(int bit = 0; bit < 8; bit++) {
+            count += (data[index] >> bit) & 1;
+        }
+    }
+
+    return count;
+}
+
+static void test_utils_bitmap_bitop_reference(
+        utils_bitmap_op_t op,
+        uint8_t *destination,
+        const uint8_t *source,
+        size_t length) {
+    for(size_t index = 0; index < length; index++) {
+        switch(op) {
+            case UTILS_BITMAP_OP_AND: destination[index] &= source[index]; break;
+            case UTILS_BITMAP_OP_OR: destination[index] |= source[index]; break;
+            case UTILS_BITMAP_OP_XOR: destination[index] ^= source[index]; break;
+            case UTILS_BITMAP_OP_NOT: destination[index] = ~source[index]; break;
+        }
+    }
+}
+
+// The lengths cover the tails of all the vectorized implementations and a few full iterations
+static const size_t test_utils_bitmap_lengths[] = {
+        0, 1, 7, 8, 9, 31, 32, 33, 63, 64, 65, 127, 128, 255, 256, 257, 511, 1000, 4096, 65535, 100003 };
+
+TEST_CASE("utils_bitmap.c", "[utils_bitmap]") {
+    SECTION("utils_bitmap_popcount") {
+        for(size_t length : test_utils_bitmap_lengths) {
+            // An offset of 1 is used to test the unaligned accesses
+            std::vector<uint8_t> data = test_utils_bitmap_build(length + 1, 0x12345678 + length);
+            uint64_t expected = test_utils_bitmap_popcount_reference(data, 1, length);
+
+            REQUIRE(UTILS_BITMAP_NAME_IMPL(popcount, loop)(data.data() + 1, length) == expected);
+            REQUIRE(utils_bitmap_popcount(data.data() + 1, length) == expected);
+
+#if defined(__x86_64__)
+            if (__builtin_cpu_supports("avx2")) {
+                REQUIRE(UTILS_BITMAP_NAME_IMPL(popcount, avx2)(data.data() + 1, length) == expected);
+            }
+
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+            if (__builtin_cpu_supports("avx512vpopcntdq")) {
+                REQUIRE(UTILS_BITMAP_NAME_IMPL(popcount, avx512)(data.data() + 1, length) == expected);
+            }
+#endif
+#endif
+        }
+    }
+
+    SECTION("utils_bitmap_popcount all bits set") {
+        std::vector<uint8_t> data(100003, 0xFF);
+
+        REQUIRE(utils_bitmap_popcount(data.data(), data.size()) == data.size() * 8);
+    }
+
+    SECTION("utils_bitmap_bitop") {
+        for(utils_bitmap_op_t op : { UTILS_BITMAP_OP_AND, UTILS_BITMAP_OP_OR, UTILS_BITMAP_OP_XOR, UTILS_BITMAP_OP_NOT }) {
+            for(size_t length : test_utils_bitmap_lengths) {
+                std::vector<uint8_t> destination = test_utils_bitmap_build(length + 1, 0xCAFEBABE + length);
+                std::vector<uint8_t> source = test_utils_bitmap_build(length + 1, 0xDEADBEEF + length);
+                std::vector<uint8_t> expected = destination;
+                std::vector<uint8_t> result;
+
+                test_utils_bitmap_bitop_reference(op, expected.data() + 1, source.data() + 1, length);
+
+                result = destination;
+                UTILS_BITMAP_NAME_IMPL(bitop, loop)(op, result.data() + 1, source.data() + 1, length);
+                REQUIRE(result == expected);
+
+                result = destination;
+                utils_bitmap_bitop(op, result.data() + 1, source.data() + 1, length);
+                REQUIRE(result == expected);
+
+#if defined(__x86_64__)
+                if (__builtin_cpu_supports("avx2")) {
+                    result = destination;
+                    UTILS_BITMAP_NAME_IMPL(bitop, avx2)(op, result.data() + 1, source.data() + 1, length);
+                    REQUIRE(result == expected);
+                }
+
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+                if (__builtin_cpu_supports("avx512f")) {
+                    result = destination;
+                    UTILS_BITMAP_NAME_IMPL(bitop, avx512)(op, result.data() + 1, source.data() + 1, length);
+                    REQUIRE(result == expected);
+                }
+#endif
+#endif
+            }
+        }
+    }
+
+    SECTION("utils_bitmap_bitop not in place") {
+        std::vector<uint8_t> data = test_utils_bitmap_build(1000, 0xABCDEF01);
+        std::vector<uint8_t> expected = data;
+
+        test_utils_bitmap_bitop_reference(UTILS_BITMAP_OP_NOT, expected.data(), data.data(), data.size());
+        utils_bitmap_bitop(UTILS_BITMAP_OP_NOT, data.data(), data.data(), data.size());
+
+        REQUIRE(data == expected);
+    }
+
+    SECTION("utils_bitmap_find_first_byte") {
+        std::vector<uint8_t> zeros(1000, 0x00);
+        std::vector<uint8_t> ones(1000, 0xFF);
+
+        SECTION("not found") {
+            REQUIRE(utils_bitmap_find_first_byte(zeros.data(), zeros.size(), true) == zeros.size());
+            REQUIRE(utils_bitmap_find_first_byte(ones.data(), ones.size(), false) == ones.size());
+            REQUIRE(utils_bitmap_find_first_byte(zeros.data(), 0, false) == 0);
+        }
+
+        SECTION("found at the beginning") {
+            REQUIRE(utils_bitmap_find_first_byte(zeros.data(), zeros.size(), false) == 0);
+            REQUIRE(utils_bitmap_find_first_byte(ones.data(), ones.size(), true) == 0);
+        }
+
+        SECTION("found at every position") {
+            for(size_t position : { 1, 7, 8, 9, 63, 64, 500, 998, 999 }) {
+                zeros[position] = 0x10;
+                ones[position] = 0xEF;
+
+                REQUIRE(utils_bitmap_find_first_byte(zeros.data(), zeros.size(), true) == position);
+                REQUIRE(utils_bitmap_find_first_byte(ones.data(), ones.size(), false) == position);
+
+                zeros[position] = 0x00;
+                ones[position] = 0xFF;
+            }
+        }
+    }
+}
@@ -0,0 +1,151 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#include "misc.h"
+#include "xalloc.h"
+#include "xalloc_arena.h"
+
+TEST_CASE("xalloc_arena.c", "[xalloc_arena]") {
+    SECTION("xalloc_arena_new") {
+        xalloc_arena_t *arena = xalloc_arena_new(1024);
+
+        REQUIRE(arena != nullptr);
+        REQUIRE(arena->head != nullptr);
+        REQUIRE(arena->head == arena->current);
+        REQUIRE(arena->block_size == 1024);
+        REQUIRE(arena->head->offset == 0);
+        REQUIRE(arena->allocations_count == 0);
+
+        xalloc_arena_free(arena);
+    }
+
+    SECTION("xalloc_arena_alloc") {
+        xalloc_arena_t *arena = xalloc_arena_new(1024);
+
+        SECTION("single allocation") {
+            void *memptr = xalloc_arena_alloc(arena, 10);
+
+            REQUIRE(memptr == arena->head->data);
+            REQUIRE(arena->head->offset == XALLOC_ARENA_ALIGNMENT);
+            REQUIRE(xalloc_arena_get_allocations_count(arena) == 1);
+        }
+
+        SECTION("allocations are aligned") {
+            void *memptr1 = xalloc_arena_alloc(arena, 1);
+            void *memptr2 = xalloc_arena_alloc(arena, 17);
+            void *memptr3 = xalloc_arena_alloc(arena, 1);
+
+            REQUIRE(((uintptr_t)memptr1 % XALLOC_ARENA_ALIGNMENT) == 0);
+            REQUIRE(((uintptr_t)memptr2 % XALLOC_ARENA_ALIGNMENT) == 0);
+            REQUIRE(((uintptr_t)memptr3 % XALLOC_ARENA_ALIGNMENT) == 0);
+            REQUIRE((char*)memptr2 - (char*)memptr1 == XALLOC_ARENA_ALIGNMENT);
+            REQUIRE((char*)memptr3 - (char*)memptr2 == XALLOC_ARENA_ALIGNMENT * 2);
+            REQUIRE(xalloc_arena_get_allocations_count(arena) == 3);
+        }
+
+        SECTION("overflow to a new block") {
+            xalloc_arena_alloc(arena, 1000);
+            void *memptr = xalloc_arena_alloc(arena, 100);
+
+            REQUIRE(arena->head->next != nullptr);
+            REQUIRE(arena->current == arena->head->next);
+            REQUIRE(memptr == arena->current->data);
+        }
+
+        SECTION("allocation larger than the block size") {
+            void *memptr = xalloc_arena_alloc(arena, 4096);
+
+            REQUIRE(arena->current != arena->head);
+            REQUIRE(arena->current->size == 4096);
+            REQUIRE(memptr == arena->current->data);
+
+            memset(memptr, 0xFF, 4096);
+        }
+
+        xalloc_arena_free(arena);
+    }
+
+    SECTION("xalloc_arena_alloc_zero") {
+        xalloc_arena_t *arena = xalloc_arena_new(1024);
+
+        memset(arena->head->data, 0xFF, 1024);
+        char *memptr = (char*)xalloc_arena_alloc_zero(arena, 64);
+
+        for(int index = 0; index < 64; index++) {
+            REQUIRE(memptr[index] == 0);
+        }
+
+        xalloc_arena_free(arena);
+    }
+
+    SECTION("xalloc_arena_realloc") {
+        xalloc_arena_t *arena = xalloc_arena_new(1024);
+
+        SECTION("last allocation is expanded in place") {
+            void *memptr = xalloc_arena_alloc(arena, 16);
+            void *memptr_new = xalloc_arena_realloc(arena, memptr, 16, 64);
+
+            REQUIRE(memptr == memptr_new);
+            REQUIRE(arena->head->offset == 64);
+        }
+
+        SECTION("not the last allocation is copied") {
+            char *memptr = (char*)xalloc_arena_alloc(arena, 16);
+            strcpy(memptr, "cachegrand");
+            xalloc_arena_alloc(arena, 16);
+            char *memptr_new = (char*)xalloc_arena_realloc(arena, memptr, 16, 64);
+
+            REQUIRE(memptr != memptr_new);
+            REQUIRE(strcmp(memptr_new, "cachegrand") == 0);
+        }
+
+        SECTION("not enough space in the block") {
+            char *memptr = (char*)xalloc_arena_alloc(arena, 1000);
+            strcpy(memptr, "cachegrand");
+            char *memptr_new = (char*)xalloc_arena_realloc(arena, memptr, 1000, 2000);
+
+            REQUIRE(memptr != memptr_new);
+            REQUIRE(arena->current != arena->head);
+            REQUIRE(strcmp(memptr_new, "cachegrand") == 0);
+        }
+
+        SECTION("null pointer") {
+            void *memptr = xalloc_arena_realloc(arena, nullptr, 0, 16);
+
+            REQUIRE(memptr == arena->head->data);
+        }
+
+        xalloc_arena_free(arena);
+    }
+
+    SECTION("xalloc_arena_reset") {
+        xalloc_arena_t *arena = xalloc_arena_new(1024);
+        xalloc_arena_block_t *head = arena->head;
+
+        xalloc_arena_alloc(arena, 1000);
+        xalloc_arena_alloc(arena, 1000);
+        xalloc_arena_alloc(arena, 5000);
+
+        xalloc_arena_reset(arena);
+
+        REQUIRE(arena->head == head);
+        REQUIRE(arena->current == head);
+        REQUIRE(arena->head->next == nullptr);
+        REQUIRE(arena->head->offset == 0);
+        REQUIRE(arena->last_allocation == nullptr);
+        REQUIRE(xalloc_arena_get_allocations_count(arena) == 0);
+        REQUIRE(xalloc_arena_alloc(arena, 16) == head->data);
+
+        xalloc_arena_free(arena);
+    }
+}
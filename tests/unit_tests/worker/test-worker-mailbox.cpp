@@ -0,0 +1,270 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstring>
+#include <cerrno>
+
+#include "exttypes.h"
+#include "xalloc.h"
+#include "spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_mailbox.h"
+
+void test_worker_mailbox_message_increment(void *user_data) {
+    (*(uint32_t*)user_data)++;
+}
+
+uint32_t test_worker_mailbox_message_order_last = 0;
+bool test_worker_mailbox_message_order_ok = true;
+
+void test_worker_mailbox_message_order(void *user_data) {
+    auto value = (uint32_t)(uintptr_t)user_data;
+
+    if (value != test_worker_mailbox_message_order_last + 1) {
+        test_worker_mailbox_message_order_ok = false;
+    }
+
+    test_worker_mailbox_message_order_last = value;
+}
+
+TEST_CASE("worker/worker_mailbox.c", "[worker][worker_mailbox]") {
+    SECTION("worker_mailbox_new") {
+        worker_mailbox_t *mailbox = worker_mailbox_new(4, 16);
+
+        REQUIRE(mailbox != nullptr);
+        REQUIRE(mailbox->workers_count == 4);
+        REQUIRE(mailbox->queue_size == 16);
+
+        for(uint32_t receiver_index = 0; receiver_index < 4; receiver_index++) {
+            REQUIRE(mailbox->workers[receiver_index].queues != nullptr);
+            REQUIRE(mailbox->workers[receiver_index].ring_fd == -1);
+            REQUIRE(mailbox->workers[receiver_index].fiber == nullptr);
+            REQUIRE(mailbox->workers[receiver_index].ready == false);
+            REQUIRE(mailbox->workers[receiver_index].wakeup_pending == 0);
+
+            for(uint32_t sender_index = 0; sender_index < 4; sender_index++) {
+                REQUIRE(mailbox->workers[receiver_index].queues[sender_index] != nullptr);
+            }
+        }
+
+        worker_mailbox_free(mailbox);
+    }
+
+    SECTION("worker_mailbox_enqueue") {
+        bool wakeup_required = false;
+        uint32_t counter = 0;
+        worker_mailbox_t *mailbox = worker_mailbox_new(2, 16);
+
+        SECTION("enqueue one message") {
+            REQUIRE(worker_mailbox_enqueue(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(wakeup_required);
+            REQUIRE(ring_bounded_queue_spsc_voidptr_get_length(mailbox->workers[1].queues[0]) == 1);
+            REQUIRE(ring_bounded_queue_spsc_voidptr_get_length(mailbox->workers[0].queues[1]) == 0);
+        }
+
+        SECTION("only the first message requires a wakeup") {
+            REQUIRE(worker_mailbox_enqueue(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(wakeup_required);
+            REQUIRE(worker_mailbox_enqueue(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(!wakeup_required);
+            REQUIRE(worker_mailbox_enqueue(
+                    mailbox, 1, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(!wakeup_required);
+        }
+
+        SECTION("wakeup required again after processing") {
+            REQUIRE(worker_mailbox_enqueue(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(wakeup_required);
+            REQUIRE(worker_mailbox_process(mailbox, 1, false) == 1);
+            REQUIRE(worker_mailbox_enqueue(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(wakeup_required);
+        }
+
+        SECTION("queue full") {
+            for(uint32_t index = 0; index < 16; index++) {
+                REQUIRE(worker_mailbox_enqueue(
+                        mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            }
+
+            REQUIRE(!worker_mailbox_enqueue(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(!wakeup_required);
+
+            // The other senders have their own queue
+            REQUIRE(worker_mailbox_enqueue(
+                    mailbox, 1, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+        }
+
+        worker_mailbox_free(mailbox);
+    }
+
+    SECTION("worker_mailbox_enqueue_or_overflow") {
+        bool wakeup_required = false;
+        uint32_t counter = 0;
+        worker_mailbox_t *mailbox = worker_mailbox_new(2, 16);
+
+        test_worker_mailbox_message_order_last = 0;
+        test_worker_mailbox_message_order_ok = true;
+
+        SECTION("queue not full") {
+            REQUIRE(worker_mailbox_enqueue_or_overflow(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(wakeup_required);
+            REQUIRE(ring_bounded_queue_spsc_voidptr_get_length(mailbox->workers[1].queues[0]) == 1);
+            REQUIRE(mailbox->workers[1].overflows[0].count == 0);
+        }
+
+        SECTION("queue full") {
+            for(uint32_t index = 0; index < 20; index++) {
+                REQUIRE(worker_mailbox_enqueue_or_overflow(
+                        mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            }
+
+            REQUIRE(ring_bounded_queue_spsc_voidptr_get_length(mailbox->workers[1].queues[0]) == 16);
+            REQUIRE(mailbox->workers[1].overflows[0].count == 4);
+
+            REQUIRE(worker_mailbox_process(mailbox, 1, false) == 20);
+            REQUIRE(counter == 20);
+            REQUIRE(mailbox->workers[1].overflows[0].count == 0);
+        }
+
+        SECTION("order preserved") {
+            uint32_t value = 1;
+
+            for(; value <= 20; value++) {
+                REQUIRE(worker_mailbox_enqueue_or_overflow(
+                        mailbox, 0, 1, test_worker_mailbox_message_order, (void*)(uintptr_t)value, &wakeup_required));
+            }
+
+            // Free some space in the queue, the new messages must keep going to the overflow list as long as it's not
+            // empty otherwise they would overtake the ones already there
+            for(uint32_t index = 0; index < 4; index++) {
+                auto message = (worker_mailbox_message_t*)ring_bounded_queue_spsc_voidptr_dequeue(
+                        mailbox->workers[1].queues[0]);
+                message->fp(message->user_data);
+                xalloc_free(message);
+            }
+
+            REQUIRE(worker_mailbox_enqueue_or_overflow(
+                    mailbox, 0, 1, test_worker_mailbox_message_order, (void*)(uintptr_t)value, &wakeup_required));
+            REQUIRE(ring_bounded_queue_spsc_voidptr_get_length(mailbox->workers[1].queues[0]) == 12);
+            REQUIRE(mailbox->workers[1].overflows[0].count == 5);
+
+            REQUIRE(worker_mailbox_process(mailbox, 1, false) == 17);
+            REQUIRE(test_worker_mailbox_message_order_last == 21);
+            REQUIRE(test_worker_mailbox_message_order_ok);
+        }
+
+        worker_mailbox_free(mailbox);
+    }
+
+    SECTION("worker_mailbox_process") {
+        bool wakeup_required = false;
+        uint32_t counter = 0;
+        worker_mailbox_t *mailbox = worker_mailbox_new(3, 16);
+
+        SECTION("no messages") {
+            REQUIRE(worker_mailbox_process(mailbox, 0, false) == 0);
+        }
+
+        SECTION("messages from multiple senders") {
+            for(uint32_t sender_index = 0; sender_index < 3; sender_index++) {
+                for(uint32_t index = 0; index < 4; index++) {
+                    REQUIRE(worker_mailbox_enqueue(
+                            mailbox,
+                            sender_index,
+                            2,
+                            test_worker_mailbox_message_increment,
+                            &counter,
+                            &wakeup_required));
+                }
+            }
+
+            REQUIRE(worker_mailbox_process(mailbox, 0, false) == 0);
+            REQUIRE(worker_mailbox_process(mailbox, 1, false) == 0);
+            REQUIRE(counter == 0);
+
+            REQUIRE(worker_mailbox_process(mailbox, 2, false) == 12);
+            REQUIRE(counter == 12);
+            REQUIRE(mailbox->workers[2].wakeup_pending == 0);
+
+            REQUIRE(worker_mailbox_process(mailbox, 2, false) == 0);
+            REQUIRE(counter == 12);
+        }
+
+        worker_mailbox_free(mailbox);
+    }
+
+    SECTION("worker_mailbox_wakeup_completed") {
+        bool wakeup_required = false;
+        uint32_t counter = 0;
+        worker_mailbox_t *mailbox = worker_mailbox_new(2, 16);
+        uint64_t user_data = (uintptr_t)&mailbox->workers[1] | WORKER_MAILBOX_WAKEUP_CQE_USER_DATA_TAG;
+
+        REQUIRE(worker_mailbox_is_wakeup_cqe(user_data));
+        REQUIRE(!worker_mailbox_is_wakeup_cqe((uintptr_t)&mailbox->workers[1]));
+
+        REQUIRE(worker_mailbox_enqueue(
+                mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+        REQUIRE(wakeup_required);
+
+        SECTION("wakeup delivered") {
+            worker_mailbox_wakeup_completed(user_data, 0);
+
+            REQUIRE(mailbox->workers[1].wakeup_pending == 1);
+            REQUIRE(worker_mailbox_enqueue(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(!wakeup_required);
+        }
+
+        SECTION("wakeup failed") {
+            // The receiver is not ready so the wakeup is not sent again but the flag must be cleared
+            worker_mailbox_wakeup_completed(user_data, -EOVERFLOW);
+
+            REQUIRE(mailbox->workers[1].wakeup_pending == 0);
+            REQUIRE(worker_mailbox_enqueue(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+            REQUIRE(wakeup_required);
+        }
+
+        worker_mailbox_free(mailbox);
+    }
+
+    SECTION("worker_mailbox_free with pending messages") {
+        bool wakeup_required = false;
+        uint32_t counter = 0;
+        worker_mailbox_t *mailbox = worker_mailbox_new(2, 16);
+
+        REQUIRE(worker_mailbox_enqueue(
+                mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+
+        // The messages in the overflow list are dropped as well
+        for(uint32_t index = 0; index < 20; index++) {
+            REQUIRE(worker_mailbox_enqueue_or_overflow(
+                    mailbox, 0, 1, test_worker_mailbox_message_increment, &counter, &wakeup_required));
+        }
+
+        worker_mailbox_free(mailbox);
+
+        REQUIRE(counter == 0);
+    }
+}
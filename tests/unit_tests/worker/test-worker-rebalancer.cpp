@@ -0,0 +1,90 @@
+/**
+ * Copyright (C) 2018-2023 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdbool>
+#include <cstring>
+#include <ctime>
+#include <arpa/inet.h>
+
+#include "exttypes.h"
+#include "xalloc.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_rebalancer.h"
+
+TEST_CASE("worker/worker_rebalancer.c", "[worker][worker_rebalancer]") {
+    worker_rebalancer_t *rebalancer = worker_rebalancer_new(4);
+
+    SECTION("worker_rebalancer_new") {
+        REQUIRE(rebalancer->workers_count == 4);
+        REQUIRE(rebalancer->migrations_budget == 0);
+        REQUIRE(rebalancer->load != nullptr);
+        REQUIRE(rebalancer->active_connections != nullptr);
+    }
+
+    SECTION("worker_rebalancer_evaluate") {
+        SECTION("no load") {
+            REQUIRE(worker_rebalancer_evaluate(rebalancer, 0, 25, 8) == 0);
+        }
+
+        SECTION("balanced") {
+            for(uint32_t index = 0; index < 4; index++) {
+                rebalancer->load[index] = 1000;
+                rebalancer->active_connections[index] = 10;
+            }
+
+            REQUIRE(worker_rebalancer_evaluate(rebalancer, 0, 25, 8) == 0);
+        }
+
+        SECTION("overloaded") {
+            rebalancer->load[0] = 10000;
+            rebalancer->load[1] = 2000;
+            rebalancer->load[2] = 2000;
+            rebalancer->load[3] = 2000;
+            rebalancer->active_connections[0] = 10;
+
+            // The mean is 4000, 6000 have to be moved away but the target can take only 2000, 2 connections
+            REQUIRE(worker_rebalancer_evaluate(rebalancer, 0, 25, 8) == 2);
+            REQUIRE(rebalancer->target_worker_index == 1);
+
+            SECTION("not overloaded") {
+                REQUIRE(worker_rebalancer_evaluate(rebalancer, 1, 25, 8) == 0);
+                REQUIRE(rebalancer->migrations_budget == 0);
+            }
+        }
+
+        SECTION("capped to max migrations") {
+            rebalancer->load[0] = 10000;
+            rebalancer->load[3] = 100;
+            rebalancer->load[1] = rebalancer->load[2] = 5000;
+            rebalancer->active_connections[0] = 100;
+
+            REQUIRE(worker_rebalancer_evaluate(rebalancer, 0, 25, 8) == 8);
+            REQUIRE(rebalancer->target_worker_index == 3);
+        }
+
+        SECTION("single connection") {
+            rebalancer->load[0] = 10000;
+            rebalancer->active_connections[0] = 1;
+
+            REQUIRE(worker_rebalancer_evaluate(rebalancer, 0, 25, 8) == 0);
+        }
+    }
+
+    worker_rebalancer_free(rebalancer);
+}
@@ -7,6 +7,18 @@ import logging
 
 
 class Program:
+    # Hottest commands, for these commands the generator emits a specialized resolver for the positional arguments
+    # to avoid walking the arguments tree for every argument received, the other commands rely on the generic path
+    FAST_PATH_COMMANDS = ["get", "set", "mget", "mset", "del", "incr", "expire"]
+
+    # FNV-1a 32bit prime, used by the perfect hash function of the commands dispatcher
+    DISPATCH_HASH_PRIME = 0x01000193
+
+    # Parameters of the hash and displace construction of the commands dispatcher
+    DISPATCH_BUCKET_AVERAGE_SIZE = 4
+    DISPATCH_MAX_DISPLACEMENT = 0xFFFF
+    DISPATCH_MAX_SEEDS = 16
+
     def __init__(
             self):
         self._setup_argument_parser()
@@ -205,6 +217,8 @@ class Program:
                 ".has_sub_arguments = {has_sub_arguments}",
                 ".has_multiple_occurrences = {has_multiple_occurrences}",
                 ".has_multiple_token = {has_multiple_token}",
+                # the keys only read by the command are tracked by the client side caching
+                ".is_read_only_key = {is_read_only_key}",
                 ".argument_context_member_size = {argument_context_member_size}",
                 ".argument_context_member_offset = "
                 "offsetof({command_context_struct_name}_t,{command_context_field_name})",
@@ -235,6 +249,12 @@ class Program:
                 has_sub_arguments="true" if argument["has_sub_arguments"] else "false",
                 has_multiple_occurrences="true" if argument["has_multiple_occurrences"] else "false",
                 has_multiple_token="true" if argument["has_multiple_token"] else "false",
+                is_read_only_key=(
+                    "true"
+                    if argument["key_spec_index"] is not None and
+                       argument["key_spec_index"] < len(command_info["key_specs"]) and
+                       "READ_ONLY" in command_info["key_specs"][argument["key_spec_index"]]["key_access_flags"]
+                    else "false"),
                 command_context_struct_name=command_context_struct_name,
                 command_context_field_name=argument["name"].replace("-", "_"),
             ) +
@@ -466,54 +486,41 @@ class Program:
 
             self._write_header_footer(fp, "CACHEGRAND_MODULE_" + self._arguments.module_name.upper() + "_AUTOGENERATED_COMMANDS_ARGUMENTS_H")
 
-    def _generate_commands_module_redis_autogenerated_commands_info_map_h_header_commands(
+    def _flatten_commands_info(
             self,
-            fp,
             all_commands_info: list,
             parent_containers: list,
-            commands_info: list):
+            commands_info: list) -> list:
+        # Returns the commands, with the subcommands following their container, in the order used to generate
+        # command_infos_map, the index in the returned list matches the index in the map
+        flattened = []
         for command_info in commands_info:
             command_string = (
                 " ".join(parent_containers) +
                 (" " if len(parent_containers) > 0 else "") +
                 command_info["command_string"]).lower()
 
-            fp.writelines([
-                "    MODULE_REDIS_COMMAND_AUTOGEN("
-                "{command_callback_name_uppercase}, "
-                "\"{command_string}\", "
-                "{requires_authentication}, "
-                "{command_callback_name}, "
-                "{required_arguments_count}, "
-                "{has_variable_arguments}, "
-                "{arguments_count}, "
-                "{is_container}, "
-                "{container_name}"
-                "),".format(
-                    command_callback_name_uppercase=command_info["command_callback_name"].upper(),
-                    command_string=command_string,
-                    requires_authentication="true" if command_info["requires_authentication"] else "false",
-                    command_callback_name=command_info["command_callback_name"],
-                    required_arguments_count=command_info["required_arguments_count"],
-                    has_variable_arguments="true" if command_info["has_variable_arguments"] else "false",
-                    arguments_count=len(command_info["arguments"]),
-                    is_container="true" if command_info["is_container"] else "false",
-                    container_name="\"" + command_info["container_name"] + "\"" if command_info["container_name"] is not None else "NULL"),
-                "\n",
-            ])
+            flattened.append((command_string, command_info))
 
             if command_info["is_container"] is True:
-                commands_info_arg = [
-                    x
-                    for x in all_commands_info
-                    if x["container_name"] == command_info["command_string"]
-                ]
-
-                self._generate_commands_module_redis_autogenerated_commands_info_map_h_header_commands(
-                    fp=fp,
+                flattened += self._flatten_commands_info(
                     all_commands_info=all_commands_info,
                     parent_containers=parent_containers + [command_info["command_string"]],
-                    commands_info=commands_info_arg)
+                    commands_info=[
+                        x
+                        for x in all_commands_info
+                        if x["container_name"] == command_info["command_string"]
+                    ])
+
+        return flattened
+
+    def _flatten_root_commands_info(
+            self,
+            commands_info: list) -> list:
+        return self._flatten_commands_info(
+            all_commands_info=commands_info,
+            parent_containers=[],
+            commands_info=[x for x in commands_info if x["container_name"] is None])
 
     def _generate_commands_module_redis_autogenerated_commands_info_map_h_header(
             self,
@@ -525,21 +532,309 @@ class Program:
             self._write_header_header(fp, "CACHEGRAND_MODULE_" + self._arguments.module_name.upper() + "_AUTOGENERATED_COMMANDS_INFO_MAP_H")
 
             fp.writelines(["module_redis_command_info_t command_infos_map[] = {\n"])
-            self._generate_commands_module_redis_autogenerated_commands_info_map_h_header_commands(
-                fp=fp,
-                all_commands_info=commands_info,
-                parent_containers=[],
-                commands_info=[
-                    x
-                    for x in commands_info
-                    if x["container_name"] is None
-                ]
-            )
+
+            for command_string, command_info in self._flatten_root_commands_info(commands_info):
+                fp.writelines([
+                    "    MODULE_REDIS_COMMAND_AUTOGEN("
+                    "{command_callback_name_uppercase}, "
+                    "\"{command_string}\", "
+                    "{requires_authentication}, "
+                    "{command_callback_name}, "
+                    "{required_arguments_count}, "
+                    "{has_variable_arguments}, "
+                    "{arguments_count}, "
+                    "{is_container}, "
+                    "{container_name}"
+                    "),".format(
+                        command_callback_name_uppercase=command_info["command_callback_name"].upper(),
+                        command_string=command_string,
+                        requires_authentication="true" if command_info["requires_authentication"] else "false",
+                        command_callback_name=command_info["command_callback_name"],
+                        required_arguments_count=command_info["required_arguments_count"],
+                        has_variable_arguments="true" if command_info["has_variable_arguments"] else "false",
+                        arguments_count=len(command_info["arguments"]),
+                        is_container="true" if command_info["is_container"] else "false",
+                        container_name="\"" + command_info["container_name"] + "\"" if command_info["container_name"] is not None else "NULL"),
+                    "\n",
+                ])
 
             fp.writelines(["};\n"])
 
             self._write_header_footer(fp, "CACHEGRAND_MODULE_" + self._arguments.module_name.upper() + "_AUTOGENERATED_COMMANDS_INFO_MAP_H")
 
+    @classmethod
+    def _dispatch_hash(
+            cls,
+            seed: int,
+            command_string: str) -> int:
+        # Must match module_redis_autogenerated_commands_dispatch_hash, the | 0x20 lowercases the letters to make the
+        # hash case-insensitive
+        hash_value = (seed ^ len(command_string)) & 0xFFFFFFFF
+        for c in command_string.encode("ascii"):
+            hash_value = ((hash_value ^ (c | 0x20)) * cls.DISPATCH_HASH_PRIME) & 0xFFFFFFFF
+
+        hash_value ^= hash_value >> 15
+
+        return hash_value
+
+    @classmethod
+    def _dispatch_slot(
+            cls,
+            hash_value: int,
+            displacement: int,
+            table_size: int) -> int:
+        # Must match module_redis_autogenerated_commands_dispatch_slot, the displacement is mixed with the whole hash
+        # via the murmur3 finalizer
+        slot = hash_value ^ displacement
+        slot = ((slot ^ (slot >> 16)) * 0x85EBCA6B) & 0xFFFFFFFF
+        slot = ((slot ^ (slot >> 13)) * 0xC2B2AE35) & 0xFFFFFFFF
+        slot ^= slot >> 16
+
+        return slot & (table_size - 1)
+
+    def _dispatch_build_perfect_hash(
+            self,
+            command_strings: list) -> (int, list, int):
+        # Hash and displace: the commands are split in buckets by the hash, each bucket gets a displacement picked to
+        # move all its commands to free slots, the largest buckets are placed first while the table is still empty.
+        # With a load factor below 0.8 a displacement is found in a handful of attempts, if a bucket can't be placed
+        # a different seed, or a larger table, is used.
+        buckets_count = 1
+        while buckets_count * self.DISPATCH_BUCKET_AVERAGE_SIZE < len(command_strings):
+            buckets_count *= 2
+
+        table_size = 1
+        while table_size * 4 < len(command_strings) * 5:
+            table_size *= 2
+
+        while True:
+            for seed in range(1, self.DISPATCH_MAX_SEEDS + 1):
+                hashes = [self._dispatch_hash(seed, command_string) for command_string in command_strings]
+
+                # Two commands with the same hash can't be separated by any displacement
+                if len(set(hashes)) != len(hashes):
+                    continue
+
+                buckets = [[] for _ in range(buckets_count)]
+                for hash_value in hashes:
+                    buckets[hash_value & (buckets_count - 1)].append(hash_value)
+
+                displacements = [0] * buckets_count
+                used_slots = set()
+                for bucket_index in sorted(range(buckets_count), key=lambda x: len(buckets[x]), reverse=True):
+                    if len(buckets[bucket_index]) == 0:
+                        break
+
+                    for displacement in range(0, self.DISPATCH_MAX_DISPLACEMENT + 1):
+                        slots = set(
+                            self._dispatch_slot(hash_value, displacement, table_size)
+                            for hash_value in buckets[bucket_index])
+                        if len(slots) == len(buckets[bucket_index]) and slots.isdisjoint(used_slots):
+                            displacements[bucket_index] = displacement
+                            used_slots |= slots
+                            break
+                    else:
+                        break
+                else:
+                    return seed, displacements, table_size
+
+            table_size *= 2
+
+    def _generate_commands_module_redis_autogenerated_commands_dispatch_h_fast_path_resolver(
+            self,
+            command_info: dict) -> Optional[str]:
+        command_context_typedef_name = self._generate_command_context_typedef_name(command_info)
+        arguments_decl_name = "module_redis_command_{}_arguments".format(command_info["command_callback_name"])
+        lines = []
+
+        for argument_index, argument in enumerate(command_info["arguments"]):
+            argument_name = argument["name"].replace("-", "_")
+
+            # Only the positional arguments are handled, the tokens are left to the generic path
+            if argument["token"] is not None or argument["type"] in ["oneof", "bool"]:
+                continue
+
+            if argument["type"] == "block":
+                if not argument["has_multiple_occurrences"]:
+                    continue
+
+                entry_typedef_name = "{}_subargument_{}_t".format(
+                    self._generate_command_context_struct_name(command_info),
+                    argument_name)
+
+                for sub_argument_index, sub_argument in enumerate(argument["sub_arguments"]):
+                    if sub_argument["token"] is not None or sub_argument["type"] in ["block", "oneof", "bool"]:
+                        continue
+
+                    # As for the generic path, the list is expanded only when the first argument of the block is
+                    # received, the following arguments of the block are stored in the last entry of the list
+                    lines += [
+                        "    if (argument == &module_redis_command_{}_subargument_{}_arguments[{}]) {{".format(
+                            command_info["command_callback_name"], argument_name, sub_argument_index),
+                        "        {} *entry = block_argument_index == 0".format(entry_typedef_name),
+                        "                ? module_redis_command_context_list_expand_and_get_new_entry(",
+                        "                        arena,",
+                        "                        &{}[{}],".format(arguments_decl_name, argument_index),
+                        "                        &command_context->{})".format(argument_name),
+                        "                : &command_context->{0}.list[command_context->{0}.count - 1];".format(
+                            argument_name),
+                        "        return &entry->{};".format(sub_argument["name"].replace("-", "_")),
+                        "    }",
+                        "",
+                    ]
+
+                continue
+
+            if argument["has_multiple_occurrences"]:
+                lines += [
+                    "    if (argument == &{}[{}]) {{".format(arguments_decl_name, argument_index),
+                    "        return module_redis_command_context_list_expand_and_get_new_entry(",
+                    "                arena,",
+                    "                argument,",
+                    "                &command_context->{});".format(argument_name),
+                    "    }",
+                    "",
+                ]
+            else:
+                lines += [
+                    "    if (argument == &{}[{}]) {{".format(arguments_decl_name, argument_index),
+                    "        return &command_context->{};".format(argument_name),
+                    "    }",
+                    "",
+                ]
+
+        if len(lines) == 0:
+            return None
+
+        return "\n".join([
+            "static void *{command_context_struct_name}_argument_member_context_addr_fast_path(",
+            "        xalloc_arena_t *arena,",
+            "        module_redis_command_argument_t *argument,",
+            "        bool is_in_block,",
+            "        int block_argument_index,",
+            "        void *context) {{",
+            "    {command_context_typedef_name} *command_context = context;",
+            "",
+        ]).format(
+            command_context_struct_name=self._generate_command_context_struct_name(command_info),
+            command_context_typedef_name=command_context_typedef_name) + "\n" + "\n".join(lines) + "\n" + \
+            "    return NULL;\n" \
+            "}\n"
+
+    def _generate_commands_module_redis_autogenerated_commands_dispatch_h_header(
+            self,
+            commands_info: list):
+        flattened_commands_info = self._flatten_root_commands_info(commands_info)
+        command_strings = [command_string for command_string, _ in flattened_commands_info]
+        seed, displacements, table_size = self._dispatch_build_perfect_hash(command_strings)
+
+        # The table contains the index of the command in command_infos_map plus one, 0 marks an empty slot
+        table = [0] * table_size
+        for command_index, command_string in enumerate(command_strings):
+            hash_value = self._dispatch_hash(seed, command_string)
+            table[self._dispatch_slot(
+                hash_value,
+                displacements[hash_value & (len(displacements) - 1)],
+                table_size)] = command_index + 1
+
+        header_name = \
+            "CACHEGRAND_MODULE_" + self._arguments.module_name.upper() + "_AUTOGENERATED_COMMANDS_DISPATCH_H"
+
+        with open(path.join(
+                self._arguments.commands_scaffolding_path, self._arguments.files_prefix + "_dispatch.h"), "w") \
+                as fp:
+
+            self._write_header_header(fp, header_name)
+
+            fp.writelines([
+                "#define MODULE_REDIS_AUTOGENERATED_COMMANDS_DISPATCH_SEED (0x{:08X}U)\n".format(seed),
+                "#define MODULE_REDIS_AUTOGENERATED_COMMANDS_DISPATCH_PRIME (0x{:08X}U)\n".format(
+                    self.DISPATCH_HASH_PRIME),
+                "#define MODULE_REDIS_AUTOGENERATED_COMMANDS_DISPATCH_DISPLACEMENTS_COUNT ({})\n".format(
+                    len(displacements)),
+                "#define MODULE_REDIS_AUTOGENERATED_COMMANDS_DISPATCH_TABLE_SIZE ({})\n".format(table_size),
+                "\n",
+                "static const uint16_t module_redis_autogenerated_commands_dispatch_displacements[] = {\n",
+            ])
+
+            for row_index in range(0, len(displacements), 16):
+                fp.writelines([
+                    "    " + ", ".join([str(x) for x in displacements[row_index:row_index + 16]]) + ",\n"
+                ])
+
+            fp.writelines([
+                "};\n",
+                "\n",
+                "static const uint16_t module_redis_autogenerated_commands_dispatch_table[] = {\n",
+            ])
+
+            for table_row_index in range(0, table_size, 16):
+                fp.writelines([
+                    "    " + ", ".join([str(x) for x in table[table_row_index:table_row_index + 16]]) + ",\n"
+                ])
+
+            fp.writelines([
+                "};\n",
+                "\n",
+                "static inline __attribute__((always_inline)) uint32_t module_redis_autogenerated_commands_dispatch_slot(\n",
+                "        uint32_t hash) {\n",
+                "    uint32_t slot = hash ^ module_redis_autogenerated_commands_dispatch_displacements[\n",
+                "            hash & (MODULE_REDIS_AUTOGENERATED_COMMANDS_DISPATCH_DISPLACEMENTS_COUNT - 1)];\n",
+                "\n",
+                "    slot = (slot ^ (slot >> 16)) * 0x85EBCA6BU;\n",
+                "    slot = (slot ^ (slot >> 13)) * 0xC2B2AE35U;\n",
+                "    slot ^= slot >> 16;\n",
+                "\n",
+                "    return slot & (MODULE_REDIS_AUTOGENERATED_COMMANDS_DISPATCH_TABLE_SIZE - 1);\n",
+                "}\n",
+                "\n",
+                "static inline __attribute__((always_inline)) uint32_t module_redis_autogenerated_commands_dispatch_hash(\n",
+                "        const char *command,\n",
+                "        size_t command_length) {\n",
+                "    uint32_t hash = MODULE_REDIS_AUTOGENERATED_COMMANDS_DISPATCH_SEED ^ (uint32_t)command_length;\n",
+                "\n",
+                "    for(size_t index = 0; index < command_length; index++) {\n",
+                "        hash = (hash ^ (uint8_t)(command[index] | 0x20)) * MODULE_REDIS_AUTOGENERATED_COMMANDS_DISPATCH_PRIME;\n",
+                "    }\n",
+                "\n",
+                "    hash ^= hash >> 15;\n",
+                "\n",
+                "    return module_redis_autogenerated_commands_dispatch_slot(hash);\n",
+                "}\n",
+                "\n",
+            ])
+
+            fast_path_commands = []
+            for command_index, (command_string, command_info) in enumerate(flattened_commands_info):
+                if command_string not in self.FAST_PATH_COMMANDS:
+                    continue
+
+                resolver = self._generate_commands_module_redis_autogenerated_commands_dispatch_h_fast_path_resolver(
+                    command_info=command_info)
+                if resolver is None:
+                    continue
+
+                fast_path_commands.append((command_index, command_string, command_info))
+                fp.writelines([resolver, "\n"])
+
+            fp.writelines([
+                "static inline void module_redis_autogenerated_commands_dispatch_register_fast_paths(\n",
+                "        module_redis_command_info_t *command_infos) {\n",
+            ])
+
+            for command_index, command_string, command_info in fast_path_commands:
+                fp.writelines([
+                    "    command_infos[{}].argument_member_context_addr_fast_path_funcptr =\n".format(command_index),
+                    "            {}_argument_member_context_addr_fast_path;\n".format(
+                        self._generate_command_context_struct_name(command_info)),
+                ])
+
+            fp.writelines([
+                "}\n",
+            ])
+
+            self._write_header_footer(fp, header_name)
+
     def _generate_commands_module_redis_command_autogenerated_c_headers_general(
             self,
             fp):
@@ -734,7 +1029,6 @@ class Program:
                     lines.append("    for(int i = 0; i < context->{argument_name}.count; i++) {{")
                     lines.append("        {free_memory_func}(db, &context->{argument_name}.list[i]);")
                     lines.append("    }}")
-                    lines.append("    xalloc_free(context->{argument_name}.list);")
                     lines.append("}}")
                 else:
                     lines.append("{free_memory_func}(db, &context->{argument_name}.value);")
@@ -749,22 +1043,17 @@ class Program:
                     lines.append("            {free_memory_func}(db, &context->{argument_name}.list[i].chunk_sequence);")
                     lines.append("        }}")
                     lines.append("    }}")
-                    lines.append("    xalloc_free(context->{argument_name}.list);")
                     lines.append("}}")
                 else:
                     lines.append("if (context->{argument_name}.value.chunk_sequence.sequence) {{")
                     lines.append("    {free_memory_func}(db, &context->{argument_name}.value.chunk_sequence);")
                     lines.append("}}")
 
-            elif argument["type"] in ["key", "pattern", "short_string"]:
+            elif argument["type"] in ["key"]:
+                # Only the keys have to be freed, the patterns and the short strings are allocated from the command
+                # arena as the lists and the context itself and therefore are released when the arena is reset
                 free_memory_func = "xalloc_free"
-
-                if argument["type"] == "key":
-                    field_name = "key"
-                elif argument["type"] == "pattern":
-                    field_name = "pattern"
-                elif argument["type"] == "short_string":
-                    field_name = "short_string"
+                field_name = "key"
 
                 if argument["has_multiple_occurrences"]:
                     lines.append("if (context->{argument_name}.list) {{")
@@ -773,7 +1062,6 @@ class Program:
                     lines.append("            {free_memory_func}(context->{argument_name}.list[i].{field_name});")
                     lines.append("        }}")
                     lines.append("    }}")
-                    lines.append("    xalloc_free(context->{argument_name}.list);")
                     lines.append("}}")
                 else:
                     lines.append("if (context->{argument_name}.value.{field_name}) {{")
@@ -834,6 +1122,8 @@ class Program:
             commands_info=commands_info)
         self._generate_commands_module_redis_autogenerated_commands_info_map_h_header(
             commands_info=commands_info)
+        self._generate_commands_module_redis_autogenerated_commands_dispatch_h_header(
+            commands_info=commands_info)
         self._generate_commands_module_redis_autogenerated_commands_contexts_h_header(
             commands_info=commands_info)
         self._generate_commands_module_redis_autogenerated_commands_contexts_c_code(